@@ -123,6 +123,14 @@ public class VectorizedParquetArrowReader extends VectorizedParquetRecordReader
   public void initialize(String path, List<String> columns)
       throws IOException, UnsupportedOperationException {}
 
+  /**
+   * Stop after rows more rows, the native reader truncates its last batch and stops
+   * decoding. Negative means no limit.
+   */
+  public void setRowBudget(long rows) throws IOException {
+    reader.setRowBudget(rows);
+  }
+
   @Override
   public boolean nextKeyValue() throws IOException {
     return nextBatch();
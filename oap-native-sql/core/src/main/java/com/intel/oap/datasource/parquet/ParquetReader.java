@@ -140,6 +140,16 @@ public class ParquetReader implements AutoCloseable {
     return root.getFieldVectors();
   }
 
+  /**
+   * Limit the rows still read from ParquetReader, for a LIMIT downstream.
+   *
+   * @param rows rows still wanted, negative for no limit.
+   * @throws IOException throws io exception in case of native failure
+   */
+  public void setRowBudget(long rows) throws IOException {
+    jniWrapper.nativeSetRowBudget(nativeInstanceId, rows);
+  }
+
   /**
    * Get last readed ArrowRecordBatch Length.
    *
@@ -78,6 +78,16 @@ public class ParquetReaderJniWrapper {
    */
   public native ArrowRecordBatchBuilder nativeReadNext(long id) throws IOException;
 
+  /**
+   * Limit the rows still read from parquet file reader. The last batch is truncated
+   * and the reader stops decoding once they are read.
+   *
+   * @param id parquet reader instance number
+   * @param rows rows a downstream limit still needs, negative for no limit
+   * @throws IOException throws exception in case of any io exception in native codes
+   */
+  public native void nativeSetRowBudget(long id, long rows) throws IOException;
+
   /**
    * Get schema from parquet file reader.
    *
@@ -0,0 +1,34 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.vectorized;
+
+/** POJO to hold the native UnsafeRow buffer converted from an arrow record batch */
+public class ArrowColumnarToRowInfo {
+  public final long instanceID;
+  public final long[] offsets;
+  public final long[] lengths;
+  public final long memoryAddress;
+
+  public ArrowColumnarToRowInfo(
+      long instanceID, long[] offsets, long[] lengths, long memoryAddress) {
+    this.instanceID = instanceID;
+    this.offsets = offsets;
+    this.lengths = lengths;
+    this.memoryAddress = memoryAddress;
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.vectorized;
+
+import java.io.IOException;
+
+public class ArrowColumnarToRowJniWrapper {
+
+  public ArrowColumnarToRowJniWrapper() throws IOException {
+    JniUtils.getInstance();
+  }
+
+  /**
+   * Convert an arrow record batch into a contiguous buffer of UnsafeRows in native memory.
+   * Row i starts at memoryAddress + offsets[i] and has lengths[i] bytes. The buffer stays
+   * valid until nativeClose is called with the returned instance id.
+   *
+   * @param schemaBuf serialized arrow schema
+   * @param numRows number of rows in the record batch
+   * @param bufAddrs addresses of the record batch buffers
+   * @param bufSizes sizes of the record batch buffers
+   * @param memoryPoolId native memory pool to allocate the rows from
+   * @return the row buffer address, offsets and lengths
+   */
+  public native ArrowColumnarToRowInfo nativeConvertColumnarToRow(
+      byte[] schemaBuf, int numRows, long[] bufAddrs, long[] bufSizes, long memoryPoolId)
+      throws RuntimeException;
+
+  /**
+   * Release the row buffer of a conversion.
+   *
+   * @param instanceID returned by nativeConvertColumnarToRow
+   */
+  public native void nativeClose(long instanceID);
+}
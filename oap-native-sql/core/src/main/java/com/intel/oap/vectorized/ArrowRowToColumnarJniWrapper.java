@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.vectorized;
+
+import java.io.IOException;
+
+public class ArrowRowToColumnarJniWrapper {
+
+  public ArrowRowToColumnarJniWrapper() throws IOException {
+    JniUtils.getInstance();
+  }
+
+  /**
+   * Convert a contiguous buffer of UnsafeRows into an arrow record batch allocated in
+   * native memory. Row i starts at memoryAddress + rowOffsets[i]. The rows are only read
+   * during the call.
+   *
+   * @param schemaBuf serialized arrow schema of the result
+   * @param rowOffsets offset of each row in the buffer
+   * @param memoryAddress address of the row buffer
+   * @param memoryPoolId native memory pool to allocate the record batch from
+   * @return the native record batch
+   */
+  public native ArrowRecordBatchBuilder nativeConvertRowToColumnar(
+      byte[] schemaBuf, long[] rowOffsets, long memoryAddress, long memoryPoolId)
+      throws RuntimeException;
+}
@@ -42,10 +42,14 @@ public class BatchIterator {
   private native void nativeProcessAndCacheOneWithSelection(long nativeHandler,
       byte[] schemaBuf, int numRows, long[] bufAddrs, long[] bufSizes,
       int selectionVectorRecordCount, long selectionVectorAddr, long selectionVectorSize);
+  private native void nativeFinishInput(long nativeHandler);
   private native void nativeSetDependencies(long nativeHandler, long[] dependencies);
   private native NativeSerializableObject nativeNextHashRelation(long nativeHandler);
   private native void nativeSetHashRelation(
       long nativeHandler, long[] memoryAddrs, int[] sizes);
+  private native long nativeMakeLimit(long nativeHandler, long limit);
+  private native void nativeSetRowBudget(long nativeHandler, long rows);
+  private native boolean nativeBudgetExhausted(long nativeHandler);
   private native void nativeClose(long nativeHandler);
 
   private long nativeHandler = 0;
@@ -180,6 +184,17 @@ public class BatchIterator {
     }
   }
 
+  /**
+   * Ends the input fed through processAndCacheOne, the rows still buffered by the
+   * native side are returned by next from then on.
+   */
+  public void finishInput() throws IOException {
+    if (nativeHandler == 0) {
+      return;
+    }
+    nativeFinishInput(nativeHandler);
+  }
+
   public void setDependencies(BatchIterator[] dependencies) {
     long[] instanceIdList = new long[dependencies.length];
     for (int i = 0; i < dependencies.length; i++) {
@@ -188,6 +203,22 @@ public class BatchIterator {
     nativeSetDependencies(nativeHandler, instanceIdList);
   }
 
+  /**
+   * Wraps this iterator in a native limit. The limit is pushed upstream as a row
+   * budget, so the native operators stop early and truncate their last batch.
+   */
+  public BatchIterator limit(long limit) throws IOException {
+    return new BatchIterator(nativeMakeLimit(nativeHandler, limit));
+  }
+
+  public void setRowBudget(long rows) {
+    nativeSetRowBudget(nativeHandler, rows);
+  }
+
+  public boolean budgetExhausted() {
+    return nativeBudgetExhausted(nativeHandler);
+  }
+
   public void close() {
     if (!closed) {
       nativeClose(nativeHandler);
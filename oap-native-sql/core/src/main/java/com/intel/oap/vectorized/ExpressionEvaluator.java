@@ -95,6 +95,23 @@ public class ExpressionEvaluator implements AutoCloseable {
     return jniWrapper.nativeGetSignature(nativeHandler);
   }
 
+  /**
+   * Executor wide build cache counters, in the order of
+   * ExpressionEvaluatorJniWrapper.nativeGetBuildCacheMetrics.
+   */
+  public long[] getBuildCacheMetrics() throws RuntimeException {
+    return jniWrapper.nativeGetBuildCacheMetrics();
+  }
+
+  /**
+   * Gandiva registry counters of the calling thread, in the order of
+   * ExpressionEvaluatorJniWrapper.nativeGetGandivaCacheMetrics.
+   */
+  public static long[] getGandivaCacheMetrics() throws IOException {
+    JniUtils.getInstance();
+    return ExpressionEvaluatorJniWrapper.nativeGetGandivaCacheMetrics();
+  }
+
   /** Set result Schema in some special cases */
   public void setReturnFields(Schema schema) throws RuntimeException, IOException, GandivaException {
     jniWrapper.nativeSetReturnFields(nativeHandler, getSchemaBytesBuf(schema));
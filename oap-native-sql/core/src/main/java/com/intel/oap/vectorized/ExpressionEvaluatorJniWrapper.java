@@ -124,6 +124,22 @@ public class ExpressionEvaluatorJniWrapper {
          */
         native String nativeGetSignature(long nativeHandler) throws RuntimeException;
 
+        /**
+         * Get the metrics of the executor wide build caches.
+         *
+         * @return parsed plan cache hits, misses and nanoseconds of parsing saved by the
+         *         hits, then loads of already resolved and of new codegen libraries
+         */
+        native long[] nativeGetBuildCacheMetrics();
+
+        /**
+         * Get the gandiva registry lookups made by the calling thread since it started.
+         *
+         * @return hits, misses, nanoseconds of building saved by the hits, evictions and
+         *         projectors and filters added
+         */
+        static native long[] nativeGetGandivaCacheMetrics();
+
         /**
          * Evaluate the expressions represented by the nativeHandler on a record batch
          * and store the output in ValueVectors. Throws an exception in case of errors
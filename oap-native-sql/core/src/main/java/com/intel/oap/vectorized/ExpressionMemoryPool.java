@@ -71,6 +71,15 @@ public class ExpressionMemoryPool implements AutoCloseable {
     return nativeInstanceId;
   }
 
+  /**
+   * Counters of the spill arbiter of the task owning this pool: the failed reservations
+   * it reclaimed memory for, then the spills it requested from the operators named
+   * spillableName and the bytes they released. All 0 when the pool is not arbitrated.
+   */
+  public long[] getSpillMetrics(String spillableName) {
+    return getSpillMetrics(nativeInstanceId, spillableName);
+  }
+
   @Override
   public void close() throws Exception {
     releaseMemoryPool(nativeInstanceId);
@@ -81,4 +90,6 @@ public class ExpressionMemoryPool implements AutoCloseable {
   private static native long createListenableMemoryPool(ReservationListener listener);
 
   private static native void releaseMemoryPool(long id);
+
+  private static native long[] getSpillMetrics(long id, String spillableName);
 }
@@ -34,6 +34,8 @@ public class ShuffleSplitterJniWrapper {
    * @param dataFile acquired from spark IndexShuffleBlockResolver
    * @param subDirsPerLocalDir SparkConf spark.diskStore.subDirectories
    * @param localDirs configured local directories where Spark can write files
+   * @param memoryPoolId native memory pool the partition buffers are allocated from, the
+   *     splitter can be spilled by other operators using a pool of the same task
    * @return native splitter instance id if created successfully.
    */
   public long make(
@@ -42,7 +44,8 @@ public class ShuffleSplitterJniWrapper {
       String codec,
       String dataFile,
       int subDirsPerLocalDir,
-      String localDirs) {
+      String localDirs,
+      long memoryPoolId) {
     return nativeMake(
         part.getShortName(),
         part.getNumPartitions(),
@@ -52,7 +55,8 @@ public class ShuffleSplitterJniWrapper {
         codec,
         dataFile,
         subDirsPerLocalDir,
-        localDirs);
+        localDirs,
+        memoryPoolId);
   }
 
   public native long nativeMake(
@@ -64,7 +68,8 @@ public class ShuffleSplitterJniWrapper {
       String codec,
       String dataFile,
       int subDirsPerLocalDir,
-      String localDirs);
+      String localDirs,
+      long memoryPoolId);
 
   /**
    * Split one record batch represented by bufAddrs and bufSizes into several batches. The batch is
@@ -296,6 +296,34 @@ case class ColumnarPreOverrides(conf: SparkConf) extends Rule[SparkPlan] {
           plan
       }
 
+    case plan: LocalLimitExec =>
+      val child = replaceWithColumnarPlan(plan.child)
+      if (columnarConf.enableColumnarLimit && child.supportsColumnar) {
+        logDebug(s"Columnar Processing for ${plan.getClass} is currently supported.")
+        ColumnarLocalLimitExec(plan.limit, child)
+      } else {
+        plan.withNewChildren(Seq(child))
+      }
+
+    case plan: GlobalLimitExec =>
+      val child = replaceWithColumnarPlan(plan.child)
+      if (columnarConf.enableColumnarLimit && child.supportsColumnar) {
+        logDebug(s"Columnar Processing for ${plan.getClass} is currently supported.")
+        ColumnarGlobalLimitExec(plan.limit, child)
+      } else {
+        plan.withNewChildren(Seq(child))
+      }
+
+    case plan: CollectLimitExec =>
+      // the collect stays row based, each partition it takes from stops at the limit
+      val child = replaceWithColumnarPlan(plan.child)
+      if (columnarConf.enableColumnarLimit && child.supportsColumnar) {
+        logDebug(s"Columnar Processing for ${plan.getClass} is currently supported.")
+        plan.withNewChildren(Seq(ColumnarLocalLimitExec(plan.limit, child)))
+      } else {
+        plan.withNewChildren(Seq(child))
+      }
+
     case plan: WindowExec =>
       if (columnarConf.enableColumnarWindow) {
         val child = plan.child match {
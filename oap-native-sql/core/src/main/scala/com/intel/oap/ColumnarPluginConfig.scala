@@ -38,6 +38,10 @@ class ColumnarPluginConfig(conf: SparkConf) {
     conf.getInt("spark.oap.sql.columnar.joinOptimizationLevel", defaultValue = 6)
   val enableColumnarWholeStageCodegen: Boolean =
     conf.getBoolean("spark.oap.sql.columnar.wholestagecodegen", defaultValue = true)
+  val enableColumnarLimit: Boolean =
+    conf.getBoolean("spark.oap.sql.columnar.limit", defaultValue = true)
+  val enableNativeRowToColumnar: Boolean =
+    conf.getBoolean("spark.oap.sql.columnar.nativeRowToColumnar", defaultValue = true)
   val enableColumnarShuffle: Boolean = conf
     .get("spark.shuffle.manager", "sort")
     .equals("org.apache.spark.shuffle.sort.ColumnarShuffleManager")
@@ -17,11 +17,13 @@
 
 package com.intel.oap.execution
 
+import com.google.common.collect.Lists
 import com.intel.oap.expression.ConverterUtils
 import com.intel.oap.vectorized.ArrowWritableColumnVector
 import com.intel.oap.vectorized.CloseableColumnBatchIterator
-import org.apache.arrow.vector.util.VectorBatchAppender
-import org.apache.arrow.memory.{BufferAllocator, RootAllocator}
+import com.intel.oap.vectorized.ExpressionEvaluator
+import org.apache.arrow.gandiva.expression._
+import org.apache.arrow.vector.types.pojo.{ArrowType, Field}
 import org.apache.spark.TaskContext
 import org.apache.spark.rdd.RDD
 import org.apache.spark.sql.catalyst.InternalRow
@@ -31,7 +33,6 @@ import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
 import org.apache.spark.sql.execution.{SparkPlan, UnaryExecNode}
 import org.apache.spark.sql.execution.datasources.v2.arrow.SparkMemoryUtils
 import org.apache.spark.sql.vectorized.{ColumnarBatch, ColumnVector}
-import org.apache.spark.sql.types.{StructType, StructField}
 
 import scala.collection.mutable.ListBuffer
 
@@ -66,68 +67,92 @@ case class CoalesceBatchesExec(child: SparkPlan) extends UnaryExecNode {
     val collectTime = longMetric("collectTime")
     val concatTime = longMetric("concatTime")
     val avgCoalescedNumRows = longMetric("avgCoalescedNumRows")
+    val arrowSchema = ConverterUtils.toArrowSchema(output)
 
     child.executeColumnar().mapPartitions { iter =>
       val beforeInput = System.nanoTime
       val hasInput = iter.hasNext
       collectTime += System.nanoTime - beforeInput
       val res = if (hasInput) {
-        new Iterator[ColumnarBatch] {
-          var numBatchesTotal: Long = _
-          var numRowsTotal: Long = _
-          val resultStructType =
-            StructType(output.map(a => StructField(a.name, a.dataType, a.nullable, a.metadata)))
-          System.out.println(s"Coalecse schema is ${resultStructType}")
-
-          SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit] { _ =>
-            if (numBatchesTotal > 0) {
-              avgCoalescedNumRows.set(numRowsTotal.toDouble / numBatchesTotal)
-            }
+        // the native coalescer takes the input batch by batch and hands out every
+        // output batch as soon as it has enough rows or bytes
+        val coalescer = new ExpressionEvaluator()
+        coalescer.build(
+          arrowSchema,
+          Lists.newArrayList(getCoalesceExpression(recordsPerBatch)),
+          arrowSchema,
+          true /*return at finish*/ )
+        val coalesceIterator = coalescer.finishByIterator()
+        // Output batches may slice the input without a copy, so an input batch is kept
+        // until the outputs made from it are closed downstream.
+        val retainedInputs = ListBuffer[ColumnarBatch]()
+        var inputFinished = false
+        var numBatchesTotal: Long = 0
+        var numRowsTotal: Long = 0
+
+        def closeRetainedInputs(keepLast: Boolean): Unit = {
+          val numToClose = if (keepLast) retainedInputs.length - 1 else retainedInputs.length
+          (0 until numToClose).foreach(_ => retainedInputs.remove(0).close())
+        }
+
+        SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit] { _ =>
+          if (numBatchesTotal > 0) {
+            avgCoalescedNumRows.set(numRowsTotal.toDouble / numBatchesTotal)
           }
+          coalesceIterator.close()
+          coalescer.close()
+          closeRetainedInputs(false)
+        }
 
+        new Iterator[ColumnarBatch] {
           override def hasNext: Boolean = {
-            val beforeNext = System.nanoTime
-            val hasNext = iter.hasNext
-            collectTime += System.nanoTime - beforeNext
-            hasNext
+            while (!coalesceIterator.hasNext && !inputFinished) {
+              val beforeNext = System.nanoTime
+              val hasNextInput = iter.hasNext
+              val input_cb = if (hasNextInput) iter.next() else null
+              collectTime += System.nanoTime - beforeNext
+              val beforeConcat = System.nanoTime
+              if (input_cb == null) {
+                coalesceIterator.finishInput()
+                inputFinished = true
+              } else if (input_cb.numRows > 0) {
+                numInputBatches += 1
+                input_cb.retain()
+                retainedInputs += input_cb
+                val input_batch = ConverterUtils.createArrowRecordBatch(input_cb)
+                coalesceIterator.processAndCacheOne(arrowSchema, input_batch)
+                ConverterUtils.releaseArrowRecordBatch(input_batch)
+              }
+              concatTime += System.nanoTime - beforeConcat
+            }
+            coalesceIterator.hasNext
           }
 
           override def next(): ColumnarBatch = {
-
             if (!hasNext) {
               throw new NoSuchElementException("End of ColumnarBatch iterator")
             }
-
-            var rowCount = 0
-            val batchesToAppend = ListBuffer[ColumnarBatch]()
-
-            while (hasNext && rowCount < recordsPerBatch) {
-              val delta = iter.next()
-              delta.retain()
-              rowCount += delta.numRows
-              batchesToAppend += delta
-            }
+            // the previous output is closed by now, only the last input can still be
+            // referenced by the batches to come
+            closeRetainedInputs(true)
 
             val beforeConcat = System.nanoTime
-            val resultColumnVectors =
-              ArrowWritableColumnVector.allocateColumns(rowCount, resultStructType).toArray
-            val target =
-              new ColumnarBatch(resultColumnVectors.map(_.asInstanceOf[ColumnVector]), rowCount)
-            coalesce(target, batchesToAppend.toList)
-            target.setNumRows(rowCount)
-
+            val output_batch = coalesceIterator.next()
+            val rowCount = output_batch.getLength
+            val resultColumnVectorList =
+              ConverterUtils.fromArrowRecordBatch(arrowSchema, output_batch)
+            ConverterUtils.releaseArrowRecordBatch(output_batch)
             concatTime += System.nanoTime - beforeConcat
+
             numOutputRows += rowCount
-            numInputBatches += batchesToAppend.length
             numOutputBatches += 1
-
             // used for calculating avgCoalescedNumRows
             numRowsTotal += rowCount
             numBatchesTotal += 1
 
-            batchesToAppend.foreach(cb => cb.close())
-
-            target
+            new ColumnarBatch(
+              resultColumnVectorList.map(v => v.asInstanceOf[ColumnVector]).toArray,
+              rowCount)
           }
         }
       } else {
@@ -146,14 +171,17 @@ object CoalesceBatchesExec {
     }
   }
 
-  def coalesce(targetBatch: ColumnarBatch, batchesToAppend: List[ColumnarBatch]): Unit = {
-    (0 until targetBatch.numCols).toList.foreach { i =>
-      val targetVector =
-        targetBatch.column(i).asInstanceOf[ArrowWritableColumnVector].getValueVector
-      val vectorsToAppend = batchesToAppend.map { cb =>
-        cb.column(i).asInstanceOf[ArrowWritableColumnVector].getValueVector
-      }
-      VectorBatchAppender.batchAppend(targetVector, vectorsToAppend: _*)
-    }
+  // standalone(CoalesceBatches(<target rows>)), the target bytes come from
+  // NATIVESQL_BATCH_BYTES on the native side
+  def getCoalesceExpression(recordsPerBatch: Int): ExpressionTree = {
+    val coalesceNode = TreeBuilder.makeFunction(
+      "CoalesceBatches",
+      Lists.newArrayList(TreeBuilder.makeLiteral(recordsPerBatch: java.lang.Integer)),
+      new ArrowType.Int(32, true) /*dummy ret type, won't be used*/ )
+    val standaloneNode = TreeBuilder.makeFunction(
+      "standalone",
+      Lists.newArrayList(coalesceNode),
+      new ArrowType.Int(32, true))
+    TreeBuilder.makeExpression(standaloneNode, Field.nullable("res", new ArrowType.Int(32, true)))
   }
 }
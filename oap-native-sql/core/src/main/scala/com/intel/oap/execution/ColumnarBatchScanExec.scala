@@ -26,7 +26,8 @@ import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
 import org.apache.spark.sql.vectorized.{ColumnarBatch, ColumnVector}
 
 class ColumnarBatchScanExec(output: Seq[AttributeReference], @transient scan: Scan)
-    extends BatchScanExec(output, scan) {
+    extends BatchScanExec(output, scan)
+    with ColumnarRowBudgetSupport {
   val tmpDir = ColumnarPluginConfig.getConf(sparkContext.getConf).tmpFile
   override def supportsColumnar(): Boolean = true
   override lazy val metrics = Map(
@@ -35,14 +36,17 @@ class ColumnarBatchScanExec(output: Seq[AttributeReference], @transient scan: Sc
     "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches"),
     "scanTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_batchscan"),
     "inputSize" -> SQLMetrics.createSizeMetric(sparkContext, "input size in bytes"))
-  override def doExecuteColumnar(): RDD[ColumnarBatch] = {
+  override def doExecuteColumnar(): RDD[ColumnarBatch] = doExecuteColumnarWithRowBudget(-1)
+
+  // parquet readers stop decoding once the partition read rows rows, negative for all
+  override protected def doExecuteColumnarWithRowBudget(rows: Int): RDD[ColumnarBatch] = {
     val numOutputRows = longMetric("numOutputRows")
     val numInputBatches = longMetric("numInputBatches")
     val numOutputBatches = longMetric("numOutputBatches")
     val scanTime = longMetric("scanTime")
     val inputSize = longMetric("inputSize")
     val inputColumnarRDD =
-      new ColumnarDataSourceRDD(sparkContext, partitions, readerFactory, true, scanTime, numInputBatches, inputSize, tmpDir)
+      new ColumnarDataSourceRDD(sparkContext, partitions, readerFactory, true, scanTime, numInputBatches, inputSize, tmpDir, rows)
     inputColumnarRDD.map { r =>
       numOutputRows += r.numRows()
       numOutputBatches += 1
@@ -82,7 +82,8 @@ case class ColumnarBroadcastHashJoinExec(
     "processTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_broadcastHasedJoin"),
     "buildTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to build hash map"),
     "joinTime" -> SQLMetrics.createTimingMetric(sparkContext, "join time"),
-    "fetchTime" -> SQLMetrics.createTimingMetric(sparkContext, "broadcast result fetch time"))
+    "fetchTime" -> SQLMetrics.createTimingMetric(sparkContext, "broadcast result fetch time")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val (buildKeyExprs, streamedKeyExprs) = {
     require(
@@ -198,6 +199,7 @@ case class ColumnarBroadcastHashJoinExec(
     val totalTime = longMetric("processTime")
     val buildTime = longMetric("buildTime")
     val joinTime = longMetric("joinTime")
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     val fetchTime = longMetric("fetchTime")
 
     var build_elapse: Long = 0
@@ -224,8 +226,10 @@ case class ColumnarBroadcastHashJoinExec(
         TreeBuilder.makeExpression(
           hash_relation_function,
           Field.nullable("result", new ArrowType.Int(32, true)))
-      hashRelationKernel
-        .build(hash_relation_schema, Lists.newArrayList(hash_relation_expr), true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        hashRelationKernel
+          .build(hash_relation_schema, Lists.newArrayList(hash_relation_expr), true)
+      }
       val hashRelationResultIterator = hashRelationKernel.finishByIterator()
       // we need to set original recordBatch to hashRelationKernel
       var numRows = 0
@@ -255,8 +259,10 @@ case class ColumnarBroadcastHashJoinExec(
       val probe_input_schema = ConverterUtils.toArrowSchema(streamedPlan.output)
       val probe_out_schema = ConverterUtils.toArrowSchema(output)
       val nativeKernel = new ExpressionEvaluator()
-      nativeKernel
-        .build(probe_input_schema, Lists.newArrayList(probe_expr), probe_out_schema, true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        nativeKernel
+          .build(probe_input_schema, Lists.newArrayList(probe_expr), probe_out_schema, true)
+      }
       val nativeIterator = nativeKernel.finishByIterator()
       // we need to complete dependency RDD's firstly
       nativeIterator.setDependencies(Array(hashRelationResultIterator))
@@ -395,6 +401,7 @@ case class ColumnarBroadcastHashJoinExec(
     val totalTime = longMetric("processTime")
     val buildTime = longMetric("buildTime")
     val joinTime = longMetric("joinTime")
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     val fetchTime = longMetric("fetchTime")
 
     var build_elapse: Long = 0
@@ -424,8 +431,10 @@ case class ColumnarBroadcastHashJoinExec(
         TreeBuilder
           .makeExpression(resCtx.root, Field.nullable("result", new ArrowType.Int(32, true)))
       val nativeKernel = new ExpressionEvaluator(jarList.toList.asJava)
-      nativeKernel
-        .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        nativeKernel
+          .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
+      }
 
       // received broadcast value contain a hashmap and raw recordBatch
       val beforeFetch = System.nanoTime()
@@ -439,8 +448,10 @@ case class ColumnarBroadcastHashJoinExec(
       val hash_relation_expression = TreeBuilder
         .makeExpression(ctx.root, Field.nullable("result", new ArrowType.Int(32, true)))
       val hashRelationKernel = new ExpressionEvaluator()
-      hashRelationKernel
-        .build(ctx.inputSchema, Lists.newArrayList(hash_relation_expression), true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        hashRelationKernel
+          .build(ctx.inputSchema, Lists.newArrayList(hash_relation_expression), true)
+      }
       val hashRelationResultIterator = hashRelationKernel.finishByIterator()
       // we need to set original recordBatch to hashRelationKernel
       while (depIter.hasNext) {
@@ -42,7 +42,8 @@ class ColumnarDataSourceRDD(
     scanTime: SQLMetric,
     numInputBatches: SQLMetric,
     inputSize: SQLMetric,
-    tmp_dir: String)
+    tmp_dir: String,
+    rowBudget: Long = -1)
     extends RDD[ColumnarBatch](sc, Nil) {
 
   override protected def getPartitions: Array[Partition] = {
@@ -66,7 +67,7 @@ class ColumnarDataSourceRDD(
     val reader = if (columnarReads) {
       partitionReaderFactory match {
         case factory: ParquetPartitionReaderFactory =>
-          VectorizedFilePartitionReaderHandler.get(inputPartition, factory, tmp_dir)
+          VectorizedFilePartitionReaderHandler.get(inputPartition, factory, tmp_dir, rowBudget)
         case _ => partitionReaderFactory.createColumnarReader(inputPartition)
       }
     } else {
@@ -32,17 +32,24 @@ import org.apache.spark.sql.vectorized.{ColumnarBatch, ColumnVector}
 import org.apache.spark.sql.types.{StructField, StructType}
 import org.apache.spark.TaskContext
 import org.apache.spark.sql.execution.datasources.v2.arrow.SparkMemoryUtils
+import org.apache.arrow.gandiva.expression._
+import org.apache.arrow.vector.types.pojo.{ArrowType, Field}
+import com.google.common.collect.Lists
+
+import scala.collection.JavaConverters._
 
 case class ColumnarExpandExec(
     projections: Seq[Seq[Expression]],
     output: Seq[Attribute],
     child: SparkPlan)
-    extends UnaryExecNode {
+    extends UnaryExecNode
+    with ColumnarCodegenSupport {
   override lazy val metrics = Map(
     "numOutputRows" -> SQLMetrics.createMetric(sparkContext, "number of output rows"),
     "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches"),
     "numInputBatches" -> SQLMetrics.createMetric(sparkContext, "input_batches"),
-    "processTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_condproject"))
+    "processTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_condproject")) ++
+    GandivaCacheMetrics.create(sparkContext)
   // The GroupExpressions can output data with arbitrary partitioning, so set it
   // as UNKNOWN partitioning
   override def outputPartitioning: Partitioning = UnknownPartitioning(0)
@@ -51,63 +58,162 @@ case class ColumnarExpandExec(
 
   override def supportsColumnar = true
 
+  override def inputRDDs(): Seq[RDD[ColumnarBatch]] = child match {
+    case c: ColumnarCodegenSupport if c.supportColumnarCodegen == true =>
+      c.inputRDDs
+    case _ =>
+      Seq(child.executeColumnar())
+  }
+
+  override def getHashBuildPlans: Seq[SparkPlan] = child match {
+    case c: ColumnarCodegenSupport if c.supportColumnarCodegen == true =>
+      c.getHashBuildPlans
+    case _ =>
+      Seq()
+  }
+
+  override def supportColumnarCodegen: Boolean = true
+
+  override def canEqual(that: Any): Boolean = false
+
+  // expand(codegen_input_schema, codegen_project, codegen_project, ...), one project per
+  // grouping set. In the stage every input row loops over the projections.
+  def getKernelFunction(childTreeNode: TreeNode): TreeNode = {
+    val inputNodeList: List[TreeNode] = originalInputAttributes.toList.map(attr => {
+      val field = Field
+        .nullable(s"${attr.name}#${attr.exprId.id}", CodeGeneration.getResultType(attr.dataType))
+      TreeBuilder.makeField(field)
+    })
+    val input_node = TreeBuilder.makeFunction(
+      "codegen_input_schema",
+      inputNodeList.asJava,
+      new ArrowType.Int(32, true) /*dummy ret type, won't be used*/ )
+    val projectNodeList: List[TreeNode] = projections.toList.map(projection => {
+      val projectInputList: java.util.List[Field] = Lists.newArrayList()
+      val thisNodeList = projection.toList.map(expr => {
+        val columnarExpr = ColumnarExpressionConverter.replaceWithColumnarExpression(expr)
+        columnarExpr.asInstanceOf[ColumnarExpression].doColumnarCodeGen(projectInputList)._1
+      })
+      TreeBuilder.makeFunction(
+        "codegen_project",
+        thisNodeList.asJava,
+        new ArrowType.Int(32, true) /*dummy ret type, won't be used*/ )
+    })
+    val expandNode = TreeBuilder.makeFunction(
+      "expand",
+      (input_node :: projectNodeList).asJava,
+      new ArrowType.Int(32, true))
+    if (childTreeNode != null) {
+      TreeBuilder.makeFunction(
+        s"child",
+        Lists.newArrayList(expandNode, childTreeNode),
+        new ArrowType.Int(32, true))
+    } else {
+      TreeBuilder.makeFunction(
+        s"child",
+        Lists.newArrayList(expandNode),
+        new ArrowType.Int(32, true))
+    }
+  }
+
+  override def doCodeGen: ColumnarCodegenContext = {
+    val (childCtx, kernelFunction) = child match {
+      case c: ColumnarCodegenSupport if c.supportColumnarCodegen == true =>
+        val ctx = c.doCodeGen
+        (ctx, getKernelFunction(ctx.root))
+      case _ =>
+        (null, getKernelFunction(null))
+    }
+    val inputSchema = if (childCtx != null) { childCtx.inputSchema }
+    else { ConverterUtils.toArrowSchema(child.output) }
+    val outputSchema = ConverterUtils.toArrowSchema(output)
+    ColumnarCodegenContext(inputSchema, outputSchema, kernelFunction)
+  }
+
   protected override def doExecute(): RDD[InternalRow] =
     throw new UnsupportedOperationException("doExecute is not supported in ColumnarExpandExec.")
 
+  // standalone(Expand(projection(...), ...)), the native Expand kernel the exec runs
+  // outside a stage. Every input batch yields one batch per projection, input columns
+  // are passed through by reference.
+  def getExpandExpression: ExpressionTree = {
+    val projectionNodeList: List[TreeNode] = projections.toList.map(projection => {
+      val projectInputList: java.util.List[Field] = Lists.newArrayList()
+      val thisNodeList = projection.toList.map(expr => {
+        val columnarExpr = ColumnarExpressionConverter.replaceWithColumnarExpression(expr)
+        columnarExpr.asInstanceOf[ColumnarExpression].doColumnarCodeGen(projectInputList)._1
+      })
+      TreeBuilder.makeFunction(
+        "projection",
+        thisNodeList.asJava,
+        new ArrowType.Int(32, true) /*dummy ret type, won't be used*/ )
+    })
+    val expandNode = TreeBuilder.makeFunction(
+      "Expand",
+      projectionNodeList.asJava,
+      new ArrowType.Int(32, true) /*dummy ret type, won't be used*/ )
+    val standaloneNode = TreeBuilder.makeFunction(
+      "standalone",
+      Lists.newArrayList(expandNode),
+      new ArrowType.Int(32, true))
+    TreeBuilder.makeExpression(standaloneNode, Field.nullable("res", new ArrowType.Int(32, true)))
+  }
+
   protected override def doExecuteColumnar(): RDD[ColumnarBatch] = {
     val numOutputRows = longMetric("numOutputRows")
     val numOutputBatches = longMetric("numOutputBatches")
     val numInputBatches = longMetric("numInputBatches")
     val procTime = longMetric("processTime")
+    val inputSchema = ConverterUtils.toArrowSchema(originalInputAttributes)
+    val outputSchema = ConverterUtils.toArrowSchema(output)
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     child.executeColumnar().mapPartitions { iter =>
-      val columnarGroups =
-        projections.map(proj => ColumnarProjection.create(originalInputAttributes, proj))
+      val expander = new ExpressionEvaluator()
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        expander.build(
+          inputSchema,
+          Lists.newArrayList(getExpandExpression),
+          outputSchema,
+          true /*return at finish*/ )
+      }
+      // the kernel queues the expanded batches of each input, the iterator drains them
+      // before the next input batch is evaluated
+      val expandIterator = expander.finishByIterator()
       var eval_elapse: Long = 0
-      def close = procTime += (eval_elapse / 1000000)
+      def close = {
+        procTime += (eval_elapse / 1000000)
+        expandIterator.close()
+        expander.close()
+      }
       val res = new Iterator[ColumnarBatch] {
-        private[this] var result: ColumnarBatch = _
-        private[this] var idx = -1 // -1 means the initial state
-        private[this] var input: List[ValueVector] = _
-        private[this] var numRows: Int = 0
-        private[this] val numGroups = columnarGroups.length
-        private[this] val resultStructType =
-          StructType(output.map(a => StructField(a.name, a.dataType, a.nullable, a.metadata)))
-
-        override def hasNext: Boolean = (-1 < idx && idx < numGroups) || iter.hasNext
-
-        override def next(): ColumnarBatch = {
-          if (idx <= 0) {
-            // in the initial (-1) or beginning(0) of a new input row, fetch the next input tuple
+        override def hasNext: Boolean = {
+          while (!expandIterator.hasNext && iter.hasNext) {
             val input_cb = iter.next()
-            input = (0 until input_cb.numCols).toList
-              .map(input_cb.column(_).asInstanceOf[ArrowWritableColumnVector].getValueVector)
-            numRows = input_cb.numRows
             numInputBatches += 1
-            idx = 0
+            if (input_cb.numRows > 0) {
+              val beforeEval = System.nanoTime()
+              val input_batch = ConverterUtils.createArrowRecordBatch(input_cb)
+              expander.evaluate(input_batch)
+              ConverterUtils.releaseArrowRecordBatch(input_batch)
+              eval_elapse += System.nanoTime() - beforeEval
+            }
           }
+          expandIterator.hasNext
+        }
 
-          if (numRows == 0) {
-            idx = -1
-            numOutputBatches += 1
-            val resultColumnVectors =
-              ArrowWritableColumnVector.allocateColumns(0, resultStructType).toArray
-            return new ColumnarBatch(resultColumnVectors.map(_.asInstanceOf[ColumnVector]), 0)
-          }
+        override def next(): ColumnarBatch = {
           val beforeEval = System.nanoTime()
-          val resultColumnVectorList = columnarGroups(idx).evaluate(numRows, input)
-          result = new ColumnarBatch(
-            resultColumnVectorList.map(v => v.asInstanceOf[ColumnVector]).toArray,
-            numRows)
-          idx += 1
-
-          if (idx == numGroups) {
-            idx = -1
-          }
-
-          numOutputRows += numRows
-          numOutputBatches += 1
+          val output_batch = expandIterator.next()
+          val length = output_batch.getLength
+          val resultColumnVectorList =
+            ConverterUtils.fromArrowRecordBatch(outputSchema, output_batch)
+          ConverterUtils.releaseArrowRecordBatch(output_batch)
           eval_elapse += System.nanoTime() - beforeEval
-          result
+          numOutputRows += length
+          numOutputBatches += 1
+          new ColumnarBatch(
+            resultColumnVectorList.map(v => v.asInstanceOf[ColumnVector]).toArray,
+            length)
         }
       }
       SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit]((tc: TaskContext) => {
@@ -81,7 +81,8 @@ class ColumnarHashAggregateExec(
     "numInputBatches" -> SQLMetrics.createMetric(sparkContext, "input_batches"),
     "aggTime" -> SQLMetrics.createTimingMetric(sparkContext, "time in aggregation process"),
     "totalTime" -> SQLMetrics
-      .createTimingMetric(sparkContext, "totaltime_hashagg"))
+      .createTimingMetric(sparkContext, "totaltime_hashagg")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val numOutputRows = longMetric("numOutputRows")
   val numOutputBatches = longMetric("numOutputBatches")
@@ -92,10 +93,23 @@ class ColumnarHashAggregateExec(
   numOutputBatches.set(0)
   numInputBatches.set(0)
 
+  // Decimal aggregates without a native action fall back when planned.
+  aggregateExpressions
+    .filter(expr =>
+      (expr.aggregateFunction.children :+ expr.aggregateFunction)
+        .exists(_.dataType.isInstanceOf[DecimalType]))
+    .foreach(expr => ColumnarAggregation.checkDecimalSupported(groupingExpressions, expr))
+
+  // The codegen hash aggregate has no decimal support, decimal sum and avg run
+  // through the split action aggregation instead.
+  val useCodegenHashAggregate: Boolean =
+    ColumnarPluginConfig.getConf(sparkConf).enableCodegenHashAggregate &&
+      groupingExpressions.nonEmpty &&
+      !child.output.exists(_.dataType.isInstanceOf[DecimalType]) &&
+      !aggregateAttributes.exists(_.dataType.isInstanceOf[DecimalType])
+
   val (listJars, signature): (Seq[String], String) =
-    if (ColumnarPluginConfig
-          .getConf(sparkConf)
-          .enableCodegenHashAggregate && groupingExpressions.nonEmpty) {
+    if (useCodegenHashAggregate) {
       var signature: String = ""
       try {
         signature = ColumnarGroupbyHashAggregation.prebuild(
@@ -135,6 +149,7 @@ class ColumnarHashAggregateExec(
   listJars.foreach(jar => logInfo(s"Uploaded ${jar}"))
 
   override def doExecuteColumnar(): RDD[ColumnarBatch] = {
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     child.executeColumnar().mapPartitionsWithIndex { (partIndex, iter) =>
       val hasInput = iter.hasNext
       val res = if (!hasInput) {
@@ -142,9 +157,7 @@ class ColumnarHashAggregateExec(
         // so return an empty iterator.
         Iterator.empty
       } else {
-        if (ColumnarPluginConfig
-              .getConf(sparkConf)
-              .enableCodegenHashAggregate && groupingExpressions.nonEmpty) {
+        if (useCodegenHashAggregate) {
           val execTempDir = ColumnarPluginConfig.getTempFile
           val jarList = listJars
             .map(jarUrl => {
@@ -156,43 +169,49 @@ class ColumnarHashAggregateExec(
                 sparkConf)
               s"${execTempDir}/spark-columnar-plugin-codegen-precompile-${signature}.jar"
             })
-          val aggregation = ColumnarGroupbyHashAggregation.create(
-            groupingExpressions,
-            child.output,
-            aggregateExpressions,
-            aggregateAttributes,
-            resultExpressions,
-            output,
-            jarList,
-            numInputBatches,
-            numOutputBatches,
-            numOutputRows,
-            aggTime,
-            totalTime,
-            sparkConf)
+          val aggregation = GandivaCacheMetrics.track(gandivaCacheMetrics) {
+            ColumnarGroupbyHashAggregation.create(
+              groupingExpressions,
+              child.output,
+              aggregateExpressions,
+              aggregateAttributes,
+              resultExpressions,
+              output,
+              jarList,
+              numInputBatches,
+              numOutputBatches,
+              numOutputRows,
+              aggTime,
+              totalTime,
+              sparkConf)
+          }
           SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => {
               aggregation.close()
             })
-          new CloseableColumnBatchIterator(aggregation.createIterator(iter))
+          new CloseableColumnBatchIterator(GandivaCacheMetrics
+            .trackIterator(gandivaCacheMetrics, aggregation.createIterator(iter)))
         } else {
-          var aggregation = ColumnarAggregation.create(
-            partIndex,
-            groupingExpressions,
-            child.output,
-            aggregateExpressions,
-            aggregateAttributes,
-            resultExpressions,
-            output,
-            numInputBatches,
-            numOutputBatches,
-            numOutputRows,
-            aggTime,
-            totalTime,
-            sparkConf)
+          var aggregation = GandivaCacheMetrics.track(gandivaCacheMetrics) {
+            ColumnarAggregation.create(
+              partIndex,
+              groupingExpressions,
+              child.output,
+              aggregateExpressions,
+              aggregateAttributes,
+              resultExpressions,
+              output,
+              numInputBatches,
+              numOutputBatches,
+              numOutputRows,
+              aggTime,
+              totalTime,
+              sparkConf)
+          }
           SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => {
               aggregation.close()
             })
-          new CloseableColumnBatchIterator(aggregation.createIterator(iter))
+          new CloseableColumnBatchIterator(GandivaCacheMetrics
+            .trackIterator(gandivaCacheMetrics, aggregation.createIterator(iter)))
         }
       }
       res
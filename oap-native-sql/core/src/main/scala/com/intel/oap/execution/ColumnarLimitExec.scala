@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.execution
+
+import com.intel.oap.vectorized.ArrowWritableColumnVector
+import org.apache.spark.rdd.RDD
+import org.apache.spark.sql.catalyst.InternalRow
+import org.apache.spark.sql.catalyst.expressions.{Attribute, SortOrder}
+import org.apache.spark.sql.catalyst.plans.physical.{AllTuples, Distribution, Partitioning}
+import org.apache.spark.sql.execution.{LimitExec, SparkPlan}
+import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
+import org.apache.spark.sql.vectorized.ColumnarBatch
+
+/**
+ * A columnar plan able to stop its partitions after a number of rows. The native
+ * operators behind it get the rows as a row budget, so they stop early, truncate their
+ * last batch and release what they hold instead of producing rows a limit drops.
+ */
+trait ColumnarRowBudgetSupport extends SparkPlan {
+
+  /** Same as executeColumnar, except that each partition yields at most rows rows. */
+  final def executeColumnarWithRowBudget(rows: Int): RDD[ColumnarBatch] = executeQuery {
+    doExecuteColumnarWithRowBudget(rows)
+  }
+
+  protected def doExecuteColumnarWithRowBudget(rows: Int): RDD[ColumnarBatch]
+}
+
+/**
+ * Takes the first limit rows of each partition. Children supporting a row budget are
+ * asked to stop there, others are cut here: the last batch is truncated and the child
+ * is not pulled any more.
+ */
+trait ColumnarBaseLimitExec extends LimitExec {
+
+  override def output: Seq[Attribute] = child.output
+
+  override def supportsColumnar: Boolean = true
+
+  override lazy val metrics: Map[String, SQLMetric] = Map(
+    "numOutputRows" -> SQLMetrics.createMetric(sparkContext, "number of output rows"),
+    "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches"))
+
+  protected override def doExecute(): RDD[InternalRow] =
+    throw new UnsupportedOperationException(s"doExecute is not supported in $nodeName.")
+
+  protected override def doExecuteColumnar(): RDD[ColumnarBatch] = {
+    val numOutputRows = longMetric("numOutputRows")
+    val numOutputBatches = longMetric("numOutputBatches")
+    val rowLimit = limit
+    val input = child match {
+      case c: ColumnarRowBudgetSupport => c.executeColumnarWithRowBudget(rowLimit)
+      case _ => child.executeColumnar()
+    }
+    input.mapPartitions { iter =>
+      new Iterator[ColumnarBatch] {
+        private var remaining = rowLimit
+
+        override def hasNext: Boolean = remaining > 0 && iter.hasNext
+
+        override def next(): ColumnarBatch = {
+          val cb = iter.next()
+          if (cb.numRows > remaining) {
+            ColumnarBaseLimitExec.truncate(cb, remaining)
+          }
+          remaining -= cb.numRows
+          numOutputRows += cb.numRows
+          numOutputBatches += 1
+          cb
+        }
+      }
+    }
+  }
+}
+
+object ColumnarBaseLimitExec {
+
+  /** Keeps the first rows rows of cb, the arrow vectors are shortened in place. */
+  def truncate(cb: ColumnarBatch, rows: Int): Unit = {
+    (0 until cb.numCols).foreach { i =>
+      cb.column(i) match {
+        case v: ArrowWritableColumnVector => v.getValueVector.setValueCount(rows)
+        case _ =>
+      }
+    }
+    cb.setNumRows(rows)
+  }
+}
+
+case class ColumnarLocalLimitExec(limit: Int, child: SparkPlan)
+    extends ColumnarBaseLimitExec {
+
+  override def outputPartitioning: Partitioning = child.outputPartitioning
+
+  override def outputOrdering: Seq[SortOrder] = child.outputOrdering
+}
+
+case class ColumnarGlobalLimitExec(limit: Int, child: SparkPlan)
+    extends ColumnarBaseLimitExec {
+
+  override def requiredChildDistribution: List[Distribution] = AllTuples :: Nil
+
+  override def outputPartitioning: Partitioning = child.outputPartitioning
+
+  override def outputOrdering: Seq[SortOrder] = child.outputOrdering
+}
@@ -75,7 +75,8 @@ case class ColumnarShuffledHashJoinExec(
     "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "number of output batches"),
     "processTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_hashjoin"),
     "buildTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to build hash map"),
-    "joinTime" -> SQLMetrics.createTimingMetric(sparkContext, "join time"))
+    "joinTime" -> SQLMetrics.createTimingMetric(sparkContext, "join time")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val (buildKeyExprs, streamedKeyExprs) = {
     require(
@@ -192,6 +193,7 @@ case class ColumnarShuffledHashJoinExec(
     val totalTime = longMetric("processTime")
     val buildTime = longMetric("buildTime")
     val joinTime = longMetric("joinTime")
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
 
     var build_elapse: Long = 0
     var eval_elapse: Long = 0
@@ -208,8 +210,10 @@ case class ColumnarShuffledHashJoinExec(
         TreeBuilder.makeExpression(
           hash_relation_function,
           Field.nullable("result", new ArrowType.Int(32, true)))
-      hashRelationKernel
-        .build(hash_relation_schema, Lists.newArrayList(hash_relation_expr), true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        hashRelationKernel
+          .build(hash_relation_schema, Lists.newArrayList(hash_relation_expr), true)
+      }
       while (depIter.hasNext) {
         val dep_cb = depIter.next()
         (0 until dep_cb.numCols).toList.foreach(i =>
@@ -233,8 +237,10 @@ case class ColumnarShuffledHashJoinExec(
       val probe_input_schema = ConverterUtils.toArrowSchema(streamedPlan.output)
       val probe_out_schema = ConverterUtils.toArrowSchema(output)
       val nativeKernel = new ExpressionEvaluator()
-      nativeKernel
-        .build(probe_input_schema, Lists.newArrayList(probe_expr), probe_out_schema, true)
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        nativeKernel
+          .build(probe_input_schema, Lists.newArrayList(probe_expr), probe_out_schema, true)
+      }
       val nativeIterator = nativeKernel.finishByIterator()
       // we need to complete dependency RDD's firstly
       nativeIterator.setDependencies(Array(hashRelationResultIterator))
@@ -395,6 +401,7 @@ case class ColumnarShuffledHashJoinExec(
     val totalTime = longMetric("processTime")
     val buildTime = longMetric("buildTime")
     val joinTime = longMetric("joinTime")
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
 
     var build_elapse: Long = 0
     var eval_elapse: Long = 0
@@ -424,8 +431,10 @@ case class ColumnarShuffledHashJoinExec(
             TreeBuilder
               .makeExpression(resCtx.root, Field.nullable("result", new ArrowType.Int(32, true)))
           val nativeKernel = new ExpressionEvaluator(jarList.toList.asJava)
-          nativeKernel
-            .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
+          GandivaCacheMetrics.track(gandivaCacheMetrics) {
+            nativeKernel
+              .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
+          }
 
           // received broadcast value contain a hashmap and raw recordBatch
           val beforeEval = System.nanoTime()
@@ -433,8 +442,10 @@ case class ColumnarShuffledHashJoinExec(
           val hashRelationKernel = new ExpressionEvaluator()
           val hash_relation_expression = TreeBuilder
             .makeExpression(ctx.root, Field.nullable("result", new ArrowType.Int(32, true)))
-          hashRelationKernel
-            .build(ctx.inputSchema, Lists.newArrayList(hash_relation_expression), true)
+          GandivaCacheMetrics.track(gandivaCacheMetrics) {
+            hashRelationKernel
+              .build(ctx.inputSchema, Lists.newArrayList(hash_relation_expression), true)
+          }
           // we need to set original recordBatch to hashRelationKernel
           while (buildIter.hasNext) {
             val dep_cb = buildIter.next()
@@ -520,25 +531,29 @@ case class ColumnarShuffledHashJoinExec(
                 sparkConf)
               s"${execTempDir}/spark-columnar-plugin-codegen-precompile-${signature}.jar"
             })
-          val vjoin = ColumnarShuffledHashJoin.create(
-            leftKeys,
-            rightKeys,
-            getResultSchema,
-            joinType,
-            buildSide,
-            condition,
-            left,
-            right,
-            jarList,
-            buildTime,
-            joinTime,
-            totalTime,
-            numOutputRows,
-            sparkConf)
+          val vjoin = GandivaCacheMetrics.track(gandivaCacheMetrics) {
+            ColumnarShuffledHashJoin.create(
+              leftKeys,
+              rightKeys,
+              getResultSchema,
+              joinType,
+              buildSide,
+              condition,
+              left,
+              right,
+              jarList,
+              buildTime,
+              joinTime,
+              totalTime,
+              numOutputRows,
+              sparkConf)
+          }
           SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => {
             vjoin.close()
           })
-          val vjoinResult = vjoin.columnarJoin(streamIter, buildIter)
+          val vjoinResult = GandivaCacheMetrics.trackIterator(
+            gandivaCacheMetrics,
+            vjoin.columnarJoin(streamIter, buildIter))
           new CloseableColumnBatchIterator(vjoinResult)
       }
     }
@@ -57,7 +57,8 @@ class ColumnarSortExec(
     "sortTime" -> SQLMetrics.createTimingMetric(sparkContext, "time in sort process"),
     "shuffleTime" -> SQLMetrics.createTimingMetric(sparkContext, "time in shuffle process"),
     "numOutputRows" -> SQLMetrics.createMetric(sparkContext, "number of output rows"),
-    "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches"))
+    "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val elapse = longMetric("totalSortTime")
   val sortTime = longMetric("sortTime")
@@ -101,6 +102,7 @@ class ColumnarSortExec(
     val signature = getCodeGenSignature
     val listJars = uploadAndListJars(signature)
     listJars.foreach(jar => logInfo(s"Uploaded ${jar}"))
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     child.executeColumnar().mapPartitions { iter =>
       val hasInput = iter.hasNext
       val res = if (!hasInput) {
@@ -118,21 +120,24 @@ class ColumnarSortExec(
               sparkConf)
             s"${execTempDir}/spark-columnar-plugin-codegen-precompile-${signature}.jar"
           })
-        val sorter = ColumnarSorter.create(
-          sortOrder,
-          true,
-          child.output,
-          jarList,
-          sortTime,
-          numOutputBatches,
-          numOutputRows,
-          shuffleTime,
-          elapse,
-          sparkConf)
+        val sorter = GandivaCacheMetrics.track(gandivaCacheMetrics) {
+          ColumnarSorter.create(
+            sortOrder,
+            true,
+            child.output,
+            jarList,
+            sortTime,
+            numOutputBatches,
+            numOutputRows,
+            shuffleTime,
+            elapse,
+            sparkConf)
+        }
         SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => {
             sorter.close()
           })
-        new CloseableColumnBatchIterator(sorter.createColumnarIterator(iter))
+        new CloseableColumnBatchIterator(GandivaCacheMetrics
+          .trackIterator(gandivaCacheMetrics, sorter.createColumnarIterator(iter)))
       }
       res
     }
@@ -72,7 +72,8 @@ class ColumnarSortMergeJoinExec(
     "numOutputRows" -> SQLMetrics.createMetric(sparkContext, "number of output rows"),
     "prepareTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to prepare left list"),
     "joinTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to merge join"),
-    "totaltime_sortmergejoin" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_sortmergejoin"))
+    "totaltime_sortmergejoin" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_sortmergejoin")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val numOutputRows = longMetric("numOutputRows")
   val joinTime = longMetric("joinTime")
@@ -122,6 +123,7 @@ class ColumnarSortMergeJoinExec(
   listJars.foreach(jar => logInfo(s"Uploaded ${jar}"))
 
   override def doExecuteColumnar(): RDD[ColumnarBatch] = {
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     right.executeColumnar().zipPartitions(left.executeColumnar()) {
       (streamIter, buildIter) =>
         ColumnarPluginConfig.getConf(sparkConf)
@@ -137,11 +139,15 @@ class ColumnarSortMergeJoinExec(
             s"${execTempDir}/spark-columnar-plugin-codegen-precompile-${signature}.jar"
           })
 
-        val vsmj = ColumnarSortMergeJoin.create(leftKeys, rightKeys, resultSchema, joinType, 
+        val vsmj = GandivaCacheMetrics.track(gandivaCacheMetrics) {
+          ColumnarSortMergeJoin.create(leftKeys, rightKeys, resultSchema, joinType,
             condition, left, right, isSkewJoin, jarList, joinTime, prepareTime, totaltime_sortmegejoin, numOutputRows, sparkConf)
+        }
         SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => {
         vsmj.close() })
-        val vjoinResult = vsmj.columnarJoin(streamIter, buildIter)
+        val vjoinResult = GandivaCacheMetrics.trackIterator(
+          gandivaCacheMetrics,
+          vsmj.columnarJoin(streamIter, buildIter))
         new CloseableColumnBatchIterator(vjoinResult)
     }
   }
@@ -71,14 +71,30 @@ trait ColumnarCodegenSupport extends SparkPlan {
 
 case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: Int)
     extends UnaryExecNode
-    with ColumnarCodegenSupport {
+    with ColumnarCodegenSupport
+    with ColumnarRowBudgetSupport {
   val sparkConf = sparkContext.getConf
 
   override lazy val metrics = Map(
     "numOutputRows" -> SQLMetrics.createMetric(sparkContext, "number of output rows"),
     "totalTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_wholestagecodegen"),
     "buildTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to build dependencies"),
-    "pipelineTime" -> SQLMetrics.createTimingMetric(sparkContext, "duration"))
+    "pipelineTime" -> SQLMetrics.createTimingMetric(sparkContext, "duration"),
+    "planCacheHits" -> SQLMetrics.createMetric(sparkContext, "plan cache hits"),
+    "planCacheMisses" -> SQLMetrics.createMetric(sparkContext, "plan cache misses"),
+    "planCacheSavedTime" ->
+      SQLMetrics.createNanoTimingMetric(sparkContext, "time saved by plan cache"),
+    "libraryHits" -> SQLMetrics.createMetric(sparkContext, "codegen libraries reused"),
+    "libraryMisses" -> SQLMetrics.createMetric(sparkContext, "codegen libraries loaded")) ++
+    GandivaCacheMetrics.create(sparkContext)
+
+  // metrics fed by nativeGetBuildCacheMetrics, in the order it returns them
+  val buildCacheMetricNames = Seq(
+    "planCacheHits",
+    "planCacheMisses",
+    "planCacheSavedTime",
+    "libraryHits",
+    "libraryMisses")
 
   override def output: Seq[Attribute] = child.output
 
@@ -183,7 +199,10 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
   override def doExecute(): RDD[InternalRow] = {
     throw new UnsupportedOperationException
   }
-  override def doExecuteColumnar(): RDD[ColumnarBatch] = {
+  override def doExecuteColumnar(): RDD[ColumnarBatch] = doExecuteColumnarWithRowBudget(-1)
+
+  // a negative budget means no limit
+  override protected def doExecuteColumnarWithRowBudget(rows: Int): RDD[ColumnarBatch] = {
     val signature = doBuild
     val listJars = uploadAndListJars(signature)
 
@@ -191,6 +210,8 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
     val numOutputBatches = child.longMetric("numOutputBatches")
     val totalTime = child.longMetric("processTime")
     val pipelineTime = longMetric("pipelineTime")
+    val buildCacheMetrics = buildCacheMetricNames.map(longMetric)
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     val timeout = ColumnarPluginConfig.getConf(sparkConf).broadcastCacheTimeout
 
     var build_elapse: Long = 0
@@ -230,8 +251,10 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
                 ctx.root,
                 Field.nullable("result", new ArrowType.Int(32, true)))
             val hashRelationKernel = new ExpressionEvaluator()
-            hashRelationKernel
-              .build(ctx.inputSchema, Lists.newArrayList(expression), true)
+            GandivaCacheMetrics.track(gandivaCacheMetrics) {
+              hashRelationKernel
+                .build(ctx.inputSchema, Lists.newArrayList(expression), true)
+            }
             val hashRelationResultIterator = hashRelationKernel.finishByIterator()
             dependentKernelIterators += hashRelationResultIterator
             // we need to set original recordBatch to hashRelationKernel
@@ -263,8 +286,10 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
                 ctx.root,
                 Field.nullable("result", new ArrowType.Int(32, true)))
             val hashRelationKernel = new ExpressionEvaluator()
-            hashRelationKernel
-              .build(ctx.inputSchema, Lists.newArrayList(expression), true)
+            GandivaCacheMetrics.track(gandivaCacheMetrics) {
+              hashRelationKernel
+                .build(ctx.inputSchema, Lists.newArrayList(expression), true)
+            }
             var build_elapse_internal: Long = 0
             while (depIter.hasNext) {
               val dep_cb = depIter.next()
@@ -309,11 +334,23 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
           resCtx.root,
           Field.nullable("result", new ArrowType.Int(32, true)))
       val nativeKernel = new ExpressionEvaluator(jarList.toList.asJava)
-      nativeKernel
-        .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
-      val nativeIterator = nativeKernel.finishByIterator()
+      // the caches are shared by the executor, builds of concurrent tasks may show up in
+      // the difference as well
+      val cacheMetricsBefore = nativeKernel.getBuildCacheMetrics
+      GandivaCacheMetrics.track(gandivaCacheMetrics) {
+        nativeKernel
+          .build(resCtx.inputSchema, Lists.newArrayList(expression), resCtx.outputSchema, true)
+      }
+      val cacheMetricsAfter = nativeKernel.getBuildCacheMetrics
+      buildCacheMetrics.zipWithIndex.foreach {
+        case (metric, i) => metric += cacheMetricsAfter(i) - cacheMetricsBefore(i)
+      }
+      val kernelIterator = nativeKernel.finishByIterator()
       // we need to complete dependency RDD's firstly
-      nativeIterator.setDependencies(dependentKernelIterators.toArray)
+      kernelIterator.setDependencies(dependentKernelIterators.toArray)
+      // the native limit hands the budget to the stage, which stops its row loop there
+      // and releases its hash relations once the budget is met
+      val nativeIterator = if (rows >= 0) kernelIterator.limit(rows) else kernelIterator
 
       var closed = false
       def close = {
@@ -325,6 +362,7 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
         dependentKernelIterators.foreach(_.close)
         nativeKernel.close
         nativeIterator.close
+        kernelIterator.close
         relationHolder.foreach(r => r.countDownClose(timeout))
       }
 
@@ -332,7 +370,7 @@ case class ColumnarWholeStageCodegenExec(child: SparkPlan)(val codegenStageId: I
       val resultStructType = ArrowUtils.fromArrowSchema(resCtx.outputSchema)
       val res = new Iterator[ColumnarBatch] {
         override def hasNext: Boolean = {
-          iter.hasNext
+          (rows < 0 || !nativeIterator.budgetExhausted) && iter.hasNext
         }
 
         override def next(): ColumnarBatch = {
@@ -58,7 +58,8 @@ class ColumnarWindowExec(windowExpression: Seq[NamedExpression],
     "numOutputBatches" -> SQLMetrics.createMetric(sparkContext, "output_batches"),
     "numInputBatches" -> SQLMetrics.createMetric(sparkContext, "input_batches"),
     "totalTime" -> SQLMetrics
-        .createTimingMetric(sparkContext, "totaltime_window"))
+        .createTimingMetric(sparkContext, "totaltime_window")) ++
+    GandivaCacheMetrics.create(sparkContext)
 
   val numOutputRows = longMetric("numOutputRows")
   val numOutputBatches = longMetric("numOutputBatches")
@@ -115,6 +116,7 @@ class ColumnarWindowExec(windowExpression: Seq[NamedExpression],
   }
 
   override protected def doExecuteColumnar(): RDD[ColumnarBatch] = {
+    val gandivaCacheMetrics = GandivaCacheMetrics.of(this)
     child.executeColumnar().mapPartitionsWithIndex { (partIndex, iter) =>
       if (!iter.hasNext) {
         Iterator.empty
@@ -161,9 +163,11 @@ class ColumnarWindowExec(windowExpression: Seq[NamedExpression],
         val evaluator = new ExpressionEvaluator()
         val resultSchema = new Schema(resultField.getChildren)
         val arrowSchema = ArrowUtils.toArrowSchema(child.schema, SQLConf.get.sessionLocalTimeZone)
-        evaluator.build(arrowSchema,
-          List(TreeBuilder.makeExpression(window,
-            resultField)).asJava, resultSchema, true)
+        GandivaCacheMetrics.track(gandivaCacheMetrics) {
+          evaluator.build(arrowSchema,
+            List(TreeBuilder.makeExpression(window,
+              resultField)).asJava, resultSchema, true)
+        }
         val inputCache = new ListBuffer[ColumnarBatch]()
         val buildCost = System.nanoTime() - prev1
         totalTime += TimeUnit.NANOSECONDS.toMillis(buildCost)
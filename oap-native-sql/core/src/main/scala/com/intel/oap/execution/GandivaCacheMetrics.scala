@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.execution
+
+import com.intel.oap.vectorized.ExpressionEvaluator
+import org.apache.spark.SparkContext
+import org.apache.spark.sql.execution.SparkPlan
+import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
+
+/**
+ * SQL metrics of the gandiva registry lookups an operator makes. The native side counts
+ * the lookups of each thread, an operator diffs the counters of its task thread around
+ * the code building its kernels. The lookups of operators pulled from inside a tracked
+ * call, which track their own, are left out, so that each lookup is reported once.
+ */
+object GandivaCacheMetrics {
+
+  // in the order of ExpressionEvaluator.getGandivaCacheMetrics
+  val names = Seq(
+    "gandivaCacheHits",
+    "gandivaCacheMisses",
+    "gandivaCacheSavedTime",
+    "gandivaCacheEvictions",
+    "gandivaCacheEntries")
+
+  def create(sparkContext: SparkContext): Map[String, SQLMetric] = Map(
+    "gandivaCacheHits" -> SQLMetrics.createMetric(sparkContext, "gandiva cache hits"),
+    "gandivaCacheMisses" -> SQLMetrics.createMetric(sparkContext, "gandiva cache misses"),
+    "gandivaCacheSavedTime" ->
+      SQLMetrics.createNanoTimingMetric(sparkContext, "time saved by gandiva cache"),
+    "gandivaCacheEvictions" ->
+      SQLMetrics.createMetric(sparkContext, "gandiva cache evictions"),
+    "gandivaCacheEntries" ->
+      SQLMetrics.createMetric(sparkContext, "gandiva cache entries added"))
+
+  /** The metrics made by create, picked out of the metrics of plan. */
+  def of(plan: SparkPlan): Map[String, SQLMetric] =
+    names.map(name => name -> plan.longMetric(name)).toMap
+
+  // lookups of the thread already reported by the tracked calls it ran
+  private val reported = new ThreadLocal[Array[Long]] {
+    override def initialValue(): Array[Long] = new Array[Long](names.length)
+  }
+
+  /** Runs body, adding the lookups it made to those of metrics it holds. */
+  def track[T](metrics: Map[String, SQLMetric])(body: => T): T = {
+    val before = ExpressionEvaluator.getGandivaCacheMetrics
+    val reportedBefore = reported.get.clone
+    try {
+      body
+    } finally {
+      val after = ExpressionEvaluator.getGandivaCacheMetrics
+      val reportedNow = reported.get
+      names.zipWithIndex.foreach {
+        case (name, i) =>
+          val lookups = after(i) - before(i)
+          metrics.get(name).foreach(_ += lookups - (reportedNow(i) - reportedBefore(i)))
+          reportedNow(i) = reportedBefore(i) + lookups
+      }
+    }
+  }
+
+  /** Tracks the kernels built lazily while the iterator is pulled. */
+  def trackIterator[T](metrics: Map[String, SQLMetric], iter: Iterator[T]): Iterator[T] =
+    new Iterator[T] {
+      override def hasNext: Boolean = track(metrics)(iter.hasNext)
+
+      override def next(): T = track(metrics)(iter.next())
+    }
+}
@@ -17,7 +17,10 @@
 
 package com.intel.oap.execution
 
+import com.intel.oap.ColumnarPluginConfig
+import com.intel.oap.expression.ConverterUtils
 import com.intel.oap.vectorized._
+import io.netty.buffer.ArrowBuf
 
 import java.util.concurrent.TimeUnit._
 import scala.collection.JavaConverters._
@@ -25,7 +28,7 @@ import scala.collection.JavaConverters._
 import org.apache.spark.{broadcast, TaskContext}
 import org.apache.spark.rdd.RDD
 import org.apache.spark.sql.catalyst.InternalRow
-import org.apache.spark.sql.catalyst.expressions.{Attribute, SortOrder, SpecializedGetters, UnsafeProjection}
+import org.apache.spark.sql.catalyst.expressions.{Attribute, SortOrder, SpecializedGetters, UnsafeProjection, UnsafeRow}
 import org.apache.spark.sql.catalyst.expressions.codegen._
 import org.apache.spark.sql.catalyst.expressions.codegen.Block._
 import org.apache.spark.sql.catalyst.plans.physical.Partitioning
@@ -33,10 +36,12 @@ import org.apache.spark.sql.catalyst.rules.Rule
 import org.apache.spark.sql.execution._
 import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
 import org.apache.spark.sql.execution.RowToColumnarExec
+import org.apache.spark.sql.execution.datasources.v2.arrow.SparkMemoryUtils
 import org.apache.spark.sql.execution.vectorized.{OffHeapColumnVector, OnHeapColumnVector, WritableColumnVector}
 import org.apache.spark.sql.internal.SQLConf
 import org.apache.spark.sql.types._
 import org.apache.spark.sql.vectorized.{ColumnarBatch, ColumnVector}
+import org.apache.spark.unsafe.Platform
 
 class RowToColumnConverter(schema: StructType) extends Serializable {
   private val converters = schema.fields.map {
@@ -217,6 +222,87 @@ object RowToColumnConverter {
   }
 }
 
+/**
+ * Converts rows to arrow batches in native code. The rows of a batch are copied as
+ * UnsafeRows into one off-heap buffer, which ArrowRowToColumnarJniWrapper reads a column
+ * at a time. The buffer is reused by the following batches.
+ */
+class NativeRowToColumnConverter(schema: StructType) extends AutoCloseable {
+  private val arrowSchema = ConverterUtils.toArrowSchema(schema)
+  private val schemaBuf = ConverterUtils.getSchemaBytesBuf(arrowSchema)
+  private val jniWrapper = new ArrowRowToColumnarJniWrapper()
+  private val memoryPool = ExpressionMemoryPool.forSpark()
+  private val allocator = ArrowWritableColumnVector.getAllocator
+  private val toUnsafe = UnsafeProjection.create(schema)
+  private var buffer: ArrowBuf = null
+
+  /** Converts the next maxRows rows of rowIterator, or all it has left. */
+  def convert(rowIterator: Iterator[InternalRow], maxRows: Int): ColumnarBatch = {
+    val rowOffsets = new Array[Long](maxRows)
+    var rowCount = 0
+    var bufferSize = 0L
+    while (rowCount < maxRows && rowIterator.hasNext) {
+      val row = rowIterator.next() match {
+        case unsafe: UnsafeRow => unsafe
+        case other => toUnsafe(other)
+      }
+      reserve(bufferSize, row.getSizeInBytes)
+      row.writeToMemory(null, buffer.memoryAddress + bufferSize)
+      rowOffsets(rowCount) = bufferSize
+      bufferSize += row.getSizeInBytes
+      rowCount += 1
+    }
+    val offsets =
+      if (rowCount == maxRows) rowOffsets else java.util.Arrays.copyOf(rowOffsets, rowCount)
+    val address = if (buffer == null) 0L else buffer.memoryAddress
+    val recordBatch = new ArrowRecordBatchBuilderImpl(
+      jniWrapper.nativeConvertRowToColumnar(
+        schemaBuf,
+        offsets,
+        address,
+        memoryPool.getNativeInstanceId)).build()
+    val vectors = ConverterUtils.fromArrowRecordBatch(arrowSchema, recordBatch)
+    ConverterUtils.releaseArrowRecordBatch(recordBatch)
+    new ColumnarBatch(vectors.map(_.asInstanceOf[ColumnVector]), rowCount)
+  }
+
+  // makes room for size more bytes after the used ones, which are kept
+  private def reserve(used: Long, size: Long): Unit = {
+    if (buffer != null && used + size <= buffer.capacity) {
+      return
+    }
+    val capacity = if (buffer == null) 0L else buffer.capacity
+    val grown = allocator.buffer(math.max(used + size, 2 * capacity))
+    if (buffer != null) {
+      Platform.copyMemory(null, buffer.memoryAddress, null, grown.memoryAddress, used)
+      buffer.close()
+    }
+    buffer = grown
+  }
+
+  // the batches hold memory of the pool, it is released when the task completes
+  override def close(): Unit = {
+    if (buffer != null) {
+      buffer.close()
+      buffer = null
+    }
+  }
+}
+
+object NativeRowToColumnConverter {
+
+  /** Whether the native converter reads every field of schema. */
+  def supports(schema: StructType): Boolean = schema.fields.forall { f =>
+    f.dataType match {
+      case BooleanType | ByteType | ShortType | IntegerType | LongType | FloatType |
+          DoubleType | DateType | TimestampType | StringType | BinaryType |
+          _: DecimalType =>
+        true
+      case _ => false
+    }
+  }
+}
+
 /**
  * Provides a common executor to translate an [[RDD]] of [[InternalRow]] into an [[RDD]] of
  * [[ColumnarBatch]]. This is inserted whenever such a transition is determined to be needed.
@@ -267,8 +353,26 @@ case class RowToArrowColumnarExec(child: SparkPlan) extends UnaryExecNode {
     // This avoids calling `schema` in the RDD closure, so that we don't need to include the entire
     // plan (this) in the closure.
     val localSchema = this.schema
+    val nativeConversion = ColumnarPluginConfig.getConf(sparkContext.getConf)
+      .enableNativeRowToColumnar && NativeRowToColumnConverter.supports(localSchema)
     child.execute().mapPartitions { rowIterator =>
-      if (rowIterator.hasNext) {
+      if (rowIterator.hasNext && nativeConversion) {
+        val converter = new NativeRowToColumnConverter(localSchema)
+        SparkMemoryUtils.addLeakSafeTaskCompletionListener[Unit](_ => converter.close())
+        val res = new Iterator[ColumnarBatch] {
+          override def hasNext: Boolean = rowIterator.hasNext
+
+          override def next(): ColumnarBatch = {
+            val start = System.nanoTime()
+            val cb = converter.convert(rowIterator, numRows)
+            processTime += NANOSECONDS.toMillis(System.nanoTime() - start)
+            numInputRows += cb.numRows
+            numOutputBatches += 1
+            cb
+          }
+        }
+        new CloseableColumnBatchIterator(res)
+      } else if (rowIterator.hasNext) {
         val res = new Iterator[ColumnarBatch] {
           private val converters = new RowToColumnConverter(localSchema)
           private var last_cb: ColumnarBatch = null
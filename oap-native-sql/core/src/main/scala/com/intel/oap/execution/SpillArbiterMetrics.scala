@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.execution
+
+import com.intel.oap.vectorized.ExpressionMemoryPool
+import org.apache.spark.SparkContext
+import org.apache.spark.sql.execution.SparkPlan
+import org.apache.spark.sql.execution.metric.{SQLMetric, SQLMetrics}
+
+/**
+ * SQL metrics of the native spill arbiter of a task. The arbiter counts the failed
+ * reservations it was asked to reclaim memory for, and the spills and reclaimed bytes
+ * of each kind of spillable operator. An operator reports its own spills once it is
+ * done with its memory pool. The triggers are counted for the whole task, only the
+ * operator ending the task reports them.
+ */
+object SpillArbiterMetrics {
+
+  // in the order of ExpressionMemoryPool.getSpillMetrics
+  val names = Seq("spillTriggers", "arbitratedSpills", "bytesReclaimed")
+
+  def create(sparkContext: SparkContext): Map[String, SQLMetric] = Map(
+    "spillTriggers" ->
+      SQLMetrics.createMetric(sparkContext, "number of failed reservations spilled for"),
+    "arbitratedSpills" ->
+      SQLMetrics.createMetric(sparkContext, "number of spills requested by the arbiter"),
+    "bytesReclaimed" ->
+      SQLMetrics.createSizeMetric(sparkContext, "bytes reclaimed by the arbiter"))
+
+  /** The metrics made by create, picked out of the metrics of plan. */
+  def of(plan: SparkPlan): Map[String, SQLMetric] =
+    names.map(name => name -> plan.longMetric(name)).toMap
+
+  /**
+   * Adds the spills of the operators named spillableName that the arbiter of pool
+   * requested, and when withTriggers the failed reservations of the task.
+   */
+  def report(
+      metrics: Map[String, SQLMetric],
+      pool: ExpressionMemoryPool,
+      spillableName: String,
+      withTriggers: Boolean): Unit = {
+    if (metrics.isEmpty) {
+      return
+    }
+    val values = pool.getSpillMetrics(spillableName)
+    names.zipWithIndex.foreach {
+      case ("spillTriggers", _) if !withTriggers =>
+      case (name, i) => metrics.get(name).foreach(_ += values(i))
+    }
+  }
+}
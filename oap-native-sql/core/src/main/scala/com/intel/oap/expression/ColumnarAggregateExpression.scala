@@ -80,6 +80,11 @@ class ColumnarAggregateExpression(
     with Logging {
 
   var aggrFieldList: List[Field] = _
+  // sum and avg of a short decimal keep decimal buffers, the merge keeps the
+  // precision of the partial sums and the final avg is returned as the Spark
+  // result type decimal(p + 4, s + 4).
+  val isDecimal = aggregateFunction.children.nonEmpty &&
+    aggregateFunction.children(0).dataType.isInstanceOf[DecimalType]
   val (funcName, argSize, resSize) = mode match {
     case Partial =>
       aggregateFunction.prettyName match {
@@ -98,12 +103,17 @@ class ColumnarAggregateExpression(
       aggregateFunction.prettyName match {
         case "avg" => ("sum_count_merge", 2, 2)
         case "count" => ("sum", 1, 1)
+        case "sum" if isDecimal => ("sum_merge", 1, 1)
         case other => (aggregateFunction.prettyName, 1, 1)
       }
     case Final =>
       aggregateFunction.prettyName match {
         case "count" => ("sum", 1, 1)
+        case "avg" if isDecimal =>
+          val resultType = aggregateFunction.dataType.asInstanceOf[DecimalType]
+          (s"avgByCount_${resultType.precision}_${resultType.scale}", 2, 1)
         case "avg" => ("avgByCount", 2, 1)
+        case "sum" if isDecimal => ("sum_merge", 1, 1)
         case "stddev_samp" => ("stddev_samp_final", 3, 1)
         case other => (aggregateFunction.prettyName, 1, 1)
       }
@@ -145,7 +145,7 @@ class ColumnarAggregation(
           internalExpressionList.map(projectExpr => {
             val attr = ConverterUtils.getResultAttrFromExpr(projectExpr, s"res_$index")
             if (attr.dataType.isInstanceOf[DecimalType])
-              throw new UnsupportedOperationException(s"Decimal type is not supported in ColumnarAggregation.")
+              ColumnarAggregation.checkDecimalSupported(groupingExpressions, expr)
             Field.nullable(s"${attr.name}#${attr.exprId.id}", CodeGeneration.getResultType(attr.dataType))
           })
         } else {
@@ -175,7 +175,7 @@ class ColumnarAggregation(
         val fieldList = ordinalList.map(i => {
           val attr = originalInputAttributes(i)
           if (attr.dataType.isInstanceOf[DecimalType])
-            throw new UnsupportedOperationException(s"Decimal type is not supported in ColumnarAggregation.")
+            ColumnarAggregation.checkDecimalSupported(groupingExpressions, expr)
           Field.nullable(s"${attr.name}#${attr.exprId.id}", CodeGeneration.getResultType(attr.dataType))
         })
         ordinalList.foreach{i => {
@@ -539,6 +539,27 @@ class ColumnarAggregation(
 }
 
 object ColumnarAggregation {
+  // Native decimal aggregation is limited to grouped sum and avg of a short
+  // decimal, precision <= 18, whose partial sums fit in decimal(p + 10, s).
+  def checkDecimalSupported(
+      groupingExpressions: Seq[NamedExpression],
+      expr: AggregateExpression): Unit = {
+    val supported = groupingExpressions.nonEmpty && (expr.aggregateFunction match {
+      case Sum(child) => isShortDecimal(child.dataType)
+      case Average(child) => isShortDecimal(child.dataType)
+      case _ => false
+    })
+    if (!supported) {
+      throw new UnsupportedOperationException(
+        s"Decimal type is not supported in ColumnarAggregation for ${expr}.")
+    }
+  }
+
+  def isShortDecimal(dataType: DataType): Boolean = dataType match {
+    case d: DecimalType => d.precision <= 18
+    case _ => false
+  }
+
   var columnarAggregation: ColumnarAggregation = _
   def create(
       partIndex: Int,
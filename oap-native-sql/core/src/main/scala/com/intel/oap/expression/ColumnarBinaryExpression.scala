@@ -70,12 +70,145 @@ class ColumnarDateAddInterval(start: Expression, interval: Expression, original:
   }
 }
 
+class ColumnarDateAdd(left: Expression, right: Expression, original: DateAdd)
+    extends DateAdd(left, right)
+    with ColumnarExpression
+    with Logging {
+  // gandiva has no add of date32 and shorts or bytes
+  if (right.dataType != IntegerType) {
+    throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
+  override def doColumnarCodeGen(args: Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+    val (right_node, right_type): (TreeNode, ArrowType) =
+      right.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val days = TreeBuilder.makeFunction(
+      "add",
+      Lists.newArrayList(ColumnarDateTimeExpressions.daysOf(left_node), right_node),
+      ColumnarDateTimeExpressions.int32Type)
+    (ColumnarDateTimeExpressions.dateOf(days), ColumnarDateTimeExpressions.date32Type)
+  }
+}
+
+class ColumnarDateSub(left: Expression, right: Expression, original: DateSub)
+    extends DateSub(left, right)
+    with ColumnarExpression
+    with Logging {
+  if (right.dataType != IntegerType) {
+    throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
+  override def doColumnarCodeGen(args: Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+    val (right_node, right_type): (TreeNode, ArrowType) =
+      right.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val days = TreeBuilder.makeFunction(
+      "subtract",
+      Lists.newArrayList(ColumnarDateTimeExpressions.daysOf(left_node), right_node),
+      ColumnarDateTimeExpressions.int32Type)
+    (ColumnarDateTimeExpressions.dateOf(days), ColumnarDateTimeExpressions.date32Type)
+  }
+}
+
+class ColumnarDateDiff(left: Expression, right: Expression, original: DateDiff)
+    extends DateDiff(left, right)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+    val (right_node, right_type): (TreeNode, ArrowType) =
+      right.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = ColumnarDateTimeExpressions.int32Type
+    val funcNode = TreeBuilder.makeFunction(
+      "subtract",
+      Lists.newArrayList(
+        ColumnarDateTimeExpressions.daysOf(left_node),
+        ColumnarDateTimeExpressions.daysOf(right_node)),
+      resultType)
+    (funcNode, resultType)
+  }
+}
+
+class ColumnarTruncDate(left: Expression, right: Expression, original: TruncDate)
+    extends TruncDate(left, right)
+    with ColumnarExpression
+    with Logging {
+  // the format of a literal, Spark's null results of other formats are left to it
+  val truncFunction: String = right match {
+    case lit: Literal if lit.value != null =>
+      ColumnarDateTimeExpressions.truncFunction(lit.value.toString).getOrElse(
+        throw new UnsupportedOperationException(s"not currently supported: $original."))
+    case _ =>
+      throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
+  override def doColumnarCodeGen(args: Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val truncated = TreeBuilder.makeFunction(
+      truncFunction,
+      Lists.newArrayList(ColumnarDateTimeExpressions.toDate64(left_node)),
+      ColumnarDateTimeExpressions.date64Type)
+    (
+      ColumnarDateTimeExpressions.dateOf(
+        ColumnarDateTimeExpressions.daysOfDate64(truncated)),
+      ColumnarDateTimeExpressions.date32Type)
+  }
+}
+
+/**
+ * unix_timestamp of a date, the seconds of its midnight in the session time zone. The
+ * offset of a region zone is looked up for each date.
+ */
+class ColumnarUnixTimestamp(left: Expression, right: Expression, original: UnixTimestamp)
+    extends UnixTimestamp(left, right, original.timeZoneId)
+    with ColumnarExpression
+    with Logging {
+  if (left.dataType != DateType || timeZoneId.isEmpty) {
+    throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
+  override def doColumnarCodeGen(args: Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = ColumnarDateTimeExpressions.int64Type
+    val seconds = ColumnarDateTimeExpressions.epochSeconds(
+      ColumnarDateTimeExpressions.toDate64(left_node))
+    val funcNode = TreeBuilder.makeFunction(
+      "subtract",
+      Lists.newArrayList(
+        seconds,
+        ColumnarDateTimeExpressions.startOfDayOffset(seconds, zoneId)),
+      resultType)
+    (funcNode, resultType)
+  }
+}
+
 object ColumnarBinaryExpression {
 
   def create(left: Expression, right: Expression, original: Expression): Expression =
     original match {
       case s: DateAddInterval =>
         new ColumnarDateAddInterval(left, right, s)
+      case a: DateAdd =>
+        new ColumnarDateAdd(left, right, a)
+      case s: DateSub =>
+        new ColumnarDateSub(left, right, s)
+      case d: DateDiff =>
+        new ColumnarDateDiff(left, right, d)
+      case t: TruncDate =>
+        new ColumnarTruncDate(left, right, t)
+      case u: UnixTimestamp =>
+        new ColumnarUnixTimestamp(left, right, u)
       case other =>
         throw new UnsupportedOperationException(s"not currently supported: $other.")
     }
@@ -104,6 +104,11 @@ class ColumnarLike(left: Expression, right: Expression, original: Expression)
     extends Like(left: Expression, right: Expression)
     with ColumnarExpression
     with Logging {
+  // the native matcher is compiled once, per row patterns stay on the JVM
+  if (!right.isInstanceOf[Literal]) {
+    throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
   override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
     val (left_node, left_type): (TreeNode, ArrowType) =
       left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
@@ -117,6 +122,41 @@ class ColumnarLike(left: Expression, right: Expression, original: Expression)
   }
 }
 
+class ColumnarRLike(left: Expression, right: Expression, original: Expression)
+    extends RLike(left: Expression, right: Expression)
+    with ColumnarExpression
+    with Logging {
+  right match {
+    case Literal(pattern, _) if pattern == null || ColumnarRLike.isSupported(pattern.toString) =>
+    case _ =>
+      throw new UnsupportedOperationException(s"not currently supported: $original.")
+  }
+
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (left_node, left_type): (TreeNode, ArrowType) =
+      left.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+    val (right_node, right_type): (TreeNode, ArrowType) =
+      right.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Bool()
+    val funcNode =
+      TreeBuilder.makeFunction("rlike", Lists.newArrayList(left_node, right_node), resultType)
+    (funcNode, resultType)
+  }
+}
+
+object ColumnarRLike {
+  // Natively the regex runs on RE2, which has no back references, lookaround, atomic
+  // groups, possessive quantifiers, class intersections, unicode blocks or the x and U
+  // flags. This errs on the safe side, e.g. an escaped backslash before a digit also
+  // falls back.
+  private val unsupportedConstruct =
+    """\\[1-9kG]|\(\?<?[=!]|\(\?>|[*+?}]\+|&&|\\[pP]\{In|\(\?[a-zA-Z-]*[xU]""".r
+
+  def isSupported(pattern: String): Boolean =
+    unsupportedConstruct.findFirstIn(pattern).isEmpty
+}
+
 class ColumnarContains(left: Expression, right: Expression, original: Expression)
     extends Contains(left: Expression, right: Expression)
     with ColumnarExpression
@@ -386,6 +426,8 @@ object ColumnarBinaryOperator {
         new ColumnarContains(left, right, c)
       case l: Like =>
         new ColumnarLike(left, right, l)
+      case r: RLike =>
+        new ColumnarRLike(left, right, r)
       case s: ShiftLeft =>
         new ColumnarShiftLeft(left, right, s)
       case s: ShiftRight =>
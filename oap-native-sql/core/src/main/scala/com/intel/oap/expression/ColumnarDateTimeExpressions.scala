@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.expression
+
+import java.time.{Instant, LocalDate, ZoneId, ZoneOffset}
+import java.util.Locale
+
+import com.google.common.collect.Lists
+
+import org.apache.arrow.gandiva.expression._
+import org.apache.arrow.vector.types.pojo.ArrowType
+import org.apache.arrow.vector.types.DateUnit
+
+import scala.collection.JavaConverters._
+
+/**
+ * Trees of the date expressions. They only use functions gandiva has for date64, so
+ * the projections outside of a whole stage run them, and the whole stage codegen
+ * compiles those functions to the branch free kernels of precompile/date_time.h.
+ */
+object ColumnarDateTimeExpressions {
+  val date32Type = new ArrowType.Date(DateUnit.DAY)
+  val date64Type = new ArrowType.Date(DateUnit.MILLISECOND)
+  val int32Type = new ArrowType.Int(32, true)
+  val int64Type = new ArrowType.Int(64, true)
+  val secondsPerDay: java.lang.Long = 86400L
+  // the Gregorian calendar repeats after 400 years, they hold whole weeks
+  val daysPer400Years = 146097L
+
+  def toDate64(date32: TreeNode): TreeNode =
+    TreeBuilder.makeFunction("castDATE", Lists.newArrayList(date32), date64Type)
+
+  /** Field of a date32 computed by a gandiva extract function, e.g. extractMonth. */
+  def extractField(date32: TreeNode, funcName: String): TreeNode = {
+    val field =
+      TreeBuilder.makeFunction(funcName, Lists.newArrayList(toDate64(date32)), int64Type)
+    TreeBuilder.makeFunction("castINT", Lists.newArrayList(field), int32Type)
+  }
+
+  def epochSeconds(date64: TreeNode): TreeNode =
+    TreeBuilder.makeFunction("extractEpoch", Lists.newArrayList(date64), int64Type)
+
+  /** Days since the epoch of a date64, as an int. */
+  def daysOfDate64(date64: TreeNode): TreeNode = {
+    val days = TreeBuilder.makeFunction(
+      "divide",
+      Lists.newArrayList(epochSeconds(date64), TreeBuilder.makeLiteral(secondsPerDay)),
+      int64Type)
+    TreeBuilder.makeFunction("castINT", Lists.newArrayList(days), int32Type)
+  }
+
+  def daysOf(date32: TreeNode): TreeNode = daysOfDate64(toDate64(date32))
+
+  def dateOf(days: TreeNode): TreeNode =
+    TreeBuilder.makeFunction("castDATE", Lists.newArrayList(days), date32Type)
+
+  /** Offset of zoneId in seconds at the midnight starting a date, as Spark takes it. */
+  def startOfDayOffset(zoneId: ZoneId, days: Long): Long =
+    days * secondsPerDay - LocalDate.ofEpochDay(days).atStartOfDay(zoneId).toEpochSecond
+
+  /**
+   * The steps of startOfDayOffset of a region zone: the seconds of the UTC midnights of
+   * the dates it changes at, the offset before the first of them and from each of them
+   * on, and the seconds of the UTC midnight the rules the zone keeps applying after its
+   * last historic transition start to repeat from, if it has such rules. The rules
+   * repeat with the calendar, the steps stop 400 years after that midnight.
+   */
+  def startOfDaySteps(zoneId: ZoneId): (Array[Long], Array[Long], Option[Long]) = {
+    val rules = zoneId.getRules
+    val history = rules.getTransitions.asScala
+    val lastYear = history.lastOption
+      .map(_.getInstant.atOffset(ZoneOffset.UTC).getYear)
+      .getOrElse(1970)
+    // the rules of the year before the cycle may still move the offset of its first days
+    val cycleStart =
+      if (rules.getTransitionRules.isEmpty) None
+      else Some(LocalDate.of(lastYear + 2, 1, 1).toEpochDay)
+    val fromRules = for {
+      year <- lastYear to lastYear + 402
+      rule <- rules.getTransitionRules.asScala
+    } yield rule.createTransition(year)
+    // the offset of a midnight only changes around the local dates of transitions
+    val days = (history ++ fromRules)
+      .flatMap { transition =>
+        val second = transition.getInstant.getEpochSecond
+        val offsets = Seq(transition.getOffsetBefore, transition.getOffsetAfter)
+          .map(_.getTotalSeconds.toLong)
+        (Math.floorDiv(second + offsets.min, secondsPerDay.longValue) - 1) to
+          (Math.floorDiv(second + offsets.max, secondsPerDay.longValue) + 1)
+      }
+      .distinct
+      .sorted
+      .filter(day => cycleStart.forall(day < _ + daysPer400Years))
+    val steps = days
+      .map(day => (day, startOfDayOffset(zoneId, day)))
+      .filter { case (day, offset) => offset != startOfDayOffset(zoneId, day - 1) }
+    val first = startOfDayOffset(zoneId, days.headOption.getOrElse(1L) - 1)
+    (
+      steps.map(_._1 * secondsPerDay).toArray,
+      (first +: steps.map(_._2)).toArray,
+      cycleStart.map(_ * secondsPerDay))
+  }
+
+  /**
+   * startOfDayOffset of the dates whose UTC midnights are utcSeconds, a literal for the
+   * zones with a fixed offset. For a region zone it is a search of its steps, as nested
+   * ifs on less_than(key, step): gandiva runs them as they are, the whole stage codegen
+   * compiles them to a table searched by StepLookup of precompile/date_time.h.
+   */
+  def startOfDayOffset(utcSeconds: TreeNode, zoneId: ZoneId): TreeNode = {
+    val rules = zoneId.getRules
+    if (rules.isFixedOffset) {
+      val offset: java.lang.Long = rules.getOffset(Instant.EPOCH).getTotalSeconds.toLong
+      return TreeBuilder.makeLiteral(offset)
+    }
+    val (steps, offsets, cycleStart) = startOfDaySteps(zoneId)
+    def literal(value: Long): TreeNode = TreeBuilder.makeLiteral(value: java.lang.Long)
+    def function(name: String, args: TreeNode*): TreeNode =
+      TreeBuilder.makeFunction(name, args.asJava, int64Type)
+    // later dates take the offset of the same date in the first 400 years of the rules
+    val key = cycleStart match {
+      case Some(start) =>
+        val period = daysPer400Years * secondsPerDay
+        val cycles = function(
+          "divide",
+          function("subtract", utcSeconds, literal(start)),
+          literal(period))
+        TreeBuilder.makeIf(
+          TreeBuilder.makeFunction(
+            "less_than",
+            Lists.newArrayList(utcSeconds, literal(start + period)),
+            new ArrowType.Bool()),
+          utcSeconds,
+          function("subtract", utcSeconds, function("multiply", cycles, literal(period))),
+          int64Type)
+      case None =>
+        utcSeconds
+    }
+    // offsets(lo) to offsets(hi), between steps(lo - 1) and steps(hi)
+    def search(lo: Int, hi: Int): TreeNode =
+      if (lo == hi) {
+        literal(offsets(lo))
+      } else {
+        val mid = (lo + hi + 1) / 2
+        TreeBuilder.makeIf(
+          TreeBuilder.makeFunction(
+            "less_than",
+            Lists.newArrayList(key, literal(steps(mid - 1))),
+            new ArrowType.Bool()),
+          search(lo, mid - 1),
+          search(mid, hi),
+          int64Type)
+      }
+    search(0, offsets.length - 1)
+  }
+
+  /**
+   * The gandiva date_trunc function of a trunc format, as Spark's TruncDate accepts
+   * them, None for the formats it returns null for.
+   */
+  def truncFunction(format: String): Option[String] =
+    format.toUpperCase(Locale.ROOT) match {
+      case "YEAR" | "YYYY" | "YY" => Some("date_trunc_Year")
+      case "QUARTER" => Some("date_trunc_Quarter")
+      case "MON" | "MONTH" | "MM" => Some("date_trunc_Month")
+      case "WEEK" => Some("date_trunc_Week")
+      case _ => None
+    }
+}
@@ -87,6 +87,71 @@ class ColumnarYear(child: Expression, original: Expression)
   }
 }
 
+class ColumnarMonth(child: Expression, original: Expression)
+    extends Month(child: Expression)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (child_node, childType): (TreeNode, ArrowType) =
+      child.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Int(32, true)
+    (ColumnarDateTimeExpressions.extractField(child_node, "extractMonth"), resultType)
+  }
+}
+
+class ColumnarDayOfMonth(child: Expression, original: Expression)
+    extends DayOfMonth(child: Expression)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (child_node, childType): (TreeNode, ArrowType) =
+      child.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Int(32, true)
+    (ColumnarDateTimeExpressions.extractField(child_node, "extractDay"), resultType)
+  }
+}
+
+class ColumnarDayOfWeek(child: Expression, original: Expression)
+    extends DayOfWeek(child: Expression)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (child_node, childType): (TreeNode, ArrowType) =
+      child.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Int(32, true)
+    (ColumnarDateTimeExpressions.extractField(child_node, "extractDow"), resultType)
+  }
+}
+
+class ColumnarDayOfYear(child: Expression, original: Expression)
+    extends DayOfYear(child: Expression)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (child_node, childType): (TreeNode, ArrowType) =
+      child.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Int(32, true)
+    (ColumnarDateTimeExpressions.extractField(child_node, "extractDoy"), resultType)
+  }
+}
+
+class ColumnarQuarter(child: Expression, original: Expression)
+    extends Quarter(child: Expression)
+    with ColumnarExpression
+    with Logging {
+  override def doColumnarCodeGen(args: java.lang.Object): (TreeNode, ArrowType) = {
+    val (child_node, childType): (TreeNode, ArrowType) =
+      child.asInstanceOf[ColumnarExpression].doColumnarCodeGen(args)
+
+    val resultType = new ArrowType.Int(32, true)
+    (ColumnarDateTimeExpressions.extractField(child_node, "extractQuarter"), resultType)
+  }
+}
+
 class ColumnarNot(child: Expression, original: Expression)
     extends Not(child: Expression)
     with ColumnarExpression
@@ -247,6 +312,16 @@ object ColumnarUnaryOperator {
       new ColumnarIsNotNull(child, i)
     case y: Year =>
       new ColumnarYear(child, y)
+    case m: Month =>
+      new ColumnarMonth(child, m)
+    case d: DayOfMonth =>
+      new ColumnarDayOfMonth(child, d)
+    case d: DayOfWeek =>
+      new ColumnarDayOfWeek(child, d)
+    case d: DayOfYear =>
+      new ColumnarDayOfYear(child, d)
+    case q: Quarter =>
+      new ColumnarQuarter(child, q)
     case n: Not =>
       new ColumnarNot(child, n)
     case a: Abs =>
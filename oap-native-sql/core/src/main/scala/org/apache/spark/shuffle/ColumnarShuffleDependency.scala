@@ -44,6 +44,9 @@ import scala.reflect.ClassTag
  * @param bytesSpilled for shuffle spill size tracking
  * @param computePidTime partition id computation time metric
  * @param splitTime native split time metric
+ * @param spillTime shuffle spill time metric
+ * @param gandivaCacheMetrics gandiva registry lookups of the native splitter
+ * @param spillArbiterMetrics spills the task's arbiter requested from the native splitter
  */
 class ColumnarShuffleDependency[K: ClassTag, V: ClassTag, C: ClassTag](
     @transient private val _rdd: RDD[_ <: Product2[K, V]],
@@ -59,7 +62,9 @@ class ColumnarShuffleDependency[K: ClassTag, V: ClassTag, C: ClassTag](
     val numInputRows: SQLMetric,
     val computePidTime: SQLMetric,
     val splitTime: SQLMetric,
-    val spillTime: SQLMetric)
+    val spillTime: SQLMetric,
+    val gandivaCacheMetrics: Map[String, SQLMetric] = Map.empty,
+    val spillArbiterMetrics: Map[String, SQLMetric] = Map.empty)
     extends ShuffleDependency[K, V, C](
       _rdd,
       partitioner,
@@ -20,8 +20,10 @@ package org.apache.spark.shuffle
 import java.io.IOException
 
 import com.google.common.annotations.VisibleForTesting
+import com.intel.oap.execution.{GandivaCacheMetrics, SpillArbiterMetrics}
 import com.intel.oap.vectorized.{
   ArrowWritableColumnVector,
+  ExpressionMemoryPool,
   ShuffleSplitterJniWrapper,
   SplitResult
 }
@@ -67,6 +69,8 @@ class ColumnarShuffleWriter[K, V](
 
   private var nativeSplitter: Long = 0
 
+  private var memoryPool: ExpressionMemoryPool = _
+
   private var splitResult: SplitResult = _
 
   private var partitionLengths: Array[Long] = _
@@ -82,13 +86,18 @@ class ColumnarShuffleWriter[K, V](
 
     val dataTmp = Utils.tempFileWith(shuffleBlockResolver.getDataFile(dep.shuffleId, mapId))
     if (nativeSplitter == 0) {
-      nativeSplitter = jniWrapper.make(
-        dep.nativePartitioning,
-        nativeBufferSize,
-        compressionCodec,
-        dataTmp.getAbsolutePath,
-        blockManager.subDirsPerLocalDir,
-        localDirs)
+      memoryPool = ExpressionMemoryPool.forSpark()
+      // the hash splitter builds its partition id projector here
+      nativeSplitter = GandivaCacheMetrics.track(dep.gandivaCacheMetrics) {
+        jniWrapper.make(
+          dep.nativePartitioning,
+          nativeBufferSize,
+          compressionCodec,
+          dataTmp.getAbsolutePath,
+          blockManager.subDirsPerLocalDir,
+          localDirs,
+          memoryPool.getNativeInstanceId)
+      }
     }
 
     while (records.hasNext) {
@@ -125,6 +134,12 @@ class ColumnarShuffleWriter[K, V](
     dep.spillTime.add(splitResult.getTotalSpillTime)
     dep.computePidTime.add(splitResult.getTotalComputePidTime)
     dep.bytesSpilled.add(splitResult.getTotalBytesSpilled)
+    // the shuffle write ends the map task, so it reports the task's spill triggers too
+    SpillArbiterMetrics.report(
+      dep.spillArbiterMetrics,
+      memoryPool,
+      "ShuffleSplitter",
+      withTriggers = true)
     writeMetrics.incBytesWritten(splitResult.getTotalBytesWritten)
     writeMetrics.incWriteTime(splitResult.getTotalWriteTime + splitResult.getTotalSpillTime)
 
@@ -1,6 +1,7 @@
 package org.apache.spark.sql.execution
 
 import com.google.common.collect.Lists;
+import com.intel.oap.execution.GandivaCacheMetrics
 import com.intel.oap.expression._
 import com.intel.oap.vectorized.{ArrowWritableColumnVector, ExpressionEvaluator, BatchIterator}
 import io.netty.buffer.{ByteBuf, ByteBufAllocator, ByteBufOutputStream}
@@ -44,7 +45,8 @@ class ColumnarBroadcastExchangeExec(mode: BroadcastMode, child: SparkPlan)
     "totalTime" -> SQLMetrics.createTimingMetric(sparkContext, "totaltime_broadcastExchange"),
     "collectTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to collect"),
     "buildTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to build"),
-    "broadcastTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to broadcast"))
+    "broadcastTime" -> SQLMetrics.createTimingMetric(sparkContext, "time to broadcast")) ++
+    GandivaCacheMetrics.create(sparkContext)
   @transient
   private lazy val promise = Promise[broadcast.Broadcast[Any]]()
 
@@ -147,10 +149,12 @@ class ColumnarBroadcastExchangeExec(mode: BroadcastMode, child: SparkPlan)
             hash_relation_function,
             Field.nullable("result", new ArrowType.Int(32, true)))
         val hashRelationKernel = new ExpressionEvaluator()
-        hashRelationKernel.build(
-          hash_relation_schema,
-          Lists.newArrayList(hash_relation_expr),
-          true)
+        GandivaCacheMetrics.track(GandivaCacheMetrics.of(this)) {
+          hashRelationKernel.build(
+            hash_relation_schema,
+            Lists.newArrayList(hash_relation_expr),
+            true)
+        }
         val iter = ConverterUtils.convertFromNetty(output, input)
         var numRows: Long = 0
         val _input = new ArrayBuffer[ColumnarBatch]()
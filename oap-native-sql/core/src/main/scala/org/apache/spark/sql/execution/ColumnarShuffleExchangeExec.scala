@@ -18,6 +18,7 @@
 package org.apache.spark.sql.execution
 
 import com.google.common.collect.Lists
+import com.intel.oap.execution.{GandivaCacheMetrics, SpillArbiterMetrics}
 import com.intel.oap.expression.{CodeGeneration, ColumnarExpression, ColumnarExpressionConverter, ConverterUtils}
 import com.intel.oap.vectorized.{ArrowColumnarBatchSerializer, ArrowWritableColumnVector, NativePartitioning}
 import org.apache.arrow.gandiva.expression.TreeBuilder
@@ -65,7 +66,8 @@ class ColumnarShuffleExchangeExec(
       .createAverageMetric(sparkContext, "avg read batch num rows"),
     "numInputRows" -> SQLMetrics.createMetric(sparkContext, "number of input rows"),
     "numOutputRows" -> SQLMetrics
-      .createMetric(sparkContext, "number of output rows")) ++ readMetrics ++ writeMetrics
+      .createMetric(sparkContext, "number of output rows")) ++ readMetrics ++ writeMetrics ++
+    GandivaCacheMetrics.create(sparkContext) ++ SpillArbiterMetrics.create(sparkContext)
 
   override def nodeName: String = "ColumnarExchange"
 
@@ -104,7 +106,9 @@ class ColumnarShuffleExchangeExec(
       longMetric("numInputRows"),
       longMetric("computePidTime"),
       longMetric("splitTime"),
-      longMetric("spillTime"))
+      longMetric("spillTime"),
+      GandivaCacheMetrics.of(this),
+      SpillArbiterMetrics.of(this))
   }
 
   private var cachedShuffleRDD: ShuffledColumnarBatchRDD = _
@@ -165,7 +169,10 @@ object ColumnarShuffleExchangeExec extends Logging {
       numInputRows: SQLMetric,
       computePidTime: SQLMetric,
       splitTime: SQLMetric,
-      spillTime: SQLMetric): ShuffleDependency[Int, ColumnarBatch, ColumnarBatch] = {
+      spillTime: SQLMetric,
+      gandivaCacheMetrics: Map[String, SQLMetric] = Map.empty,
+      spillArbiterMetrics: Map[String, SQLMetric] = Map.empty)
+      : ShuffleDependency[Int, ColumnarBatch, ColumnarBatch] = {
 
     val arrowFields = outputAttributes.map(attr => {
       Field
@@ -318,7 +325,9 @@ object ColumnarShuffleExchangeExec extends Logging {
         numInputRows = numInputRows,
         computePidTime = computePidTime,
         splitTime = splitTime,
-        spillTime = spillTime)
+        spillTime = spillTime,
+        gandivaCacheMetrics = gandivaCacheMetrics,
+        spillArbiterMetrics = spillArbiterMetrics)
 
     dependency
   }
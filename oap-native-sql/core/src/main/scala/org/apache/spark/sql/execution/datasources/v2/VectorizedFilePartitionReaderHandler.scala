@@ -41,9 +41,14 @@ object VectorizedFilePartitionReaderHandler {
   def get(
       inputPartition: InputPartition,
       parquetReaderFactory: ParquetPartitionReaderFactory,
-      tmpDir: String): FilePartitionReader[ColumnarBatch] = {
+      tmpDir: String,
+      rowBudget: Long = -1): FilePartitionReader[ColumnarBatch] = {
+    // rows the partition still reads, negative for no limit. Files past the budget are
+    // not opened at all.
+    var remaining = rowBudget
     val iter: Iterator[PartitionedFileReader[ColumnarBatch]] =
-      inputPartition.asInstanceOf[FilePartition].files.toIterator.map { file =>
+      inputPartition.asInstanceOf[FilePartition].files.toIterator
+        .takeWhile(_ => remaining != 0).map { file =>
         val filePath = new Path(new URI(file.filePath))
         val split =
           new org.apache.parquet.hadoop.ParquetInputSplit(
@@ -78,10 +83,18 @@ object VectorizedFilePartitionReaderHandler {
           readDataSchema,
           tmpDir)
         vectorizedReader.initialize(split, hadoopAttemptContext)
+        if (remaining >= 0) {
+          vectorizedReader.setRowBudget(remaining)
+        }
         val partitionReader = new PartitionReader[ColumnarBatch] {
           override def next(): Boolean = vectorizedReader.nextKeyValue()
-          override def get(): ColumnarBatch =
-            vectorizedReader.getCurrentValue.asInstanceOf[ColumnarBatch]
+          override def get(): ColumnarBatch = {
+            val batch = vectorizedReader.getCurrentValue.asInstanceOf[ColumnarBatch]
+            if (remaining > 0) {
+              remaining = math.max(0, remaining - batch.numRows)
+            }
+            batch
+          }
           override def close(): Unit = vectorizedReader.close()
         }
 
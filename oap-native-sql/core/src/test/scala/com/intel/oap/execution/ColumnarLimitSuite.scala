@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.intel.oap.execution
+
+import org.apache.spark.SparkConf
+import org.apache.spark.sql.{QueryTest, Row}
+import org.apache.spark.sql.execution.adaptive.AdaptiveSparkPlanHelper
+import org.apache.spark.sql.test.SharedSparkSession
+
+class ColumnarLimitSuite extends QueryTest
+  with SharedSparkSession
+  with AdaptiveSparkPlanHelper {
+
+  override def sparkConf: SparkConf =
+    super.sparkConf
+      .setAppName("test")
+      .set("spark.sql.parquet.columnarReaderBatchSize", "4096")
+      .set("spark.sql.sources.useV1SourceList", "avro")
+      .set("spark.sql.extensions", "com.intel.oap.ColumnarPlugin")
+      .set("spark.sql.execution.arrow.maxRecordsPerBatch", "4096")
+      .set("spark.memory.offHeap.enabled", "true")
+      .set("spark.memory.offHeap.size", "10m")
+      .set("spark.unsafe.exceptionOnMemoryLeak", "false")
+      .set("spark.oap.sql.columnar.preferColumnar", "true")
+
+  test("limit over a parquet scan stops the reader at the limit") {
+    withTempPath { dir =>
+      val path = dir.getCanonicalPath
+      // a single file of several batches
+      spark.range(0, 20000, 1, 1).toDF("id").write.parquet(path)
+      val df = spark.read.parquet(path).limit(10)
+      checkAnswer(df, (0L until 10L).map(Row(_)))
+
+      val plan = df.queryExecution.executedPlan
+      assert(collect(plan) { case l: ColumnarLocalLimitExec => l }.size === 1)
+      val scans = collect(plan) { case s: ColumnarBatchScanExec => s }
+      assert(scans.size === 1)
+      // the last batch was truncated, no row past the limit was decoded
+      assert(scans.head.metrics("numOutputRows").value === 10)
+    }
+  }
+
+  test("limit truncates the batches of children without a row budget") {
+    withTempPath { dir =>
+      val path = dir.getCanonicalPath
+      spark.range(0, 10000, 1, 1).toDF("id").write.parquet(path)
+      val input = spark.read.parquet(path)
+      val df = input.union(input).limit(5000)
+      val rows = df.collect()
+      assert(rows.length === 5000)
+      assert(rows.forall(_.getLong(0) < 10000))
+      assert(collect(df.queryExecution.executedPlan) {
+        case l: ColumnarLocalLimitExec => l
+      }.size === 1)
+    }
+  }
+}
@@ -20,6 +20,7 @@ package org.apache.spark.shuffle
 import java.io.File
 import java.nio.file.Files
 
+import com.intel.oap.execution.{GandivaCacheMetrics, SpillArbiterMetrics}
 import com.intel.oap.expression.ConverterUtils
 import com.intel.oap.vectorized.{ArrowWritableColumnVector, NativePartitioning}
 import org.apache.arrow.memory.RootAllocator
@@ -96,6 +97,10 @@ class ColumnarShuffleWriterSuite extends SharedSparkSession {
       .thenReturn(SQLMetrics.createNanoTimingMetric(spark.sparkContext, "totaltime_spill"))
     when(dependency.computePidTime)
       .thenReturn(SQLMetrics.createNanoTimingMetric(spark.sparkContext, "totaltime_computepid"))
+    when(dependency.gandivaCacheMetrics)
+      .thenReturn(GandivaCacheMetrics.create(spark.sparkContext))
+    when(dependency.spillArbiterMetrics)
+      .thenReturn(SpillArbiterMetrics.create(spark.sparkContext))
     when(taskContext.taskMetrics()).thenReturn(taskMetrics)
     when(blockResolver.getDataFile(0, 0)).thenReturn(outputFile)
 
@@ -204,6 +209,10 @@ class ColumnarShuffleWriterSuite extends SharedSparkSession {
 
     assert(taskMetrics.diskBytesSpilled === 0)
     assert(taskMetrics.memoryBytesSpilled === 0)
+    // the reservations of the splitter never failed, the arbiter had nothing to do
+    SpillArbiterMetrics.names.foreach { name =>
+      assert(dependency.spillArbiterMetrics(name).value === 0)
+    }
 
     val bytes = Files.readAllBytes(outputFile.toPath)
     val reader = new ArrowStreamReader(new ByteArrayReadableSeekableByteChannel(bytes), allocator)
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.spark.sql.execution.benchmark
+
+import com.intel.oap.execution.{NativeRowToColumnConverter, RowToColumnConverter => ArrowRowToColumnConverter}
+import com.intel.oap.vectorized.ArrowWritableColumnVector
+import org.apache.spark.benchmark.{Benchmark, BenchmarkBase}
+import org.apache.spark.sql.catalyst.InternalRow
+import org.apache.spark.sql.catalyst.expressions.{GenericInternalRow, UnsafeProjection, UnsafeRow}
+import org.apache.spark.sql.execution.RowToColumnConverter
+import org.apache.spark.sql.execution.vectorized.{OffHeapColumnVector, WritableColumnVector}
+import org.apache.spark.sql.types._
+import org.apache.spark.unsafe.types.UTF8String
+
+/**
+ * Benchmark to measure the row to columnar conversions on wide schemas: Spark's
+ * RowToColumnConverter, the row by row conversion into arrow vectors that
+ * RowToArrowColumnarExec falls back to, and the native conversion through
+ * ArrowRowToColumnarJniWrapper.
+ * To run this benchmark:
+ * {{{
+ *   1. without sbt:
+ *      bin/spark-submit --class <this class> --jars <spark core test jar> <core test jar>
+ *   2. build/sbt "test:runMain <this class>"
+ *   3. generate result:
+ *      SPARK_GENERATE_BENCHMARK_FILES=1 build/sbt "test:runMain <this class>"
+ *      Results will be written to "benchmarks/RowToArrowColumnarBenchmark-results.txt".
+ * }}}
+ */
+object RowToArrowColumnarBenchmark extends BenchmarkBase {
+
+  private val numRows = 100000
+  private val batchSize = 4096
+  private val numColumns = 200
+
+  private def makeRows(schema: StructType): Array[UnsafeRow] = {
+    val toUnsafe = UnsafeProjection.create(schema)
+    val random = new scala.util.Random(42)
+    Array.fill(numRows) {
+      val values = schema.fields.map { f =>
+        if (f.nullable && random.nextInt(10) == 0) {
+          null
+        } else {
+          f.dataType match {
+            case IntegerType => random.nextInt()
+            case LongType => random.nextLong()
+            case DoubleType => random.nextDouble()
+            case StringType => UTF8String.fromString(random.alphanumeric.take(12).mkString)
+          }
+        }
+      }
+      toUnsafe(new GenericInternalRow(values)).copy()
+    }
+  }
+
+  private def convertAll(
+      rows: Array[UnsafeRow],
+      allocate: () => Seq[WritableColumnVector],
+      convert: (InternalRow, Array[WritableColumnVector]) => Unit): Unit = {
+    var start = 0
+    while (start < rows.length) {
+      val vectors = allocate().toArray
+      val end = math.min(start + batchSize, rows.length)
+      var i = start
+      while (i < end) {
+        convert(rows(i), vectors)
+        i += 1
+      }
+      vectors.foreach(_.close())
+      start = end
+    }
+  }
+
+  private def benchmarkSchema(name: String, schema: StructType): Unit = {
+    val rows = makeRows(schema)
+    val benchmark = new Benchmark(name, numRows, output = output)
+
+    benchmark.addCase("Spark RowToColumnConverter, off-heap vectors") { _ =>
+      val converter = new RowToColumnConverter(schema)
+      convertAll(
+        rows,
+        () => OffHeapColumnVector.allocateColumns(batchSize, schema),
+        converter.convert)
+    }
+
+    benchmark.addCase("row by row into arrow vectors") { _ =>
+      val converter = new ArrowRowToColumnConverter(schema)
+      convertAll(
+        rows,
+        () => ArrowWritableColumnVector.allocateColumns(batchSize, schema),
+        converter.convert)
+    }
+
+    benchmark.addCase("ArrowRowToColumnarJniWrapper") { _ =>
+      val converter = new NativeRowToColumnConverter(schema)
+      val iter = rows.iterator
+      while (iter.hasNext) {
+        val cb = converter.convert(iter, batchSize)
+        cb.close()
+      }
+      converter.close()
+    }
+
+    benchmark.run()
+  }
+
+  override def runBenchmarkSuite(mainArgs: Array[String]): Unit = {
+    runBenchmark("Row to columnar conversion of wide rows") {
+      val fixedWidth = StructType((0 until numColumns).map { i =>
+        StructField(s"c$i", if (i % 2 == 0) LongType else IntegerType, nullable = true)
+      })
+      benchmarkSchema(s"$numColumns fixed width columns", fixedWidth)
+
+      val mixed = StructType((0 until numColumns).map { i =>
+        val dataType = i % 4 match {
+          case 0 => StringType
+          case 1 => DoubleType
+          case 2 => LongType
+          case _ => IntegerType
+        }
+        StructField(s"c$i", dataType, nullable = true)
+      })
+      benchmarkSchema(s"$numColumns columns, a quarter of them strings", mixed)
+    }
+  }
+}
@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+
+#include "codegen/code_generator.h"
+#include "codegen/code_generator_factory.h"
+#include "codegen/common/result_iterator.h"
+#include "tests/test_utils.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+using gandiva::TreeExprBuilder;
+
+const int num_batches = 1000;
+const int batch_size = 4096;
+
+/// Runs the same WholeStageCodeGen filter and project over TPC-DS store_sales like
+/// columns twice: once without any null, which takes the null free loop, and once
+/// with a single null per column and batch, which forces the nullable loop.
+class BenchmarkArrowComputeNullFree : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ss_item_sk = arrow::field("ss_item_sk", arrow::int32());
+    ss_quantity = arrow::field("ss_quantity", arrow::int32());
+    ss_sales_price = arrow::field("ss_sales_price", arrow::float64());
+    ss_net_profit = arrow::field("ss_net_profit", arrow::float64());
+    schema = arrow::schema({ss_item_sk, ss_quantity, ss_sales_price, ss_net_profit});
+  }
+
+ protected:
+  std::shared_ptr<arrow::Field> ss_item_sk;
+  std::shared_ptr<arrow::Field> ss_quantity;
+  std::shared_ptr<arrow::Field> ss_sales_price;
+  std::shared_ptr<arrow::Field> ss_net_profit;
+  std::shared_ptr<arrow::Schema> schema;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> MakeBatches(bool with_null) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> item_dist(1, 18000);
+    std::uniform_int_distribution<int32_t> quantity_dist(1, 100);
+    std::uniform_real_distribution<double> price_dist(0, 200);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (int b = 0; b < num_batches; b++) {
+      arrow::Int32Builder item_builder;
+      arrow::Int32Builder quantity_builder;
+      arrow::DoubleBuilder price_builder;
+      arrow::DoubleBuilder profit_builder;
+      for (int i = 0; i < batch_size; i++) {
+        if (with_null && i == 0) {
+          THROW_NOT_OK(item_builder.AppendNull());
+          THROW_NOT_OK(quantity_builder.AppendNull());
+          THROW_NOT_OK(price_builder.AppendNull());
+          THROW_NOT_OK(profit_builder.AppendNull());
+          continue;
+        }
+        THROW_NOT_OK(item_builder.Append(item_dist(gen)));
+        THROW_NOT_OK(quantity_builder.Append(quantity_dist(gen)));
+        THROW_NOT_OK(price_builder.Append(price_dist(gen)));
+        THROW_NOT_OK(profit_builder.Append(price_dist(gen) - 100));
+      }
+      std::vector<std::shared_ptr<arrow::Array>> arrays(4);
+      THROW_NOT_OK(item_builder.Finish(&arrays[0]));
+      THROW_NOT_OK(quantity_builder.Finish(&arrays[1]));
+      THROW_NOT_OK(price_builder.Finish(&arrays[2]));
+      THROW_NOT_OK(profit_builder.Finish(&arrays[3]));
+      batches.push_back(arrow::RecordBatch::Make(schema, batch_size, arrays));
+    }
+    return batches;
+  }
+
+  void DoWSCG(bool with_null) {
+    // ss_quantity >= 10, then project ss_item_sk and ss_sales_price + ss_net_profit
+    gandiva::NodeVector field_node_list = {
+        TreeExprBuilder::MakeField(ss_item_sk), TreeExprBuilder::MakeField(ss_quantity),
+        TreeExprBuilder::MakeField(ss_sales_price),
+        TreeExprBuilder::MakeField(ss_net_profit)};
+    auto n_filter_input = TreeExprBuilder::MakeFunction("codegen_input_schema",
+                                                        field_node_list, arrow::uint32());
+    auto n_filter_func = TreeExprBuilder::MakeFunction(
+        "greater_than_or_equal_to",
+        {TreeExprBuilder::MakeField(ss_quantity), TreeExprBuilder::MakeLiteral((int)10)},
+        arrow::boolean());
+    auto n_filter = TreeExprBuilder::MakeFunction(
+        "filter", {n_filter_input, n_filter_func}, arrow::uint32());
+    auto n_child_filter =
+        TreeExprBuilder::MakeFunction("child", {n_filter}, arrow::uint32());
+    auto n_project_input = TreeExprBuilder::MakeFunction(
+        "codegen_input_schema", field_node_list, arrow::uint32());
+    auto n_add = TreeExprBuilder::MakeFunction(
+        "add",
+        {TreeExprBuilder::MakeField(ss_sales_price),
+         TreeExprBuilder::MakeField(ss_net_profit)},
+        arrow::float64());
+    auto n_project_func = TreeExprBuilder::MakeFunction(
+        "codegen_project", {TreeExprBuilder::MakeField(ss_item_sk), n_add},
+        arrow::uint32());
+    auto n_project = TreeExprBuilder::MakeFunction(
+        "project", {n_project_input, n_project_func}, arrow::uint32());
+    auto n_child = TreeExprBuilder::MakeFunction("child", {n_project, n_child_filter},
+                                                 arrow::uint32());
+    auto n_wscg =
+        TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, arrow::uint32());
+    auto f_res = arrow::field("res", arrow::uint32());
+    auto wscg_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+    auto f_sum = arrow::field("sum", arrow::float64());
+
+    uint64_t elapse_gen = 0;
+    uint64_t elapse_eval = 0;
+    std::shared_ptr<CodeGenerator> expr_wscg;
+    TIME_MICRO_OR_THROW(elapse_gen, CreateCodeGenerator(schema, {wscg_expr},
+                                                        {ss_item_sk, f_sum}, &expr_wscg,
+                                                        true));
+    std::shared_ptr<ResultIteratorBase> iter_base;
+    THROW_NOT_OK(expr_wscg->finish(&iter_base));
+    auto iter = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(iter_base);
+    THROW_NOT_OK(iter->SetDependencies({}));
+
+    auto batches = MakeBatches(with_null);
+    int64_t num_output_rows = 0;
+    for (auto batch : batches) {
+      std::shared_ptr<arrow::RecordBatch> result_batch;
+      TIME_MICRO_OR_THROW(elapse_eval, iter->Process(batch->columns(), &result_batch));
+      num_output_rows += result_batch->num_rows();
+    }
+
+    std::cout << (with_null ? "With one null per column and batch: " : "Without null: ")
+              << num_batches << " batches of " << batch_size << " rows, "
+              << num_output_rows << " output rows" << std::endl
+              << "Took " << TIME_TO_STRING(elapse_gen) << " doing codegen" << std::endl
+              << "Took " << TIME_TO_STRING(elapse_eval) << " doing WSCG" << std::endl;
+  }
+};
+
+TEST_F(BenchmarkArrowComputeNullFree, WSCGWithoutNull) { DoWSCG(false); }
+
+TEST_F(BenchmarkArrowComputeNullFree, WSCGWithNull) { DoWSCG(true); }
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+#include <gandiva/configuration.h>
+#include <gandiva/projector.h>
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "codegen/code_generator.h"
+#include "codegen/code_generator_factory.h"
+#include "codegen/common/result_iterator.h"
+#include "tests/test_utils.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+using gandiva::TreeExprBuilder;
+
+// 2M rows sorted in 4K row batches
+const int num_batches = 512;
+const int batch_size = 4096;
+
+/// Sorts a narrow schema of ints and a wide one of 200 byte strings, then drains the
+/// sorted output through a gandiva projection standing in for the next operator.
+/// Each schema runs with a fixed NATIVESQL_BATCH_SIZE of 4K rows per output batch and
+/// with batches sized to a 2M NATIVESQL_BATCH_BYTES budget: the narrow rows grow to
+/// the 64K NATIVESQL_BATCH_MAX_ROWS cap, the wide ones are cut below 4K.
+class BenchmarkBatchSizing : public ::testing::Test {
+ protected:
+  std::vector<std::shared_ptr<arrow::RecordBatch>> MakeBatches(
+      const std::shared_ptr<arrow::Schema>& schema, int num_strings) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> key_dist(0, 1 << 30);
+    std::uniform_int_distribution<int> char_dist('a', 'z');
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (int b = 0; b < num_batches; b++) {
+      arrow::Int32Builder key_builder;
+      arrow::Int32Builder value_builder;
+      std::vector<arrow::StringBuilder> string_builders(num_strings);
+      for (int i = 0; i < batch_size; i++) {
+        THROW_NOT_OK(key_builder.Append(key_dist(gen)));
+        THROW_NOT_OK(value_builder.Append(i));
+        for (auto& builder : string_builders) {
+          std::string value(200, static_cast<char>(char_dist(gen)));
+          THROW_NOT_OK(builder.Append(value));
+        }
+      }
+      std::vector<std::shared_ptr<arrow::Array>> arrays(2 + num_strings);
+      THROW_NOT_OK(key_builder.Finish(&arrays[0]));
+      THROW_NOT_OK(value_builder.Finish(&arrays[1]));
+      for (int i = 0; i < num_strings; i++) {
+        THROW_NOT_OK(string_builders[i].Finish(&arrays[2 + i]));
+      }
+      batches.push_back(arrow::RecordBatch::Make(schema, batch_size, arrays));
+    }
+    return batches;
+  }
+
+  void DoSortAndDrain(int num_strings, bool adaptive) {
+    setenv("NATIVESQL_BATCH_SIZE", std::to_string(batch_size).c_str(), 1);
+    setenv("NATIVESQL_BATCH_BYTES", adaptive ? "2097152" : "0", 1);
+    setenv("NATIVESQL_BATCH_MAX_ROWS", "65536", 1);
+    auto key = arrow::field("key", arrow::int32());
+    auto value = arrow::field("value", arrow::int32());
+    arrow::FieldVector fields = {key, value};
+    for (int i = 0; i < num_strings; i++) {
+      fields.push_back(arrow::field("str_" + std::to_string(i), arrow::utf8()));
+    }
+    auto schema = arrow::schema(fields);
+
+    auto arg_key = TreeExprBuilder::MakeField(key);
+    auto n_key_func =
+        TreeExprBuilder::MakeFunction("key_function", {arg_key}, arrow::uint32());
+    auto n_key_field =
+        TreeExprBuilder::MakeFunction("key_field", {arg_key}, arrow::uint32());
+    auto n_dir = TreeExprBuilder::MakeFunction(
+        "sort_directions", {TreeExprBuilder::MakeLiteral(true)}, arrow::uint32());
+    auto n_nulls_order = TreeExprBuilder::MakeFunction(
+        "sort_nulls_order", {TreeExprBuilder::MakeLiteral(true)}, arrow::uint32());
+    auto n_sort_to_indices = TreeExprBuilder::MakeFunction(
+        "sortArraysToIndices", {n_key_func, n_key_field, n_dir, n_nulls_order},
+        arrow::uint32());
+    auto n_sort =
+        TreeExprBuilder::MakeFunction("standalone", {n_sort_to_indices}, arrow::uint32());
+    auto sort_expr =
+        TreeExprBuilder::MakeExpression(n_sort, arrow::field("res", arrow::uint32()));
+
+    // key + value, the next operator's share of the work per row is small
+    auto project_expr = TreeExprBuilder::MakeExpression(
+        TreeExprBuilder::MakeFunction("add",
+                                      {arg_key, TreeExprBuilder::MakeField(value)},
+                                      arrow::int32()),
+        arrow::field("sum", arrow::int32()));
+    std::shared_ptr<gandiva::Projector> projector;
+    auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+    THROW_NOT_OK(
+        gandiva::Projector::Make(schema, {project_expr}, configuration, &projector));
+
+    auto batches = MakeBatches(schema, num_strings);
+    std::shared_ptr<CodeGenerator> sorter;
+    THROW_NOT_OK(CreateCodeGenerator(schema, {sort_expr}, fields, &sorter, true));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+    for (auto batch : batches) {
+      THROW_NOT_OK(sorter->evaluate(batch, &dummy_result_batches));
+    }
+    batches.clear();
+    std::shared_ptr<ResultIteratorBase> iter_base;
+    THROW_NOT_OK(sorter->finish(&iter_base));
+    auto iter = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(iter_base);
+
+    uint64_t elapse_next = 0;
+    uint64_t elapse_project = 0;
+    int64_t num_output_batches = 0;
+    int64_t num_output_rows = 0;
+    while (iter->HasNext()) {
+      std::shared_ptr<arrow::RecordBatch> result_batch;
+      TIME_MICRO_OR_THROW(elapse_next, iter->Next(&result_batch));
+      arrow::ArrayVector projected;
+      auto pool = arrow::default_memory_pool();
+      TIME_MICRO_OR_THROW(elapse_project,
+                          projector->Evaluate(*result_batch, pool, &projected));
+      num_output_batches++;
+      num_output_rows += result_batch->num_rows();
+    }
+    unsetenv("NATIVESQL_BATCH_SIZE");
+    unsetenv("NATIVESQL_BATCH_BYTES");
+    unsetenv("NATIVESQL_BATCH_MAX_ROWS");
+
+    auto elapse_total = elapse_next + elapse_project;
+    std::cout << (num_strings == 0 ? "Narrow" : "Wide") << " schema, "
+              << (adaptive ? "sized by bytes: " : "fixed rows: ") << num_output_rows
+              << " rows in " << num_output_batches << " batches" << std::endl
+              << "Took " << TIME_TO_STRING(elapse_next) << " doing sort output, "
+              << TIME_TO_STRING(elapse_project) << " doing projection, "
+              << num_output_rows / std::max<uint64_t>(1, elapse_total) << "M rows/s"
+              << std::endl;
+  }
+};
+
+TEST_F(BenchmarkBatchSizing, NarrowFixedRows) { DoSortAndDrain(0, false); }
+
+TEST_F(BenchmarkBatchSizing, NarrowSizedByBytes) { DoSortAndDrain(0, true); }
+
+TEST_F(BenchmarkBatchSizing, WideFixedRows) { DoSortAndDrain(3, false); }
+
+TEST_F(BenchmarkBatchSizing, WideSizedByBytes) { DoSortAndDrain(3, true); }
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/status.h>
+#include <arrow/type.h>
+#include <gandiva/configuration.h>
+#include <gandiva/projector.h>
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "precompile/date_time.h"
+#include "third_party/gandiva/types.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+using gandiva::TreeExprBuilder;
+
+// 16M dates of 1900 to 2100
+const int num_rows = 16 * 1024 * 1024;
+const int batch_size = 4096;
+
+/// java.time.LocalDate.ofEpochDay, which Spark's DateTimeUtils calls for each value of
+/// month(), dayofweek(), trunc() and the like, as the JVM runs it minus the allocation.
+struct JavaLocalDate {
+  int64_t year;
+  int32_t month;
+  int32_t day;
+
+  static JavaLocalDate OfEpochDay(int64_t epoch_day) {
+    int64_t zero_day = epoch_day + 719528 - 60;
+    int64_t adjust = 0;
+    if (zero_day < 0) {
+      int64_t adjust_cycles = (zero_day + 1) / 146097 - 1;
+      adjust = adjust_cycles * 400;
+      zero_day += -adjust_cycles * 146097;
+    }
+    int64_t year_est = (400 * zero_day + 591) / 146097;
+    int64_t doy_est =
+        zero_day - (365 * year_est + year_est / 4 - year_est / 100 + year_est / 400);
+    if (doy_est < 0) {
+      year_est--;
+      doy_est =
+          zero_day - (365 * year_est + year_est / 4 - year_est / 100 + year_est / 400);
+    }
+    year_est += adjust;
+    int32_t march_doy0 = static_cast<int32_t>(doy_est);
+    int32_t march_month0 = (march_doy0 * 5 + 2) / 153;
+    JavaLocalDate date;
+    date.month = (march_month0 + 2) % 12 + 1;
+    date.day = march_doy0 - (march_month0 * 306 + 5) / 10 + 1;
+    date.year = year_est + march_month0 / 10;
+    return date;
+  }
+
+  // DayOfWeek.of(floorMod(epochDay + 3, 7) + 1), shifted to Spark's 1 for Sunday
+  static int32_t DayOfWeek(int64_t epoch_day) {
+    int64_t dow0 = ((epoch_day + 3) % 7 + 7) % 7;
+    return static_cast<int32_t>((dow0 + 1) % 7 + 1);
+  }
+
+  int64_t ToEpochDay() const {
+    int64_t y = year;
+    int64_t total = 365 * y;
+    if (y >= 0) {
+      total += (y + 3) / 4 - (y + 99) / 100 + (y + 399) / 400;
+    } else {
+      total -= y / -4 - y / -100 + y / -400;
+    }
+    total += (367 * month - 362) / 12;
+    total += day - 1;
+    if (month > 2) {
+      total--;
+      bool leap = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+      if (!leap) total--;
+    }
+    return total - 719528;
+  }
+};
+
+/// Month, day of week and truncation to the month of date32 arrays, by the JVM's
+/// per value LocalDate arithmetic, by the precompiled gandiva functions the gandiva
+/// projections call through gmtime_r, by a gandiva projector of the trees the columnar
+/// expressions build, and by the branch free kernels of precompile/date_time.h.
+class BenchmarkDateTime : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> dist(DaysFromCivil(1900, 1, 1),
+                                                DaysFromCivil(2100, 12, 31));
+    days_.resize(num_rows);
+    for (auto& day : days_) {
+      day = dist(gen);
+    }
+    out_.resize(num_rows);
+  }
+
+  void Run(const std::string& name, const std::function<void()>& kernel) {
+    uint64_t elapse = 0;
+    TIME_MICRO_OR_THROW(elapse, ([&] {
+                          kernel();
+                          return arrow::Status::OK();
+                        })());
+    int64_t checksum = 0;
+    for (auto value : out_) {
+      checksum += value;
+    }
+    std::cout << name << " took " << TIME_TO_STRING(elapse) << ", "
+              << num_rows / std::max<uint64_t>(1, elapse) << "M rows/s, checksum "
+              << checksum << std::endl;
+  }
+
+  void RunProjector(const std::string& name, const std::string& func_name) {
+    auto field = arrow::field("d", arrow::date32());
+    auto schema = arrow::schema({field});
+    auto date64 = TreeExprBuilder::MakeFunction(
+        "castDATE", {TreeExprBuilder::MakeField(field)}, arrow::date64());
+    auto extract = TreeExprBuilder::MakeFunction(func_name, {date64}, arrow::int64());
+    auto cast = TreeExprBuilder::MakeFunction("castINT", {extract}, arrow::int32());
+    auto expr = TreeExprBuilder::MakeExpression(cast, arrow::field("r", arrow::int32()));
+    std::shared_ptr<gandiva::Projector> projector;
+    THROW_NOT_OK(gandiva::Projector::Make(
+        schema, {expr}, gandiva::ConfigurationBuilder::DefaultConfiguration(),
+        &projector));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (int offset = 0; offset < num_rows; offset += batch_size) {
+      arrow::Date32Builder builder;
+      THROW_NOT_OK(builder.AppendValues(days_.data() + offset, batch_size));
+      std::shared_ptr<arrow::Array> array;
+      THROW_NOT_OK(builder.Finish(&array));
+      batches.push_back(arrow::RecordBatch::Make(schema, batch_size, {array}));
+    }
+    uint64_t elapse = 0;
+    int64_t checksum = 0;
+    auto pool = arrow::default_memory_pool();
+    for (auto& batch : batches) {
+      arrow::ArrayVector outputs;
+      TIME_MICRO_OR_THROW(elapse, projector->Evaluate(*batch, pool, &outputs));
+      auto result = std::dynamic_pointer_cast<arrow::Int32Array>(outputs[0]);
+      for (int i = 0; i < result->length(); i++) {
+        checksum += result->Value(i);
+      }
+    }
+    std::cout << name << " took " << TIME_TO_STRING(elapse) << ", "
+              << num_rows / std::max<uint64_t>(1, elapse) << "M rows/s, checksum "
+              << checksum << std::endl;
+  }
+
+  std::vector<int32_t> days_;
+  std::vector<int32_t> out_;
+};
+
+TEST_F(BenchmarkDateTime, Month) {
+  Run("JVM LocalDate month", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      out_[i] = JavaLocalDate::OfEpochDay(days_[i]).month;
+    }
+  });
+  Run("gandiva extractMonth", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      out_[i] = static_cast<int32_t>(extractMonth_timestamp(castDATE_date32(days_[i])));
+    }
+  });
+  RunProjector("gandiva projector month", "extractMonth");
+  Run("date_time month", [this] { ExtractMonths(days_.data(), num_rows, out_.data()); });
+}
+
+TEST_F(BenchmarkDateTime, DayOfWeek) {
+  Run("JVM LocalDate dayofweek", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      out_[i] = JavaLocalDate::DayOfWeek(days_[i]);
+    }
+  });
+  Run("gandiva extractDow", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      out_[i] = static_cast<int32_t>(extractDow_timestamp(castDATE_date32(days_[i])));
+    }
+  });
+  RunProjector("gandiva projector dayofweek", "extractDow");
+  Run("date_time dayofweek",
+      [this] { ExtractDaysOfWeek(days_.data(), num_rows, out_.data()); });
+}
+
+TEST_F(BenchmarkDateTime, TruncMonth) {
+  Run("JVM LocalDate trunc month", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      auto date = JavaLocalDate::OfEpochDay(days_[i]);
+      date.day = 1;
+      out_[i] = static_cast<int32_t>(date.ToEpochDay());
+    }
+  });
+  Run("gandiva date_trunc_Month", [this] {
+    for (int i = 0; i < num_rows; i++) {
+      out_[i] = DaysOfMillis(date_trunc_Month_date64(castDATE_date32(days_[i])));
+    }
+  });
+  Run("date_time trunc month",
+      [this] { TruncMonths(days_.data(), num_rows, out_.data()); });
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,182 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/builder.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "codegen/common/hash_relation.h"
+#include "tests/test_utils.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+// 1M build rows in 4K row batches, the payload is far beyond the LLC
+const int num_batches = 256;
+const int batch_size = 4096;
+const int num_probes = 4 * 1024 * 1024;
+
+class BenchmarkHashRelationPayload : public ::testing::Test {
+ protected:
+  // a quarter of the payload columns are strings
+  void MakeBuildSide(int num_fields) {
+    std::mt19937_64 gen(42);
+    types_.clear();
+    batches_.clear();
+    for (int f = 0; f < num_fields; f++) {
+      types_.push_back(f % 4 == 3 ? arrow::utf8() : arrow::int64());
+    }
+    for (int b = 0; b < num_batches; b++) {
+      std::vector<std::shared_ptr<arrow::Array>> columns;
+      for (auto type : types_) {
+        std::shared_ptr<arrow::Array> column;
+        if (type->id() == arrow::Type::STRING) {
+          arrow::StringBuilder builder;
+          for (int i = 0; i < batch_size; i++) {
+            ASSERT_NOT_OK(builder.Append(std::string(gen() % 16, 'x')));
+          }
+          ASSERT_NOT_OK(builder.Finish(&column));
+        } else {
+          arrow::Int64Builder builder;
+          for (int i = 0; i < batch_size; i++) {
+            ASSERT_NOT_OK(builder.Append(static_cast<int64_t>(gen())));
+          }
+          ASSERT_NOT_OK(builder.Finish(&column));
+        }
+        columns.push_back(column);
+      }
+      batches_.push_back(columns);
+    }
+    probes_.clear();
+    for (int i = 0; i < num_probes; i++) {
+      probes_.emplace_back(gen() % num_batches, gen() % batch_size);
+    }
+  }
+
+  // reads every payload field of the matched rows, like the generated probe code
+  template <typename Int64Column, typename StringColumn>
+  int64_t Gather(const std::vector<std::shared_ptr<Int64Column>>& int64_columns,
+                 const std::vector<std::shared_ptr<StringColumn>>& string_columns) {
+    int64_t checksum = 0;
+    for (auto& probe : probes_) {
+      for (auto& column : int64_columns) {
+        if (!column->IsNull(probe.array_id, probe.id)) {
+          checksum += column->GetValue(probe.array_id, probe.id);
+        }
+      }
+      for (auto& column : string_columns) {
+        if (!column->IsNull(probe.array_id, probe.id)) {
+          checksum += column->GetValue(probe.array_id, probe.id).size();
+        }
+      }
+    }
+    return checksum;
+  }
+
+  template <template <typename, typename> class ColumnType, typename GetColumnFunc>
+  void DoGather(GetColumnFunc get_column, uint64_t* elapse, int64_t* checksum) {
+    std::vector<std::shared_ptr<ColumnType<arrow::Int64Type, void>>> int64_columns;
+    std::vector<std::shared_ptr<ColumnType<arrow::StringType, void>>> string_columns;
+    for (int f = 0; f < types_.size(); f++) {
+      if (types_[f]->id() == arrow::Type::STRING) {
+        std::shared_ptr<ColumnType<arrow::StringType, void>> column;
+        ASSERT_NOT_OK(get_column(f, &column));
+        string_columns.push_back(column);
+      } else {
+        std::shared_ptr<ColumnType<arrow::Int64Type, void>> column;
+        ASSERT_NOT_OK(get_column(f, &column));
+        int64_columns.push_back(column);
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    *checksum = Gather(int64_columns, string_columns);
+    auto end = std::chrono::steady_clock::now();
+    *elapse = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  }
+
+  void DoBenchmark(int num_fields) {
+    MakeBuildSide(num_fields);
+    // one relation per layout, a relation keeps its payload in one of them
+    auto make_relation = [this](bool rows, std::shared_ptr<HashRelation>* out) {
+      std::vector<std::shared_ptr<HashRelationColumn>> hash_relation_columns;
+      for (auto type : types_) {
+        std::shared_ptr<HashRelationColumn> column;
+        ASSERT_NOT_OK(MakeHashRelationColumn(type->id(), &column));
+        hash_relation_columns.push_back(column);
+      }
+      *out = std::make_shared<HashRelation>(hash_relation_columns);
+      if (rows) {
+        (*out)->EnablePayloadRows(arrow::default_memory_pool(), types_);
+      }
+    };
+    std::shared_ptr<HashRelation> column_relation;
+    std::shared_ptr<HashRelation> row_relation;
+    make_relation(false, &column_relation);
+    make_relation(true, &row_relation);
+    for (auto& batch : batches_) {
+      ASSERT_NOT_OK(column_relation->AppendPayload(batch));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto& batch : batches_) {
+      ASSERT_NOT_OK(row_relation->AppendPayload(batch));
+    }
+    auto end = std::chrono::steady_clock::now();
+    uint64_t elapse_append =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    uint64_t elapse_columns;
+    uint64_t elapse_rows;
+    int64_t checksum_columns;
+    int64_t checksum_rows;
+    DoGather<TypedHashRelationColumn>(
+        [&](int f, auto* out) { return column_relation->GetColumn(f, out); },
+        &elapse_columns, &checksum_columns);
+    DoGather<TypedHashRelationRowColumn>(
+        [&](int f, auto* out) { return row_relation->GetRowColumn(f, out); },
+        &elapse_rows, &checksum_rows);
+    ASSERT_EQ(checksum_columns, checksum_rows);
+
+    std::cout << num_fields << " payload fields, " << num_batches * batch_size
+              << " build rows, " << num_probes << " random matches, row layout "
+              << (HashRelationPayloadRows::Preferred(types_) ? "chosen" : "not chosen")
+              << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_append)
+              << " to pack the payload into rows" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_columns)
+              << " to gather from columns" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_rows) << " to gather from rows"
+              << std::endl;
+  }
+
+  std::vector<std::shared_ptr<arrow::DataType>> types_;
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> batches_;
+  std::vector<ArrayItemIndex> probes_;
+};
+
+TEST_F(BenchmarkHashRelationPayload, NarrowPayload) { DoBenchmark(4); }
+
+TEST_F(BenchmarkHashRelationPayload, WidePayload) { DoBenchmark(24); }
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "third_party/row_wise_memory/hashMap.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+// 8M keys in a 16M slot keyArray (256MB) plus a 128MB bytesMap, far beyond what the
+// TLB covers with 4K pages
+const int num_keys = 8 * 1024 * 1024;
+const int num_probes = 32 * 1024 * 1024;
+
+class BenchmarkHugePage : public ::testing::Test {
+ protected:
+  static int HashKey(int64_t key) {
+    uint64_t h = static_cast<uint64_t>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<int>(h);
+  }
+
+  void DoProbe(const char* mode) {
+    setenv("NATIVESQL_HUGE_PAGE", mode, 1);
+    std::mt19937_64 gen(42);
+    std::vector<int64_t> keys(num_keys);
+    for (auto& key : keys) {
+      key = static_cast<int64_t>(gen());
+    }
+    std::uniform_int_distribution<int> pick(0, num_keys - 1);
+    std::vector<int64_t> probes(num_probes);
+    for (auto& probe : probes) {
+      probe = keys[pick(gen)];
+    }
+
+    uint64_t elapse_build = 0;
+    uint64_t elapse_probe = 0;
+    int64_t num_found = 0;
+    {
+      auto start = std::chrono::steady_clock::now();
+      auto hash_map = createUnsafeHashMap(2 * num_keys, num_keys * 16, sizeof(int64_t));
+      for (int i = 0; i < num_keys; i++) {
+        ArrayItemIndex item(i / 4096, i % 4096);
+        append(hash_map, keys[i], HashKey(keys[i]), (char*)&item, sizeof(item));
+      }
+      auto end = std::chrono::steady_clock::now();
+      elapse_build =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+      start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_probes; i++) {
+        if (safeLookup(hash_map, probes[i], HashKey(probes[i])) == 0) num_found++;
+      }
+      end = std::chrono::steady_clock::now();
+      elapse_probe =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+      // free with the same mode the maps were allocated with
+      destroyHashMap(hash_map);
+    }
+    unsetenv("NATIVESQL_HUGE_PAGE");
+    ASSERT_EQ(num_found, num_probes);
+
+    std::cout << "NATIVESQL_HUGE_PAGE=" << mode << ", " << num_keys << " keys, "
+              << num_probes << " random probes" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_build) << " to build" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_probe) << " to probe, "
+              << num_probes * 1000.0 / elapse_probe << " M probes/s" << std::endl;
+  }
+};
+
+TEST_F(BenchmarkHugePage, ProbeWithoutHugePage) { DoProbe("off"); }
+
+TEST_F(BenchmarkHugePage, ProbeWithTHP) { DoProbe("thp"); }
+
+// falls back to THP when no huge pages are reserved in vm.nr_hugepages
+TEST_F(BenchmarkHugePage, ProbeWithHugeTLB) { DoProbe("hugetlb"); }
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
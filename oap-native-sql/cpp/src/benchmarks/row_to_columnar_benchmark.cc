@@ -0,0 +1,196 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+
+#include "operators/columnar_to_row_converter.h"
+#include "operators/row_to_columnar_converter.h"
+#include "tests/test_utils.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace rowtocolumnar {
+
+const int num_rows = 10000;
+const int num_iterations = 20;
+
+class BenchmarkRowToColumnar : public ::testing::Test {
+ protected:
+  // every fourth column is a string when with_string is set, the rest cycles through
+  // int32, int64 and double, about 10% of the values are null
+  std::shared_ptr<arrow::RecordBatch> MakeWideBatch(int num_columns, bool with_string) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> value_dist(0, 1 << 20);
+    std::uniform_int_distribution<int32_t> length_dist(0, 32);
+    std::bernoulli_distribution null_dist(0.1);
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (int col = 0; col < num_columns; col++) {
+      std::shared_ptr<arrow::Array> array;
+      std::string name = "f" + std::to_string(col);
+      if (with_string && col % 4 == 3) {
+        arrow::StringBuilder builder;
+        for (int i = 0; i < num_rows; i++) {
+          if (null_dist(gen)) {
+            THROW_NOT_OK(builder.AppendNull());
+          } else {
+            THROW_NOT_OK(builder.Append(std::string(length_dist(gen), 'x')));
+          }
+        }
+        THROW_NOT_OK(builder.Finish(&array));
+      } else if (col % 3 == 0) {
+        arrow::Int32Builder builder;
+        for (int i = 0; i < num_rows; i++) {
+          if (null_dist(gen)) {
+            THROW_NOT_OK(builder.AppendNull());
+          } else {
+            THROW_NOT_OK(builder.Append(value_dist(gen)));
+          }
+        }
+        THROW_NOT_OK(builder.Finish(&array));
+      } else if (col % 3 == 1) {
+        arrow::Int64Builder builder;
+        for (int i = 0; i < num_rows; i++) {
+          if (null_dist(gen)) {
+            THROW_NOT_OK(builder.AppendNull());
+          } else {
+            THROW_NOT_OK(builder.Append(value_dist(gen)));
+          }
+        }
+        THROW_NOT_OK(builder.Finish(&array));
+      } else {
+        arrow::DoubleBuilder builder;
+        for (int i = 0; i < num_rows; i++) {
+          if (null_dist(gen)) {
+            THROW_NOT_OK(builder.AppendNull());
+          } else {
+            THROW_NOT_OK(builder.Append(value_dist(gen) / 3.0));
+          }
+        }
+        THROW_NOT_OK(builder.Finish(&array));
+      }
+      fields.push_back(arrow::field(name, array->type()));
+      arrays.push_back(array);
+    }
+    return arrow::RecordBatch::Make(arrow::schema(fields), num_rows, arrays);
+  }
+
+  // Reads the rows one value at a time into array builders. A C++ baseline for a
+  // row-at-a-time conversion, it doesn't measure the JVM path that fills arrow vectors
+  // from UnsafeRows, whose cost also includes the JVM getters and vector writes.
+  static arrow::Status ConvertRowByRow(const std::shared_ptr<arrow::Schema>& schema,
+                                       int64_t length, const int64_t* row_offsets,
+                                       const uint8_t* memory_address,
+                                       std::shared_ptr<arrow::RecordBatch>* out) {
+    std::unique_ptr<arrow::RecordBatchBuilder> builder;
+    RETURN_NOT_OK(
+        arrow::RecordBatchBuilder::Make(schema, arrow::default_memory_pool(), &builder));
+    int32_t num_fields = schema->num_fields();
+    int64_t nullbitset_width = columnartorow::CalculateBitSetWidthInBytes(num_fields);
+    for (int64_t i = 0; i < length; i++) {
+      auto row = memory_address + row_offsets[i];
+      for (int32_t col = 0; col < num_fields; col++) {
+        auto field_builder = builder->GetField(col);
+        if ((row[col >> 3] >> (col & 7)) & 1) {
+          RETURN_NOT_OK(field_builder->AppendNull());
+          continue;
+        }
+        auto slot = row + nullbitset_width + col * 8;
+        switch (schema->field(col)->type()->id()) {
+          case arrow::Type::INT32: {
+            int32_t value;
+            memcpy(&value, slot, sizeof(int32_t));
+            RETURN_NOT_OK(
+                static_cast<arrow::Int32Builder*>(field_builder)->Append(value));
+          } break;
+          case arrow::Type::INT64: {
+            int64_t value;
+            memcpy(&value, slot, sizeof(int64_t));
+            RETURN_NOT_OK(
+                static_cast<arrow::Int64Builder*>(field_builder)->Append(value));
+          } break;
+          case arrow::Type::DOUBLE: {
+            double value;
+            memcpy(&value, slot, sizeof(double));
+            RETURN_NOT_OK(
+                static_cast<arrow::DoubleBuilder*>(field_builder)->Append(value));
+          } break;
+          case arrow::Type::STRING: {
+            int64_t offset_and_size;
+            memcpy(&offset_and_size, slot, sizeof(int64_t));
+            RETURN_NOT_OK(static_cast<arrow::StringBuilder*>(field_builder)
+                              ->Append(row + (offset_and_size >> 32),
+                                       static_cast<int32_t>(offset_and_size)));
+          } break;
+          default:
+            return arrow::Status::NotImplemented("ConvertRowByRow doesn't support ",
+                                                 schema->field(col)->type()->ToString());
+        }
+      }
+    }
+    return builder->Flush(out);
+  }
+
+  void DoConvert(int num_columns, bool with_string) {
+    auto input_batch = MakeWideBatch(num_columns, with_string);
+    columnartorow::ColumnarToRowConverter row_converter(input_batch,
+                                                        arrow::default_memory_pool());
+    ASSERT_NOT_OK(row_converter.Init());
+    ASSERT_NOT_OK(row_converter.Write());
+    auto row_offsets = row_converter.GetOffsets().data();
+    auto memory_address = row_converter.GetBufferAddress();
+
+    uint64_t elapse_native = 0;
+    uint64_t elapse_row_by_row = 0;
+    std::shared_ptr<arrow::RecordBatch> native_batch;
+    std::shared_ptr<arrow::RecordBatch> row_by_row_batch;
+    for (int i = 0; i < num_iterations; i++) {
+      RowToColumnarConverter converter(input_batch->schema(), num_rows, row_offsets,
+                                       memory_address, arrow::default_memory_pool());
+      TIME_NANO_OR_THROW(elapse_native, converter.Convert(&native_batch));
+      TIME_NANO_OR_THROW(elapse_row_by_row,
+                         ConvertRowByRow(input_batch->schema(), num_rows, row_offsets,
+                                         memory_address, &row_by_row_batch));
+    }
+    ASSERT_NOT_OK(Equals(*input_batch, *native_batch));
+    ASSERT_NOT_OK(Equals(*input_batch, *row_by_row_batch));
+
+    std::cout << num_columns << " columns" << (with_string ? " with string" : "")
+              << ", " << num_rows << " rows, " << row_converter.GetBufferSize()
+              << " bytes of UnsafeRow, " << num_iterations << " iterations" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_native)
+              << " to convert in columns" << std::endl
+              << "Took " << TIME_NANO_TO_STRING(elapse_row_by_row)
+              << " to convert row by row with C++ builders (not the JVM path)"
+              << std::endl;
+  }
+};
+
+TEST_F(BenchmarkRowToColumnar, WideNumeric) { DoConvert(200, false); }
+
+TEST_F(BenchmarkRowToColumnar, WideWithString) { DoConvert(200, true); }
+
+}  // namespace rowtocolumnar
+}  // namespace sparkcolumnarplugin
@@ -332,6 +332,12 @@ arrow::Status ExprVisitor::MakeExprVisitorImpl(
     } else if (child_func_name.compare("ConcatArrayList") == 0) {
       RETURN_NOT_OK(
           ConcatArrayListVisitorImpl::Make(field_list, func_node, ret_fields, p, &impl_));
+    } else if (child_func_name.compare("CoalesceBatches") == 0) {
+      RETURN_NOT_OK(
+          CoalesceBatchesVisitorImpl::Make(field_list, func_node, ret_fields, p, &impl_));
+    } else if (child_func_name.compare("Expand") == 0) {
+      RETURN_NOT_OK(
+          ExpandVisitorImpl::Make(field_list, func_node, ret_fields, p, &impl_));
     }
     goto finish;
   }
@@ -120,6 +120,15 @@ class ActionCodeGen {
   std::vector<std::string> finish_var_to_builder_codes_list_;
   std::vector<std::string> finish_var_to_array_codes_list_;
   std::vector<std::string> finish_var_array_codes_list_;
+  // The aggregate inputs are known to hold no null when the generated callbacks are
+  // instantiated with null_free as std::true_type, the check then folds away. Group
+  // by keys are not covered by that, their nulls are checked on every batch.
+  std::string GetValidString(const std::string& typed_array) {
+    if (is_key_) {
+      return "!" + typed_array + "->IsNull(cur_id_)";
+    }
+    return "null_free || !" + typed_array + "->IsNull(cur_id_)";
+  }
   std::string Replace(std::string& str_input, const std::string& oldStr,
                       const std::string& newStr) {
     auto str = str_input;
@@ -293,8 +302,8 @@ class GroupByActionCodeGen : public ActionCodeGen {
       auto tmp_name = typed_input_and_prepare_list_[0].first + "_tmp";
 
       std::stringstream prepare_codes_ss;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << sig_name << ".push_back("
                          << typed_input_and_prepare_list_[0].first
@@ -420,8 +429,8 @@ class SumActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -546,8 +555,8 @@ class CountActionCodeGen : public ActionCodeGen {
       auto count_name_tmp = tmp_name + "_count";
       prepare_codes_ss << GetCTypeString(data_type) << " " << count_name_tmp << " = 0;"
                        << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << count_name_tmp << " = 1;" << std::endl;
       prepare_codes_ss << "}" << std::endl;
 
@@ -671,8 +680,8 @@ class SumCountActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -739,8 +748,8 @@ class SumCountActionCodeGen : public ActionCodeGen {
       auto count_name_tmp = tmp_name + "_count";
       prepare_codes_ss << GetCTypeString(data_type) << " " << count_name_tmp << " = 0;"
                        << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << count_name_tmp << " = 1;" << std::endl;
       prepare_codes_ss << "}" << std::endl;
 
@@ -811,8 +820,8 @@ class AvgByCountActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                     << ") {" << std::endl;
     prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -860,8 +869,8 @@ class AvgByCountActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[2].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[2].first)
+                     << ") {" << std::endl;
     prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[2].first
@@ -998,8 +1007,8 @@ class MaxActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -1115,8 +1124,8 @@ class MinActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -1225,8 +1234,8 @@ class AvgActionCodeGen : public ActionCodeGen {
       std::stringstream prepare_codes_ss;
       prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                        << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
                          << "->GetView(cur_id_);" << std::endl;
@@ -1252,8 +1261,8 @@ class AvgActionCodeGen : public ActionCodeGen {
       auto count_name_tmp = tmp_name + "_count";
       prepare_codes_ss << GetCTypeString(data_type) << " " << count_name_tmp << " = 0;"
                        << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << count_name_tmp << " = 1;" << std::endl;
       prepare_codes_ss << "}" << std::endl;
       func_sig_define_codes_list_.push_back(
@@ -1329,8 +1338,8 @@ class SumCountMergeActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                     << ") {" << std::endl;
     prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
@@ -1410,8 +1419,8 @@ class SumCountMergeActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool " << tmp_name << "_validity = false;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[2].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[2].first)
+                     << ") {" << std::endl;
     prepare_codes_ss << tmp_name << "_validity = true;" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[2].first
@@ -1515,8 +1524,8 @@ class StddevSampPartialActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << sum_tmp_name << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool is_null_" << sum_tmp_name << " = true;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       if (data_type->id() != arrow::Type::STRING) {
         prepare_codes_ss << sum_tmp_name << " = "
                          << typed_input_and_prepare_list_[0].first
@@ -1554,8 +1563,8 @@ class StddevSampPartialActionCodeGen : public ActionCodeGen {
       prepare_codes_ss << GetCTypeString(data_type) << " " << count_name_tmp << " = 0;"
                        << std::endl;
       prepare_codes_ss << "bool is_null_" << count_name_tmp << " = true;" << std::endl;
-      prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                       << "->IsNull(cur_id_)) {" << std::endl;
+      prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                       << ") {" << std::endl;
       prepare_codes_ss << count_name_tmp << " = 1;" << std::endl;
       prepare_codes_ss << "is_null_" << count_name_tmp << " = false;" << std::endl;
       prepare_codes_ss << "}" << std::endl;
@@ -1667,8 +1676,8 @@ class StddevSampFinalActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool is_null_" << tmp_name << " = true;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[0].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[0].first)
+                     << ") {" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[0].first
                        << "->GetView(cur_id_);" << std::endl;
@@ -1698,8 +1707,8 @@ class StddevSampFinalActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool is_null_" << tmp_name << " = true;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[1].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[1].first)
+                     << ") {" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[1].first
                        << "->GetView(cur_id_);" << std::endl;
@@ -1730,8 +1739,8 @@ class StddevSampFinalActionCodeGen : public ActionCodeGen {
     prepare_codes_ss << GetCTypeString(data_type) << " " << tmp_name << " = 0;"
                      << std::endl;
     prepare_codes_ss << "bool is_null_" << tmp_name << " = true;" << std::endl;
-    prepare_codes_ss << "if (!" << typed_input_and_prepare_list_[2].first
-                     << "->IsNull(cur_id_)) {" << std::endl;
+    prepare_codes_ss << "if (" << GetValidString(typed_input_and_prepare_list_[2].first)
+                     << ") {" << std::endl;
     if (data_type->id() != arrow::Type::STRING) {
       prepare_codes_ss << tmp_name << " = " << typed_input_and_prepare_list_[2].first
                        << "->GetView(cur_id_);" << std::endl;
@@ -17,11 +17,34 @@
 
 #include "codegen/arrow_compute/ext/actions_impl.h"
 
+#include <arrow/filesystem/path_util.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/util/io_util.h>
+#include <arrow/util/string_view.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "codegen/arrow_compute/ext/compact_distinct_set.h"
+#include "codegen/arrow_compute/ext/hyperloglog_plus_plus.h"
+#include "codegen/arrow_compute/ext/quantile_summaries.h"
+#include "precompile/decimal.h"
+#include "third_party/arrow/utils/hashing.h"
+#include "third_party/xxhash/xxhash64.h"
+
 namespace sparkcolumnarplugin {
 namespace codegen {
 namespace arrowcompute {
 namespace extra {
 
+namespace xxhash64 = sparkcolumnarplugin::thirdparty::xxhash64;
+
 // Find the largest compatible primitive type for a primitive type.
 template <typename I, typename Enable = void>
 struct FindAccumulatorType {};
@@ -817,29 +840,126 @@ class AvgAction : public ActionBase {
   std::vector<bool> cache_validity_;
 };
 
-//////////////// SumCountAction ///////////////
-template <typename DataType>
-class SumCountAction : public ActionBase {
+//////////////// DecimalSums ///////////////
+// Per group sums of a decimal column. Short decimals are summed in int64 and a
+// group only moves its sum to the 128 bit accumulator when an addition overflows,
+// wider decimals are summed in 128 bit right away.
+class DecimalSums {
  public:
-  SumCountAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
-    std::unique_ptr<arrow::ArrayBuilder> sum_builder;
-    std::unique_ptr<arrow::ArrayBuilder> count_builder;
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                      arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &sum_builder);
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                      arrow::TypeTraits<arrow::Int64Type>::type_singleton(), &count_builder);                   
-    sum_builder_.reset(
-        arrow::internal::checked_cast<arrow::DoubleBuilder*>(sum_builder.release()));
-    count_builder_.reset(
-        arrow::internal::checked_cast<arrow::Int64Builder*>(count_builder.release()));
+  DecimalSums(const std::shared_ptr<arrow::DataType>& type) {
+    auto decimal_type = std::dynamic_pointer_cast<arrow::Decimal128Type>(type);
+    precision_ = decimal_type->precision();
+    scale_ = decimal_type->scale();
+    short_input_ = precision_ <= precompile::kMaxShortDecimalPrecision;
+  }
+
+  int32_t precision() const { return precision_; }
+  int32_t scale() const { return scale_; }
+
+  void Resize(int size) {
+    if (short_sums_.size() < size) {
+      short_sums_.resize(size, 0);
+      wide_sums_.resize(size, 0);
+      overflow_.resize(size, false);
+    }
+  }
+
+  void Reset(const std::shared_ptr<arrow::Array>& in) {
+    // little endian 128 bit values, low word first
+    values_ = in->data()->GetValues<int64_t>(1, in->offset() * 2);
+  }
+
+  inline void Add(int group_id, int row_id) {
+    if (short_input_) {
+      auto value = values_[row_id * 2];
+      int64_t sum;
+      if (__builtin_add_overflow(short_sums_[group_id], value, &sum)) {
+        wide_sums_[group_id] += static_cast<precompile::int128_t>(short_sums_[group_id]) +
+                                value;
+        short_sums_[group_id] = 0;
+      } else {
+        short_sums_[group_id] = sum;
+      }
+    } else {
+      auto value = static_cast<precompile::int128_t>(
+          (static_cast<precompile::uint128_t>(values_[row_id * 2 + 1]) << 64) |
+          static_cast<uint64_t>(values_[row_id * 2]));
+      if (__builtin_add_overflow(wide_sums_[group_id], value, &wide_sums_[group_id])) {
+        overflow_[group_id] = true;
+      }
+    }
+  }
+
+  // false when the sum no longer fits in 128 bit
+  inline bool Get(int group_id, precompile::int128_t* out) const {
+    *out = wide_sums_[group_id] + short_sums_[group_id];
+    return !overflow_[group_id];
+  }
 
+  // the sum as an int64 if it never left the short accumulator
+  inline bool GetShort(int group_id, int64_t* out) const {
+    *out = short_sums_[group_id];
+    return wide_sums_[group_id] == 0 && !overflow_[group_id];
+  }
+
+  // the sum of the group divided by count, rounded half up to res_scale, false when
+  // it doesn't fit in res_precision
+  bool GetAvg(int group_id, int64_t count, int32_t res_precision, int32_t res_scale,
+              arrow::Decimal128* out) const {
+    int64_t short_sum;
+    int64_t short_scaled;
+    if (GetShort(group_id, &short_sum) &&
+        precompile::RescaleShortDecimal(short_sum, scale_, res_scale, &short_scaled)) {
+      auto avg = precompile::DivideRoundHalfUp<int64_t>(short_scaled, count);
+      *out = arrow::Decimal128(avg);
+      return precompile::DecimalFitsInPrecision(avg, res_precision);
+    }
+    precompile::int128_t sum;
+    precompile::int128_t scaled;
+    if (!Get(group_id, &sum) ||
+        !precompile::RescaleDecimal(sum, scale_, res_scale, &scaled)) {
+      return false;
+    }
+    auto avg = precompile::DivideRoundHalfUp<precompile::int128_t>(scaled, count);
+    *out = precompile::FromInt128(avg);
+    return precompile::DecimalFitsInPrecision(avg, res_precision);
+  }
+
+  uint64_t size() const { return short_sums_.size(); }
+
+ private:
+  int32_t precision_;
+  int32_t scale_;
+  bool short_input_;
+  const int64_t* values_;
+  std::vector<int64_t> short_sums_;
+  std::vector<precompile::int128_t> wide_sums_;
+  std::vector<bool> overflow_;
+};
+
+// sum(decimal(p, s)) and the sum of avg's buffer are decimal(p + 10, s) in Spark
+static int32_t GetDecimalSumPrecision(const std::shared_ptr<arrow::DataType>& type) {
+  auto decimal_type = std::dynamic_pointer_cast<arrow::Decimal128Type>(type);
+  return std::min(precompile::kMaxDecimalPrecision, decimal_type->precision() + 10);
+}
+
+//////////////// DecimalSumAction ///////////////
+// Sums into decimal(res_precision, s), sums overflowing it are null. The partial sum
+// widens the input by 10 digits, merging the partial sums keeps their precision.
+class DecimalSumAction : public ActionBase {
+ public:
+  DecimalSumAction(arrow::compute::FunctionContext* ctx,
+                   std::shared_ptr<arrow::DataType> type, int32_t res_precision)
+      : ctx_(ctx), sums_(type), res_precision_(res_precision) {
 #ifdef DEBUG
-    std::cout << "Construct SumCountAction" << std::endl;
+    std::cout << "Construct DecimalSumAction" << std::endl;
 #endif
+    builder_.reset(new arrow::Decimal128Builder(
+        arrow::decimal(res_precision_, sums_.scale()), ctx_->memory_pool()));
   }
-  ~SumCountAction() {
+  ~DecimalSumAction() {
 #ifdef DEBUG
-    std::cout << "Destruct SumCountAction" << std::endl;
+    std::cout << "Destruct DecimalSumAction" << std::endl;
 #endif
   }
 
@@ -849,29 +969,28 @@ class SumCountAction : public ActionBase {
                        std::function<arrow::Status(int)>* on_valid,
                        std::function<arrow::Status()>* on_null) override {
     // resize result data
-    if (cache_sum_.size() <= max_group_id) {
-      cache_sum_.resize(max_group_id + 1, 0);
-      cache_count_.resize(max_group_id + 1, 0);
+    if (cache_validity_.size() <= max_group_id) {
+      cache_validity_.resize(max_group_id + 1, false);
+      sums_.Resize(max_group_id + 1);
     }
 
     in_ = in_list[0];
-    // prepare evaluate lambda
-    data_ = const_cast<CType*>(in_->data()->GetValues<CType>(1));
+    sums_.Reset(in_);
     row_id = 0;
     if (in_->null_count()) {
       *on_valid = [this](int dest_group_id) {
         const bool is_null = in_->IsNull(row_id);
         if (!is_null) {
-          cache_sum_[dest_group_id] += data_[row_id];
-          cache_count_[dest_group_id] += 1;
+          cache_validity_[dest_group_id] = true;
+          sums_.Add(dest_group_id, row_id);
         }
         row_id++;
         return arrow::Status::OK();
       };
     } else {
       *on_valid = [this](int dest_group_id) {
-        cache_sum_[dest_group_id] += data_[row_id];
-        cache_count_[dest_group_id] += 1;
+        cache_validity_[dest_group_id] = true;
+        sums_.Add(dest_group_id, row_id);
         row_id++;
         return arrow::Status::OK();
       };
@@ -884,113 +1003,196 @@ class SumCountAction : public ActionBase {
   }
 
   arrow::Status Finish(ArrayList* out) override {
-    auto length = GetResultLength();
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_validity_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    std::shared_ptr<arrow::Array> arr_out;
+    builder_->Reset();
     for (uint64_t i = 0; i < length; i++) {
-      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[i]));
-      RETURN_NOT_OK(count_builder_->Append(cache_count_[i]));
+      precompile::int128_t sum;
+      if (cache_validity_[offset + i] && sums_.Get(offset + i, &sum) &&
+          precompile::DecimalFitsInPrecision(sum, res_precision_)) {
+        RETURN_NOT_OK(builder_->Append(precompile::FromInt128(sum)));
+      } else {
+        RETURN_NOT_OK(builder_->AppendNull());
+      }
     }
 
-    std::shared_ptr<arrow::Array> sum_array;
-    std::shared_ptr<arrow::Array> count_array;
-    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
-    RETURN_NOT_OK(count_builder_->Finish(&count_array));
-    out->push_back(sum_array);
-    out->push_back(count_array);
+    RETURN_NOT_OK(builder_->Finish(&arr_out));
+    out->push_back(arr_out);
     return arrow::Status::OK();
   }
 
-  uint64_t GetResultLength() { return cache_sum_.size(); }
+ private:
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<arrow::Array> in_;
+  int row_id;
+  // result
+  DecimalSums sums_;
+  int32_t res_precision_;
+  std::vector<bool> cache_validity_;
+  std::unique_ptr<arrow::Decimal128Builder> builder_;
+};
+
+//////////////// DecimalAvgAction ///////////////
+// avg(decimal(p, s)) is decimal(p + 4, s + 4) in Spark, rounded half up.
+class DecimalAvgAction : public ActionBase {
+ public:
+  DecimalAvgAction(arrow::compute::FunctionContext* ctx,
+                   std::shared_ptr<arrow::DataType> type)
+      : ctx_(ctx), sums_(type) {
+#ifdef DEBUG
+    std::cout << "Construct DecimalAvgAction" << std::endl;
+#endif
+    res_precision_ = std::min(precompile::kMaxDecimalPrecision, sums_.precision() + 4);
+    res_scale_ = std::min(precompile::kMaxDecimalPrecision, sums_.scale() + 4);
+    builder_.reset(new arrow::Decimal128Builder(
+        arrow::decimal(res_precision_, res_scale_), ctx_->memory_pool()));
+  }
+  ~DecimalAvgAction() {
+#ifdef DEBUG
+    std::cout << "Destruct DecimalAvgAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 1; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_validity_.size() <= max_group_id) {
+      cache_validity_.resize(max_group_id + 1, false);
+      cache_count_.resize(max_group_id + 1, 0);
+      sums_.Resize(max_group_id + 1);
+    }
+
+    in_ = in_list[0];
+    sums_.Reset(in_);
+    row_id = 0;
+    if (in_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        const bool is_null = in_->IsNull(row_id);
+        if (!is_null) {
+          cache_validity_[dest_group_id] = true;
+          sums_.Add(dest_group_id, row_id);
+          cache_count_[dest_group_id] += 1;
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        cache_validity_[dest_group_id] = true;
+        sums_.Add(dest_group_id, row_id);
+        cache_count_[dest_group_id] += 1;
+        row_id++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_validity_.size(); }
 
   arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
-    sum_builder_->Reset();
-    count_builder_->Reset();
+    std::shared_ptr<arrow::Array> arr_out;
+    builder_->Reset();
     for (uint64_t i = 0; i < length; i++) {
-      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[offset + i]));
-      RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
+      arrow::Decimal128 avg;
+      if (cache_validity_[offset + i] &&
+          sums_.GetAvg(offset + i, cache_count_[offset + i], res_precision_, res_scale_,
+                       &avg)) {
+        RETURN_NOT_OK(builder_->Append(avg));
+      } else {
+        RETURN_NOT_OK(builder_->AppendNull());
+      }
     }
 
-    std::shared_ptr<arrow::Array> sum_array;
-    std::shared_ptr<arrow::Array> count_array;
-    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
-    RETURN_NOT_OK(count_builder_->Finish(&count_array));
-    out->push_back(sum_array);
-    out->push_back(count_array);
+    RETURN_NOT_OK(builder_->Finish(&arr_out));
+    out->push_back(arr_out);
     return arrow::Status::OK();
   }
 
  private:
-  using CType = typename arrow::TypeTraits<DataType>::CType;
-  using ResDataType = typename FindAccumulatorType<DataType>::Type;
-  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
-  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
-  std::unique_ptr<arrow::DoubleBuilder> sum_builder_;
-  std::unique_ptr<arrow::Int64Builder> count_builder_;
   // input
   arrow::compute::FunctionContext* ctx_;
-  CType* data_;
   std::shared_ptr<arrow::Array> in_;
   int row_id;
   // result
-  std::vector<double> cache_sum_;
+  DecimalSums sums_;
+  int32_t res_precision_;
+  int32_t res_scale_;
   std::vector<int64_t> cache_count_;
+  std::vector<bool> cache_validity_;
+  std::unique_ptr<arrow::Decimal128Builder> builder_;
 };
 
-//////////////// SumCountMergeAction ///////////////
-template <typename DataType>
-class SumCountMergeAction : public ActionBase {
+//////////////// DecimalSumCountAction ///////////////
+// Partial avg of a decimal, the sum as decimal(p + 10, s) and the count. Like Spark's
+// buffer a group without values sums to 0, a sum overflowing its precision is null.
+// With merge set the input is such a buffer, whose sums keep their precision and
+// whose counts are added up, null sums are skipped with their counts.
+class DecimalSumCountAction : public ActionBase {
  public:
-  SumCountMergeAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
-    std::unique_ptr<arrow::ArrayBuilder> sum_builder;
-    std::unique_ptr<arrow::ArrayBuilder> count_builder;
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                      arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &sum_builder);
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                      arrow::TypeTraits<arrow::Int64Type>::type_singleton(), &count_builder);                   
-    sum_builder_.reset(
-        arrow::internal::checked_cast<arrow::DoubleBuilder*>(sum_builder.release()));
-    count_builder_.reset(
-        arrow::internal::checked_cast<arrow::Int64Builder*>(count_builder.release()));
+  DecimalSumCountAction(arrow::compute::FunctionContext* ctx,
+                        std::shared_ptr<arrow::DataType> type, bool merge)
+      : ctx_(ctx), sums_(type), merge_(merge) {
 #ifdef DEBUG
-    std::cout << "Construct SumCountMergeAction" << std::endl;
+    std::cout << "Construct DecimalSumCountAction" << std::endl;
 #endif
+    res_precision_ = merge_ ? sums_.precision() : GetDecimalSumPrecision(type);
+    sum_builder_.reset(new arrow::Decimal128Builder(
+        arrow::decimal(res_precision_, sums_.scale()), ctx_->memory_pool()));
+    count_builder_.reset(new arrow::Int64Builder(ctx_->memory_pool()));
   }
-  ~SumCountMergeAction() {
+  ~DecimalSumCountAction() {
 #ifdef DEBUG
-    std::cout << "Destruct SumCountMergeAction" << std::endl;
+    std::cout << "Destruct DecimalSumCountAction" << std::endl;
 #endif
   }
 
-  int RequiredColNum() { return 2; }
+  int RequiredColNum() { return merge_ ? 2 : 1; }
 
   arrow::Status Submit(ArrayList in_list, int max_group_id,
                        std::function<arrow::Status(int)>* on_valid,
                        std::function<arrow::Status()>* on_null) override {
     // resize result data
-    if (cache_sum_.size() <= max_group_id) {
-      cache_sum_.resize(max_group_id + 1, 0);
+    if (cache_count_.size() <= max_group_id) {
       cache_count_.resize(max_group_id + 1, 0);
+      sums_.Resize(max_group_id + 1);
     }
 
     in_sum_ = in_list[0];
-    in_count_ = in_list[1];
-    // prepare evaluate lambda
-    data_sum_ = const_cast<double*>(in_sum_->data()->GetValues<double>(1));
-    data_count_ = const_cast<int64_t*>(in_count_->data()->GetValues<int64_t>(1));
+    sums_.Reset(in_sum_);
+    data_count_ = merge_ ? in_list[1]->data()->GetValues<int64_t>(1) : nullptr;
     row_id = 0;
     if (in_sum_->null_count()) {
       *on_valid = [this](int dest_group_id) {
         const bool is_null = in_sum_->IsNull(row_id);
         if (!is_null) {
-          cache_sum_[dest_group_id] += data_sum_[row_id];
-          cache_count_[dest_group_id] += data_count_[row_id];
+          sums_.Add(dest_group_id, row_id);
+          cache_count_[dest_group_id] += merge_ ? data_count_[row_id] : 1;
         }
         row_id++;
         return arrow::Status::OK();
       };
     } else {
       *on_valid = [this](int dest_group_id) {
-        cache_sum_[dest_group_id] += data_sum_[row_id];
-        cache_count_[dest_group_id] += data_count_[row_id];
+        sums_.Add(dest_group_id, row_id);
+        cache_count_[dest_group_id] += merge_ ? data_count_[row_id] : 1;
         row_id++;
         return arrow::Status::OK();
       };
@@ -1003,28 +1205,22 @@ class SumCountMergeAction : public ActionBase {
   }
 
   arrow::Status Finish(ArrayList* out) override {
-    auto length = GetResultLength();
-    for (uint64_t i = 0; i < length; i++) {
-      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[i]));
-      RETURN_NOT_OK(count_builder_->Append(cache_count_[i]));
-    }
-
-    std::shared_ptr<arrow::Array> sum_array;
-    std::shared_ptr<arrow::Array> count_array;
-    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
-    RETURN_NOT_OK(count_builder_->Finish(&count_array));
-    out->push_back(sum_array);
-    out->push_back(count_array);
-    return arrow::Status::OK();
+    return Finish(0, GetResultLength(), out);
   }
 
-  uint64_t GetResultLength() { return cache_sum_.size(); }
+  uint64_t GetResultLength() { return cache_count_.size(); }
 
   arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
     sum_builder_->Reset();
     count_builder_->Reset();
     for (uint64_t i = 0; i < length; i++) {
-      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[offset + i]));
+      precompile::int128_t sum;
+      if (sums_.Get(offset + i, &sum) &&
+          precompile::DecimalFitsInPrecision(sum, res_precision_)) {
+        RETURN_NOT_OK(sum_builder_->Append(precompile::FromInt128(sum)));
+      } else {
+        RETURN_NOT_OK(sum_builder_->AppendNull());
+      }
       RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
     }
 
@@ -1038,42 +1234,40 @@ class SumCountMergeAction : public ActionBase {
   }
 
  private:
-  using CType = typename arrow::TypeTraits<DataType>::CType;
-  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
-  using ResDataType = typename FindAccumulatorType<DataType>::Type;
-  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
-  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
-  std::unique_ptr<arrow::DoubleBuilder> sum_builder_;
-  std::unique_ptr<arrow::Int64Builder> count_builder_;
   // input
   arrow::compute::FunctionContext* ctx_;
-  double* data_sum_;
-  int64_t* data_count_;
-  int row_id;
   std::shared_ptr<arrow::Array> in_sum_;
-  std::shared_ptr<arrow::Array> in_count_;
+  const int64_t* data_count_;
+  int row_id;
   // result
-  std::vector<double> cache_sum_;
+  DecimalSums sums_;
+  bool merge_;
+  int32_t res_precision_;
   std::vector<int64_t> cache_count_;
+  std::unique_ptr<arrow::Decimal128Builder> sum_builder_;
+  std::unique_ptr<arrow::Int64Builder> count_builder_;
 };
 
-//////////////// AvgByCountAction ///////////////
-template <typename DataType>
-class AvgByCountAction : public ActionBase {
+//////////////// DecimalAvgByCountAction ///////////////
+// Final avg of a decimal from the sum and count buffers, as res_type rounded half up.
+// Null when no partial saw a value or the average overflows.
+class DecimalAvgByCountAction : public ActionBase {
  public:
-  AvgByCountAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
-    std::unique_ptr<arrow::ArrayBuilder> builder;
-    arrow::MakeBuilder(ctx_->memory_pool(), 
-        arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &builder);
-    builder_.reset(
-      arrow::internal::checked_cast<arrow::DoubleBuilder*>(builder.release()));                      
+  DecimalAvgByCountAction(arrow::compute::FunctionContext* ctx,
+                          std::shared_ptr<arrow::DataType> type,
+                          std::shared_ptr<arrow::DataType> res_type)
+      : ctx_(ctx), sums_(type) {
 #ifdef DEBUG
-    std::cout << "Construct AvgByCountAction" << std::endl;
+    std::cout << "Construct DecimalAvgByCountAction" << std::endl;
 #endif
+    auto decimal_type = std::dynamic_pointer_cast<arrow::Decimal128Type>(res_type);
+    res_precision_ = decimal_type->precision();
+    res_scale_ = decimal_type->scale();
+    builder_.reset(new arrow::Decimal128Builder(res_type, ctx_->memory_pool()));
   }
-  ~AvgByCountAction() {
+  ~DecimalAvgByCountAction() {
 #ifdef DEBUG
-    std::cout << "Destruct AvgByCountAction" << std::endl;
+    std::cout << "Destruct DecimalAvgByCountAction" << std::endl;
 #endif
   }
 
@@ -1083,23 +1277,20 @@ class AvgByCountAction : public ActionBase {
                        std::function<arrow::Status(int)>* on_valid,
                        std::function<arrow::Status()>* on_null) override {
     // resize result data
-    if (cache_validity_.size() <= max_group_id) {
-      cache_validity_.resize(max_group_id + 1, false);
-      cache_sum_.resize(max_group_id + 1, 0);
+    if (cache_count_.size() <= max_group_id) {
       cache_count_.resize(max_group_id + 1, 0);
+      sums_.Resize(max_group_id + 1);
     }
 
     in_sum_ = in_list[0];
-    in_count_ = in_list[1];
-    // prepare evaluate lambda
-    data_sum_ = const_cast<double*>(in_sum_->data()->GetValues<double>(1));
-    data_count_ = const_cast<int64_t*>(in_count_->data()->GetValues<int64_t>(1));
+    sums_.Reset(in_sum_);
+    data_count_ = in_list[1]->data()->GetValues<int64_t>(1);
     row_id = 0;
     if (in_sum_->null_count()) {
       *on_valid = [this](int dest_group_id) {
         const bool is_null = in_sum_->IsNull(row_id);
         if (!is_null) {
-          cache_sum_[dest_group_id] += data_sum_[row_id];
+          sums_.Add(dest_group_id, row_id);
           cache_count_[dest_group_id] += data_count_[row_id];
         }
         row_id++;
@@ -1107,7 +1298,7 @@ class AvgByCountAction : public ActionBase {
       };
     } else {
       *on_valid = [this](int dest_group_id) {
-        cache_sum_[dest_group_id] += data_sum_[row_id];
+        sums_.Add(dest_group_id, row_id);
         cache_count_[dest_group_id] += data_count_[row_id];
         row_id++;
         return arrow::Status::OK();
@@ -1121,95 +1312,67 @@ class AvgByCountAction : public ActionBase {
   }
 
   arrow::Status Finish(ArrayList* out) override {
-    std::shared_ptr<arrow::Array> out_arr;
-    for (int i = 0; i < cache_sum_.size(); i++) {
-      if (cache_count_[i] == 0) {
-        cache_sum_[i] = 0;
-      } else {
-        cache_validity_[i] = true;
-        cache_sum_[i] /= cache_count_[i];
-      }
-    }
-    RETURN_NOT_OK(builder_->AppendValues(cache_sum_, cache_validity_));
-    RETURN_NOT_OK(builder_->Finish(&out_arr));
-    out->push_back(out_arr);
-
-    return arrow::Status::OK();
+    return Finish(0, GetResultLength(), out);
   }
 
-  uint64_t GetResultLength() { return cache_sum_.size(); }
+  uint64_t GetResultLength() { return cache_count_.size(); }
 
   arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    std::shared_ptr<arrow::Array> arr_out;
     builder_->Reset();
-    for (int i = 0; i < length; i++) {
-      if (cache_count_[i + offset] == 0) {
-        cache_sum_[i + offset] = 0;
-      } else {
-        cache_validity_[i + offset] = true;
-        cache_sum_[i + offset] /= cache_count_[i + offset];
-      }
-    }
     for (uint64_t i = 0; i < length; i++) {
-      if (cache_validity_[offset + i]) {
-        RETURN_NOT_OK(builder_->Append(cache_sum_[offset + i]));
+      arrow::Decimal128 avg;
+      if (cache_count_[offset + i] != 0 &&
+          sums_.GetAvg(offset + i, cache_count_[offset + i], res_precision_, res_scale_,
+                       &avg)) {
+        RETURN_NOT_OK(builder_->Append(avg));
       } else {
         RETURN_NOT_OK(builder_->AppendNull());
       }
     }
 
-    std::shared_ptr<arrow::Array> out_arr;
-    RETURN_NOT_OK(builder_->Finish(&out_arr));
-    out->push_back(out_arr);
+    RETURN_NOT_OK(builder_->Finish(&arr_out));
+    out->push_back(arr_out);
     return arrow::Status::OK();
   }
 
  private:
-  using CType = typename arrow::TypeTraits<DataType>::CType;
-  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
-  using ResDataType = typename FindAccumulatorType<DataType>::Type;
-  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
-  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
-  std::unique_ptr<arrow::DoubleBuilder> builder_;
   // input
   arrow::compute::FunctionContext* ctx_;
-  double* data_sum_;
-  int64_t* data_count_;
-  int row_id;
   std::shared_ptr<arrow::Array> in_sum_;
-  std::shared_ptr<arrow::Array> in_count_;
+  const int64_t* data_count_;
+  int row_id;
   // result
-  std::vector<double> cache_sum_;
+  DecimalSums sums_;
+  int32_t res_precision_;
+  int32_t res_scale_;
   std::vector<int64_t> cache_count_;
-  std::vector<bool> cache_validity_;
+  std::unique_ptr<arrow::Decimal128Builder> builder_;
 };
 
-//////////////// StddevSampPartialAction ///////////////
+//////////////// SumCountAction ///////////////
 template <typename DataType>
-class StddevSampPartialAction : public ActionBase {
+class SumCountAction : public ActionBase {
  public:
-  StddevSampPartialAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+  SumCountAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+    std::unique_ptr<arrow::ArrayBuilder> sum_builder;
     std::unique_ptr<arrow::ArrayBuilder> count_builder;
-    std::unique_ptr<arrow::ArrayBuilder> avg_builder;
-    std::unique_ptr<arrow::ArrayBuilder> m2_builder;
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &count_builder);
     arrow::MakeBuilder(ctx_->memory_pool(),
-                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &avg_builder);
+                      arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &sum_builder);
     arrow::MakeBuilder(ctx_->memory_pool(),
-                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &m2_builder);                  
+                      arrow::TypeTraits<arrow::Int64Type>::type_singleton(), &count_builder);                   
+    sum_builder_.reset(
+        arrow::internal::checked_cast<arrow::DoubleBuilder*>(sum_builder.release()));
     count_builder_.reset(
-        arrow::internal::checked_cast<arrow::DoubleBuilder*>(count_builder.release()));
-    avg_builder_.reset(
-        arrow::internal::checked_cast<arrow::DoubleBuilder*>(avg_builder.release()));
-    m2_builder_.reset(
-        arrow::internal::checked_cast<arrow::DoubleBuilder*>(m2_builder.release()));    
+        arrow::internal::checked_cast<arrow::Int64Builder*>(count_builder.release()));
+
 #ifdef DEBUG
-    std::cout << "Construct StddevSampPartialAction" << std::endl;
+    std::cout << "Construct SumCountAction" << std::endl;
 #endif
   }
-  ~StddevSampPartialAction() {
+  ~SumCountAction() {
 #ifdef DEBUG
-    std::cout << "Destruct StddevSampPartialAction" << std::endl;
+    std::cout << "Destruct SumCountAction" << std::endl;
 #endif
   }
 
@@ -1219,11 +1382,9 @@ class StddevSampPartialAction : public ActionBase {
                        std::function<arrow::Status(int)>* on_valid,
                        std::function<arrow::Status()>* on_null) override {
     // resize result data
-    if (cache_validity_.size() <= max_group_id) {
-      cache_validity_.resize(max_group_id + 1, false);
+    if (cache_sum_.size() <= max_group_id) {
       cache_sum_.resize(max_group_id + 1, 0);
       cache_count_.resize(max_group_id + 1, 0);
-      cache_m2_.resize(max_group_id + 1, 0);
     }
 
     in_ = in_list[0];
@@ -1234,28 +1395,16 @@ class StddevSampPartialAction : public ActionBase {
       *on_valid = [this](int dest_group_id) {
         const bool is_null = in_->IsNull(row_id);
         if (!is_null) {
-          cache_validity_[dest_group_id] = true;
-          double pre_avg = cache_sum_[dest_group_id] * 1.0 / 
-            (cache_count_[dest_group_id] > 0 ? cache_count_[dest_group_id] : 1);
-          double delta = data_[row_id] * 1.0 - pre_avg;
-          double deltaN = delta / (cache_count_[dest_group_id] + 1);
-          cache_m2_[dest_group_id] += delta * deltaN * cache_count_[dest_group_id];
-          cache_sum_[dest_group_id] += data_[row_id] * 1.0;
-          cache_count_[dest_group_id] += 1.0;
+          cache_sum_[dest_group_id] += data_[row_id];
+          cache_count_[dest_group_id] += 1;
         }
         row_id++;
         return arrow::Status::OK();
       };
     } else {
       *on_valid = [this](int dest_group_id) {
-        cache_validity_[dest_group_id] = true;
-        double pre_avg = cache_sum_[dest_group_id] * 1.0 / 
-            (cache_count_[dest_group_id] > 0 ? cache_count_[dest_group_id] : 1);
-        double delta = data_[row_id] * 1.0 - pre_avg;
-        double deltaN = delta / (cache_count_[dest_group_id] + 1);
-        cache_m2_[dest_group_id] += delta * deltaN * cache_count_[dest_group_id];
-        cache_sum_[dest_group_id] += data_[row_id] * 1.0;
-        cache_count_[dest_group_id] += 1.0;
+        cache_sum_[dest_group_id] += data_[row_id];
+        cache_count_[dest_group_id] += 1;
         row_id++;
         return arrow::Status::OK();
       };
@@ -1268,234 +1417,1503 @@ class StddevSampPartialAction : public ActionBase {
   }
 
   arrow::Status Finish(ArrayList* out) override {
-    // get count
-    std::shared_ptr<arrow::Array> count_array;
-    RETURN_NOT_OK(count_builder_->AppendValues(cache_count_, cache_validity_));
-    RETURN_NOT_OK(count_builder_->Finish(&count_array));
-    // get avg
-    std::shared_ptr<arrow::Array> avg_array;
-    for (uint64_t i = 0; i < cache_sum_.size(); i++) {
-      if (cache_count_[i] < 0.0001) {
-        cache_sum_[i] = 0;
-      } else {
-        cache_sum_[i] /= cache_count_[i] * 1.0;
-      }  
+    auto length = GetResultLength();
+    for (uint64_t i = 0; i < length; i++) {
+      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[i]));
+      RETURN_NOT_OK(count_builder_->Append(cache_count_[i]));
     }
-    RETURN_NOT_OK(avg_builder_->AppendValues(cache_sum_, cache_validity_));
-    RETURN_NOT_OK(avg_builder_->Finish(&avg_array));
-    //get m2
-    std::shared_ptr<arrow::Array> m2_array;
-    RETURN_NOT_OK(m2_builder_->AppendValues(cache_m2_, cache_validity_));
-    RETURN_NOT_OK(m2_builder_->Finish(&m2_array));
 
+    std::shared_ptr<arrow::Array> sum_array;
+    std::shared_ptr<arrow::Array> count_array;
+    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    out->push_back(sum_array);
     out->push_back(count_array);
-    out->push_back(avg_array);
-    out->push_back(m2_array);
     return arrow::Status::OK();
   }
 
   uint64_t GetResultLength() { return cache_sum_.size(); }
 
   arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    sum_builder_->Reset();
     count_builder_->Reset();
-    avg_builder_->Reset();
-    m2_builder_->Reset();
+    for (uint64_t i = 0; i < length; i++) {
+      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[offset + i]));
+      RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
+    }
+
+    std::shared_ptr<arrow::Array> sum_array;
+    std::shared_ptr<arrow::Array> count_array;
+    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    out->push_back(sum_array);
+    out->push_back(count_array);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  using ResDataType = typename FindAccumulatorType<DataType>::Type;
+  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
+  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
+  std::unique_ptr<arrow::DoubleBuilder> sum_builder_;
+  std::unique_ptr<arrow::Int64Builder> count_builder_;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  CType* data_;
+  std::shared_ptr<arrow::Array> in_;
+  int row_id;
+  // result
+  std::vector<double> cache_sum_;
+  std::vector<int64_t> cache_count_;
+};
+
+//////////////// SumCountMergeAction ///////////////
+template <typename DataType>
+class SumCountMergeAction : public ActionBase {
+ public:
+  SumCountMergeAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+    std::unique_ptr<arrow::ArrayBuilder> sum_builder;
+    std::unique_ptr<arrow::ArrayBuilder> count_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                      arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &sum_builder);
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                      arrow::TypeTraits<arrow::Int64Type>::type_singleton(), &count_builder);                   
+    sum_builder_.reset(
+        arrow::internal::checked_cast<arrow::DoubleBuilder*>(sum_builder.release()));
+    count_builder_.reset(
+        arrow::internal::checked_cast<arrow::Int64Builder*>(count_builder.release()));
+#ifdef DEBUG
+    std::cout << "Construct SumCountMergeAction" << std::endl;
+#endif
+  }
+  ~SumCountMergeAction() {
+#ifdef DEBUG
+    std::cout << "Destruct SumCountMergeAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 2; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_sum_.size() <= max_group_id) {
+      cache_sum_.resize(max_group_id + 1, 0);
+      cache_count_.resize(max_group_id + 1, 0);
+    }
+
+    in_sum_ = in_list[0];
+    in_count_ = in_list[1];
+    // prepare evaluate lambda
+    data_sum_ = const_cast<double*>(in_sum_->data()->GetValues<double>(1));
+    data_count_ = const_cast<int64_t*>(in_count_->data()->GetValues<int64_t>(1));
+    row_id = 0;
+    if (in_sum_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        const bool is_null = in_sum_->IsNull(row_id);
+        if (!is_null) {
+          cache_sum_[dest_group_id] += data_sum_[row_id];
+          cache_count_[dest_group_id] += data_count_[row_id];
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        cache_sum_[dest_group_id] += data_sum_[row_id];
+        cache_count_[dest_group_id] += data_count_[row_id];
+        row_id++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
 
+  arrow::Status Finish(ArrayList* out) override {
+    auto length = GetResultLength();
     for (uint64_t i = 0; i < length; i++) {
-      if (cache_count_[i + offset] < 0.00001) {
-        cache_sum_[i + offset] = 0;
-      } else {
-        cache_sum_[i + offset] /= cache_count_[i + offset] * 1.0;
-      }
+      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[i]));
+      RETURN_NOT_OK(count_builder_->Append(cache_count_[i]));
     }
+
+    std::shared_ptr<arrow::Array> sum_array;
+    std::shared_ptr<arrow::Array> count_array;
+    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    out->push_back(sum_array);
+    out->push_back(count_array);
+    return arrow::Status::OK();
+  }
+
+  uint64_t GetResultLength() { return cache_sum_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    sum_builder_->Reset();
+    count_builder_->Reset();
     for (uint64_t i = 0; i < length; i++) {
-      if (cache_validity_[offset + i]) {
-        RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
-        RETURN_NOT_OK(avg_builder_->Append(cache_sum_[offset + i]));
-        RETURN_NOT_OK(m2_builder_->Append(cache_m2_[offset + i]));
-      } else {
-        // append zero to count_builder if all values in this group are null
-        double zero = 0;
-        RETURN_NOT_OK(count_builder_->Append(zero));
-        RETURN_NOT_OK(avg_builder_->Append(zero));
-        RETURN_NOT_OK(m2_builder_->Append(zero));
+      RETURN_NOT_OK(sum_builder_->Append(cache_sum_[offset + i]));
+      RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
+    }
+
+    std::shared_ptr<arrow::Array> sum_array;
+    std::shared_ptr<arrow::Array> count_array;
+    RETURN_NOT_OK(sum_builder_->Finish(&sum_array));
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    out->push_back(sum_array);
+    out->push_back(count_array);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  using ResDataType = typename FindAccumulatorType<DataType>::Type;
+  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
+  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
+  std::unique_ptr<arrow::DoubleBuilder> sum_builder_;
+  std::unique_ptr<arrow::Int64Builder> count_builder_;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  double* data_sum_;
+  int64_t* data_count_;
+  int row_id;
+  std::shared_ptr<arrow::Array> in_sum_;
+  std::shared_ptr<arrow::Array> in_count_;
+  // result
+  std::vector<double> cache_sum_;
+  std::vector<int64_t> cache_count_;
+};
+
+//////////////// AvgByCountAction ///////////////
+template <typename DataType>
+class AvgByCountAction : public ActionBase {
+ public:
+  AvgByCountAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), 
+        arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &builder);
+    builder_.reset(
+      arrow::internal::checked_cast<arrow::DoubleBuilder*>(builder.release()));                      
+#ifdef DEBUG
+    std::cout << "Construct AvgByCountAction" << std::endl;
+#endif
+  }
+  ~AvgByCountAction() {
+#ifdef DEBUG
+    std::cout << "Destruct AvgByCountAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 2; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_validity_.size() <= max_group_id) {
+      cache_validity_.resize(max_group_id + 1, false);
+      cache_sum_.resize(max_group_id + 1, 0);
+      cache_count_.resize(max_group_id + 1, 0);
+    }
+
+    in_sum_ = in_list[0];
+    in_count_ = in_list[1];
+    // prepare evaluate lambda
+    data_sum_ = const_cast<double*>(in_sum_->data()->GetValues<double>(1));
+    data_count_ = const_cast<int64_t*>(in_count_->data()->GetValues<int64_t>(1));
+    row_id = 0;
+    if (in_sum_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        const bool is_null = in_sum_->IsNull(row_id);
+        if (!is_null) {
+          cache_sum_[dest_group_id] += data_sum_[row_id];
+          cache_count_[dest_group_id] += data_count_[row_id];
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        cache_sum_[dest_group_id] += data_sum_[row_id];
+        cache_count_[dest_group_id] += data_count_[row_id];
+        row_id++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    std::shared_ptr<arrow::Array> out_arr;
+    for (int i = 0; i < cache_sum_.size(); i++) {
+      if (cache_count_[i] == 0) {
+        cache_sum_[i] = 0;
+      } else {
+        cache_validity_[i] = true;
+        cache_sum_[i] /= cache_count_[i];
+      }
+    }
+    RETURN_NOT_OK(builder_->AppendValues(cache_sum_, cache_validity_));
+    RETURN_NOT_OK(builder_->Finish(&out_arr));
+    out->push_back(out_arr);
+
+    return arrow::Status::OK();
+  }
+
+  uint64_t GetResultLength() { return cache_sum_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    builder_->Reset();
+    for (int i = 0; i < length; i++) {
+      if (cache_count_[i + offset] == 0) {
+        cache_sum_[i + offset] = 0;
+      } else {
+        cache_validity_[i + offset] = true;
+        cache_sum_[i + offset] /= cache_count_[i + offset];
+      }
+    }
+    for (uint64_t i = 0; i < length; i++) {
+      if (cache_validity_[offset + i]) {
+        RETURN_NOT_OK(builder_->Append(cache_sum_[offset + i]));
+      } else {
+        RETURN_NOT_OK(builder_->AppendNull());
+      }
+    }
+
+    std::shared_ptr<arrow::Array> out_arr;
+    RETURN_NOT_OK(builder_->Finish(&out_arr));
+    out->push_back(out_arr);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  using ResDataType = typename FindAccumulatorType<DataType>::Type;
+  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
+  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
+  std::unique_ptr<arrow::DoubleBuilder> builder_;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  double* data_sum_;
+  int64_t* data_count_;
+  int row_id;
+  std::shared_ptr<arrow::Array> in_sum_;
+  std::shared_ptr<arrow::Array> in_count_;
+  // result
+  std::vector<double> cache_sum_;
+  std::vector<int64_t> cache_count_;
+  std::vector<bool> cache_validity_;
+};
+
+//////////////// StddevSampPartialAction ///////////////
+template <typename DataType>
+class StddevSampPartialAction : public ActionBase {
+ public:
+  StddevSampPartialAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+    std::unique_ptr<arrow::ArrayBuilder> count_builder;
+    std::unique_ptr<arrow::ArrayBuilder> avg_builder;
+    std::unique_ptr<arrow::ArrayBuilder> m2_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &count_builder);
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &avg_builder);
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &m2_builder);                  
+    count_builder_.reset(
+        arrow::internal::checked_cast<arrow::DoubleBuilder*>(count_builder.release()));
+    avg_builder_.reset(
+        arrow::internal::checked_cast<arrow::DoubleBuilder*>(avg_builder.release()));
+    m2_builder_.reset(
+        arrow::internal::checked_cast<arrow::DoubleBuilder*>(m2_builder.release()));    
+#ifdef DEBUG
+    std::cout << "Construct StddevSampPartialAction" << std::endl;
+#endif
+  }
+  ~StddevSampPartialAction() {
+#ifdef DEBUG
+    std::cout << "Destruct StddevSampPartialAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 1; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_validity_.size() <= max_group_id) {
+      cache_validity_.resize(max_group_id + 1, false);
+      cache_sum_.resize(max_group_id + 1, 0);
+      cache_count_.resize(max_group_id + 1, 0);
+      cache_m2_.resize(max_group_id + 1, 0);
+    }
+
+    in_ = in_list[0];
+    // prepare evaluate lambda
+    data_ = const_cast<CType*>(in_->data()->GetValues<CType>(1));
+    row_id = 0;
+    if (in_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        const bool is_null = in_->IsNull(row_id);
+        if (!is_null) {
+          cache_validity_[dest_group_id] = true;
+          double pre_avg = cache_sum_[dest_group_id] * 1.0 / 
+            (cache_count_[dest_group_id] > 0 ? cache_count_[dest_group_id] : 1);
+          double delta = data_[row_id] * 1.0 - pre_avg;
+          double deltaN = delta / (cache_count_[dest_group_id] + 1);
+          cache_m2_[dest_group_id] += delta * deltaN * cache_count_[dest_group_id];
+          cache_sum_[dest_group_id] += data_[row_id] * 1.0;
+          cache_count_[dest_group_id] += 1.0;
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        cache_validity_[dest_group_id] = true;
+        double pre_avg = cache_sum_[dest_group_id] * 1.0 / 
+            (cache_count_[dest_group_id] > 0 ? cache_count_[dest_group_id] : 1);
+        double delta = data_[row_id] * 1.0 - pre_avg;
+        double deltaN = delta / (cache_count_[dest_group_id] + 1);
+        cache_m2_[dest_group_id] += delta * deltaN * cache_count_[dest_group_id];
+        cache_sum_[dest_group_id] += data_[row_id] * 1.0;
+        cache_count_[dest_group_id] += 1.0;
+        row_id++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    // get count
+    std::shared_ptr<arrow::Array> count_array;
+    RETURN_NOT_OK(count_builder_->AppendValues(cache_count_, cache_validity_));
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    // get avg
+    std::shared_ptr<arrow::Array> avg_array;
+    for (uint64_t i = 0; i < cache_sum_.size(); i++) {
+      if (cache_count_[i] < 0.0001) {
+        cache_sum_[i] = 0;
+      } else {
+        cache_sum_[i] /= cache_count_[i] * 1.0;
+      }  
+    }
+    RETURN_NOT_OK(avg_builder_->AppendValues(cache_sum_, cache_validity_));
+    RETURN_NOT_OK(avg_builder_->Finish(&avg_array));
+    //get m2
+    std::shared_ptr<arrow::Array> m2_array;
+    RETURN_NOT_OK(m2_builder_->AppendValues(cache_m2_, cache_validity_));
+    RETURN_NOT_OK(m2_builder_->Finish(&m2_array));
+
+    out->push_back(count_array);
+    out->push_back(avg_array);
+    out->push_back(m2_array);
+    return arrow::Status::OK();
+  }
+
+  uint64_t GetResultLength() { return cache_sum_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    count_builder_->Reset();
+    avg_builder_->Reset();
+    m2_builder_->Reset();
+
+    for (uint64_t i = 0; i < length; i++) {
+      if (cache_count_[i + offset] < 0.00001) {
+        cache_sum_[i + offset] = 0;
+      } else {
+        cache_sum_[i + offset] /= cache_count_[i + offset] * 1.0;
+      }
+    }
+    for (uint64_t i = 0; i < length; i++) {
+      if (cache_validity_[offset + i]) {
+        RETURN_NOT_OK(count_builder_->Append(cache_count_[offset + i]));
+        RETURN_NOT_OK(avg_builder_->Append(cache_sum_[offset + i]));
+        RETURN_NOT_OK(m2_builder_->Append(cache_m2_[offset + i]));
+      } else {
+        // append zero to count_builder if all values in this group are null
+        double zero = 0;
+        RETURN_NOT_OK(count_builder_->Append(zero));
+        RETURN_NOT_OK(avg_builder_->Append(zero));
+        RETURN_NOT_OK(m2_builder_->Append(zero));
+      }
+    }
+
+    std::shared_ptr<arrow::Array> count_array;
+    std::shared_ptr<arrow::Array> avg_array;
+    std::shared_ptr<arrow::Array> m2_array;
+    RETURN_NOT_OK(count_builder_->Finish(&count_array));
+    RETURN_NOT_OK(avg_builder_->Finish(&avg_array));
+    RETURN_NOT_OK(m2_builder_->Finish(&m2_array));
+    out->push_back(count_array);
+    out->push_back(avg_array);
+    out->push_back(m2_array);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  using ResDataType = typename FindAccumulatorType<DataType>::Type;
+  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
+  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
+  std::unique_ptr<arrow::DoubleBuilder> count_builder_;
+  std::unique_ptr<arrow::DoubleBuilder> avg_builder_;
+  std::unique_ptr<arrow::DoubleBuilder> m2_builder_;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  CType* data_;
+  std::shared_ptr<arrow::Array> in_;
+  int row_id;
+  // result
+  std::vector<double> cache_sum_;
+  std::vector<double> cache_count_;
+  std::vector<double> cache_m2_;
+  std::vector<bool> cache_validity_;
+};
+
+//////////////// StddevSampFinalAction ///////////////
+template <typename DataType>
+class StddevSampFinalAction : public ActionBase {
+ public:
+  StddevSampFinalAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    arrow::MakeBuilder(ctx_->memory_pool(),
+                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &builder);
+    builder_.reset(
+      arrow::internal::checked_cast<arrow::DoubleBuilder*>(builder.release()));
+#ifdef DEBUG
+    std::cout << "Construct StddevSampFinalAction" << std::endl;
+#endif
+  }
+  ~StddevSampFinalAction() {
+#ifdef DEBUG
+    std::cout << "Destruct StddevSampFinalAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 3; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_validity_.size() <= max_group_id) {
+      cache_validity_.resize(max_group_id + 1, false);
+      cache_count_.resize(max_group_id + 1, 0);
+      cache_avg_.resize(max_group_id + 1, 0);
+      cache_m2_.resize(max_group_id + 1, 0);
+    }
+    in_count_ = in_list[0];
+    in_avg_ = in_list[1];
+    in_m2_ = in_list[2];
+    // prepare evaluate lambda
+    data_count_ = const_cast<double*>(in_count_->data()->GetValues<double>(1));
+    data_avg_ = const_cast<double*>(in_avg_->data()->GetValues<double>(1));
+    data_m2_ = const_cast<double*>(in_m2_->data()->GetValues<double>(1));
+    row_id = 0;
+    if (in_m2_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        const bool is_null = in_m2_->IsNull(row_id);
+        if (!is_null && data_count_[row_id] > 0) {
+          cache_validity_[dest_group_id] = true;
+          double pre_avg = cache_avg_[dest_group_id];
+          double delta = data_avg_[row_id] - pre_avg;
+          double n1 = cache_count_[dest_group_id];
+          double n2 = data_count_[row_id];
+          double deltaN = (n1 + n2) > 0 ? delta / (n1 + n2) : 0;
+          cache_m2_[dest_group_id] += (data_m2_[row_id] + delta * deltaN * n1 * n2);
+          cache_avg_[dest_group_id] += deltaN * n2;
+          cache_count_[dest_group_id] += n2;
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        if (data_count_[row_id] > 0) {
+           cache_validity_[dest_group_id] = true;
+           double pre_avg = cache_avg_[dest_group_id];
+           double delta = data_avg_[row_id] - pre_avg;
+           double n1 = cache_count_[dest_group_id];
+           double n2 = data_count_[row_id];
+           double deltaN = (n1 + n2) > 0 ? delta / (n1 + n2) : 0;
+           cache_m2_[dest_group_id] += (data_m2_[row_id] + delta * deltaN * n1 * n2);
+           cache_avg_[dest_group_id] += deltaN * n2;
+           cache_count_[dest_group_id] += n2;
+        }
+        row_id++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    std::shared_ptr<arrow::Array> out_arr;
+    for (int i = 0; i < cache_count_.size(); i++) {
+      cache_m2_[i] = sqrt(cache_m2_[i] / (cache_count_[i] > 1 ? 
+        (cache_count_[i] - 1) : 1));
+    }
+    RETURN_NOT_OK(builder_->AppendValues(cache_m2_, cache_validity_));
+    RETURN_NOT_OK(builder_->Finish(&out_arr));
+    out->push_back(out_arr);
+
+    return arrow::Status::OK();
+  }
+
+  uint64_t GetResultLength() { return cache_count_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    builder_->Reset();
+    for (int i = 0; i < length; i++) {
+      cache_m2_[i + offset] = sqrt(cache_m2_[i + offset] / 
+        (cache_count_[i + offset] > 1 ? (cache_count_[i + offset] - 1) : 1));
+    }
+    for (uint64_t i = 0; i < length; i++) {
+      if (cache_count_[offset + i] - 1 < 0.00001) {
+        // append Infinity if only one non-null value exists
+        // RETURN_NOT_OK(builder->Append(std::numeric_limits<double>::quiet_NaN()));
+        RETURN_NOT_OK(builder_->Append(std::numeric_limits<double>::infinity()));
+      } else if (cache_validity_[offset + i]) {
+        RETURN_NOT_OK(builder_->Append(cache_m2_[offset + i]));
+      } else {
+        // append null if all values are null 
+        RETURN_NOT_OK(builder_->AppendNull());
+      }
+    }
+
+    std::shared_ptr<arrow::Array> out_array;
+    RETURN_NOT_OK(builder_->Finish(&out_array));
+    out->push_back(out_array);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  using ResDataType = typename FindAccumulatorType<DataType>::Type;
+  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
+  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
+  std::unique_ptr<arrow::DoubleBuilder> builder_;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  double* data_count_;
+  double* data_avg_;
+  double* data_m2_;
+  int row_id;
+  std::shared_ptr<arrow::Array> in_count_;
+  std::shared_ptr<arrow::Array> in_avg_;
+  std::shared_ptr<arrow::Array> in_m2_;
+  // result
+  std::vector<double> cache_count_;
+  std::vector<double> cache_avg_;
+  std::vector<double> cache_m2_;
+  std::vector<bool> cache_validity_;
+};
+
+//////////////// ApproxCountDistinct helpers ///////////////
+// Spark hashes values with XxHash64 (seed 42) before updating HLL++ registers, keep
+// the same per-type hashing so registers are interchangeable with the JVM side.
+template <typename CType>
+inline typename std::enable_if<std::is_integral<CType>::value && sizeof(CType) <= 4,
+                               uint64_t>::type
+HashForApprox(CType v) {
+  return xxhash64::hash_int(static_cast<int32_t>(v), HyperLogLogPlusPlus::kSeed);
+}
+
+template <typename CType>
+inline typename std::enable_if<std::is_integral<CType>::value && sizeof(CType) == 8,
+                               uint64_t>::type
+HashForApprox(CType v) {
+  return xxhash64::hash_long(static_cast<int64_t>(v), HyperLogLogPlusPlus::kSeed);
+}
+
+inline uint64_t HashForApprox(float v) {
+  // -0.0 is normalized to 0.0, NaN follows java's floatToIntBits
+  int32_t bits = 0x7fc00000;
+  if (!std::isnan(v)) {
+    v = (v == 0.0f) ? 0.0f : v;
+    memcpy(&bits, &v, sizeof(bits));
+  }
+  return xxhash64::hash_int(bits, HyperLogLogPlusPlus::kSeed);
+}
+
+inline uint64_t HashForApprox(double v) {
+  int64_t bits = 0x7ff8000000000000LL;
+  if (!std::isnan(v)) {
+    v = (v == 0.0) ? 0.0 : v;
+    memcpy(&bits, &v, sizeof(bits));
+  }
+  return xxhash64::hash_long(bits, HyperLogLogPlusPlus::kSeed);
+}
+
+inline uint64_t HashForApprox(arrow::util::string_view v) {
+  return xxhash64::hash_bytes(reinterpret_cast<const uint8_t*>(v.data()),
+                              static_cast<int32_t>(v.size()), HyperLogLogPlusPlus::kSeed);
+}
+
+//////////////// ApproxCountDistinctPartialAction ///////////////
+template <typename DataType>
+class ApproxCountDistinctPartialAction : public ActionBase {
+ public:
+  ApproxCountDistinctPartialAction(arrow::compute::FunctionContext* ctx,
+                                   double relative_sd)
+      : ctx_(ctx), hll_(relative_sd), num_words_(hll_.num_words()) {
+#ifdef DEBUG
+    std::cout << "Construct ApproxCountDistinctPartialAction" << std::endl;
+#endif
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::int64(), &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<arrow::Int64Builder*>(array_builder.release()));
+  }
+  ~ApproxCountDistinctPartialAction() {
+#ifdef DEBUG
+    std::cout << "Destruct ApproxCountDistinctPartialAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 1; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data, registers are laid out group by group
+    if (GetResultLength() <= max_group_id) {
+      cache_.resize((max_group_id + 1) * num_words_, 0);
+    }
+
+    in_ = std::dynamic_pointer_cast<ArrayType>(in_list[0]);
+    // hash and encode the whole batch up front, so the per-row callback only needs
+    // to touch one register
+    auto length = in_->length();
+    encoded_.resize(length);
+    for (int64_t i = 0; i < length; i++) {
+      encoded_[i] = hll_.Encode(HashForApprox(in_->GetView(i)));
+    }
+    row_id_ = 0;
+    // prepare evaluate lambda
+    if (in_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        if (!in_->IsNull(row_id_)) {
+          hll_.Update(&cache_[dest_group_id * num_words_], encoded_[row_id_]);
+        }
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        hll_.Update(&cache_[dest_group_id * num_words_], encoded_[row_id_]);
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id_++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_.size() / num_words_; }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    // one int64 column per register word, same as Spark's MS[i] buffer attributes
+    for (int w = 0; w < num_words_; w++) {
+      std::shared_ptr<arrow::Array> arr_out;
+      builder_->Reset();
+      RETURN_NOT_OK(builder_->Reserve(length));
+      for (uint64_t i = 0; i < length; i++) {
+        builder_->UnsafeAppend(cache_[(offset + i) * num_words_ + w]);
+      }
+      RETURN_NOT_OK(builder_->Finish(&arr_out));
+      out->push_back(arr_out);
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<ArrayType> in_;
+  std::vector<uint32_t> encoded_;
+  int row_id_ = 0;
+  // result
+  HyperLogLogPlusPlus hll_;
+  const int num_words_;
+  std::vector<int64_t> cache_;
+  std::unique_ptr<arrow::Int64Builder> builder_;
+};
+
+//////////////// ApproxCountDistinctMergeAction ///////////////
+class ApproxCountDistinctMergeAction : public ActionBase {
+ public:
+  ApproxCountDistinctMergeAction(arrow::compute::FunctionContext* ctx,
+                                 double relative_sd, bool is_final)
+      : ctx_(ctx),
+        hll_(relative_sd),
+        num_words_(hll_.num_words()),
+        is_final_(is_final) {
+#ifdef DEBUG
+    std::cout << "Construct ApproxCountDistinctMergeAction" << std::endl;
+#endif
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::int64(), &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<arrow::Int64Builder*>(array_builder.release()));
+  }
+  ~ApproxCountDistinctMergeAction() {
+#ifdef DEBUG
+    std::cout << "Destruct ApproxCountDistinctMergeAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return num_words_; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (GetResultLength() <= max_group_id) {
+      cache_.resize((max_group_id + 1) * num_words_, 0);
+    }
+
+    in_ = in_list[0];
+    in_data_.resize(num_words_);
+    for (int w = 0; w < num_words_; w++) {
+      in_data_[w] = in_list[w]->data()->GetValues<int64_t>(1);
+    }
+    row_id_ = 0;
+    // prepare evaluate lambda
+    if (in_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        if (!in_->IsNull(row_id_)) {
+          MergeRow(dest_group_id);
+        }
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        MergeRow(dest_group_id);
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id_++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_.size() / num_words_; }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    if (is_final_) {
+      std::shared_ptr<arrow::Array> arr_out;
+      builder_->Reset();
+      RETURN_NOT_OK(builder_->Reserve(length));
+      for (uint64_t i = 0; i < length; i++) {
+        builder_->UnsafeAppend(hll_.Query(&cache_[(offset + i) * num_words_]));
+      }
+      RETURN_NOT_OK(builder_->Finish(&arr_out));
+      out->push_back(arr_out);
+      return arrow::Status::OK();
+    }
+    for (int w = 0; w < num_words_; w++) {
+      std::shared_ptr<arrow::Array> arr_out;
+      builder_->Reset();
+      RETURN_NOT_OK(builder_->Reserve(length));
+      for (uint64_t i = 0; i < length; i++) {
+        builder_->UnsafeAppend(cache_[(offset + i) * num_words_ + w]);
+      }
+      RETURN_NOT_OK(builder_->Finish(&arr_out));
+      out->push_back(arr_out);
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  inline void MergeRow(int dest_group_id) {
+    auto dst = &cache_[dest_group_id * num_words_];
+    for (int w = 0; w < num_words_; w++) {
+      dst[w] = HyperLogLogPlusPlus::MergeWord(dst[w], in_data_[w][row_id_]);
+    }
+  }
+
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<arrow::Array> in_;
+  std::vector<const int64_t*> in_data_;
+  int row_id_ = 0;
+  // result
+  HyperLogLogPlusPlus hll_;
+  const int num_words_;
+  bool is_final_;
+  std::vector<int64_t> cache_;
+  std::unique_ptr<arrow::Int64Builder> builder_;
+};
+
+//////////////// PercentileApproxPartialAction ///////////////
+template <typename DataType>
+class PercentileApproxPartialAction : public ActionBase {
+ public:
+  PercentileApproxPartialAction(arrow::compute::FunctionContext* ctx, int accuracy)
+      : ctx_(ctx), relative_error_(1.0 / accuracy) {
+#ifdef DEBUG
+    std::cout << "Construct PercentileApproxPartialAction" << std::endl;
+#endif
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::binary(), &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<arrow::BinaryBuilder*>(array_builder.release()));
+  }
+  ~PercentileApproxPartialAction() {
+#ifdef DEBUG
+    std::cout << "Destruct PercentileApproxPartialAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 1; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_.size() <= max_group_id) {
+      cache_.resize(max_group_id + 1, QuantileSummaries(relative_error_));
+    }
+
+    in_ = in_list[0];
+    data_ = in_->data()->GetValues<CType>(1);
+    row_id_ = 0;
+    // prepare evaluate lambda
+    if (in_->null_count()) {
+      *on_valid = [this](int dest_group_id) {
+        if (!in_->IsNull(row_id_)) {
+          cache_[dest_group_id].Insert(static_cast<double>(data_[row_id_]));
+        }
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    } else {
+      *on_valid = [this](int dest_group_id) {
+        cache_[dest_group_id].Insert(static_cast<double>(data_[row_id_]));
+        row_id_++;
+        return arrow::Status::OK();
+      };
+    }
+    *on_null = [this]() {
+      row_id_++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    std::shared_ptr<arrow::Array> arr_out;
+    std::string buf;
+    builder_->Reset();
+    for (uint64_t i = 0; i < length; i++) {
+      cache_[offset + i].Serialize(&buf);
+      RETURN_NOT_OK(builder_->Append(buf));
+    }
+    RETURN_NOT_OK(builder_->Finish(&arr_out));
+    out->push_back(arr_out);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<arrow::Array> in_;
+  const CType* data_;
+  int row_id_ = 0;
+  // result
+  double relative_error_;
+  std::vector<QuantileSummaries> cache_;
+  std::unique_ptr<arrow::BinaryBuilder> builder_;
+};
+
+//////////////// PercentileApproxMergeAction ///////////////
+// The final action returns the percentile as ResType, the type of the aggregated
+// column like in Spark. The summaries only hold input values, so the cast is exact.
+template <typename ResType>
+class PercentileApproxMergeAction : public ActionBase {
+ public:
+  PercentileApproxMergeAction(arrow::compute::FunctionContext* ctx, int accuracy,
+                              bool is_final, double percentage)
+      : ctx_(ctx),
+        relative_error_(1.0 / accuracy),
+        is_final_(is_final),
+        percentage_(percentage) {
+#ifdef DEBUG
+    std::cout << "Construct PercentileApproxMergeAction" << std::endl;
+#endif
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::binary(), &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<arrow::BinaryBuilder*>(array_builder.release()));
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::TypeTraits<ResType>::type_singleton(),
+                       &array_builder);
+    final_builder_.reset(
+        arrow::internal::checked_cast<ResBuilderType*>(array_builder.release()));
+  }
+  ~PercentileApproxMergeAction() {
+#ifdef DEBUG
+    std::cout << "Destruct PercentileApproxMergeAction" << std::endl;
+#endif
+  }
+
+  int RequiredColNum() { return 1; }
+
+  arrow::Status Submit(ArrayList in_list, int max_group_id,
+                       std::function<arrow::Status(int)>* on_valid,
+                       std::function<arrow::Status()>* on_null) override {
+    // resize result data
+    if (cache_.size() <= max_group_id) {
+      cache_.resize(max_group_id + 1, QuantileSummaries(relative_error_));
+    }
+
+    in_ = std::dynamic_pointer_cast<arrow::BinaryArray>(in_list[0]);
+    row_id_ = 0;
+    // prepare evaluate lambda
+    *on_valid = [this](int dest_group_id) {
+      if (!in_->IsNull(row_id_)) {
+        auto view = in_->GetView(row_id_);
+        QuantileSummaries other(relative_error_);
+        RETURN_NOT_OK(QuantileSummaries::Deserialize(
+            reinterpret_cast<const uint8_t*>(view.data()),
+            static_cast<int32_t>(view.size()), &other));
+        cache_[dest_group_id].Merge(other);
+      }
+      row_id_++;
+      return arrow::Status::OK();
+    };
+    *on_null = [this]() {
+      row_id_++;
+      return arrow::Status::OK();
+    };
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(ArrayList* out) override {
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return cache_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    std::shared_ptr<arrow::Array> arr_out;
+    if (is_final_) {
+      final_builder_->Reset();
+      for (uint64_t i = 0; i < length; i++) {
+        double res;
+        if (cache_[offset + i].Query(percentage_, &res)) {
+          RETURN_NOT_OK(final_builder_->Append(static_cast<ResCType>(res)));
+        } else {
+          RETURN_NOT_OK(final_builder_->AppendNull());
+        }
+      }
+      RETURN_NOT_OK(final_builder_->Finish(&arr_out));
+    } else {
+      std::string buf;
+      builder_->Reset();
+      for (uint64_t i = 0; i < length; i++) {
+        cache_[offset + i].Serialize(&buf);
+        RETURN_NOT_OK(builder_->Append(buf));
+      }
+      RETURN_NOT_OK(builder_->Finish(&arr_out));
+    }
+    out->push_back(arr_out);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using ResCType = typename arrow::TypeTraits<ResType>::CType;
+  using ResBuilderType = typename arrow::TypeTraits<ResType>::BuilderType;
+
+  // input
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<arrow::BinaryArray> in_;
+  int row_id_ = 0;
+  // result
+  double relative_error_;
+  bool is_final_;
+  double percentage_;
+  std::vector<QuantileSummaries> cache_;
+  std::unique_ptr<arrow::BinaryBuilder> builder_;
+  std::unique_ptr<ResBuilderType> final_builder_;
+};
+
+//////////////// CountDistinctAction ///////////////
+// Spill the distinct pairs and their memo table once they hold more than this many
+// bytes, can be overridden by NATIVESQL_DISTINCT_SPILL_THRESHOLD.
+static int64_t GetDistinctSpillThreshold() {
+  const char* env_threshold = std::getenv("NATIVESQL_DISTINCT_SPILL_THRESHOLD");
+  if (env_threshold != nullptr) {
+    return atoll(env_threshold);
+  }
+  return 512LL * 1024 * 1024;
+}
+
+// One input column of a count(distinct), knows how to turn a row into key bytes.
+struct DistinctKeyColumn {
+  enum Kind { BOOL, FIXED, FLOAT, DOUBLE, BINARY };
+
+  static arrow::Status GetKind(const std::shared_ptr<arrow::DataType>& type, Kind* kind,
+                               int* byte_width) {
+    switch (type->id()) {
+      case arrow::BooleanType::type_id:
+        *kind = BOOL;
+        *byte_width = 1;
+        break;
+      case arrow::FloatType::type_id:
+        *kind = FLOAT;
+        *byte_width = 4;
+        break;
+      case arrow::DoubleType::type_id:
+        *kind = DOUBLE;
+        *byte_width = 8;
+        break;
+      case arrow::StringType::type_id:
+      case arrow::BinaryType::type_id:
+        *kind = BINARY;
+        *byte_width = 0;
+        break;
+      case arrow::UInt8Type::type_id:
+      case arrow::Int8Type::type_id:
+      case arrow::UInt16Type::type_id:
+      case arrow::Int16Type::type_id:
+      case arrow::UInt32Type::type_id:
+      case arrow::Int32Type::type_id:
+      case arrow::UInt64Type::type_id:
+      case arrow::Int64Type::type_id:
+      case arrow::Date32Type::type_id:
+      case arrow::Date64Type::type_id:
+      case arrow::TimestampType::type_id:
+      case arrow::Decimal128Type::type_id:
+        *kind = FIXED;
+        *byte_width =
+            arrow::internal::checked_cast<const arrow::FixedWidthType&>(*type).bit_width() /
+            8;
+        break;
+      default:
+        return arrow::Status::NotImplemented("CountDistinct doesn't support type ",
+                                             type->ToString());
+    }
+    return arrow::Status::OK();
+  }
+
+  void Reset(const std::shared_ptr<arrow::Array>& in) {
+    auto data = in->data();
+    offset = data->offset;
+    if (kind == BINARY) {
+      offsets = data->GetValues<int32_t>(1);
+      values = data->buffers[2] ? data->buffers[2]->data() : nullptr;
+    } else {
+      values = data->buffers[1]->data();
+    }
+  }
+
+  // Raw bits of a fixed width value no wider than 8 bytes, -0.0 and NaN are
+  // normalized like Spark's NormalizeFloatingNumbers.
+  inline uint64_t FixedKey(int64_t i) const {
+    switch (kind) {
+      case BOOL:
+        return arrow::BitUtil::GetBit(values, offset + i) ? 1 : 0;
+      case FLOAT: {
+        float v;
+        memcpy(&v, values + (offset + i) * 4, sizeof(v));
+        uint32_t bits = 0x7fc00000;
+        if (!std::isnan(v)) {
+          v = (v == 0.0f) ? 0.0f : v;
+          memcpy(&bits, &v, sizeof(bits));
+        }
+        return bits;
+      }
+      case DOUBLE: {
+        double v;
+        memcpy(&v, values + (offset + i) * 8, sizeof(v));
+        uint64_t bits = 0x7ff8000000000000ULL;
+        if (!std::isnan(v)) {
+          v = (v == 0.0) ? 0.0 : v;
+          memcpy(&bits, &v, sizeof(bits));
+        }
+        return bits;
+      }
+      default: {
+        uint64_t key = 0;
+        memcpy(&key, values + (offset + i) * byte_width, byte_width);
+        return key;
       }
     }
+  }
 
-    std::shared_ptr<arrow::Array> count_array;
-    std::shared_ptr<arrow::Array> avg_array;
-    std::shared_ptr<arrow::Array> m2_array;
-    RETURN_NOT_OK(count_builder_->Finish(&count_array));
-    RETURN_NOT_OK(avg_builder_->Finish(&avg_array));
-    RETURN_NOT_OK(m2_builder_->Finish(&m2_array));
-    out->push_back(count_array);
-    out->push_back(avg_array);
-    out->push_back(m2_array);
-    return arrow::Status::OK();
+  inline void AppendTo(int64_t i, std::string* out) const {
+    switch (kind) {
+      case BINARY: {
+        int32_t pos = offsets[i];
+        int32_t len = offsets[i + 1] - pos;
+        // length prefix keeps ("a", "bc") and ("ab", "c") apart
+        out->append(reinterpret_cast<const char*>(&len), sizeof(len));
+        if (len > 0) {
+          out->append(reinterpret_cast<const char*>(values + pos), len);
+        }
+      } break;
+      case FIXED:
+        out->append(reinterpret_cast<const char*>(values + (offset + i) * byte_width),
+                    byte_width);
+        break;
+      default: {
+        uint64_t key = FixedKey(i);
+        out->append(reinterpret_cast<const char*>(&key), byte_width);
+      } break;
+    }
   }
 
- private:
-  using CType = typename arrow::TypeTraits<DataType>::CType;
-  using ResDataType = typename FindAccumulatorType<DataType>::Type;
-  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
-  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
-  std::unique_ptr<arrow::DoubleBuilder> count_builder_;
-  std::unique_ptr<arrow::DoubleBuilder> avg_builder_;
-  std::unique_ptr<arrow::DoubleBuilder> m2_builder_;
-  // input
-  arrow::compute::FunctionContext* ctx_;
-  CType* data_;
-  std::shared_ptr<arrow::Array> in_;
-  int row_id;
-  // result
-  std::vector<double> cache_sum_;
-  std::vector<double> cache_count_;
-  std::vector<double> cache_m2_;
-  std::vector<bool> cache_validity_;
+  Kind kind;
+  int byte_width;
+  int64_t offset = 0;
+  const uint8_t* values = nullptr;
+  const int32_t* offsets = nullptr;
 };
 
-//////////////// StddevSampFinalAction ///////////////
-template <typename DataType>
-class StddevSampFinalAction : public ActionBase {
+/// Exact count(distinct col_0, ..., col_n) per group. Rows with a null in any of the
+/// distinct columns are skipped, same as Spark.
+///
+/// A single fixed width column is keyed by its value bits directly, anything else
+/// (strings, several columns) is interned into a binary memo table and keyed by memo
+/// index. The (group_id, key) pairs go into a CompactDistinctSet. Once the set and the
+/// memo table hold more than the spill threshold, the pairs are hash partitioned into
+/// arrow ipc files, memo keys as their bytes, and both are reset. Finish dedups one
+/// partition at a time.
+class CountDistinctAction : public ActionBase {
  public:
-  StddevSampFinalAction(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {
-    std::unique_ptr<arrow::ArrayBuilder> builder;
-    arrow::MakeBuilder(ctx_->memory_pool(),
-                       arrow::TypeTraits<arrow::DoubleType>::type_singleton(), &builder);
-    builder_.reset(
-      arrow::internal::checked_cast<arrow::DoubleBuilder*>(builder.release()));
+  CountDistinctAction(arrow::compute::FunctionContext* ctx,
+                      std::vector<DistinctKeyColumn> columns, int64_t spill_threshold)
+      : ctx_(ctx),
+        columns_(std::move(columns)),
+        pairs_(ctx->memory_pool()),
+        spill_threshold_(spill_threshold) {
 #ifdef DEBUG
-    std::cout << "Construct StddevSampFinalAction" << std::endl;
+    std::cout << "Construct CountDistinctAction" << std::endl;
 #endif
+    use_raw_key_ = columns_.size() == 1 && columns_[0].kind != DistinctKeyColumn::BINARY &&
+                   columns_[0].byte_width <= 8;
+    if (!use_raw_key_) {
+      memo_table_.reset(new MemoTable(ctx_->memory_pool()));
+    }
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx_->memory_pool(), arrow::int64(), &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<arrow::Int64Builder*>(array_builder.release()));
   }
-  ~StddevSampFinalAction() {
+  ~CountDistinctAction() {
 #ifdef DEBUG
-    std::cout << "Destruct StddevSampFinalAction" << std::endl;
+    std::cout << "Destruct CountDistinctAction" << std::endl;
 #endif
   }
 
-  int RequiredColNum() { return 3; }
+  int RequiredColNum() { return columns_.size(); }
 
   arrow::Status Submit(ArrayList in_list, int max_group_id,
                        std::function<arrow::Status(int)>* on_valid,
                        std::function<arrow::Status()>* on_null) override {
+    // the set and the memo table only grow while rows are evaluated, so batch
+    // boundaries are the place to check memory
+    if (EstimatedBytes() > spill_threshold_) {
+      RETURN_NOT_OK(Spill());
+    }
     // resize result data
-    if (cache_validity_.size() <= max_group_id) {
-      cache_validity_.resize(max_group_id + 1, false);
-      cache_count_.resize(max_group_id + 1, 0);
-      cache_avg_.resize(max_group_id + 1, 0);
-      cache_m2_.resize(max_group_id + 1, 0);
+    if (counts_.size() <= max_group_id) {
+      counts_.resize(max_group_id + 1, 0);
     }
-    in_count_ = in_list[0];
-    in_avg_ = in_list[1];
-    in_m2_ = in_list[2];
+
+    // build the keys of the whole batch up front
+    auto length = in_list[0]->length();
+    bool has_null = false;
+    for (int c = 0; c < columns_.size(); c++) {
+      columns_[c].Reset(in_list[c]);
+      has_null |= in_list[c]->null_count() > 0;
+    }
+    keys_.resize(length);
+    key_valid_.assign(length, true);
+    if (has_null) {
+      for (int c = 0; c < columns_.size(); c++) {
+        if (in_list[c]->null_count() == 0) continue;
+        for (int64_t i = 0; i < length; i++) {
+          if (in_list[c]->IsNull(i)) key_valid_[i] = false;
+        }
+      }
+    }
+    if (use_raw_key_) {
+      for (int64_t i = 0; i < length; i++) {
+        keys_[i] = columns_[0].FixedKey(i);
+      }
+    } else {
+      std::string key_buf;
+      for (int64_t i = 0; i < length; i++) {
+        if (!key_valid_[i]) continue;
+        key_buf.clear();
+        for (auto& column : columns_) {
+          column.AppendTo(i, &key_buf);
+        }
+        int32_t memo_index;
+        RETURN_NOT_OK(memo_table_->GetOrInsert(
+            key_buf.data(), static_cast<int32_t>(key_buf.size()), &memo_index));
+        keys_[i] = memo_index;
+      }
+    }
+
+    row_id_ = 0;
     // prepare evaluate lambda
-    data_count_ = const_cast<double*>(in_count_->data()->GetValues<double>(1));
-    data_avg_ = const_cast<double*>(in_avg_->data()->GetValues<double>(1));
-    data_m2_ = const_cast<double*>(in_m2_->data()->GetValues<double>(1));
-    row_id = 0;
-    if (in_m2_->null_count()) {
+    if (has_null) {
       *on_valid = [this](int dest_group_id) {
-        const bool is_null = in_m2_->IsNull(row_id);
-        if (!is_null && data_count_[row_id] > 0) {
-          cache_validity_[dest_group_id] = true;
-          double pre_avg = cache_avg_[dest_group_id];
-          double delta = data_avg_[row_id] - pre_avg;
-          double n1 = cache_count_[dest_group_id];
-          double n2 = data_count_[row_id];
-          double deltaN = (n1 + n2) > 0 ? delta / (n1 + n2) : 0;
-          cache_m2_[dest_group_id] += (data_m2_[row_id] + delta * deltaN * n1 * n2);
-          cache_avg_[dest_group_id] += deltaN * n2;
-          cache_count_[dest_group_id] += n2;
+        if (key_valid_[row_id_]) {
+          RETURN_NOT_OK(Insert(dest_group_id, keys_[row_id_]));
         }
-        row_id++;
+        row_id_++;
         return arrow::Status::OK();
       };
     } else {
       *on_valid = [this](int dest_group_id) {
-        if (data_count_[row_id] > 0) {
-           cache_validity_[dest_group_id] = true;
-           double pre_avg = cache_avg_[dest_group_id];
-           double delta = data_avg_[row_id] - pre_avg;
-           double n1 = cache_count_[dest_group_id];
-           double n2 = data_count_[row_id];
-           double deltaN = (n1 + n2) > 0 ? delta / (n1 + n2) : 0;
-           cache_m2_[dest_group_id] += (data_m2_[row_id] + delta * deltaN * n1 * n2);
-           cache_avg_[dest_group_id] += deltaN * n2;
-           cache_count_[dest_group_id] += n2;
-        }
-        row_id++;
+        RETURN_NOT_OK(Insert(dest_group_id, keys_[row_id_]));
+        row_id_++;
         return arrow::Status::OK();
       };
     }
     *on_null = [this]() {
-      row_id++;
+      row_id_++;
       return arrow::Status::OK();
     };
     return arrow::Status::OK();
   }
 
   arrow::Status Finish(ArrayList* out) override {
-    std::shared_ptr<arrow::Array> out_arr;
-    for (int i = 0; i < cache_count_.size(); i++) {
-      cache_m2_[i] = sqrt(cache_m2_[i] / (cache_count_[i] > 1 ? 
-        (cache_count_[i] - 1) : 1));
+    return Finish(0, GetResultLength(), out);
+  }
+
+  uint64_t GetResultLength() { return counts_.size(); }
+
+  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
+    if (spill_dir_ && !merged_) {
+      RETURN_NOT_OK(MergeSpills());
     }
-    RETURN_NOT_OK(builder_->AppendValues(cache_m2_, cache_validity_));
-    RETURN_NOT_OK(builder_->Finish(&out_arr));
-    out->push_back(out_arr);
+    std::shared_ptr<arrow::Array> arr_out;
+    builder_->Reset();
+    RETURN_NOT_OK(builder_->Reserve(length));
+    for (uint64_t i = 0; i < length; i++) {
+      builder_->UnsafeAppend(counts_[offset + i]);
+    }
+    RETURN_NOT_OK(builder_->Finish(&arr_out));
+    out->push_back(arr_out);
+    return arrow::Status::OK();
+  }
+
+ private:
+  using MemoTable = arrow::internal::BinaryMemoTable<arrow::BinaryBuilder>;
+  // rough pool cost of one memo entry besides its bytes: offset and hash table slots
+  static const int64_t kBytesPerMemoEntry = 40;
+  static const int kSpillPartitions = 16;
+
+  static inline int SpillPartition(int32_t group_id, uint64_t key) {
+    uint64_t h = (key ^ (static_cast<uint64_t>(group_id) << 32)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>(h >> 60);
+  }
 
+  inline arrow::Status Insert(int32_t group_id, uint64_t key) {
+    bool inserted;
+    RETURN_NOT_OK(pairs_.Insert(group_id, key, &inserted));
+    if (inserted) {
+      counts_[group_id]++;
+    }
     return arrow::Status::OK();
   }
 
-  uint64_t GetResultLength() { return cache_count_.size(); }
+  int64_t EstimatedBytes() const {
+    int64_t bytes = pairs_.bytes();
+    if (memo_table_) {
+      bytes += memo_table_->values_size() + memo_table_->size() * kBytesPerMemoEntry;
+    }
+    return bytes;
+  }
+
+  arrow::Status OpenSpillWriters() {
+    ARROW_ASSIGN_OR_RAISE(spill_dir_,
+                          arrow::internal::TemporaryDir::Make("columnar-distinct-"));
+    // memo indices are only valid until the memo table is reset, so memo keys are
+    // spilled as their bytes
+    spill_schema_ = arrow::schema(
+        {arrow::field("group_id", arrow::int32()),
+         arrow::field("key", use_raw_key_ ? arrow::uint64() : arrow::binary())});
+    for (int p = 0; p < kSpillPartitions; p++) {
+      auto path = arrow::fs::internal::ConcatAbstractPath(
+          spill_dir_->path().ToString(), "partition_" + std::to_string(p));
+      ARROW_ASSIGN_OR_RAISE(auto os, arrow::io::FileOutputStream::Open(path));
+      ARROW_ASSIGN_OR_RAISE(
+          auto writer, arrow::ipc::NewStreamWriter(os.get(), spill_schema_,
+                                                   arrow::ipc::IpcWriteOptions::Defaults()));
+      spill_paths_.push_back(path);
+      spill_os_.push_back(os);
+      spill_writers_.push_back(writer);
+    }
+    return arrow::Status::OK();
+  }
 
-  arrow::Status Finish(uint64_t offset, uint64_t length, ArrayList* out) override {
-    builder_->Reset();
-    for (int i = 0; i < length; i++) {
-      cache_m2_[i + offset] = sqrt(cache_m2_[i + offset] / 
-        (cache_count_[i + offset] > 1 ? (cache_count_[i + offset] - 1) : 1));
+  arrow::Status Spill() {
+    if (!spill_dir_) {
+      RETURN_NOT_OK(OpenSpillWriters());
     }
-    for (uint64_t i = 0; i < length; i++) {
-      if (cache_count_[offset + i] - 1 < 0.00001) {
-        // append Infinity if only one non-null value exists
-        // RETURN_NOT_OK(builder->Append(std::numeric_limits<double>::quiet_NaN()));
-        RETURN_NOT_OK(builder_->Append(std::numeric_limits<double>::infinity()));
-      } else if (cache_validity_[offset + i]) {
-        RETURN_NOT_OK(builder_->Append(cache_m2_[offset + i]));
+    std::vector<std::unique_ptr<arrow::Int32Builder>> group_builders;
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> key_builders;
+    for (int p = 0; p < kSpillPartitions; p++) {
+      group_builders.emplace_back(new arrow::Int32Builder(ctx_->memory_pool()));
+      if (use_raw_key_) {
+        key_builders.emplace_back(new arrow::UInt64Builder(ctx_->memory_pool()));
       } else {
-        // append null if all values are null 
-        RETURN_NOT_OK(builder_->AppendNull());
+        key_builders.emplace_back(new arrow::BinaryBuilder(ctx_->memory_pool()));
       }
     }
+    if (use_raw_key_) {
+      RETURN_NOT_OK(pairs_.ForEach([&](int32_t group_id, uint64_t key) {
+        auto p = SpillPartition(group_id, key);
+        RETURN_NOT_OK(group_builders[p]->Append(group_id));
+        return static_cast<arrow::UInt64Builder*>(key_builders[p].get())->Append(key);
+      }));
+    } else {
+      std::vector<arrow::util::string_view> memo_values;
+      memo_values.reserve(memo_table_->size());
+      memo_table_->VisitValues(
+          0, [&](arrow::util::string_view value) { memo_values.push_back(value); });
+      RETURN_NOT_OK(pairs_.ForEach([&](int32_t group_id, uint64_t key) {
+        auto value = memo_values[key];
+        auto p = SpillPartition(group_id, HashKeyBytes(value));
+        RETURN_NOT_OK(group_builders[p]->Append(group_id));
+        return static_cast<arrow::BinaryBuilder*>(key_builders[p].get())->Append(value);
+      }));
+    }
+    for (int p = 0; p < kSpillPartitions; p++) {
+      if (group_builders[p]->length() == 0) continue;
+      std::shared_ptr<arrow::Array> group_arr;
+      std::shared_ptr<arrow::Array> key_arr;
+      RETURN_NOT_OK(group_builders[p]->Finish(&group_arr));
+      RETURN_NOT_OK(key_builders[p]->Finish(&key_arr));
+      auto batch =
+          arrow::RecordBatch::Make(spill_schema_, group_arr->length(), {group_arr, key_arr});
+      RETURN_NOT_OK(spill_writers_[p]->WriteRecordBatch(*batch));
+    }
+    pairs_.Clear();
+    if (memo_table_) {
+      memo_table_.reset(new MemoTable(ctx_->memory_pool()));
+    }
+    return arrow::Status::OK();
+  }
 
-    std::shared_ptr<arrow::Array> out_array;
-    RETURN_NOT_OK(builder_->Finish(&out_array));
-    out->push_back(out_array);
+  static inline uint64_t HashKeyBytes(arrow::util::string_view value) {
+    return sparkcolumnarplugin::thirdparty::xxhash64::hash_bytes(
+        reinterpret_cast<const uint8_t*>(value.data()),
+        static_cast<int32_t>(value.size()), 42);
+  }
+
+  arrow::Status MergeSpills() {
+    RETURN_NOT_OK(Spill());
+    for (int p = 0; p < kSpillPartitions; p++) {
+      RETURN_NOT_OK(spill_writers_[p]->Close());
+      RETURN_NOT_OK(spill_os_[p]->Close());
+    }
+    counts_.assign(counts_.size(), 0);
+    // a (group_id, key) pair always lands in the same partition, so partitions can be
+    // deduplicated independently, memo keys are interned again per partition
+    for (int p = 0; p < kSpillPartitions; p++) {
+      ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::ReadableFile::Open(spill_paths_[p]));
+      ARROW_ASSIGN_OR_RAISE(auto reader, arrow::ipc::RecordBatchStreamReader::Open(file));
+      std::shared_ptr<arrow::RecordBatch> batch;
+      RETURN_NOT_OK(reader->ReadNext(&batch));
+      while (batch) {
+        auto groups = batch->column(0)->data()->GetValues<int32_t>(1);
+        if (use_raw_key_) {
+          auto keys = batch->column(1)->data()->GetValues<uint64_t>(1);
+          for (int64_t i = 0; i < batch->num_rows(); i++) {
+            RETURN_NOT_OK(Insert(groups[i], keys[i]));
+          }
+        } else {
+          auto keys = std::static_pointer_cast<arrow::BinaryArray>(batch->column(1));
+          for (int64_t i = 0; i < batch->num_rows(); i++) {
+            int32_t memo_index;
+            RETURN_NOT_OK(memo_table_->GetOrInsert(keys->GetView(i), &memo_index));
+            RETURN_NOT_OK(Insert(groups[i], memo_index));
+          }
+        }
+        RETURN_NOT_OK(reader->ReadNext(&batch));
+      }
+      RETURN_NOT_OK(file->Close());
+      pairs_.Clear();
+      if (memo_table_) {
+        memo_table_.reset(new MemoTable(ctx_->memory_pool()));
+      }
+    }
+    merged_ = true;
     return arrow::Status::OK();
   }
 
- private:
-  using CType = typename arrow::TypeTraits<DataType>::CType;
-  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
-  using ResDataType = typename FindAccumulatorType<DataType>::Type;
-  using ResCType = typename arrow::TypeTraits<ResDataType>::CType;
-  using ResArrayType = typename arrow::TypeTraits<ResDataType>::ArrayType;
-  std::unique_ptr<arrow::DoubleBuilder> builder_;
   // input
   arrow::compute::FunctionContext* ctx_;
-  double* data_count_;
-  double* data_avg_;
-  double* data_m2_;
-  int row_id;
-  std::shared_ptr<arrow::Array> in_count_;
-  std::shared_ptr<arrow::Array> in_avg_;
-  std::shared_ptr<arrow::Array> in_m2_;
+  std::vector<DistinctKeyColumn> columns_;
+  bool use_raw_key_;
+  std::vector<uint64_t> keys_;
+  std::vector<bool> key_valid_;
+  int row_id_ = 0;
   // result
-  std::vector<double> cache_count_;
-  std::vector<double> cache_avg_;
-  std::vector<double> cache_m2_;
-  std::vector<bool> cache_validity_;
+  CompactDistinctSet pairs_;
+  std::vector<int64_t> counts_;
+  int64_t spill_threshold_;
+  std::unique_ptr<MemoTable> memo_table_;
+  std::unique_ptr<arrow::Int64Builder> builder_;
+  // spill
+  std::unique_ptr<arrow::internal::TemporaryDir> spill_dir_;
+  std::shared_ptr<arrow::Schema> spill_schema_;
+  std::vector<std::string> spill_paths_;
+  std::vector<std::shared_ptr<arrow::io::FileOutputStream>> spill_os_;
+  std::vector<std::shared_ptr<arrow::ipc::RecordBatchWriter>> spill_writers_;
+  bool merged_ = false;
 };
 
 ///////////////////// Public Functions //////////////////
@@ -1565,6 +2983,11 @@ arrow::Status MakeSumAction(arrow::compute::FunctionContext *ctx,
   } break;
     PROCESS_SUPPORTED_TYPES(PROCESS)
 #undef PROCESS
+    case arrow::Decimal128Type::type_id: {
+      auto action_ptr =
+          std::make_shared<DecimalSumAction>(ctx, type, GetDecimalSumPrecision(type));
+      *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+    } break;
     default:
       break;
   }
@@ -1582,6 +3005,10 @@ arrow::Status MakeAvgAction(arrow::compute::FunctionContext *ctx,
   } break;
     PROCESS_SUPPORTED_TYPES(PROCESS)
 #undef PROCESS
+    case arrow::Decimal128Type::type_id: {
+      auto action_ptr = std::make_shared<DecimalAvgAction>(ctx, type);
+      *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+    } break;
     default:
       break;
   }
@@ -1633,6 +3060,10 @@ arrow::Status MakeSumCountAction(arrow::compute::FunctionContext *ctx,
   } break;
     PROCESS_SUPPORTED_TYPES(PROCESS)
 #undef PROCESS
+    case arrow::Decimal128Type::type_id: {
+      auto action_ptr = std::make_shared<DecimalSumCountAction>(ctx, type, false);
+      *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+    } break;
     default:
       break;
   }
@@ -1650,12 +3081,43 @@ arrow::Status MakeSumCountMergeAction(arrow::compute::FunctionContext *ctx,
   } break;
     PROCESS_SUPPORTED_TYPES(PROCESS)
 #undef PROCESS
+    case arrow::Decimal128Type::type_id: {
+      auto action_ptr = std::make_shared<DecimalSumCountAction>(ctx, type, true);
+      *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+    } break;
     default:
       break;
   }
   return arrow::Status::OK();
 }
 
+arrow::Status MakeSumMergeAction(arrow::compute::FunctionContext *ctx,
+                                 std::shared_ptr<arrow::DataType> type,
+                                 std::shared_ptr<ActionBase> *out) {
+  if (type->id() != arrow::Decimal128Type::type_id) {
+    return MakeSumAction(ctx, type, out);
+  }
+  auto decimal_type = std::dynamic_pointer_cast<arrow::Decimal128Type>(type);
+  auto action_ptr =
+      std::make_shared<DecimalSumAction>(ctx, type, decimal_type->precision());
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
+arrow::Status MakeDecimalAvgByCountAction(arrow::compute::FunctionContext *ctx,
+                                          std::shared_ptr<arrow::DataType> type,
+                                          std::shared_ptr<arrow::DataType> res_type,
+                                          std::shared_ptr<ActionBase> *out) {
+  if (type->id() != arrow::Decimal128Type::type_id ||
+      res_type->id() != arrow::Decimal128Type::type_id) {
+    return arrow::Status::Invalid("avgByCount of ", type->ToString(), " as ",
+                                  res_type->ToString(), " is not supported.");
+  }
+  auto action_ptr = std::make_shared<DecimalAvgByCountAction>(ctx, type, res_type);
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
 arrow::Status MakeAvgByCountAction(arrow::compute::FunctionContext *ctx,
                                    std::shared_ptr<arrow::DataType> type,
                                    std::shared_ptr<ActionBase> *out) {
@@ -1707,6 +3169,129 @@ arrow::Status MakeStddevSampFinalAction(arrow::compute::FunctionContext *ctx,
   return arrow::Status::OK();
 }
 
+// no precision fits a relative_sd of 0 or below, above 0.39 fewer than 4 bits index the
+// registers
+static arrow::Status CheckRelativeSD(double relative_sd) {
+  if (!(relative_sd > 0)) {
+    return arrow::Status::Invalid(
+        "ApproxCountDistinct expects a positive relative standard deviation, got ",
+        relative_sd);
+  }
+  if (relative_sd > 0.39) {
+    return arrow::Status::Invalid(
+        "HLL++ requires at least 4 bits for addressing. Use a lower error, at most "
+        "39%, got ",
+        relative_sd);
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status MakeApproxCountDistinctPartialAction(
+    arrow::compute::FunctionContext* ctx, std::shared_ptr<arrow::DataType> type,
+    double relative_sd, std::shared_ptr<ActionBase>* out) {
+  RETURN_NOT_OK(CheckRelativeSD(relative_sd));
+  switch (type->id()) {
+#define PROCESS(InType)                                                             \
+  case InType::type_id: {                                                           \
+    auto action_ptr =                                                               \
+        std::make_shared<ApproxCountDistinctPartialAction<InType>>(ctx, relative_sd); \
+    *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);                       \
+  } break;
+    PROCESS_SUPPORTED_TYPES(PROCESS)
+    PROCESS(arrow::Date32Type)
+    PROCESS(arrow::StringType)
+#undef PROCESS
+    default:
+      return arrow::Status::NotImplemented("ApproxCountDistinct doesn't support type ",
+                                           type->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status MakeApproxCountDistinctMergeAction(arrow::compute::FunctionContext* ctx,
+                                                 double relative_sd,
+                                                 std::shared_ptr<ActionBase>* out) {
+  RETURN_NOT_OK(CheckRelativeSD(relative_sd));
+  auto action_ptr =
+      std::make_shared<ApproxCountDistinctMergeAction>(ctx, relative_sd, false);
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
+arrow::Status MakeApproxCountDistinctFinalAction(arrow::compute::FunctionContext* ctx,
+                                                 double relative_sd,
+                                                 std::shared_ptr<ActionBase>* out) {
+  RETURN_NOT_OK(CheckRelativeSD(relative_sd));
+  auto action_ptr =
+      std::make_shared<ApproxCountDistinctMergeAction>(ctx, relative_sd, true);
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
+arrow::Status MakePercentileApproxPartialAction(arrow::compute::FunctionContext* ctx,
+                                                std::shared_ptr<arrow::DataType> type,
+                                                int accuracy,
+                                                std::shared_ptr<ActionBase>* out) {
+  switch (type->id()) {
+#define PROCESS(InType)                                                             \
+  case InType::type_id: {                                                           \
+    auto action_ptr =                                                               \
+        std::make_shared<PercentileApproxPartialAction<InType>>(ctx, accuracy);     \
+    *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);                       \
+  } break;
+    PROCESS_SUPPORTED_TYPES(PROCESS)
+#undef PROCESS
+    default:
+      return arrow::Status::NotImplemented("PercentileApprox doesn't support type ",
+                                           type->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status MakePercentileApproxMergeAction(arrow::compute::FunctionContext* ctx,
+                                              int accuracy,
+                                              std::shared_ptr<ActionBase>* out) {
+  auto action_ptr = std::make_shared<PercentileApproxMergeAction<arrow::DoubleType>>(
+      ctx, accuracy, false, 0);
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
+arrow::Status MakePercentileApproxFinalAction(arrow::compute::FunctionContext* ctx,
+                                              double percentage, int accuracy,
+                                              std::shared_ptr<arrow::DataType> type,
+                                              std::shared_ptr<ActionBase>* out) {
+  switch (type->id()) {
+#define PROCESS(InType)                                                             \
+  case InType::type_id: {                                                           \
+    auto action_ptr = std::make_shared<PercentileApproxMergeAction<InType>>(        \
+        ctx, accuracy, true, percentage);                                           \
+    *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);                       \
+  } break;
+    PROCESS_SUPPORTED_TYPES(PROCESS)
+#undef PROCESS
+    default:
+      return arrow::Status::NotImplemented("PercentileApprox doesn't support type ",
+                                           type->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status MakeCountDistinctAction(
+    arrow::compute::FunctionContext* ctx,
+    std::vector<std::shared_ptr<arrow::DataType>> type_list,
+    std::shared_ptr<ActionBase>* out) {
+  std::vector<DistinctKeyColumn> columns(type_list.size());
+  for (int i = 0; i < type_list.size(); i++) {
+    RETURN_NOT_OK(DistinctKeyColumn::GetKind(type_list[i], &columns[i].kind,
+                                             &columns[i].byte_width));
+  }
+  auto action_ptr = std::make_shared<CountDistinctAction>(ctx, std::move(columns),
+                                                          GetDistinctSpillThreshold());
+  *out = std::dynamic_pointer_cast<ActionBase>(action_ptr);
+  return arrow::Status::OK();
+}
+
 #undef PROCESS_SUPPORTED_TYPES
 
 }  // namespace extra
@@ -98,6 +98,19 @@ arrow::Status MakeAvgByCountAction(arrow::compute::FunctionContext* ctx,
                                    std::shared_ptr<arrow::DataType> type,
                                    std::shared_ptr<ActionBase>* out);
 
+/// Sum of partial sums, a decimal keeps the precision of its partial sums where
+/// MakeSumAction() widens it by 10 digits. Other types sum like MakeSumAction().
+arrow::Status MakeSumMergeAction(arrow::compute::FunctionContext* ctx,
+                                 std::shared_ptr<arrow::DataType> type,
+                                 std::shared_ptr<ActionBase>* out);
+
+/// Final avg of the decimal sum and count buffers, the average is returned as
+/// res_type, decimal(p + 4, s + 4) of the averaged decimal(p, s) in Spark.
+arrow::Status MakeDecimalAvgByCountAction(arrow::compute::FunctionContext* ctx,
+                                          std::shared_ptr<arrow::DataType> type,
+                                          std::shared_ptr<arrow::DataType> res_type,
+                                          std::shared_ptr<ActionBase>* out);
+
 arrow::Status MakeStddevSampPartialAction(arrow::compute::FunctionContext* ctx,
                                           std::shared_ptr<arrow::DataType> type,
                                           std::shared_ptr<ActionBase>* out);
@@ -105,6 +118,38 @@ arrow::Status MakeStddevSampPartialAction(arrow::compute::FunctionContext* ctx,
 arrow::Status MakeStddevSampFinalAction(arrow::compute::FunctionContext* ctx,
                                         std::shared_ptr<arrow::DataType> type,
                                         std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakeApproxCountDistinctPartialAction(
+    arrow::compute::FunctionContext* ctx, std::shared_ptr<arrow::DataType> type,
+    double relative_sd, std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakeApproxCountDistinctMergeAction(arrow::compute::FunctionContext* ctx,
+                                                 double relative_sd,
+                                                 std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakeApproxCountDistinctFinalAction(arrow::compute::FunctionContext* ctx,
+                                                 double relative_sd,
+                                                 std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakePercentileApproxPartialAction(arrow::compute::FunctionContext* ctx,
+                                                std::shared_ptr<arrow::DataType> type,
+                                                int accuracy,
+                                                std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakePercentileApproxMergeAction(arrow::compute::FunctionContext* ctx,
+                                              int accuracy,
+                                              std::shared_ptr<ActionBase>* out);
+
+/// The percentile is returned as type, the type of the aggregated column.
+arrow::Status MakePercentileApproxFinalAction(arrow::compute::FunctionContext* ctx,
+                                              double percentage, int accuracy,
+                                              std::shared_ptr<arrow::DataType> type,
+                                              std::shared_ptr<ActionBase>* out);
+
+arrow::Status MakeCountDistinctAction(
+    arrow::compute::FunctionContext* ctx,
+    std::vector<std::shared_ptr<arrow::DataType>> type_list,
+    std::shared_ptr<ActionBase>* out);
 }
 }
 }
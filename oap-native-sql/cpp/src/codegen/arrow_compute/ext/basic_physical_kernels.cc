@@ -67,15 +67,17 @@ class ProjectKernel::Impl {
 
   arrow::Status DoCodeGen(int level, const std::vector<std::string> input,
                           std::shared_ptr<CodeGenContext>* codegen_ctx_out, int* var_id) {
-    auto codegen_ctx = std::make_shared<CodeGenContext>();
+    auto codegen_ctx =
+        *codegen_ctx_out ? *codegen_ctx_out : std::make_shared<CodeGenContext>();
     int idx = 0;
     for (auto project : project_list_) {
       std::shared_ptr<ExpressionCodegenVisitor> project_node_visitor;
       std::vector<std::string> input_list;
       std::vector<int> indices_list;
-      RETURN_NOT_OK(MakeExpressionCodegenVisitor(project, input, {input_field_list_}, -1,
-                                                 var_id, &input_list,
-                                                 &project_node_visitor));
+      RETURN_NOT_OK(MakeExpressionCodegenVisitor(
+          project, input, {input_field_list_}, -1, var_id, &input_list,
+          &project_node_visitor, true, codegen_ctx->null_free));
+      codegen_ctx->batch_prepare_codes += project_node_visitor->GetBatchPrepare();
       codegen_ctx->process_codes += project_node_visitor->GetPrepare();
       auto name = project_node_visitor->GetResult();
       auto validity = project_node_visitor->GetPreCheck();
@@ -99,8 +101,9 @@ class ProjectKernel::Impl {
       process_ss << output_validity << " = " << validity << ";" << std::endl;
       codegen_ctx->process_codes += process_ss.str();
 
-      define_ss << GetCTypeString(project->return_type()) << " " << output_name << ";"
-                << std::endl;
+      // the results are declared for the whole row, a view of them stays valid
+      define_ss << GetCViewTypeString(project->return_type()) << " " << output_name
+                << ";" << std::endl;
       define_ss << "bool " << output_validity << ";" << std::endl;
       codegen_ctx->definition_codes += define_ss.str();
     }
@@ -168,13 +171,15 @@ class FilterKernel::Impl {
 
   arrow::Status DoCodeGen(int level, const std::vector<std::string> input,
                           std::shared_ptr<CodeGenContext>* codegen_ctx_out, int* var_id) {
-    auto codegen_ctx = std::make_shared<CodeGenContext>();
+    auto codegen_ctx =
+        *codegen_ctx_out ? *codegen_ctx_out : std::make_shared<CodeGenContext>();
     std::shared_ptr<ExpressionCodegenVisitor> condition_node_visitor;
     std::vector<std::string> input_list;
     std::vector<int> indices_list;
-    RETURN_NOT_OK(MakeExpressionCodegenVisitor(condition_, input, {input_field_list_}, -1,
-                                               var_id, &input_list,
-                                               &condition_node_visitor));
+    RETURN_NOT_OK(MakeExpressionCodegenVisitor(
+        condition_, input, {input_field_list_}, -1, var_id, &input_list,
+        &condition_node_visitor, true, codegen_ctx->null_free));
+    codegen_ctx->batch_prepare_codes += condition_node_visitor->GetBatchPrepare();
     codegen_ctx->process_codes += condition_node_visitor->GetPrepare();
     for (auto header : condition_node_visitor->GetHeaders()) {
       if (std::find(codegen_ctx->header_codes.begin(), codegen_ctx->header_codes.end(),
@@ -196,13 +201,14 @@ class FilterKernel::Impl {
       auto output_validity = output_name + "_validity";
       codegen_ctx->output_list.push_back(std::make_pair(output_name, field->type()));
 
-      define_ss << GetCTypeString(field->type()) << " " << output_name << ";"
+      define_ss << GetCViewTypeString(field->type()) << " " << output_name << ";"
                 << std::endl;
       define_ss << "bool " << output_validity << ";" << std::endl;
 
       process_ss << output_name << " = " << input[idx] << ";" << std::endl;
-      process_ss << output_validity << " = " << input[idx] << "_validity"
-                 << ";" << std::endl;
+      process_ss << output_validity << " = "
+                 << (codegen_ctx->null_free ? "true" : input[idx] + "_validity") << ";"
+                 << std::endl;
       idx++;
     }
     codegen_ctx->definition_codes += define_ss.str();
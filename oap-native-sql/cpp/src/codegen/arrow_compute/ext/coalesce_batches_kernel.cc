@@ -0,0 +1,547 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/array/concatenate.h>
+#include <arrow/builder.h>
+#include <arrow/compute/context.h>
+#include <arrow/record_batch.h>
+#include <arrow/status.h>
+#include <arrow/type.h>
+#include <arrow/type_traits.h>
+#include <arrow/util/checked_cast.h>
+#include <gandiva/node.h>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+
+#include "codegen/arrow_compute/ext/codegen_common.h"
+#include "codegen/arrow_compute/ext/kernels_ext.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+using ArrayList = std::vector<std::shared_ptr<arrow::Array>>;
+
+///////////////  CoalesceBatches  ////////////////
+// Appends slices of one input column into a builder which is reserved up front for a
+// whole output batch. Reports roughly how many bytes were copied so the caller can
+// cut batches by size.
+class ColumnAppender {
+ public:
+  virtual ~ColumnAppender() {}
+  virtual arrow::Status Reserve(int64_t length) = 0;
+  virtual arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                               int64_t length, int64_t* bytes) = 0;
+  virtual arrow::Status Finish(std::shared_ptr<arrow::Array>* out) = 0;
+};
+
+template <typename DataType>
+class FixedWidthAppender : public ColumnAppender {
+ public:
+  FixedWidthAppender(arrow::compute::FunctionContext* ctx,
+                     const std::shared_ptr<arrow::DataType>& type) {
+    std::unique_ptr<arrow::ArrayBuilder> array_builder;
+    arrow::MakeBuilder(ctx->memory_pool(), type, &array_builder);
+    builder_.reset(
+        arrow::internal::checked_cast<BuilderType*>(array_builder.release()));
+  }
+
+  arrow::Status Reserve(int64_t length) override { return builder_->Reserve(length); }
+
+  arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                       int64_t length, int64_t* bytes) override {
+    auto typed_in = arrow::internal::checked_cast<const ArrayType*>(in.get());
+    auto values = typed_in->raw_values() + offset;
+    if (typed_in->null_count() == 0) {
+      RETURN_NOT_OK(builder_->AppendValues(values, length));
+    } else {
+      RETURN_NOT_OK(builder_->Reserve(length));
+      for (int64_t i = 0; i < length; i++) {
+        if (typed_in->IsNull(offset + i)) {
+          builder_->UnsafeAppendNull();
+        } else {
+          builder_->UnsafeAppend(values[i]);
+        }
+      }
+    }
+    *bytes = length * sizeof(CType);
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(std::shared_ptr<arrow::Array>* out) override {
+    return builder_->Finish(out);
+  }
+
+ private:
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  using BuilderType = typename arrow::TypeTraits<DataType>::BuilderType;
+  using CType = typename arrow::TypeTraits<DataType>::CType;
+  std::unique_ptr<BuilderType> builder_;
+};
+
+class BooleanAppender : public ColumnAppender {
+ public:
+  BooleanAppender(arrow::compute::FunctionContext* ctx)
+      : builder_(new arrow::BooleanBuilder(ctx->memory_pool())) {}
+
+  arrow::Status Reserve(int64_t length) override { return builder_->Reserve(length); }
+
+  arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                       int64_t length, int64_t* bytes) override {
+    auto typed_in = arrow::internal::checked_cast<const arrow::BooleanArray*>(in.get());
+    RETURN_NOT_OK(builder_->Reserve(length));
+    for (int64_t i = offset; i < offset + length; i++) {
+      if (typed_in->IsNull(i)) {
+        builder_->UnsafeAppendNull();
+      } else {
+        builder_->UnsafeAppend(typed_in->Value(i));
+      }
+    }
+    *bytes = length / 8 + 1;
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(std::shared_ptr<arrow::Array>* out) override {
+    return builder_->Finish(out);
+  }
+
+ private:
+  std::unique_ptr<arrow::BooleanBuilder> builder_;
+};
+
+template <typename DataType>
+class BinaryAppender : public ColumnAppender {
+ public:
+  BinaryAppender(arrow::compute::FunctionContext* ctx)
+      : builder_(new BuilderType(ctx->memory_pool())) {}
+
+  arrow::Status Reserve(int64_t length) override { return builder_->Reserve(length); }
+
+  arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                       int64_t length, int64_t* bytes) override {
+    auto typed_in = arrow::internal::checked_cast<const ArrayType*>(in.get());
+    int64_t data_bytes =
+        typed_in->value_offset(offset + length) - typed_in->value_offset(offset);
+    // one reservation per slice, so the per-row appends never reallocate
+    RETURN_NOT_OK(builder_->Reserve(length));
+    RETURN_NOT_OK(builder_->ReserveData(data_bytes));
+    for (int64_t i = offset; i < offset + length; i++) {
+      if (typed_in->IsNull(i)) {
+        builder_->UnsafeAppendNull();
+      } else {
+        int32_t value_length;
+        auto value = typed_in->GetValue(i, &value_length);
+        builder_->UnsafeAppend(value, value_length);
+      }
+    }
+    *bytes = data_bytes + length * sizeof(int32_t);
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(std::shared_ptr<arrow::Array>* out) override {
+    return builder_->Finish(out);
+  }
+
+ private:
+  using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+  using BuilderType = typename arrow::TypeTraits<DataType>::BuilderType;
+  std::unique_ptr<BuilderType> builder_;
+};
+
+class DecimalAppender : public ColumnAppender {
+ public:
+  DecimalAppender(arrow::compute::FunctionContext* ctx,
+                  const std::shared_ptr<arrow::DataType>& type)
+      : builder_(new arrow::Decimal128Builder(type, ctx->memory_pool())) {}
+
+  arrow::Status Reserve(int64_t length) override { return builder_->Reserve(length); }
+
+  arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                       int64_t length, int64_t* bytes) override {
+    auto typed_in = arrow::internal::checked_cast<const arrow::Decimal128Array*>(in.get());
+    RETURN_NOT_OK(builder_->Reserve(length));
+    for (int64_t i = offset; i < offset + length; i++) {
+      if (typed_in->IsNull(i)) {
+        RETURN_NOT_OK(builder_->AppendNull());
+      } else {
+        RETURN_NOT_OK(builder_->Append(typed_in->GetValue(i)));
+      }
+    }
+    *bytes = length * typed_in->byte_width();
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(std::shared_ptr<arrow::Array>* out) override {
+    return builder_->Finish(out);
+  }
+
+ private:
+  std::unique_ptr<arrow::Decimal128Builder> builder_;
+};
+
+// Nested and other rarely used types copy the slices and concatenate them once per
+// output batch. The input buffers may be released once Append returns, so the slices
+// are not kept by reference.
+class ConcatenateAppender : public ColumnAppender {
+ public:
+  ConcatenateAppender(arrow::compute::FunctionContext* ctx) : ctx_(ctx) {}
+
+  arrow::Status Reserve(int64_t length) override { return arrow::Status::OK(); }
+
+  arrow::Status Append(const std::shared_ptr<arrow::Array>& in, int64_t offset,
+                       int64_t length, int64_t* bytes) override {
+    std::shared_ptr<arrow::Array> copy;
+    RETURN_NOT_OK(
+        arrow::Concatenate({in->Slice(offset, length)}, ctx_->memory_pool(), &copy));
+    slices_.push_back(copy);
+    *bytes = 0;
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Finish(std::shared_ptr<arrow::Array>* out) override {
+    if (slices_.size() == 1) {
+      *out = slices_[0];
+    } else {
+      RETURN_NOT_OK(arrow::Concatenate(slices_, ctx_->memory_pool(), out));
+    }
+    slices_.clear();
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::compute::FunctionContext* ctx_;
+  ArrayList slices_;
+};
+
+static arrow::Status MakeColumnAppender(arrow::compute::FunctionContext* ctx,
+                                        const std::shared_ptr<arrow::DataType>& type,
+                                        std::shared_ptr<ColumnAppender>* out) {
+  switch (type->id()) {
+#define PROCESS(InType)                                                \
+  case InType::type_id: {                                              \
+    *out = std::make_shared<FixedWidthAppender<InType>>(ctx, type);    \
+  } break;
+    PROCESS(arrow::UInt8Type)
+    PROCESS(arrow::Int8Type)
+    PROCESS(arrow::UInt16Type)
+    PROCESS(arrow::Int16Type)
+    PROCESS(arrow::UInt32Type)
+    PROCESS(arrow::Int32Type)
+    PROCESS(arrow::UInt64Type)
+    PROCESS(arrow::Int64Type)
+    PROCESS(arrow::FloatType)
+    PROCESS(arrow::DoubleType)
+    PROCESS(arrow::Date32Type)
+    PROCESS(arrow::Date64Type)
+    PROCESS(arrow::TimestampType)
+#undef PROCESS
+    case arrow::BooleanType::type_id: {
+      *out = std::make_shared<BooleanAppender>(ctx);
+    } break;
+    case arrow::StringType::type_id: {
+      *out = std::make_shared<BinaryAppender<arrow::StringType>>(ctx);
+    } break;
+    case arrow::BinaryType::type_id: {
+      *out = std::make_shared<BinaryAppender<arrow::BinaryType>>(ctx);
+    } break;
+    case arrow::Decimal128Type::type_id: {
+      *out = std::make_shared<DecimalAppender>(ctx, type);
+    } break;
+    default: {
+      *out = std::make_shared<ConcatenateAppender>(ctx);
+    } break;
+  }
+  return arrow::Status::OK();
+}
+
+// Rough bytes per row of a batch, counted the way the appenders count copied bytes.
+static int64_t EstimateRowBytes(const ArrayList& in) {
+  int64_t length = in[0]->length();
+  int64_t bytes = 0;
+  for (auto& arr : in) {
+    switch (arr->type_id()) {
+      case arrow::Type::BOOL:
+        bytes += length / 8 + 1;
+        break;
+      case arrow::Type::STRING:
+      case arrow::Type::BINARY: {
+        auto typed_arr =
+            arrow::internal::checked_cast<const arrow::BinaryArray*>(arr.get());
+        bytes += typed_arr->value_offset(length) - typed_arr->value_offset(0) +
+                 length * sizeof(int32_t);
+      } break;
+      default: {
+        auto fixed_type = std::dynamic_pointer_cast<arrow::FixedWidthType>(arr->type());
+        if (fixed_type) {
+          bytes += length * fixed_type->bit_width() / 8;
+        }
+      } break;
+    }
+  }
+  return std::max<int64_t>(1, bytes / length);
+}
+
+// Shared between the kernel and its result iterator, so batches completed while input
+// is still arriving can be drained without waiting for the last one. Output batches are
+// cut at the row target or the byte target, whichever comes first.
+class BatchCoalescer {
+ public:
+  BatchCoalescer(arrow::compute::FunctionContext* ctx, int64_t target_rows,
+                 int64_t target_bytes)
+      : ctx_(ctx), target_rows_(target_rows), target_bytes_(target_bytes) {}
+
+  arrow::Status Append(const ArrayList& in) {
+    if (in.empty() || in[0]->length() == 0) {
+      return arrow::Status::OK();
+    }
+    if (appender_list_.empty()) {
+      for (auto arr : in) {
+        std::shared_ptr<ColumnAppender> appender;
+        RETURN_NOT_OK(MakeColumnAppender(ctx_, arr->type(), &appender));
+        appender_list_.push_back(appender);
+      }
+    }
+    int64_t length = in[0]->length();
+    int64_t row_bytes = EstimateRowBytes(in);
+    // rows of this input that make a full output batch
+    int64_t batch_rows =
+        std::max<int64_t>(1, std::min(target_rows_, target_bytes_ / row_bytes));
+    int64_t offset = 0;
+    while (offset < length) {
+      // whole output batches are sliced from the input, no copy
+      if (buffered_rows_ == 0 && length - offset >= batch_rows) {
+        ArrayList out;
+        for (auto arr : in) {
+          out.push_back(offset == 0 && batch_rows == length
+                            ? arr
+                            : arr->Slice(offset, batch_rows));
+        }
+        ready_list_.push_back(out);
+        offset += batch_rows;
+        continue;
+      }
+      if (buffered_rows_ == 0) {
+        for (auto appender : appender_list_) {
+          RETURN_NOT_OK(appender->Reserve(batch_rows));
+        }
+      }
+      // the rows still fitting in both targets, at least one
+      auto room_rows = std::min(
+          target_rows_ - buffered_rows_,
+          std::max<int64_t>(1, (target_bytes_ - buffered_bytes_) / row_bytes));
+      auto append_length = std::min(length - offset, room_rows);
+      for (int i = 0; i < appender_list_.size(); i++) {
+        int64_t bytes;
+        RETURN_NOT_OK(appender_list_[i]->Append(in[i], offset, append_length, &bytes));
+        buffered_bytes_ += bytes;
+      }
+      buffered_rows_ += append_length;
+      offset += append_length;
+      if (buffered_rows_ >= target_rows_ || buffered_bytes_ >= target_bytes_) {
+        RETURN_NOT_OK(Flush());
+      }
+    }
+    return arrow::Status::OK();
+  }
+
+  /// No more input follows, the rows still buffered make the last batch.
+  void FinishInput() { input_finished_ = true; }
+
+  arrow::Status Flush() {
+    if (buffered_rows_ == 0) {
+      return arrow::Status::OK();
+    }
+    ArrayList out;
+    for (auto appender : appender_list_) {
+      std::shared_ptr<arrow::Array> arr;
+      RETURN_NOT_OK(appender->Finish(&arr));
+      out.push_back(arr);
+    }
+    ready_list_.push_back(out);
+    buffered_rows_ = 0;
+    buffered_bytes_ = 0;
+    return arrow::Status::OK();
+  }
+
+  // while input is arriving only completed batches are returned
+  bool HasNext() {
+    return !ready_list_.empty() || (input_finished_ && buffered_rows_ > 0);
+  }
+
+  arrow::Status Next(ArrayList* out) {
+    if (ready_list_.empty() && input_finished_) {
+      RETURN_NOT_OK(Flush());
+    }
+    if (ready_list_.empty()) {
+      return arrow::Status::Invalid("BatchCoalescer Next is called without input.");
+    }
+    *out = ready_list_.front();
+    ready_list_.pop_front();
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::compute::FunctionContext* ctx_;
+  const int64_t target_rows_;
+  const int64_t target_bytes_;
+  std::vector<std::shared_ptr<ColumnAppender>> appender_list_;
+  int64_t buffered_rows_ = 0;
+  int64_t buffered_bytes_ = 0;
+  bool input_finished_ = false;
+  std::deque<ArrayList> ready_list_;
+};
+
+class CoalesceBatchesKernel::Impl {
+ public:
+  Impl(arrow::compute::FunctionContext* ctx,
+       const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+       std::shared_ptr<gandiva::Node> root_node,
+       const std::vector<std::shared_ptr<arrow::Field>>& output_field_list)
+      : ctx_(ctx) {
+    // CoalesceBatches(<target rows>, <target bytes>), both are optional
+    int64_t target_rows = GetBatchSize();
+    int64_t target_bytes = GetBatchBytes();
+    auto func_node = std::dynamic_pointer_cast<gandiva::FunctionNode>(root_node);
+    if (func_node) {
+      auto children = func_node->children();
+      if (children.size() > 0) {
+        target_rows = GetIntLiteral(children[0], target_rows);
+      }
+      if (children.size() > 1) {
+        target_bytes = GetIntLiteral(children[1], target_bytes);
+      }
+    }
+    coalescer_ = std::make_shared<BatchCoalescer>(ctx_, target_rows, target_bytes);
+  }
+  virtual ~Impl() {}
+
+  arrow::Status Evaluate(const ArrayList& in) {
+    evaluated_ = true;
+    return coalescer_->Append(in);
+  }
+
+  // Input evaluated through the kernel ends when the result iterator is made. An
+  // iterator made before any input streams instead, it takes the input through
+  // ProcessAndCacheOne() and returns batches as soon as they are complete until
+  // FinishInput() is called.
+  arrow::Status MakeResultIterator(
+      std::shared_ptr<arrow::Schema> schema,
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+    if (evaluated_) {
+      coalescer_->FinishInput();
+    }
+    *out = std::make_shared<CoalesceBatchesResultIterator>(schema, coalescer_);
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<BatchCoalescer> coalescer_;
+  bool evaluated_ = false;
+
+  static int64_t GetIntLiteral(const gandiva::NodePtr& node, int64_t default_value) {
+    auto literal_node = std::dynamic_pointer_cast<gandiva::LiteralNode>(node);
+    if (!literal_node) {
+      return default_value;
+    }
+    switch (literal_node->return_type()->id()) {
+      case arrow::Int32Type::type_id:
+        return arrow::util::get<int32_t>(literal_node->holder());
+      case arrow::Int64Type::type_id:
+        return arrow::util::get<int64_t>(literal_node->holder());
+      default:
+        return default_value;
+    }
+  }
+
+  class CoalesceBatchesResultIterator : public ResultIterator<arrow::RecordBatch> {
+   public:
+    CoalesceBatchesResultIterator(std::shared_ptr<arrow::Schema> result_schema,
+                                  std::shared_ptr<BatchCoalescer> coalescer)
+        : result_schema_(result_schema), coalescer_(coalescer) {}
+
+    std::string ToString() override { return "CoalesceBatchesResultIterator"; }
+
+    bool HasNext() override { return coalescer_->HasNext(); }
+
+    arrow::Status ProcessAndCacheOne(
+        const std::vector<std::shared_ptr<arrow::Array>>& in,
+        const std::shared_ptr<arrow::Array>& selection = nullptr) override {
+      if (selection) {
+        return arrow::Status::NotImplemented(
+            "CoalesceBatchesResultIterator doesn't support a selection vector.");
+      }
+      return coalescer_->Append(in);
+    }
+
+    arrow::Status FinishInput() override {
+      coalescer_->FinishInput();
+      return arrow::Status::OK();
+    }
+
+    arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) override {
+      ArrayList arr_list;
+      RETURN_NOT_OK(coalescer_->Next(&arr_list));
+      *out = arrow::RecordBatch::Make(result_schema_, arr_list[0]->length(), arr_list);
+      return arrow::Status::OK();
+    }
+
+   private:
+    std::shared_ptr<arrow::Schema> result_schema_;
+    std::shared_ptr<BatchCoalescer> coalescer_;
+  };
+};
+
+arrow::Status CoalesceBatchesKernel::Make(
+    arrow::compute::FunctionContext* ctx,
+    const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+    std::shared_ptr<gandiva::Node> root_node,
+    const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
+    std::shared_ptr<KernalBase>* out) {
+  *out = std::make_shared<CoalesceBatchesKernel>(ctx, input_field_list, root_node,
+                                                 output_field_list);
+  return arrow::Status::OK();
+}
+
+CoalesceBatchesKernel::CoalesceBatchesKernel(
+    arrow::compute::FunctionContext* ctx,
+    const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+    std::shared_ptr<gandiva::Node> root_node,
+    const std::vector<std::shared_ptr<arrow::Field>>& output_field_list) {
+  impl_.reset(new Impl(ctx, input_field_list, root_node, output_field_list));
+  kernel_name_ = "CoalesceBatchesKernel";
+}
+
+arrow::Status CoalesceBatchesKernel::Evaluate(const ArrayList& in) {
+  return impl_->Evaluate(in);
+}
+
+arrow::Status CoalesceBatchesKernel::MakeResultIterator(
+    std::shared_ptr<arrow::Schema> schema,
+    std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+  return impl_->MakeResultIterator(schema, out);
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
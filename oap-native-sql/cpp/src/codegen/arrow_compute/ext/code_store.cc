@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/arrow_compute/ext/code_store.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "codegen/arrow_compute/ext/codegen_common.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+static const char kPrefix[] = "spark-columnar-plugin-codegen-";
+static const char kJarPrefix[] = "spark-columnar-plugin-codegen-precompile-";
+
+static bool StartsWith(const std::string& str, const std::string& prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+static bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+namespace {
+/// The files of one signature found in the store.
+struct FileGroup {
+  std::vector<std::string> files;
+  int64_t bytes = 0;
+  int64_t last_used = 0;
+  bool has_library = false;
+  bool has_temporary = false;
+};
+}  // namespace
+
+CodeStore::CodeStore(std::string dir, int64_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes) {
+  mkdir(dir_.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  mkdir((dir_ + "/locks").c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+}
+
+CodeStore* CodeStore::Get() {
+  // never destroyed, loaded libraries stay pinned until the process exits
+  static std::mutex stores_mtx;
+  static auto stores = new std::unordered_map<std::string, CodeStore*>();
+  auto dir = GetTempPath() + "/tmp";
+  std::lock_guard<std::mutex> lock(stores_mtx);
+  auto it = stores->find(dir);
+  if (it != stores->end()) {
+    return it->second;
+  }
+  auto store = new CodeStore(dir, DefaultMaxBytes());
+  store->CleanUp();
+  stores->emplace(dir, store);
+  return store;
+}
+
+int64_t CodeStore::DefaultMaxBytes() {
+  auto env = std::getenv("NATIVESQL_CODE_DIR_MAX_BYTES");
+  return env == nullptr ? 1024LL * 1024 * 1024 : std::max<int64_t>(0, std::atoll(env));
+}
+
+std::string CodeStore::GetPath(const std::string& signature,
+                               const std::string& extension) const {
+  return dir_ + "/" + kPrefix + signature + extension;
+}
+
+std::string CodeStore::GetJarPath(const std::string& signature) const {
+  return dir_ + "/" + kJarPrefix + signature + ".jar";
+}
+
+int CodeStore::Lock(const std::string& signature) {
+  return OpenLock(signature, LOCK_EX);
+}
+
+std::vector<int> CodeStore::Lock(const std::vector<std::string>& signatures) {
+  // one lock per stripe, flock on a second fd of a held stripe would block
+  std::set<size_t> stripes;
+  for (auto& signature : signatures) {
+    stripes.insert(StripeOf(signature));
+  }
+  std::vector<int> fds;
+  for (auto stripe : stripes) {
+    fds.push_back(OpenStripe(stripe, LOCK_EX));
+  }
+  return fds;
+}
+
+void CodeStore::Unlock(int fd) {
+  if (fd < 0) return;
+  flock(fd, LOCK_UN);
+  close(fd);
+}
+
+size_t CodeStore::StripeOf(const std::string& signature) {
+  return std::hash<std::string>{}(signature) % kNumLockStripes;
+}
+
+int CodeStore::OpenLock(const std::string& signature, int operation) {
+  return OpenStripe(StripeOf(signature), operation);
+}
+
+int CodeStore::OpenStripe(size_t stripe, int operation) {
+  auto lockfile = dir_ + "/locks/" + std::to_string(stripe) + ".lock";
+  auto fd =
+      open(lockfile.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fd < 0) return -1;
+  if (flock(fd, operation) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void CodeStore::Pin(const std::string& signature) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (pinned_.find(signature) != pinned_.end()) return;
+  auto libfile = GetPath(signature, ".so");
+  auto fd = open(libfile.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  flock(fd, LOCK_SH);
+  // the modification time orders the libraries for eviction
+  futimens(fd, nullptr);
+  pinned_.emplace(signature, fd);
+}
+
+std::string CodeStore::SignatureOf(const std::string& file_name) const {
+  if (StartsWith(file_name, kJarPrefix)) {
+    if (!EndsWith(file_name, ".jar")) return "";
+    auto length = file_name.size() - (sizeof(kJarPrefix) - 1) - 4;
+    return file_name.substr(sizeof(kJarPrefix) - 1, length);
+  }
+  if (!StartsWith(file_name, kPrefix)) return "";
+  auto signature = file_name.substr(sizeof(kPrefix) - 1);
+  return signature.substr(0, signature.find('.'));
+}
+
+static std::map<std::string, FileGroup> ListGroups(
+    const std::string& dir,
+    const std::function<std::string(const std::string&)>& signature_of,
+    int64_t* total_bytes) {
+  std::map<std::string, FileGroup> groups;
+  *total_bytes = 0;
+  auto dirp = opendir(dir.c_str());
+  if (dirp == nullptr) return groups;
+  struct dirent* entry;
+  while ((entry = readdir(dirp)) != nullptr) {
+    std::string name = entry->d_name;
+    auto signature = signature_of(name);
+    if (signature.empty()) continue;
+    struct stat file_stat;
+    auto path = dir + "/" + name;
+    if (stat(path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) continue;
+    auto& group = groups[signature];
+    group.files.push_back(path);
+    group.bytes += file_stat.st_size;
+    group.last_used = std::max<int64_t>(group.last_used, file_stat.st_mtime);
+    group.has_library |= name == kPrefix + signature + ".so";
+    group.has_temporary |= EndsWith(name, ".tmp");
+    *total_bytes += file_stat.st_size;
+  }
+  closedir(dirp);
+  return groups;
+}
+
+int64_t CodeStore::Evict() {
+  if (max_bytes_ <= 0) return 0;
+  int64_t total_bytes;
+  auto groups = ListGroups(
+      dir_, [this](const std::string& name) { return SignatureOf(name); },
+      &total_bytes);
+  if (total_bytes <= max_bytes_) return 0;
+  std::vector<std::pair<int64_t, std::string>> lru;
+  for (auto& group : groups) {
+    lru.emplace_back(group.second.last_used, group.first);
+  }
+  std::sort(lru.begin(), lru.end());
+  int64_t removed_bytes = 0;
+  for (auto& item : lru) {
+    if (total_bytes <= max_bytes_) break;
+    auto& signature = item.second;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (pinned_.find(signature) != pinned_.end()) continue;
+    }
+    // busy compiling or loading, or a signature of the stripe this thread holds
+    auto lock_fd = OpenLock(signature, LOCK_EX | LOCK_NB);
+    if (lock_fd < 0) continue;
+    auto& group = groups[signature];
+    int library_fd = -1;
+    if (group.has_library) {
+      library_fd = open(GetPath(signature, ".so").c_str(), O_RDONLY);
+      // another process loaded it
+      if (library_fd >= 0 && flock(library_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(library_fd);
+        Unlock(lock_fd);
+        continue;
+      }
+    }
+    for (auto& file : group.files) {
+      unlink(file.c_str());
+    }
+    total_bytes -= group.bytes;
+    removed_bytes += group.bytes;
+    if (library_fd >= 0) close(library_fd);
+    Unlock(lock_fd);
+  }
+#ifdef DEBUG
+  std::cout << "CodeStore evicted " << removed_bytes << " bytes of " << dir_
+            << ", left " << total_bytes << std::endl;
+#endif
+  return removed_bytes;
+}
+
+int CodeStore::CleanUp() {
+  int64_t total_bytes;
+  auto groups = ListGroups(
+      dir_, [this](const std::string& name) { return SignatureOf(name); },
+      &total_bytes);
+  int removed_files = 0;
+  for (auto& item : groups) {
+    auto& group = item.second;
+    if (group.has_library && !group.has_temporary) continue;
+    // a compile still running holds the lock
+    auto lock_fd = OpenLock(item.first, LOCK_EX | LOCK_NB);
+    if (lock_fd < 0) continue;
+    for (auto& file : group.files) {
+      if (group.has_library && !EndsWith(file, ".tmp")) continue;
+      if (unlink(file.c_str()) == 0) removed_files++;
+    }
+    Unlock(lock_fd);
+  }
+  return removed_files;
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+/**
+ * The directory generated codes are compiled in, shared by the executors of a host.
+ * Every file of a signature (sources, objects, profiles, library, jar and logs) is
+ * named after it, the store evicts them together, least recently loaded first, once
+ * the directory grows over NATIVESQL_CODE_DIR_MAX_BYTES.
+ *
+ * Compiles and loads of a signature are serialized by one of kNumLockStripes lock
+ * files picked by its hash, so unrelated signatures build in parallel and the lock
+ * files don't pile up. A process keeps a shared lock on each library it loaded, as
+ * libraries are never unloaded, and eviction skips every library another process or
+ * this one holds that way. Libraries are linked under a temporary name and renamed,
+ * so a crashed compile leaves no broken library, and the leftovers of one are cleaned
+ * up when a process first opens the store.
+ */
+class CodeStore {
+ public:
+  static constexpr int kNumLockStripes = 64;
+
+  CodeStore(std::string dir, int64_t max_bytes);
+
+  /// Store of GetTempPath()/tmp, NATIVESQL_CODE_DIR_MAX_BYTES (1G by default, 0 for
+  /// no bound) caps it.
+  static CodeStore* Get();
+
+  static int64_t DefaultMaxBytes();
+
+  const std::string& dir() const { return dir_; }
+
+  /// File of signature with the given extension, e.g. ".so".
+  std::string GetPath(const std::string& signature, const std::string& extension) const;
+  std::string GetJarPath(const std::string& signature) const;
+
+  /// Blocks until signature may be compiled or loaded, returns the fd to unlock.
+  int Lock(const std::string& signature);
+  /// Locks a build writing the files of several signatures, the stripes are taken in
+  /// a fixed order so two such builds can't deadlock. Returns the fds to unlock.
+  std::vector<int> Lock(const std::vector<std::string>& signatures);
+  void Unlock(int fd);
+
+  /// Marks the library of signature loaded by this process, it is no longer evicted
+  /// and becomes the most recently used.
+  void Pin(const std::string& signature);
+
+  /// Evicts the least recently loaded signatures until the directory fits its cap.
+  /// Returns the bytes removed.
+  int64_t Evict();
+
+  /// Removes temporary libraries and the files of signatures without a library, which
+  /// a failed or crashed compile left. Returns the files removed.
+  int CleanUp();
+
+ private:
+  // flocks the stripe of signature, -1 when a LOCK_NB operation finds it taken
+  int OpenLock(const std::string& signature, int operation);
+  int OpenStripe(size_t stripe, int operation);
+  static size_t StripeOf(const std::string& signature);
+  std::string SignatureOf(const std::string& file_name) const;
+
+  const std::string dir_;
+  const int64_t max_bytes_;
+  std::mutex mtx_;
+  // fds of the pinned libraries, kept open as the shared locks on them are the pins
+  std::unordered_map<std::string, int> pinned_;
+};
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
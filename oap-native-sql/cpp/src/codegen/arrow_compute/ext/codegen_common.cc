@@ -24,11 +24,16 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
+#include "codegen/arrow_compute/ext/code_store.h"
 #include "utils/macros.h"
 
 namespace sparkcolumnarplugin {
@@ -121,6 +126,12 @@ std::string GetCTypeString(std::shared_ptr<arrow::DataType> type) {
       throw;
   }
 }
+std::string GetCViewTypeString(std::shared_ptr<arrow::DataType> type) {
+  if (type->id() == arrow::StringType::type_id) {
+    return "arrow::util::string_view";
+  }
+  return GetCTypeString(type);
+}
 std::string GetTypeString(std::shared_ptr<arrow::DataType> type, std::string tail) {
   switch (type->id()) {
     case arrow::UInt8Type::type_id:
@@ -307,6 +318,8 @@ gandiva::ExpressionVector GetGandivaKernel(std::vector<gandiva::NodePtr> key_lis
 gandiva::ExpressionPtr GetHash32Kernel(std::vector<gandiva::NodePtr> key_list) {
   // This Project should be do upon GetGandivaKernel
   // So we need to treat inside functionNode as fieldNode.
+  // internal_hash32 is not a gandiva function, the expression is only evaluated by the
+  // codegen visitor, natively it is precompile::HashArrays32 over the projected keys.
   std::vector<std::shared_ptr<gandiva::Node>> func_node_list = {};
   std::shared_ptr<arrow::DataType> ret_type;
   auto seed = gandiva::TreeExprBuilder::MakeLiteral((int32_t)0);
@@ -317,7 +330,8 @@ gandiva::ExpressionPtr GetHash32Kernel(std::vector<gandiva::NodePtr> key_list) {
     auto field_node = gandiva::TreeExprBuilder::MakeField(
         arrow::field("projection_key_" + std::to_string(idx++), key->return_type()));
     func_node =
-        gandiva::TreeExprBuilder::MakeFunction("hash32", {field_node, seed}, ret_type);
+        gandiva::TreeExprBuilder::MakeFunction("internal_hash32", {field_node, seed},
+                                               ret_type);
     seed = func_node;
   }
   func_node_list.push_back(func_node);
@@ -355,6 +369,50 @@ gandiva::ExpressionPtr GetConcatedKernel(std::vector<gandiva::NodePtr> key_list)
       func_node_list[0], arrow::field("projection_key", ret_type));
 }
 
+bool IsPackableJoinKey(std::vector<gandiva::NodePtr> key_list) {
+  if (key_list.size() == 1) return true;
+  bool packable = key_list.size() == 2;
+  for (auto key : key_list) {
+    packable = packable && key->return_type()->id() == arrow::Type::INT32;
+  }
+  return packable;
+}
+
+gandiva::ExpressionPtr GetJoinKeyKernel(std::vector<gandiva::NodePtr> key_list) {
+  if (key_list.size() == 1) {
+    return GetConcatedKernel(key_list);
+  }
+  // two int32 keys are packed as ((int64)k0 << 32) | (uint32)k1
+  auto ret_type = arrow::int64();
+  auto high = gandiva::TreeExprBuilder::MakeFunction(
+      "multiply",
+      {gandiva::TreeExprBuilder::MakeFunction("castBIGINT", {key_list[0]}, ret_type),
+       gandiva::TreeExprBuilder::MakeLiteral((int64_t)1 << 32)},
+      ret_type);
+  auto low = gandiva::TreeExprBuilder::MakeFunction(
+      "bitwise_and",
+      {gandiva::TreeExprBuilder::MakeFunction("castBIGINT", {key_list[1]}, ret_type),
+       gandiva::TreeExprBuilder::MakeLiteral((int64_t)0xFFFFFFFF)},
+      ret_type);
+  auto packed = gandiva::TreeExprBuilder::MakeFunction("add", {high, low}, ret_type);
+  return gandiva::TreeExprBuilder::MakeExpression(
+      packed, arrow::field("projection_key", ret_type));
+}
+
+std::string GetNoNullCondition(const std::vector<std::string>& array_list) {
+  if (array_list.empty()) {
+    return "true";
+  }
+  std::stringstream ss;
+  for (int i = 0; i < array_list.size(); i++) {
+    if (i != 0) {
+      ss << " && ";
+    }
+    ss << array_list[i] << "->null_count() == 0";
+  }
+  return ss.str();
+}
+
 arrow::Status GetIndexList(const std::vector<std::shared_ptr<arrow::Field>>& target_list,
                            const std::vector<std::shared_ptr<arrow::Field>>& source_list,
                            std::vector<int>* out) {
@@ -460,30 +518,99 @@ int GetBatchSize() {
   return batch_size;
 }
 
-int FileSpinLock() {
-  std::string lockfile = GetTempPath() + "/nativesql_compile.lock";
+int64_t GetBatchBytes() {
+  int64_t batch_bytes;
+  const char* env_batch_bytes = std::getenv("NATIVESQL_BATCH_BYTES");
+  if (env_batch_bytes != nullptr) {
+    batch_bytes = atoll(env_batch_bytes);
+  } else {
+    batch_bytes = 32 * 1024 * 1024;
+  }
+  return batch_bytes;
+}
 
-  auto fd = open(lockfile.c_str(), O_CREAT, S_IRWXU | S_IRWXG);
-  flock(fd, LOCK_EX);
+int64_t GetBatchMaxRows() {
+  int64_t max_rows;
+  const char* env_max_rows = std::getenv("NATIVESQL_BATCH_MAX_ROWS");
+  if (env_max_rows != nullptr) {
+    max_rows = atoll(env_max_rows);
+  } else {
+    max_rows = 65536;
+  }
+  return std::max<int64_t>(max_rows, GetBatchSize());
+}
 
-  return fd;
+bool GetHashRelationStatsEnabled() {
+  const char* env_stats = std::getenv("NATIVESQL_HASH_RELATION_STATS");
+  return env_stats != nullptr && atoi(env_stats) != 0;
 }
 
-void FileSpinUnLock(int fd) {
-  flock(fd, LOCK_UN);
-  close(fd);
+int GetWSCGThreads() {
+  int threads = 1;
+  const char* env_threads = std::getenv("NATIVESQL_WSCG_THREADS");
+  if (env_threads != nullptr) {
+    threads = atoi(env_threads);
+  }
+  // bounded per task, several tasks share the executor cores
+  int max_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  return std::max(1, std::min(threads, max_threads));
 }
 
-arrow::Status CompileCodes(std::string codes, std::string signature) {
+int GetMorselRows() {
+  int morsel_rows;
+  const char* env_morsel_rows = std::getenv("NATIVESQL_WSCG_MORSEL_ROWS");
+  if (env_morsel_rows != nullptr) {
+    morsel_rows = std::max(1, atoi(env_morsel_rows));
+  } else {
+    morsel_rows = 1024;
+  }
+  return morsel_rows;
+}
+
+int FileSpinLock(const std::string& signature) {
+  return CodeStore::Get()->Lock(signature);
+}
+
+void FileSpinUnLock(int fd) { CodeStore::Get()->Unlock(fd); }
+
+int64_t GetProfileGuidedThresholdMillis() {
+  int64_t threshold_millis = 0;
+  const char* env_threshold = std::getenv("NATIVESQL_PGO_THRESHOLD_MS");
+  if (env_threshold != nullptr) {
+    threshold_millis = std::max<int64_t>(0, atoll(env_threshold));
+  }
+  return threshold_millis;
+}
+
+int GetProfileBatches() {
+  int profile_batches;
+  const char* env_profile_batches = std::getenv("NATIVESQL_PGO_PROFILE_BATCHES");
+  if (env_profile_batches != nullptr) {
+    profile_batches = std::max(1, atoi(env_profile_batches));
+  } else {
+    profile_batches = 32;
+  }
+  return profile_batches;
+}
+
+arrow::Status CompileCodes(std::string codes, std::string signature,
+                           ProfileBuild profile_build, const std::string& profile_key) {
   // temporary cpp/library output files
   srand(time(NULL));
-  std::string outpath = GetTempPath() + "/tmp";
-  mkdir(outpath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-  std::string prefix = "/spark-columnar-plugin-codegen-";
-  std::string cppfile = outpath + prefix + signature + ".cc";
-  std::string libfile = outpath + prefix + signature + ".so";
-  std::string jarfile = outpath + prefix + signature + ".jar";
-  std::string logfile = outpath + prefix + signature + ".log";
+  auto store = CodeStore::Get();
+  std::string outpath = store->dir();
+  std::string cppfile = store->GetPath(signature, ".cc");
+  std::string libfile = store->GetPath(signature, ".so");
+  // linked under a temporary name, a library in the store is always complete
+  std::string tmp_libfile = store->GetPath(signature, ".so.tmp");
+  std::string logfile = store->GetPath(signature, ".log");
+  // Both profile builds compile the same source to the same object, gcc names the
+  // profile after the object and checks it against the source locations. Without a
+  // profile directory it is written next to the object, as a file of profile_key.
+  std::string objfile = store->GetPath(profile_key, ".pgo.o");
+  if (profile_build != ProfileBuild::kNone) {
+    cppfile = store->GetPath(profile_key, ".pgo.cc");
+  }
   std::ofstream out(cppfile.c_str(), std::ofstream::out);
 
   // output code to file
@@ -492,6 +619,12 @@ arrow::Status CompileCodes(std::string codes, std::string signature) {
     exit(EXIT_FAILURE);
   }
   out << codes;
+  if (profile_build == ProfileBuild::kGenerate) {
+    // lets the running task write the counters out without unloading the library
+    out << R"(
+extern "C" void __gcov_dump(void);
+extern "C" void DumpProfile() { __gcov_dump(); })";
+  }
 #ifdef DEBUG
   std::cout << "BatchSize is " << GetBatchSize() << std::endl;
   std::cout << codes << std::endl;
@@ -521,8 +654,24 @@ arrow::Status CompileCodes(std::string codes, std::string signature) {
   // compile the code
   std::string cmd = env_gcc + " -std=c++14 -Wno-deprecated-declarations " + arrow_header +
                     arrow_lib + arrow_lib2 + nativesql_header + nativesql_header_2 +
-                    nativesql_lib + cppfile + " -o " + libfile +
+                    nativesql_lib + cppfile + " -o " + tmp_libfile +
                     " -O3 -march=native -shared -fPIC -lspark_columnar_jni 2> " + logfile;
+  if (profile_build != ProfileBuild::kNone) {
+    std::string profile_flags;
+    if (profile_build == ProfileBuild::kGenerate) {
+      // morsels of one batch bump the counters from several threads
+      profile_flags = " -fprofile-generate -fprofile-update=atomic ";
+    } else {
+      // functions the profiled batches never reached have no profile
+      profile_flags = " -fprofile-use -fprofile-correction -Wno-missing-profile"
+                      " -Wno-coverage-mismatch ";
+    }
+    cmd = env_gcc + " -std=c++14 -Wno-deprecated-declarations " + arrow_header +
+          nativesql_header + nativesql_header_2 + profile_flags + " -c " + cppfile +
+          " -o " + objfile + " -O3 -march=native -fPIC 2> " + logfile + " && " +
+          env_gcc + profile_flags + arrow_lib + arrow_lib2 + nativesql_lib + objfile +
+          " -o " + tmp_libfile + " -shared -fPIC -lspark_columnar_jni 2>> " + logfile;
+  }
 #ifdef DEBUG
   std::cout << cmd << std::endl;
 #endif
@@ -532,6 +681,11 @@ arrow::Status CompileCodes(std::string codes, std::string signature) {
 #ifdef DEBUG
   std::cout << "CodeGeneration took " << TIME_TO_STRING(elapse_time) << std::endl;
 #endif
+  if (WEXITSTATUS(ret) != EXIT_SUCCESS && profile_build != ProfileBuild::kNone) {
+    // the plain build keeps running, a failed profile build only stops profiling
+    unlink(tmp_libfile.c_str());
+    return arrow::Status::Invalid("profile build failed, see ", logfile);
+  }
   if (WEXITSTATUS(ret) != EXIT_SUCCESS) {
     std::cout << "compilation failed, see " << logfile << std::endl;
     std::cout << cmd << std::endl;
@@ -539,6 +693,9 @@ arrow::Status CompileCodes(std::string codes, std::string signature) {
     system(cmd.c_str());
     exit(EXIT_FAILURE);
   }
+  if (rename(tmp_libfile.c_str(), libfile.c_str()) != 0) {
+    return arrow::Status::IOError("rename ", tmp_libfile, " failed: ", strerror(errno));
+  }
   cmd = "cd " + outpath + "; jar -cf spark-columnar-plugin-codegen-precompile-" +
         signature + ".jar spark-columnar-plugin-codegen-" + signature + ".so";
 #ifdef DEBUG
@@ -555,6 +712,8 @@ arrow::Status CompileCodes(std::string codes, std::string signature) {
     std::cout << "stat failed: " << strerror(errno) << std::endl;
     exit(EXIT_FAILURE);
   }
+  // the signature lock of this compile is held, eviction skips its stripe
+  store->Evict();
 
   return arrow::Status::OK();
 }
@@ -572,11 +731,44 @@ std::string exec(const char* cmd) {
   return result;
 }
 
+using MakeCodeGenFunc = void (*)(arrow::compute::FunctionContext* ctx,
+                                 std::shared_ptr<CodeGenBase>* out);
+
+// Libraries are never unloaded, so the resolved entry point of a signature stays valid
+// and later tasks skip dlopen and dlsym.
+static std::mutex loaded_libraries_mtx;
+static std::unordered_map<std::string, MakeCodeGenFunc> loaded_libraries;
+static int64_t loaded_library_hits = 0;
+static int64_t loaded_library_misses = 0;
+
+void GetLoadLibraryMetrics(int64_t* hits, int64_t* misses) {
+  std::lock_guard<std::mutex> lock(loaded_libraries_mtx);
+  *hits = loaded_library_hits;
+  *misses = loaded_library_misses;
+}
+
 arrow::Status LoadLibrary(std::string signature, arrow::compute::FunctionContext* ctx,
                           std::shared_ptr<CodeGenBase>* out) {
-  std::string outpath = GetTempPath() + "/tmp";
-  std::string prefix = "/spark-columnar-plugin-codegen-";
-  std::string libfile = outpath + prefix + signature + ".so";
+  MakeCodeGenFunc MakeCodeGen = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(loaded_libraries_mtx);
+    auto it = loaded_libraries.find(signature);
+    if (it != loaded_libraries.end()) {
+      loaded_library_hits++;
+      MakeCodeGen = it->second;
+    }
+  }
+  if (MakeCodeGen != nullptr) {
+    MakeCodeGen(ctx, out);
+    return arrow::Status::OK();
+  }
+  auto store = CodeStore::Get();
+  std::string libfile = store->GetPath(signature, ".so");
+  // the usual miss before a compile, without listing the whole store
+  struct stat lib_stat;
+  if (stat(libfile.c_str(), &lib_stat) != 0) {
+    return arrow::Status::Invalid(libfile, " is not generated");
+  }
   // load dynamic library
   void* dynlib = dlopen(libfile.c_str(), RTLD_LAZY);
   if (!dynlib) {
@@ -594,8 +786,6 @@ arrow::Status LoadLibrary(std::string signature, arrow::compute::FunctionContext
   // loading symbol from library and assign to pointer
   // (to be cast to function pointer later)
 
-  void (*MakeCodeGen)(arrow::compute::FunctionContext * ctx,
-                      std::shared_ptr<CodeGenBase> * out);
   *(void**)(&MakeCodeGen) = dlsym(dynlib, "MakeCodeGen");
   const char* dlsym_error = dlerror();
   if (dlsym_error != NULL) {
@@ -603,10 +793,36 @@ arrow::Status LoadLibrary(std::string signature, arrow::compute::FunctionContext
     ss << "error loading symbol:\n" << dlsym_error << std::endl;
     return arrow::Status::Invalid(ss.str());
   }
+  {
+    std::lock_guard<std::mutex> lock(loaded_libraries_mtx);
+    if (loaded_libraries.emplace(signature, MakeCodeGen).second) {
+      loaded_library_misses++;
+    }
+  }
+
+  store->Pin(signature);
 
   MakeCodeGen(ctx, out);
   return arrow::Status::OK();
 }
+
+arrow::Status DumpLibraryProfile(std::string signature) {
+  std::string libfile = CodeStore::Get()->GetPath(signature, ".so");
+  // only a library the task already loaded has counters to write
+  void* dynlib = dlopen(libfile.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+  if (!dynlib) {
+    return arrow::Status::Invalid(libfile, " is not loaded");
+  }
+  void (*DumpProfile)() = nullptr;
+  *(void**)(&DumpProfile) = dlsym(dynlib, "DumpProfile");
+  if (DumpProfile == nullptr) {
+    dlclose(dynlib);
+    return arrow::Status::Invalid(libfile, " is not an instrumented build");
+  }
+  DumpProfile();
+  dlclose(dynlib);
+  return arrow::Status::OK();
+}
 }  // namespace extra
 }  // namespace arrowcompute
 }  // namespace codegen
@@ -33,21 +33,42 @@ namespace extra {
 
 std::string BaseCodes();
 
-int FileSpinLock();
+/// Serializes compiling and loading the library of signature across processes.
+int FileSpinLock(const std::string& signature);
 
 void FileSpinUnLock(int fd);
 
 int GetBatchSize();
+int64_t GetBatchBytes();
+/// Rows a batch sized by bytes may grow to, at least GetBatchSize().
+int64_t GetBatchMaxRows();
+/// NATIVESQL_HASH_RELATION_STATS=1 logs the HashRelationStats of each built relation,
+/// which costs a scan of the relation.
+bool GetHashRelationStatsEnabled();
+int GetWSCGThreads();
+int GetMorselRows();
+int64_t GetProfileGuidedThresholdMillis();
+int GetProfileBatches();
 std::string exec(const char* cmd);
 std::string GetTempPath();
 std::string GetArrowTypeDefString(std::shared_ptr<arrow::DataType> type);
 std::string GetCTypeString(std::shared_ptr<arrow::DataType> type);
+/// C type of a value that doesn't outlive the row it was read for, strings are views
+/// into the array or the variable they came from.
+std::string GetCViewTypeString(std::shared_ptr<arrow::DataType> type);
 std::string GetTypeString(std::shared_ptr<arrow::DataType> type,
                           std::string tail = "Type");
 std::string GetTemplateString(std::shared_ptr<arrow::DataType> type,
                               std::string template_name, std::string tail = "",
                               std::string prefix = "");
 gandiva::ExpressionPtr GetConcatedKernel(std::vector<gandiva::NodePtr> key_list);
+/// Whether the keys of a join fit the single scalar key of the type 0 hash relation
+/// exactly: one key, or two int32 keys. Other joins keep their keys in unsafe rows and
+/// compare them after the hash matched, i.e. use the type 1 relation.
+bool IsPackableJoinKey(std::vector<gandiva::NodePtr> key_list);
+/// The single key of a join whose keys are IsPackableJoinKey, two int32 keys are packed
+/// into one int64.
+gandiva::ExpressionPtr GetJoinKeyKernel(std::vector<gandiva::NodePtr> key_list);
 gandiva::ExpressionPtr GetHash32Kernel(std::vector<gandiva::NodePtr> key_list);
 gandiva::ExpressionVector GetGandivaKernel(std::vector<gandiva::NodePtr> key_list);
 template <typename T>
@@ -60,6 +81,8 @@ std::string GetStringFromList(std::vector<T> list) {
 }
 std::string GetParameterList(std::vector<std::string> parameter_list,
                              bool comma_ahead = true);
+/// Run time condition to pick the null free variant, true if no array has a null.
+std::string GetNoNullCondition(const std::vector<std::string>& array_list);
 arrow::Status GetIndexList(const std::vector<std::shared_ptr<arrow::Field>>& target_list,
                            const std::vector<std::shared_ptr<arrow::Field>>& source_list,
                            std::vector<int>* out);
@@ -76,10 +99,23 @@ arrow::Status GetIndexListFromSchema(
 std::pair<int, int> GetFieldIndex(gandiva::FieldPtr target_field,
                                   std::vector<gandiva::FieldVector> field_list_v);
 
-arrow::Status CompileCodes(std::string codes, std::string signature);
+/// Builds of generated codes: the plain one, one instrumented to count its branches and
+/// one optimised with those counts. Both profile builds of the same codes pass the same
+/// profile_key, which names the profile on disk.
+enum class ProfileBuild { kNone, kGenerate, kUse };
+
+arrow::Status CompileCodes(std::string codes, std::string signature,
+                           ProfileBuild profile_build = ProfileBuild::kNone,
+                           const std::string& profile_key = "");
+
+/// Writes out the branch counts an instrumented library loaded by this process gathered.
+arrow::Status DumpLibraryProfile(std::string signature);
 
 arrow::Status LoadLibrary(std::string signature, arrow::compute::FunctionContext* ctx,
                           std::shared_ptr<CodeGenBase>* out);
+
+/// Loads of already resolved libraries and of new ones since the process started.
+void GetLoadLibraryMetrics(int64_t* hits, int64_t* misses);
 }  // namespace extra
 }  // namespace arrowcompute
 }  // namespace codegen
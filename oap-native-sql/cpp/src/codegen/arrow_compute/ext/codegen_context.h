@@ -21,11 +21,18 @@
 #include <arrow/type_fwd.h>
 
 struct CodeGenContext {
+  // set by the caller before DoCodeGen when the input columns of the kernel hold no
+  // null in the loop generated, their validity checks are then emitted as true
+  bool null_free = false;
   std::vector<std::string> header_codes;
   std::string hash_relation_prepare_codes;
+  // run once per input batch, before the row loop
+  std::string batch_prepare_codes;
   std::string prepare_codes;
   std::string process_codes;
   std::string finish_codes;
+  // run once a LIMIT's row budget is met, drops what the kernel still holds
+  std::string release_codes;
   std::string definition_codes;
   std::vector<std::string> function_list;
   std::vector<std::pair<std::string, std::shared_ptr<arrow::DataType>>> output_list;
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/result.h>
+#include <arrow/status.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+/// Set of distinct (group_id, key) pairs of a count(distinct). The pairs of all
+/// groups share one open addressing table of 16 byte slots allocated from the memory
+/// pool, so the set is charged to the pool and costs no heap node per entry.
+class CompactDistinctSet {
+ public:
+  explicit CompactDistinctSet(arrow::MemoryPool* pool) : pool_(pool) {}
+
+  /// Sets inserted to true if the pair was not in the set yet.
+  inline arrow::Status Insert(int32_t group_id, uint64_t key, bool* inserted) {
+    if ((size_ + 1) * 2 > capacity_) {
+      RETURN_NOT_OK(Grow());
+    }
+    auto slot = Find(group_id, key);
+    *inserted = slot->tag == 0;
+    if (*inserted) {
+      slot->key = key;
+      slot->tag = static_cast<uint32_t>(group_id) + 1;
+      size_++;
+    }
+    return arrow::Status::OK();
+  }
+
+  inline int64_t size() const { return size_; }
+
+  /// Bytes held in the memory pool.
+  inline int64_t bytes() const { return capacity_ * sizeof(Slot); }
+
+  /// Calls func(group_id, key) for every pair, stops at the first error.
+  template <typename Func>
+  arrow::Status ForEach(Func&& func) const {
+    for (int64_t i = 0; i < capacity_; i++) {
+      if (slots_[i].tag != 0) {
+        RETURN_NOT_OK(func(static_cast<int32_t>(slots_[i].tag - 1), slots_[i].key));
+      }
+    }
+    return arrow::Status::OK();
+  }
+
+  /// Drops all pairs and gives the table back to the pool.
+  void Clear() {
+    buffer_.reset();
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  static const int64_t kInitialCapacity = 1024;
+
+  struct Slot {
+    uint64_t key;
+    // group_id + 1, 0 marks an empty slot
+    uint32_t tag;
+    uint32_t padding;
+  };
+
+  static inline uint64_t HashPair(int32_t group_id, uint64_t key) {
+    uint64_t h = key ^ (static_cast<uint64_t>(static_cast<uint32_t>(group_id)) << 32 |
+                        static_cast<uint32_t>(group_id));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // the slot holding the pair, or the empty slot it goes to
+  inline Slot* Find(int32_t group_id, uint64_t key) const {
+    auto tag = static_cast<uint32_t>(group_id) + 1;
+    auto mask = static_cast<uint64_t>(capacity_ - 1);
+    auto pos = HashPair(group_id, key) & mask;
+    while (slots_[pos].tag != 0 && (slots_[pos].tag != tag || slots_[pos].key != key)) {
+      pos = (pos + 1) & mask;
+    }
+    return &slots_[pos];
+  }
+
+  arrow::Status Grow() {
+    auto old_buffer = buffer_;
+    auto old_slots = slots_;
+    auto old_capacity = capacity_;
+    auto capacity = capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
+    ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateBuffer(capacity * sizeof(Slot), pool_));
+    slots_ = reinterpret_cast<Slot*>(buffer_->mutable_data());
+    memset(slots_, 0, capacity * sizeof(Slot));
+    capacity_ = capacity;
+    for (int64_t i = 0; i < old_capacity; i++) {
+      if (old_slots[i].tag != 0) {
+        *Find(static_cast<int32_t>(old_slots[i].tag - 1), old_slots[i].key) =
+            old_slots[i];
+      }
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::MemoryPool* pool_;
+  std::shared_ptr<arrow::Buffer> buffer_;
+  Slot* slots_ = nullptr;
+  int64_t capacity_ = 0;
+  int64_t size_ = 0;
+};
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
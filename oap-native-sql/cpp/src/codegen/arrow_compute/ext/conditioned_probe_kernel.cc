@@ -40,7 +40,9 @@
 #include "codegen/arrow_compute/ext/typed_node_visitor.h"
 #include "codegen/common/hash_relation_number.h"
 #include "codegen/common/hash_relation_string.h"
+#include "precompile/internal_hash.h"
 #include "precompile/unsafe_array.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 namespace sparkcolumnarplugin {
@@ -82,6 +84,11 @@ class ConditionedProbeKernel::Impl {
         std::dynamic_pointer_cast<gandiva::LiteralNode>(hash_configuration_list[0])
             ->holder());
     hash_map_type_ = std::stoi(hash_map_type_str);
+    // keys which don't fit one scalar exactly are kept in unsafe rows and compared
+    // after the hash matched, HashRelationKernel builds the same way
+    if (hash_map_type_ == 0 && !IsPackableJoinKey(right_key_node_list)) {
+      hash_map_type_ = 1;
+    }
     /////////// right_key_list may need to do precodegen /////////////
     gandiva::FieldVector right_key_list;
     /** two scenarios:
@@ -109,7 +116,7 @@ class ConditionedProbeKernel::Impl {
      * right_key_hash_codegen_
      * */
     if (pre_processed_key_ && hash_map_type_ == 0) {
-      right_key_project_expr_ = GetConcatedKernel(right_key_node_list);
+      right_key_project_expr_ = GetJoinKeyKernel(right_key_node_list);
       right_key_project_ = right_key_project_expr_->root();
     }
     if (hash_map_type_ == 1) {
@@ -166,7 +173,8 @@ class ConditionedProbeKernel::Impl {
 
   arrow::Status DoCodeGen(int level, std::vector<std::string> input,
                           std::shared_ptr<CodeGenContext>* codegen_ctx_out, int* var_id) {
-    auto codegen_ctx = std::make_shared<CodeGenContext>();
+    auto codegen_ctx =
+        *codegen_ctx_out ? *codegen_ctx_out : std::make_shared<CodeGenContext>();
 
     codegen_ctx->header_codes.push_back(
         R"(#include "codegen/arrow_compute/ext/array_item_index.h")");
@@ -188,6 +196,11 @@ class ConditionedProbeKernel::Impl {
                     << std::endl;
     hash_define_ss << "std::shared_ptr<HashRelation> hash_relation_list_"
                    << hash_relation_id_ << "_;" << std::endl;
+    std::stringstream hash_release_ss;
+    hash_release_ss << "hash_relation_list_" << hash_relation_id_ << "_ = nullptr;"
+                    << std::endl;
+    // the payload is gathered in the layout HashRelationKernel chose, columns or
+    // packed rows for wide payloads
     for (int i = 0; i < left_field_list_.size(); i++) {
       std::stringstream hash_relation_col_name_ss;
       hash_relation_col_name_ss << "hash_relation_" << hash_relation_id_ << "_" << i;
@@ -195,13 +208,15 @@ class ConditionedProbeKernel::Impl {
       auto hash_relation_col_type = left_field_list_[i]->type();
       hash_define_ss << "std::shared_ptr<"
                      << GetTemplateString(hash_relation_col_type,
-                                          "TypedHashRelationColumn", "Type", "arrow::")
+                                          "TypedHashRelationPayload", "Type", "arrow::")
                      << "> " << hash_relation_col_name << ";" << std::endl;
       hash_prepare_ss << "RETURN_NOT_OK(hash_relation_list_[" << hash_relation_id_
-                      << "]->GetColumn(" << i << ", &" << hash_relation_col_name << "));"
-                      << std::endl;
+                      << "]->GetPayloadColumn(" << i << ", &"
+                      << hash_relation_col_name << "));" << std::endl;
+      hash_release_ss << hash_relation_col_name << " = nullptr;" << std::endl;
     }
     codegen_ctx->hash_relation_prepare_codes = hash_prepare_ss.str();
+    codegen_ctx->release_codes = hash_release_ss.str();
 
     // define output list here, which will also be defined in class variables definition
     int idx = 0;
@@ -210,7 +225,9 @@ class ConditionedProbeKernel::Impl {
                          "_output_col_" + std::to_string(idx++);
       auto output_validity = output_name + "_validity";
       codegen_ctx->output_list.push_back(std::make_pair(output_name, field->type()));
-      hash_define_ss << GetCTypeString(field->type()) << " " << output_name << ";"
+      // the probed values are declared in the probe loop, which the kernels after the
+      // probe run in
+      hash_define_ss << GetCViewTypeString(field->type()) << " " << output_name << ";"
                      << std::endl;
       hash_define_ss << "bool " << output_validity << ";" << std::endl;
     }
@@ -226,8 +243,8 @@ class ConditionedProbeKernel::Impl {
     if (right_key_project_codegen_.size() == 1) {
       // when right_key is single and not string, we don't need to use unsafeRow
       // chendi: But we still use name unsafe_row_${id} to pass key data
-      prepare_ss << GetCTypeString(right_key_project_codegen_[0]->result()->type()) << " "
-                 << unsafe_row_name << ";" << std::endl;
+      prepare_ss << GetCViewTypeString(right_key_project_codegen_[0]->result()->type())
+                 << " " << unsafe_row_name << ";" << std::endl;
       do_unsafe_row = false;
     } else {
       prepare_ss << "std::shared_ptr<UnsafeRow> " << unsafe_row_name
@@ -237,9 +254,9 @@ class ConditionedProbeKernel::Impl {
     idx = 0;
     for (auto expr : right_key_project_codegen_) {
       std::shared_ptr<ExpressionCodegenVisitor> project_node_visitor;
-      RETURN_NOT_OK(MakeExpressionCodegenVisitor(expr->root(), input, {right_field_list_},
-                                                 -1, var_id, &input_list,
-                                                 &project_node_visitor));
+      RETURN_NOT_OK(MakeExpressionCodegenVisitor(
+          expr->root(), input, {right_field_list_}, -1, var_id, &input_list,
+          &project_node_visitor, false, codegen_ctx->null_free));
       prepare_ss << project_node_visitor->GetPrepare();
       auto key_name = project_node_visitor->GetResult();
       auto validity_name = project_node_visitor->GetPreCheck();
@@ -366,21 +383,17 @@ class ConditionedProbeKernel::Impl {
       if (hash_map_type_ == 0) {
         if (right_key_project_list.size() == 1) {
           auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-          THROW_NOT_OK(gandiva::Projector::Make(arrow::schema(right_field_list_),
-                                                right_key_project_list[0], configuration,
-                                                &right_hash_key_project_));
+          THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(
+              arrow::schema(right_field_list_), right_key_project_list[0], configuration,
+              &right_hash_key_project_));
         }
       } else if (hash_map_type_ == 1) {
+        // the keys are hashed by HashArrays32, right_key_project_list[0] only tells
+        // how the codegen path hashes them
         auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-        for (auto expr : right_key_project_list[1]) {
-          right_projected_field_list_.push_back(expr->result());
-        }
-        THROW_NOT_OK(gandiva::Projector::Make(arrow::schema(right_projected_field_list_),
-                                              right_key_project_list[0], configuration,
-                                              &right_hash_key_project_));
-        THROW_NOT_OK(gandiva::Projector::Make(arrow::schema(right_field_list_),
-                                              right_key_project_list[1], configuration,
-                                              &right_keys_project_));
+        THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(
+            arrow::schema(right_field_list_), right_key_project_list[1], configuration,
+            &right_keys_project_));
       }
     }
 
@@ -400,6 +413,7 @@ class ConditionedProbeKernel::Impl {
   PROCESS(arrow::StringType)
     arrow::Status SetDependencies(
         const std::vector<std::shared_ptr<ResultIteratorBase>>& dependent_iter_list) {
+      if (row_budget_ == 0) return arrow::Status::OK();
       auto iter = dependent_iter_list[0];
       auto typed_dependent =
           std::dynamic_pointer_cast<ResultIterator<HashRelation>>(iter);
@@ -530,6 +544,18 @@ class ConditionedProbeKernel::Impl {
         const std::vector<std::shared_ptr<arrow::Array>>& in,
         std::shared_ptr<arrow::RecordBatch>* out,
         const std::shared_ptr<arrow::Array>& selection = nullptr) override {
+      if (row_budget_ == 0) {
+        // the hash relation is gone, only the schema is left to answer
+        arrow::ArrayVector empty_list;
+        for (auto field : result_schema_->fields()) {
+          std::shared_ptr<arrow::Array> empty;
+          RETURN_NOT_OK(
+              arrow::MakeArrayOfNull(ctx_->memory_pool(), field->type(), 0, &empty));
+          empty_list.push_back(empty);
+        }
+        *out = arrow::RecordBatch::Make(result_schema_, 0, empty_list);
+        return arrow::Status::OK();
+      }
       // Get key array, which should be typed
       std::shared_ptr<arrow::Array> key_array;
       arrow::ArrayVector projected_keys_outputs;
@@ -545,11 +571,8 @@ class ConditionedProbeKernel::Impl {
       if (hash_map_type_ == 1) {
         RETURN_NOT_OK(right_keys_project_->Evaluate(*in_batch, ctx_->memory_pool(),
                                                     &projected_keys_outputs));
-        in_batch = arrow::RecordBatch::Make(arrow::schema(right_projected_field_list_),
-                                            in_batch->num_rows(), projected_keys_outputs);
-        RETURN_NOT_OK(
-            right_hash_key_project_->Evaluate(*in_batch, ctx_->memory_pool(), &outputs));
-        key_array = outputs[0];
+        RETURN_NOT_OK(precompile::HashArrays32(projected_keys_outputs,
+                                               ctx_->memory_pool(), &key_array));
       } else {
         if (right_hash_key_project_) {
           RETURN_NOT_OK(right_hash_key_project_->Evaluate(*in_batch, ctx_->memory_pool(),
@@ -586,10 +609,31 @@ class ConditionedProbeKernel::Impl {
         RETURN_NOT_OK(appender->Reset());
       }
       *out = arrow::RecordBatch::Make(result_schema_, out_length, out_arr_list);
+      if (row_budget_ > 0) {
+        if ((*out)->num_rows() > row_budget_) {
+          *out = (*out)->Slice(0, row_budget_);
+        }
+        row_budget_ -= (*out)->num_rows();
+        if (row_budget_ == 0) ReleaseHashRelation();
+      }
+      return arrow::Status::OK();
+    }
+
+    arrow::Status SetRowBudget(int64_t rows) override {
+      row_budget_ = rows;
+      if (row_budget_ == 0) ReleaseHashRelation();
       return arrow::Status::OK();
     }
 
+    bool BudgetExhausted() override { return row_budget_ == 0; }
+
    private:
+    void ReleaseHashRelation() {
+      probe_func_ = nullptr;
+      appender_list_.clear();
+      hash_relation_ = nullptr;
+    }
+
     class ProbeFunctionBase {
      public:
       virtual uint64_t Evaluate(std::shared_ptr<arrow::Array>) { return 0; }
@@ -643,7 +687,7 @@ class ConditionedProbeKernel::Impl {
               auto typed_first_key_arr = std::make_shared<StringArray>(key_payloads[0]);
               fast_probe = [this, typed_key_array, typed_first_key_arr](int i) {
                 return hash_relation_->Get(typed_key_array->GetView(i),
-                                           typed_first_key_arr->GetString(i));
+                                           typed_first_key_arr->GetView(i));
               };
             } break;
             default: {
@@ -739,7 +783,7 @@ class ConditionedProbeKernel::Impl {
               auto typed_first_key_arr = std::make_shared<StringArray>(key_payloads[0]);
               fast_probe = [this, typed_key_array, typed_first_key_arr](int i) {
                 return hash_relation_->Get(typed_key_array->GetView(i),
-                                           typed_first_key_arr->GetString(i));
+                                           typed_first_key_arr->GetView(i));
               };
             } break;
             default: {
@@ -843,7 +887,7 @@ class ConditionedProbeKernel::Impl {
               auto typed_first_key_arr = std::make_shared<StringArray>(key_payloads[0]);
               fast_probe = [this, typed_key_array, typed_first_key_arr](int i) {
                 return hash_relation_->IfExists(typed_key_array->GetView(i),
-                                                typed_first_key_arr->GetString(i));
+                                                typed_first_key_arr->GetView(i));
               };
             } break;
             default: {
@@ -937,7 +981,7 @@ class ConditionedProbeKernel::Impl {
               auto typed_first_key_arr = std::make_shared<StringArray>(key_payloads[0]);
               fast_probe = [this, typed_key_array, typed_first_key_arr](int i) {
                 return hash_relation_->IfExists(typed_key_array->GetView(i),
-                                                typed_first_key_arr->GetString(i));
+                                                typed_first_key_arr->GetView(i));
               };
             } break;
             default: {
@@ -1034,7 +1078,7 @@ class ConditionedProbeKernel::Impl {
               auto typed_first_key_arr = std::make_shared<StringArray>(key_payloads[0]);
               fast_probe = [this, typed_key_array, typed_first_key_arr](int i) {
                 return hash_relation_->IfExists(typed_key_array->GetView(i),
-                                                typed_first_key_arr->GetString(i));
+                                                typed_first_key_arr->GetView(i));
               };
             } break;
             default: {
@@ -1097,12 +1141,23 @@ class ConditionedProbeKernel::Impl {
             std::dynamic_pointer_cast<TypedHashRelation<DataType>>(hash_relation);
       }
       uint64_t Evaluate(std::shared_ptr<arrow::Array> key_array) override {
+        if (key_array->null_count() == 0) {
+          return EvaluateImpl<false>(key_array);
+        }
+        return EvaluateImpl<true>(key_array);
+      }
+
+     private:
+      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+
+      template <bool kHasNull>
+      uint64_t EvaluateImpl(const std::shared_ptr<arrow::Array>& key_array) {
         auto typed_key_array = std::dynamic_pointer_cast<ArrayType>(key_array);
 
         uint64_t out_length = 0;
         for (int i = 0; i < key_array->length(); i++) {
           int index;
-          if (key_array->IsNull(i)) {
+          if (kHasNull && key_array->IsNull(i)) {
             index = typed_hash_relation_->GetNull();
           } else {
             index = typed_hash_relation_->Get(typed_key_array->GetView(i));
@@ -1124,8 +1179,6 @@ class ConditionedProbeKernel::Impl {
         return out_length;
       }
 
-     private:
-      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
       std::shared_ptr<TypedHashRelation<DataType>> typed_hash_relation_;
       std::vector<std::shared_ptr<AppenderBase>> appender_list_;
     };
@@ -1140,11 +1193,22 @@ class ConditionedProbeKernel::Impl {
             std::dynamic_pointer_cast<TypedHashRelation<DataType>>(hash_relation);
       }
       uint64_t Evaluate(std::shared_ptr<arrow::Array> key_array) override {
+        if (key_array->null_count() == 0) {
+          return EvaluateImpl<false>(key_array);
+        }
+        return EvaluateImpl<true>(key_array);
+      }
+
+     private:
+      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+
+      template <bool kHasNull>
+      uint64_t EvaluateImpl(const std::shared_ptr<arrow::Array>& key_array) {
         auto typed_key_array = std::dynamic_pointer_cast<ArrayType>(key_array);
         uint64_t out_length = 0;
         for (int i = 0; i < key_array->length(); i++) {
           int index;
-          if (key_array->IsNull(i)) {
+          if (kHasNull && key_array->IsNull(i)) {
             index = typed_hash_relation_->GetNull();
           } else {
             index = typed_hash_relation_->Get(typed_key_array->GetView(i));
@@ -1174,8 +1238,6 @@ class ConditionedProbeKernel::Impl {
         return out_length;
       }
 
-     private:
-      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
       std::shared_ptr<TypedHashRelation<DataType>> typed_hash_relation_;
       std::vector<std::shared_ptr<AppenderBase>> appender_list_;
     };
@@ -1190,11 +1252,22 @@ class ConditionedProbeKernel::Impl {
             std::dynamic_pointer_cast<TypedHashRelation<DataType>>(hash_relation);
       }
       uint64_t Evaluate(std::shared_ptr<arrow::Array> key_array) override {
+        if (key_array->null_count() == 0) {
+          return EvaluateImpl<false>(key_array);
+        }
+        return EvaluateImpl<true>(key_array);
+      }
+
+     private:
+      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+
+      template <bool kHasNull>
+      uint64_t EvaluateImpl(const std::shared_ptr<arrow::Array>& key_array) {
         auto typed_key_array = std::dynamic_pointer_cast<ArrayType>(key_array);
         uint64_t out_length = 0;
         for (int i = 0; i < key_array->length(); i++) {
           int index;
-          if (key_array->IsNull(i)) {
+          if (kHasNull && key_array->IsNull(i)) {
             index = typed_hash_relation_->GetNull();
           } else {
             index = typed_hash_relation_->Get(typed_key_array->GetView(i));
@@ -1213,8 +1286,6 @@ class ConditionedProbeKernel::Impl {
         return out_length;
       }
 
-     private:
-      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
       std::shared_ptr<TypedHashRelation<DataType>> typed_hash_relation_;
       std::vector<std::shared_ptr<AppenderBase>> appender_list_;
     };
@@ -1229,11 +1300,22 @@ class ConditionedProbeKernel::Impl {
             std::dynamic_pointer_cast<TypedHashRelation<DataType>>(hash_relation);
       }
       uint64_t Evaluate(std::shared_ptr<arrow::Array> key_array) override {
+        if (key_array->null_count() == 0) {
+          return EvaluateImpl<false>(key_array);
+        }
+        return EvaluateImpl<true>(key_array);
+      }
+
+     private:
+      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+
+      template <bool kHasNull>
+      uint64_t EvaluateImpl(const std::shared_ptr<arrow::Array>& key_array) {
         auto typed_key_array = std::dynamic_pointer_cast<ArrayType>(key_array);
         uint64_t out_length = 0;
         for (int i = 0; i < key_array->length(); i++) {
           int index;
-          if (key_array->IsNull(i)) {
+          if (kHasNull && key_array->IsNull(i)) {
             index = typed_hash_relation_->GetNull();
           } else {
             index = typed_hash_relation_->Get(typed_key_array->GetView(i));
@@ -1253,8 +1335,6 @@ class ConditionedProbeKernel::Impl {
         return out_length;
       }
 
-     private:
-      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
       std::shared_ptr<TypedHashRelation<DataType>> typed_hash_relation_;
       std::vector<std::shared_ptr<AppenderBase>> appender_list_;
     };
@@ -1269,11 +1349,22 @@ class ConditionedProbeKernel::Impl {
             std::dynamic_pointer_cast<TypedHashRelation<DataType>>(hash_relation);
       }
       uint64_t Evaluate(std::shared_ptr<arrow::Array> key_array) override {
+        if (key_array->null_count() == 0) {
+          return EvaluateImpl<false>(key_array);
+        }
+        return EvaluateImpl<true>(key_array);
+      }
+
+     private:
+      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
+
+      template <bool kHasNull>
+      uint64_t EvaluateImpl(const std::shared_ptr<arrow::Array>& key_array) {
         auto typed_key_array = std::dynamic_pointer_cast<ArrayType>(key_array);
         uint64_t out_length = 0;
         for (int i = 0; i < key_array->length(); i++) {
           int index;
-          if (key_array->IsNull(i)) {
+          if (kHasNull && key_array->IsNull(i)) {
             index = typed_hash_relation_->GetNull();
           } else {
             index = typed_hash_relation_->Get(typed_key_array->GetView(i));
@@ -1296,8 +1387,6 @@ class ConditionedProbeKernel::Impl {
         return out_length;
       }
 
-     private:
-      using ArrayType = typename arrow::TypeTraits<DataType>::ArrayType;
       std::shared_ptr<TypedHashRelation<DataType>> typed_hash_relation_;
       std::vector<std::shared_ptr<AppenderBase>> appender_list_;
     };
@@ -1320,8 +1409,9 @@ class ConditionedProbeKernel::Impl {
 
     gandiva::FieldVector left_field_list_;
     gandiva::FieldVector right_field_list_;
-    gandiva::FieldVector right_projected_field_list_;
     std::shared_ptr<ProbeFunctionBase> probe_func_;
+    // rows a downstream LIMIT still takes, -1 for no limit
+    int64_t row_budget_ = -1;
   };
 
   arrow::Status GetInnerJoin(const std::vector<std::string> input, bool cond_check,
@@ -1523,6 +1613,7 @@ class ConditionedProbeKernel::Impl {
         "hash_relation_list_" + std::to_string(hash_relation_id_) + "_";
     auto index_name = "hash_relation_" + std::to_string(hash_relation_id_) + "_index";
     std::vector<std::vector<std::string>> output_name_list = {{}, {}};
+    std::vector<std::vector<std::string>> output_validity_list = {{}, {}};
     std::stringstream valid_ss;
     for (int i = 0; i < left_field_list_.size(); i++) {
       auto type = left_field_list_[i]->type();
@@ -1539,19 +1630,24 @@ class ConditionedProbeKernel::Impl {
       valid_ss << "}" << std::endl;
 
       output_name_list[0].push_back(output_name);
+      output_validity_list[0].push_back(output_validity);
     }
     for (int i = 0; i < right_field_list_.size(); i++) {
       if (exist_index_ != -1 && exist_index_ == i) {
         auto exist_name =
             "hash_relation_" + std::to_string(hash_relation_id_) + "_existence_value";
         output_name_list[1].push_back(exist_name);
+        output_validity_list[1].push_back(exist_name + "_validity");
       }
       output_name_list[1].push_back(input[i]);
+      output_validity_list[1].push_back((*output)->null_free ? "true"
+                                                             : input[i] + "_validity");
     }
     if (exist_index_ != -1 && exist_index_ == right_field_list_.size()) {
       auto exist_name =
           "hash_relation_" + std::to_string(hash_relation_id_) + "_existence_value";
       output_name_list[1].push_back(exist_name);
+      output_validity_list[1].push_back(exist_name + "_validity");
     }
 
     int output_idx = 0;
@@ -1561,8 +1657,8 @@ class ConditionedProbeKernel::Impl {
       auto name = (*output)->output_list[output_idx++].first;
       ss << name << " = " << output_name_list[pair.first][pair.second] << ";"
          << std::endl;
-      ss << name << "_validity = " << output_name_list[pair.first][pair.second]
-         << "_validity;" << std::endl;
+      ss << name << "_validity = " << output_validity_list[pair.first][pair.second]
+         << ";" << std::endl;
     }
     valid_ss << ss.str();
 
@@ -0,0 +1,352 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/compute/context.h>
+#include <arrow/record_batch.h>
+#include <arrow/scalar.h>
+#include <arrow/status.h>
+#include <arrow/type.h>
+#include <gandiva/configuration.h>
+#include <gandiva/node.h>
+#include <gandiva/projector.h>
+
+#include <deque>
+#include <iostream>
+
+#include "codegen/arrow_compute/ext/codegen_common.h"
+#include "codegen/arrow_compute/ext/expression_codegen_visitor.h"
+#include "codegen/arrow_compute/ext/kernels_ext.h"
+#include "utils/gandiva_registry.h"
+#include "utils/macros.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+using ArrayList = std::vector<std::shared_ptr<arrow::Array>>;
+
+///////////////  Expand  ////////////////
+// How one output column of a projection is produced. Spark's grouping sets only
+// reference input columns, nulls and the grouping id literal, anything else goes
+// through a gandiva projector.
+struct ExpandColumn {
+  std::shared_ptr<arrow::DataType> type;
+  // the input column passed through by reference
+  int input_index = -1;
+  // a literal repeated for every row, nullptr scalar for a null literal
+  bool is_constant = false;
+  std::shared_ptr<arrow::Scalar> scalar;
+  // the constant column of the longest batch seen, shorter batches take a slice
+  std::shared_ptr<arrow::Array> cached;
+  // output index of the projector of this projection
+  int projected_index = -1;
+};
+
+static bool MakeLiteralScalar(const gandiva::LiteralNode& node,
+                              std::shared_ptr<arrow::Scalar>* out) {
+  auto& holder = node.holder();
+  switch (node.return_type()->id()) {
+#define PROCESS(InType, CType)                                  \
+  case InType::type_id: {                                       \
+    *out = arrow::MakeScalar(arrow::util::get<CType>(holder));  \
+    return true;                                                \
+  }
+    PROCESS(arrow::BooleanType, bool)
+    PROCESS(arrow::UInt8Type, uint8_t)
+    PROCESS(arrow::Int8Type, int8_t)
+    PROCESS(arrow::UInt16Type, uint16_t)
+    PROCESS(arrow::Int16Type, int16_t)
+    PROCESS(arrow::UInt32Type, uint32_t)
+    PROCESS(arrow::Int32Type, int32_t)
+    PROCESS(arrow::UInt64Type, uint64_t)
+    PROCESS(arrow::Int64Type, int64_t)
+    PROCESS(arrow::FloatType, float)
+    PROCESS(arrow::DoubleType, double)
+#undef PROCESS
+    default:
+      return false;
+  }
+}
+
+class ExpandKernel::Impl {
+ public:
+  Impl(arrow::compute::FunctionContext* ctx,
+       const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+       const std::vector<gandiva::NodeVector>& projection_list)
+      : ctx_(ctx),
+        input_field_list_(input_field_list),
+        projection_list_(projection_list) {
+    auto input_schema = arrow::schema(input_field_list_);
+    for (auto& projection : projection_list_) {
+      std::vector<ExpandColumn> column_list;
+      gandiva::ExpressionVector expr_list;
+      for (auto& node : projection) {
+        ExpandColumn column;
+        column.type = node->return_type();
+        auto field_node = std::dynamic_pointer_cast<gandiva::FieldNode>(node);
+        auto literal_node = std::dynamic_pointer_cast<gandiva::LiteralNode>(node);
+        if (field_node != nullptr) {
+          column.input_index = input_schema->GetFieldIndex(field_node->field()->name());
+        }
+        if (column.input_index < 0) {
+          if (literal_node != nullptr &&
+              (literal_node->is_null() ||
+               MakeLiteralScalar(*literal_node, &column.scalar))) {
+            column.is_constant = true;
+          } else {
+            column.projected_index = expr_list.size();
+            expr_list.push_back(gandiva::TreeExprBuilder::MakeExpression(
+                node, arrow::field("expand_" + std::to_string(expr_list.size()),
+                                   column.type)));
+          }
+        }
+        column_list.push_back(column);
+      }
+      std::shared_ptr<gandiva::Projector> projector;
+      if (!expr_list.empty()) {
+        auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
+        THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(input_schema, expr_list,
+                                                           configuration, &projector));
+      }
+      column_list_v_.push_back(column_list);
+      projector_list_.push_back(projector);
+    }
+    ready_list_ = std::make_shared<std::deque<ArrayList>>();
+  }
+
+  // Queues one output batch per projection. Passed through columns and constant
+  // columns share their buffers, only projected expressions allocate.
+  arrow::Status Evaluate(const ArrayList& in) {
+    if (in.empty() || in[0]->length() == 0) {
+      return arrow::Status::OK();
+    }
+    auto length = in[0]->length();
+    std::shared_ptr<arrow::RecordBatch> in_batch;
+    for (int i = 0; i < projection_list_.size(); i++) {
+      arrow::ArrayVector projected;
+      if (projector_list_[i] != nullptr) {
+        if (in_batch == nullptr) {
+          in_batch =
+              arrow::RecordBatch::Make(arrow::schema(input_field_list_), length, in);
+        }
+        RETURN_NOT_OK(
+            projector_list_[i]->Evaluate(*in_batch, ctx_->memory_pool(), &projected));
+      }
+      ArrayList out;
+      for (auto& column : column_list_v_[i]) {
+        if (column.input_index >= 0) {
+          out.push_back(in[column.input_index]);
+        } else if (column.is_constant) {
+          std::shared_ptr<arrow::Array> constant;
+          RETURN_NOT_OK(GetConstantArray(&column, length, &constant));
+          out.push_back(constant);
+        } else {
+          out.push_back(projected[column.projected_index]);
+        }
+      }
+      ready_list_->push_back(out);
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::Status MakeResultIterator(
+      std::shared_ptr<arrow::Schema> schema,
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+    *out = std::make_shared<ExpandResultIterator>(schema, ready_list_);
+    return arrow::Status::OK();
+  }
+
+  std::string GetSignature() { return signature_; }
+
+  // One input row loops over the projections, the kernels after expand see each
+  // projected row in turn. The loop is closed after they materialize the row.
+  arrow::Status DoCodeGen(int level, const std::vector<std::string> input,
+                          std::shared_ptr<CodeGenContext>* codegen_ctx_out, int* var_id) {
+    auto codegen_ctx =
+        *codegen_ctx_out ? *codegen_ctx_out : std::make_shared<CodeGenContext>();
+    auto expand_id = "expand_" + std::to_string(level) + "_id";
+    std::stringstream process_ss;
+    std::stringstream define_ss;
+    std::vector<std::string> output_list;
+    for (int k = 0; k < projection_list_[0].size(); k++) {
+      auto output_name =
+          "expand_" + std::to_string(level) + "_output_col_" + std::to_string(k);
+      auto type = projection_list_[0][k]->return_type();
+      output_list.push_back(output_name);
+      codegen_ctx->output_list.push_back(std::make_pair(output_name, type));
+      define_ss << GetCTypeString(type) << " " << output_name << ";" << std::endl;
+      define_ss << "bool " << output_name << "_validity;" << std::endl;
+    }
+    process_ss << "for (int " << expand_id << " = 0; " << expand_id << " < "
+               << projection_list_.size() << "; " << expand_id << "++) {" << std::endl;
+    process_ss << "switch (" << expand_id << ") {" << std::endl;
+    for (int i = 0; i < projection_list_.size(); i++) {
+      process_ss << "case " << i << ": {" << std::endl;
+      // every case is its own scope
+      std::vector<std::string> prepared_list;
+      for (int k = 0; k < projection_list_[i].size(); k++) {
+        std::shared_ptr<ExpressionCodegenVisitor> visitor;
+        RETURN_NOT_OK(MakeExpressionCodegenVisitor(
+            projection_list_[i][k], input, {input_field_list_}, -1, var_id,
+            &prepared_list, &visitor, true, codegen_ctx->null_free));
+        codegen_ctx->batch_prepare_codes += visitor->GetBatchPrepare();
+        for (auto header : visitor->GetHeaders()) {
+          if (std::find(codegen_ctx->header_codes.begin(),
+                        codegen_ctx->header_codes.end(),
+                        header) == codegen_ctx->header_codes.end()) {
+            codegen_ctx->header_codes.push_back(header);
+          }
+        }
+        process_ss << visitor->GetPrepare();
+        // the cases are scopes of their own, the outputs own their strings
+        if (projection_list_[i][k]->return_type()->id() == arrow::Type::STRING) {
+          process_ss << output_list[k] << " = std::string(" << visitor->GetResult()
+                     << ");" << std::endl;
+        } else {
+          process_ss << output_list[k] << " = " << visitor->GetResult() << ";"
+                     << std::endl;
+        }
+        process_ss << output_list[k] << "_validity = " << visitor->GetPreCheck() << ";"
+                   << std::endl;
+      }
+      process_ss << "} break;" << std::endl;
+    }
+    process_ss << "}" << std::endl;
+    codegen_ctx->process_codes += process_ss.str();
+    codegen_ctx->definition_codes += define_ss.str();
+    codegen_ctx->finish_codes += "} // end of Expand\n";
+    *codegen_ctx_out = codegen_ctx;
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::compute::FunctionContext* ctx_;
+  std::string signature_;
+  std::vector<std::shared_ptr<arrow::Field>> input_field_list_;
+  std::vector<gandiva::NodeVector> projection_list_;
+  std::vector<std::vector<ExpandColumn>> column_list_v_;
+  std::vector<std::shared_ptr<gandiva::Projector>> projector_list_;
+  std::shared_ptr<std::deque<ArrayList>> ready_list_;
+
+  arrow::Status GetConstantArray(ExpandColumn* column, int64_t length,
+                                 std::shared_ptr<arrow::Array>* out) {
+    if (column->cached == nullptr || column->cached->length() < length) {
+      if (column->scalar == nullptr) {
+        RETURN_NOT_OK(arrow::MakeArrayOfNull(ctx_->memory_pool(), column->type, length,
+                                             &column->cached));
+      } else {
+        RETURN_NOT_OK(arrow::MakeArrayFromScalar(ctx_->memory_pool(), *column->scalar,
+                                                 length, &column->cached));
+      }
+    }
+    *out = column->cached->length() == length ? column->cached
+                                              : column->cached->Slice(0, length);
+    return arrow::Status::OK();
+  }
+
+  class ExpandResultIterator : public ResultIterator<arrow::RecordBatch> {
+   public:
+    ExpandResultIterator(std::shared_ptr<arrow::Schema> result_schema,
+                         std::shared_ptr<std::deque<ArrayList>> ready_list)
+        : result_schema_(result_schema), ready_list_(ready_list) {}
+
+    std::string ToString() override { return "ExpandResultIterator"; }
+
+    bool HasNext() override { return !ready_list_->empty(); }
+
+    arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) override {
+      if (ready_list_->empty()) {
+        return arrow::Status::Invalid(
+            "ExpandResultIterator Next is called without input.");
+      }
+      auto arr_list = ready_list_->front();
+      ready_list_->pop_front();
+      *out = arrow::RecordBatch::Make(result_schema_, arr_list[0]->length(), arr_list);
+      return arrow::Status::OK();
+    }
+
+   private:
+    std::shared_ptr<arrow::Schema> result_schema_;
+    std::shared_ptr<std::deque<ArrayList>> ready_list_;
+  };
+};
+
+arrow::Status ExpandKernel::Make(
+    arrow::compute::FunctionContext* ctx,
+    const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+    std::shared_ptr<gandiva::Node> root_node,
+    const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
+    std::shared_ptr<KernalBase>* out) {
+  // Expand(projection(<expressions>), projection(<expressions>), ...)
+  std::vector<gandiva::NodeVector> projection_list;
+  auto func_node = std::dynamic_pointer_cast<gandiva::FunctionNode>(root_node);
+  for (auto child : func_node->children()) {
+    auto projection = std::dynamic_pointer_cast<gandiva::FunctionNode>(child);
+    if (projection == nullptr ||
+        projection->children().size() != output_field_list.size()) {
+      return arrow::Status::Invalid("Expand expects projections of ",
+                                    output_field_list.size(), " expressions.");
+    }
+    projection_list.push_back(projection->children());
+  }
+  *out = std::make_shared<ExpandKernel>(ctx, input_field_list, projection_list);
+  return arrow::Status::OK();
+}
+
+arrow::Status ExpandKernel::Make(arrow::compute::FunctionContext* ctx,
+                                 const gandiva::NodeVector& input_field_node_list,
+                                 const std::vector<gandiva::NodeVector>& projection_list,
+                                 std::shared_ptr<KernalBase>* out) {
+  std::vector<std::shared_ptr<arrow::Field>> input_field_list;
+  for (auto node : input_field_node_list) {
+    auto field_node = std::dynamic_pointer_cast<gandiva::FieldNode>(node);
+    input_field_list.push_back(field_node->field());
+  }
+  *out = std::make_shared<ExpandKernel>(ctx, input_field_list, projection_list);
+  return arrow::Status::OK();
+}
+
+ExpandKernel::ExpandKernel(
+    arrow::compute::FunctionContext* ctx,
+    const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+    const std::vector<gandiva::NodeVector>& projection_list) {
+  impl_.reset(new Impl(ctx, input_field_list, projection_list));
+  kernel_name_ = "ExpandKernel";
+}
+
+arrow::Status ExpandKernel::Evaluate(const ArrayList& in) { return impl_->Evaluate(in); }
+
+arrow::Status ExpandKernel::MakeResultIterator(
+    std::shared_ptr<arrow::Schema> schema,
+    std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+  return impl_->MakeResultIterator(schema, out);
+}
+
+std::string ExpandKernel::GetSignature() { return impl_->GetSignature(); }
+
+arrow::Status ExpandKernel::DoCodeGen(int level, std::vector<std::string> input,
+                                      std::shared_ptr<CodeGenContext>* codegen_ctx,
+                                      int* var_id) {
+  return impl_->DoCodeGen(level, input, codegen_ctx, var_id);
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -17,20 +17,228 @@
 
 #include "codegen/arrow_compute/ext/expression_codegen_visitor.h"
 
+#include <arrow/type_traits.h>
 #include <gandiva/decimal_scalar.h>
 #include <gandiva/node.h>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
 
 #include "codegen/arrow_compute/ext/codegen_common.h"
+#include "precompile/string_predicates.h"
 
 namespace sparkcolumnarplugin {
 namespace codegen {
 namespace arrowcompute {
 namespace extra {
+// Escapes a string into a C++ string literal for the generated codes.
+static std::string GetCStringLiteral(const std::string& value) {
+  std::stringstream ss;
+  ss << "std::string(\"";
+  for (unsigned char c : value) {
+    if (c == '\\' || c == '"') {
+      ss << '\\' << c;
+    } else if (c < 0x20 || c >= 0x7F) {
+      // always three octal digits, so a following digit is not taken in
+      ss << '\\' << static_cast<char>('0' + (c >> 6))
+         << static_cast<char>('0' + ((c >> 3) & 7)) << static_cast<char>('0' + (c & 7));
+    } else {
+      ss << c;
+    }
+  }
+  ss << "\", " << value.size() << ")";
+  return ss.str();
+}
+
+// Prints an integer literal which keeps its value as int64_t, including INT64_MIN.
+static std::string GetIntegerLiteral(int64_t value) {
+  if (value == std::numeric_limits<int64_t>::min()) {
+    return "std::numeric_limits<int64_t>::min()";
+  }
+  return std::to_string(value) + "LL";
+}
+
+// Kernel of precompile/date_time.h computing a gandiva function of a date64 from its
+// days, empty for other functions.
+static std::string GetDateKernel(const std::string& func_name) {
+  static const std::unordered_map<std::string, std::string> kernels = {
+      {"extractYear", "ExtractYear"},         {"extractMonth", "ExtractMonth"},
+      {"extractDay", "ExtractDayOfMonth"},    {"extractQuarter", "ExtractQuarter"},
+      {"extractDow", "ExtractDayOfWeek"},     {"extractDoy", "ExtractDayOfYear"},
+      {"date_trunc_Year", "TruncYear"},       {"date_trunc_Quarter", "TruncQuarter"},
+      {"date_trunc_Month", "TruncMonth"},     {"date_trunc_Week", "TruncWeek"}};
+  auto it = kernels.find(func_name);
+  return it == kernels.end() ? "" : it->second;
+}
+
+// Whole array version of the kernel of GetDateKernel, run once per batch.
+static std::string GetDateArrayKernel(const std::string& func_name) {
+  static const std::unordered_map<std::string, std::string> kernels = {
+      {"extractYear", "ExtractYears"},        {"extractMonth", "ExtractMonths"},
+      {"extractDay", "ExtractDaysOfMonth"},   {"extractQuarter", "ExtractQuarters"},
+      {"extractDow", "ExtractDaysOfWeek"},    {"extractDoy", "ExtractDaysOfYear"},
+      {"date_trunc_Year", "TruncYears"},      {"date_trunc_Quarter", "TruncQuarters"},
+      {"date_trunc_Month", "TruncMonths"},    {"date_trunc_Week", "TruncWeeks"}};
+  auto it = kernels.find(func_name);
+  return it == kernels.end() ? "" : it->second;
+}
+
+// Reads a non null integer literal, false for any other node.
+static bool GetIntegerLiteralValue(const gandiva::Node& node, int64_t* out) {
+  auto literal = dynamic_cast<const gandiva::LiteralNode*>(&node);
+  if (literal == nullptr || literal->is_null()) {
+    return false;
+  }
+  auto& holder = literal->holder();
+  switch (literal->return_type()->id()) {
+    case arrow::Int8Type::type_id:
+      *out = arrow::util::get<int8_t>(holder);
+      return true;
+    case arrow::Int16Type::type_id:
+      *out = arrow::util::get<int16_t>(holder);
+      return true;
+    case arrow::Int32Type::type_id:
+      *out = arrow::util::get<int32_t>(holder);
+      return true;
+    case arrow::Int64Type::type_id:
+      *out = arrow::util::get<int64_t>(holder);
+      return true;
+    case arrow::UInt8Type::type_id:
+      *out = arrow::util::get<uint8_t>(holder);
+      return true;
+    case arrow::UInt16Type::type_id:
+      *out = arrow::util::get<uint16_t>(holder);
+      return true;
+    case arrow::UInt32Type::type_id:
+      *out = arrow::util::get<uint32_t>(holder);
+      return true;
+    case arrow::UInt64Type::type_id: {
+      auto value = arrow::util::get<uint64_t>(holder);
+      *out = static_cast<int64_t>(value);
+      return value <= std::numeric_limits<int64_t>::max();
+    }
+    default:
+      return false;
+  }
+}
+
+static bool GetIntegerLiteralValue(gandiva::NodePtr node, int64_t* out) {
+  return node != nullptr && GetIntegerLiteralValue(*node, out);
+}
+
+// CASE with fewer arms is as fast as a chain of compares, and a wider key range
+// makes the table too sparse to stay in cache.
+const size_t kMinLookupTableArms = 4;
+const uint64_t kMaxLookupTableSpan = 256;
+
+static bool GetLookupTableArms(
+    const gandiva::IfNode& node, std::shared_ptr<gandiva::FieldNode>* key_node,
+    std::vector<std::pair<int64_t, gandiva::NodePtr>>* arms,
+    gandiva::NodePtr* else_node) {
+  // CASE key WHEN literal THEN literal ... ELSE literal END, as nested ifs of
+  // equal(key, literal) conditions
+  const gandiva::IfNode* cur = &node;
+  while (true) {
+    auto condition = std::dynamic_pointer_cast<gandiva::FunctionNode>(cur->condition());
+    if (condition == nullptr || condition->descriptor()->name() != "equal" ||
+        std::dynamic_pointer_cast<gandiva::LiteralNode>(cur->then_node()) == nullptr) {
+      return false;
+    }
+    auto field = std::dynamic_pointer_cast<gandiva::FieldNode>(condition->children()[0]);
+    auto literal = condition->children()[1];
+    if (field == nullptr) {
+      field = std::dynamic_pointer_cast<gandiva::FieldNode>(condition->children()[1]);
+      literal = condition->children()[0];
+    }
+    int64_t key;
+    if (field == nullptr || !arrow::is_integer(field->return_type()->id()) ||
+        !GetIntegerLiteralValue(literal, &key)) {
+      return false;
+    }
+    if (*key_node == nullptr) {
+      *key_node = field;
+    } else if ((*key_node)->field()->name() != field->field()->name()) {
+      return false;
+    }
+    // unsigned keys are compared against the table range as unsigned
+    auto key_type = field->return_type()->id();
+    if (key < 0 && (key_type == arrow::Type::UINT8 || key_type == arrow::Type::UINT16 ||
+                    key_type == arrow::Type::UINT32 || key_type == arrow::Type::UINT64)) {
+      return false;
+    }
+    arms->emplace_back(key, cur->then_node());
+    auto next = std::dynamic_pointer_cast<gandiva::IfNode>(cur->else_node());
+    if (next == nullptr) {
+      break;
+    }
+    cur = next.get();
+  }
+  *else_node = cur->else_node();
+  if (std::dynamic_pointer_cast<gandiva::LiteralNode>(*else_node) == nullptr ||
+      arms->size() < kMinLookupTableArms) {
+    return false;
+  }
+  auto min_key = (*arms)[0].first;
+  auto max_key = (*arms)[0].first;
+  for (auto& arm : *arms) {
+    min_key = std::min(min_key, arm.first);
+    max_key = std::max(max_key, arm.first);
+  }
+  // the span is exact in unsigned arithmetic, even for keys far apart
+  return static_cast<uint64_t>(max_key) - static_cast<uint64_t>(min_key) <
+         kMaxLookupTableSpan;
+}
+
+// A step function of a signed integer key, e.g. the offsets of a region time zone,
+// as a search of nested if(less_than(key, bound), below, above) with the same key and
+// integer literal leaves. Read left to right the bounds have to increase, the leaf a
+// key reaches is then the one after the bounds not above it.
+static bool GetStepTableArms(const gandiva::Node& node, gandiva::NodePtr* key_node,
+                             std::vector<int64_t>* bounds, std::vector<int64_t>* values) {
+  auto if_node = dynamic_cast<const gandiva::IfNode*>(&node);
+  if (if_node == nullptr) {
+    int64_t value;
+    if (!GetIntegerLiteralValue(node, &value)) {
+      return false;
+    }
+    values->push_back(value);
+    return true;
+  }
+  auto condition = std::dynamic_pointer_cast<gandiva::FunctionNode>(if_node->condition());
+  int64_t bound;
+  if (condition == nullptr || condition->descriptor()->name() != "less_than" ||
+      !GetIntegerLiteralValue(condition->children()[1], &bound)) {
+    return false;
+  }
+  auto key = condition->children()[0];
+  switch (key->return_type()->id()) {
+    case arrow::Type::INT8:
+    case arrow::Type::INT16:
+    case arrow::Type::INT32:
+    case arrow::Type::INT64:
+      break;
+    default:
+      return false;
+  }
+  if (*key_node == nullptr) {
+    *key_node = key;
+  } else if (key->ToString() != (*key_node)->ToString()) {
+    return false;
+  }
+  if (!GetStepTableArms(*if_node->then_node(), key_node, bounds, values) ||
+      (!bounds->empty() && bounds->back() >= bound)) {
+    return false;
+  }
+  bounds->push_back(bound);
+  return GetStepTableArms(*if_node->else_node(), key_node, bounds, values);
+}
+
 std::string ExpressionCodegenVisitor::GetInput() { return input_codes_str_; }
 std::string ExpressionCodegenVisitor::GetResult() { return codes_str_; }
 std::string ExpressionCodegenVisitor::GetPrepare() { return prepare_str_; }
+std::string ExpressionCodegenVisitor::GetBatchPrepare() { return batch_prepare_str_; }
 std::string ExpressionCodegenVisitor::GetPreCheck() { return check_str_; }
 std::string ExpressionCodegenVisitor::GetRealResult() { return real_codes_str_; }
 std::string ExpressionCodegenVisitor::GetRealValidity() { return real_validity_str_; }
@@ -51,8 +259,10 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
 
     RETURN_NOT_OK(MakeExpressionCodegenVisitor(child, input_list, field_list_v_,
                                                hash_relation_id_, func_count_,
-                                               prepared_list_, &child_visitor));
+                                               prepared_list_, &child_visitor,
+                                               batch_codegen_, null_free_));
     child_visitor_list.push_back(child_visitor);
+    batch_prepare_str_ += child_visitor->GetBatchPrepare();
     if (field_type_ == unknown || field_type_ == literal) {
       field_type_ = child_visitor->GetFieldType();
     } else if (field_type_ != child_visitor->GetFieldType() && field_type_ != literal &&
@@ -158,55 +368,159 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     prepare_ss << "bool " << check_str_ << " = true;" << std::endl;
     prepare_str_ += prepare_ss.str();
   } else if (func_name.compare("substr") == 0) {
-    ss << child_visitor_list[0]->GetResult() << ".substr("
-       << "((" << child_visitor_list[1]->GetResult() << " - 1) < 0 ? 0 : ("
-       << child_visitor_list[1]->GetResult() << " - 1)), "
-       << child_visitor_list[2]->GetResult() << ")";
-    check_str_ = child_visitor_list[0]->GetPreCheck();
     for (int i = 0; i < 3; i++) {
       prepare_str_ += child_visitor_list[i]->GetPrepare();
     }
-    // codes_str_ = ss.str();
     codes_str_ = "substr_" + std::to_string(cur_func_id);
     check_str_ = GetValidityName(codes_str_);
-    std::stringstream prepare_ss;
-    prepare_ss << "auto " << codes_str_ << " = " << ss.str() << ";" << std::endl;
-    prepare_ss << "bool " << check_str_ << " = true;" << std::endl;
-    prepare_str_ += prepare_ss.str();
-  } else if (func_name.compare("upper") == 0) {
-    std::stringstream prepare_ss;
     auto child_name = child_visitor_list[0]->GetResult();
-    codes_str_ = "upper_" + std::to_string(cur_func_id);
-    check_str_ = codes_str_ + "_validity";
-    prepare_ss << "std::string " << codes_str_ << ";" << std::endl;
-    prepare_ss << codes_str_ << ".resize(" << child_name << ".size());" << std::endl;
+    auto pos = child_visitor_list[1]->GetResult();
+    auto len = child_visitor_list[2]->GetResult();
+    std::string child_array;
+    bool is_batch = GetBatchInputArray(child_visitor_list[0], &child_array) &&
+                    child_visitor_list[1]->GetFieldType() == literal &&
+                    child_visitor_list[2]->GetFieldType() == literal;
+    std::stringstream prepare_ss;
+    // the rows of the batch output are viewed in place, not copied per row
+    prepare_ss << (is_batch ? "arrow::util::string_view " : "std::string ") << codes_str_
+               << ";" << std::endl;
     prepare_ss << "bool " << check_str_ << " = " << child_visitor_list[0]->GetPreCheck()
                << ";" << std::endl;
     prepare_ss << "if (" << check_str_ << ") {" << std::endl;
-    prepare_ss << "std::transform(" << child_name << ".begin(), " << child_name
-               << ".end(), " << codes_str_ << ".begin(), ::toupper);" << std::endl;
+    if (is_batch) {
+      std::stringstream batch_prepare_ss;
+      batch_prepare_ss << "std::shared_ptr<arrow::Array> " << codes_str_ << "_out;"
+                       << std::endl;
+      batch_prepare_ss << "RETURN_NOT_OK(sparkcolumnarplugin::precompile::"
+                       << "SubstrStringArray(ctx_->memory_pool(), " << child_array
+                       << "->cache_, " << pos << ", " << len << ", &" << codes_str_
+                       << "_out));" << std::endl;
+      batch_prepare_ss << "auto " << codes_str_
+                       << "_array = std::make_shared<StringArray>(" << codes_str_
+                       << "_out);" << std::endl;
+      batch_prepare_str_ += batch_prepare_ss.str();
+      prepare_ss << codes_str_ << " = " << codes_str_ << "_array->GetView(i);"
+                 << std::endl;
+    } else {
+      prepare_ss << codes_str_ << " = sparkcolumnarplugin::precompile::Utf8Substr("
+                 << child_name << ", " << pos << ", " << len << ");" << std::endl;
+    }
     prepare_ss << "}" << std::endl;
+    prepare_str_ += prepare_ss.str();
+    header_list_.push_back(R"(#include "precompile/string_kernels.h")");
+  } else if (func_name.compare("upper") == 0 || func_name.compare("lower") == 0) {
+    bool is_upper = func_name.compare("upper") == 0;
     for (int i = 0; i < 1; i++) {
       prepare_str_ += child_visitor_list[i]->GetPrepare();
     }
-    prepare_str_ += prepare_ss.str();
-  } else if (func_name.compare("lower") == 0) {
-    std::stringstream prepare_ss;
     auto child_name = child_visitor_list[0]->GetResult();
-    codes_str_ = "lower_" + std::to_string(cur_func_id);
+    codes_str_ = func_name + "_" + std::to_string(cur_func_id);
     check_str_ = codes_str_ + "_validity";
-    prepare_ss << "std::string " << codes_str_ << ";" << std::endl;
-    prepare_ss << codes_str_ << ".resize(" << child_name << ".size());" << std::endl;
+    std::string child_array;
+    bool is_batch = GetBatchInputArray(child_visitor_list[0], &child_array);
+    std::stringstream prepare_ss;
+    prepare_ss << (is_batch ? "arrow::util::string_view " : "std::string ") << codes_str_
+               << ";" << std::endl;
     prepare_ss << "bool " << check_str_ << " = " << child_visitor_list[0]->GetPreCheck()
                << ";" << std::endl;
     prepare_ss << "if (" << check_str_ << ") {" << std::endl;
-    prepare_ss << "std::transform(" << child_name << ".begin(), " << child_name
-               << ".end(), " << codes_str_ << ".begin(), ::tolower);" << std::endl;
+    if (is_batch) {
+      // convert the whole input column once per batch
+      std::stringstream batch_prepare_ss;
+      batch_prepare_ss << "std::shared_ptr<arrow::Array> " << codes_str_ << "_out;"
+                       << std::endl;
+      batch_prepare_ss << "RETURN_NOT_OK(sparkcolumnarplugin::precompile::"
+                       << (is_upper ? "UpperStringArray" : "LowerStringArray")
+                       << "(ctx_->memory_pool(), " << child_array << "->cache_, &"
+                       << codes_str_ << "_out));" << std::endl;
+      batch_prepare_ss << "auto " << codes_str_
+                       << "_array = std::make_shared<StringArray>(" << codes_str_
+                       << "_out);" << std::endl;
+      batch_prepare_str_ += batch_prepare_ss.str();
+      prepare_ss << codes_str_ << " = " << codes_str_ << "_array->GetView(i);"
+                 << std::endl;
+    } else {
+      prepare_ss << codes_str_ << " = sparkcolumnarplugin::precompile::"
+                 << (is_upper ? "Utf8Upper" : "Utf8Lower") << "(" << child_name << ");"
+                 << std::endl;
+    }
     prepare_ss << "}" << std::endl;
-    for (int i = 0; i < 1; i++) {
+    prepare_str_ += prepare_ss.str();
+    header_list_.push_back(R"(#include "precompile/string_kernels.h")");
+  } else if (func_name.compare("starts_with") == 0 ||
+             func_name.compare("ends_with") == 0 ||
+             func_name.compare("is_substr") == 0 || func_name.compare("like") == 0 ||
+             func_name.compare("rlike") == 0) {
+    for (int i = 0; i < 2; i++) {
       prepare_str_ += child_visitor_list[i]->GetPrepare();
     }
+    auto child_name = child_visitor_list[0]->GetResult();
+    codes_str_ = func_name + "_" + std::to_string(cur_func_id);
+    check_str_ = GetValidityName(codes_str_);
+    auto matcher_name = codes_str_ + "_matcher";
+    std::string matcher_codes;
+    auto pattern_node =
+        std::dynamic_pointer_cast<gandiva::LiteralNode>(node.children()[1]);
+    bool is_pattern_match =
+        func_name.compare("like") == 0 || func_name.compare("rlike") == 0;
+    if (pattern_node != nullptr && !pattern_node->is_null()) {
+      // a literal pattern is classified and compiled once, when the kernel runs first,
+      // so it is checked here: the jitted code can't report a bad one
+      auto pattern = arrow::util::get<std::string>(pattern_node->holder());
+      RETURN_NOT_OK(precompile::StringMatcher::Validate(func_name, pattern));
+      std::stringstream matcher_ss;
+      matcher_ss << "static const auto " << matcher_name
+                 << " = sparkcolumnarplugin::precompile::StringMatcher::GetOrMake(\""
+                 << func_name << "\", " << GetCStringLiteral(pattern) << ");" << std::endl;
+      matcher_codes = matcher_ss.str();
+    } else if (pattern_node == nullptr && is_pattern_match) {
+      // a LIKE or regex pattern computed per row may be one the matcher rejects
+      return arrow::Status::NotImplemented(func_name,
+                                           " is only supported with a literal pattern");
+    }
+    std::string child_array;
+    std::stringstream prepare_ss;
+    prepare_ss << "bool " << check_str_ << " = " << child_visitor_list[0]->GetPreCheck()
+               << " && " << child_visitor_list[1]->GetPreCheck() << ";" << std::endl;
+    prepare_ss << "bool " << codes_str_ << " = false;" << std::endl;
+    if (!matcher_codes.empty() &&
+        GetBatchInputArray(child_visitor_list[0], &child_array)) {
+      // evaluate the whole input column into a selection bitmap once per batch
+      std::stringstream batch_prepare_ss;
+      batch_prepare_ss << matcher_codes;
+      batch_prepare_ss << "std::shared_ptr<arrow::Buffer> " << codes_str_
+                       << "_selection_buffer;" << std::endl;
+      batch_prepare_ss << "RETURN_NOT_OK(" << matcher_name
+                       << "->MatchArray(ctx_->memory_pool(), " << child_array
+                       << "->cache_, &" << codes_str_ << "_selection_buffer));"
+                       << std::endl;
+      batch_prepare_ss << "auto " << codes_str_ << "_selection = " << codes_str_
+                       << "_selection_buffer->data();" << std::endl;
+      batch_prepare_str_ += batch_prepare_ss.str();
+      prepare_ss << "if (" << check_str_ << ") {" << std::endl;
+      prepare_ss << codes_str_ << " = sparkcolumnarplugin::precompile::GetSelection("
+                 << codes_str_ << "_selection, i);" << std::endl;
+      prepare_ss << "}" << std::endl;
+    } else if (!matcher_codes.empty()) {
+      prepare_ss << matcher_codes;
+      prepare_ss << "if (" << check_str_ << ") {" << std::endl;
+      prepare_ss << codes_str_ << " = " << matcher_name << "->Match(" << child_name
+                 << ");" << std::endl;
+      prepare_ss << "}" << std::endl;
+    } else {
+      // a prefix, suffix or needle computed per row is made again when it changes, it
+      // doesn't go into the shared cache
+      prepare_ss << "static thread_local sparkcolumnarplugin::precompile::"
+                 << "StringMatcherMemo " << matcher_name << "(\"" << func_name << "\");"
+                 << std::endl;
+      prepare_ss << "if (" << check_str_ << ") {" << std::endl;
+      prepare_ss << codes_str_ << " = " << matcher_name << ".Get("
+                 << child_visitor_list[1]->GetResult() << ").Match(" << child_name
+                 << ");" << std::endl;
+      prepare_ss << "}" << std::endl;
+    }
     prepare_str_ += prepare_ss.str();
+    header_list_.push_back(R"(#include "precompile/string_predicates.h")");
   } else if (func_name.find("cast") != std::string::npos &&
              func_name.compare("castDATE") != 0 &&
              func_name.compare("castDECIMAL") != 0) {
@@ -233,6 +547,18 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     }
     prepare_str_ += prepare_ss.str();
     check_str_ = validity;
+  } else if (func_name.compare("internal_hash32") == 0) {
+    // hash of the join tables, only has to match precompile::HashArrays32
+    ss << "sparkcolumnarplugin::precompile::InternalHash32("
+       << child_visitor_list[0]->GetResult() << ", "
+       << child_visitor_list[0]->GetPreCheck() << ", "
+       << child_visitor_list[1]->GetResult() << ")" << std::endl;
+    for (int i = 0; i < 2; i++) {
+      prepare_str_ += child_visitor_list[i]->GetPrepare();
+    }
+    check_str_ = "true";
+    codes_str_ = ss.str();
+    header_list_.push_back(R"(#include "precompile/internal_hash.h")");
   } else if (func_name.find("hash") != std::string::npos) {
     if (child_visitor_list.size() == 1) {
       ss << "sparkcolumnarplugin::thirdparty::murmurhash32::" << func_name << "("
@@ -256,14 +582,28 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
   } else if (func_name.compare("castDATE") == 0) {
     codes_str_ = func_name + "_" + std::to_string(cur_func_id);
     auto validity = codes_str_ + "_validity";
+    auto child_type_id = node.children()[0]->return_type()->id();
+    std::stringstream cast_ss;
+    if (node.return_type()->id() == arrow::Type::DATE32) {
+      // days of an int
+      cast_ss << child_visitor_list[0]->GetResult();
+    } else if (child_type_id == arrow::Type::DATE32) {
+      cast_ss << "sparkcolumnarplugin::precompile::MillisOfDays("
+              << child_visitor_list[0]->GetResult() << ")";
+      header_list_.push_back(R"(#include "precompile/date_time.h")");
+      // the date fields of it then run once per batch on the whole column
+      GetBatchInputArray(child_visitor_list[0], &batch_days_array_);
+    } else {
+      cast_ss << func_name << "(" << child_visitor_list[0]->GetResult() << ")";
+      header_list_.push_back(R"(#include "precompile/gandiva.h")");
+    }
     std::stringstream prepare_ss;
     prepare_ss << GetCTypeString(node.return_type()) << " " << codes_str_ << ";"
                << std::endl;
     prepare_ss << "bool " << validity << " = " << child_visitor_list[0]->GetPreCheck()
                << ";" << std::endl;
     prepare_ss << "if (" << validity << ") {" << std::endl;
-    prepare_ss << codes_str_ << " = " << func_name << "("
-               << child_visitor_list[0]->GetResult() << ");" << std::endl;
+    prepare_ss << codes_str_ << " = " << cast_ss.str() << ";" << std::endl;
     prepare_ss << "}" << std::endl;
 
     for (int i = 0; i < 1; i++) {
@@ -271,18 +611,35 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     }
     prepare_str_ += prepare_ss.str();
     check_str_ = validity;
-    header_list_.push_back(R"(#include "precompile/gandiva.h")");
-  } else if (func_name.compare("castDECIMAL") == 0) {
+  } else if (func_name.compare("castDECIMAL") == 0 ||
+             func_name.compare("rescaleDECIMAL") == 0) {
     codes_str_ = func_name + "_" + std::to_string(cur_func_id);
     auto validity = codes_str_ + "_validity";
-    std::stringstream fix_ss;
     auto decimal_type =
         std::dynamic_pointer_cast<arrow::Decimal128Type>(node.return_type());
-    if (!child_visitor_list[0]->decimal_scale_.empty()) {
-      fix_ss << ", " << child_visitor_list[0]->decimal_scale_ << ", "
-             << decimal_type->scale();
+    auto child_type = node.children()[0]->return_type();
+    std::stringstream cast_ss;
+    if (child_type->id() == arrow::Type::DECIMAL) {
+      // rescaleDECIMAL of a decimal expression rescales its unscaled value
+      auto in_scale = func_name.compare("rescaleDECIMAL") == 0 &&
+                              !child_visitor_list[0]->decimal_scale_.empty()
+                          ? 0
+                          : std::dynamic_pointer_cast<arrow::Decimal128Type>(child_type)
+                                ->scale();
+      cast_ss << "sparkcolumnarplugin::precompile::RescaleDecimal("
+              << child_visitor_list[0]->GetResult() << ", " << in_scale << ", "
+              << decimal_type->precision() << ", " << decimal_type->scale() << ", &"
+              << validity << ")";
+      header_list_.push_back(R"(#include "precompile/decimal.h")");
+    } else if (arrow::is_integer(child_type->id())) {
+      cast_ss << "sparkcolumnarplugin::precompile::CastDecimal("
+              << child_visitor_list[0]->GetResult() << ", " << decimal_type->precision()
+              << ", " << decimal_type->scale() << ", &" << validity << ")";
+      header_list_.push_back(R"(#include "precompile/decimal.h")");
     } else {
-      fix_ss << ", " << decimal_type->precision() << ", " << decimal_type->scale();
+      cast_ss << "castDECIMAL(" << child_visitor_list[0]->GetResult() << ", "
+              << decimal_type->precision() << ", " << decimal_type->scale() << ")";
+      header_list_.push_back(R"(#include "precompile/gandiva.h")");
     }
     std::stringstream prepare_ss;
     prepare_ss << GetCTypeString(node.return_type()) << " " << codes_str_ << ";"
@@ -290,8 +647,7 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     prepare_ss << "bool " << validity << " = " << child_visitor_list[0]->GetPreCheck()
                << ";" << std::endl;
     prepare_ss << "if (" << validity << ") {" << std::endl;
-    prepare_ss << codes_str_ << " = " << func_name << "("
-               << child_visitor_list[0]->GetResult() << fix_ss.str() << ");" << std::endl;
+    prepare_ss << codes_str_ << " = " << cast_ss.str() << ";" << std::endl;
     prepare_ss << "}" << std::endl;
 
     for (int i = 0; i < 1; i++) {
@@ -299,17 +655,39 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     }
     prepare_str_ += prepare_ss.str();
     check_str_ = validity;
-    header_list_.push_back(R"(#include "precompile/gandiva.h")");
-  } else if (func_name.compare("rescaleDECIMAL") == 0) {
+  } else if ((!GetDateKernel(func_name).empty() ||
+              func_name.compare("extractEpoch") == 0) &&
+             node.children()[0]->return_type()->id() == arrow::Type::DATE64) {
+    // the fields of days are branch free arithmetic, gandiva's go through gmtime_r
     codes_str_ = func_name + "_" + std::to_string(cur_func_id);
     auto validity = codes_str_ + "_validity";
-    std::stringstream fix_ss;
-    auto decimal_type =
-        std::dynamic_pointer_cast<arrow::Decimal128Type>(node.return_type());
-    if (!child_visitor_list[0]->decimal_scale_.empty()) {
-      fix_ss << ", 0, " << decimal_type->scale();
+    auto days = "sparkcolumnarplugin::precompile::DaysOfMillis(" +
+                child_visitor_list[0]->GetResult() + ")";
+    auto kernel = GetDateKernel(func_name);
+    auto days_array = child_visitor_list[0]->batch_days_array_;
+    std::stringstream date_ss;
+    if (func_name.compare("extractEpoch") == 0) {
+      date_ss << child_visitor_list[0]->GetResult() << " / 1000";
     } else {
-      fix_ss << ", " << decimal_type->precision() << ", " << decimal_type->scale();
+      auto field = "sparkcolumnarplugin::precompile::" + kernel + "(" + days + ")";
+      if (!days_array.empty()) {
+        // the field of the whole column, computed once per batch
+        std::stringstream batch_prepare_ss;
+        batch_prepare_ss << "std::unique_ptr<int32_t[]> " << codes_str_
+                         << "_out(new int32_t[" << days_array << "->length()]);"
+                         << std::endl;
+        batch_prepare_ss << "sparkcolumnarplugin::precompile::"
+                         << GetDateArrayKernel(func_name) << "(" << days_array
+                         << "->value_data(), " << days_array << "->length(), "
+                         << codes_str_ << "_out.get());" << std::endl;
+        batch_prepare_str_ += batch_prepare_ss.str();
+        field = codes_str_ + "_out[i]";
+      }
+      if (func_name.compare(0, 11, "date_trunc_") == 0) {
+        date_ss << "sparkcolumnarplugin::precompile::MillisOfDays(" << field << ")";
+      } else {
+        date_ss << field;
+      }
     }
     std::stringstream prepare_ss;
     prepare_ss << GetCTypeString(node.return_type()) << " " << codes_str_ << ";"
@@ -317,16 +695,13 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FunctionNode& node)
     prepare_ss << "bool " << validity << " = " << child_visitor_list[0]->GetPreCheck()
                << ";" << std::endl;
     prepare_ss << "if (" << validity << ") {" << std::endl;
-    prepare_ss << codes_str_ << " = castDECIMAL(" << child_visitor_list[0]->GetResult()
-               << fix_ss.str() << ");" << std::endl;
+    prepare_ss << codes_str_ << " = " << date_ss.str() << ";" << std::endl;
     prepare_ss << "}" << std::endl;
 
-    for (int i = 0; i < 1; i++) {
-      prepare_str_ += child_visitor_list[i]->GetPrepare();
-    }
+    prepare_str_ += child_visitor_list[0]->GetPrepare();
     prepare_str_ += prepare_ss.str();
     check_str_ = validity;
-    header_list_.push_back(R"(#include "precompile/gandiva.h")");
+    header_list_.push_back(R"(#include "precompile/date_time.h")");
   } else if (func_name.compare("extractYear") == 0) {
     codes_str_ = func_name + "_" + std::to_string(cur_func_id);
     auto validity = codes_str_ + "_validity";
@@ -572,7 +947,8 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FieldNode& node) {
     }
   }
 
-  check_str_ = codes_validity_str_;
+  // no null in this loop, the checks built on the field fold to constants
+  check_str_ = null_free_ && field_type_ != left ? "true" : codes_validity_str_;
   if (prepared_list_ != nullptr) {
     if (std::find((*prepared_list_).begin(), (*prepared_list_).end(), codes_str_) ==
         (*prepared_list_).end()) {
@@ -584,19 +960,43 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::FieldNode& node) {
 }
 
 arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::IfNode& node) {
+  std::shared_ptr<gandiva::FieldNode> key_node;
+  std::vector<std::pair<int64_t, gandiva::NodePtr>> arms;
+  gandiva::NodePtr else_node;
+  if (GetLookupTableArms(node, &key_node, &arms, &else_node)) {
+    return VisitLookupTable(node, key_node, arms, else_node);
+  }
+  gandiva::NodePtr step_key_node;
+  std::vector<int64_t> bounds;
+  std::vector<int64_t> values;
+  if (arrow::is_integer(node.return_type()->id()) &&
+      GetStepTableArms(node, &step_key_node, &bounds, &values) &&
+      bounds.size() >= kMinLookupTableArms) {
+    return VisitStepTable(node, step_key_node, bounds, values);
+  }
   std::stringstream prepare_ss;
   auto cur_func_id = *func_count_;
 
   std::vector<gandiva::NodePtr> children = {node.condition(), node.then_node(),
                                             node.else_node()};
+  // each branch is only prepared for the rows which select it, so fields first
+  // prepared inside a branch are unknown to the codes after this node
+  std::vector<std::vector<std::string>> branch_prepared_lists(2);
   std::vector<std::shared_ptr<ExpressionCodegenVisitor>> child_visitor_list;
-  for (auto child : children) {
+  for (int i = 0; i < 3; i++) {
+    auto prepared_list = prepared_list_;
+    if (i > 0 && prepared_list_ != nullptr) {
+      branch_prepared_lists[i - 1] = *prepared_list_;
+      prepared_list = &branch_prepared_lists[i - 1];
+    }
     std::shared_ptr<ExpressionCodegenVisitor> child_visitor;
     *func_count_ = *func_count_ + 1;
-    RETURN_NOT_OK(MakeExpressionCodegenVisitor(child, input_list_, field_list_v_,
+    RETURN_NOT_OK(MakeExpressionCodegenVisitor(children[i], input_list_, field_list_v_,
                                                hash_relation_id_, func_count_,
-                                               prepared_list_, &child_visitor));
+                                               prepared_list, &child_visitor,
+                                               batch_codegen_, null_free_));
     child_visitor_list.push_back(child_visitor);
+    batch_prepare_str_ += child_visitor->GetBatchPrepare();
     if (field_type_ == unknown || field_type_ == literal) {
       field_type_ = child_visitor->GetFieldType();
     } else if (field_type_ != child_visitor->GetFieldType() && field_type_ != literal &&
@@ -610,21 +1010,28 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::IfNode& node) {
       }
     }
   }
-  for (int i = 0; i < 3; i++) {
-    prepare_str_ += child_visitor_list[i]->GetPrepare();
-  }
+  prepare_str_ += child_visitor_list[0]->GetPrepare();
   auto condition_name = "condition_" + std::to_string(cur_func_id);
   auto condition_validity = condition_name + "_validity";
   prepare_ss << GetCTypeString(node.return_type()) << " " << condition_name << ";"
              << std::endl;
   prepare_ss << "bool " << condition_validity << ";" << std::endl;
+  // the branches are scopes of their own, the result owns its string
+  auto get_result = [&node](std::shared_ptr<ExpressionCodegenVisitor> visitor) {
+    if (node.return_type()->id() == arrow::Type::STRING) {
+      return "std::string(" + visitor->GetResult() + ")";
+    }
+    return visitor->GetResult();
+  };
   prepare_ss << "if (" << child_visitor_list[0]->GetResult() << ") {" << std::endl;
-  prepare_ss << condition_name << " = " << child_visitor_list[1]->GetResult() << ";"
+  prepare_ss << child_visitor_list[1]->GetPrepare();
+  prepare_ss << condition_name << " = " << get_result(child_visitor_list[1]) << ";"
              << std::endl;
   prepare_ss << condition_validity << " = " << child_visitor_list[1]->GetPreCheck() << ";"
              << std::endl;
   prepare_ss << "} else {" << std::endl;
-  prepare_ss << condition_name << " = " << child_visitor_list[2]->GetResult() << ";"
+  prepare_ss << child_visitor_list[2]->GetPrepare();
+  prepare_ss << condition_name << " = " << get_result(child_visitor_list[2]) << ";"
              << std::endl;
   prepare_ss << condition_validity << " = " << child_visitor_list[2]->GetPreCheck() << ";"
              << std::endl;
@@ -635,6 +1042,142 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::IfNode& node) {
   return arrow::Status::OK();
 }
 
+arrow::Status ExpressionCodegenVisitor::VisitLookupTable(
+    const gandiva::IfNode& node, std::shared_ptr<gandiva::FieldNode> key_node,
+    const std::vector<std::pair<int64_t, gandiva::NodePtr>>& arms,
+    gandiva::NodePtr else_node) {
+  auto cur_func_id = *func_count_;
+  std::shared_ptr<ExpressionCodegenVisitor> key_visitor;
+  *func_count_ = *func_count_ + 1;
+  RETURN_NOT_OK(MakeExpressionCodegenVisitor(key_node, input_list_, field_list_v_,
+                                             hash_relation_id_, func_count_,
+                                             prepared_list_, &key_visitor,
+                                             batch_codegen_, null_free_));
+  field_type_ = key_visitor->GetFieldType();
+  prepare_str_ += key_visitor->GetPrepare();
+
+  auto min_key = arms[0].first;
+  auto max_key = arms[0].first;
+  for (auto& arm : arms) {
+    min_key = std::min(min_key, arm.first);
+    max_key = std::max(max_key, arm.first);
+  }
+  // keys without an arm take the else result, the first arm of a key wins
+  std::vector<gandiva::NodePtr> table(max_key - min_key + 1, else_node);
+  for (auto it = arms.rbegin(); it != arms.rend(); it++) {
+    table[it->first - min_key] = it->second;
+  }
+  auto get_literal = [this](gandiva::NodePtr literal, std::string* value,
+                            std::string* validity) {
+    std::shared_ptr<ExpressionCodegenVisitor> literal_visitor;
+    *func_count_ = *func_count_ + 1;
+    RETURN_NOT_OK(MakeExpressionCodegenVisitor(literal, input_list_, field_list_v_,
+                                               hash_relation_id_, func_count_,
+                                               prepared_list_, &literal_visitor,
+                                               batch_codegen_, null_free_));
+    *value = literal_visitor->GetResult();
+    *validity = literal_visitor->GetPreCheck();
+    return arrow::Status::OK();
+  };
+
+  auto type_str = GetCTypeString(node.return_type());
+  auto table_name = "case_table_" + std::to_string(cur_func_id);
+  std::stringstream table_ss;
+  std::stringstream table_validity_ss;
+  // built once when first reached, like the in sets
+  table_ss << "static const " << type_str << " " << table_name << "[] = {";
+  table_validity_ss << "static const bool " << table_name << "_validity[] = {";
+  for (int i = 0; i < table.size(); i++) {
+    std::string value;
+    std::string validity;
+    RETURN_NOT_OK(get_literal(table[i], &value, &validity));
+    if (i > 0) {
+      table_ss << ", ";
+      table_validity_ss << ", ";
+    }
+    table_ss << (validity == "true" ? value : type_str + "()");
+    table_validity_ss << validity;
+  }
+  table_ss << "};" << std::endl;
+  table_validity_ss << "};" << std::endl;
+  std::string else_value;
+  std::string else_validity;
+  RETURN_NOT_OK(get_literal(else_node, &else_value, &else_validity));
+
+  auto key = key_visitor->GetResult();
+  auto min_key_str = GetIntegerLiteral(min_key);
+  auto condition_name = "condition_" + std::to_string(cur_func_id);
+  auto condition_validity = condition_name + "_validity";
+  std::stringstream prepare_ss;
+  prepare_ss << table_ss.str() << table_validity_ss.str();
+  prepare_ss << type_str << " " << condition_name << ";" << std::endl;
+  prepare_ss << "bool " << condition_validity << ";" << std::endl;
+  prepare_ss << "if (" << key_visitor->GetPreCheck() << " && " << key
+             << " >= " << min_key_str << " && " << key
+             << " <= " << GetIntegerLiteral(max_key) << ") {" << std::endl;
+  prepare_ss << condition_name << " = " << table_name << "[" << key << " - "
+             << min_key_str << "];" << std::endl;
+  prepare_ss << condition_validity << " = " << table_name << "_validity[" << key
+             << " - " << min_key_str << "];" << std::endl;
+  prepare_ss << "} else {" << std::endl;
+  prepare_ss << condition_name << " = " << else_value << ";" << std::endl;
+  prepare_ss << condition_validity << " = " << else_validity << ";" << std::endl;
+  prepare_ss << "}" << std::endl;
+  codes_str_ = condition_name;
+  prepare_str_ += prepare_ss.str();
+  check_str_ = condition_validity;
+  return arrow::Status::OK();
+}
+
+arrow::Status ExpressionCodegenVisitor::VisitStepTable(
+    const gandiva::IfNode& node, gandiva::NodePtr key_node,
+    const std::vector<int64_t>& bounds, const std::vector<int64_t>& values) {
+  auto cur_func_id = *func_count_;
+  std::shared_ptr<ExpressionCodegenVisitor> key_visitor;
+  *func_count_ = *func_count_ + 1;
+  RETURN_NOT_OK(MakeExpressionCodegenVisitor(key_node, input_list_, field_list_v_,
+                                             hash_relation_id_, func_count_,
+                                             prepared_list_, &key_visitor,
+                                             batch_codegen_, null_free_));
+  field_type_ = key_visitor->GetFieldType();
+  prepare_str_ += key_visitor->GetPrepare();
+  batch_prepare_str_ += key_visitor->GetBatchPrepare();
+  header_list_ = key_visitor->GetHeaders();
+  header_list_.push_back(R"(#include "precompile/date_time.h")");
+
+  auto type_str = GetCTypeString(node.return_type());
+  auto table_name = "step_table_" + std::to_string(cur_func_id);
+  std::stringstream prepare_ss;
+  // built once when first reached, like the CASE tables
+  prepare_ss << "static const int64_t " << table_name << "_bounds[] = {";
+  for (int i = 0; i < bounds.size(); i++) {
+    prepare_ss << (i > 0 ? ", " : "") << GetIntegerLiteral(bounds[i]);
+  }
+  prepare_ss << "};" << std::endl;
+  prepare_ss << "static const " << type_str << " " << table_name << "[] = {";
+  for (int i = 0; i < values.size(); i++) {
+    prepare_ss << (i > 0 ? ", " : "") << "static_cast<" << type_str << ">("
+               << GetIntegerLiteral(values[i]) << ")";
+  }
+  prepare_ss << "};" << std::endl;
+
+  // a null key fails every condition, gandiva then takes the last else
+  auto condition_name = "condition_" + std::to_string(cur_func_id);
+  auto condition_validity = condition_name + "_validity";
+  prepare_ss << type_str << " " << condition_name << " = " << table_name << "["
+             << bounds.size() << "];" << std::endl;
+  prepare_ss << "bool " << condition_validity << " = true;" << std::endl;
+  prepare_ss << "if (" << key_visitor->GetPreCheck() << ") {" << std::endl;
+  prepare_ss << condition_name << " = sparkcolumnarplugin::precompile::StepLookup("
+             << key_visitor->GetResult() << ", " << table_name << "_bounds, "
+             << table_name << ", " << bounds.size() << ");" << std::endl;
+  prepare_ss << "}" << std::endl;
+  codes_str_ = condition_name;
+  prepare_str_ += prepare_ss.str();
+  check_str_ = condition_validity;
+  return arrow::Status::OK();
+}
+
 arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::LiteralNode& node) {
   auto cur_func_id = *func_count_;
   std::stringstream codes_ss;
@@ -643,8 +1186,11 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::LiteralNode& node)
   } else if (node.return_type()->id() == arrow::Type::DECIMAL) {
     auto scalar = arrow::util::get<gandiva::DecimalScalar128>(node.holder());
     auto decimal = arrow::Decimal128(scalar.value());
-    codes_ss << "arrow::Decimal128(\"" << decimal.ToString(scalar.scale()) << "\")"
-             << std::endl;
+    // built from the unscaled value instead of parsing a string for every row, the
+    // high word goes through its bits as INT64_MIN has no literal
+    codes_ss << "arrow::Decimal128(static_cast<int64_t>("
+             << static_cast<uint64_t>(decimal.high_bits()) << "ULL), "
+             << decimal.low_bits() << "ULL)" << std::endl;
     decimal_scale_ = std::to_string(scalar.scale());
   } else {
     codes_ss << gandiva::ToString(node.holder()) << std::endl;
@@ -664,9 +1210,11 @@ arrow::Status ExpressionCodegenVisitor::Visit(const gandiva::BooleanNode& node)
     *func_count_ = *func_count_ + 1;
     RETURN_NOT_OK(MakeExpressionCodegenVisitor(child, input_list_, field_list_v_,
                                                hash_relation_id_, func_count_,
-                                               prepared_list_, &child_visitor));
+                                               prepared_list_, &child_visitor,
+                                               batch_codegen_, null_free_));
 
     prepare_str_ += child_visitor->GetPrepare();
+    batch_prepare_str_ += child_visitor->GetBatchPrepare();
     child_visitor_list.push_back(child_visitor);
     if (field_type_ == unknown || field_type_ == literal) {
       field_type_ = child_visitor->GetFieldType();
@@ -703,35 +1251,41 @@ arrow::Status ExpressionCodegenVisitor::Visit(
 
   RETURN_NOT_OK(MakeExpressionCodegenVisitor(node.eval_expr(), input_list_, field_list_v_,
                                              hash_relation_id_, func_count_,
-                                             prepared_list_, &child_visitor));
+                                             prepared_list_, &child_visitor,
+                                             batch_codegen_, null_free_));
   std::stringstream prepare_ss;
-  prepare_ss << "std::vector<int> in_list_" << cur_func_id << " = {";
+  // built once when first reached, the set picks its lookup structure from the
+  // list size and value range
+  prepare_ss << "static const sparkcolumnarplugin::precompile::IntegerInSet<int32_t> "
+             << "in_set_" << cur_func_id << "({";
   bool add_comma = false;
   for (auto& value : node.values()) {
     if (add_comma) {
       prepare_ss << ", ";
     }
-    // add type in the front to differentiate
     prepare_ss << value;
     add_comma = true;
   }
-  prepare_ss << "};" << std::endl;
+  prepare_ss << "});" << std::endl;
 
   std::stringstream ss;
-  ss << child_visitor->GetPreCheck() << " && "
-     << "std::find(in_list_" << cur_func_id << ".begin(), in_list_" << cur_func_id
-     << ".end(), " << child_visitor->GetResult() << ") != "
-     << "in_list_" << cur_func_id << ".end()";
+  ss << child_visitor->GetPreCheck() << " && in_set_" << cur_func_id << ".Contains("
+     << child_visitor->GetResult() << ")";
   codes_str_ = ss.str();
   prepare_str_ = prepare_ss.str();
   field_type_ = child_visitor->GetFieldType();
   prepare_str_ += child_visitor->GetPrepare();
+  batch_prepare_str_ += child_visitor->GetBatchPrepare();
   for (auto header : child_visitor->GetHeaders()) {
     if (std::find(header_list_.begin(), header_list_.end(), header) ==
         header_list_.end()) {
       header_list_.push_back(header);
     }
   }
+  if (std::find(header_list_.begin(), header_list_.end(),
+                R"(#include "precompile/in_set.h")") == header_list_.end()) {
+    header_list_.push_back(R"(#include "precompile/in_set.h")");
+  }
   return arrow::Status::OK();
 }
 
@@ -743,35 +1297,39 @@ arrow::Status ExpressionCodegenVisitor::Visit(
 
   RETURN_NOT_OK(MakeExpressionCodegenVisitor(node.eval_expr(), input_list_, field_list_v_,
                                              hash_relation_id_, func_count_,
-                                             prepared_list_, &child_visitor));
+                                             prepared_list_, &child_visitor,
+                                             batch_codegen_, null_free_));
   std::stringstream prepare_ss;
-  prepare_ss << "std::vector<long int> in_list_" << cur_func_id << " = {";
+  prepare_ss << "static const sparkcolumnarplugin::precompile::IntegerInSet<int64_t> "
+             << "in_set_" << cur_func_id << "({";
   bool add_comma = false;
   for (auto& value : node.values()) {
     if (add_comma) {
       prepare_ss << ", ";
     }
-    // add type in the front to differentiate
-    prepare_ss << value;
+    prepare_ss << GetIntegerLiteral(value);
     add_comma = true;
   }
-  prepare_ss << "};" << std::endl;
+  prepare_ss << "});" << std::endl;
 
   std::stringstream ss;
-  ss << child_visitor->GetPreCheck() << " && "
-     << "std::find(in_list_" << cur_func_id << ".begin(), in_list_" << cur_func_id
-     << ".end(), " << child_visitor->GetResult() << ") != "
-     << "in_list_" << cur_func_id << ".end()";
+  ss << child_visitor->GetPreCheck() << " && in_set_" << cur_func_id << ".Contains("
+     << child_visitor->GetResult() << ")";
   codes_str_ = ss.str();
   prepare_str_ = prepare_ss.str();
   field_type_ = child_visitor->GetFieldType();
   prepare_str_ += child_visitor->GetPrepare();
+  batch_prepare_str_ += child_visitor->GetBatchPrepare();
   for (auto header : child_visitor->GetHeaders()) {
     if (std::find(header_list_.begin(), header_list_.end(), header) ==
         header_list_.end()) {
       header_list_.push_back(header);
     }
   }
+  if (std::find(header_list_.begin(), header_list_.end(),
+                R"(#include "precompile/in_set.h")") == header_list_.end()) {
+    header_list_.push_back(R"(#include "precompile/in_set.h")");
+  }
   return arrow::Status::OK();
 }
 
@@ -783,35 +1341,39 @@ arrow::Status ExpressionCodegenVisitor::Visit(
 
   RETURN_NOT_OK(MakeExpressionCodegenVisitor(node.eval_expr(), input_list_, field_list_v_,
                                              hash_relation_id_, func_count_,
-                                             prepared_list_, &child_visitor));
+                                             prepared_list_, &child_visitor,
+                                             batch_codegen_, null_free_));
   std::stringstream prepare_ss;
-  prepare_ss << "std::vector<std::string> in_list_" << cur_func_id << " = {";
+  prepare_ss << "static const sparkcolumnarplugin::precompile::StringInSet "
+             << "in_set_" << cur_func_id << "({";
   bool add_comma = false;
   for (auto& value : node.values()) {
     if (add_comma) {
       prepare_ss << ", ";
     }
-    // add type in the front to differentiate
-    prepare_ss << R"(")" << value << R"(")";
+    prepare_ss << GetCStringLiteral(value);
     add_comma = true;
   }
-  prepare_ss << "};" << std::endl;
+  prepare_ss << "});" << std::endl;
 
   std::stringstream ss;
-  ss << child_visitor->GetPreCheck() << " && "
-     << "std::find(in_list_" << cur_func_id << ".begin(), in_list_" << cur_func_id
-     << ".end(), " << child_visitor->GetResult() << ") != "
-     << "in_list_" << cur_func_id << ".end()";
+  ss << child_visitor->GetPreCheck() << " && in_set_" << cur_func_id << ".Contains("
+     << child_visitor->GetResult() << ")";
   codes_str_ = ss.str();
   prepare_str_ = prepare_ss.str();
   field_type_ = child_visitor->GetFieldType();
   prepare_str_ += child_visitor->GetPrepare();
+  batch_prepare_str_ += child_visitor->GetBatchPrepare();
   for (auto header : child_visitor->GetHeaders()) {
     if (std::find(header_list_.begin(), header_list_.end(), header) ==
         header_list_.end()) {
       header_list_.push_back(header);
     }
   }
+  if (std::find(header_list_.begin(), header_list_.end(),
+                R"(#include "precompile/in_set.h")") == header_list_.end()) {
+    header_list_.push_back(R"(#include "precompile/in_set.h")");
+  }
   return arrow::Status::OK();
 }
 
@@ -834,6 +1396,19 @@ std::string ExpressionCodegenVisitor::CombineValidity(
   return out.str();
 }
 
+bool ExpressionCodegenVisitor::GetBatchInputArray(
+    std::shared_ptr<ExpressionCodegenVisitor> child_visitor, std::string* array_name) {
+  // whole stage codegen reads input column i of the current batch into
+  // typed_in_col_i from the typed_in_i array, row by row with index i
+  const std::string prefix = "typed_in_col_";
+  auto name = child_visitor->GetResult();
+  if (!batch_codegen_ || name.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  *array_name = "typed_in_" + name.substr(prefix.size());
+  return true;
+}
+
 std::string ExpressionCodegenVisitor::GetValidityName(std::string name) {
   auto pos = name.find("!");
   if (pos == std::string::npos) {
@@ -30,13 +30,16 @@ class ExpressionCodegenVisitor : public VisitorBase {
   ExpressionCodegenVisitor(
       std::shared_ptr<gandiva::Node> func, std::vector<std::string> input_list,
       std::vector<std::vector<std::shared_ptr<arrow::Field>>> field_list_v,
-      int hash_relation_id, int* func_count, std::vector<std::string>* prepared_list)
+      int hash_relation_id, int* func_count, std::vector<std::string>* prepared_list,
+      bool batch_codegen = false, bool null_free = false)
       : func_(func),
         field_list_v_(field_list_v),
         func_count_(func_count),
         input_list_(input_list),
         prepared_list_(prepared_list),
-        hash_relation_id_(hash_relation_id) {}
+        hash_relation_id_(hash_relation_id),
+        batch_codegen_(batch_codegen),
+        null_free_(null_free) {}
 
   enum FieldType { left, right, literal, mixed, unknown };
 
@@ -50,6 +53,8 @@ class ExpressionCodegenVisitor : public VisitorBase {
   std::string GetResultValidity();
   std::string GetPreCheck();
   std::string GetPrepare();
+  // codes to run once per input batch, before the per-row codes
+  std::string GetBatchPrepare();
   std::string GetRealResult();
   std::string GetRealValidity();
   std::vector<std::string> GetHeaders();
@@ -63,6 +68,9 @@ class ExpressionCodegenVisitor : public VisitorBase {
   arrow::Status Visit(const gandiva::InExpressionNode<long int>& node) override;
   arrow::Status Visit(const gandiva::InExpressionNode<std::string>& node) override;
   std::string decimal_scale_;
+  // the batch input array of the date32 days a castDATE to date64 reads, empty
+  // unless the date field kernels can run on the whole column
+  std::string batch_days_array_;
 
  private:
   std::shared_ptr<gandiva::Node> func_;
@@ -70,6 +78,10 @@ class ExpressionCodegenVisitor : public VisitorBase {
   int hash_relation_id_;
   std::vector<std::string> input_list_;
   int* func_count_;
+  // whether the caller pastes GetBatchPrepare() ahead of the per-row loop
+  bool batch_codegen_;
+  // whether the input_list columns are known to hold no null in the generated loop
+  bool null_free_;
   FieldType field_type_ = unknown;
   // output
   std::vector<std::string>* prepared_list_;
@@ -79,20 +91,34 @@ class ExpressionCodegenVisitor : public VisitorBase {
   std::string codes_str_;
   std::string codes_validity_str_;
   std::string prepare_str_;
+  std::string batch_prepare_str_;
   std::string input_codes_str_;
   std::string check_str_;
 
+  // CASE on one integer column with literal results, as a table indexed by the key
+  arrow::Status VisitLookupTable(
+      const gandiva::IfNode& node, std::shared_ptr<gandiva::FieldNode> key_node,
+      const std::vector<std::pair<int64_t, gandiva::NodePtr>>& arms,
+      gandiva::NodePtr else_node);
+  // search of a step function of an integer key, as a table of its bounds
+  arrow::Status VisitStepTable(const gandiva::IfNode& node, gandiva::NodePtr key_node,
+                               const std::vector<int64_t>& bounds,
+                               const std::vector<int64_t>& values);
   std::string CombineValidity(std::vector<std::string> validity_list);
   std::string GetValidityName(std::string name);
+  bool GetBatchInputArray(std::shared_ptr<ExpressionCodegenVisitor> child_visitor,
+                          std::string* array_name);
 };
 
 static arrow::Status MakeExpressionCodegenVisitor(
     std::shared_ptr<gandiva::Node> func, std::vector<std::string> input_list,
     std::vector<std::vector<std::shared_ptr<arrow::Field>>> field_list_v,
     int hash_relation_id, int* func_count, std::vector<std::string>* prepared_list,
-    std::shared_ptr<ExpressionCodegenVisitor>* out) {
+    std::shared_ptr<ExpressionCodegenVisitor>* out, bool batch_codegen = false,
+    bool null_free = false) {
   auto visitor = std::make_shared<ExpressionCodegenVisitor>(
-      func, input_list, field_list_v, hash_relation_id, func_count, prepared_list);
+      func, input_list, field_list_v, hash_relation_id, func_count, prepared_list,
+      batch_codegen, null_free);
   RETURN_NOT_OK(visitor->Eval());
   *out = visitor;
   return arrow::Status::OK();
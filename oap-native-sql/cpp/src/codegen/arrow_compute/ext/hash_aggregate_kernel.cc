@@ -34,6 +34,7 @@
 #include "codegen/arrow_compute/ext/codegen_register.h"
 #include "codegen/arrow_compute/ext/kernels_ext.h"
 #include "codegen/arrow_compute/ext/typed_action_codegen_impl.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 namespace sparkcolumnarplugin {
@@ -94,7 +95,7 @@ class HashAggregateKernel::Impl {
     std::cout << "signature is " << signature_ << std::endl;
 #endif
 
-    auto file_lock = FileSpinLock();
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, &hash_aggregater_);
     if (!status.ok()) {
       // process
@@ -187,8 +188,8 @@ class HashAggregateKernel::Impl {
     if (!expr_list.empty()) {
       original_input_schema_ = arrow::schema(input_field_list_);
       auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-      THROW_NOT_OK(gandiva::Projector::Make(original_input_schema_, expr_list,
-                                            configuration, &projector_));
+      THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(
+          original_input_schema_, expr_list, configuration, &projector_));
     }
     return arrow::Status::OK();
   }
@@ -282,6 +283,7 @@ class HashAggregateKernel::Impl {
     auto typed_input_parameter_str = GetParameterList(typed_input_list);
     auto compute_on_exists_str = compute_on_exists_ss.str();
     auto compute_on_new_str = compute_on_new_ss.str();
+    auto no_null_condition_str = GetNoNullCondition(typed_input_list);
     auto impl_cached_define_str = cached_define_ss.str();
     auto on_finish_str = on_finish_ss.str();
     auto on_finish_cached_parameter_str = GetParameterList(result_cached_list, false);
@@ -347,17 +349,21 @@ class TypedGroupbyHashAggregateImpl : public CodeGenBase {
            evaluate_get_typed_key_array_str +
            R"(
     auto insert_on_found = [this)" +
-           typed_input_parameter_str + R"(](int32_t i) {
+           typed_input_parameter_str + R"(](int32_t i, auto null_free) {
       )" + compute_on_exists_str +
            R"(
     };
     auto insert_on_not_found = [this)" +
-           typed_input_parameter_str + R"(](int32_t i) {
+           typed_input_parameter_str + R"(](int32_t i, auto null_free) {
       )" + compute_on_new_str +
            R"(
       num_groups_ ++;
     };
 
+    auto process = [this, &typed_array, &insert_on_found,
+                    &insert_on_not_found](auto null_free) {
+    auto on_found = [&](int32_t i) { insert_on_found(i, null_free); };
+    auto on_not_found = [&](int32_t i) { insert_on_not_found(i, null_free); };
     cur_id_ = 0;
     int memo_index = 0;
     if (typed_array->null_count() == 0) {
@@ -366,9 +372,9 @@ class TypedGroupbyHashAggregateImpl : public CodeGenBase {
            evaluate_get_typed_key_method_str + R"((cur_id_), [](int32_t){},
                                  [](int32_t){}, &memo_index);
         if (memo_index < num_groups_) {
-          insert_on_found(memo_index);
+          on_found(memo_index);
         } else {
-          insert_on_not_found(memo_index);
+          on_not_found(memo_index);
         }
       }
     } else {
@@ -376,9 +382,9 @@ class TypedGroupbyHashAggregateImpl : public CodeGenBase {
         if (typed_array->IsNull(cur_id_)) {
           memo_index = hash_table_->GetOrInsertNull([](int32_t){}, [](int32_t){});
           if (memo_index < num_groups_) {
-            insert_on_found(memo_index);
+            on_found(memo_index);
           } else {
-            insert_on_not_found(memo_index);
+            on_not_found(memo_index);
           }
         } else {
           hash_table_->GetOrInsert(typed_array->)" +
@@ -386,13 +392,21 @@ class TypedGroupbyHashAggregateImpl : public CodeGenBase {
                                    [](int32_t){}, [](int32_t){},
                                    &memo_index);
         if (memo_index < num_groups_) {
-          insert_on_found(memo_index);
+          on_found(memo_index);
         } else {
-          insert_on_not_found(memo_index);
+          on_not_found(memo_index);
         }
         }
       }
     }
+    };
+    // the actions skip their null checks when no input of the batch has a null
+    if ()" + no_null_condition_str +
+           R"() {
+      process(std::true_type());
+    } else {
+      process(std::false_type());
+    }
     return arrow::Status::OK();
   }
 
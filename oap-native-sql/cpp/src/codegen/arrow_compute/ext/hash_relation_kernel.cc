@@ -36,6 +36,8 @@
 #include "codegen/arrow_compute/ext/typed_node_visitor.h"
 #include "codegen/common/hash_relation_number.h"
 #include "codegen/common/hash_relation_string.h"
+#include "precompile/internal_hash.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 namespace sparkcolumnarplugin {
@@ -74,6 +76,10 @@ class HashRelationKernel::Impl {
           std::dynamic_pointer_cast<gandiva::LiteralNode>(parameter_nodes[0])->holder());
       builder_type_ = std::stoi(builder_type_str);
     }
+    // the probe side switches the same way, see ConditionedProbeKernel
+    if (builder_type_ == 0 && !IsPackableJoinKey(key_nodes)) {
+      builder_type_ = 1;
+    }
     if (builder_type_ == 0) {
       if (key_nodes.size() == 1) {
         auto key_node = key_nodes[0];
@@ -92,30 +98,26 @@ class HashRelationKernel::Impl {
                                       hash_relation_list, &hash_relation_));
       } else {
         gandiva::ExpressionPtr project_expr;
-        project_expr = GetConcatedKernel(key_nodes);
+        project_expr = GetJoinKeyKernel(key_nodes);
         auto schema = arrow::schema(input_field_list);
         auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-        THROW_NOT_OK(gandiva::Projector::Make(schema, {project_expr}, configuration,
-                                              &key_projector_));
+        THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(
+            schema, {project_expr}, configuration, &key_projector_));
         THROW_NOT_OK(MakeHashRelation(project_expr->result()->type()->id(), ctx_,
                                       hash_relation_list, &hash_relation_));
       }
     } else if (builder_type_ == 1) {
       // we will use unsafe_row and new unsafe_hash_map
       gandiva::ExpressionVector key_project_expr = GetGandivaKernel(key_nodes);
-      gandiva::ExpressionPtr key_hash_expr = GetHash32Kernel(key_nodes);
 
       auto schema = arrow::schema(input_field_list);
       auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-      THROW_NOT_OK(gandiva::Projector::Make(schema, key_project_expr, configuration,
-                                            &key_prepare_projector_));
+      THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(
+          schema, key_project_expr, configuration, &key_prepare_projector_));
       gandiva::FieldVector key_hash_field_list;
       for (auto expr : key_project_expr) {
         key_hash_field_list.push_back(expr->result());
       }
-      hash_input_schema_ = arrow::schema(key_hash_field_list);
-      THROW_NOT_OK(gandiva::Projector::Make(hash_input_schema_, {key_hash_expr},
-                                            configuration, &key_projector_));
       if (key_hash_field_list.size() == 1 &&
           key_hash_field_list[0]->type()->id() != arrow::Type::STRING) {
         // If single key case, we can put key in KeyArray
@@ -130,12 +132,18 @@ class HashRelationKernel::Impl {
     } else {
       hash_relation_ = std::make_shared<HashRelation>(hash_relation_list);
     }
+    // recorded in the relation, the probe side reads the payload in this layout
+    std::vector<std::shared_ptr<arrow::DataType>> payload_types;
+    for (auto field : input_field_list) {
+      payload_types.push_back(field->type());
+    }
+    if (HashRelationPayloadRows::Preferred(payload_types)) {
+      hash_relation_->EnablePayloadRows(ctx_->memory_pool(), payload_types);
+    }
   }
 
   arrow::Status Evaluate(const ArrayList& in) {
-    for (int i = 0; i < in.size(); i++) {
-      RETURN_NOT_OK(hash_relation_->AppendPayloadColumn(i, in[i]));
-    }
+    RETURN_NOT_OK(hash_relation_->AppendPayload(in));
     if (builder_type_ == 2) return arrow::Status::OK();
     std::shared_ptr<arrow::Array> key_array;
     if (builder_type_ == 0) {
@@ -159,13 +167,9 @@ class HashRelationKernel::Impl {
       RETURN_NOT_OK(key_prepare_projector_->Evaluate(*in_batch, ctx_->memory_pool(),
                                                      &project_outputs));
 
-      /* Process key Hash projection */
-      arrow::ArrayVector hash_outputs;
-      auto hash_in_batch =
-          arrow::RecordBatch::Make(hash_input_schema_, length, project_outputs);
+      /* Process key Hash, same as GetHash32Kernel on the probe side */
       RETURN_NOT_OK(
-          key_projector_->Evaluate(*hash_in_batch, ctx_->memory_pool(), &hash_outputs));
-      key_array = hash_outputs[0];
+          precompile::HashArrays32(project_outputs, ctx_->memory_pool(), &key_array));
 
 /* For single field fixed_size key, we simply insert to HashMap without append to unsafe
  * Row */
@@ -220,6 +224,12 @@ class HashRelationKernel::Impl {
   std::string GetSignature() { return ""; }
   arrow::Status MakeResultIterator(std::shared_ptr<arrow::Schema> schema,
                                    std::shared_ptr<ResultIterator<HashRelation>>* out) {
+    if (GetHashRelationStatsEnabled()) {
+      HashRelationStats stats;
+      RETURN_NOT_OK(hash_relation_->GetStats(&stats));
+      std::cout << "HashRelation built with type " << builder_type_ << ", "
+                << stats.ToString() << std::endl;
+    }
     *out = std::make_shared<HashRelationResultIterator>(hash_relation_);
     return arrow::Status::OK();
   }
@@ -232,7 +242,6 @@ class HashRelationKernel::Impl {
   std::vector<int> key_indices_;
   std::shared_ptr<gandiva::Projector> key_projector_;
   std::shared_ptr<gandiva::Projector> key_prepare_projector_;
-  std::shared_ptr<arrow::Schema> hash_input_schema_;
   std::shared_ptr<HashRelation> hash_relation_;
   int builder_type_ = 0;
 
@@ -249,10 +258,7 @@ class HashRelationKernel::Impl {
     arrow::Status ProcessAndCacheOne(
         const std::vector<std::shared_ptr<arrow::Array>>& in,
         const std::shared_ptr<arrow::Array>& selection = nullptr) override {
-      for (int i = 0; i < in.size(); i++) {
-        RETURN_NOT_OK(hash_relation_->AppendPayloadColumn(i, in[i]));
-      }
-      return arrow::Status::OK();
+      return hash_relation_->AppendPayload(in);
     }
 
    private:
@@ -0,0 +1,198 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "codegen/arrow_compute/ext/hyperloglog_plus_plus_bias.h"
+#include "third_party/xxhash/xxhash64.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+/// HyperLogLog++ sketch with the same register layout as Spark's
+/// HyperLogLogPlusPlusHelper: 6-bit registers packed 10 per int64 word, and
+/// m / 10 + 1 words per sketch. The words are kept as plain int64 columns so a
+/// partial aggregate can be shuffled like any other aggregate buffer.
+///
+/// Query() follows Spark's estimate: linear counting below the threshold of p,
+/// otherwise the raw estimate, corrected by the empirical bias of
+/// hyperloglog_plus_plus_bias.h while it is at most 5m and p < 19.
+class HyperLogLogPlusPlus {
+ public:
+  static const int kRegisterSize = 6;
+  static const int kRegistersPerWord = 10;
+  static const int64_t kRegisterWordMask = (1LL << kRegisterSize) - 1;
+  static const uint64_t kSeed = 42;
+
+  explicit HyperLogLogPlusPlus(double relative_sd = 0.05) {
+    if (relative_sd > 0.39) {
+      throw std::runtime_error(
+          "HLL++ requires at least 4 bits for addressing. Use a lower error, at most "
+          "39%.");
+    }
+    p_ = static_cast<int>(ceil(2.0 * log(1.106 / relative_sd) / log(2.0)));
+    idx_shift_ = 64 - p_;
+    w_padding_ = 1ULL << (p_ - 1);
+    m_ = 1 << p_;
+    switch (p_) {
+      case 4:
+        alpha_m2_ = 0.673 * m_ * m_;
+        break;
+      case 5:
+        alpha_m2_ = 0.697 * m_ * m_;
+        break;
+      case 6:
+        alpha_m2_ = 0.709 * m_ * m_;
+        break;
+      default:
+        alpha_m2_ = (0.7213 / (1.0 + 1.079 / m_)) * m_ * m_;
+    }
+    num_words_ = m_ / kRegistersPerWord + 1;
+  }
+
+  int p() const { return p_; }
+  int num_registers() const { return m_; }
+  int num_words() const { return num_words_; }
+
+  /// Map a hash value to its packed (register index, register value) pair. Kept
+  /// branch free so the whole input column can be pre-processed in one loop.
+  inline uint32_t Encode(uint64_t hash) const {
+    uint32_t idx = static_cast<uint32_t>(hash >> idx_shift_);
+    uint32_t pw = static_cast<uint32_t>(__builtin_clzll((hash << p_) | w_padding_)) + 1;
+    return (idx << 8) | pw;
+  }
+
+  inline void Update(int64_t* words, uint32_t encoded) const {
+    uint32_t idx = encoded >> 8;
+    int64_t pw = encoded & 0xFF;
+    uint32_t word_offset = idx / kRegistersPerWord;
+    int shift = kRegisterSize * (idx - word_offset * kRegistersPerWord);
+    int64_t mask = kRegisterWordMask << shift;
+    int64_t word = words[word_offset];
+    int64_t m_idx = static_cast<int64_t>(static_cast<uint64_t>(word & mask) >> shift);
+    if (pw > m_idx) {
+      words[word_offset] = (word & ~mask) | (pw << shift);
+    }
+  }
+
+  /// Register-wise max of two packed words.
+  static inline int64_t MergeWord(int64_t word1, int64_t word2) {
+    int64_t word = 0;
+    int64_t mask = kRegisterWordMask;
+    for (int i = 0; i < kRegistersPerWord; i++) {
+      // registers are 6 bits wide, compare them unsigned in place
+      uint64_t r1 = static_cast<uint64_t>(word1 & mask);
+      uint64_t r2 = static_cast<uint64_t>(word2 & mask);
+      word |= static_cast<int64_t>(r1 > r2 ? r1 : r2);
+      mask <<= kRegisterSize;
+    }
+    return word;
+  }
+
+  inline void Merge(int64_t* dst, const int64_t* src) const {
+    for (int w = 0; w < num_words_; w++) {
+      dst[w] = MergeWord(dst[w], src[w]);
+    }
+  }
+
+  int64_t Query(const int64_t* words) const {
+    double z_inverse = 0.0;
+    double v = 0.0;
+    int idx = 0;
+    for (int w = 0; w < num_words_; w++) {
+      uint64_t word = static_cast<uint64_t>(words[w]);
+      int i = 0;
+      while (idx < m_ && i < kRegistersPerWord) {
+        int m_idx = static_cast<int>((word >> (i * kRegisterSize)) & kRegisterWordMask);
+        z_inverse += 1.0 / static_cast<double>(1LL << m_idx);
+        if (m_idx == 0) {
+          v += 1.0;
+        }
+        i++;
+        idx++;
+      }
+    }
+    double e = alpha_m2_ / z_inverse;
+    double estimate = (p_ < 19 && e < 5.0 * m_) ? e - EstimateBias(e) : e;
+    if (v > 0) {
+      double h = m_ * log(m_ / v);
+      if (h <= Threshold(p_)) {
+        estimate = h;
+      }
+    }
+    return static_cast<int64_t>(llround(estimate));
+  }
+
+  /// Mean bias of the kBiasNeighbors raw estimates in the tables closest to e.
+  double EstimateBias(double e) const {
+    auto table = GetHyperLogLogPlusPlusBias(p_);
+    const double* estimates = table.raw_estimates;
+    int num_estimates = table.size;
+    // the estimates are sorted, start from the first one not below e
+    int nearest = static_cast<int>(
+        std::lower_bound(estimates, estimates + num_estimates, e) - estimates);
+    auto distance = [&](int i) {
+      double diff = e - estimates[i];
+      return diff * diff;
+    };
+    // slide the window while the (exclusive) high end is closer than the low one
+    int low = std::max(nearest - kBiasNeighbors + 1, 0);
+    int high = std::min(low + kBiasNeighbors, num_estimates);
+    while (high < num_estimates && distance(high) < distance(low)) {
+      low++;
+      high++;
+    }
+    double bias_sum = 0.0;
+    for (int i = low; i < high; i++) {
+      bias_sum += table.biases[i];
+    }
+    return bias_sum / (high - low);
+  }
+
+ private:
+  static const int kBiasNeighbors = 6;
+
+  // linear counting thresholds from the HLL++ paper, indexed by p - 4
+  static double Threshold(int p) {
+    static const double thresholds[] = {10,    20,    40,    80,     220,
+                                        400,   900,   1800,  3100,   6500,
+                                        11500, 20000, 50000, 120000, 350000};
+    return thresholds[p > 18 ? 14 : p - 4];
+  }
+  int p_;
+  int idx_shift_;
+  uint64_t w_padding_;
+  int m_;
+  double alpha_m2_;
+  int num_words_;
+};
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -53,6 +53,7 @@
 #include "codegen/arrow_compute/ext/array_item_index.h"
 #include "codegen/arrow_compute/ext/codegen_common.h"
 //#include "codegen/arrow_compute/ext/codegen_node_visitor.h"
+#include "precompile/internal_hash.h"
 #include "third_party/arrow/utils/hashing.h"
 #include "utils/macros.h"
 
@@ -64,13 +65,24 @@ namespace extra {
 using ArrayList = std::vector<std::shared_ptr<arrow::Array>>;
 
 ///////////////  SplitArrayListWithAction  ////////////////
+// Numeric type of an action argument, named like arrow prints it, e.g. "int32".
+static arrow::Status GetNumericType(const std::string& name,
+                                    std::shared_ptr<arrow::DataType>* out) {
+  for (auto type : {arrow::uint8(), arrow::int8(), arrow::uint16(), arrow::int16(),
+                    arrow::uint32(), arrow::int32(), arrow::uint64(), arrow::int64(),
+                    arrow::float32(), arrow::float64()}) {
+    if (type->ToString() == name) {
+      *out = type;
+      return arrow::Status::OK();
+    }
+  }
+  return arrow::Status::Invalid(name, " is not a numeric type.");
+}
+
 class SplitArrayListWithActionKernel::Impl {
  public:
-  Impl(arrow::compute::FunctionContext* ctx, std::vector<std::string> action_name_list,
-       std::vector<std::shared_ptr<arrow::DataType>> type_list)
-      : ctx_(ctx), action_name_list_(action_name_list) {
-    InitActionList(type_list);
-  }
+  Impl(arrow::compute::FunctionContext* ctx, std::vector<std::string> action_name_list)
+      : ctx_(ctx), action_name_list_(action_name_list) {}
   virtual ~Impl() {}
 
   arrow::Status InitActionList(std::vector<std::shared_ptr<arrow::DataType>> type_list) {
@@ -100,6 +112,21 @@ class SplitArrayListWithActionKernel::Impl {
         RETURN_NOT_OK(MakeSumCountMergeAction(ctx_, type_list[type_id], &action));
       } else if (action_name_list_[action_id].compare("action_avgByCount") == 0) {
         RETURN_NOT_OK(MakeAvgByCountAction(ctx_, type_list[type_id], &action));
+      } else if (action_name_list_[action_id].compare(0, 18, "action_avgByCount_") ==
+                 0) {
+        // action_avgByCount_<precision>_<scale> of a decimal average
+        auto args = action_name_list_[action_id].substr(18);
+        auto pos = args.find('_');
+        if (pos == std::string::npos) {
+          return arrow::Status::Invalid(action_name_list_[action_id],
+                                        " expects precision and scale.");
+        }
+        auto res_type =
+            arrow::decimal(std::stoi(args.substr(0, pos)), std::stoi(args.substr(pos + 1)));
+        RETURN_NOT_OK(MakeDecimalAvgByCountAction(ctx_, type_list[type_id], res_type,
+                                                  &action));
+      } else if (action_name_list_[action_id].compare("action_sum_merge") == 0) {
+        RETURN_NOT_OK(MakeSumMergeAction(ctx_, type_list[type_id], &action));
       } else if (action_name_list_[action_id].compare(0, 20, "action_countLiteral_") ==
                  0) {
         int arg = std::stoi(action_name_list_[action_id].substr(20));
@@ -109,6 +136,58 @@ class SplitArrayListWithActionKernel::Impl {
         RETURN_NOT_OK(MakeStddevSampPartialAction(ctx_, type_list[type_id], &action));
       } else if (action_name_list_[action_id].compare("action_stddev_samp_final") == 0) {
         RETURN_NOT_OK(MakeStddevSampFinalAction(ctx_, type_list[type_id], &action));
+      } else if (action_name_list_[action_id].compare(0, 22, "action_count_distinct_") ==
+                 0) {
+        // action_count_distinct_<number of distinct columns>
+        int col_num = std::stoi(action_name_list_[action_id].substr(22));
+        if (type_id + col_num > type_list.size()) {
+          return arrow::Status::Invalid(action_name_list_[action_id], " expects ",
+                                        col_num, " input columns.");
+        }
+        std::vector<std::shared_ptr<arrow::DataType>> distinct_type_list(
+            type_list.begin() + type_id, type_list.begin() + type_id + col_num);
+        RETURN_NOT_OK(MakeCountDistinctAction(ctx_, distinct_type_list, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 37, "action_approx_count_distinct_partial_") == 0) {
+        double relative_sd = std::stod(action_name_list_[action_id].substr(37));
+        RETURN_NOT_OK(MakeApproxCountDistinctPartialAction(ctx_, type_list[type_id],
+                                                           relative_sd, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 35, "action_approx_count_distinct_merge_") == 0) {
+        double relative_sd = std::stod(action_name_list_[action_id].substr(35));
+        RETURN_NOT_OK(MakeApproxCountDistinctMergeAction(ctx_, relative_sd, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 35, "action_approx_count_distinct_final_") == 0) {
+        double relative_sd = std::stod(action_name_list_[action_id].substr(35));
+        RETURN_NOT_OK(MakeApproxCountDistinctFinalAction(ctx_, relative_sd, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 33, "action_percentile_approx_partial_") == 0) {
+        int accuracy = std::stoi(action_name_list_[action_id].substr(33));
+        RETURN_NOT_OK(MakePercentileApproxPartialAction(ctx_, type_list[type_id],
+                                                        accuracy, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 31, "action_percentile_approx_merge_") == 0) {
+        int accuracy = std::stoi(action_name_list_[action_id].substr(31));
+        RETURN_NOT_OK(MakePercentileApproxMergeAction(ctx_, accuracy, &action));
+      } else if (action_name_list_[action_id].compare(
+                     0, 31, "action_percentile_approx_final_") == 0) {
+        // action_percentile_approx_final_<percentage>_<accuracy>[_<type>], type is the
+        // name of the aggregated column's type, double when omitted
+        auto args = action_name_list_[action_id].substr(31);
+        auto pos = args.find('_');
+        if (pos == std::string::npos) {
+          return arrow::Status::Invalid(action_name_list_[action_id],
+                                        " expects percentage and accuracy.");
+        }
+        double percentage = std::stod(args.substr(0, pos));
+        auto type_pos = args.find('_', pos + 1);
+        int accuracy = std::stoi(args.substr(pos + 1, type_pos - pos - 1));
+        std::shared_ptr<arrow::DataType> res_type = arrow::float64();
+        if (type_pos != std::string::npos) {
+          RETURN_NOT_OK(GetNumericType(args.substr(type_pos + 1), &res_type));
+        }
+        RETURN_NOT_OK(MakePercentileApproxFinalAction(ctx_, percentage, accuracy,
+                                                      res_type, &action));
       } else {
         return arrow::Status::NotImplemented(action_name_list_[action_id],
                                              " is not implementetd.");
@@ -149,7 +228,7 @@ class SplitArrayListWithActionKernel::Impl {
       }
       std::function<arrow::Status(int)> func;
       std::function<arrow::Status()> null_func;
-      action->Submit(cols, max_group_id, &func, &null_func);
+      RETURN_NOT_OK(action->Submit(cols, max_group_id, &func, &null_func));
       eval_func_list.push_back(func);
       eval_null_func_list.push_back(null_func);
     }
@@ -157,12 +236,12 @@ class SplitArrayListWithActionKernel::Impl {
     for (int row_id = 0; row_id < in_dict->length(); row_id++) {
       if (in_dict->IsValid(row_id)) {
         auto group_id = typed_in_dict->GetView(row_id);
-        for (auto eval_func : eval_func_list) {
-          eval_func(group_id);
+        for (auto& eval_func : eval_func_list) {
+          RETURN_NOT_OK(eval_func(group_id));
         }
       } else {
-        for (auto eval_func : eval_null_func_list) {
-          eval_func();
+        for (auto& eval_func : eval_null_func_list) {
+          RETURN_NOT_OK(eval_func());
         }
       }
     }
@@ -247,15 +326,16 @@ arrow::Status SplitArrayListWithActionKernel::Make(
     arrow::compute::FunctionContext* ctx, std::vector<std::string> action_name_list,
     std::vector<std::shared_ptr<arrow::DataType>> type_list,
     std::shared_ptr<KernalBase>* out) {
-  *out =
-      std::make_shared<SplitArrayListWithActionKernel>(ctx, action_name_list, type_list);
+  auto kernel = std::make_shared<SplitArrayListWithActionKernel>(ctx, action_name_list);
+  // a malformed action name fails the build instead of leaving the action out
+  RETURN_NOT_OK(kernel->impl_->InitActionList(type_list));
+  *out = kernel;
   return arrow::Status::OK();
 }
 
 SplitArrayListWithActionKernel::SplitArrayListWithActionKernel(
-    arrow::compute::FunctionContext* ctx, std::vector<std::string> action_name_list,
-    std::vector<std::shared_ptr<arrow::DataType>> type_list) {
-  impl_.reset(new Impl(ctx, action_name_list, type_list));
+    arrow::compute::FunctionContext* ctx, std::vector<std::string> action_name_list) {
+  impl_.reset(new Impl(ctx, action_name_list));
   kernel_name_ = "SplitArrayListWithActionKernel";
 }
 
@@ -1278,63 +1358,18 @@ class HashArrayKernel::Impl {
   Impl(arrow::compute::FunctionContext* ctx,
        std::vector<std::shared_ptr<arrow::DataType>> type_list)
       : ctx_(ctx) {
-    // create a new result array type here
-    std::vector<std::shared_ptr<gandiva::Node>> func_node_list = {};
-    std::vector<std::shared_ptr<arrow::Field>> field_list = {};
-
-    gandiva::ExpressionPtr expr;
-    int index = 0;
-    for (auto type : type_list) {
-      auto field = arrow::field(std::to_string(index), type);
-      field_list.push_back(field);
-      auto field_node = gandiva::TreeExprBuilder::MakeField(field);
-      auto func_node =
-          gandiva::TreeExprBuilder::MakeFunction("hash64", {field_node}, arrow::int64());
-      func_node_list.push_back(func_node);
-      if (func_node_list.size() == 2) {
-        auto shift_func_node = gandiva::TreeExprBuilder::MakeFunction(
-            "multiply",
-            {func_node_list[0], gandiva::TreeExprBuilder::MakeLiteral((int64_t)10)},
-            arrow::int64());
-        auto tmp_func_node = gandiva::TreeExprBuilder::MakeFunction(
-            "add", {shift_func_node, func_node_list[1]}, arrow::int64());
-        func_node_list.clear();
-        func_node_list.push_back(tmp_func_node);
-      }
-      index++;
-    }
-    expr = gandiva::TreeExprBuilder::MakeExpression(func_node_list[0],
-                                                    arrow::field("res", arrow::int64()));
-#ifdef DEBUG
-    std::cout << expr->ToString() << std::endl;
-#endif
-    schema_ = arrow::schema(field_list);
-    auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-    auto status = gandiva::Projector::Make(schema_, {expr}, configuration, &projector);
     pool_ = ctx_->memory_pool();
   }
 
   virtual ~Impl() {}
 
   arrow::Status Evaluate(const ArrayList& in, std::shared_ptr<arrow::Array>* out) {
-    auto length = in[0]->length();
-    auto num_columns = in.size();
-
-    auto in_batch = arrow::RecordBatch::Make(schema_, length, in);
-    // arrow::PrettyPrintOptions print_option(2, 500);
-    // arrow::PrettyPrint(*in_batch.get(), print_option, &std::cout);
-
-    arrow::ArrayVector outputs;
-    RETURN_NOT_OK(projector->Evaluate(*in_batch, pool_, &outputs));
-    *out = outputs[0];
-
-    return arrow::Status::OK();
+    // the keys are only grouped by, so they can be hashed with the internal hash
+    return precompile::HashArrays64(in, pool_, out);
   }
 
  private:
   arrow::compute::FunctionContext* ctx_;
-  std::shared_ptr<gandiva::Projector> projector;
-  std::shared_ptr<arrow::Schema> schema_;
   arrow::MemoryPool* pool_;
 };
 
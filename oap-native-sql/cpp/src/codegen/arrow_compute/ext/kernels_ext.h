@@ -86,6 +86,7 @@ class KernalBase {
     return arrow::Status::NotImplemented("MakeResultIterator is abstract interface for ",
                                          kernel_name_);
   }
+  /// Fills *codegen_ctx, a context the caller set beforehand carries its flags in.
   virtual arrow::Status DoCodeGen(int level, std::vector<std::string> input,
                                   std::shared_ptr<CodeGenContext>* codegen_ctx,
                                   int* var_id) {
@@ -103,8 +104,7 @@ class SplitArrayListWithActionKernel : public KernalBase {
                             std::vector<std::shared_ptr<arrow::DataType>> type_list,
                             std::shared_ptr<KernalBase>* out);
   SplitArrayListWithActionKernel(arrow::compute::FunctionContext* ctx,
-                                 std::vector<std::string> action_name_list,
-                                 std::vector<std::shared_ptr<arrow::DataType>> type_list);
+                                 std::vector<std::string> action_name_list);
   arrow::Status Evaluate(const ArrayList& in,
                          const std::shared_ptr<arrow::Array>& dict) override;
   arrow::Status Finish(ArrayList* out) override;
@@ -551,6 +551,59 @@ class ConcatArrayListKernel : public KernalBase {
   std::unique_ptr<Impl> impl_;
   arrow::compute::FunctionContext* ctx_;
 };
+class CoalesceBatchesKernel : public KernalBase {
+ public:
+  static arrow::Status Make(
+      arrow::compute::FunctionContext* ctx,
+      const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+      std::shared_ptr<gandiva::Node> root_node,
+      const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
+      std::shared_ptr<KernalBase>* out);
+  CoalesceBatchesKernel(
+      arrow::compute::FunctionContext* ctx,
+      const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+      std::shared_ptr<gandiva::Node> root_node,
+      const std::vector<std::shared_ptr<arrow::Field>>& output_field_list);
+  arrow::Status Evaluate(const ArrayList& in) override;
+  arrow::Status MakeResultIterator(
+      std::shared_ptr<arrow::Schema> schema,
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) override;
+
+  class Impl;
+
+ private:
+  std::unique_ptr<Impl> impl_;
+  arrow::compute::FunctionContext* ctx_;
+};
+class ExpandKernel : public KernalBase {
+ public:
+  static arrow::Status Make(
+      arrow::compute::FunctionContext* ctx,
+      const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+      std::shared_ptr<gandiva::Node> root_node,
+      const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
+      std::shared_ptr<KernalBase>* out);
+  static arrow::Status Make(arrow::compute::FunctionContext* ctx,
+                            const gandiva::NodeVector& input_field_node_list,
+                            const std::vector<gandiva::NodeVector>& projection_list,
+                            std::shared_ptr<KernalBase>* out);
+  ExpandKernel(arrow::compute::FunctionContext* ctx,
+               const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+               const std::vector<gandiva::NodeVector>& projection_list);
+  arrow::Status Evaluate(const ArrayList& in) override;
+  arrow::Status MakeResultIterator(
+      std::shared_ptr<arrow::Schema> schema,
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) override;
+  arrow::Status DoCodeGen(int level, std::vector<std::string> input,
+                          std::shared_ptr<CodeGenContext>* codegen_ctx,
+                          int* var_id) override;
+  std::string GetSignature() override;
+  class Impl;
+
+ private:
+  std::unique_ptr<Impl> impl_;
+  arrow::compute::FunctionContext* ctx_;
+};
 class ConditionedProbeKernel : public KernalBase {
  public:
   static arrow::Status Make(arrow::compute::FunctionContext* ctx,
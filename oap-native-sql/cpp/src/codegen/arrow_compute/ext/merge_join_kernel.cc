@@ -198,7 +198,7 @@ class ConditionedJoinArraysKernel::Impl {
     signature_ss << std::hex << std::hash<std::string>{}(func_args_ss.str());
     signature_ = signature_ss.str();
 
-    auto file_lock = FileSpinLock();
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, out);
     if (!status.ok()) {
       // process
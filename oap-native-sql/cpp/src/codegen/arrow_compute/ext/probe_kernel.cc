@@ -43,6 +43,7 @@
 #include "codegen/arrow_compute/ext/codegen_node_visitor.h"
 #include "codegen/arrow_compute/ext/codegen_register.h"
 #include "codegen/arrow_compute/ext/kernels_ext.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 namespace sparkcolumnarplugin {
@@ -252,7 +253,7 @@ class ConditionedProbeArraysKernel::Impl {
     signature_ss << std::hex << std::hash<std::string>{}(func_args_ss.str());
     signature_ = signature_ss.str();
 
-    auto file_lock = FileSpinLock();
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, out);
     if (!status.ok()) {
       // process
@@ -875,15 +876,15 @@ class ConditionedProbeArraysKernel::Impl {
     if (!left_project_node_list.empty()) {
       auto schema = arrow::schema(left_field_list);
       auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-      auto status = gandiva::Projector::Make(schema, left_project_node_list,
-                                             configuration, &left_projector_);
+      auto status = GandivaRegistry::Get()->MakeProjector(
+          schema, left_project_node_list, configuration, &left_projector_);
     }
 
     if (!right_project_node_list.empty()) {
       auto schema = arrow::schema(right_field_list);
       auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-      auto status = gandiva::Projector::Make(schema, right_project_node_list,
-                                             configuration, &right_projector_);
+      auto status = GandivaRegistry::Get()->MakeProjector(
+          schema, right_project_node_list, configuration, &right_projector_);
     }
 
     return R"(
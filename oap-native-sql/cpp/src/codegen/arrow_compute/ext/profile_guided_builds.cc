@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/arrow_compute/ext/profile_guided_builds.h"
+
+#include <iostream>
+#include <thread>
+
+#include "codegen/arrow_compute/ext/code_store.h"
+#include "codegen/arrow_compute/ext/codegen_common.h"
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+ProfileGuidedBuilds* ProfileGuidedBuilds::Get() {
+  // never destroyed, background builds may still run when the executor exits
+  static auto instance = new ProfileGuidedBuilds(GetProfileGuidedThresholdMillis());
+  return instance;
+}
+
+ProfileGuidedBuilds::State ProfileGuidedBuilds::GetState(const std::string& signature) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = entries_.find(signature);
+  return it == entries_.end() ? State::kPlain : it->second.state;
+}
+
+std::string ProfileGuidedBuilds::GetSignature(const std::string& signature) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = entries_.find(signature);
+  if (it == entries_.end() || it->second.state != State::kOptimised) {
+    return signature;
+  }
+  return OptimisedSignature(signature, it->second.generation);
+}
+
+void ProfileGuidedBuilds::AddRunTime(const std::string& signature,
+                                     const std::string& codes, int64_t nanos) {
+  if (!enabled()) return;
+  int generation;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& entry = entries_[signature];
+    if (entry.state != State::kPlain) return;
+    entry.run_nanos += nanos;
+    if (entry.run_nanos < threshold_nanos_) return;
+    entry.state = State::kInstrumenting;
+    generation = ++entry.generation;
+  }
+  StartBuild(signature, codes, generation, true);
+}
+
+bool ProfileGuidedBuilds::ClaimInstrumented(const std::string& signature,
+                                            std::string* instrumented) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = entries_.find(signature);
+  if (it == entries_.end() || it->second.state != State::kInstrumented) {
+    return false;
+  }
+  it->second.state = State::kProfiling;
+  *instrumented = InstrumentedSignature(signature, it->second.generation);
+  return true;
+}
+
+void ProfileGuidedBuilds::FinishProfiling(const std::string& signature,
+                                          const std::string& codes,
+                                          int64_t profiled_batches) {
+  int generation;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& entry = entries_[signature];
+    if (entry.state != State::kProfiling) return;
+    if (profiled_batches == 0) {
+      entry.state = State::kInstrumented;
+      return;
+    }
+    entry.state = State::kOptimising;
+    generation = entry.generation;
+  }
+  auto status = dump_profile_(InstrumentedSignature(signature, generation));
+  if (!status.ok()) {
+    std::cout << "profiling " << signature << " failed: " << status.ToString()
+              << std::endl;
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_[signature].state = State::kFailed;
+    return;
+  }
+  StartBuild(signature, codes, generation, false);
+}
+
+void ProfileGuidedBuilds::MarkFailed(const std::string& signature) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  entries_[signature].state = State::kFailed;
+}
+
+arrow::Status ProfileGuidedBuilds::CompileBuild(const std::string& codes,
+                                                const std::string& build_signature,
+                                                bool instrumented,
+                                                const std::string& profile_key) {
+  auto profile_build = instrumented ? ProfileBuild::kGenerate : ProfileBuild::kUse;
+  // the source, object and profile are files of profile_key, shared by both builds
+  auto store = CodeStore::Get();
+  auto file_locks = store->Lock({build_signature, profile_key});
+  arrow::Status status;
+  try {
+    status = CompileCodes(codes, build_signature, profile_build, profile_key);
+  } catch (const std::exception& e) {
+    status = arrow::Status::Invalid(e.what());
+  }
+  for (auto fd : file_locks) {
+    store->Unlock(fd);
+  }
+  return status;
+}
+
+arrow::Status ProfileGuidedBuilds::DumpProfile(
+    const std::string& instrumented_signature) {
+  return DumpLibraryProfile(instrumented_signature);
+}
+
+void ProfileGuidedBuilds::StartBuild(const std::string& signature,
+                                     const std::string& codes, int generation,
+                                     bool instrumented) {
+  std::thread([this, signature, codes, generation, instrumented] {
+    auto build_signature = instrumented ? InstrumentedSignature(signature, generation)
+                                        : OptimisedSignature(signature, generation);
+    auto status = compile_(codes, build_signature, instrumented,
+                           OptimisedSignature(signature, generation));
+#ifdef DEBUG
+    std::cout << "profile build " << build_signature << ": " << status.ToString()
+              << std::endl;
+#endif
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& entry = entries_[signature];
+    if (!status.ok()) {
+      entry.state = State::kFailed;
+    } else {
+      entry.state = instrumented ? State::kInstrumented : State::kOptimised;
+    }
+  }).detach();
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+/**
+ * Executor wide state of the profile guided builds of generated kernels, keyed by the
+ * signature of their plain build. Once the tasks running a kernel spent
+ * NATIVESQL_PGO_THRESHOLD_MS in it, an instrumented build is compiled in the
+ * background. One task then runs it for GetProfileBatches() batches, and the build
+ * optimised with the gathered profile is compiled in the background in turn. Each
+ * profile round is a new generation, its builds get their own signatures, so the
+ * loaded library cache and later tasks tell them apart from the plain build.
+ */
+class ProfileGuidedBuilds {
+ public:
+  enum class State {
+    kPlain,
+    kInstrumenting,
+    kInstrumented,
+    kProfiling,
+    kOptimising,
+    kOptimised,
+    kFailed
+  };
+
+  /// Compiles codes into the library of build_signature, generating the profile of
+  /// profile_key when instrumented, or using it otherwise.
+  using CompileFunction = std::function<arrow::Status(
+      const std::string& codes, const std::string& build_signature, bool instrumented,
+      const std::string& profile_key)>;
+  /// Writes the profile gathered by the loaded instrumented build.
+  using DumpProfileFunction =
+      std::function<arrow::Status(const std::string& instrumented_signature)>;
+
+  explicit ProfileGuidedBuilds(int64_t threshold_millis,
+                               CompileFunction compile = CompileBuild,
+                               DumpProfileFunction dump_profile = DumpProfile)
+      : threshold_nanos_(threshold_millis * 1000000),
+        compile_(std::move(compile)),
+        dump_profile_(std::move(dump_profile)) {}
+
+  /// Instance of the executor, configured by NATIVESQL_PGO_THRESHOLD_MS.
+  static ProfileGuidedBuilds* Get();
+
+  static std::string InstrumentedSignature(const std::string& signature,
+                                           int generation) {
+    return signature + "-pgo" + std::to_string(generation) + "-instrumented";
+  }
+
+  static std::string OptimisedSignature(const std::string& signature, int generation) {
+    return signature + "-pgo" + std::to_string(generation);
+  }
+
+  bool enabled() const { return threshold_nanos_ > 0; }
+
+  State GetState(const std::string& signature);
+
+  /// The signature a new task should load, the optimised build once there is one.
+  std::string GetSignature(const std::string& signature);
+
+  /// Adds time a task spent in the plain build. The call crossing the threshold starts
+  /// the instrumented build of codes.
+  void AddRunTime(const std::string& signature, const std::string& codes,
+                  int64_t nanos);
+
+  /// Lets one task run the instrumented build, returns false to the others. The
+  /// claiming task gets the signature to load.
+  bool ClaimInstrumented(const std::string& signature, std::string* instrumented);
+
+  /// Called by the claiming task: dumps the profile and starts the optimised build, or
+  /// hands the instrumented build to another task when no batch was profiled.
+  void FinishProfiling(const std::string& signature, const std::string& codes,
+                       int64_t profiled_batches);
+
+  /// Called by a task which could not load a build, the kernel stays on the plain
+  /// build from then on.
+  void MarkFailed(const std::string& signature);
+
+ private:
+  struct Entry {
+    State state = State::kPlain;
+    int64_t run_nanos = 0;
+    int generation = 0;
+  };
+
+  static arrow::Status CompileBuild(const std::string& codes,
+                                    const std::string& build_signature,
+                                    bool instrumented, const std::string& profile_key);
+  static arrow::Status DumpProfile(const std::string& instrumented_signature);
+
+  void StartBuild(const std::string& signature, const std::string& codes,
+                  int generation, bool instrumented);
+
+  const int64_t threshold_nanos_;
+  const CompileFunction compile_;
+  const DumpProfileFunction dump_profile_;
+  std::mutex mtx_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
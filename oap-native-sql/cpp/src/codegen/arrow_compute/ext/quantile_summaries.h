@@ -0,0 +1,295 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+/// Greenwald-Khanna quantile summary, a port of Spark's QuantileSummaries used by
+/// percentile_approx. Serialize/Deserialize use the same big-endian layout as
+/// Spark's PercentileDigestSerializer, so the state is a single binary column.
+class QuantileSummaries {
+ public:
+  struct Stats {
+    double value;
+    int64_t g;
+    int64_t delta;
+  };
+
+  static const int kDefaultCompressThreshold = 10000;
+  static const int kDefaultHeadSize = 50000;
+  // compress threshold, relative error, count and number of samples
+  static const int kHeaderSize = 4 + 8 + 8 + 4;
+  // value, g and delta of a sample
+  static const int kStatsSize = 24;
+
+  QuantileSummaries(double relative_error,
+                    int compress_threshold = kDefaultCompressThreshold)
+      : compress_threshold_(compress_threshold), relative_error_(relative_error) {}
+
+  int64_t count() const { return count_ + head_sampled_.size(); }
+
+  void Insert(double x) {
+    head_sampled_.push_back(x);
+    compressed_ = false;
+    if (head_sampled_.size() >= kDefaultHeadSize) {
+      InsertHeadBuffer();
+      if (static_cast<int>(sampled_.size()) >= compress_threshold_) {
+        Compress();
+      }
+    }
+  }
+
+  void Compress() {
+    InsertHeadBuffer();
+    sampled_ = CompressImmut(sampled_, 2 * relative_error_ * count_);
+    compressed_ = true;
+  }
+
+  void Merge(QuantileSummaries& other) {
+    Compress();
+    other.Compress();
+    if (other.count_ == 0) {
+      return;
+    }
+    if (count_ == 0) {
+      sampled_ = other.sampled_;
+      count_ = other.count_;
+      return;
+    }
+    std::vector<Stats> merged;
+    merged.reserve(sampled_.size() + other.sampled_.size());
+    std::merge(sampled_.begin(), sampled_.end(), other.sampled_.begin(),
+               other.sampled_.end(), std::back_inserter(merged),
+               [](const Stats& l, const Stats& r) { return l.value < r.value; });
+    count_ += other.count_;
+    sampled_ = CompressImmut(merged, 2 * relative_error_ * count_);
+    compressed_ = true;
+  }
+
+  /// Returns false when the summary is empty.
+  bool Query(double quantile, double* out) {
+    if (!compressed_) {
+      Compress();
+    }
+    if (sampled_.empty()) {
+      return false;
+    }
+    if (quantile <= relative_error_) {
+      *out = sampled_.front().value;
+      return true;
+    }
+    if (quantile >= 1 - relative_error_) {
+      *out = sampled_.back().value;
+      return true;
+    }
+    int64_t rank = static_cast<int64_t>(ceil(quantile * count_));
+    int64_t target_error = 0;
+    for (const auto& stats : sampled_) {
+      target_error = std::max(target_error, stats.delta + stats.g);
+    }
+    target_error /= 2;
+    int64_t min_rank = 0;
+    for (size_t i = 0; i + 1 < sampled_.size(); i++) {
+      const auto& cur = sampled_[i];
+      min_rank += cur.g;
+      int64_t max_rank = min_rank + cur.delta;
+      if (max_rank - target_error <= rank && rank <= min_rank + target_error) {
+        *out = cur.value;
+        return true;
+      }
+    }
+    *out = sampled_.back().value;
+    return true;
+  }
+
+  void Serialize(std::string* out) {
+    if (!compressed_) {
+      Compress();
+    }
+    out->clear();
+    out->reserve(kHeaderSize + sampled_.size() * kStatsSize);
+    PutInt(out, compress_threshold_);
+    PutLong(out, DoubleToBits(relative_error_));
+    PutLong(out, count_);
+    PutInt(out, static_cast<int32_t>(sampled_.size()));
+    for (const auto& stats : sampled_) {
+      PutLong(out, DoubleToBits(stats.value));
+      PutLong(out, stats.g);
+      PutLong(out, stats.delta);
+    }
+  }
+
+  /// Reads a state written by Serialize, the state is rejected unless its length is
+  /// exactly the one its header announces.
+  static arrow::Status Deserialize(const uint8_t* data, int32_t length,
+                                   QuantileSummaries* out) {
+    if (length < kHeaderSize) {
+      return arrow::Status::Invalid("QuantileSummaries state of ", length,
+                                    " bytes is shorter than its header");
+    }
+    const uint8_t* p = data;
+    int32_t compress_threshold = GetInt(&p);
+    double relative_error = BitsToDouble(GetLong(&p));
+    int64_t count = GetLong(&p);
+    int32_t num_sampled = GetInt(&p);
+    if (num_sampled < 0 ||
+        static_cast<int64_t>(num_sampled) * kStatsSize != length - kHeaderSize) {
+      return arrow::Status::Invalid("QuantileSummaries state of ", length,
+                                    " bytes doesn't hold ", num_sampled, " samples");
+    }
+    QuantileSummaries res(relative_error, compress_threshold);
+    res.count_ = count;
+    res.sampled_.resize(num_sampled);
+    for (int32_t i = 0; i < num_sampled; i++) {
+      res.sampled_[i].value = BitsToDouble(GetLong(&p));
+      res.sampled_[i].g = GetLong(&p);
+      res.sampled_[i].delta = GetLong(&p);
+    }
+    res.compressed_ = true;
+    *out = std::move(res);
+    return arrow::Status::OK();
+  }
+
+ private:
+  int compress_threshold_;
+  double relative_error_;
+  int64_t count_ = 0;
+  bool compressed_ = false;
+  std::vector<Stats> sampled_;
+  std::vector<double> head_sampled_;
+
+  void InsertHeadBuffer() {
+    if (head_sampled_.empty()) {
+      return;
+    }
+    int64_t current_count = count_;
+    std::sort(head_sampled_.begin(), head_sampled_.end());
+    std::vector<Stats> new_samples;
+    new_samples.reserve(sampled_.size() + head_sampled_.size());
+    size_t sample_idx = 0;
+    for (size_t ops_idx = 0; ops_idx < head_sampled_.size(); ops_idx++) {
+      double current_sample = head_sampled_[ops_idx];
+      while (sample_idx < sampled_.size() &&
+             sampled_[sample_idx].value <= current_sample) {
+        new_samples.push_back(sampled_[sample_idx++]);
+      }
+      current_count++;
+      int64_t delta = 0;
+      if (!new_samples.empty() &&
+          !(sample_idx == sampled_.size() && ops_idx == head_sampled_.size() - 1)) {
+        delta = static_cast<int64_t>(floor(2 * relative_error_ * current_count));
+      }
+      new_samples.push_back({current_sample, 1, delta});
+    }
+    while (sample_idx < sampled_.size()) {
+      new_samples.push_back(sampled_[sample_idx++]);
+    }
+    sampled_.swap(new_samples);
+    count_ = current_count;
+    head_sampled_.clear();
+  }
+
+  static std::vector<Stats> CompressImmut(const std::vector<Stats>& current,
+                                          double merge_threshold) {
+    std::vector<Stats> res;
+    if (current.empty()) {
+      return res;
+    }
+    // built back to front, reversed at the end
+    Stats head = current.back();
+    for (int64_t i = static_cast<int64_t>(current.size()) - 2; i >= 1; i--) {
+      const auto& sample1 = current[i];
+      if (sample1.g + head.g + head.delta < merge_threshold) {
+        head.g += sample1.g;
+      } else {
+        res.push_back(head);
+        head = sample1;
+      }
+    }
+    res.push_back(head);
+    const auto& curr_head = current.front();
+    if (curr_head.value <= head.value && current.size() > 1) {
+      res.push_back(curr_head);
+    }
+    std::reverse(res.begin(), res.end());
+    return res;
+  }
+
+  static int64_t DoubleToBits(double v) {
+    int64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+  }
+
+  static double BitsToDouble(int64_t bits) {
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+
+  static void PutInt(std::string* out, int32_t v) {
+    uint32_t u = static_cast<uint32_t>(v);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      out->push_back(static_cast<char>((u >> shift) & 0xFF));
+    }
+  }
+
+  static void PutLong(std::string* out, int64_t v) {
+    uint64_t u = static_cast<uint64_t>(v);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      out->push_back(static_cast<char>((u >> shift) & 0xFF));
+    }
+  }
+
+  static int32_t GetInt(const uint8_t** p) {
+    uint32_t u = 0;
+    for (int i = 0; i < 4; i++) {
+      u = (u << 8) | (*p)[i];
+    }
+    *p += 4;
+    return static_cast<int32_t>(u);
+  }
+
+  static int64_t GetLong(const uint8_t** p) {
+    uint64_t u = 0;
+    for (int i = 0; i < 8; i++) {
+      u = (u << 8) | (*p)[i];
+    }
+    *p += 8;
+    return static_cast<int64_t>(u);
+  }
+};
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
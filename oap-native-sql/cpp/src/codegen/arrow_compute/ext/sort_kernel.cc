@@ -38,8 +38,10 @@
 #include "codegen/arrow_compute/ext/typed_node_visitor.h"
 #include "third_party/ska_sort.hpp"
 #include "precompile/array.h"
+#include "precompile/batch_sizer.h"
 #include "precompile/type.h"
 #include "array_appender.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 /**
@@ -135,7 +137,7 @@ class SortArraysToIndicesKernel::Impl {
     signature_ss << std::hex << std::hash<std::string>{}(func_args_ss.str());
     signature_ = signature_ss.str();
 
-    auto file_lock = FileSpinLock();
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, &sorter);
     if (!status.ok()) {
       // process
@@ -290,6 +292,7 @@ class SortArraysToIndicesKernel::Impl {
 #include <algorithm>
 
 #include "codegen/arrow_compute/ext/array_item_index.h"
+#include "precompile/batch_sizer.h"
 #include "precompile/builder.h"
 #include "precompile/type.h"
 #include "third_party/ska_sort.hpp"
@@ -370,6 +373,7 @@ class TypedSorterImpl : public CodeGenBase {
      )" + result_iter_define_str +
            R"(
       indices_begin_ = (ArrayItemIndex*)indices_in->value_data();
+      batch_sizer_.Estimate(*result_schema_);
     }
 
     std::string ToString() override { return "SortArraysToIndicesResultIterator"; }
@@ -382,9 +386,9 @@ class TypedSorterImpl : public CodeGenBase {
     }
 
     arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) {
-      auto length = (total_length_ - offset_) > )" +
-           std::to_string(GetBatchSize()) + R"( ? )" + std::to_string(GetBatchSize()) +
-           R"( : (total_length_ - offset_);
+      uint64_t batch_size = batch_sizer_.NextRows();
+      auto length = (total_length_ - offset_) > batch_size ? batch_size
+                                                           : (total_length_ - offset_);
       uint64_t count = 0;
       while (count < length) {
         auto item = indices_begin_ + offset_ + count++;
@@ -396,12 +400,16 @@ class TypedSorterImpl : public CodeGenBase {
            R"(
       *out = arrow::RecordBatch::Make(result_schema_, length, {)" +
            typed_res_array_str + R"(});
+      batch_sizer_.Observe(**out);
       return arrow::Status::OK();
     }
 
    private:
    )" + result_variables_define_str +
            R"(
+    BatchSizer batch_sizer_{)" +
+           std::to_string(GetBatchSize()) + ", " + std::to_string(GetBatchBytes()) +
+           ", " + std::to_string(GetBatchMaxRows()) + R"(};
     std::shared_ptr<FixedSizeBinaryArray> indices_in_cache_;
     uint64_t offset_ = 0;
     ArrayItemIndex* indices_begin_;
@@ -478,9 +486,9 @@ extern "C" void MakeCodeGen(arrow::compute::FunctionContext* ctx,
     }
 
     auto x_num_value = array + std::to_string(cur_key_id) + "_[x.array_id]->GetView(x.id)";
-    auto x_str_value = array + std::to_string(cur_key_id) + "_[x.array_id]->GetString(x.id)";
+    auto x_str_value = array + std::to_string(cur_key_id) + "_[x.array_id]->GetView(x.id)";
     auto y_num_value = array + std::to_string(cur_key_id) + "_[y.array_id]->GetView(y.id)";
-    auto y_str_value = array + std::to_string(cur_key_id) + "_[y.array_id]->GetString(y.id)";
+    auto y_str_value = array + std::to_string(cur_key_id) + "_[y.array_id]->GetView(y.id)";
     auto is_x_null = array + std::to_string(cur_key_id) + "_[x.array_id]->IsNull(x.id)";
     auto is_y_null = array + std::to_string(cur_key_id) + "_[y.array_id]->IsNull(y.id)";
 
@@ -506,7 +514,7 @@ extern "C" void MakeCodeGen(arrow::compute::FunctionContext* ctx,
     ss << " else {\n";
 
     // Multiple keys sorting w/ different ordering is supported.
-    // For string type of data, GetString should be used instead of GetView.
+    // For string type of data, views are compared directly without copying.
     if (asc) {
       if (data_type->id() == arrow::Type::STRING) {
         ss << "return " << x_str_value << " < " << y_str_value << ";\n}\n";
@@ -793,7 +801,7 @@ class SortInplaceKernel : public SortArraysToIndicesKernel::Impl {
       arrow::MakeBuilder(ctx_->memory_pool(), data_type_0, &builder_0);
       builder_0_.reset(
           arrow::internal::checked_cast<BuilderType_0*>(builder_0.release()));
-      batch_size_ = GetBatchSize();
+      batch_sizer_.Estimate(*result_schema_);
     }
 
     std::string ToString() override { return "SortArraysToIndicesResultIterator"; }
@@ -806,7 +814,8 @@ class SortInplaceKernel : public SortArraysToIndicesKernel::Impl {
     }
 
     arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) {
-      auto length = (total_length_ - total_offset_) > batch_size_ ? batch_size_
+      uint64_t batch_size = batch_sizer_.NextRows();
+      auto length = (total_length_ - total_offset_) > batch_size ? batch_size
                                                             : (total_length_ - total_offset_);
       /**
        * Here we take value from the sorted result_arr_ and append to builder.
@@ -855,6 +864,7 @@ class SortInplaceKernel : public SortArraysToIndicesKernel::Impl {
       builder_0_->Reset();
 
       *out = arrow::RecordBatch::Make(result_schema_, length, {out_0});
+      batch_sizer_.Observe(**out);
       return arrow::Status::OK();
     }
 
@@ -872,7 +882,8 @@ class SortInplaceKernel : public SortArraysToIndicesKernel::Impl {
     const uint64_t nulls_total_;
     std::shared_ptr<arrow::Schema> result_schema_;
     arrow::compute::FunctionContext* ctx_;
-    uint64_t batch_size_;
+    precompile::BatchSizer batch_sizer_{GetBatchSize(), GetBatchBytes(),
+                                        GetBatchMaxRows()};
   };
 };
 
@@ -1051,7 +1062,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_number<CTYPE>>
           appender_list_[i]->AddArray(arr);
         }
       }
-      batch_size_ = GetBatchSize();
+      batch_sizer_.Estimate(*schema_);
     }
     ~SorterResultIterator(){}
 
@@ -1065,8 +1076,9 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_number<CTYPE>>
     }
 
     arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) {
-      auto length = (total_length_ - offset_) > batch_size_ ? batch_size_
-                                                            : (total_length_ - offset_);
+      uint64_t batch_size = batch_sizer_.NextRows();
+      auto length = (total_length_ - offset_) > batch_size ? batch_size
+                                                           : (total_length_ - offset_);
       uint64_t count = 0;
       for (int i = 0; i < col_num_; i++) {
         while (count < length) {
@@ -1085,6 +1097,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_number<CTYPE>>
       }
 
       *out = arrow::RecordBatch::Make(schema_, length, arrays);
+      batch_sizer_.Observe(**out);
       return arrow::Status::OK();
     }
 
@@ -1093,7 +1106,8 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_number<CTYPE>>
     const uint64_t total_length_;
     std::shared_ptr<arrow::Schema> schema_;
     arrow::compute::FunctionContext* ctx_;
-    uint64_t batch_size_;
+    precompile::BatchSizer batch_sizer_{GetBatchSize(), GetBatchBytes(),
+                                        GetBatchMaxRows()};
     int col_num_;
     ArrayItemIndex* indices_begin_;
     std::vector<arrow::ArrayVector> cached_in_;
@@ -1200,7 +1214,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
     }
     if (asc_) {
       auto comp = [this](ArrayItemIndex x, ArrayItemIndex y) {
-        return cached_key_[x.array_id]->GetString(x.id) < cached_key_[y.array_id]->GetString(y.id);};
+        return cached_key_[x.array_id]->GetView(x.id) < cached_key_[y.array_id]->GetView(y.id);};
       if (nulls_first_) {
         std::sort(indices_begin + nulls_total_, indices_begin + items_total_, comp);
       } else {
@@ -1208,7 +1222,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
       }
     } else {
       auto comp = [this](ArrayItemIndex x, ArrayItemIndex y) {
-        return cached_key_[x.array_id]->GetString(x.id) > cached_key_[y.array_id]->GetString(y.id);};
+        return cached_key_[x.array_id]->GetView(x.id) > cached_key_[y.array_id]->GetView(y.id);};
       if (nulls_first_) {
         std::sort(indices_begin + nulls_total_, indices_begin + items_total_, comp);
       } else {
@@ -1275,7 +1289,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
           appender_list_[i]->AddArray(arr);
         }
       }
-      batch_size_ = GetBatchSize();
+      batch_sizer_.Estimate(*schema_);
     }
 
     std::string ToString() override { return "SortArraysToIndicesResultIterator"; }
@@ -1288,8 +1302,9 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
     }
 
     arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) {
-      auto length = (total_length_ - offset_) > batch_size_ ? batch_size_
-                                                            : (total_length_ - offset_);
+      uint64_t batch_size = batch_sizer_.NextRows();
+      auto length = (total_length_ - offset_) > batch_size ? batch_size
+                                                           : (total_length_ - offset_);
       uint64_t count = 0;
       for (int i = 0; i < col_num_; i++) {
         while (count < length) {
@@ -1308,6 +1323,7 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
       }
 
       *out = arrow::RecordBatch::Make(schema_, length, arrays);
+      batch_sizer_.Observe(**out);
       return arrow::Status::OK();
     }
 
@@ -1316,7 +1332,8 @@ class SortOnekeyKernel<DATATYPE, CTYPE, enable_if_string<CTYPE>>
     const uint64_t total_length_;
     std::shared_ptr<arrow::Schema> schema_;
     arrow::compute::FunctionContext* ctx_;
-    uint64_t batch_size_;
+    precompile::BatchSizer batch_sizer_{GetBatchSize(), GetBatchBytes(),
+                                        GetBatchMaxRows()};
     int col_num_;
     ArrayItemIndex* indices_begin_;
     std::vector<arrow::ArrayVector> cached_in_;
@@ -1377,8 +1394,8 @@ SortArraysToIndicesKernel::SortArraysToIndicesKernel(
   if (pre_processed_key_) {
     key_project_exprs = GetGandivaKernel(sort_key_node);
     auto configuration = gandiva::ConfigurationBuilder().DefaultConfiguration();
-    THROW_NOT_OK(gandiva::Projector::Make(result_schema, key_project_exprs,
-                                          configuration, &key_projector));
+    THROW_NOT_OK(GandivaRegistry::Get()->MakeProjector(result_schema, key_project_exprs,
+                                                       configuration, &key_projector));
     for (const auto& expr : key_project_exprs) {
       auto key_type = expr->root()->return_type();
       projected_types.push_back(key_type);
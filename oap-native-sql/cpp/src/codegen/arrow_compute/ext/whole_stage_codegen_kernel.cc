@@ -16,6 +16,7 @@
  */
 
 #include <arrow/array.h>
+#include <arrow/array/concatenate.h>
 #include <arrow/compute/context.h>
 #include <arrow/pretty_print.h>
 #include <arrow/status.h>
@@ -26,13 +27,19 @@
 #include <gandiva/projector.h>
 
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include "codegen/arrow_compute/ext/codegen_common.h"
 #include "codegen/arrow_compute/ext/kernels_ext.h"
+#include "codegen/arrow_compute/ext/profile_guided_builds.h"
 #include "codegen/common/hash_relation.h"
 #include "utils/macros.h"
 //#include "codegen/arrow_compute/ext/codegen_node_visitor.h"
@@ -44,6 +51,313 @@ namespace extra {
 
 using ArrayList = std::vector<std::shared_ptr<arrow::Array>>;
 
+/// Small worker pool owned by one task. RunAll() runs the first task on the calling
+/// thread and the others on the workers, and returns once all of them are done. The
+/// workers allocate from the task's pool, whose JNI listener attaches them to the JVM.
+class MorselWorkerPool {
+ public:
+  explicit MorselWorkerPool(int num_workers) {
+    for (int i = 0; i < num_workers; i++) {
+      workers_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+
+  ~MorselWorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    task_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  arrow::Status RunAll(const std::vector<std::function<arrow::Status()>>& tasks) {
+    std::vector<arrow::Status> status_list(tasks.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int i = 1; i < tasks.size(); i++) {
+        queue_.push_back([&tasks, &status_list, i] { status_list[i] = Run(tasks[i]); });
+      }
+      pending_ += tasks.size() - 1;
+    }
+    task_cv_.notify_all();
+    status_list[0] = Run(tasks[0]);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_cv_.wait(lock, [this] { return pending_ == 0; });
+    }
+    for (auto& status : status_list) {
+      RETURN_NOT_OK(status);
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  // generated codes report failures by throwing
+  static arrow::Status Run(const std::function<arrow::Status()>& task) {
+    try {
+      return task();
+    } catch (const std::exception& e) {
+      return arrow::Status::Invalid("WholeStageCodeGen morsel failed: ", e.what());
+    }
+  }
+
+  void WorkerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_--;
+      }
+      done_cv_.notify_all();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> queue_;
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  int pending_ = 0;
+  bool stopped_ = false;
+};
+
+/// Runs one WSCG pipeline over morsels of each input batch in parallel. Every worker
+/// has its own instance of the generated iterator, the hash relations it probes are
+/// shared read only. The outputs are concatenated in morsel order, so the rows come
+/// out in the same order as with a single thread.
+class MorselResultIterator : public ResultIterator<arrow::RecordBatch> {
+ public:
+  MorselResultIterator(
+      arrow::compute::FunctionContext* ctx, std::shared_ptr<arrow::Schema> result_schema,
+      std::vector<std::shared_ptr<ResultIterator<arrow::RecordBatch>>> iter_list,
+      int morsel_rows)
+      : ctx_(ctx),
+        result_schema_(std::move(result_schema)),
+        iter_list_(std::move(iter_list)),
+        morsel_rows_(morsel_rows),
+        worker_pool_(new MorselWorkerPool(iter_list_.size() - 1)) {}
+
+  arrow::Status SetDependencies(
+      const std::vector<std::shared_ptr<ResultIteratorBase>>& dependent_iter_list)
+      override {
+    for (auto iter : iter_list_) {
+      RETURN_NOT_OK(iter->SetDependencies(dependent_iter_list));
+    }
+    return arrow::Status::OK();
+  }
+
+  /// Morsels would all run to completion before the budget is checked, so under a
+  /// LIMIT the first iterator takes every batch alone, the others are dropped and the
+  /// workers joined.
+  arrow::Status SetRowBudget(int64_t rows) override {
+    if (rows >= 0) {
+      iter_list_.resize(1);
+      worker_pool_.reset();
+    }
+    return iter_list_[0]->SetRowBudget(rows);
+  }
+
+  bool BudgetExhausted() override { return iter_list_[0]->BudgetExhausted(); }
+
+  arrow::Status Process(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                        std::shared_ptr<arrow::RecordBatch>* out,
+                        const std::shared_ptr<arrow::Array>& selection = nullptr)
+      override {
+    int64_t length = in.empty() ? 0 : in[0]->length();
+    int64_t num_morsels = std::min(static_cast<int64_t>(iter_list_.size()),
+                                   (length + morsel_rows_ - 1) / morsel_rows_);
+    if (num_morsels <= 1 || selection != nullptr) {
+      return iter_list_[0]->Process(in, out, selection);
+    }
+    int64_t morsel_length = (length + num_morsels - 1) / num_morsels;
+    num_morsels = (length + morsel_length - 1) / morsel_length;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> morsel_out(num_morsels);
+    std::vector<std::function<arrow::Status()>> tasks;
+    for (int64_t i = 0; i < num_morsels; i++) {
+      ArrayList morsel_in;
+      for (auto array : in) {
+        morsel_in.push_back(array->Slice(i * morsel_length, morsel_length));
+      }
+      auto iter = iter_list_[i];
+      auto morsel_result = &morsel_out[i];
+      tasks.push_back([iter, morsel_in, morsel_result] {
+        return iter->Process(morsel_in, morsel_result);
+      });
+    }
+    RETURN_NOT_OK(worker_pool_->RunAll(tasks));
+
+    int64_t out_length = 0;
+    for (auto batch : morsel_out) {
+      out_length += batch->num_rows();
+    }
+    ArrayList out_arrays;
+    for (int col = 0; col < result_schema_->num_fields(); col++) {
+      ArrayList to_concat;
+      for (auto batch : morsel_out) {
+        to_concat.push_back(batch->column(col));
+      }
+      std::shared_ptr<arrow::Array> concatenated;
+      RETURN_NOT_OK(arrow::Concatenate(to_concat, ctx_->memory_pool(), &concatenated));
+      out_arrays.push_back(concatenated);
+    }
+    *out = arrow::RecordBatch::Make(result_schema_, out_length, out_arrays);
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::compute::FunctionContext* ctx_;
+  std::shared_ptr<arrow::Schema> result_schema_;
+  std::vector<std::shared_ptr<ResultIterator<arrow::RecordBatch>>> iter_list_;
+  int64_t morsel_rows_;
+  // null once a row budget leaves a single iterator
+  std::unique_ptr<MorselWorkerPool> worker_pool_;
+};
+
+/// Times the batches of a generated iterator for ProfileGuidedBuilds and swaps in its
+/// profile builds between batches: the instrumented one while this task profiles it,
+/// the optimised one once it is compiled. Each new iterator gets the dependencies and
+/// the row budget left of the one it replaces.
+class ProfileGuidedResultIterator : public ResultIterator<arrow::RecordBatch> {
+ public:
+  using IteratorMaker =
+      std::function<arrow::Status(std::shared_ptr<CodeGenBase>,
+                                  std::shared_ptr<ResultIterator<arrow::RecordBatch>>*)>;
+
+  ProfileGuidedResultIterator(arrow::compute::FunctionContext* ctx,
+                              std::string signature,
+                              std::shared_ptr<const std::string> codes,
+                              std::shared_ptr<ResultIterator<arrow::RecordBatch>> iter,
+                              IteratorMaker make_iterator)
+      : ctx_(ctx),
+        signature_(std::move(signature)),
+        codes_(std::move(codes)),
+        plain_iter_(iter),
+        iter_(std::move(iter)),
+        make_iterator_(std::move(make_iterator)) {}
+
+  ~ProfileGuidedResultIterator() {
+    if (build_ == Build::kInstrumented) {
+      ProfileGuidedBuilds::Get()->FinishProfiling(signature_, *codes_,
+                                                  profiled_batches_);
+    }
+  }
+
+  arrow::Status SetDependencies(
+      const std::vector<std::shared_ptr<ResultIteratorBase>>& dependent_iter_list)
+      override {
+    dependent_iter_list_ = dependent_iter_list;
+    has_dependencies_ = true;
+    return iter_->SetDependencies(dependent_iter_list);
+  }
+
+  arrow::Status SetRowBudget(int64_t rows) override {
+    row_budget_ = rows;
+    return iter_->SetRowBudget(rows);
+  }
+
+  bool BudgetExhausted() override { return iter_->BudgetExhausted(); }
+
+  arrow::Status Process(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                        std::shared_ptr<arrow::RecordBatch>* out,
+                        const std::shared_ptr<arrow::Array>& selection = nullptr)
+      override {
+    MaybeSwap();
+    auto start = std::chrono::steady_clock::now();
+    RETURN_NOT_OK(iter_->Process(in, out, selection));
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+    if (row_budget_ > 0) {
+      row_budget_ = std::max<int64_t>(0, row_budget_ - (*out)->num_rows());
+    }
+    auto builds = ProfileGuidedBuilds::Get();
+    if (build_ == Build::kPlain) {
+      builds->AddRunTime(signature_, *codes_, nanos);
+    } else if (build_ == Build::kInstrumented &&
+               ++profiled_batches_ >= GetProfileBatches()) {
+      builds->FinishProfiling(signature_, *codes_, profiled_batches_);
+      // counting slows the kernel down, back to the plain build until the optimised
+      // one is there
+      if (row_budget_ >= 0) {
+        RETURN_NOT_OK(plain_iter_->SetRowBudget(row_budget_));
+      }
+      iter_ = plain_iter_;
+      build_ = Build::kProfiled;
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  enum class Build { kPlain, kInstrumented, kProfiled, kOptimised };
+
+  // a build which fails to load leaves the current iterator in place and stops the
+  // profile guided builds of the kernel
+  void MaybeSwap() {
+    if (build_ == Build::kOptimised || row_budget_ == 0) {
+      return;
+    }
+    auto builds = ProfileGuidedBuilds::Get();
+    auto state = builds->GetState(signature_);
+    if (state == ProfileGuidedBuilds::State::kOptimised) {
+      if (!SwapTo(builds->GetSignature(signature_)).ok()) {
+        builds->MarkFailed(signature_);
+        return;
+      }
+      build_ = Build::kOptimised;
+      plain_iter_ = nullptr;
+      return;
+    }
+    std::string instrumented;
+    if (build_ == Build::kPlain &&
+        state == ProfileGuidedBuilds::State::kInstrumented &&
+        builds->ClaimInstrumented(signature_, &instrumented)) {
+      if (!SwapTo(instrumented).ok()) {
+        builds->MarkFailed(signature_);
+        return;
+      }
+      build_ = Build::kInstrumented;
+    }
+  }
+
+  arrow::Status SwapTo(const std::string& signature) {
+    std::shared_ptr<CodeGenBase> kernel;
+    RETURN_NOT_OK(LoadLibrary(signature, ctx_, &kernel));
+    std::shared_ptr<ResultIterator<arrow::RecordBatch>> iter;
+    RETURN_NOT_OK(make_iterator_(kernel, &iter));
+    if (has_dependencies_) {
+      RETURN_NOT_OK(iter->SetDependencies(dependent_iter_list_));
+    }
+    if (row_budget_ >= 0) {
+      RETURN_NOT_OK(iter->SetRowBudget(row_budget_));
+    }
+    iter_ = iter;
+    return arrow::Status::OK();
+  }
+
+  arrow::compute::FunctionContext* ctx_;
+  const std::string signature_;
+  std::shared_ptr<const std::string> codes_;
+  std::shared_ptr<ResultIterator<arrow::RecordBatch>> plain_iter_;
+  std::shared_ptr<ResultIterator<arrow::RecordBatch>> iter_;
+  IteratorMaker make_iterator_;
+  std::vector<std::shared_ptr<ResultIteratorBase>> dependent_iter_list_;
+  bool has_dependencies_ = false;
+  int64_t row_budget_ = -1;
+  Build build_ = Build::kPlain;
+  int64_t profiled_batches_ = 0;
+};
+
 ///////////////  WholeStageCodeGen  ////////////////
 class WholeStageCodeGenKernel::Impl {
  public:
@@ -61,7 +375,19 @@ class WholeStageCodeGenKernel::Impl {
   arrow::Status MakeResultIterator(
       std::shared_ptr<arrow::Schema> schema,
       std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
-    return wscg_kernel_->MakeResultIterator(schema, out);
+    RETURN_NOT_OK(MakeKernelResultIterator(ctx_, wscg_kernel_, schema, out));
+    if (codes_ == nullptr) {
+      return arrow::Status::OK();
+    }
+    auto ctx = ctx_;
+    auto make_iterator = [ctx, schema](
+                             std::shared_ptr<CodeGenBase> kernel,
+                             std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+      return MakeKernelResultIterator(ctx, kernel, schema, out);
+    };
+    *out = std::make_shared<ProfileGuidedResultIterator>(ctx_, signature_, codes_, *out,
+                                                         make_iterator);
+    return arrow::Status::OK();
   }
 
   std::string GetSignature() { return signature_; }
@@ -72,6 +398,28 @@ class WholeStageCodeGenKernel::Impl {
   std::vector<std::shared_ptr<KernalBase>> kernel_list_;
   std::shared_ptr<CodeGenBase> wscg_kernel_;
   std::string signature_;
+  // kept for the profile guided builds, null while they are off
+  std::shared_ptr<const std::string> codes_;
+
+  static arrow::Status MakeKernelResultIterator(
+      arrow::compute::FunctionContext* ctx, std::shared_ptr<CodeGenBase> kernel,
+      std::shared_ptr<arrow::Schema> schema,
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+    auto num_threads = GetWSCGThreads();
+    if (num_threads <= 1) {
+      return kernel->MakeResultIterator(schema, out);
+    }
+    // the generated iterator keeps per row state in members, one instance per thread
+    std::vector<std::shared_ptr<ResultIterator<arrow::RecordBatch>>> iter_list;
+    for (int i = 0; i < num_threads; i++) {
+      std::shared_ptr<ResultIterator<arrow::RecordBatch>> iter;
+      RETURN_NOT_OK(kernel->MakeResultIterator(schema, &iter));
+      iter_list.push_back(iter);
+    }
+    *out = std::make_shared<MorselResultIterator>(ctx, schema, std::move(iter_list),
+                                                  GetMorselRows());
+    return arrow::Status::OK();
+  }
 
   arrow::Status GetArguments(std::shared_ptr<gandiva::Node> node, int i,
                              gandiva::NodeVector* node_list) {
@@ -139,6 +487,18 @@ class WholeStageCodeGenKernel::Impl {
               ->children();
       RETURN_NOT_OK(
           FilterKernel::Make(ctx_, field_node_list, function_node->children()[1], out));
+    } else if (func_name.compare("expand") == 0) {
+      // expand(codegen_input_schema, codegen_project, codegen_project, ...)
+      auto field_node_list =
+          std::dynamic_pointer_cast<gandiva::FunctionNode>(function_node->children()[0])
+              ->children();
+      std::vector<gandiva::NodeVector> projection_list;
+      for (int i = 1; i < function_node->children().size(); i++) {
+        projection_list.push_back(
+            std::dynamic_pointer_cast<gandiva::FunctionNode>(function_node->children()[i])
+                ->children());
+      }
+      RETURN_NOT_OK(ExpandKernel::Make(ctx_, field_node_list, projection_list, out));
     }
     return arrow::Status::OK();
   }
@@ -170,32 +530,31 @@ class WholeStageCodeGenKernel::Impl {
       const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
       const std::vector<std::shared_ptr<KernalBase>>& kernel_list,
       std::shared_ptr<CodeGenBase>* out) {
-    int argument_id = 0;
-    int level = 0;
     std::vector<std::shared_ptr<CodeGenContext>> codegen_ctx_list;
-    std::vector<std::string> input_list;
-    for (int i = 0; i < input_field_list.size(); i++) {
-      auto name = "typed_in_col_" + std::to_string(i);
-      input_list.push_back(name);
-    }
-    for (auto kernel : kernel_list) {
-      std::shared_ptr<CodeGenContext> child_codegen_ctx;
-      RETURN_NOT_OK(
-          kernel->DoCodeGen(level++, input_list, &child_codegen_ctx, &argument_id));
-      codegen_ctx_list.push_back(child_codegen_ctx);
-      input_list.clear();
-      for (auto pair : child_codegen_ctx->output_list) {
-        input_list.push_back(pair.first);
-      }
-    }
-    std::string codes;
+    std::vector<std::shared_ptr<CodeGenContext>> null_free_codegen_ctx_list;
     RETURN_NOT_OK(
-        DoCodeGen(input_field_list, output_field_list, codegen_ctx_list, &codes));
+        DoKernelsCodeGen(input_field_list, kernel_list, false, &codegen_ctx_list));
+    RETURN_NOT_OK(DoKernelsCodeGen(input_field_list, kernel_list, true,
+                                   &null_free_codegen_ctx_list));
+    std::string codes;
+    RETURN_NOT_OK(DoCodeGen(input_field_list, output_field_list, codegen_ctx_list,
+                            null_free_codegen_ctx_list, &codes));
     // generate dll signature
     std::stringstream signature_ss;
     signature_ss << std::hex << std::hash<std::string>{}(codes);
     signature_ = signature_ss.str();
-    auto file_lock = FileSpinLock();
+    auto profile_guided_builds = ProfileGuidedBuilds::Get();
+    if (profile_guided_builds->enabled()) {
+      codes_ = std::make_shared<const std::string>(codes);
+      // a task after the profile round starts with the optimised build
+      auto profiled_signature = profile_guided_builds->GetSignature(signature_);
+      if (profiled_signature != signature_ &&
+          LoadLibrary(profiled_signature, ctx_, out).ok()) {
+        codes_ = nullptr;
+        return arrow::Status::OK();
+      }
+    }
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, out);
 
     if (!status.ok()) {
@@ -213,15 +572,45 @@ class WholeStageCodeGenKernel::Impl {
     return arrow::Status::OK();
   }
 
+  // Both runs number their variables alike, so the null free loop shares the batch
+  // prepare codes and members of the nullable one.
+  arrow::Status DoKernelsCodeGen(
+      const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
+      const std::vector<std::shared_ptr<KernalBase>>& kernel_list, bool null_free,
+      std::vector<std::shared_ptr<CodeGenContext>>* codegen_ctx_list) {
+    int argument_id = 0;
+    int level = 0;
+    std::vector<std::string> input_list;
+    for (int i = 0; i < input_field_list.size(); i++) {
+      auto name = "typed_in_col_" + std::to_string(i);
+      input_list.push_back(name);
+    }
+    for (auto kernel : kernel_list) {
+      auto child_codegen_ctx = std::make_shared<CodeGenContext>();
+      // only the first kernel reads the input columns
+      child_codegen_ctx->null_free = null_free && level == 0;
+      RETURN_NOT_OK(
+          kernel->DoCodeGen(level++, input_list, &child_codegen_ctx, &argument_id));
+      codegen_ctx_list->push_back(child_codegen_ctx);
+      input_list.clear();
+      for (auto pair : child_codegen_ctx->output_list) {
+        input_list.push_back(pair.first);
+      }
+    }
+    return arrow::Status::OK();
+  }
+
   arrow::Status DoCodeGen(
       const std::vector<std::shared_ptr<arrow::Field>>& input_field_list,
       const std::vector<std::shared_ptr<arrow::Field>>& output_field_list,
       const std::vector<std::shared_ptr<CodeGenContext>>& codegen_ctx_list,
+      const std::vector<std::shared_ptr<CodeGenContext>>& null_free_codegen_ctx_list,
       std::string* codes) {
     std::stringstream codes_ss;
     std::string out_list;
     std::stringstream define_ss;
     codes_ss << BaseCodes() << std::endl;
+    codes_ss << R"(#include "precompile/batch_sizer.h")" << std::endl;
     codes_ss << R"(#include "precompile/builder.h")" << std::endl;
     std::vector<std::string> headers;
     for (auto codegen_ctx : codegen_ctx_list) {
@@ -260,6 +649,7 @@ class TypedWholeStageCodeGenImpl : public CodeGenBase {
     codes_ss << R"(
     arrow::Status SetDependencies(
         const std::vector<std::shared_ptr<ResultIteratorBase>>& dependent_iter_list) {
+      if (row_budget_ == 0) return arrow::Status::OK();
       std::vector<std::shared_ptr<ResultIterator<HashRelation>>> typed_dependent_iter_list;
       for (auto iter : dependent_iter_list) {
         typed_dependent_iter_list.push_back(
@@ -288,62 +678,98 @@ class TypedWholeStageCodeGenImpl : public CodeGenBase {
                << "]);";
     }
 
-    codes_ss << R"(
-          uint64_t out_length = 0;
-          auto length = typed_in_0->length();
-          for (int i = 0; i < length; i++) {
-    )" << std::endl;
+    for (auto codegen_ctx : codegen_ctx_list) {
+      codes_ss << codegen_ctx->batch_prepare_codes << std::endl;
+    }
+
     // input preparation
+    std::vector<std::string> typed_array_list;
+    std::stringstream prepare_ss;
+    std::stringstream null_free_prepare_ss;
     for (int i = 0; i < input_field_list.size(); i++) {
       auto typed_array_name = "typed_in_" + std::to_string(i);
       auto name = "typed_in_col_" + std::to_string(i);
       auto validity = name + "_validity";
-      if (input_field_list[i]->type()->id() == arrow::Type::STRING) {
-        define_ss << "bool " << validity << ";" << std::endl;
-        define_ss << GetCTypeString(input_field_list[i]->type()) << " " << name << ";"
-                  << std::endl;
-        codes_ss << validity << " = " << typed_array_name << "->IsNull(i) ? false : true;"
-                 << std::endl;
-        codes_ss << "if (" << validity << ") {" << std::endl;
-        codes_ss << name << " = " << typed_array_name << "->GetString(i);" << std::endl;
-        codes_ss << "}" << std::endl;
-
-      } else {
-        define_ss << "bool " << validity << ";" << std::endl;
-        define_ss << GetCTypeString(input_field_list[i]->type()) << " " << name << ";"
-                  << std::endl;
-        codes_ss << validity << " = " << typed_array_name << "->IsNull(i) ? false : true;"
+      typed_array_list.push_back(typed_array_name);
+      define_ss << "bool " << validity << ";" << std::endl;
+      // strings are read in place, the views stay valid until the batch is done
+      define_ss << GetCViewTypeString(input_field_list[i]->type()) << " " << name << ";"
+                << std::endl;
+      prepare_ss << validity << " = " << typed_array_name << "->IsNull(i) ? false : true;"
                  << std::endl;
-        codes_ss << "if (" << validity << ") {" << std::endl;
-
-        codes_ss << name << " = " << typed_array_name << "->GetView(i);" << std::endl;
-        codes_ss << "}" << std::endl;
-      }
-    }
-    // paste children's codegen
-    for (auto codegen_ctx : codegen_ctx_list) {
-      codes_ss << codegen_ctx->prepare_codes << std::endl;
-      codes_ss << codegen_ctx->process_codes << std::endl;
-    }
-
-    codes_ss << GetProcessMaterializeCodes(codegen_ctx_list.back()) << std::endl;
-    codes_ss << "out_length += 1;" << std::endl;
-    for (auto codegen_ctx : codegen_ctx_list) {
-      codes_ss << codegen_ctx->finish_codes << std::endl;
+      prepare_ss << "if (" << validity << ") {" << std::endl;
+      prepare_ss << name << " = " << typed_array_name << "->GetView(i);" << std::endl;
+      prepare_ss << "}" << std::endl;
+      // functions of the children may still read the validity members
+      null_free_prepare_ss << validity << " = true;" << std::endl;
+      null_free_prepare_ss << name << " = " << typed_array_name << "->GetView(i);"
+                           << std::endl;
     }
+    // Most batches have no null at all, so the loop is emitted twice and picked per
+    // batch: the kernels generated the null free one with their input validity
+    // checks as constants.
+    // Under a LIMIT the loop stops once the budget is met, rows a probe or expand
+    // emitted past it are sliced off below.
+    codes_ss << R"(
+          uint64_t out_length = 0;
+          auto length = typed_in_0->length();
+          uint64_t out_limit = row_budget_ < 0 ? UINT64_MAX : row_budget_;
+)" << GetBuilderReserveCodes(output_field_list)
+             << R"(
+          if ()" << GetNoNullCondition(typed_array_list)
+             << R"() {
+          for (int i = 0; i < length && out_length < out_limit; i++) {
+    )" << std::endl;
+    codes_ss << null_free_prepare_ss.str();
+    codes_ss << GetLoopCodes(null_free_codegen_ctx_list);
+    codes_ss << "} // end of null free for loop" << std::endl;
+    codes_ss << R"(
+          } else {
+          for (int i = 0; i < length && out_length < out_limit; i++) {
+    )" << std::endl;
+    codes_ss << prepare_ss.str();
+    codes_ss << GetLoopCodes(codegen_ctx_list);
     codes_ss << "} // end of for loop" << std::endl;
+    codes_ss << "}" << std::endl;
     codes_ss << GetProcessFinishCodes(output_field_list) << std::endl;
     codes_ss << R"(
       *out = arrow::RecordBatch::Make(result_schema_, out_length, {)" +
                     GetProcessOutListCodes(output_field_list) + R"(});
+      output_sizer_.Observe(**out, length);
+      if (row_budget_ > 0) {
+        if (out_length > static_cast<uint64_t>(row_budget_)) {
+          *out = (*out)->Slice(0, row_budget_);
+        }
+        row_budget_ -= (*out)->num_rows();
+        if (row_budget_ == 0) ReleaseResources();
+      }
       return arrow::Status::OK();
     }
 
+    arrow::Status SetRowBudget(int64_t rows) override {
+      row_budget_ = rows;
+      if (row_budget_ == 0) ReleaseResources();
+      return arrow::Status::OK();
+    }
+
+    bool BudgetExhausted() override { return row_budget_ == 0; }
+
    private:
     arrow::compute::FunctionContext* ctx_;
     std::shared_ptr<arrow::Schema> result_schema_;
-    std::vector<std::shared_ptr<HashRelation>> hash_relation_list_;)"
+    std::vector<std::shared_ptr<HashRelation>> hash_relation_list_;
+    int64_t row_budget_ = -1;
+    // output batches follow the input ones, it only sizes the builders
+    BatchSizer output_sizer_{)"
+             << GetBatchSize() << ", 0, " << GetBatchMaxRows() << R"(};
+
+    void ReleaseResources() {
+      hash_relation_list_.clear();)"
              << std::endl;
+    for (auto codegen_ctx : codegen_ctx_list) {
+      codes_ss << codegen_ctx->release_codes;
+    }
+    codes_ss << "}" << std::endl;
     codes_ss << define_ss.str();
     for (auto codegen_ctx : codegen_ctx_list) {
       codes_ss << codegen_ctx->definition_codes << std::endl;
@@ -367,6 +793,24 @@ extern "C" void MakeCodeGen(arrow::compute::FunctionContext *ctx,
     return arrow::Status::OK();
   }
 
+  std::string GetLoopCodes(
+      const std::vector<std::shared_ptr<CodeGenContext>>& codegen_ctx_list) {
+    std::stringstream loop_ss;
+    // paste children's codegen
+    for (auto codegen_ctx : codegen_ctx_list) {
+      loop_ss << codegen_ctx->prepare_codes << std::endl;
+      loop_ss << codegen_ctx->process_codes << std::endl;
+    }
+
+    loop_ss << GetProcessMaterializeCodes(codegen_ctx_list.back()) << std::endl;
+    loop_ss << "out_length += 1;" << std::endl;
+    // loops opened by probe or expand close innermost first
+    for (auto it = codegen_ctx_list.rbegin(); it != codegen_ctx_list.rend(); it++) {
+      loop_ss << (*it)->finish_codes << std::endl;
+    }
+    return loop_ss.str();
+  }
+
   std::string GetProcessMaterializeCodes(std::shared_ptr<CodeGenContext> codegen_ctx) {
     std::stringstream codes_ss;
     int i = 0;
@@ -375,13 +819,8 @@ extern "C" void MakeCodeGen(arrow::compute::FunctionContext *ctx,
       auto type = pair.second;
       auto validity = name + "_validity";
       codes_ss << "if (" << validity << ") {" << std::endl;
-      if (type->id() == arrow::Type::STRING) {
-        codes_ss << "  RETURN_NOT_OK(builder_" << i << "_->AppendString(" << name << "));"
-                 << std::endl;
-      } else {
-        codes_ss << "  RETURN_NOT_OK(builder_" << i << "_->Append(" << name << "));"
-                 << std::endl;
-      }
+      codes_ss << "  RETURN_NOT_OK(builder_" << i << "_->Append(" << name << "));"
+               << std::endl;
       codes_ss << "} else {" << std::endl;
       codes_ss << "  RETURN_NOT_OK(builder_" << i << "_->AppendNull());" << std::endl;
       codes_ss << "}" << std::endl;
@@ -430,6 +869,24 @@ extern "C" void MakeCodeGen(arrow::compute::FunctionContext *ctx,
     return codes_ss.str();
   }
 
+  /// Reserves the builders for the rows and string bytes the last batches produced
+  /// per input row, so wide outputs aren't grown by repeated doubling.
+  std::string GetBuilderReserveCodes(gandiva::FieldVector output_field_list) {
+    std::stringstream codes_ss;
+    codes_ss << "auto expected_rows = output_sizer_.ExpectedRows(length);" << std::endl;
+    for (int i = 0; i < output_field_list.size(); i++) {
+      auto data_type = output_field_list[i]->type();
+      codes_ss << "RETURN_NOT_OK(builder_" << i << "_->Reserve(expected_rows));"
+               << std::endl;
+      if (data_type->id() == arrow::Type::STRING) {
+        codes_ss << "RETURN_NOT_OK(builder_" << i << "_->ReserveData("
+                 << "output_sizer_.ExpectedValueBytes(" << i << ", expected_rows)));"
+                 << std::endl;
+      }
+    }
+    return codes_ss.str();
+  }
+
   std::string GetBuilderDefinitionCodes(gandiva::FieldVector output_field_list) {
     std::stringstream codes_ss;
     for (int i = 0; i < output_field_list.size(); i++) {
@@ -161,7 +161,7 @@ class WindowSortKernel::Impl {
     signature_ss << std::hex << std::hash<std::string>{}(func_args_ss.str());
     signature_ = signature_ss.str();
 
-    auto file_lock = FileSpinLock();
+    auto file_lock = FileSpinLock(signature_);
     auto status = LoadLibrary(signature_, ctx_, &sorter);
     if (!status.ok()) {
       // process
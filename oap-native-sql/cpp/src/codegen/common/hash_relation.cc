@@ -15,9 +15,278 @@
  * limitations under the License.
  */
 
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/type.h>
+#include <arrow/util/bit_util.h>
+
+#include <cstdlib>
+#include <cstring>
+
 #include "codegen/common/hash_relation_number.h"
 #include "codegen/common/hash_relation_string.h"
 
+std::vector<ArrayItemIndex>& HashRelation::ThreadItemList() {
+  thread_local std::vector<ArrayItemIndex> item_list;
+  return item_list;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+// narrower payloads gather few enough lines from the columns
+const int kMinRowWiseFields = 8;
+const int kCacheLineSize = 64;
+
+int64_t AlignTo(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool IsRowWiseSupported(const arrow::DataType& type) {
+  switch (type.id()) {
+    case arrow::Type::BOOL:
+    case arrow::Type::UINT8:
+    case arrow::Type::INT8:
+    case arrow::Type::UINT16:
+    case arrow::Type::INT16:
+    case arrow::Type::UINT32:
+    case arrow::Type::INT32:
+    case arrow::Type::UINT64:
+    case arrow::Type::INT64:
+    case arrow::Type::FLOAT:
+    case arrow::Type::DOUBLE:
+    case arrow::Type::DATE32:
+    case arrow::Type::DATE64:
+    case arrow::Type::STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// bytes of a field in the fixed width part of a row, booleans take a byte
+int GetFixedWidth(const arrow::DataType& type) {
+  switch (type.id()) {
+    case arrow::Type::STRING:
+      return 0;
+    case arrow::Type::BOOL:
+      return 1;
+    default:
+      return static_cast<const arrow::FixedWidthType&>(type).bit_width() / 8;
+  }
+}
+
+void SetNullAt(uint8_t* row, int field) { row[field >> 3] |= 1 << (field & 7); }
+
+template <int kWidth>
+void PackFixedWidth(const arrow::Array& in, int field, int offset, int row_size,
+                    uint8_t* rows) {
+  auto values = in.data()->buffers[1]->data() + in.offset() * kWidth;
+  for (int64_t i = 0; i < in.length(); i++) {
+    auto row = rows + i * row_size;
+    if (in.IsNull(i)) {
+      SetNullAt(row, field);
+    } else {
+      memcpy(row + offset, values + i * kWidth, kWidth);
+    }
+  }
+}
+
+}  // namespace
+
+HashRelationPayloadRows::HashRelationPayloadRows(
+    arrow::MemoryPool* pool, const std::vector<std::shared_ptr<arrow::DataType>>& types)
+    : pool_(pool), types_(types), field_offsets_(types.size()) {
+  int offset = AlignTo((types.size() + 7) / 8, 8);
+  // widest first, so every fixed width field is naturally aligned
+  for (int width : {8, 4, 2, 1}) {
+    for (int i = 0; i < types.size(); i++) {
+      if (GetFixedWidth(*types[i]) == width) {
+        field_offsets_[i] = offset;
+        offset += width;
+      }
+    }
+  }
+  offset = AlignTo(offset, 4);
+  for (int i = 0; i < types.size(); i++) {
+    if (types[i]->id() == arrow::Type::STRING) {
+      field_offsets_[i] = offset;
+      offset += 2 * sizeof(uint32_t);
+    }
+  }
+  row_size_ = AlignTo(offset, 8);
+}
+
+bool HashRelationPayloadRows::Preferred(
+    const std::vector<std::shared_ptr<arrow::DataType>>& types) {
+  for (auto type : types) {
+    if (!IsRowWiseSupported(*type)) return false;
+  }
+  const char* env_layout = std::getenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT");
+  if (env_layout != nullptr && strcmp(env_layout, "row") == 0) return !types.empty();
+  if (env_layout != nullptr && strcmp(env_layout, "column") == 0) return false;
+  if (types.size() < kMinRowWiseFields) return false;
+
+  // a match reads the validity and the value of each column, plus the offsets of a
+  // string column, while a row is read as a whole plus the bytes of its strings
+  int64_t column_lines = 0;
+  int64_t num_strings = 0;
+  for (auto type : types) {
+    if (type->id() == arrow::Type::STRING) {
+      column_lines += 3;
+      num_strings++;
+    } else {
+      column_lines += 2;
+    }
+  }
+  HashRelationPayloadRows layout(nullptr, types);
+  int64_t row_lines = AlignTo(layout.row_size(), kCacheLineSize) / kCacheLineSize;
+  return 2 * (row_lines + num_strings) <= column_lines;
+}
+
+arrow::Status HashRelationPayloadRows::AppendBatch(
+    const std::vector<std::shared_ptr<arrow::Array>>& in) {
+  if (in.size() != types_.size()) {
+    return arrow::Status::Invalid("HashRelationPayloadRows expects ", types_.size(),
+                                  " columns, got ", in.size());
+  }
+  int64_t length = in.empty() ? 0 : in[0]->length();
+  int64_t var_data_size = 0;
+  for (int i = 0; i < in.size(); i++) {
+    if (types_[i]->id() == arrow::Type::STRING) {
+      auto typed_in = std::static_pointer_cast<arrow::StringArray>(in[i]);
+      var_data_size += typed_in->value_offset(length) - typed_in->value_offset(0);
+    }
+  }
+  std::shared_ptr<arrow::Buffer> rows;
+  ARROW_ASSIGN_OR_RAISE(rows, arrow::AllocateBuffer(length * row_size_, pool_));
+  std::shared_ptr<arrow::Buffer> var_data;
+  ARROW_ASSIGN_OR_RAISE(var_data, arrow::AllocateBuffer(var_data_size, pool_));
+  auto raw_rows = rows->mutable_data();
+  auto raw_var_data = var_data->mutable_data();
+  memset(raw_rows, 0, length * row_size_);
+
+  // column by column, each column is read sequentially
+  uint32_t var_data_offset = 0;
+  for (int field = 0; field < in.size(); field++) {
+    auto offset = field_offsets_[field];
+    switch (types_[field]->id()) {
+      case arrow::Type::BOOL: {
+        auto typed_in = std::static_pointer_cast<arrow::BooleanArray>(in[field]);
+        for (int64_t i = 0; i < length; i++) {
+          auto row = raw_rows + i * row_size_;
+          if (typed_in->IsNull(i)) {
+            SetNullAt(row, field);
+          } else {
+            row[offset] = typed_in->Value(i);
+          }
+        }
+      } break;
+      case arrow::Type::STRING: {
+        auto typed_in = std::static_pointer_cast<arrow::StringArray>(in[field]);
+        for (int64_t i = 0; i < length; i++) {
+          auto row = raw_rows + i * row_size_;
+          if (typed_in->IsNull(i)) {
+            SetNullAt(row, field);
+            continue;
+          }
+          auto value = typed_in->GetView(i);
+          uint32_t slot[2] = {var_data_offset, static_cast<uint32_t>(value.size())};
+          memcpy(raw_var_data + var_data_offset, value.data(), value.size());
+          memcpy(row + offset, slot, sizeof(slot));
+          var_data_offset += value.size();
+        }
+      } break;
+      default: {
+        switch (GetFixedWidth(*types_[field])) {
+          case 1:
+            PackFixedWidth<1>(*in[field], field, offset, row_size_, raw_rows);
+            break;
+          case 2:
+            PackFixedWidth<2>(*in[field], field, offset, row_size_, raw_rows);
+            break;
+          case 4:
+            PackFixedWidth<4>(*in[field], field, offset, row_size_, raw_rows);
+            break;
+          default:
+            PackFixedWidth<8>(*in[field], field, offset, row_size_, raw_rows);
+            break;
+        }
+      } break;
+    }
+  }
+
+  lengths_.push_back(length);
+  raw_rows_.push_back(rows->data());
+  raw_var_data_.push_back(reinterpret_cast<const char*>(var_data->data()));
+  buffers_.push_back(std::move(rows));
+  buffers_.push_back(std::move(var_data));
+  return arrow::Status::OK();
+}
+
+arrow::Status HashRelationPayloadRows::UnpackColumn(
+    int field, std::vector<std::shared_ptr<arrow::Array>>* out) {
+  auto type = types_[field];
+  auto offset = field_offsets_[field];
+  auto width = GetFixedWidth(*type);
+  for (int array_id = 0; array_id < lengths_.size(); array_id++) {
+    auto length = lengths_[array_id];
+    std::shared_ptr<arrow::Buffer> validity;
+    ARROW_ASSIGN_OR_RAISE(
+        validity, arrow::AllocateBuffer(arrow::BitUtil::BytesForBits(length), pool_));
+    auto raw_validity = validity->mutable_data();
+    memset(raw_validity, 0, validity->size());
+    int64_t null_count = 0;
+    for (int64_t i = 0; i < length; i++) {
+      if (IsNull(array_id, i, field)) {
+        null_count++;
+      } else {
+        arrow::BitUtil::SetBit(raw_validity, i);
+      }
+    }
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers = {validity};
+    if (type->id() == arrow::Type::STRING) {
+      std::shared_ptr<arrow::Buffer> offsets;
+      ARROW_ASSIGN_OR_RAISE(
+          offsets, arrow::AllocateBuffer((length + 1) * sizeof(int32_t), pool_));
+      auto raw_offsets = reinterpret_cast<int32_t*>(offsets->mutable_data());
+      raw_offsets[0] = 0;
+      for (int64_t i = 0; i < length; i++) {
+        raw_offsets[i + 1] = raw_offsets[i] + GetView(array_id, i, offset).size();
+      }
+      std::shared_ptr<arrow::Buffer> data;
+      ARROW_ASSIGN_OR_RAISE(data, arrow::AllocateBuffer(raw_offsets[length], pool_));
+      for (int64_t i = 0; i < length; i++) {
+        auto value = GetView(array_id, i, offset);
+        memcpy(data->mutable_data() + raw_offsets[i], value.data(), value.size());
+      }
+      buffers.push_back(offsets);
+      buffers.push_back(data);
+    } else if (type->id() == arrow::Type::BOOL) {
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(
+          values, arrow::AllocateBuffer(arrow::BitUtil::BytesForBits(length), pool_));
+      memset(values->mutable_data(), 0, values->size());
+      for (int64_t i = 0; i < length; i++) {
+        if (GetRow(array_id, i)[offset]) {
+          arrow::BitUtil::SetBit(values->mutable_data(), i);
+        }
+      }
+      buffers.push_back(values);
+    } else {
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(values, arrow::AllocateBuffer(length * width, pool_));
+      for (int64_t i = 0; i < length; i++) {
+        memcpy(values->mutable_data() + i * width, GetRow(array_id, i) + offset, width);
+      }
+      buffers.push_back(values);
+    }
+    out->push_back(
+        arrow::MakeArray(arrow::ArrayData::Make(type, length, buffers, null_count)));
+  }
+  return arrow::Status::OK();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////
 #define PROCESS_SUPPORTED_TYPES(PROCESS) \
   PROCESS(arrow::BooleanType)            \
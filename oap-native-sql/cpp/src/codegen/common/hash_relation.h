@@ -20,6 +20,14 @@
 #include <arrow/compute/context.h>
 #include <arrow/status.h>
 #include <arrow/type_fwd.h>
+#include <arrow/util/string_view.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 #include "codegen/arrow_compute/ext/array_item_index.h"
 #include "precompile/type_traits.h"
@@ -102,6 +110,131 @@ class TypedHashRelationColumn<DataType, enable_if_string_like<DataType>>
   std::vector<std::shared_ptr<StringArray>> array_vector_;
 };
 
+/// Build side payload packed row by row, for joins which gather many build columns
+/// per match. Each row is a null bitmap, then the fixed width fields ordered by width,
+/// then an (offset, length) slot per string field pointing into the string bytes of
+/// its batch. The fields of a row share one or two cache lines, where the column
+/// layout touches a validity and a value line per column.
+class HashRelationPayloadRows {
+ public:
+  HashRelationPayloadRows(arrow::MemoryPool* pool,
+                          const std::vector<std::shared_ptr<arrow::DataType>>& types);
+
+  /// Whether gathering these columns is cheaper from packed rows. Packing copies the
+  /// build side once, so the rows have to save at least half of the cache lines a
+  /// match touches. NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT=row|column overrides it.
+  /// Only the build side decides, the HashRelation records the layout it chose.
+  static bool Preferred(const std::vector<std::shared_ptr<arrow::DataType>>& types);
+
+  /// Packs one batch, batches are numbered like the array_id of ArrayItemIndex.
+  arrow::Status AppendBatch(const std::vector<std::shared_ptr<arrow::Array>>& in);
+
+  /// Rebuilds the arrays of one field, one per batch, for consumers of columns.
+  arrow::Status UnpackColumn(int field, std::vector<std::shared_ptr<arrow::Array>>* out);
+
+  int field_offset(int field) const { return field_offsets_[field]; }
+
+  int row_size() const { return row_size_; }
+
+  bool IsNull(int array_id, int id, int field) const {
+    return (GetRow(array_id, id)[field >> 3] >> (field & 7)) & 1;
+  }
+
+  template <typename T>
+  T GetFixed(int array_id, int id, int offset) const {
+    T value;
+    memcpy(&value, GetRow(array_id, id) + offset, sizeof(T));
+    return value;
+  }
+
+  arrow::util::string_view GetView(int array_id, int id, int offset) const {
+    uint32_t slot[2];
+    memcpy(slot, GetRow(array_id, id) + offset, sizeof(slot));
+    return arrow::util::string_view(raw_var_data_[array_id] + slot[0], slot[1]);
+  }
+
+ private:
+  const uint8_t* GetRow(int array_id, int id) const {
+    return raw_rows_[array_id] + static_cast<int64_t>(id) * row_size_;
+  }
+
+  arrow::MemoryPool* pool_;
+  std::vector<std::shared_ptr<arrow::DataType>> types_;
+  std::vector<int> field_offsets_;
+  int row_size_;
+  std::vector<int64_t> lengths_;
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers_;
+  std::vector<const uint8_t*> raw_rows_;
+  std::vector<const char*> raw_var_data_;
+};
+
+/// Reads one field of the packed rows, with the interface of TypedHashRelationColumn
+/// so that the generated probe code only changes in the declaration.
+template <typename T, typename Enable = void>
+class TypedHashRelationRowColumn {};
+
+template <typename DataType>
+class TypedHashRelationRowColumn<DataType, enable_if_number<DataType>> {
+ public:
+  using T = typename TypeTraits<DataType>::CType;
+  TypedHashRelationRowColumn(std::shared_ptr<HashRelationPayloadRows> rows, int field)
+      : rows_(std::move(rows)), field_(field), offset_(rows_->field_offset(field)) {}
+  bool IsNull(int array_id, int id) { return rows_->IsNull(array_id, id, field_); }
+  T GetValue(int array_id, int id) { return rows_->GetFixed<T>(array_id, id, offset_); }
+
+ private:
+  std::shared_ptr<HashRelationPayloadRows> rows_;
+  int field_;
+  int offset_;
+};
+
+template <typename DataType>
+class TypedHashRelationRowColumn<DataType, enable_if_string_like<DataType>> {
+ public:
+  TypedHashRelationRowColumn(std::shared_ptr<HashRelationPayloadRows> rows, int field)
+      : rows_(std::move(rows)), field_(field), offset_(rows_->field_offset(field)) {}
+  bool IsNull(int array_id, int id) { return rows_->IsNull(array_id, id, field_); }
+  std::string GetValue(int array_id, int id) {
+    return std::string(rows_->GetView(array_id, id, offset_));
+  }
+
+ private:
+  std::shared_ptr<HashRelationPayloadRows> rows_;
+  int field_;
+  int offset_;
+};
+
+/// Payload field of a HashRelation in the layout its build side chose. The probe code
+/// is generated before the relation is built, so it reads every payload through this.
+template <typename DataType>
+class TypedHashRelationPayload {
+ public:
+  using ColumnType = TypedHashRelationColumn<DataType>;
+  using RowColumnType = TypedHashRelationRowColumn<DataType>;
+  using ValueType = decltype(std::declval<ColumnType>().GetValue(0, 0));
+
+  TypedHashRelationPayload(std::shared_ptr<HashRelationColumn> column,
+                           std::shared_ptr<HashRelationPayloadRows> rows, int field) {
+    if (rows) {
+      row_column_ = std::make_shared<RowColumnType>(std::move(rows), field);
+    } else {
+      column_ = std::dynamic_pointer_cast<ColumnType>(column);
+    }
+  }
+  bool IsNull(int array_id, int id) {
+    return row_column_ ? row_column_->IsNull(array_id, id)
+                       : column_->IsNull(array_id, id);
+  }
+  ValueType GetValue(int array_id, int id) {
+    return row_column_ ? row_column_->GetValue(array_id, id)
+                       : column_->GetValue(array_id, id);
+  }
+
+ private:
+  std::shared_ptr<ColumnType> column_;
+  std::shared_ptr<RowColumnType> row_column_;
+};
+
 template <typename T>
 using is_number_alike =
     std::integral_constant<bool, std::is_arithmetic<T>::value ||
@@ -109,6 +242,31 @@ using is_number_alike =
 
 /////////////////////////////////////////////////////////////////////////
 
+/// Build side statistics of a HashRelation, used to spot join keys which hash badly.
+struct HashRelationStats {
+  // distinct keys in the table
+  int64_t num_keys = 0;
+  // build rows, i.e. the candidates of all keys
+  int64_t num_rows = 0;
+  // candidates behind the most frequent key, the longest chain one probe walks
+  int64_t max_candidates = 0;
+  // keys sharing their 32-bit hash with another key, unsafe hash map only
+  int64_t num_hash_collisions = 0;
+  // slots visited to reach a key, unsafe hash map only
+  int64_t max_probe_length = 0;
+  double avg_probe_length = 0;
+
+  std::string ToString() const {
+    std::stringstream ss;
+    ss << "keys: " << num_keys << ", rows: " << num_rows
+       << ", max candidates: " << max_candidates
+       << ", hash collisions: " << num_hash_collisions
+       << ", max probe length: " << max_probe_length
+       << ", avg probe length: " << avg_probe_length;
+    return ss.str();
+  }
+};
+
 class HashRelation {
  public:
   HashRelation(arrow::compute::FunctionContext* ctx) {}
@@ -124,7 +282,6 @@ class HashRelation {
       int key_size = -1)
       : HashRelation(hash_relation_column) {
     hash_table_ = createUnsafeHashMap(1024 * 1024, 256 * 1024 * 1024, key_size);
-    arrayid_list_.reserve(64);
   }
 
   ~HashRelation() {
@@ -192,17 +349,18 @@ class HashRelation {
     if (hash_table_ == nullptr) {
       throw std::runtime_error("HashRelation Get failed, hash_table is null.");
     }
-    auto res = safeLookup(hash_table_, payload, v, &arrayid_list_);
+    auto res = safeLookup(hash_table_, payload, v, &ThreadItemList());
     if (res == -1) return -1;
 
     return 0;
   }
 
-  int Get(int32_t v, std::string payload) {
+  int Get(int32_t v, arrow::util::string_view payload) {
     if (hash_table_ == nullptr) {
       throw std::runtime_error("HashRelation Get failed, hash_table is null.");
     }
-    auto res = safeLookup(hash_table_, payload.data(), payload.size(), v, &arrayid_list_);
+    auto res =
+        safeLookup(hash_table_, payload.data(), payload.size(), v, &ThreadItemList());
     if (res == -1) return -1;
     return 0;
   }
@@ -211,7 +369,7 @@ class HashRelation {
     if (hash_table_ == nullptr) {
       throw std::runtime_error("HashRelation Get failed, hash_table is null.");
     }
-    auto res = safeLookup(hash_table_, payload, v, &arrayid_list_);
+    auto res = safeLookup(hash_table_, payload, v, &ThreadItemList());
     if (res == -1) return -1;
     return 0;
   }
@@ -225,7 +383,7 @@ class HashRelation {
     return safeLookup(hash_table_, payload, v);
   }
 
-  int IfExists(int32_t v, std::string payload) {
+  int IfExists(int32_t v, arrow::util::string_view payload) {
     if (hash_table_ == nullptr) {
       throw std::runtime_error("HashRelation Get failed, hash_table is null.");
     }
@@ -245,16 +403,60 @@ class HashRelation {
     return hash_relation_column_list_[idx]->AppendColumn(in);
   }
 
+  /// Payload batches are kept as columns, or only packed into rows once
+  /// EnablePayloadRows() was called.
+  arrow::Status AppendPayload(const std::vector<std::shared_ptr<arrow::Array>>& in) {
+    if (payload_rows_) {
+      return payload_rows_->AppendBatch(in);
+    }
+    for (int i = 0; i < in.size(); i++) {
+      RETURN_NOT_OK(AppendPayloadColumn(i, in[i]));
+    }
+    return arrow::Status::OK();
+  }
+
+  /// Chooses the row layout for the payload, before any is appended.
+  void EnablePayloadRows(arrow::MemoryPool* pool,
+                         const std::vector<std::shared_ptr<arrow::DataType>>& types) {
+    payload_rows_ = std::make_shared<HashRelationPayloadRows>(pool, types);
+  }
+
+  bool HasPayloadRows() const { return payload_rows_ != nullptr; }
+
+  /// Arrays of a payload column, unpacked again when the payload is kept in rows.
   arrow::Status GetArrayVector(int idx, std::vector<std::shared_ptr<arrow::Array>>* out) {
+    if (payload_rows_) {
+      return payload_rows_->UnpackColumn(idx, out);
+    }
     return hash_relation_column_list_[idx]->GetArrayVector(out);
   }
 
   template <typename T>
   arrow::Status GetColumn(int idx, std::shared_ptr<T>* out) {
+    if (payload_rows_) {
+      return arrow::Status::Invalid("HashRelation payload was packed into rows");
+    }
     *out = std::dynamic_pointer_cast<T>(hash_relation_column_list_[idx]);
     return arrow::Status::OK();
   }
 
+  /// Accessor of a payload column in whichever layout was chosen, T is a
+  /// TypedHashRelationPayload.
+  template <typename T>
+  arrow::Status GetPayloadColumn(int idx, std::shared_ptr<T>* out) {
+    *out = std::make_shared<T>(hash_relation_column_list_[idx], payload_rows_, idx);
+    return arrow::Status::OK();
+  }
+
+  template <typename T>
+  arrow::Status GetRowColumn(int idx, std::shared_ptr<T>* out) {
+    if (!payload_rows_) {
+      return arrow::Status::Invalid("HashRelation payload was not packed into rows");
+    }
+    *out = std::make_shared<T>(payload_rows_, idx);
+    return arrow::Status::OK();
+  }
+
   arrow::Status UnsafeGetHashTableObject(int64_t* addrs, int* sizes) {
     if (hash_table_ == nullptr) {
       return arrow::Status::Invalid("UnsafeGetHashTableObject hash_table is null");
@@ -287,19 +489,73 @@ class HashRelation {
     return arrow::Status::OK();
   }
 
-  virtual std::vector<ArrayItemIndex> GetItemListByIndex(int i) { return arrayid_list_; }
+  virtual std::vector<ArrayItemIndex> GetItemListByIndex(int i) {
+    return ThreadItemList();
+  }
 
   void TESTGrowAndRehashKeyArray() { growAndRehashKeyArray(hash_table_); }
 
+  virtual arrow::Status GetStats(HashRelationStats* out) {
+    *out = HashRelationStats();
+    if (hash_table_ == nullptr) {
+      return arrow::Status::OK();
+    }
+    const int mask = hash_table_->arrayCapacity - 1;
+    const int stride = hash_table_->bytesInKeyArray;
+    std::vector<int> hash_list;
+    hash_list.reserve(hash_table_->numKeys);
+    int64_t total_probe_length = 0;
+    for (int slot = 0; slot < hash_table_->arrayCapacity; slot++) {
+      char* pos = hash_table_->keyArray + slot * stride;
+      int offset = *(int*)pos;
+      if (offset < 0) continue;
+      int hash_val = *(int*)(pos + 4);
+      hash_list.push_back(hash_val);
+      // replay the probe sequence of append() from the home slot
+      int probe = hash_val & mask;
+      int step = 1;
+      int64_t probe_length = 1;
+      while (probe != slot && probe_length <= hash_table_->arrayCapacity) {
+        probe = (probe + step++) & mask;
+        probe_length++;
+      }
+      total_probe_length += probe_length;
+      out->max_probe_length = std::max(out->max_probe_length, probe_length);
+      int64_t candidates = 1;
+      while ((offset = getNextOffsetFromBytesMap(hash_table_, offset)) != 0) {
+        candidates++;
+      }
+      out->num_rows += candidates;
+      out->max_candidates = std::max(out->max_candidates, candidates);
+    }
+    out->num_keys = hash_list.size();
+    if (out->num_keys > 0) {
+      out->avg_probe_length = (double)total_probe_length / out->num_keys;
+    }
+    std::sort(hash_list.begin(), hash_list.end());
+    for (size_t i = 0; i < hash_list.size();) {
+      size_t j = i + 1;
+      while (j < hash_list.size() && hash_list[j] == hash_list[i]) j++;
+      if (j - i > 1) out->num_hash_collisions += j - i;
+      i = j;
+    }
+    return arrow::Status::OK();
+  }
+
  protected:
   bool unsafe_set = false;
   uint64_t num_arrays_ = 0;
   std::vector<std::shared_ptr<HashRelationColumn>> hash_relation_column_list_;
+  std::shared_ptr<HashRelationPayloadRows> payload_rows_;
   unsafeHashMap* hash_table_ = nullptr;
   using ArrayType = sparkcolumnarplugin::precompile::Int32Array;
   bool null_index_set_ = false;
   std::vector<ArrayItemIndex> null_index_list_;
-  std::vector<ArrayItemIndex> arrayid_list_;
+
+  /* Get() leaves the matched items here for GetItemListByIndex(), per thread so that
+   * the morsel workers of a WSCG pipeline can probe the same relation. Defined out of
+   * line, the generated libraries must share the instance of this library. */
+  static std::vector<ArrayItemIndex>& ThreadItemList();
 
   arrow::Status Insert(int32_t v, std::shared_ptr<UnsafeRow> payload, uint32_t array_id,
                        uint32_t id) {
@@ -321,6 +577,18 @@ class HashRelation {
     return arrow::Status::OK();
   }
 
+  static void GetCandidateStats(
+      const std::vector<std::vector<ArrayItemIndex>>& memo_index_to_arrayid,
+      HashRelationStats* out) {
+    *out = HashRelationStats();
+    out->num_keys = memo_index_to_arrayid.size();
+    for (auto& item_list : memo_index_to_arrayid) {
+      int64_t candidates = item_list.size();
+      out->num_rows += candidates;
+      out->max_candidates = std::max(out->max_candidates, candidates);
+    }
+  }
+
   arrow::Status InsertNull(uint32_t array_id, uint32_t id) {
     if (!null_index_set_) {
       null_index_set_ = true;
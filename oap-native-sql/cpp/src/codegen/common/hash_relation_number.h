@@ -63,6 +63,11 @@ class TypedHashRelation<DataType, enable_if_number<DataType>> : public HashRelat
     return memo_index_to_arrayid_[i];
   }
 
+  arrow::Status GetStats(HashRelationStats* out) override {
+    GetCandidateStats(memo_index_to_arrayid_, out);
+    return arrow::Status::OK();
+  }
+
  private:
   arrow::Status Insert(T v, uint32_t array_id, uint32_t id) {
     int i;
@@ -69,6 +69,11 @@ class TypedHashRelation<DataType, enable_if_string_like<DataType>> : public Hash
     return memo_index_to_arrayid_[i];
   }
 
+  arrow::Status GetStats(HashRelationStats* out) override {
+    GetCandidateStats(memo_index_to_arrayid_, out);
+    return arrow::Status::OK();
+  }
+
  private:
   arrow::Status Insert(arrow::util::string_view v, uint32_t array_id, uint32_t id) {
     int i;
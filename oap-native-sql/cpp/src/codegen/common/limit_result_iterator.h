@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/status.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codegen/common/result_iterator.h"
+
+/**
+ * LIMIT on top of a RecordBatch iterator. The limit is handed upstream as a row
+ * budget when the iterator is made, so scans, probes and WSCG stages that honour it
+ * stop early. Upstreams that don't are still cut here: batches are sliced to the
+ * rows left and the upstream is dropped once the limit is met.
+ */
+class LimitResultIterator : public ResultIterator<arrow::RecordBatch> {
+ public:
+  static arrow::Status Make(std::shared_ptr<ResultIterator<arrow::RecordBatch>> upstream,
+                            int64_t limit,
+                            std::shared_ptr<ResultIterator<arrow::RecordBatch>>* out) {
+    auto iter = std::shared_ptr<LimitResultIterator>(
+        new LimitResultIterator(std::move(upstream), std::max<int64_t>(limit, 0)));
+    RETURN_NOT_OK(iter->upstream_->SetRowBudget(iter->remaining_));
+    *out = iter;
+    return arrow::Status::OK();
+  }
+
+  bool HasNext() override {
+    return remaining_ > 0 && upstream_ != nullptr && upstream_->HasNext();
+  }
+
+  arrow::Status Next(std::shared_ptr<arrow::RecordBatch>* out) override {
+    if (!HasNext()) {
+      return arrow::Status::Invalid("LimitResultIterator Next() after the limit is met");
+    }
+    RETURN_NOT_OK(upstream_->Next(out));
+    return Truncate(out);
+  }
+
+  arrow::Status Process(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                        std::shared_ptr<arrow::RecordBatch>* out,
+                        const std::shared_ptr<arrow::Array>& selection = nullptr)
+      override {
+    if (upstream_ == nullptr) {
+      return MakeEmptyBatch(out);
+    }
+    RETURN_NOT_OK(upstream_->Process(in, out, selection));
+    return Truncate(out);
+  }
+
+  arrow::Status SetDependencies(
+      const std::vector<std::shared_ptr<ResultIteratorBase>>& dependent_iter_list)
+      override {
+    if (upstream_ == nullptr) return arrow::Status::OK();
+    return upstream_->SetDependencies(dependent_iter_list);
+  }
+
+  /// A second limit further downstream can only lower the budget.
+  arrow::Status SetRowBudget(int64_t rows) override {
+    if (rows < 0 || rows >= remaining_) return arrow::Status::OK();
+    remaining_ = rows;
+    if (remaining_ == 0) Release();
+    if (upstream_ == nullptr) return arrow::Status::OK();
+    return upstream_->SetRowBudget(remaining_);
+  }
+
+  bool BudgetExhausted() override { return remaining_ == 0; }
+
+  std::string ToString() override { return "LimitResultIterator"; }
+
+ private:
+  LimitResultIterator(std::shared_ptr<ResultIterator<arrow::RecordBatch>> upstream,
+                      int64_t limit)
+      : upstream_(std::move(upstream)), remaining_(limit) {}
+
+  arrow::Status Truncate(std::shared_ptr<arrow::RecordBatch>* out) {
+    if (*out == nullptr) return arrow::Status::OK();
+    if (result_schema_ == nullptr) result_schema_ = (*out)->schema();
+    if ((*out)->num_rows() > remaining_) {
+      *out = (*out)->Slice(0, remaining_);
+    }
+    remaining_ -= (*out)->num_rows();
+    if (remaining_ == 0) Release();
+    return arrow::Status::OK();
+  }
+
+  /// the upstream may pin hash relations, readers and builders, none is needed now.
+  /// It is kept until one batch told the schema the empty batches need.
+  void Release() {
+    if (result_schema_ != nullptr) upstream_ = nullptr;
+  }
+
+  arrow::Status MakeEmptyBatch(std::shared_ptr<arrow::RecordBatch>* out) {
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (auto field : result_schema_->fields()) {
+      std::shared_ptr<arrow::Array> column;
+      RETURN_NOT_OK(arrow::MakeArrayOfNull(arrow::default_memory_pool(), field->type(),
+                                           0, &column));
+      columns.push_back(column);
+    }
+    *out = arrow::RecordBatch::Make(result_schema_, 0, columns);
+    return arrow::Status::OK();
+  }
+
+  std::shared_ptr<ResultIterator<arrow::RecordBatch>> upstream_;
+  std::shared_ptr<arrow::Schema> result_schema_;
+  int64_t remaining_;
+};
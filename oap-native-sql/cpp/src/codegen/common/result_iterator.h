@@ -29,6 +29,15 @@ class ResultIteratorBase {
       const std::shared_ptr<arrow::Array>& selection = nullptr) {
     return arrow::Status::NotImplemented("ResultIterator abstract ProcessAndCacheOne()");
   }
+  /// Marks the end of the input fed through ProcessAndCacheOne(), rows still buffered
+  /// are returned by Next() from then on.
+  virtual arrow::Status FinishInput() { return arrow::Status::OK(); }
+  /// Caps the rows a downstream LIMIT still needs from this iterator, a negative
+  /// budget means no limit. Iterators able to stop early truncate their last batch,
+  /// release what they hold and pass the budget on to the iterators they read from.
+  virtual arrow::Status SetRowBudget(int64_t rows) { return arrow::Status::OK(); }
+  /// True once the row budget is met, no further rows will be produced.
+  virtual bool BudgetExhausted() { return false; }
 };
 
 template <typename T>
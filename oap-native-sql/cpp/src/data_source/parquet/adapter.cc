@@ -31,13 +31,17 @@
 #include <parquet/file_reader.h>
 #include <parquet/file_writer.h>
 #include <parquet/schema.h>
+#include "codegen/arrow_compute/ext/codegen_common.h"
 #include "data_source/parquet/adapter.h"
+#include "precompile/batch_sizer.h"
 
 namespace jni {
 namespace parquet {
 namespace adapters {
 
 using RecordBatchReader = arrow::RecordBatchReader;
+using sparkcolumnarplugin::codegen::arrowcompute::extra::GetBatchBytes;
+using sparkcolumnarplugin::codegen::arrowcompute::extra::GetBatchMaxRows;
 using Table = arrow::Table;
 
 class ParquetFileReader::Impl {
@@ -48,6 +52,7 @@ class ParquetFileReader::Impl {
   Status Open(std::shared_ptr<RandomAccessFile>& file, MemoryPool* pool,
               ::parquet::ArrowReaderProperties properties) {
     file_ = file;
+    fixed_batch_size_ = properties.batch_size();
     RETURN_NOT_OK(GetRowGroupOffset(file_));
     RETURN_NOT_OK(::parquet::arrow::FileReader::Make(
         pool, ::parquet::ParquetFileReader::Open(file_), properties, &parquet_reader_));
@@ -56,6 +61,7 @@ class ParquetFileReader::Impl {
 
   Status InitRecordBatchReader(const std::vector<int>& column_indices,
                                const std::vector<int>& row_group_indices) {
+    SetBatchSize(column_indices, row_group_indices);
     RETURN_NOT_OK(
         GetRecordBatchReader(row_group_indices, column_indices, &record_batch_reader_));
     RETURN_NOT_OK(record_batch_reader_->ReadNext(&next_batch_));
@@ -79,7 +85,24 @@ class ParquetFileReader::Impl {
   }
 
   Status ReadNext(std::shared_ptr<RecordBatch>* out) {
+    if (row_budget_ == 0) {
+      ReleaseRecordBatchReader();
+    }
     *out = next_batch_;
+    if (next_batch_ == nullptr) {
+      return Status::OK();
+    }
+    if (row_budget_ > 0) {
+      if ((*out)->num_rows() > row_budget_) {
+        *out = (*out)->Slice(0, row_budget_);
+      }
+      row_budget_ -= (*out)->num_rows();
+      if (row_budget_ == 0) {
+        // don't decode a batch nobody will take
+        ReleaseRecordBatchReader();
+        return Status::OK();
+      }
+    }
     auto status = record_batch_reader_->ReadNext(&next_batch_);
     if (!status.ok()) {
       next_batch_ = nullptr;
@@ -87,6 +110,14 @@ class ParquetFileReader::Impl {
     return Status::OK();
   }
 
+  Status SetRowBudget(int64_t rows) {
+    row_budget_ = rows;
+    if (row_budget_ == 0) {
+      ReleaseRecordBatchReader();
+    }
+    return Status::OK();
+  }
+
  private:
   std::shared_ptr<RandomAccessFile> file_;
   std::unique_ptr<::parquet::arrow::FileReader> parquet_reader_;
@@ -94,6 +125,14 @@ class ParquetFileReader::Impl {
   std::shared_ptr<RecordBatch> next_batch_;
   std::shared_ptr<Schema> schema_;
   std::vector<uint64_t> row_group_bytes_;
+  int64_t fixed_batch_size_ = 0;
+  // rows still wanted by a downstream LIMIT, -1 for no limit
+  int64_t row_budget_ = -1;
+
+  void ReleaseRecordBatchReader() {
+    next_batch_ = nullptr;
+    record_batch_reader_ = nullptr;
+  }
 
   Status GetRecordBatchReader(const std::vector<int>& row_group_indices,
                               const std::vector<int>& column_indices,
@@ -106,6 +145,38 @@ class ParquetFileReader::Impl {
     }
   }
 
+  /// Sizes the batches by bytes: the decoded columns are about as wide as their
+  /// uncompressed pages, so the row width comes from the row group metadata of the
+  /// columns read. Narrow rows grow past the batch size the reader was given, up to
+  /// GetBatchMaxRows().
+  void SetBatchSize(const std::vector<int>& column_indices,
+                    const std::vector<int>& row_group_indices) {
+    sparkcolumnarplugin::precompile::BatchSizer sizer(fixed_batch_size_, GetBatchBytes(),
+                                                      GetBatchMaxRows());
+    if (!sizer.adaptive()) return;
+    auto metadata = parquet_reader_->parquet_reader()->metadata();
+    std::vector<int> row_groups = row_group_indices;
+    if (row_groups.empty()) {
+      for (int i = 0; i < metadata->num_row_groups(); i++) row_groups.push_back(i);
+    }
+    int64_t rows = 0;
+    int64_t bytes = 0;
+    for (auto row_group : row_groups) {
+      auto row_group_metadata = metadata->RowGroup(row_group);
+      rows += row_group_metadata->num_rows();
+      if (column_indices.empty()) {
+        bytes += row_group_metadata->total_byte_size();
+        continue;
+      }
+      for (auto column : column_indices) {
+        bytes += row_group_metadata->ColumnChunk(column)->total_uncompressed_size();
+      }
+    }
+    if (rows == 0 || bytes == 0) return;
+    sizer.Estimate(static_cast<double>(bytes) / rows);
+    parquet_reader_->set_batch_size(sizer.NextRows());
+  }
+
   Status GetRowGroupOffset(std::shared_ptr<RandomAccessFile> file) {
     std::unique_ptr<::parquet::ParquetFileReader> reader =
         ::parquet::ParquetFileReader::Open(file);
@@ -171,6 +242,10 @@ Status ParquetFileReader::ReadNext(std::shared_ptr<RecordBatch>* out) {
   return impl_->ReadNext(out);
 }
 
+Status ParquetFileReader::SetRowBudget(int64_t rows) {
+  return impl_->SetRowBudget(rows);
+}
+
 class ParquetFileWriter::Impl {
  public:
   Impl() = default;
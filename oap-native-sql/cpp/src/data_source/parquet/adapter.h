@@ -96,6 +96,12 @@ class ARROW_EXPORT ParquetFileReader {
   /// \param[out] out the returned RecordBatch
   Status ReadNext(std::shared_ptr<RecordBatch>* out);
 
+  /// \brief Stop reading after rows more rows, the last batch is truncated and
+  ///         the decoder is released once they are read. Negative means no limit.
+  ///
+  /// \param[in] rows rows still wanted by a downstream LIMIT
+  Status SetRowBudget(int64_t rows);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sparkcolumnarplugin {
+namespace jni {
+
+/**
+ * An executor wide LRU cache of the immutable results of nativeBuild, keyed by the
+ * serialized inputs they were built from. Values are shared by every task that hits
+ * them, so they must never be modified after insertion. Each value remembers how long
+ * it took to build, which is what a hit saves.
+ * @tparam Value class of the cached objects.
+ */
+template <typename Value>
+class BuildCache {
+ public:
+  explicit BuildCache(size_t capacity) : capacity_(capacity) {}
+
+  /// NATIVESQL_BUILD_CACHE_SIZE entries, 256 by default, 0 disables the cache.
+  static size_t DefaultCapacity() {
+    auto env = std::getenv("NATIVESQL_BUILD_CACHE_SIZE");
+    return env == nullptr ? 256 : std::strtoul(env, nullptr, 10);
+  }
+
+  std::shared_ptr<const Value> Lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      misses_++;
+      return nullptr;
+    }
+    hits_++;
+    saved_nanos_ += it->second.build_nanos;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+    return it->second.value;
+  }
+
+  void Insert(const std::string& key, std::shared_ptr<const Value> value,
+              int64_t build_nanos) {
+    if (capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    // another task may have built the same inputs meanwhile
+    if (map_.find(key) != map_.end()) return;
+    while (map_.size() >= capacity_) {
+      map_.erase(*lru_.back());
+      lru_.pop_back();
+    }
+    auto it = map_.emplace(key, Entry{std::move(value), build_nanos, lru_.end()}).first;
+    lru_.push_front(&it->first);
+    it->second.lru_it = lru_.begin();
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    lru_.clear();
+    map_.clear();
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return map_.size();
+  }
+
+  int64_t hits() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return hits_;
+  }
+
+  int64_t misses() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return misses_;
+  }
+
+  int64_t saved_nanos() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return saved_nanos_;
+  }
+
+ private:
+  // keys of map_ are stable, the recency list only points at them
+  using LruList = std::list<const std::string*>;
+
+  struct Entry {
+    std::shared_ptr<const Value> value;
+    int64_t build_nanos;
+    typename LruList::iterator lru_it;
+  };
+
+  const size_t capacity_;
+  std::mutex mtx_;
+  LruList lru_;
+  std::unordered_map<std::string, Entry> map_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t saved_nanos_ = 0;
+};
+
+}  // namespace jni
+}  // namespace sparkcolumnarplugin
@@ -27,18 +27,28 @@
 #include <arrow/util/compression.h>
 #include <jni.h>
 
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 
+#include "codegen/arrow_compute/ext/codegen_common.h"
 #include "codegen/code_generator_factory.h"
 #include "codegen/common/hash_relation.h"
+#include "codegen/common/limit_result_iterator.h"
 #include "codegen/common/result_iterator.h"
 #include "data_source/parquet/adapter.h"
+#include "jni/build_cache.h"
 #include "jni/concurrent_map.h"
 #include "jni/jni_common.h"
+#include "operators/columnar_to_row_converter.h"
+#include "operators/row_to_columnar_converter.h"
 #include "proto/protobuf_utils.h"
 #include "shuffle/splitter.h"
+#include "utils/gandiva_registry.h"
+#include "utils/huge_page_memory_pool.h"
+#include "utils/spill_arbiter.h"
 
 namespace types {
 class ExpressionList;
@@ -59,6 +69,9 @@ static jmethodID serializable_obj_builder_constructor;
 static jclass split_result_class;
 static jmethodID split_result_constructor;
 
+static jclass arrow_columnar_to_row_info_class;
+static jmethodID arrow_columnar_to_row_info_constructor;
+
 static jclass native_memory_reservation_class;
 static jclass native_direct_memory_reservation_class;
 static jmethodID reserve_memory_method;
@@ -81,8 +94,23 @@ static arrow::jni::ConcurrentMap<std::shared_ptr<arrow::Schema>>
     decompression_schema_holder_;
 static arrow::jni::ConcurrentMap<arrow::MemoryPool*> memory_pool_holder;
 
+using sparkcolumnarplugin::columnartorow::ColumnarToRowConverter;
+static arrow::jni::ConcurrentMap<std::shared_ptr<ColumnarToRowConverter>>
+    columnar_to_row_converter_holder_;
+
 static int64_t default_memory_pool_id;
 
+// Parsed inputs of nativeBuild, shared by the tasks building the same plan. Every task
+// still creates its own CodeGenerator from them.
+struct ParsedPlan {
+  std::shared_ptr<arrow::Schema> schema;
+  gandiva::ExpressionVector expr_vector;
+  gandiva::FieldVector ret_types;
+  gandiva::ExpressionVector finish_expr_vector;
+};
+static sparkcolumnarplugin::jni::BuildCache<ParsedPlan> plan_cache_(
+    sparkcolumnarplugin::jni::BuildCache<ParsedPlan>::DefaultCapacity());
+
 std::shared_ptr<CodeGenerator> GetCodeGenerator(JNIEnv* env, jlong id) {
   auto handler = handler_holder_.Lookup(id);
   if (!handler) {
@@ -177,6 +205,44 @@ std::shared_ptr<ParquetFileWriter> GetFileWriter(JNIEnv* env, jlong id) {
   return writer;
 }
 
+// attempt id of the task running on the calling thread, -1 outside of a task
+int64_t GetTaskAttemptId(JNIEnv* env) {
+  jclass tc_cls = env->FindClass("org/apache/spark/TaskContext");
+  jmethodID get_tc_mid =
+      env->GetStaticMethodID(tc_cls, "get", "()Lorg/apache/spark/TaskContext;");
+  jobject tc_obj = env->CallStaticObjectMethod(tc_cls, get_tc_mid);
+  if (tc_obj == NULL) {
+    std::cout << "TaskContext.get() return NULL" << std::endl;
+    return -1;
+  }
+  jmethodID get_tsk_attmpt_mid = env->GetMethodID(tc_cls, "taskAttemptId", "()J");
+  jlong attmpt_id = env->CallLongMethod(tc_obj, get_tsk_attmpt_mid);
+  return (int64_t)attmpt_id;
+}
+
+// Detaches the thread it belongs to from the JVM when the thread exits.
+struct ThreadDetacher {
+  JavaVM* vm = nullptr;
+  ~ThreadDetacher() {
+    if (vm != nullptr) vm->DetachCurrentThread();
+  }
+};
+
+// Morsel workers of a whole stage codegen task allocate from the task's pool on threads
+// the JVM never saw, they are attached on their first reservation and detached on exit.
+bool GetOrAttachEnv(JavaVM* vm, JNIEnv** env) {
+  static thread_local ThreadDetacher detacher;
+  auto status = vm->GetEnv(reinterpret_cast<void**>(env), JNI_VERSION);
+  if (status == JNI_OK) return true;
+  if (status != JNI_EDETACHED ||
+      vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(env), nullptr) !=
+          JNI_OK) {
+    return false;
+  }
+  detacher.vm = vm;
+  return true;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -189,9 +255,12 @@ class ReserveMemory : public arrow::ReservationListener {
 
   arrow::Status OnReservation(int64_t size) override {
     JNIEnv* env;
-    if (vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION) != JNI_OK) {
-      return arrow::Status::Invalid("JNIEnv was not attached to current thread");
+    if (!GetOrAttachEnv(vm_, &env)) {
+      return arrow::Status::Invalid("Unable to attach current thread to the JVM");
     }
+    // Spark's MemoryConsumer counts its bytes unsynchronized, morsel workers reserve
+    // concurrently
+    std::lock_guard<std::mutex> lock(mutex_);
     env->CallObjectMethod(memory_reservation_, reserve_memory_method, size);
     if (env->ExceptionCheck()) {
       env->ExceptionDescribe();
@@ -203,9 +272,10 @@ class ReserveMemory : public arrow::ReservationListener {
 
   arrow::Status OnRelease(int64_t size) override {
     JNIEnv* env;
-    if (vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION) != JNI_OK) {
-      return arrow::Status::Invalid("JNIEnv was not attached to current thread");
+    if (!GetOrAttachEnv(vm_, &env)) {
+      return arrow::Status::Invalid("Unable to attach current thread to the JVM");
     }
+    std::lock_guard<std::mutex> lock(mutex_);
     env->CallObjectMethod(memory_reservation_, unreserve_memory_method, size);
     if (env->ExceptionCheck()) {
       env->ExceptionDescribe();
@@ -222,6 +292,7 @@ class ReserveMemory : public arrow::ReservationListener {
  private:
   JavaVM* vm_;
   jobject memory_reservation_;
+  std::mutex mutex_;
 };
 
 jint JNI_OnLoad(JavaVM* vm, void* reserved) {
@@ -264,6 +335,11 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved) {
       CreateGlobalClassReference(env, "Lcom/intel/oap/vectorized/SplitResult;");
   split_result_constructor = GetMethodID(env, split_result_class, "<init>", "(JJJJJ[J)V");
 
+  arrow_columnar_to_row_info_class = CreateGlobalClassReference(
+      env, "Lcom/intel/oap/vectorized/ArrowColumnarToRowInfo;");
+  arrow_columnar_to_row_info_constructor =
+      GetMethodID(env, arrow_columnar_to_row_info_class, "<init>", "(J[J[JJ)V");
+
 
   native_memory_reservation_class =
       CreateGlobalClassReference(env,
@@ -299,6 +375,7 @@ void JNI_OnUnload(JavaVM* vm, void* reserved) {
   env->DeleteGlobalRef(arrow_record_batch_builder_class);
   env->DeleteGlobalRef(serializable_obj_builder_class);
   env->DeleteGlobalRef(split_result_class);
+  env->DeleteGlobalRef(arrow_columnar_to_row_info_class);
 
   env->DeleteGlobalRef(native_memory_reservation_class);
   env->DeleteGlobalRef(native_direct_memory_reservation_class);
@@ -308,7 +385,9 @@ void JNI_OnUnload(JavaVM* vm, void* reserved) {
   batch_iterator_holder_.Clear();
   shuffle_splitter_holder_.Clear();
   decompression_schema_holder_.Clear();
+  columnar_to_row_converter_holder_.Clear();
   memory_pool_holder.Clear();
+  plan_cache_.Clear();
 
   default_memory_pool_id = -1L;
 }
@@ -328,16 +407,33 @@ JNIEXPORT jlong JNICALL Java_com_intel_oap_vectorized_ExpressionMemoryPool_creat
   }
   std::shared_ptr<arrow::ReservationListener> listener =
       std::make_shared<ReserveMemory>(vm, jlistener_ref);
+  // large buffers are still reserved through the listener when backed by huge pages
+  arrow::MemoryPool* backing_pool = getHugePageMode() == HUGEPAGE_OFF
+                                        ? arrow::default_memory_pool()
+                                        : sparkcolumnarplugin::GetHugePageMemoryPool();
+  auto listenable_pool =
+      new arrow::ReservationListenableMemoryPool(backing_pool, listener);
+  // pools of the same task share an arbiter, which spills registered operators when a
+  // reservation fails
+  auto task_attempt_id = GetTaskAttemptId(env);
+  auto arbiter = task_attempt_id < 0
+                     ? std::make_shared<sparkcolumnarplugin::SpillArbiter>()
+                     : sparkcolumnarplugin::SpillArbiter::ForTask(task_attempt_id);
   auto memory_pool =
-      new arrow::ReservationListenableMemoryPool(arrow::default_memory_pool(), listener);
+      new sparkcolumnarplugin::ArbitratedMemoryPool(listenable_pool, arbiter);
   return memory_pool_holder.Insert(memory_pool);
 }
 
 JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_ExpressionMemoryPool_releaseMemoryPool
     (JNIEnv* env, jclass, jlong memory_pool_id) {
+  auto arbitrated_pool = dynamic_cast<sparkcolumnarplugin::ArbitratedMemoryPool*>(
+      memory_pool_holder.Lookup(memory_pool_id));
+  if (arbitrated_pool == nullptr) {
+    return;
+  }
   arrow::ReservationListenableMemoryPool* pool =
       dynamic_cast<arrow::ReservationListenableMemoryPool*>(
-          memory_pool_holder.Lookup(memory_pool_id));
+          arbitrated_pool->delegated());
   if (pool == nullptr) {
     return;
   }
@@ -348,6 +444,34 @@ JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_ExpressionMemoryPool_releas
   }
   env->DeleteGlobalRef(rm->GetMemoryReservation());
   memory_pool_holder.Erase(memory_pool_id);
+  // buffers still allocated keep the pools alive, they only give up the task's arbiter
+  if (arbitrated_pool->bytes_allocated() == 0) {
+    delete arbitrated_pool;
+    delete pool;
+  } else {
+    arbitrated_pool->ReleaseArbiter();
+  }
+  sparkcolumnarplugin::SpillArbiter::RemoveFinishedTasks();
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_intel_oap_vectorized_ExpressionMemoryPool_getSpillMetrics(
+    JNIEnv* env, jclass, jlong memory_pool_id, jstring jspillable_name) {
+  jlong metrics[3] = {0, 0, 0};
+  auto arbiter =
+      sparkcolumnarplugin::GetSpillArbiter(memory_pool_holder.Lookup(memory_pool_id));
+  if (arbiter != nullptr) {
+    auto spillable_metrics = arbiter->metrics();
+    auto it = spillable_metrics.find(JStringToCString(env, jspillable_name));
+    metrics[0] = arbiter->num_triggers();
+    if (it != spillable_metrics.end()) {
+      metrics[1] = it->second.num_spills;
+      metrics[2] = it->second.bytes_reclaimed;
+    }
+  }
+  jlongArray out = env->NewLongArray(3);
+  env->SetLongArrayRegion(out, 0, 3, metrics);
+  return out;
 }
 
 JNIEXPORT void JNICALL
@@ -365,40 +489,82 @@ Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeSetBatchSize(
   setenv("NATIVESQL_BATCH_SIZE", std::to_string(batch_size).c_str(), 1);
 }
 
-JNIEXPORT jlong JNICALL
-Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeBuild(
-    JNIEnv* env, jobject obj, jbyteArray schema_arr, jbyteArray exprs_arr,
-    jbyteArray res_schema_arr, jboolean return_when_finish = false) {
-  arrow::Status status;
+// Length prefixed, so the same bytes split differently between the arrays don't collide.
+void AppendPlanCacheKey(JNIEnv* env, jbyteArray arr, std::string* key) {
+  int32_t len = arr == nullptr ? -1 : env->GetArrayLength(arr);
+  key->append(reinterpret_cast<const char*>(&len), sizeof(len));
+  if (len > 0) {
+    auto offset = key->size();
+    key->resize(offset + len);
+    env->GetByteArrayRegion(arr, 0, len, reinterpret_cast<jbyte*>(&(*key)[offset]));
+  }
+}
 
-  std::shared_ptr<arrow::Schema> schema;
-  arrow::Status msg = MakeSchema(env, schema_arr, &schema);
-  if (!msg.ok()) {
-    std::string error_message = "failed to readSchema, err msg is " + msg.message();
-    env->ThrowNew(io_exception_class, error_message.c_str());
+arrow::Status GetParsedPlan(JNIEnv* env, jbyteArray schema_arr, jbyteArray exprs_arr,
+                            jbyteArray res_schema_arr, jbyteArray finish_exprs_arr,
+                            std::shared_ptr<const ParsedPlan>* out) {
+  std::string key;
+  AppendPlanCacheKey(env, schema_arr, &key);
+  AppendPlanCacheKey(env, exprs_arr, &key);
+  AppendPlanCacheKey(env, res_schema_arr, &key);
+  AppendPlanCacheKey(env, finish_exprs_arr, &key);
+  *out = plan_cache_.Lookup(key);
+  if (*out) {
+    return arrow::Status::OK();
   }
 
-  gandiva::ExpressionVector expr_vector;
-  gandiva::FieldVector ret_types;
-  msg = MakeExprVector(env, exprs_arr, &expr_vector, &ret_types);
+  auto start = std::chrono::steady_clock::now();
+  auto plan = std::make_shared<ParsedPlan>();
+  arrow::Status msg = MakeSchema(env, schema_arr, &plan->schema);
   if (!msg.ok()) {
-    std::string error_message =
-        "failed to parse expressions protobuf, err msg is " + msg.message();
-    env->ThrowNew(io_exception_class, error_message.c_str());
+    return arrow::Status::Invalid("failed to readSchema, err msg is ", msg.message());
+  }
+  msg = MakeExprVector(env, exprs_arr, &plan->expr_vector, &plan->ret_types);
+  if (!msg.ok()) {
+    return arrow::Status::Invalid("failed to parse expressions protobuf, err msg is ",
+                                  msg.message());
   }
-
   if (res_schema_arr != nullptr) {
     std::shared_ptr<arrow::Schema> resSchema;
     msg = MakeSchema(env, res_schema_arr, &resSchema);
     if (!msg.ok()) {
-      std::string error_message = "failed to readSchema, err msg is " + msg.message();
-      env->ThrowNew(io_exception_class, error_message.c_str());
+      return arrow::Status::Invalid("failed to readSchema, err msg is ", msg.message());
+    }
+    plan->ret_types = resSchema->fields();
+  }
+  if (finish_exprs_arr != nullptr) {
+    gandiva::FieldVector finish_ret_types;
+    msg = MakeExprVector(env, finish_exprs_arr, &plan->finish_expr_vector,
+                         &finish_ret_types);
+    if (!msg.ok()) {
+      return arrow::Status::Invalid("failed to parse expressions protobuf, err msg is ",
+                                    msg.message());
     }
-    ret_types = resSchema->fields();
+  }
+  auto end = std::chrono::steady_clock::now();
+  plan_cache_.Insert(
+      key, plan,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  *out = plan;
+  return arrow::Status::OK();
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeBuild(
+    JNIEnv* env, jobject obj, jbyteArray schema_arr, jbyteArray exprs_arr,
+    jbyteArray res_schema_arr, jboolean return_when_finish = false) {
+  arrow::Status status;
+
+  std::shared_ptr<const ParsedPlan> plan;
+  arrow::Status msg =
+      GetParsedPlan(env, schema_arr, exprs_arr, res_schema_arr, nullptr, &plan);
+  if (!msg.ok()) {
+    env->ThrowNew(io_exception_class, msg.message().c_str());
+    return -1;
   }
 
 #ifdef DEBUG
-  for (auto expr : expr_vector) {
+  for (auto expr : plan->expr_vector) {
     std::cout << expr->ToString() << std::endl;
   }
 #endif
@@ -406,7 +572,7 @@ Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeBuild(
   std::shared_ptr<CodeGenerator> handler;
   try {
     msg = sparkcolumnarplugin::codegen::CreateCodeGenerator(
-        schema, expr_vector, ret_types, &handler, return_when_finish);
+        plan->schema, plan->expr_vector, plan->ret_types, &handler, return_when_finish);
   } catch (const std::runtime_error& error) {
     env->ThrowNew(unsupportedoperation_exception_class, error.what());
   } catch (const std::exception& error) {
@@ -437,35 +603,19 @@ Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeBuildWithFinis
     jbyteArray finish_exprs_arr) {
   arrow::Status status;
 
-  std::shared_ptr<arrow::Schema> schema;
-  arrow::Status msg = MakeSchema(env, schema_arr, &schema);
-  if (!msg.ok()) {
-    std::string error_message = "failed to readSchema, err msg is " + msg.message();
-    env->ThrowNew(io_exception_class, error_message.c_str());
-  }
-
-  gandiva::ExpressionVector expr_vector;
-  gandiva::FieldVector ret_types;
-  msg = MakeExprVector(env, exprs_arr, &expr_vector, &ret_types);
-  if (!msg.ok()) {
-    std::string error_message =
-        "failed to parse expressions protobuf, err msg is " + msg.message();
-    env->ThrowNew(io_exception_class, error_message.c_str());
-  }
-
-  gandiva::ExpressionVector finish_expr_vector;
-  gandiva::FieldVector finish_ret_types;
-  msg = MakeExprVector(env, finish_exprs_arr, &finish_expr_vector, &finish_ret_types);
+  std::shared_ptr<const ParsedPlan> plan;
+  arrow::Status msg =
+      GetParsedPlan(env, schema_arr, exprs_arr, nullptr, finish_exprs_arr, &plan);
   if (!msg.ok()) {
-    std::string error_message =
-        "failed to parse expressions protobuf, err msg is " + msg.message();
-    env->ThrowNew(io_exception_class, error_message.c_str());
+    env->ThrowNew(io_exception_class, msg.message().c_str());
+    return -1;
   }
 
   std::shared_ptr<CodeGenerator> handler;
   try {
     msg = sparkcolumnarplugin::codegen::CreateCodeGenerator(
-        schema, expr_vector, ret_types, &handler, true, finish_expr_vector);
+        plan->schema, plan->expr_vector, plan->ret_types, &handler, true,
+        plan->finish_expr_vector);
   } catch (const std::runtime_error& error) {
     env->ThrowNew(unsupportedoperation_exception_class, error.what());
   } catch (const std::exception& error) {
@@ -573,6 +723,31 @@ Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeGetSignature(
   return env->NewStringUTF((handler->GetSignature()).c_str());
 }
 
+JNIEXPORT jlongArray JNICALL
+Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeGetBuildCacheMetrics(
+    JNIEnv* env, jobject obj) {
+  int64_t library_hits;
+  int64_t library_misses;
+  sparkcolumnarplugin::codegen::arrowcompute::extra::GetLoadLibraryMetrics(
+      &library_hits, &library_misses);
+  jlong metrics[5] = {plan_cache_.hits(), plan_cache_.misses(), plan_cache_.saved_nanos(),
+                      library_hits, library_misses};
+  jlongArray out = env->NewLongArray(5);
+  env->SetLongArrayRegion(out, 0, 5, metrics);
+  return out;
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeGetGandivaCacheMetrics(
+    JNIEnv* env, jclass cls) {
+  auto gandiva = sparkcolumnarplugin::GandivaRegistry::ThreadMetrics();
+  jlong metrics[5] = {gandiva.hits, gandiva.misses, gandiva.saved_nanos, gandiva.evictions,
+                      gandiva.inserts};
+  jlongArray out = env->NewLongArray(5);
+  env->SetLongArrayRegion(out, 0, 5, metrics);
+  return out;
+}
+
 JNIEXPORT jobject JNICALL
 Java_com_intel_oap_vectorized_ExpressionEvaluatorJniWrapper_nativeEvaluateWithSelection(
     JNIEnv* env, jobject obj, jlong id, jint num_rows, jlongArray buf_addrs,
@@ -1009,6 +1184,51 @@ JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_BatchIterator_nativeSetDepe
   env->ReleaseLongArrayElements(ids, ids_data, JNI_ABORT);
 }
 
+JNIEXPORT jlong JNICALL Java_com_intel_oap_vectorized_BatchIterator_nativeMakeLimit(
+    JNIEnv* env, jobject this_obj, jlong id, jlong limit) {
+  arrow::Status status;
+  auto iter = GetBatchIterator<arrow::RecordBatch>(env, id);
+  std::shared_ptr<ResultIterator<arrow::RecordBatch>> out;
+  status = LimitResultIterator::Make(iter, limit, &out);
+  if (!status.ok()) {
+    std::string error_message =
+        "nativeMakeLimit: failed to push the limit upstream, err msg is " +
+        status.message();
+    env->ThrowNew(io_exception_class, error_message.c_str());
+  }
+  return batch_iterator_holder_.Insert(std::move(out));
+}
+
+JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_BatchIterator_nativeSetRowBudget(
+    JNIEnv* env, jobject this_obj, jlong id, jlong rows) {
+  auto iter = GetBatchIterator(env, id);
+  auto status = iter->SetRowBudget(rows);
+  if (!status.ok()) {
+    std::string error_message =
+        "nativeSetRowBudget: failed with error msg " + status.ToString();
+    env->ThrowNew(io_exception_class, error_message.c_str());
+  }
+}
+
+JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_BatchIterator_nativeFinishInput(
+    JNIEnv* env, jobject this_obj, jlong id) {
+  auto iter = GetBatchIterator(env, id);
+  auto status = iter->FinishInput();
+  if (!status.ok()) {
+    std::string error_message =
+        "nativeFinishInput: failed with error msg " + status.ToString();
+    env->ThrowNew(io_exception_class, error_message.c_str());
+  }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_intel_oap_vectorized_BatchIterator_nativeBudgetExhausted(JNIEnv* env,
+                                                                  jobject this_obj,
+                                                                  jlong id) {
+  auto iter = GetBatchIterator(env, id);
+  return iter->BudgetExhausted();
+}
+
 JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_BatchIterator_nativeClose(
     JNIEnv* env, jobject this_obj, jlong id) {
 #ifdef DEBUG
@@ -1174,6 +1394,19 @@ Java_com_intel_oap_datasource_parquet_ParquetReaderJniWrapper_nativeReadNext(JNI
   return MakeRecordBatchBuilder(env, record_batch->schema(), record_batch);
 }
 
+JNIEXPORT void JNICALL
+Java_com_intel_oap_datasource_parquet_ParquetReaderJniWrapper_nativeSetRowBudget(
+    JNIEnv* env, jobject obj, jlong id, jlong rows) {
+  arrow::Status status;
+  auto reader = GetFileReader(env, id);
+  status = reader->SetRowBudget(rows);
+  if (!status.ok()) {
+    std::string error_message =
+        "nativeSetRowBudget: failed to set row budget, err is " + status.message();
+    env->ThrowNew(io_exception_class, error_message.c_str());
+  }
+}
+
 JNIEXPORT jobject JNICALL
 Java_com_intel_oap_datasource_parquet_ParquetReaderJniWrapper_nativeGetSchema(JNIEnv* env,
                                                                               jobject obj,
@@ -1305,7 +1538,7 @@ Java_com_intel_oap_vectorized_ShuffleSplitterJniWrapper_nativeMake(
     JNIEnv* env, jobject, jstring partitioning_name_jstr, jint num_partitions,
     jbyteArray schema_arr, jbyteArray expr_arr, jint buffer_size,
     jstring compression_type_jstr, jstring data_file_jstr, jint num_sub_dirs,
-    jstring local_dirs_jstr) {
+    jstring local_dirs_jstr, jlong memory_pool_id) {
   if (partitioning_name_jstr == NULL) {
     env->ThrowNew(illegal_argument_exception_class,
                   std::string("Short partitioning name can't be null").c_str());
@@ -1383,17 +1616,22 @@ Java_com_intel_oap_vectorized_ShuffleSplitterJniWrapper_nativeMake(
     splitOptions.thread_id = (int64_t)sid;
   }
 
-  jclass tc_cls = env->FindClass("org/apache/spark/TaskContext");
-  jmethodID get_tc_mid = env->GetStaticMethodID(tc_cls, "get", "()Lorg/apache/spark/TaskContext;");
-  jobject tc_obj = env->CallStaticObjectMethod(tc_cls, get_tc_mid);
-  if (tc_obj == NULL) {
-    std::cout << "TaskContext.get() return NULL" << std::endl;
-  } else {
-    jmethodID get_tsk_attmpt_mid = env->GetMethodID(tc_cls, "taskAttemptId", "()J");
-    jlong attmpt_id = env->CallLongMethod(tc_obj, get_tsk_attmpt_mid);
-    splitOptions.task_attempt_id = (int64_t)attmpt_id;
+  auto task_attempt_id = GetTaskAttemptId(env);
+  if (task_attempt_id >= 0) {
+    splitOptions.task_attempt_id = task_attempt_id;
   }
 
+  // partition buffers come from the task's pool, so that the splitter can be spilled
+  // when another operator of the task runs out of memory
+  auto pool = memory_pool_holder.Lookup(memory_pool_id);
+  if (pool == nullptr) {
+    std::string error_message =
+        "Invalid memory pool id " + std::to_string(memory_pool_id);
+    env->ThrowNew(illegal_argument_exception_class, error_message.c_str());
+    return 0;
+  }
+  splitOptions.memory_pool = pool;
+
   auto make_result = Splitter::Make(partitioning_name, std::move(schema), num_partitions,
                                     expr_vector, std::move(splitOptions));
   if (!make_result.ok()) {
@@ -1614,6 +1852,137 @@ JNIEXPORT void JNICALL Java_com_intel_oap_vectorized_ShuffleDecompressionJniWrap
   decompression_schema_holder_.Erase(schema_holder_id);
 }
 
+JNIEXPORT jobject JNICALL
+Java_com_intel_oap_vectorized_ArrowColumnarToRowJniWrapper_nativeConvertColumnarToRow(
+    JNIEnv* env, jobject, jbyteArray schema_arr, jint num_rows, jlongArray buf_addrs,
+    jlongArray buf_sizes, jlong memory_pool_id) {
+  if (buf_addrs == NULL) {
+    env->ThrowNew(illegal_argument_exception_class,
+                  std::string("Native convert columnar to row: buf_addrs can't be null")
+                      .c_str());
+    return nullptr;
+  }
+  if (buf_sizes == NULL) {
+    env->ThrowNew(illegal_argument_exception_class,
+                  std::string("Native convert columnar to row: buf_sizes can't be null")
+                      .c_str());
+    return nullptr;
+  }
+  int in_bufs_len = env->GetArrayLength(buf_addrs);
+  if (in_bufs_len != env->GetArrayLength(buf_sizes)) {
+    env->ThrowNew(illegal_argument_exception_class,
+                  std::string("Native convert columnar to row: length of buf_addrs and "
+                              "buf_sizes mismatch")
+                      .c_str());
+    return nullptr;
+  }
+  auto pool = memory_pool_holder.Lookup(memory_pool_id);
+  if (pool == nullptr) {
+    std::string error_message =
+        "Invalid memory pool id " + std::to_string(memory_pool_id);
+    env->ThrowNew(illegal_argument_exception_class, error_message.c_str());
+    return nullptr;
+  }
+
+  std::shared_ptr<arrow::Schema> schema;
+  // ValueOrDie in MakeSchema
+  MakeSchema(env, schema_arr, &schema);
+
+  jlong* in_buf_addrs = env->GetLongArrayElements(buf_addrs, JNI_FALSE);
+  jlong* in_buf_sizes = env->GetLongArrayElements(buf_sizes, JNI_FALSE);
+
+  std::shared_ptr<arrow::RecordBatch> rb;
+  auto status = MakeRecordBatch(schema, num_rows, (int64_t*)in_buf_addrs,
+                                (int64_t*)in_buf_sizes, in_bufs_len, &rb);
+
+  env->ReleaseLongArrayElements(buf_addrs, in_buf_addrs, JNI_ABORT);
+  env->ReleaseLongArrayElements(buf_sizes, in_buf_sizes, JNI_ABORT);
+
+  if (!status.ok()) {
+    env->ThrowNew(illegal_argument_exception_class,
+                  std::string("Native convert columnar to row: make record batch failed, "
+                              "error message is " +
+                              status.message())
+                      .c_str());
+    return nullptr;
+  }
+
+  auto converter = std::make_shared<ColumnarToRowConverter>(rb, pool);
+  status = converter->Init();
+  if (status.ok()) {
+    status = converter->Write();
+  }
+  if (!status.ok()) {
+    env->ThrowNew(io_exception_class,
+                  std::string("Native convert columnar to row failed, error message is " +
+                              status.message())
+                      .c_str());
+    return nullptr;
+  }
+
+  const auto& offsets = converter->GetOffsets();
+  const auto& lengths = converter->GetLengths();
+  auto offsets_arr = env->NewLongArray(num_rows);
+  env->SetLongArrayRegion(offsets_arr, 0, num_rows,
+                          reinterpret_cast<const jlong*>(offsets.data()));
+  auto lengths_arr = env->NewLongArray(num_rows);
+  env->SetLongArrayRegion(lengths_arr, 0, num_rows,
+                          reinterpret_cast<const jlong*>(lengths.data()));
+  auto address = reinterpret_cast<jlong>(converter->GetBufferAddress());
+  auto instance_id = columnar_to_row_converter_holder_.Insert(converter);
+
+  return env->NewObject(arrow_columnar_to_row_info_class,
+                        arrow_columnar_to_row_info_constructor, instance_id, offsets_arr,
+                        lengths_arr, address);
+}
+
+JNIEXPORT void JNICALL
+Java_com_intel_oap_vectorized_ArrowColumnarToRowJniWrapper_nativeClose(
+    JNIEnv* env, jobject, jlong instance_id) {
+  columnar_to_row_converter_holder_.Erase(instance_id);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_intel_oap_vectorized_ArrowRowToColumnarJniWrapper_nativeConvertRowToColumnar(
+    JNIEnv* env, jobject, jbyteArray schema_arr, jlongArray row_offsets,
+    jlong memory_address, jlong memory_pool_id) {
+  if (row_offsets == NULL) {
+    env->ThrowNew(illegal_argument_exception_class,
+                  std::string("Native convert row to columnar: row_offsets can't be null")
+                      .c_str());
+    return nullptr;
+  }
+  auto pool = memory_pool_holder.Lookup(memory_pool_id);
+  if (pool == nullptr) {
+    std::string error_message =
+        "Invalid memory pool id " + std::to_string(memory_pool_id);
+    env->ThrowNew(illegal_argument_exception_class, error_message.c_str());
+    return nullptr;
+  }
+
+  std::shared_ptr<arrow::Schema> schema;
+  // ValueOrDie in MakeSchema
+  MakeSchema(env, schema_arr, &schema);
+
+  int num_rows = env->GetArrayLength(row_offsets);
+  jlong* in_row_offsets = env->GetLongArrayElements(row_offsets, JNI_FALSE);
+  sparkcolumnarplugin::rowtocolumnar::RowToColumnarConverter converter(
+      schema, num_rows, reinterpret_cast<const int64_t*>(in_row_offsets),
+      reinterpret_cast<const uint8_t*>(memory_address), pool);
+  std::shared_ptr<arrow::RecordBatch> rb;
+  auto status = converter.Convert(&rb);
+  env->ReleaseLongArrayElements(row_offsets, in_row_offsets, JNI_ABORT);
+
+  if (!status.ok()) {
+    env->ThrowNew(io_exception_class,
+                  std::string("Native convert row to columnar failed, error message is " +
+                              status.message())
+                      .c_str());
+    return nullptr;
+  }
+  return MakeRecordBatchBuilder(env, schema, rb);
+}
+
 #ifdef __cplusplus
 }
 #endif
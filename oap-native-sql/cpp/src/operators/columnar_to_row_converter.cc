@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "operators/columnar_to_row_converter.h"
+
+#include <arrow/array.h>
+#include <arrow/type.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/util/decimal.h>
+#include <string.h>
+
+namespace sparkcolumnarplugin {
+namespace columnartorow {
+
+namespace {
+
+inline void SetNullAt(uint8_t* row, int32_t col_index) {
+  row[col_index >> 3] |= static_cast<uint8_t>(1 << (col_index & 7));
+}
+
+// Spark keeps decimals up to 18 digits as the unscaled long, wider ones as the
+// minimal big-endian two's complement bytes of the unscaled value.
+inline bool IsCompactDecimal(const std::shared_ptr<arrow::DataType>& type) {
+  return std::static_pointer_cast<arrow::Decimal128Type>(type)->precision() <= 18;
+}
+
+int32_t ToMinimalBigEndian(const arrow::Decimal128& value, uint8_t* out) {
+  auto le = value.ToBytes();
+  uint8_t be[16];
+  for (int i = 0; i < 16; i++) {
+    be[i] = le[15 - i];
+  }
+  int32_t begin = 0;
+  while (begin < 15 && ((be[begin] == 0x00 && (be[begin + 1] & 0x80) == 0) ||
+                        (be[begin] == 0xFF && (be[begin + 1] & 0x80) != 0))) {
+    begin++;
+  }
+  memcpy(out, be + begin, 16 - begin);
+  return 16 - begin;
+}
+
+int32_t GetFixedWidth(arrow::Type::type type_id) {
+  switch (type_id) {
+    case arrow::Type::BOOL:
+    case arrow::Type::INT8:
+      return 1;
+    case arrow::Type::INT16:
+      return 2;
+    case arrow::Type::INT32:
+    case arrow::Type::DATE32:
+    case arrow::Type::FLOAT:
+      return 4;
+    case arrow::Type::INT64:
+    case arrow::Type::DATE64:
+    case arrow::Type::TIMESTAMP:
+    case arrow::Type::DOUBLE:
+      return 8;
+    default:
+      return -1;
+  }
+}
+
+template <typename T>
+void WriteFixedWidth(const arrow::Array& array, uint8_t* buffer,
+                     const std::vector<int64_t>& offsets, int64_t field_offset,
+                     int32_t col_index) {
+  auto values = array.data()->GetValues<T>(1);
+  if (array.null_count() == 0) {
+    for (int64_t i = 0; i < array.length(); i++) {
+      memcpy(buffer + offsets[i] + field_offset, values + i, sizeof(T));
+    }
+  } else {
+    for (int64_t i = 0; i < array.length(); i++) {
+      if (array.IsNull(i)) {
+        SetNullAt(buffer + offsets[i], col_index);
+      } else {
+        memcpy(buffer + offsets[i] + field_offset, values + i, sizeof(T));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+arrow::Status ColumnarToRowConverter::Init() {
+  num_rows_ = rb_->num_rows();
+  num_cols_ = rb_->num_columns();
+  nullbitset_width_ = CalculateBitSetWidthInBytes(num_cols_);
+  int64_t fixed_size = nullbitset_width_ + num_cols_ * 8;
+  lengths_.assign(num_rows_, fixed_size);
+
+  for (int32_t col_index = 0; col_index < num_cols_; col_index++) {
+    auto array = rb_->column(col_index);
+    auto type_id = array->type_id();
+    if (type_id == arrow::Type::STRING || type_id == arrow::Type::BINARY) {
+      auto binary_array = std::static_pointer_cast<arrow::BinaryArray>(array);
+      auto value_offsets = binary_array->raw_value_offsets();
+      for (int64_t i = 0; i < num_rows_; i++) {
+        if (!binary_array->IsNull(i)) {
+          lengths_[i] +=
+              RoundNumberOfBytesToNearestWord(value_offsets[i + 1] - value_offsets[i]);
+        }
+      }
+    } else if (type_id == arrow::Type::DECIMAL) {
+      // like Spark's UnsafeRowWriter, a wide decimal keeps its 16 bytes when null
+      if (!IsCompactDecimal(array->type())) {
+        for (int64_t i = 0; i < num_rows_; i++) {
+          lengths_[i] += 16;
+        }
+      }
+    } else if (GetFixedWidth(type_id) < 0) {
+      return arrow::Status::NotImplemented("ColumnarToRowConverter doesn't support ",
+                                           array->type()->ToString());
+    }
+  }
+
+  offsets_.resize(num_rows_);
+  int64_t total_size = 0;
+  for (int64_t i = 0; i < num_rows_; i++) {
+    offsets_[i] = total_size;
+    total_size += lengths_[i];
+  }
+  var_cursors_.assign(num_rows_, fixed_size);
+
+  ARROW_ASSIGN_OR_RAISE(buffer_, arrow::AllocateBuffer(total_size, pool_));
+  buffer_address_ = buffer_->mutable_data();
+  // null bits and the padding of variable length data must be zero
+  memset(buffer_address_, 0, total_size);
+  return arrow::Status::OK();
+}
+
+arrow::Status ColumnarToRowConverter::Write() {
+  for (int32_t col_index = 0; col_index < num_cols_; col_index++) {
+    RETURN_NOT_OK(WriteColumn(col_index));
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status ColumnarToRowConverter::WriteColumn(int32_t col_index) {
+  auto array = rb_->column(col_index);
+  int64_t field_offset = nullbitset_width_ + col_index * 8;
+  switch (array->type_id()) {
+    case arrow::Type::BOOL: {
+      auto data = array->data();
+      auto values = data->buffers[1]->data();
+      for (int64_t i = 0; i < num_rows_; i++) {
+        if (array->IsNull(i)) {
+          SetNullAt(buffer_address_ + offsets_[i], col_index);
+        } else {
+          buffer_address_[offsets_[i] + field_offset] =
+              arrow::BitUtil::GetBit(values, data->offset + i);
+        }
+      }
+    } break;
+    case arrow::Type::INT8:
+      WriteFixedWidth<int8_t>(*array, buffer_address_, offsets_, field_offset, col_index);
+      break;
+    case arrow::Type::INT16:
+      WriteFixedWidth<int16_t>(*array, buffer_address_, offsets_, field_offset,
+                               col_index);
+      break;
+    case arrow::Type::INT32:
+    case arrow::Type::DATE32:
+    case arrow::Type::FLOAT:
+      WriteFixedWidth<int32_t>(*array, buffer_address_, offsets_, field_offset,
+                               col_index);
+      break;
+    case arrow::Type::INT64:
+    case arrow::Type::DATE64:
+    case arrow::Type::TIMESTAMP:
+    case arrow::Type::DOUBLE:
+      WriteFixedWidth<int64_t>(*array, buffer_address_, offsets_, field_offset,
+                               col_index);
+      break;
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: {
+      auto binary_array = std::static_pointer_cast<arrow::BinaryArray>(array);
+      for (int64_t i = 0; i < num_rows_; i++) {
+        auto row = buffer_address_ + offsets_[i];
+        if (binary_array->IsNull(i)) {
+          SetNullAt(row, col_index);
+          continue;
+        }
+        int32_t length;
+        auto value = binary_array->GetValue(i, &length);
+        memcpy(row + var_cursors_[i], value, length);
+        int64_t offset_and_size = (var_cursors_[i] << 32) | length;
+        memcpy(row + field_offset, &offset_and_size, sizeof(int64_t));
+        var_cursors_[i] += RoundNumberOfBytesToNearestWord(length);
+      }
+    } break;
+    case arrow::Type::DECIMAL: {
+      auto decimal_array = std::static_pointer_cast<arrow::Decimal128Array>(array);
+      bool compact = IsCompactDecimal(array->type());
+      for (int64_t i = 0; i < num_rows_; i++) {
+        auto row = buffer_address_ + offsets_[i];
+        if (decimal_array->IsNull(i)) {
+          SetNullAt(row, col_index);
+          if (!compact) {
+            // the zeroed bytes stay reserved, the offset points at them with size 0
+            int64_t offset_and_size = var_cursors_[i] << 32;
+            memcpy(row + field_offset, &offset_and_size, sizeof(int64_t));
+            var_cursors_[i] += 16;
+          }
+          continue;
+        }
+        arrow::Decimal128 value(decimal_array->GetValue(i));
+        if (compact) {
+          int64_t unscaled = static_cast<int64_t>(value.low_bits());
+          memcpy(row + field_offset, &unscaled, sizeof(int64_t));
+        } else {
+          int64_t size = ToMinimalBigEndian(value, row + var_cursors_[i]);
+          int64_t offset_and_size = (var_cursors_[i] << 32) | size;
+          memcpy(row + field_offset, &offset_and_size, sizeof(int64_t));
+          var_cursors_[i] += 16;
+        }
+      }
+    } break;
+    default:
+      return arrow::Status::NotImplemented("ColumnarToRowConverter doesn't support ",
+                                           array->type()->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+}  // namespace columnartorow
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/status.h>
+
+#include <memory>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace columnartorow {
+
+/// Spark UnsafeRow layout helpers, shared with the row to columnar converter.
+/// A row is | null bit set, 8-byte words | 8 bytes per field | variable length data |
+/// where a variable length field stores (offset in row << 32 | size) in its 8 bytes.
+inline int64_t CalculateBitSetWidthInBytes(int32_t num_fields) {
+  return ((num_fields + 63) / 64) * 8;
+}
+
+inline int64_t RoundNumberOfBytesToNearestWord(int64_t num_bytes) {
+  return (num_bytes + 7) & ~static_cast<int64_t>(7);
+}
+
+/// Converts a whole RecordBatch into one contiguous buffer of Spark UnsafeRows. Row
+/// sizes and offsets are computed first, then every column is written in one pass over
+/// the rows, so each column is read sequentially.
+class ColumnarToRowConverter {
+ public:
+  ColumnarToRowConverter(std::shared_ptr<arrow::RecordBatch> rb, arrow::MemoryPool* pool)
+      : rb_(std::move(rb)), pool_(pool) {}
+
+  /// Computes the row lengths and offsets and allocates the row buffer.
+  arrow::Status Init();
+  /// Writes the rows, Init() must be called first.
+  arrow::Status Write();
+
+  uint8_t* GetBufferAddress() const { return buffer_address_; }
+  int64_t GetBufferSize() const { return buffer_ ? buffer_->size() : 0; }
+  const std::vector<int64_t>& GetOffsets() const { return offsets_; }
+  const std::vector<int64_t>& GetLengths() const { return lengths_; }
+  int64_t GetNumRows() const { return num_rows_; }
+
+ private:
+  arrow::Status WriteColumn(int32_t col_index);
+
+  std::shared_ptr<arrow::RecordBatch> rb_;
+  arrow::MemoryPool* pool_;
+  std::shared_ptr<arrow::Buffer> buffer_;
+  uint8_t* buffer_address_ = nullptr;
+  int64_t num_rows_ = 0;
+  int32_t num_cols_ = 0;
+  int64_t nullbitset_width_ = 0;
+  // offset of each row in the buffer, and its length in bytes
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> lengths_;
+  // next free byte of the variable length region of each row, relative to the row
+  std::vector<int64_t> var_cursors_;
+};
+
+}  // namespace columnartorow
+}  // namespace sparkcolumnarplugin
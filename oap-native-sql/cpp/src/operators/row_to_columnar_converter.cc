@@ -0,0 +1,238 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "operators/row_to_columnar_converter.h"
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/util/bit_util.h>
+#include <string.h>
+
+#include <limits>
+
+namespace sparkcolumnarplugin {
+namespace rowtocolumnar {
+
+namespace {
+
+inline bool IsNullAt(const uint8_t* row, int32_t col_index) {
+  return (row[col_index >> 3] >> (col_index & 7)) & 1;
+}
+
+inline int64_t GetSlot(const uint8_t* row, int64_t field_offset) {
+  int64_t slot;
+  memcpy(&slot, row + field_offset, sizeof(int64_t));
+  return slot;
+}
+
+// Spark zeroes the slot of a null fixed-width field, so the values are copied without
+// looking at the null bits.
+template <typename T>
+void ReadFixedWidth(const uint8_t* memory_address, const int64_t* row_offsets,
+                    int64_t num_rows, int64_t field_offset, uint8_t* out) {
+  auto values = reinterpret_cast<T*>(out);
+  for (int64_t i = 0; i < num_rows; i++) {
+    memcpy(values + i, memory_address + row_offsets[i] + field_offset, sizeof(T));
+  }
+}
+
+// Arrow keeps decimals as 16 bytes little-endian two's complement, Spark as the
+// unscaled long up to 18 digits and as minimal big-endian bytes above.
+void ReadCompactDecimal(int64_t unscaled, uint8_t* out) {
+  int64_t high = unscaled < 0 ? -1 : 0;
+  memcpy(out, &unscaled, sizeof(int64_t));
+  memcpy(out + 8, &high, sizeof(int64_t));
+}
+
+void ReadMinimalBigEndian(const uint8_t* data, int32_t length, uint8_t* out) {
+  uint8_t sign = length > 0 && (data[0] & 0x80) != 0 ? 0xFF : 0x00;
+  memset(out, sign, 16);
+  for (int32_t i = 0; i < length && i < 16; i++) {
+    out[i] = data[length - 1 - i];
+  }
+}
+
+int32_t GetFixedWidth(arrow::Type::type type_id) {
+  switch (type_id) {
+    case arrow::Type::INT8:
+      return 1;
+    case arrow::Type::INT16:
+      return 2;
+    case arrow::Type::INT32:
+    case arrow::Type::DATE32:
+    case arrow::Type::FLOAT:
+      return 4;
+    case arrow::Type::INT64:
+    case arrow::Type::DATE64:
+    case arrow::Type::TIMESTAMP:
+    case arrow::Type::DOUBLE:
+      return 8;
+    default:
+      return -1;
+  }
+}
+
+}  // namespace
+
+arrow::Status RowToColumnarConverter::Convert(std::shared_ptr<arrow::RecordBatch>* out) {
+  nullbitset_width_ = columnartorow::CalculateBitSetWidthInBytes(schema_->num_fields());
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  for (int32_t col_index = 0; col_index < schema_->num_fields(); col_index++) {
+    std::shared_ptr<arrow::ArrayData> data;
+    RETURN_NOT_OK(ReadColumn(col_index, &data));
+    arrays.push_back(arrow::MakeArray(data));
+  }
+  *out = arrow::RecordBatch::Make(schema_, num_rows_, std::move(arrays));
+  return arrow::Status::OK();
+}
+
+arrow::Status RowToColumnarConverter::ReadValidity(int32_t col_index,
+                                                   std::shared_ptr<arrow::Buffer>* out,
+                                                   int64_t* null_count) {
+  std::shared_ptr<arrow::Buffer> validity;
+  ARROW_ASSIGN_OR_RAISE(validity, arrow::AllocateBuffer(
+                                      arrow::BitUtil::BytesForBits(num_rows_), pool_));
+  auto bitmap = validity->mutable_data();
+  memset(bitmap, 0, validity->size());
+  *null_count = 0;
+  for (int64_t i = 0; i < num_rows_; i++) {
+    if (IsNullAt(memory_address_ + row_offsets_[i], col_index)) {
+      (*null_count)++;
+    } else {
+      arrow::BitUtil::SetBit(bitmap, i);
+    }
+  }
+  *out = *null_count == 0 ? nullptr : validity;
+  return arrow::Status::OK();
+}
+
+arrow::Status RowToColumnarConverter::ReadColumn(
+    int32_t col_index, std::shared_ptr<arrow::ArrayData>* out) {
+  auto type = schema_->field(col_index)->type();
+  int64_t field_offset = nullbitset_width_ + col_index * 8;
+  std::shared_ptr<arrow::Buffer> validity;
+  int64_t null_count;
+  RETURN_NOT_OK(ReadValidity(col_index, &validity, &null_count));
+
+  switch (type->id()) {
+    case arrow::Type::BOOL: {
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(values, arrow::AllocateBuffer(
+                                        arrow::BitUtil::BytesForBits(num_rows_), pool_));
+      auto bitmap = values->mutable_data();
+      memset(bitmap, 0, values->size());
+      for (int64_t i = 0; i < num_rows_; i++) {
+        if (memory_address_[row_offsets_[i] + field_offset] != 0) {
+          arrow::BitUtil::SetBit(bitmap, i);
+        }
+      }
+      *out = arrow::ArrayData::Make(type, num_rows_, {validity, values}, null_count);
+    } break;
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: {
+      // first pass sizes the value buffer, the second one copies the values
+      int64_t total_size = 0;
+      for (int64_t i = 0; i < num_rows_; i++) {
+        auto row = memory_address_ + row_offsets_[i];
+        if (!IsNullAt(row, col_index)) {
+          total_size += GetSlot(row, field_offset) & 0xFFFFFFFF;
+        }
+      }
+      if (total_size > std::numeric_limits<int32_t>::max()) {
+        return arrow::Status::CapacityError("RowToColumnarConverter: column ",
+                                            schema_->field(col_index)->name(),
+                                            " is too large for ", type->ToString());
+      }
+      std::shared_ptr<arrow::Buffer> offsets;
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(
+          offsets, arrow::AllocateBuffer((num_rows_ + 1) * sizeof(int32_t), pool_));
+      ARROW_ASSIGN_OR_RAISE(values, arrow::AllocateBuffer(total_size, pool_));
+      auto value_offsets = reinterpret_cast<int32_t*>(offsets->mutable_data());
+      auto value_data = values->mutable_data();
+      int32_t cursor = 0;
+      for (int64_t i = 0; i < num_rows_; i++) {
+        value_offsets[i] = cursor;
+        auto row = memory_address_ + row_offsets_[i];
+        if (IsNullAt(row, col_index)) {
+          continue;
+        }
+        auto offset_and_size = GetSlot(row, field_offset);
+        int32_t length = static_cast<int32_t>(offset_and_size & 0xFFFFFFFF);
+        memcpy(value_data + cursor, row + (offset_and_size >> 32), length);
+        cursor += length;
+      }
+      value_offsets[num_rows_] = cursor;
+      *out = arrow::ArrayData::Make(type, num_rows_, {validity, offsets, values},
+                                    null_count);
+    } break;
+    case arrow::Type::DECIMAL: {
+      bool compact =
+          std::static_pointer_cast<arrow::Decimal128Type>(type)->precision() <= 18;
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(values, arrow::AllocateBuffer(num_rows_ * 16, pool_));
+      auto value_data = values->mutable_data();
+      for (int64_t i = 0; i < num_rows_; i++) {
+        auto row = memory_address_ + row_offsets_[i];
+        auto slot = GetSlot(row, field_offset);
+        if (compact) {
+          ReadCompactDecimal(slot, value_data + i * 16);
+        } else if (IsNullAt(row, col_index)) {
+          memset(value_data + i * 16, 0, 16);
+        } else {
+          ReadMinimalBigEndian(row + (slot >> 32),
+                               static_cast<int32_t>(slot & 0xFFFFFFFF),
+                               value_data + i * 16);
+        }
+      }
+      *out = arrow::ArrayData::Make(type, num_rows_, {validity, values}, null_count);
+    } break;
+    default: {
+      auto width = GetFixedWidth(type->id());
+      if (width < 0) {
+        return arrow::Status::NotImplemented("RowToColumnarConverter doesn't support ",
+                                             type->ToString());
+      }
+      std::shared_ptr<arrow::Buffer> values;
+      ARROW_ASSIGN_OR_RAISE(values, arrow::AllocateBuffer(num_rows_ * width, pool_));
+      auto value_data = values->mutable_data();
+      switch (width) {
+        case 1:
+          ReadFixedWidth<int8_t>(memory_address_, row_offsets_, num_rows_, field_offset,
+                                 value_data);
+          break;
+        case 2:
+          ReadFixedWidth<int16_t>(memory_address_, row_offsets_, num_rows_,
+                                  field_offset, value_data);
+          break;
+        case 4:
+          ReadFixedWidth<int32_t>(memory_address_, row_offsets_, num_rows_,
+                                  field_offset, value_data);
+          break;
+        default:
+          ReadFixedWidth<int64_t>(memory_address_, row_offsets_, num_rows_,
+                                  field_offset, value_data);
+          break;
+      }
+      *out = arrow::ArrayData::Make(type, num_rows_, {validity, values}, null_count);
+    } break;
+  }
+  return arrow::Status::OK();
+}
+
+}  // namespace rowtocolumnar
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/status.h>
+#include <arrow/type.h>
+
+#include <memory>
+#include <vector>
+
+#include "operators/columnar_to_row_converter.h"
+
+namespace sparkcolumnarplugin {
+namespace rowtocolumnar {
+
+/// Builds an arrow::RecordBatch from a contiguous buffer of Spark UnsafeRows, the
+/// reverse of columnartorow::ColumnarToRowConverter. Each column is filled with one
+/// pass over the rows straight into preallocated buffers. String and binary columns
+/// sum their value sizes in a first pass, so the value buffer is allocated once.
+class RowToColumnarConverter {
+ public:
+  /// Row i starts at memory_address + row_offsets[i]. The rows are only read during
+  /// Convert(), the caller keeps them alive until then.
+  RowToColumnarConverter(std::shared_ptr<arrow::Schema> schema, int64_t num_rows,
+                         const int64_t* row_offsets, const uint8_t* memory_address,
+                         arrow::MemoryPool* pool)
+      : schema_(std::move(schema)),
+        num_rows_(num_rows),
+        row_offsets_(row_offsets),
+        memory_address_(memory_address),
+        pool_(pool) {}
+
+  arrow::Status Convert(std::shared_ptr<arrow::RecordBatch>* out);
+
+ private:
+  arrow::Status ReadColumn(int32_t col_index, std::shared_ptr<arrow::ArrayData>* out);
+  /// Reads the null bits of a column into a validity bitmap, which is left null when
+  /// the column has no null.
+  arrow::Status ReadValidity(int32_t col_index, std::shared_ptr<arrow::Buffer>* out,
+                             int64_t* null_count);
+
+  std::shared_ptr<arrow::Schema> schema_;
+  int64_t num_rows_;
+  const int64_t* row_offsets_;
+  const uint8_t* memory_address_;
+  arrow::MemoryPool* pool_;
+  int64_t nullbitset_width_ = 0;
+};
+
+}  // namespace rowtocolumnar
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Sizes output batches by bytes as well as rows. A fixed row count gives tiny batches
+/// of narrow int columns, which don't amortise the per batch overhead, and huge ones of
+/// wide strings, which spill out of the caches and reallocate their buffers. The sizer
+/// keeps a moving average of the bytes per row of each column, estimated from the
+/// schema until a batch was seen, and hands out target bytes / row width rows, between
+/// kMinRows and a global row cap (GetBatchMaxRows()) above the configured batch size.
+/// Without a byte budget or a row width every batch has the configured rows.
+class BatchSizer {
+ public:
+  static constexpr int64_t kMinRows = 64;
+  /// bytes per row assumed for a string column no batch was seen of
+  static constexpr int64_t kDefaultValueBytes = 32;
+
+  /// batch_rows is the configured batch size, target_bytes 0 keeps every batch that
+  /// long. max_rows caps the rows of narrow batches, it is never below batch_rows.
+  BatchSizer(int64_t batch_rows, int64_t target_bytes, int64_t max_rows)
+      : batch_rows_(std::max<int64_t>(1, batch_rows)),
+        target_bytes_(target_bytes),
+        max_rows_(std::max(batch_rows_, max_rows)) {}
+
+  bool adaptive() const { return target_bytes_ > 0; }
+
+  /// Initial row width from the types, used until the first Observe().
+  void Estimate(const arrow::Schema& schema) {
+    if (observed_) return;
+    widths_.clear();
+    value_widths_.clear();
+    for (auto field : schema.fields()) {
+      auto type = field->type();
+      if (IsBinary(type)) {
+        widths_.push_back(sizeof(int32_t) + static_cast<double>(kDefaultValueBytes));
+        value_widths_.push_back(static_cast<double>(kDefaultValueBytes));
+      } else {
+        widths_.push_back(FixedWidthBytes(type));
+        value_widths_.push_back(0);
+      }
+    }
+  }
+
+  /// Initial row width known from elsewhere, e.g. the metadata of a file.
+  void Estimate(double row_bytes) {
+    if (observed_) return;
+    widths_ = {row_bytes};
+    value_widths_.clear();
+  }
+
+  /// Learns the row width from an output batch. Passing the rows of the input it was
+  /// made of also learns how many rows an input row turns into.
+  void Observe(const arrow::RecordBatch& batch, int64_t input_rows = 0) {
+    auto rows = batch.num_rows();
+    if (input_rows > 0) {
+      auto ratio = static_cast<double>(rows) / input_rows;
+      rows_per_input_ = observed_ratio_ ? (rows_per_input_ * 3 + ratio) / 4 : ratio;
+      observed_ratio_ = true;
+    }
+    if (rows == 0) return;
+    widths_.resize(batch.num_columns(), 0);
+    value_widths_.resize(batch.num_columns(), 0);
+    for (int i = 0; i < batch.num_columns(); i++) {
+      auto column = batch.column(i);
+      double width;
+      double value_width = 0;
+      if (IsBinary(column->type())) {
+        auto binary = std::static_pointer_cast<arrow::BinaryArray>(column);
+        value_width = static_cast<double>(binary->value_offset(rows) -
+                                          binary->value_offset(0)) /
+                      rows;
+        width = sizeof(int32_t) + value_width;
+      } else {
+        width = FixedWidthBytes(column->type());
+      }
+      widths_[i] = observed_ ? (widths_[i] * 3 + width) / 4 : width;
+      value_widths_[i] =
+          observed_ ? (value_widths_[i] * 3 + value_width) / 4 : value_width;
+    }
+    observed_ = true;
+  }
+
+  /// Bytes per row, 0 when nothing is known yet.
+  double row_bytes() const {
+    double bytes = 0;
+    for (auto width : widths_) bytes += width;
+    return bytes;
+  }
+
+  /// Rows of the next output batch.
+  int64_t NextRows() const {
+    auto bytes = row_bytes();
+    if (!adaptive() || bytes <= 0) return batch_rows_;
+    auto rows = static_cast<int64_t>(target_bytes_ / bytes);
+    int64_t min_rows = kMinRows;
+    return std::max(std::min(min_rows, max_rows_), std::min(rows, max_rows_));
+  }
+
+  /// Rows expected out of input_rows, for reserving the builders up front.
+  int64_t ExpectedRows(int64_t input_rows) const {
+    if (!observed_ratio_) return input_rows;
+    auto rows = static_cast<int64_t>(rows_per_input_ * input_rows);
+    return std::min(rows, std::max(input_rows, max_rows_));
+  }
+
+  /// Value bytes of string column i expected in rows rows.
+  int64_t ExpectedValueBytes(int i, int64_t rows) const {
+    if (i >= static_cast<int>(value_widths_.size())) return 0;
+    return static_cast<int64_t>(value_widths_[i] * rows);
+  }
+
+ private:
+  static bool IsBinary(const std::shared_ptr<arrow::DataType>& type) {
+    return type->id() == arrow::Type::STRING || type->id() == arrow::Type::BINARY;
+  }
+
+  static double FixedWidthBytes(const std::shared_ptr<arrow::DataType>& type) {
+    auto fixed_width = dynamic_cast<const arrow::FixedWidthType*>(type.get());
+    // nested types are rare in outputs, a pointer's worth stands for them
+    if (fixed_width == nullptr) return sizeof(int64_t);
+    return fixed_width->bit_width() / 8.0;
+  }
+
+  const int64_t batch_rows_;
+  const int64_t target_bytes_;
+  const int64_t max_rows_;
+  std::vector<double> widths_;
+  std::vector<double> value_widths_;
+  bool observed_ = false;
+  double rows_per_input_ = 1;
+  bool observed_ratio_ = false;
+};
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -60,6 +60,10 @@ arrow::Status StringBuilder::AppendString(std::string value) {
   return impl_->Append(arrow::util::string_view(value));
 }
 arrow::Status StringBuilder::AppendNull() { return impl_->AppendNull(); }
+arrow::Status StringBuilder::Reserve(int64_t length) { return impl_->Reserve(length); }
+arrow::Status StringBuilder::ReserveData(int64_t length) {
+  return impl_->ReserveData(length);
+}
 arrow::Status StringBuilder::Finish(std::shared_ptr<arrow::Array>* out) {
   return impl_->Finish(out);
 }
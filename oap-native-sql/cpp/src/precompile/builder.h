@@ -40,6 +40,8 @@ class StringBuilder {
   arrow::Status Append(arrow::util::string_view val);
   arrow::Status AppendString(std::string val);
   arrow::Status AppendNull();
+  arrow::Status Reserve(int64_t);
+  arrow::Status ReserveData(int64_t);
   arrow::Status Finish(std::shared_ptr<arrow::Array>* out);
   arrow::Status Reset();
 
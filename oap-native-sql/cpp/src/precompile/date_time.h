@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Date kernels on days since 1970-01-01 (date32) and millis since the epoch (date64),
+/// in the proleptic Gregorian calendar Spark 3 uses. The civil conversions count the
+/// year from March, which puts the leap day last: every field is then a few 32 bit
+/// multiplications and divisions by constants, with no branch nor table, so the array
+/// versions vectorise. Gandiva's own kernels go through gmtime_r per value instead.
+/// Days are shifted by whole 400 year eras to stay unsigned, which holds from the
+/// least date32 in the year -5877641 up to 5879621-03-20.
+
+constexpr int64_t kMillisPerDay = 86400000;
+constexpr uint32_t kDaysPerEra = 146097;
+// eras before 1970 the unsigned days start at, and the days from 0000-03-01 to
+// 1970-01-01 plus those eras
+constexpr uint32_t kShiftEras = 14699;
+constexpr uint32_t kShiftDays = 719468 + kShiftEras * kDaysPerEra;
+// 2^31 % 7, to take days modulo 7 in unsigned ints
+constexpr uint32_t kSignBitMod7 = 2;
+
+/// a / b rounded down, b > 0.
+inline int64_t FloorDiv(int64_t a, int64_t b) { return a / b - (a % b < 0); }
+
+/// Year, month (1-12) and day of month (1-31) of days.
+inline void CivilFromDays(int32_t days, int32_t* year, int32_t* month, int32_t* day) {
+  uint32_t z = static_cast<uint32_t>(days) + kShiftDays;
+  uint32_t era = z / kDaysPerEra;
+  // day and year of the era, [0, 146096] and [0, 399]
+  uint32_t doe = z - era * kDaysPerEra;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  // day of the year starting March 1st, [0, 365], and its month, [0, 11]
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t m = mp + 3 - 12 * (mp >= 10);
+  *day = static_cast<int32_t>(doy - (153 * mp + 2) / 5 + 1);
+  *month = static_cast<int32_t>(m);
+  *year = static_cast<int32_t>(yoe + (era - kShiftEras) * 400 + (m <= 2));
+}
+
+/// Days of year-month-day, month in 1-12.
+inline int32_t DaysFromCivil(int32_t year, int32_t month, int32_t day) {
+  uint32_t y = static_cast<uint32_t>(year - (month <= 2)) + kShiftEras * 400;
+  uint32_t era = y / 400;
+  uint32_t yoe = y - era * 400;
+  uint32_t mp = static_cast<uint32_t>(month + 9 - 12 * (month > 2));
+  uint32_t doy = (153 * mp + 2) / 5 + day - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  // wraps back to the signed days
+  return static_cast<int32_t>(era * kDaysPerEra + doe - kShiftDays);
+}
+
+/// 0 for Sunday to 6 for Saturday, 1970-01-01 was a Thursday.
+inline uint32_t WeekDay(int32_t days) {
+  uint32_t u = static_cast<uint32_t>(days) + (1u << 31);
+  return (u % 7 + 7 - kSignBitMod7 + 4) % 7;
+}
+
+inline int32_t DaysOfMillis(int64_t millis) {
+  return static_cast<int32_t>(FloorDiv(millis, kMillisPerDay));
+}
+
+inline int64_t MillisOfDays(int32_t days) { return days * kMillisPerDay; }
+
+inline int32_t ExtractYear(int32_t days) {
+  int32_t year, month, day;
+  CivilFromDays(days, &year, &month, &day);
+  return year;
+}
+
+inline int32_t ExtractMonth(int32_t days) {
+  int32_t year, month, day;
+  CivilFromDays(days, &year, &month, &day);
+  return month;
+}
+
+inline int32_t ExtractDayOfMonth(int32_t days) {
+  int32_t year, month, day;
+  CivilFromDays(days, &year, &month, &day);
+  return day;
+}
+
+inline int32_t ExtractQuarter(int32_t days) { return (ExtractMonth(days) + 2) / 3; }
+
+/// 1 for Sunday to 7 for Saturday, as Spark's dayofweek.
+inline int32_t ExtractDayOfWeek(int32_t days) {
+  return static_cast<int32_t>(WeekDay(days)) + 1;
+}
+
+/// 1 for January 1st.
+inline int32_t ExtractDayOfYear(int32_t days) {
+  return days - DaysFromCivil(ExtractYear(days), 1, 1) + 1;
+}
+
+inline int32_t TruncYear(int32_t days) {
+  return DaysFromCivil(ExtractYear(days), 1, 1);
+}
+
+inline int32_t TruncQuarter(int32_t days) {
+  int32_t year, month, day;
+  CivilFromDays(days, &year, &month, &day);
+  return DaysFromCivil(year, month - (month - 1) % 3, 1);
+}
+
+inline int32_t TruncMonth(int32_t days) { return days - ExtractDayOfMonth(days) + 1; }
+
+/// The Monday starting the week of days.
+inline int32_t TruncWeek(int32_t days) {
+  return days - static_cast<int32_t>((WeekDay(days) + 6) % 7);
+}
+
+/// Value of a step function at key: values[0] below bounds[0], values[i] from
+/// bounds[i - 1] up to bounds[i] and values[size] from bounds[size - 1] on, for size
+/// increasing bounds. The offsets of a region time zone change at such bounds, e.g.
+/// those of unix_timestamp at the midnights of dates. The search halves the range
+/// with conditional moves, in as many steps for every key.
+template <typename T>
+inline T StepLookup(int64_t key, const int64_t* bounds, const T* values, int32_t size) {
+  if (size == 0) {
+    return values[0];
+  }
+  // the last bound not above key, or the first one
+  const int64_t* base = bounds;
+  int32_t n = size;
+  while (n > 1) {
+    int32_t half = n / 2;
+    base = base[half] <= key ? base + half : base;
+    n -= half;
+  }
+  return values[(base - bounds) + (*base <= key)];
+}
+
+/// Whole array versions, out may be in. Whole stage codegen runs them once per batch
+/// on date columns.
+#define DATE_TIME_ARRAY_KERNEL(NAME, KERNEL)                                  \
+  inline void NAME(const int32_t* days, int64_t length, int32_t* out) {       \
+    for (int64_t i = 0; i < length; i++) {                                    \
+      out[i] = KERNEL(days[i]);                                               \
+    }                                                                         \
+  }
+
+DATE_TIME_ARRAY_KERNEL(ExtractYears, ExtractYear)
+DATE_TIME_ARRAY_KERNEL(ExtractMonths, ExtractMonth)
+DATE_TIME_ARRAY_KERNEL(ExtractDaysOfMonth, ExtractDayOfMonth)
+DATE_TIME_ARRAY_KERNEL(ExtractQuarters, ExtractQuarter)
+DATE_TIME_ARRAY_KERNEL(ExtractDaysOfWeek, ExtractDayOfWeek)
+DATE_TIME_ARRAY_KERNEL(ExtractDaysOfYear, ExtractDayOfYear)
+DATE_TIME_ARRAY_KERNEL(TruncYears, TruncYear)
+DATE_TIME_ARRAY_KERNEL(TruncQuarters, TruncQuarter)
+DATE_TIME_ARRAY_KERNEL(TruncMonths, TruncMonth)
+DATE_TIME_ARRAY_KERNEL(TruncWeeks, TruncWeek)
+
+#undef DATE_TIME_ARRAY_KERNEL
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/util/decimal.h>
+#include <stdint.h>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Decimal arithmetic on unscaled values. Decimals are stored as arrow::Decimal128,
+/// but with a precision up to 18 the unscaled value always fits in an int64, so the
+/// rescales, casts and sums below stay in 64 bit and only widen to 128 bit when the
+/// precision or an intermediate result doesn't allow it. Rounding is ROUND_HALF_UP
+/// and results that don't fit the target precision are reported, Spark turns them
+/// into nulls.
+
+constexpr int32_t kMaxShortDecimalPrecision = 18;
+constexpr int32_t kMaxDecimalPrecision = 38;
+
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+struct DecimalScaleMultipliers {
+  int128_t values[kMaxDecimalPrecision + 1];
+
+  constexpr DecimalScaleMultipliers() : values() {
+    int128_t multiplier = 1;
+    for (int32_t i = 0; i <= kMaxDecimalPrecision; i++) {
+      values[i] = multiplier;
+      if (i < kMaxDecimalPrecision) multiplier *= 10;
+    }
+  }
+};
+
+inline const DecimalScaleMultipliers& GetDecimalScaleMultipliers() {
+  static constexpr DecimalScaleMultipliers multipliers;
+  return multipliers;
+}
+
+/// 10^scale, scale in [0, 38]
+inline int128_t GetDecimalScaleMultiplier(int32_t scale) {
+  return GetDecimalScaleMultipliers().values[scale];
+}
+
+/// 10^scale, scale in [0, 18]
+inline int64_t GetShortDecimalScaleMultiplier(int32_t scale) {
+  return static_cast<int64_t>(GetDecimalScaleMultipliers().values[scale]);
+}
+
+inline bool IsShortDecimalValue(const arrow::Decimal128& v) {
+  return v.high_bits() == (static_cast<int64_t>(v.low_bits()) >> 63);
+}
+
+inline int128_t ToInt128(const arrow::Decimal128& v) {
+  return static_cast<int128_t>(
+      (static_cast<uint128_t>(static_cast<uint64_t>(v.high_bits())) << 64) |
+      v.low_bits());
+}
+
+inline arrow::Decimal128 FromInt128(int128_t v) {
+  return arrow::Decimal128(static_cast<int64_t>(v >> 64), static_cast<uint64_t>(v));
+}
+
+inline bool DecimalFitsInPrecision(int64_t v, int32_t precision) {
+  if (precision > kMaxShortDecimalPrecision) return true;
+  auto bound = GetShortDecimalScaleMultiplier(precision);
+  return v > -bound && v < bound;
+}
+
+inline bool DecimalFitsInPrecision(int128_t v, int32_t precision) {
+  auto bound = GetDecimalScaleMultiplier(precision);
+  return v > -bound && v < bound;
+}
+
+/// v / divisor, ties away from zero
+template <typename T>
+inline T DivideRoundHalfUp(T v, T divisor) {
+  T quotient = v / divisor;
+  T remainder = v % divisor;
+  T abs_remainder = remainder < 0 ? -remainder : remainder;
+  T abs_divisor = divisor < 0 ? -divisor : divisor;
+  // |remainder| * 2 >= |divisor| without overflowing near 10^38
+  if (abs_remainder >= abs_divisor - abs_remainder) {
+    quotient += ((v < 0) != (divisor < 0)) ? -1 : 1;
+  }
+  return quotient;
+}
+
+/// Changes the scale of an unscaled value, false when it overflows.
+inline bool RescaleDecimal(int128_t in, int32_t in_scale, int32_t out_scale,
+                           int128_t* out) {
+  if (out_scale >= in_scale) {
+    auto delta = out_scale - in_scale;
+    if (delta > kMaxDecimalPrecision) {
+      *out = 0;
+      return in == 0;
+    }
+    return !__builtin_mul_overflow(in, GetDecimalScaleMultiplier(delta), out);
+  }
+  auto delta = in_scale - out_scale;
+  // even a 38 digit value rounds to 0 beyond 39 digits
+  *out = delta > kMaxDecimalPrecision
+             ? 0
+             : DivideRoundHalfUp<int128_t>(in, GetDecimalScaleMultiplier(delta));
+  return true;
+}
+
+inline bool RescaleShortDecimal(int64_t in, int32_t in_scale, int32_t out_scale,
+                                int64_t* out) {
+  if (out_scale >= in_scale) {
+    auto delta = out_scale - in_scale;
+    if (delta > kMaxShortDecimalPrecision) {
+      *out = 0;
+      return in == 0;
+    }
+    return !__builtin_mul_overflow(in, GetShortDecimalScaleMultiplier(delta), out);
+  }
+  auto delta = in_scale - out_scale;
+  if (delta > kMaxShortDecimalPrecision) {
+    // 10^19 and up don't fit in an int64, but the quotient is at most 1
+    int128_t wide_out;
+    RescaleDecimal(in, in_scale, out_scale, &wide_out);
+    *out = static_cast<int64_t>(wide_out);
+    return true;
+  }
+  *out = DivideRoundHalfUp<int64_t>(in, GetShortDecimalScaleMultiplier(delta));
+  return true;
+}
+
+/// castDECIMAL of a decimal, *validity is cleared when the result doesn't fit in
+/// out_precision.
+inline arrow::Decimal128 RescaleDecimal(const arrow::Decimal128& in, int32_t in_scale,
+                                        int32_t out_precision, int32_t out_scale,
+                                        bool* validity) {
+  if (out_precision <= kMaxShortDecimalPrecision && IsShortDecimalValue(in)) {
+    int64_t out;
+    *validity =
+        RescaleShortDecimal(static_cast<int64_t>(in.low_bits()), in_scale, out_scale,
+                            &out) &&
+        DecimalFitsInPrecision(out, out_precision);
+    return arrow::Decimal128(out);
+  }
+  int128_t out;
+  *validity = RescaleDecimal(ToInt128(in), in_scale, out_scale, &out) &&
+              DecimalFitsInPrecision(out, out_precision);
+  return FromInt128(out);
+}
+
+/// castDECIMAL of an integral value, exact unlike the cast through double.
+inline arrow::Decimal128 CastDecimal(int64_t in, int32_t out_precision,
+                                     int32_t out_scale, bool* validity) {
+  if (out_precision <= kMaxShortDecimalPrecision) {
+    int64_t out;
+    *validity = RescaleShortDecimal(in, 0, out_scale, &out) &&
+                DecimalFitsInPrecision(out, out_precision);
+    return arrow::Decimal128(out);
+  }
+  int128_t out;
+  *validity = RescaleDecimal(in, 0, out_scale, &out) &&
+              DecimalFitsInPrecision(out, out_precision);
+  return FromInt128(out);
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "arrow/util/string_view.h"  // IWYU pragma: export
+#include "third_party/xxhash/xxhash64.h"
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Open addressing table of the IN list values. Several hash seeds are tried when the
+/// table is built and the one with the shortest probe sequence is kept, so most
+/// lists end up with a perfect hash and every lookup is a single probe.
+template <typename T, typename Hasher>
+class InHashTable {
+ public:
+  static const int kNumSeeds = 8;
+
+  template <typename ValueType>
+  void Build(const std::vector<ValueType>& values) {
+    size_t capacity = 2;
+    while (capacity < values.size() * 2) {
+      capacity <<= 1;
+    }
+    mask_ = capacity - 1;
+    int best_probe = -1;
+    uint64_t best_seed = 0;
+    for (uint64_t seed = 0; seed < kNumSeeds && best_probe != 1; seed++) {
+      int probe = Fill(values, seed);
+      if (best_probe == -1 || probe < best_probe) {
+        best_probe = probe;
+        best_seed = seed;
+      }
+    }
+    if (best_seed != seed_) {
+      Fill(values, best_seed);
+    }
+  }
+
+  bool Contains(const T& v) const {
+    size_t slot = Hasher::Hash(v, seed_) & mask_;
+    for (int i = 0; i < max_probe_; i++) {
+      if (!used_[slot]) {
+        return false;
+      }
+      if (slots_[slot] == v) {
+        return true;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    return false;
+  }
+
+ private:
+  template <typename ValueType>
+  int Fill(const std::vector<ValueType>& values, uint64_t seed) {
+    seed_ = seed;
+    slots_.assign(mask_ + 1, T());
+    used_.assign(mask_ + 1, 0);
+    max_probe_ = 0;
+    for (const auto& value : values) {
+      T v(value);
+      size_t slot = Hasher::Hash(v, seed_) & mask_;
+      int probe = 1;
+      while (used_[slot]) {
+        slot = (slot + 1) & mask_;
+        probe++;
+      }
+      slots_[slot] = v;
+      used_[slot] = 1;
+      max_probe_ = std::max(max_probe_, probe);
+    }
+    return max_probe_;
+  }
+
+  std::vector<T> slots_;
+  std::vector<uint8_t> used_;
+  size_t mask_ = 0;
+  uint64_t seed_ = 0;
+  int max_probe_ = 0;
+};
+
+struct IntegerInHasher {
+  template <typename T>
+  static uint64_t Hash(T v, uint64_t seed) {
+    return thirdparty::xxhash64::fmix(static_cast<uint64_t>(v) ^
+                                      (seed * thirdparty::xxhash64::PRIME64_1));
+  }
+};
+
+struct StringInHasher {
+  static uint64_t Hash(arrow::util::string_view v, uint64_t seed) {
+    return thirdparty::xxhash64::hash_bytes(reinterpret_cast<const uint8_t*>(v.data()),
+                                            static_cast<int32_t>(v.size()), seed);
+  }
+};
+
+/// IN list of integer literals. The structure is chosen when the list is built:
+/// a bitmap over [min, max] for dense lists, a branchless binary search over the
+/// sorted values for short ones, and InHashTable otherwise.
+template <typename T>
+class IntegerInSet {
+ public:
+  static const size_t kMaxSortedSize = 16;
+  static const uint64_t kMaxBitmapRange = 1 << 20;
+
+  IntegerInSet(std::vector<T> values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.empty()) {
+      kind_ = EMPTY;
+      return;
+    }
+    min_ = values.front();
+    range_ = static_cast<UnsignedType>(values.back()) - static_cast<UnsignedType>(min_);
+    if (values.size() > 2 && range_ < kMaxBitmapRange && range_ < values.size() * 64) {
+      kind_ = BITMAP;
+      bitmap_.assign(range_ / 64 + 1, 0);
+      for (auto v : values) {
+        auto offset = static_cast<UnsignedType>(v) - static_cast<UnsignedType>(min_);
+        bitmap_[offset >> 6] |= 1ULL << (offset & 63);
+      }
+    } else if (values.size() <= kMaxSortedSize) {
+      kind_ = SORTED;
+      sorted_ = values;
+    } else {
+      kind_ = HASH;
+      hash_table_.Build(values);
+    }
+  }
+
+  bool Contains(T v) const {
+    switch (kind_) {
+      case BITMAP: {
+        auto offset = static_cast<UnsignedType>(v) - static_cast<UnsignedType>(min_);
+        return offset <= range_ && ((bitmap_[offset >> 6] >> (offset & 63)) & 1);
+      }
+      case SORTED: {
+        const T* base = sorted_.data();
+        size_t n = sorted_.size();
+        while (n > 1) {
+          size_t half = n >> 1;
+          base = base[half] <= v ? base + half : base;
+          n -= half;
+        }
+        return *base == v;
+      }
+      case HASH:
+        return hash_table_.Contains(v);
+      default:
+        return false;
+    }
+  }
+
+ private:
+  using UnsignedType = typename std::make_unsigned<T>::type;
+  enum Kind { EMPTY, BITMAP, SORTED, HASH };
+
+  Kind kind_;
+  T min_;
+  UnsignedType range_;
+  std::vector<uint64_t> bitmap_;
+  std::vector<T> sorted_;
+  InHashTable<T, IntegerInHasher> hash_table_;
+};
+
+/// IN list of string literals, compared as views without copying the probe value.
+class StringInSet {
+ public:
+  static const size_t kMaxLinearSize = 8;
+
+  StringInSet(std::vector<std::string> values) : values_(std::move(values)) {
+    std::sort(values_.begin(), values_.end());
+    values_.erase(std::unique(values_.begin(), values_.end()), values_.end());
+    // views point into values_, which is not modified from here on
+    std::vector<arrow::util::string_view> views(values_.begin(), values_.end());
+    if (values_.size() > kMaxLinearSize) {
+      hash_table_.Build(views);
+    } else {
+      views_ = views;
+    }
+  }
+
+  // the views would still point into the values of the source
+  StringInSet(const StringInSet&) = delete;
+  StringInSet& operator=(const StringInSet&) = delete;
+
+  bool Contains(arrow::util::string_view v) const {
+    if (values_.size() > kMaxLinearSize) {
+      return hash_table_.Contains(v);
+    }
+    for (const auto& view : views_) {
+      if (view.size() == v.size() && memcmp(view.data(), v.data(), v.size()) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<std::string> values_;
+  std::vector<arrow::util::string_view> views_;
+  InHashTable<arrow::util::string_view, StringInHasher> hash_table_;
+};
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/internal_hash.h"
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/type.h>
+#include <arrow/type_traits.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+namespace {
+
+struct SoftwareCrc32c {
+  static uint32_t U8(uint32_t crc, uint8_t v) { return SoftwareCrc32cU8(crc, v); }
+  static uint32_t U32(uint32_t crc, uint32_t v) { return SoftwareCrc32cU32(crc, v); }
+  static uint32_t U64(uint32_t crc, uint64_t v) { return SoftwareCrc32cU64(crc, v); }
+};
+
+#if defined(__x86_64__)
+// The library is built for any x86_64, so the SSE4.2 loops are compiled separately
+// and picked at runtime. They are flattened, the instructions can only be inlined
+// into functions compiled for SSE4.2.
+#define INTERNAL_HASH_SSE42 __attribute__((target("sse4.2"), flatten))
+
+struct Sse42Crc32c {
+  __attribute__((target("sse4.2"))) static uint32_t U8(uint32_t crc, uint8_t v) {
+    return _mm_crc32_u8(crc, v);
+  }
+  __attribute__((target("sse4.2"))) static uint32_t U32(uint32_t crc, uint32_t v) {
+    return _mm_crc32_u32(crc, v);
+  }
+  __attribute__((target("sse4.2"))) static uint32_t U64(uint32_t crc, uint64_t v) {
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+  }
+};
+
+bool HasSse42() {
+  static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+  return has_sse42;
+}
+#endif
+
+#define PROCESS_SUPPORTED_TYPES(PROCESS) \
+  PROCESS(arrow::UInt8Type)              \
+  PROCESS(arrow::Int8Type)               \
+  PROCESS(arrow::UInt16Type)             \
+  PROCESS(arrow::Int16Type)              \
+  PROCESS(arrow::UInt32Type)             \
+  PROCESS(arrow::Int32Type)              \
+  PROCESS(arrow::UInt64Type)             \
+  PROCESS(arrow::Int64Type)              \
+  PROCESS(arrow::FloatType)              \
+  PROCESS(arrow::DoubleType)             \
+  PROCESS(arrow::Date32Type)             \
+  PROCESS(arrow::Date64Type)             \
+  PROCESS(arrow::TimestampType)
+
+// The hashes of the previous columns are the seeds.
+template <typename Crc, typename GetWord>
+void HashWords32(const arrow::Array& in, GetWord get_word, int32_t* hashes) {
+  auto length = in.length();
+  if (in.null_count() == 0) {
+    for (int64_t i = 0; i < length; i++) {
+      hashes[i] = FinalizeInternalHash32(
+          Crc::U64(static_cast<uint32_t>(hashes[i]), get_word(i)));
+    }
+  } else {
+    for (int64_t i = 0; i < length; i++) {
+      if (in.IsNull(i)) {
+        hashes[i] = InternalHashNull32<Crc>(hashes[i]);
+        continue;
+      }
+      hashes[i] = FinalizeInternalHash32(
+          Crc::U64(static_cast<uint32_t>(hashes[i]), get_word(i)));
+    }
+  }
+}
+
+template <typename Crc>
+arrow::Status HashColumn32(const arrow::Array& in, int32_t* hashes) {
+  switch (in.type_id()) {
+#define PROCESS(InType)                                                             \
+  case InType::type_id: {                                                           \
+    using ArrayType = typename arrow::TypeTraits<InType>::ArrayType;                \
+    auto values = static_cast<const ArrayType&>(in).raw_values();                   \
+    auto get_word = [values](int64_t i) { return GetInternalHashWord(values[i]); }; \
+    HashWords32<Crc>(in, get_word, hashes);                                         \
+  } break;
+    PROCESS_SUPPORTED_TYPES(PROCESS)
+#undef PROCESS
+    case arrow::Type::BOOL: {
+      auto& typed_in = static_cast<const arrow::BooleanArray&>(in);
+      HashWords32<Crc>(
+          in, [&typed_in](int64_t i) { return GetInternalHashWord(typed_in.Value(i)); },
+          hashes);
+    } break;
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: {
+      auto& typed_in = static_cast<const arrow::BinaryArray&>(in);
+      for (int64_t i = 0; i < in.length(); i++) {
+        if (in.IsNull(i)) {
+          hashes[i] = InternalHashNull32<Crc>(hashes[i]);
+          continue;
+        }
+        auto v = typed_in.GetView(i);
+        hashes[i] = FinalizeInternalHash32(
+            Crc32cBytes<Crc>(reinterpret_cast<const uint8_t*>(v.data()), v.size(),
+                             static_cast<uint32_t>(hashes[i])));
+      }
+    } break;
+    case arrow::Type::DECIMAL: {
+      auto& typed_in = static_cast<const arrow::FixedSizeBinaryArray&>(in);
+      for (int64_t i = 0; i < in.length(); i++) {
+        if (in.IsNull(i)) {
+          hashes[i] = InternalHashNull32<Crc>(hashes[i]);
+          continue;
+        }
+        // little endian Decimal128, low word first
+        uint64_t words[2];
+        memcpy(words, typed_in.GetValue(i), sizeof(words));
+        auto crc = Crc::U64(static_cast<uint32_t>(hashes[i]), words[0]);
+        hashes[i] = FinalizeInternalHash32(Crc::U64(crc, words[1]));
+      }
+    } break;
+    default:
+      return arrow::Status::NotImplemented("HashArrays32 doesn't support ",
+                                           in.type()->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+#if defined(__x86_64__)
+INTERNAL_HASH_SSE42 arrow::Status HashColumn32Sse42(const arrow::Array& in,
+                                                    int32_t* hashes) {
+  return HashColumn32<Sse42Crc32c>(in, hashes);
+}
+#endif
+
+template <typename GetValue>
+void HashValues64(const arrow::Array& in, GetValue get_value, int64_t* hashes) {
+  auto length = in.length();
+  if (in.null_count() == 0) {
+    for (int64_t i = 0; i < length; i++) {
+      hashes[i] = InternalHash64(get_value(i), true, hashes[i]);
+    }
+  } else {
+    for (int64_t i = 0; i < length; i++) {
+      if (in.IsNull(i)) {
+        hashes[i] = InternalHashNull64(hashes[i]);
+        continue;
+      }
+      hashes[i] = InternalHash64(get_value(i), true, hashes[i]);
+    }
+  }
+}
+
+arrow::Status HashColumn64(const arrow::Array& in, int64_t* hashes) {
+  switch (in.type_id()) {
+#define PROCESS(InType)                                                  \
+  case InType::type_id: {                                                \
+    using ArrayType = typename arrow::TypeTraits<InType>::ArrayType;     \
+    auto values = static_cast<const ArrayType&>(in).raw_values();        \
+    HashValues64(in, [values](int64_t i) { return values[i]; }, hashes); \
+  } break;
+    PROCESS_SUPPORTED_TYPES(PROCESS)
+#undef PROCESS
+    case arrow::Type::BOOL: {
+      auto& typed_in = static_cast<const arrow::BooleanArray&>(in);
+      HashValues64(in, [&typed_in](int64_t i) { return typed_in.Value(i); }, hashes);
+    } break;
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: {
+      auto& typed_in = static_cast<const arrow::BinaryArray&>(in);
+      HashValues64(in, [&typed_in](int64_t i) { return typed_in.GetView(i); }, hashes);
+    } break;
+    case arrow::Type::DECIMAL: {
+      auto& typed_in = static_cast<const arrow::Decimal128Array&>(in);
+      HashValues64(
+          in, [&typed_in](int64_t i) { return arrow::Decimal128(typed_in.GetValue(i)); },
+          hashes);
+    } break;
+    default:
+      return arrow::Status::NotImplemented("HashArrays64 doesn't support ",
+                                           in.type()->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+#undef PROCESS_SUPPORTED_TYPES
+
+template <typename CType>
+arrow::Status AllocateHashes(int64_t length, arrow::MemoryPool* pool,
+                             std::shared_ptr<arrow::Buffer>* out) {
+  ARROW_ASSIGN_OR_RAISE(*out, arrow::AllocateBuffer(length * sizeof(CType), pool));
+  // the first column is hashed with seed 0
+  memset((*out)->mutable_data(), 0, length * sizeof(CType));
+  return arrow::Status::OK();
+}
+
+}  // namespace
+
+arrow::Status HashArrays32(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                           arrow::MemoryPool* pool, std::shared_ptr<arrow::Array>* out) {
+  auto length = in.empty() ? 0 : in[0]->length();
+  std::shared_ptr<arrow::Buffer> hashes;
+  RETURN_NOT_OK(AllocateHashes<int32_t>(length, pool, &hashes));
+  auto raw_hashes = reinterpret_cast<int32_t*>(hashes->mutable_data());
+  for (const auto& column : in) {
+#if defined(__x86_64__)
+    if (HasSse42()) {
+      RETURN_NOT_OK(HashColumn32Sse42(*column, raw_hashes));
+      continue;
+    }
+#endif
+    RETURN_NOT_OK(HashColumn32<SoftwareCrc32c>(*column, raw_hashes));
+  }
+  *out = arrow::MakeArray(
+      arrow::ArrayData::Make(arrow::int32(), length, {nullptr, hashes}, 0));
+  return arrow::Status::OK();
+}
+
+arrow::Status HashArrays64(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                           arrow::MemoryPool* pool, std::shared_ptr<arrow::Array>* out) {
+  auto length = in.empty() ? 0 : in[0]->length();
+  std::shared_ptr<arrow::Buffer> hashes;
+  RETURN_NOT_OK(AllocateHashes<int64_t>(length, pool, &hashes));
+  auto raw_hashes = reinterpret_cast<int64_t*>(hashes->mutable_data());
+  for (const auto& column : in) {
+    RETURN_NOT_OK(HashColumn64(*column, raw_hashes));
+  }
+  *out = arrow::MakeArray(
+      arrow::ArrayData::Make(arrow::int64(), length, {nullptr, hashes}, 0));
+  return arrow::Status::OK();
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
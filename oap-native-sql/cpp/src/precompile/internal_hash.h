@@ -0,0 +1,259 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+#include <arrow/type_fwd.h>
+#include <arrow/util/decimal.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "arrow/util/string_view.h"  // IWYU pragma: export
+#include "third_party/xxhash/xxhash64.h"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Hashing for the join and aggregation tables. These hashes never leave the process,
+/// so unlike the hash() expression and shuffle partitioning they don't have to match
+/// Spark's murmur3, they only have to agree between the build and the probe side.
+/// The 32 bit hash is CRC32C plus a finalizer, a single instruction per 8 bytes with
+/// SSE4.2. The table based CRC32C below gives the same results, so code built with and
+/// without SSE4.2 (like the jitted kernels and the library) can share one table.
+/// The 64 bit hash goes through xxhash64, CRCs with different seeds are correlated and
+/// the 64 bit keys are used as the grouping key without comparing the columns.
+
+struct Crc32cTable {
+  uint32_t values[256];
+
+  constexpr Crc32cTable() : values() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+      }
+      values[i] = crc;
+    }
+  }
+};
+
+inline const uint32_t* GetCrc32cTable() {
+  static constexpr Crc32cTable table;
+  return table.values;
+}
+
+/// CRC32C steps without the pre and post inversion, same as the SSE4.2 instructions.
+inline uint32_t SoftwareCrc32cU8(uint32_t crc, uint8_t v) {
+  return GetCrc32cTable()[(crc ^ v) & 0xff] ^ (crc >> 8);
+}
+
+inline uint32_t SoftwareCrc32cU32(uint32_t crc, uint32_t v) {
+  auto table = GetCrc32cTable();
+  crc ^= v;
+  for (int i = 0; i < 4; i++) {
+    crc = table[crc & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+inline uint32_t SoftwareCrc32cU64(uint32_t crc, uint64_t v) {
+  crc = SoftwareCrc32cU32(crc, static_cast<uint32_t>(v));
+  return SoftwareCrc32cU32(crc, static_cast<uint32_t>(v >> 32));
+}
+
+#if defined(__SSE4_2__)
+inline uint32_t Crc32cU8(uint32_t crc, uint8_t v) { return _mm_crc32_u8(crc, v); }
+inline uint32_t Crc32cU32(uint32_t crc, uint32_t v) { return _mm_crc32_u32(crc, v); }
+inline uint32_t Crc32cU64(uint32_t crc, uint64_t v) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+}
+#else
+inline uint32_t Crc32cU8(uint32_t crc, uint8_t v) { return SoftwareCrc32cU8(crc, v); }
+inline uint32_t Crc32cU32(uint32_t crc, uint32_t v) {
+  return SoftwareCrc32cU32(crc, v);
+}
+inline uint32_t Crc32cU64(uint32_t crc, uint64_t v) {
+  return SoftwareCrc32cU64(crc, v);
+}
+#endif
+
+/// CRC is linear, the low bits of the table index need the high bits mixed in.
+inline int32_t FinalizeInternalHash32(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  return static_cast<int32_t>(h);
+}
+
+/// Integers of all widths, booleans and dates hash as int64, so a key hashes the same
+/// whatever integer type each side of a join projected it to. Floating points hash
+/// as double, with -0.0 and all the NaNs folded like Spark compares them.
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, uint64_t>::type
+GetInternalHashWord(T v) {
+  return static_cast<uint64_t>(static_cast<int64_t>(v));
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint64_t>::type
+GetInternalHashWord(T v) {
+  double d = static_cast<double>(v);
+  if (d == 0.0) {
+    d = 0.0;
+  } else if (std::isnan(d)) {
+    d = std::numeric_limits<double>::quiet_NaN();
+  }
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+template <typename Crc>
+inline uint32_t Crc32cBytes(const uint8_t* data, int64_t length, uint32_t crc) {
+  crc = Crc::U32(crc, static_cast<uint32_t>(length));
+  int64_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    crc = Crc::U64(crc, word);
+  }
+  for (; i < length; i++) {
+    crc = Crc::U8(crc, data[i]);
+  }
+  return crc;
+}
+
+struct DefaultCrc32c {
+  static uint32_t U8(uint32_t crc, uint8_t v) { return Crc32cU8(crc, v); }
+  static uint32_t U32(uint32_t crc, uint32_t v) { return Crc32cU32(crc, v); }
+  static uint32_t U64(uint32_t crc, uint64_t v) { return Crc32cU64(crc, v); }
+};
+
+/// A null hashes a marker under a perturbed seed instead of keeping the seed, else
+/// (NULL, 5) and (5, NULL) would hash the same, and the 64 bit hash is a grouping key
+/// nothing compares. With its own seed the marker doesn't collide with any value
+/// more often than two distinct values do.
+constexpr uint64_t kInternalHashNullWord = 0x9E3779B97F4A7C15ULL;
+constexpr uint32_t kInternalHashNullSeed32 = 0x5BD1E995u;
+constexpr uint64_t kInternalHashNullSeed64 = 0xC2B2AE3D27D4EB4FULL;
+
+template <typename Crc = DefaultCrc32c>
+inline int32_t InternalHashNull32(int32_t seed) {
+  return FinalizeInternalHash32(
+      Crc::U64(static_cast<uint32_t>(seed) ^ kInternalHashNullSeed32,
+               kInternalHashNullWord));
+}
+
+inline int64_t InternalHashNull64(int64_t seed) {
+  return thirdparty::xxhash64::hash_long(
+      kInternalHashNullWord, static_cast<uint64_t>(seed) ^ kInternalHashNullSeed64);
+}
+
+/// Per row hash for the jitted kernels. Chaining the keys through the seed, starting
+/// with 0, gives the same hash as HashArrays32().
+template <typename T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, int32_t>::type
+InternalHash32(T v, bool validity, int32_t seed) {
+  if (!validity) return InternalHashNull32(seed);
+  return FinalizeInternalHash32(
+      Crc32cU64(static_cast<uint32_t>(seed), GetInternalHashWord(v)));
+}
+
+inline int32_t InternalHash32(arrow::util::string_view v, bool validity, int32_t seed) {
+  if (!validity) return InternalHashNull32(seed);
+  return FinalizeInternalHash32(Crc32cBytes<DefaultCrc32c>(
+      reinterpret_cast<const uint8_t*>(v.data()), v.size(), static_cast<uint32_t>(seed)));
+}
+
+inline int32_t InternalHash32(const std::string& v, bool validity, int32_t seed) {
+  return InternalHash32(arrow::util::string_view(v), validity, seed);
+}
+
+inline int32_t InternalHash32(const arrow::Decimal128& v, bool validity, int32_t seed) {
+  if (!validity) return InternalHashNull32(seed);
+  auto crc = Crc32cU64(static_cast<uint32_t>(seed), v.low_bits());
+  crc = Crc32cU64(crc, static_cast<uint64_t>(v.high_bits()));
+  return FinalizeInternalHash32(crc);
+}
+
+template <typename T>
+inline int32_t InternalHash32(const T& v, bool validity) {
+  return InternalHash32(v, validity, 0);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, int64_t>::type
+InternalHash64(T v, bool validity, int64_t seed) {
+  if (!validity) return InternalHashNull64(seed);
+  return thirdparty::xxhash64::hash_long(GetInternalHashWord(v), seed);
+}
+
+inline int64_t InternalHash64(arrow::util::string_view v, bool validity, int64_t seed) {
+  if (!validity) return InternalHashNull64(seed);
+  return thirdparty::xxhash64::hash_bytes(reinterpret_cast<const uint8_t*>(v.data()),
+                                          v.size(), seed);
+}
+
+inline int64_t InternalHash64(const std::string& v, bool validity, int64_t seed) {
+  return InternalHash64(arrow::util::string_view(v), validity, seed);
+}
+
+inline int64_t InternalHash64(const arrow::Decimal128& v, bool validity, int64_t seed) {
+  if (!validity) return InternalHashNull64(seed);
+  auto hash = thirdparty::xxhash64::hash_long(v.low_bits(), seed);
+  return thirdparty::xxhash64::hash_long(v.high_bits(), hash);
+}
+
+template <typename T>
+inline int64_t InternalHash64(const T& v, bool validity) {
+  return InternalHash64(v, validity, 0);
+}
+
+/// Hasher for the maps keyed by a column value.
+template <typename T>
+struct InternalHasher {
+  size_t operator()(const T& v) const {
+    return static_cast<uint32_t>(InternalHash32(v, true, 0));
+  }
+};
+
+/// Hashes the columns into one Int32 array, column by column with the hash of the
+/// previous columns as seed, the same as chaining InternalHash32() over the keys of a
+/// row. Fixed width columns are hashed in tight loops, with the SSE4.2 CRC32C
+/// instructions when the CPU has them.
+arrow::Status HashArrays32(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                           arrow::MemoryPool* pool, std::shared_ptr<arrow::Array>* out);
+
+/// The same with InternalHash64() into an Int64 array.
+arrow::Status HashArrays64(const std::vector<std::shared_ptr<arrow::Array>>& in,
+                           arrow::MemoryPool* pool, std::shared_ptr<arrow::Array>* out);
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,448 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/string_kernels.h"
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/builder.h>
+#include <arrow/util/bit_util.h>
+#include <locale.h>
+#include <string.h>
+#include <wctype.h>
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+namespace {
+
+template <bool kUpper>
+inline uint8_t AsciiCase(uint8_t c) {
+  // flip the 0x20 bit of [a-z] for upper, of [A-Z] for lower
+  return static_cast<uint8_t>(c - (kUpper ? 'a' : 'A')) < 26 ? c ^ 0x20 : c;
+}
+
+#if defined(__AVX2__)
+template <bool kUpper>
+inline __m256i AsciiCase(__m256i v) {
+  // shift the letter range down to [-128, -103] so one signed compare finds it
+  auto low = _mm256_set1_epi8(static_cast<char>(128 - (kUpper ? 'a' : 'A')));
+  auto shifted = _mm256_add_epi8(v, low);
+  auto in_range = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), shifted);
+  return _mm256_xor_si256(v, _mm256_and_si256(in_range, _mm256_set1_epi8(0x20)));
+}
+#endif
+
+#if defined(__SSE2__)
+template <bool kUpper>
+inline __m128i AsciiCase(__m128i v) {
+  auto low = _mm_set1_epi8(static_cast<char>(128 - (kUpper ? 'a' : 'A')));
+  auto shifted = _mm_add_epi8(v, low);
+  auto in_range = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+  return _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+#endif
+
+/// Simple case mapping of the two-byte letters whose counterpart is also two bytes
+/// long: Latin-1 Supplement, basic Greek and Cyrillic. Only used when the C library
+/// has no UTF-8 locale to map with.
+template <bool kUpper>
+inline uint32_t CodepointCase(uint32_t c) {
+  if (kUpper) {
+    if (c >= 0xE0 && c <= 0xFE && c != 0xF7) return c - 0x20;
+    if (c >= 0x3B1 && c <= 0x3C9 && c != 0x3C2) return c - 0x20;
+    if (c >= 0x430 && c <= 0x44F) return c - 0x20;
+    if (c >= 0x450 && c <= 0x45F) return c - 0x50;
+  } else {
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7) return c + 0x20;
+    if (c >= 0x391 && c <= 0x3A9 && c != 0x3A2) return c + 0x20;
+    if (c >= 0x410 && c <= 0x42F) return c + 0x20;
+    if (c >= 0x400 && c <= 0x40F) return c + 0x50;
+  }
+  return c;
+}
+
+locale_t Utf8Locale() {
+  static locale_t locale = [] {
+    auto l = newlocale(LC_CTYPE_MASK, "C.UTF-8", static_cast<locale_t>(0));
+    if (l == static_cast<locale_t>(0)) {
+      l = newlocale(LC_CTYPE_MASK, "en_US.UTF-8", static_cast<locale_t>(0));
+    }
+    return l;
+  }();
+  return locale;
+}
+
+/// The unconditional mappings of Unicode's SpecialCasing.txt Java applies, one code
+/// point to several. Returns the number written to out, 0 if c maps to one.
+template <bool kUpper>
+int SpecialCase(uint32_t c, uint32_t* out) {
+  struct Special {
+    uint32_t from;
+    uint32_t to[3];
+  };
+  static const Special kUpperSpecials[] = {
+      {0xDF, {'S', 'S'}},           {0x149, {0x2BC, 'N'}},
+      {0x1F0, {'J', 0x30C}},        {0x390, {0x399, 0x308, 0x301}},
+      {0x3B0, {0x3A5, 0x308, 0x301}}, {0x587, {0x535, 0x552}},
+      {0x1E96, {'H', 0x331}},       {0x1E97, {'T', 0x308}},
+      {0x1E98, {'W', 0x30A}},       {0x1E99, {'Y', 0x30A}},
+      {0x1E9A, {'A', 0x2BE}},       {0xFB00, {'F', 'F'}},
+      {0xFB01, {'F', 'I'}},         {0xFB02, {'F', 'L'}},
+      {0xFB03, {'F', 'F', 'I'}},    {0xFB04, {'F', 'F', 'L'}},
+      {0xFB05, {'S', 'T'}},         {0xFB06, {'S', 'T'}}};
+  static const Special kLowerSpecials[] = {{0x130, {'i', 0x307}}};
+  const Special* begin = kUpper ? std::begin(kUpperSpecials) : std::begin(kLowerSpecials);
+  const Special* end = kUpper ? std::end(kUpperSpecials) : std::end(kLowerSpecials);
+  for (auto it = begin; it != end; ++it) {
+    if (it->from == c) {
+      int n = 0;
+      while (n < 3 && it->to[n] != 0) {
+        out[n] = it->to[n];
+        n++;
+      }
+      return n;
+    }
+  }
+  return 0;
+}
+
+/// Decodes the code point at in[i], setting *size to its byte length. Bytes that
+/// don't start a well formed sequence decode to themselves with size 1.
+inline uint32_t DecodeUtf8(const uint8_t* in, int64_t length, int64_t i, int* size) {
+  uint8_t c = in[i];
+  int n = c >= 0xF0 && c < 0xF8 ? 4 : (c >= 0xE0 ? 3 : (c >= 0xC0 ? 2 : 1));
+  if (n == 1 || c >= 0xF8 || i + n > length) {
+    *size = 1;
+    return c;
+  }
+  uint32_t cp = c & (0x7F >> n);
+  for (int k = 1; k < n; k++) {
+    if ((in[i + k] & 0xC0) != 0x80) {
+      *size = 1;
+      return c;
+    }
+    cp = (cp << 6) | (in[i + k] & 0x3F);
+  }
+  *size = n;
+  return cp;
+}
+
+inline void AppendUtf8(uint32_t cp, std::string* out) {
+  if (cp < 0x80) {
+    out->push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+inline bool IsLetter(uint32_t cp) {
+  auto locale = Utf8Locale();
+  if (locale == static_cast<locale_t>(0)) return CodepointCase<true>(cp) != cp ||
+                                                   CodepointCase<false>(cp) != cp;
+  return iswalpha_l(static_cast<wint_t>(cp), locale);
+}
+
+/// Appends the case mapping of a UTF-8 string of any content to out, the same as
+/// String.toUpperCase and toLowerCase of Java, which Spark falls back to for strings
+/// that aren't all ASCII: the multi code point mappings of SpecialCasing.txt, a final
+/// sigma and the simple mappings of the C library's UTF-8 locale.
+template <bool kUpper>
+void AppendUtf8Case(const uint8_t* in, int64_t length, std::string* out) {
+  auto locale = Utf8Locale();
+  uint32_t prev = 0;
+  int64_t i = 0;
+  while (i < length) {
+    if (in[i] < 0x80) {
+      prev = in[i];
+      out->push_back(static_cast<char>(AsciiCase<kUpper>(in[i])));
+      i++;
+      continue;
+    }
+    int size;
+    uint32_t cp = DecodeUtf8(in, length, i, &size);
+    if (size == 1) {
+      // not UTF-8, kept as is
+      out->push_back(static_cast<char>(in[i]));
+      prev = 0;
+      i++;
+      continue;
+    }
+    uint32_t special[3];
+    int num_special = SpecialCase<kUpper>(cp, special);
+    if (num_special > 0) {
+      for (int k = 0; k < num_special; k++) AppendUtf8(special[k], out);
+    } else if (!kUpper && cp == 0x3A3 && IsLetter(prev)) {
+      // a capital sigma ending a word lowers to the final form
+      int next_size = 0;
+      bool at_end = i + size >= length ||
+                    !IsLetter(DecodeUtf8(in, length, i + size, &next_size));
+      AppendUtf8(at_end ? 0x3C2 : 0x3C3, out);
+    } else if (locale != static_cast<locale_t>(0)) {
+      auto mapped = kUpper ? towupper_l(static_cast<wint_t>(cp), locale)
+                           : towlower_l(static_cast<wint_t>(cp), locale);
+      AppendUtf8(static_cast<uint32_t>(mapped), out);
+    } else {
+      AppendUtf8(CodepointCase<kUpper>(cp), out);
+    }
+    prev = cp;
+    i += size;
+  }
+}
+
+/// Case conversion of an all ASCII buffer, 16/32 bytes at a time.
+template <bool kUpper>
+void AsciiCaseRange(const uint8_t* in, int64_t length, uint8_t* out) {
+  int64_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 32 <= length; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), AsciiCase<kUpper>(v));
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 16 <= length; i += 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), AsciiCase<kUpper>(v));
+  }
+#endif
+  for (; i < length; i++) {
+    out[i] = AsciiCase<kUpper>(in[i]);
+  }
+}
+
+inline bool IsContinuation(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+int32_t NumChars(const uint8_t* data, int32_t length) {
+  int32_t num = 0;
+  for (int32_t i = 0; i < length; i++) {
+    num += !IsContinuation(data[i]);
+  }
+  return num;
+}
+
+/// Byte offset num_chars characters after from_byte, or length if there are fewer.
+int32_t CharToByteOffset(const uint8_t* data, int32_t length, int32_t from_byte,
+                         int32_t num_chars) {
+  int32_t i = from_byte;
+  while (i < length && num_chars > 0) {
+    i++;
+    while (i < length && IsContinuation(data[i])) i++;
+    num_chars--;
+  }
+  return i;
+}
+
+template <bool kUpper>
+std::string Utf8Case(arrow::util::string_view in) {
+  auto data = reinterpret_cast<const uint8_t*>(in.data());
+  std::string out;
+  if (IsAscii(data, in.size())) {
+    out.resize(in.size());
+    AsciiCaseRange<kUpper>(data, in.size(), reinterpret_cast<uint8_t*>(&out[0]));
+  } else {
+    out.reserve(in.size());
+    AppendUtf8Case<kUpper>(data, in.size(), &out);
+  }
+  return out;
+}
+
+template <bool kUpper>
+arrow::Status CaseStringArray(arrow::MemoryPool* pool,
+                              const std::shared_ptr<arrow::Array>& in,
+                              std::shared_ptr<arrow::Array>* out) {
+  auto typed_in = std::static_pointer_cast<arrow::StringArray>(in);
+  auto length = typed_in->length();
+  auto value_offsets = typed_in->raw_value_offsets();
+  auto value_data = typed_in->value_data() == nullptr ? nullptr
+                                                      : typed_in->value_data()->data();
+  int32_t data_begin = value_offsets[0];
+  int32_t data_end = value_offsets[length];
+  auto in_data = in->data();
+  if (IsAscii(value_data + data_begin, data_end - data_begin)) {
+    // ASCII case mapping keeps byte lengths, so validity and offsets of the input are
+    // reused and only [data_begin, data_end) of the value buffer is rewritten
+    std::shared_ptr<arrow::Buffer> data;
+    ARROW_ASSIGN_OR_RAISE(data, arrow::AllocateBuffer(data_end, pool));
+    AsciiCaseRange<kUpper>(value_data + data_begin, data_end - data_begin,
+                           data->mutable_data() + data_begin);
+    *out = arrow::MakeArray(arrow::ArrayData::Make(
+        in->type(), length, {in_data->buffers[0], in_data->buffers[1], data},
+        in->null_count(), in->offset()));
+    return arrow::Status::OK();
+  }
+
+  // other letters may change their byte length, ß uppers to SS
+  arrow::StringBuilder builder(pool);
+  RETURN_NOT_OK(builder.Reserve(length));
+  RETURN_NOT_OK(builder.ReserveData(data_end - data_begin));
+  std::string value;
+  for (int64_t i = 0; i < length; i++) {
+    if (typed_in->IsNull(i)) {
+      RETURN_NOT_OK(builder.AppendNull());
+      continue;
+    }
+    value.clear();
+    AppendUtf8Case<kUpper>(value_data + value_offsets[i],
+                           value_offsets[i + 1] - value_offsets[i], &value);
+    RETURN_NOT_OK(builder.Append(value));
+  }
+  return builder.Finish(out);
+}
+
+}  // namespace
+
+bool IsAscii(const uint8_t* data, int64_t length) {
+  int64_t i = 0;
+#if defined(__AVX2__)
+  auto acc = _mm256_setzero_si256();
+  for (; i + 32 <= length; i += 32) {
+    acc = _mm256_or_si256(acc,
+                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+  }
+  if (_mm256_movemask_epi8(acc) != 0) return false;
+#elif defined(__SSE2__)
+  auto acc = _mm_setzero_si128();
+  for (; i + 16 <= length; i += 16) {
+    acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+  }
+  if (_mm_movemask_epi8(acc) != 0) return false;
+#endif
+  uint64_t word_acc = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    word_acc |= word;
+  }
+  uint8_t byte_acc = 0;
+  for (; i < length; i++) {
+    byte_acc |= data[i];
+  }
+  return ((word_acc & 0x8080808080808080ULL) | (byte_acc & 0x80)) == 0;
+}
+
+void Utf8SubstrRange(const uint8_t* data, int32_t length, bool is_ascii, int32_t pos,
+                     int32_t len, int32_t* begin, int32_t* end) {
+  // same as UTF8String.substringSQL: pos is 1-based, 0 is taken as 1 and a negative
+  // pos counts from the end
+  int64_t num_chars = is_ascii ? length : NumChars(data, length);
+  int64_t start = pos > 0 ? pos - 1 : (pos < 0 ? num_chars + pos : 0);
+  int64_t stop = std::min(start + len, num_chars);
+  start = std::max<int64_t>(start, 0);
+  if (start >= stop) {
+    *begin = *end = 0;
+    return;
+  }
+  if (is_ascii) {
+    *begin = static_cast<int32_t>(start);
+    *end = static_cast<int32_t>(stop);
+  } else {
+    *begin = CharToByteOffset(data, length, 0, static_cast<int32_t>(start));
+    *end = CharToByteOffset(data, length, *begin, static_cast<int32_t>(stop - start));
+  }
+}
+
+std::string Utf8Upper(arrow::util::string_view in) { return Utf8Case<true>(in); }
+
+std::string Utf8Lower(arrow::util::string_view in) { return Utf8Case<false>(in); }
+
+std::string Utf8Substr(arrow::util::string_view in, int32_t pos, int32_t len) {
+  auto data = reinterpret_cast<const uint8_t*>(in.data());
+  int32_t length = static_cast<int32_t>(in.size());
+  int32_t begin, end;
+  Utf8SubstrRange(data, length, IsAscii(data, length), pos, len, &begin, &end);
+  return std::string(in.data() + begin, end - begin);
+}
+
+arrow::Status UpperStringArray(arrow::MemoryPool* pool,
+                               const std::shared_ptr<arrow::Array>& in,
+                               std::shared_ptr<arrow::Array>* out) {
+  return CaseStringArray<true>(pool, in, out);
+}
+
+arrow::Status LowerStringArray(arrow::MemoryPool* pool,
+                               const std::shared_ptr<arrow::Array>& in,
+                               std::shared_ptr<arrow::Array>* out) {
+  return CaseStringArray<false>(pool, in, out);
+}
+
+arrow::Status SubstrStringArray(arrow::MemoryPool* pool,
+                                const std::shared_ptr<arrow::Array>& in, int32_t pos,
+                                int32_t len, std::shared_ptr<arrow::Array>* out) {
+  auto typed_in = std::static_pointer_cast<arrow::StringArray>(in);
+  auto length = typed_in->length();
+  auto value_offsets = typed_in->raw_value_offsets();
+  auto value_data = typed_in->value_data() == nullptr ? nullptr
+                                                      : typed_in->value_data()->data();
+  int32_t data_begin = value_offsets[0];
+  int32_t data_end = value_offsets[length];
+  // one check for the whole batch decides between byte and character positions
+  bool is_ascii = IsAscii(value_data + data_begin, data_end - data_begin);
+
+  std::shared_ptr<arrow::Buffer> offsets;
+  std::shared_ptr<arrow::Buffer> data;
+  ARROW_ASSIGN_OR_RAISE(offsets,
+                        arrow::AllocateBuffer((length + 1) * sizeof(int32_t), pool));
+  // a substring is never longer than its input
+  ARROW_ASSIGN_OR_RAISE(data, arrow::AllocateBuffer(data_end - data_begin, pool));
+  auto out_offsets = reinterpret_cast<int32_t*>(offsets->mutable_data());
+  auto out_data = data->mutable_data();
+  int32_t out_pos = 0;
+  out_offsets[0] = 0;
+  for (int64_t i = 0; i < length; i++) {
+    if (!typed_in->IsNull(i)) {
+      auto value = value_data + value_offsets[i];
+      int32_t begin, end;
+      Utf8SubstrRange(value, value_offsets[i + 1] - value_offsets[i], is_ascii, pos,
+                      len, &begin, &end);
+      memcpy(out_data + out_pos, value + begin, end - begin);
+      out_pos += end - begin;
+    }
+    out_offsets[i + 1] = out_pos;
+  }
+
+  std::shared_ptr<arrow::Buffer> null_bitmap = in->data()->buffers[0];
+  if (null_bitmap != nullptr && in->offset() != 0) {
+    ARROW_ASSIGN_OR_RAISE(null_bitmap,
+                          arrow::internal::CopyBitmap(pool, null_bitmap->data(),
+                                                      in->offset(), length));
+  }
+  *out = arrow::MakeArray(arrow::ArrayData::Make(
+      in->type(), length, {null_bitmap, offsets, data}, in->null_count(), 0));
+  return arrow::Status::OK();
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+#include <arrow/type_fwd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "arrow/util/string_view.h"  // IWYU pragma: export
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// Returns true if every byte in [data, data + length) is 7-bit ASCII.
+bool IsAscii(const uint8_t* data, int64_t length);
+
+/// Byte range [*begin, *end) of Spark's substring(str, pos, len), where pos and len
+/// count characters.
+void Utf8SubstrRange(const uint8_t* data, int32_t length, bool is_ascii, int32_t pos,
+                     int32_t len, int32_t* begin, int32_t* end);
+
+/// Per-row helpers used by generated code when a batch kernel does not apply. Upper
+/// and lower convert ASCII 16/32 bytes at a time and map other strings the way Java
+/// does, with the length changing mappings such as ß to SS.
+std::string Utf8Upper(arrow::util::string_view in);
+std::string Utf8Lower(arrow::util::string_view in);
+std::string Utf8Substr(arrow::util::string_view in, int32_t pos, int32_t len);
+
+/// Per-batch kernels working on a whole StringArray. Offsets and validity of the
+/// input are shared with the output whenever possible, for upper and lower when the
+/// batch is all ASCII.
+arrow::Status UpperStringArray(arrow::MemoryPool* pool,
+                               const std::shared_ptr<arrow::Array>& in,
+                               std::shared_ptr<arrow::Array>* out);
+arrow::Status LowerStringArray(arrow::MemoryPool* pool,
+                               const std::shared_ptr<arrow::Array>& in,
+                               std::shared_ptr<arrow::Array>* out);
+arrow::Status SubstrStringArray(arrow::MemoryPool* pool,
+                                const std::shared_ptr<arrow::Array>& in, int32_t pos,
+                                int32_t len, std::shared_ptr<arrow::Array>* out);
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,623 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/string_predicates.h"
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/util/bit_util.h>
+#include <re2/re2.h>
+#include <string.h>
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+class StringMatcher::Impl {
+ public:
+  // one element of a LIKE pattern which is neither a prefix, suffix nor substring
+  struct Token {
+    enum Type { BYTE, ANY_CHAR, ANY_SEQUENCE } type;
+    uint8_t byte;
+  };
+
+  Kind kind_ = EXACT;
+  // the literal of EXACT, PREFIX, SUFFIX and SUBSTRING
+  std::string literal_;
+  std::vector<Token> tokens_;
+  std::unique_ptr<re2::RE2> regex_;
+
+  bool Match(const uint8_t* data, int64_t length) const {
+    switch (kind_) {
+      case EXACT:
+        return static_cast<size_t>(length) == literal_.size() &&
+               memcmp(data, literal_.data(), literal_.size()) == 0;
+      case PREFIX:
+        return static_cast<size_t>(length) >= literal_.size() &&
+               memcmp(data, literal_.data(), literal_.size()) == 0;
+      case SUFFIX:
+        return static_cast<size_t>(length) >= literal_.size() &&
+               memcmp(data + length - literal_.size(), literal_.data(),
+                      literal_.size()) == 0;
+      case SUBSTRING:
+        return literal_.empty() ||
+               memmem(data, length, literal_.data(), literal_.size()) != nullptr;
+      case WILDCARD:
+        return MatchWildcard(data, length);
+      case REGEX:
+        return re2::RE2::PartialMatch(
+            re2::StringPiece(reinterpret_cast<const char*>(data), length), *regex_);
+    }
+    return false;
+  }
+
+  arrow::Status MatchArray(arrow::MemoryPool* pool,
+                           const std::shared_ptr<arrow::Array>& in,
+                           std::shared_ptr<arrow::Buffer>* out) const {
+    auto typed_in = std::static_pointer_cast<arrow::StringArray>(in);
+    auto length = typed_in->length();
+    ARROW_ASSIGN_OR_RAISE(
+        *out, arrow::AllocateBuffer(arrow::BitUtil::BytesForBits(length), pool));
+    auto bitmap = (*out)->mutable_data();
+    memset(bitmap, 0, (*out)->size());
+    if (length == 0) {
+      return arrow::Status::OK();
+    }
+    auto offsets = typed_in->raw_value_offsets();
+    auto data = typed_in->value_data() == nullptr ? nullptr
+                                                  : typed_in->value_data()->data();
+    if (kind_ == SUBSTRING && !literal_.empty()) {
+      // Scan the whole value buffer instead of every string: each hit is mapped back
+      // to its row, and the search resumes at the start of the next row.
+      int64_t row = 0;
+      int32_t pos = offsets[0];
+      int32_t end = offsets[length];
+      while (pos < end) {
+        auto hit = static_cast<const uint8_t*>(
+            memmem(data + pos, end - pos, literal_.data(), literal_.size()));
+        if (hit == nullptr) {
+          break;
+        }
+        int32_t hit_pos = static_cast<int32_t>(hit - data);
+        while (offsets[row + 1] <= hit_pos) {
+          row++;
+        }
+        if (hit_pos + static_cast<int32_t>(literal_.size()) <= offsets[row + 1]) {
+          if (!typed_in->IsNull(row)) {
+            arrow::BitUtil::SetBit(bitmap, row);
+          }
+          pos = offsets[row + 1];
+        } else {
+          // the hit straddles two rows
+          pos = hit_pos + 1;
+        }
+      }
+      return arrow::Status::OK();
+    }
+    for (int64_t i = 0; i < length; i++) {
+      if (!typed_in->IsNull(i) &&
+          Match(data + offsets[i], offsets[i + 1] - offsets[i])) {
+        arrow::BitUtil::SetBit(bitmap, i);
+      }
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  static int64_t NextChar(const uint8_t* data, int64_t length, int64_t i) {
+    i++;
+    while (i < length && (data[i] & 0xC0) == 0x80) {
+      i++;
+    }
+    return i;
+  }
+
+  // iterative glob matching, backtracking to the last '%' only
+  bool MatchWildcard(const uint8_t* data, int64_t length) const {
+    int64_t i = 0;
+    size_t j = 0;
+    int64_t star_i = -1;
+    size_t star_j = 0;
+    while (i < length) {
+      if (j < tokens_.size() && tokens_[j].type == Token::ANY_CHAR) {
+        i = NextChar(data, length, i);
+        j++;
+      } else if (j < tokens_.size() && tokens_[j].type == Token::BYTE &&
+                 tokens_[j].byte == data[i]) {
+        i++;
+        j++;
+      } else if (j < tokens_.size() && tokens_[j].type == Token::ANY_SEQUENCE) {
+        star_j = j++;
+        star_i = i;
+      } else if (star_i >= 0) {
+        j = star_j + 1;
+        star_i = NextChar(data, length, star_i);
+        i = star_i;
+      } else {
+        return false;
+      }
+    }
+    while (j < tokens_.size() && tokens_[j].type == Token::ANY_SEQUENCE) {
+      j++;
+    }
+    return j == tokens_.size();
+  }
+};
+
+StringMatcher::StringMatcher() : impl_(new Impl()) {}
+StringMatcher::~StringMatcher() {}
+
+StringMatcher::Kind StringMatcher::kind() const { return impl_->kind_; }
+
+bool StringMatcher::Match(arrow::util::string_view value) const {
+  return impl_->Match(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+arrow::Status StringMatcher::MatchArray(arrow::MemoryPool* pool,
+                                        const std::shared_ptr<arrow::Array>& in,
+                                        std::shared_ptr<arrow::Buffer>* out) const {
+  return impl_->MatchArray(pool, in, out);
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::MakeStartsWith(const std::string& prefix) {
+  auto matcher = std::make_shared<StringMatcher>();
+  matcher->impl_->kind_ = PREFIX;
+  matcher->impl_->literal_ = prefix;
+  return matcher;
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::MakeEndsWith(const std::string& suffix) {
+  auto matcher = std::make_shared<StringMatcher>();
+  matcher->impl_->kind_ = SUFFIX;
+  matcher->impl_->literal_ = suffix;
+  return matcher;
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::MakeContains(const std::string& needle) {
+  auto matcher = std::make_shared<StringMatcher>();
+  matcher->impl_->kind_ = SUBSTRING;
+  matcher->impl_->literal_ = needle;
+  return matcher;
+}
+
+// the checks of Spark's StringUtils.escapeLikeRegex
+static arrow::Status ValidateLike(const std::string& pattern) {
+  for (size_t i = 0; i < pattern.size(); i++) {
+    if (pattern[i] != '\\') continue;
+    if (i + 1 == pattern.size()) {
+      return arrow::Status::Invalid("the pattern '", pattern,
+                                    "' is invalid, it is not allowed to end with the "
+                                    "escape character");
+    }
+    char next = pattern[++i];
+    if (next != '_' && next != '%' && next != '\\') {
+      return arrow::Status::Invalid("the pattern '", pattern,
+                                    "' is invalid, the escape character is not allowed "
+                                    "to precede '",
+                                    next, "'");
+    }
+  }
+  return arrow::Status::OK();
+}
+
+static bool HasRegexMetaCharacter(const std::string& pattern) {
+  return pattern.find_first_of("\\^$.|?*+()[]{}") != std::string::npos;
+}
+
+static arrow::Status CompileRegex(const std::string& pattern,
+                                  std::unique_ptr<re2::RE2>* out) {
+  std::string translated;
+  auto status = TranslateJavaRegex(pattern, &translated);
+  if (!status.ok()) {
+    return arrow::Status(status.code(),
+                         "Invalid regex pattern " + pattern + ": " + status.message());
+  }
+  re2::RE2::Options options;
+  options.set_log_errors(false);
+  out->reset(new re2::RE2(translated, options));
+  if (!(*out)->ok()) {
+    return arrow::Status::Invalid("Invalid regex pattern ", pattern, ": ",
+                                  (*out)->error());
+  }
+  return arrow::Status::OK();
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::MakeLike(const std::string& pattern) {
+  auto status = ValidateLike(pattern);
+  if (!status.ok()) {
+    throw std::runtime_error(status.message());
+  }
+  using Token = Impl::Token;
+  std::vector<Token> tokens;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    uint8_t c = pattern[i];
+    if (c == '\\') {
+      tokens.push_back({Token::BYTE, static_cast<uint8_t>(pattern[++i])});
+    } else if (c == '%') {
+      // consecutive '%' are the same as one
+      if (tokens.empty() || tokens.back().type != Token::ANY_SEQUENCE) {
+        tokens.push_back({Token::ANY_SEQUENCE, 0});
+      }
+    } else if (c == '_') {
+      tokens.push_back({Token::ANY_CHAR, 0});
+    } else {
+      tokens.push_back({Token::BYTE, c});
+    }
+  }
+  // classify: literal, literal%, %literal or %literal%
+  size_t begin = 0;
+  size_t end = tokens.size();
+  bool leading = begin < end && tokens[begin].type == Token::ANY_SEQUENCE;
+  bool trailing = end > begin + leading && tokens[end - 1].type == Token::ANY_SEQUENCE;
+  begin += leading;
+  end -= trailing;
+  std::string literal;
+  bool simple = true;
+  for (size_t i = begin; i < end; i++) {
+    if (tokens[i].type != Token::BYTE) {
+      simple = false;
+      break;
+    }
+    literal.push_back(static_cast<char>(tokens[i].byte));
+  }
+  auto matcher = std::make_shared<StringMatcher>();
+  if (!simple) {
+    matcher->impl_->kind_ = WILDCARD;
+    matcher->impl_->tokens_ = std::move(tokens);
+  } else {
+    matcher->impl_->literal_ = literal;
+    if (leading && trailing) {
+      matcher->impl_->kind_ = SUBSTRING;
+    } else if (leading) {
+      matcher->impl_->kind_ = SUFFIX;
+    } else if (trailing) {
+      matcher->impl_->kind_ = PREFIX;
+    } else {
+      matcher->impl_->kind_ = EXACT;
+    }
+  }
+  return matcher;
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::MakeRegex(const std::string& pattern) {
+  // a regex without any meta character is a plain substring search
+  if (!HasRegexMetaCharacter(pattern)) {
+    return MakeContains(pattern);
+  }
+  auto matcher = std::make_shared<StringMatcher>();
+  matcher->impl_->kind_ = REGEX;
+  auto status = CompileRegex(pattern, &matcher->impl_->regex_);
+  if (!status.ok()) {
+    throw std::runtime_error(status.message());
+  }
+  return matcher;
+}
+
+arrow::Status StringMatcher::Validate(const std::string& func_name,
+                                      const std::string& pattern) {
+  if (func_name == "like") {
+    return ValidateLike(pattern);
+  } else if (func_name == "rlike") {
+    if (!HasRegexMetaCharacter(pattern)) {
+      return arrow::Status::OK();
+    }
+    std::unique_ptr<re2::RE2> regex;
+    return CompileRegex(pattern, &regex);
+  } else if (func_name == "starts_with" || func_name == "ends_with" ||
+             func_name == "is_substr") {
+    return arrow::Status::OK();
+  }
+  return arrow::Status::NotImplemented("StringMatcher doesn't support ", func_name);
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::GetOrMake(const std::string& func_name,
+                                                        const std::string& pattern) {
+  static std::mutex mtx;
+  static std::map<std::pair<std::string, std::string>, std::shared_ptr<StringMatcher>>
+      cache;
+  auto key = std::make_pair(func_name, pattern);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  auto matcher = Make(func_name, pattern);
+  std::lock_guard<std::mutex> lock(mtx);
+  if (cache.size() >= kMaxCachedMatchers) {
+    cache.clear();
+  }
+  cache.emplace(key, matcher);
+  return matcher;
+}
+
+std::shared_ptr<StringMatcher> StringMatcher::Make(const std::string& func_name,
+                                                   const std::string& pattern) {
+  std::shared_ptr<StringMatcher> matcher;
+  if (func_name == "starts_with") {
+    matcher = MakeStartsWith(pattern);
+  } else if (func_name == "ends_with") {
+    matcher = MakeEndsWith(pattern);
+  } else if (func_name == "is_substr") {
+    matcher = MakeContains(pattern);
+  } else if (func_name == "like") {
+    matcher = MakeLike(pattern);
+  } else if (func_name == "rlike") {
+    matcher = MakeRegex(pattern);
+  } else {
+    throw std::runtime_error("StringMatcher doesn't support " + func_name);
+  }
+  return matcher;
+}
+
+// java.util.regex classes RE2 spells differently
+static const char kJavaHorizontalSpace[] =
+    " \\t\\x{a0}\\x{1680}\\x{180e}\\x{2000}-\\x{200a}\\x{202f}\\x{205f}\\x{3000}";
+static const char kJavaVerticalSpace[] = "\\n\\x0B\\f\\r\\x{85}\\x{2028}\\x{2029}";
+static const char kJavaSpace[] = "\\t\\n\\x0B\\f\\r ";
+
+static const std::map<std::string, std::string> kJavaPosixClasses = {
+    {"Lower", "lower"},          {"Upper", "upper"},         {"ASCII", "ascii"},
+    {"Alpha", "alpha"},          {"Digit", "digit"},         {"Alnum", "alnum"},
+    {"Punct", "punct"},          {"Graph", "graph"},         {"Print", "print"},
+    {"Blank", "blank"},          {"Cntrl", "cntrl"},         {"XDigit", "xdigit"},
+    {"Space", "space"},          {"javaLowerCase", "lower"}, {"javaUpperCase", "upper"},
+    {"javaWhitespace", "space"}};
+
+static std::string HexEscape(uint32_t code_point) {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "\\x{%x}", code_point);
+  return buffer;
+}
+
+// a character class of the given members, or its members when already in a class
+static std::string ClassOf(const std::string& members, bool negated, bool in_class) {
+  if (in_class) return members;
+  return (negated ? "[^" : "[") + members + "]";
+}
+
+arrow::Status TranslateJavaRegex(const std::string& pattern, std::string* out) {
+  out->clear();
+  // without MULTILINE, Java's $ also matches before a final line terminator
+  bool multiline = false;
+  for (size_t i = 0; i + 1 < pattern.size(); i++) {
+    if (pattern[i] == '(' && pattern[i + 1] == '?') {
+      auto end = pattern.find_first_of(":)", i);
+      auto flags = pattern.substr(i + 2, end == std::string::npos ? 0 : end - i - 2);
+      auto minus = flags.find('-');
+      multiline |= flags.substr(0, minus).find('m') != std::string::npos;
+    }
+  }
+  bool in_class = false;
+  bool in_braces = false;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    char c = pattern[i];
+    char next = i + 1 < pattern.size() ? pattern[i + 1] : '\0';
+    if (c == '\\') {
+      if (i + 1 == pattern.size()) {
+        return arrow::Status::Invalid("trailing backslash");
+      }
+      i++;
+      switch (next) {
+        case 'Q': {
+          // quoted literal up to \E, escaped one character at a time
+          auto end = pattern.find("\\E", i + 1);
+          auto literal = pattern.substr(
+              i + 1, end == std::string::npos ? std::string::npos : end - i - 1);
+          for (char l : literal) {
+            if (!isalnum(static_cast<unsigned char>(l)) &&
+                !(static_cast<unsigned char>(l) & 0x80)) {
+              out->push_back('\\');
+            }
+            out->push_back(l);
+          }
+          i = end == std::string::npos ? pattern.size() : end + 1;
+          break;
+        }
+        case '0': {
+          uint32_t value = 0;
+          size_t digits = 0;
+          while (digits < 3 && i + 1 < pattern.size() && pattern[i + 1] >= '0' &&
+                 pattern[i + 1] <= '7' && value * 8 + (pattern[i + 1] - '0') <= 0377) {
+            value = value * 8 + (pattern[++i] - '0');
+            digits++;
+          }
+          if (digits == 0) return arrow::Status::Invalid("illegal octal escape");
+          out->append(HexEscape(value));
+          break;
+        }
+        case 'c':
+          if (i + 1 == pattern.size()) {
+            return arrow::Status::Invalid("illegal control escape");
+          }
+          out->append(HexEscape(pattern[++i] ^ 64));
+          break;
+        case 'e':
+          out->append(HexEscape(0x1b));
+          break;
+        case 'u':
+          if (i + 4 >= pattern.size()) {
+            return arrow::Status::Invalid("illegal unicode escape");
+          }
+          out->append("\\x{" + pattern.substr(i + 1, 4) + "}");
+          i += 4;
+          break;
+        case 's':
+          out->append(ClassOf(kJavaSpace, false, in_class));
+          break;
+        case 'h':
+          out->append(ClassOf(kJavaHorizontalSpace, false, in_class));
+          break;
+        case 'v':
+          out->append(ClassOf(kJavaVerticalSpace, false, in_class));
+          break;
+        case 'S':
+        case 'H':
+        case 'V':
+          if (in_class) {
+            return arrow::Status::NotImplemented("\\", next, " in a character class");
+          }
+          out->append(ClassOf(next == 'S'   ? kJavaSpace
+                              : next == 'H' ? kJavaHorizontalSpace
+                                            : kJavaVerticalSpace,
+                              true, false));
+          break;
+        case 'R':
+          out->append(std::string("(?:\\r\\n|[") + kJavaVerticalSpace + "])");
+          break;
+        case 'Z':
+          out->append("(?:\\n?\\z)");
+          break;
+        case 'p':
+        case 'P': {
+          std::string name;
+          if (i + 1 < pattern.size() && pattern[i + 1] == '{') {
+            auto end = pattern.find('}', i);
+            if (end == std::string::npos) {
+              return arrow::Status::Invalid("unclosed character family");
+            }
+            name = pattern.substr(i + 2, end - i - 2);
+            i = end;
+          } else if (i + 1 < pattern.size()) {
+            name = pattern.substr(++i, 1);
+          }
+          bool negated = next == 'P';
+          auto posix = kJavaPosixClasses.find(name);
+          if (posix != kJavaPosixClasses.end()) {
+            auto member = std::string(negated ? "[:^" : "[:") + posix->second + ":]";
+            out->append(in_class ? member : "[" + member + "]");
+            break;
+          }
+          if (name.compare(0, 2, "In") == 0) {
+            return arrow::Status::NotImplemented("unicode block ", name);
+          }
+          // scripts and categories, Java optionally prefixes them with Is
+          if (name.compare(0, 2, "Is") == 0) name = name.substr(2);
+          out->append(std::string("\\") + next + "{" + name + "}");
+          break;
+        }
+        case 'k':
+        case 'G':
+          return arrow::Status::NotImplemented("\\", next);
+        default:
+          if (next >= '1' && next <= '9') {
+            return arrow::Status::NotImplemented("back reference \\", next);
+          }
+          out->push_back('\\');
+          out->push_back(next);
+      }
+      continue;
+    }
+    if (in_class) {
+      if (c == '[') {
+        return arrow::Status::NotImplemented("nested character class");
+      } else if (c == '&' && next == '&') {
+        return arrow::Status::NotImplemented("character class intersection");
+      } else if (c == ']') {
+        in_class = false;
+      }
+      out->push_back(c);
+      continue;
+    }
+    switch (c) {
+      case '[':
+        in_class = true;
+        out->push_back(c);
+        if (next == '^') out->push_back(pattern[++i]);
+        // a leading ] is a member
+        if (i + 1 < pattern.size() && pattern[i + 1] == ']') {
+          out->append("\\]");
+          i++;
+        }
+        break;
+      case '(':
+        if (next != '?') {
+          out->push_back(c);
+          break;
+        }
+        i++;
+        if (i + 1 < pattern.size() &&
+            (pattern[i + 1] == '=' || pattern[i + 1] == '!' ||
+             (pattern[i + 1] == '<' && i + 2 < pattern.size() &&
+              (pattern[i + 2] == '=' || pattern[i + 2] == '!')))) {
+          return arrow::Status::NotImplemented("lookaround");
+        } else if (i + 1 < pattern.size() && pattern[i + 1] == '>') {
+          return arrow::Status::NotImplemented("atomic group");
+        } else if (i + 1 < pattern.size() && pattern[i + 1] == '<') {
+          out->append("(?P");
+        } else if (i + 1 < pattern.size() && pattern[i + 1] == ':') {
+          out->append("(?");
+        } else {
+          // inline flags, RE2 reads i, m and s alike and has no others of Java
+          std::string flags;
+          while (i + 1 < pattern.size() && pattern[i + 1] != ':' &&
+                 pattern[i + 1] != ')') {
+            char flag = pattern[++i];
+            if (flag == 'x' || flag == 'U') {
+              return arrow::Status::NotImplemented("regex flag ", flag);
+            }
+            if (flag != 'u' && flag != 'd') flags.push_back(flag);
+          }
+          if (i + 1 == pattern.size()) {
+            return arrow::Status::Invalid("unclosed group");
+          }
+          bool group = pattern[++i] == ':';
+          if (!flags.empty() && flags.back() == '-') flags.pop_back();
+          if (group) {
+            out->append("(?" + flags + ":");
+          } else if (!flags.empty()) {
+            out->append("(?" + flags + ")");
+          }
+        }
+        break;
+      case '$':
+        out->append(multiline ? "$" : "(?:\\n?\\z)");
+        break;
+      case '{':
+        in_braces = true;
+        out->push_back(c);
+        break;
+      case '}':
+      case '*':
+      case '+':
+      case '?':
+        if (c == '}' && !in_braces) {
+          out->push_back(c);
+          break;
+        }
+        in_braces = false;
+        if (next == '+') {
+          return arrow::Status::NotImplemented("possessive quantifier");
+        }
+        out->push_back(c);
+        break;
+      default:
+        out->push_back(c);
+    }
+  }
+  return arrow::Status::OK();
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
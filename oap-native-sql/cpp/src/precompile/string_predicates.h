@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+#include <arrow/type_fwd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "arrow/util/string_view.h"  // IWYU pragma: export
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+/// String predicate with a constant pattern: starts_with, ends_with, is_substr, like
+/// and rlike. The pattern is classified once when the matcher is made, so a LIKE
+/// such as 'abc%' or '%abc%' is evaluated as a prefix compare or a memmem scan, and a
+/// regex is compiled once with RE2.
+class StringMatcher {
+ public:
+  enum Kind { EXACT, PREFIX, SUFFIX, SUBSTRING, WILDCARD, REGEX };
+
+  /// Makers throw std::runtime_error for an invalid pattern, like the rest of the
+  /// generated code does on setup failures. Code generation calls Validate() first,
+  /// the jitted kernels must never see a pattern that throws.
+  static std::shared_ptr<StringMatcher> MakeStartsWith(const std::string& prefix);
+  static std::shared_ptr<StringMatcher> MakeEndsWith(const std::string& suffix);
+  static std::shared_ptr<StringMatcher> MakeContains(const std::string& needle);
+  /// Spark LIKE with '\' as escape character.
+  static std::shared_ptr<StringMatcher> MakeLike(const std::string& pattern);
+  /// Spark RLIKE, true if the java.util.regex pattern matches any part of the string.
+  static std::shared_ptr<StringMatcher> MakeRegex(const std::string& pattern);
+  /// Matcher of one of the functions above by its name.
+  static std::shared_ptr<StringMatcher> Make(const std::string& func_name,
+                                             const std::string& pattern);
+  /// Invalid for a LIKE pattern Spark rejects, a trailing '\\' or one escaping
+  /// anything but '_', '%' and '\\', NotImplemented for a regex RE2 can't run.
+  static arrow::Status Validate(const std::string& func_name, const std::string& pattern);
+  /// Matchers of literal patterns are cached by function name and pattern, so all
+  /// kernels using the same predicate share one compiled program. The cache is
+  /// dropped once it holds kMaxCachedMatchers, holders keep their matchers.
+  static std::shared_ptr<StringMatcher> GetOrMake(const std::string& func_name,
+                                                  const std::string& pattern);
+  static constexpr size_t kMaxCachedMatchers = 1024;
+
+  StringMatcher();
+  ~StringMatcher();
+
+  Kind kind() const;
+  bool Match(arrow::util::string_view value) const;
+
+  /// Evaluates the predicate over a whole StringArray into a selection bitmap of
+  /// in->length() bits starting at bit 0. Bits of null rows are left unset.
+  arrow::Status MatchArray(arrow::MemoryPool* pool,
+                           const std::shared_ptr<arrow::Array>& in,
+                           std::shared_ptr<arrow::Buffer>* out) const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/// Matcher of a pattern computed per row, compiled again only when the pattern differs
+/// from the one of the previous row.
+class StringMatcherMemo {
+ public:
+  explicit StringMatcherMemo(std::string func_name) : func_name_(std::move(func_name)) {}
+
+  const StringMatcher& Get(arrow::util::string_view pattern) {
+    if (matcher_ == nullptr ||
+        arrow::util::string_view(pattern_.data(), pattern_.size()) != pattern) {
+      pattern_.assign(pattern.data(), pattern.size());
+      matcher_ = StringMatcher::Make(func_name_, pattern_);
+    }
+    return *matcher_;
+  }
+
+ private:
+  const std::string func_name_;
+  std::string pattern_;
+  std::shared_ptr<StringMatcher> matcher_;
+};
+
+/// Rewrites a java.util.regex pattern to the RE2 syntax, e.g. \p{Alpha} to
+/// [[:alpha:]] and \Z to (?:\n?\z). Returns NotImplemented for constructs RE2 has
+/// no equivalent of: back references, lookaround, atomic groups, possessive
+/// quantifiers and class unions or intersections.
+arrow::Status TranslateJavaRegex(const std::string& pattern, std::string* out);
+
+inline bool GetSelection(const uint8_t* bitmap, int64_t i) {
+  return (bitmap[i >> 3] >> (i & 0x07)) & 1;
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
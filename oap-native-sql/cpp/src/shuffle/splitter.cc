@@ -15,6 +15,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -26,6 +28,7 @@
 
 #include "shuffle/splitter.h"
 #include "shuffle/utils.h"
+#include "utils/gandiva_registry.h"
 #include "utils/macros.h"
 
 #if defined(COLUMNAR_PLUGIN_USE_AVX512)
@@ -122,6 +125,16 @@ inline void PrefetchDstAddr(__m512i dst_addr_8x, int32_t scale) {
 }
 #endif
 
+// marks the partition buffers as in use, so that they are not spilled meanwhile
+class PartitionBuffersInUse {
+ public:
+  explicit PartitionBuffersInUse(bool* in_use) : in_use_(in_use) { *in_use_ = true; }
+  ~PartitionBuffersInUse() { *in_use_ = false; }
+
+ private:
+  bool* in_use_;
+};
+
 class Splitter::PartitionWriter {
  public:
   explicit PartitionWriter(Splitter* splitter) : splitter_(splitter) {}
@@ -252,6 +265,12 @@ arrow::Result<std::shared_ptr<Splitter>> Splitter::Make(
   return Make(short_name, std::move(schema), num_partitions, {}, std::move(options));
 }
 
+Splitter::~Splitter() {
+  if (spill_arbiter_ != nullptr) {
+    spill_arbiter_->Unregister(this);
+  }
+}
+
 arrow::Status Splitter::Init() {
   const auto& fields = schema_->fields();
   ARROW_ASSIGN_OR_RAISE(column_type_id_, ToSplitterTypeId(schema_->fields()));
@@ -306,6 +325,11 @@ arrow::Status Splitter::Init() {
   if (options_.data_file.length() == 0) {
     ARROW_ASSIGN_OR_RAISE(options_.data_file, CreateTempShuffleFile(configured_dirs_[0]));
   }
+
+  spill_arbiter_ = GetSpillArbiter(options_.memory_pool);
+  if (spill_arbiter_ != nullptr) {
+    spill_arbiter_->Register(this);
+  }
   return arrow::Status::OK();
 }
 
@@ -319,6 +343,7 @@ arrow::Status Splitter::Split(const arrow::RecordBatch& rb) {
 
 arrow::Status Splitter::Stop() {
   EVAL_START("write", options_.thread_id)
+  PartitionBuffersInUse in_use(&splitting_);
   // open data file output stream
   ARROW_ASSIGN_OR_RAISE(data_file_os_,
                         arrow::io::FileOutputStream::Open(options_.data_file, true));
@@ -458,6 +483,7 @@ arrow::Result<std::shared_ptr<arrow::RecordBatch>> Splitter::MakeRecordBatchAndR
 }
 
 arrow::Status Splitter::DoSplit(const arrow::RecordBatch& rb) {
+  PartitionBuffersInUse in_use(&splitting_);
   // prepare partition buffers and spill if necessary
   for (auto pid = 0; pid < num_partitions_; ++pid) {
     if (partition_id_cnt_[pid] > partition_buffer_size_[pid]) {
@@ -509,6 +535,85 @@ arrow::Status Splitter::SpillPartition(int32_t partition_id) {
   return partition_writer_[partition_id]->Spill(batch);
 }
 
+int64_t Splitter::PartitionBufferBytes(int32_t partition_id) const {
+  if (partition_buffer_size_[partition_id] == 0) {
+    return 0;
+  }
+  int64_t bytes = 0;
+  for (const auto& column_buffers : partition_fixed_width_buffers_) {
+    for (const auto& buffer : column_buffers[partition_id]) {
+      if (buffer != nullptr) {
+        bytes += buffer->capacity();
+      }
+    }
+  }
+  for (const auto& column_builders : partition_binary_builders_) {
+    const auto& builder = column_builders[partition_id];
+    if (builder != nullptr) {
+      bytes += builder->value_data_capacity() + builder->capacity() * sizeof(int32_t);
+    }
+  }
+  for (const auto& column_builders : partition_large_binary_builders_) {
+    const auto& builder = column_builders[partition_id];
+    if (builder != nullptr) {
+      bytes += builder->value_data_capacity() + builder->capacity() * sizeof(int64_t);
+    }
+  }
+  return bytes;
+}
+
+void Splitter::ReleasePartitionBuffers(int32_t partition_id) {
+  for (auto i = 0; i < partition_fixed_width_buffers_.size(); ++i) {
+    partition_fixed_width_buffers_[i][partition_id].clear();
+    partition_fixed_width_validity_addrs_[i][partition_id] = nullptr;
+    partition_fixed_width_value_addrs_[i][partition_id] = nullptr;
+  }
+  for (auto& column_builders : partition_binary_builders_) {
+    column_builders[partition_id] = nullptr;
+  }
+  for (auto& column_builders : partition_large_binary_builders_) {
+    column_builders[partition_id] = nullptr;
+  }
+  // buffers are allocated again by the next DoSplit() with rows of this partition
+  partition_buffer_size_[partition_id] = 0;
+}
+
+int64_t Splitter::GetReclaimableBytes() const {
+  if (splitting_) {
+    return 0;
+  }
+  int64_t bytes = 0;
+  for (auto pid = 0; pid < num_partitions_; ++pid) {
+    bytes += PartitionBufferBytes(pid);
+  }
+  return bytes;
+}
+
+arrow::Status Splitter::Spill(int64_t size, int64_t* reclaimed) {
+  *reclaimed = 0;
+  if (splitting_) {
+    return arrow::Status::OK();
+  }
+  std::vector<std::pair<int64_t, int32_t>> partitions;
+  for (auto pid = 0; pid < num_partitions_; ++pid) {
+    auto bytes = PartitionBufferBytes(pid);
+    if (bytes > 0) {
+      partitions.emplace_back(bytes, pid);
+    }
+  }
+  std::sort(partitions.begin(), partitions.end(), std::greater<>());
+  for (const auto& partition : partitions) {
+    if (*reclaimed >= size) break;
+    auto pid = partition.second;
+    if (partition_buffer_idx_base_[pid] > 0) {
+      RETURN_NOT_OK(SpillPartition(pid));
+    }
+    ReleasePartitionBuffers(pid);
+    *reclaimed += partition.first;
+  }
+  return arrow::Status::OK();
+}
+
 arrow::Status Splitter::SplitFixedWidthValueBuffer(const arrow::RecordBatch& rb) {
   const auto num_rows = rb.num_rows();
   for (auto col = 0; col < fixed_width_array_idx_.size(); ++col) {
@@ -909,7 +1014,9 @@ arrow::Status HashSplitter::CreateProjector(
   }
   auto hash_expr =
       gandiva::TreeExprBuilder::MakeExpression(hash, arrow::field("pid", arrow::int32()));
-  return gandiva::Projector::Make(schema_, {hash_expr}, &projector_);
+  return GandivaRegistry::Get()->MakeProjector(
+      schema_, {hash_expr}, gandiva::ConfigurationBuilder::DefaultConfiguration(),
+      &projector_);
 }
 
 arrow::Status HashSplitter::ComputeAndCountPartitionId(const arrow::RecordBatch& rb) {
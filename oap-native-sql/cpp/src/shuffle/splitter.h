@@ -30,11 +30,12 @@
 
 #include "shuffle/type.h"
 #include "shuffle/utils.h"
+#include "utils/spill_arbiter.h"
 
 namespace sparkcolumnarplugin {
 namespace shuffle {
 
-class Splitter {
+class Splitter : public Spillable {
  public:
   static arrow::Result<std::shared_ptr<Splitter>> Make(
       const std::string& short_name, std::shared_ptr<arrow::Schema> schema,
@@ -45,6 +46,8 @@ class Splitter {
       const std::string& short_name, std::shared_ptr<arrow::Schema> schema,
       int num_partitions, SplitOptions options = SplitOptions::Defaults());
 
+  virtual ~Splitter();
+
   virtual const std::shared_ptr<arrow::Schema>& schema() const { return schema_; }
 
   virtual arrow::Status Split(const arrow::RecordBatch&);
@@ -72,6 +75,21 @@ class Splitter {
   // for testing
   const std::string& DataFile() const { return options_.data_file; }
 
+  std::string SpillableName() const override { return "ShuffleSplitter"; }
+
+  /***
+   * Bytes held by the partition buffers, 0 while a batch is being split or the
+   * splitter is stopping as the buffers are in use then.
+   */
+  int64_t GetReclaimableBytes() const override;
+
+  /***
+   * Spill the partitions holding the largest buffers until size bytes are released.
+   * Buffered rows are written to the partitions' spill files, then the buffers are
+   * freed and allocated again once the partition gets new rows.
+   */
+  arrow::Status Spill(int64_t size, int64_t* reclaimed) override;
+
  protected:
   Splitter(int32_t num_partitions, std::shared_ptr<arrow::Schema> schema,
            SplitOptions options)
@@ -112,6 +130,10 @@ class Splitter {
 
   arrow::Status AllocatePartitionBuffers(int32_t partition_id, int32_t new_size);
 
+  int64_t PartitionBufferBytes(int32_t partition_id) const;
+
+  void ReleasePartitionBuffers(int32_t partition_id);
+
   class PartitionWriter;
 
   std::vector<int32_t> partition_buffer_size_;
@@ -154,6 +176,12 @@ class Splitter {
   std::vector<std::string> configured_dirs_;
 
   std::shared_ptr<arrow::io::FileOutputStream> data_file_os_;
+
+  // arbiter of the task's memory pool, the splitter can be spilled to free memory for
+  // other operators of the task
+  std::shared_ptr<SpillArbiter> spill_arbiter_;
+  // partition buffers are in use, Split() and Stop() are running
+  bool splitting_ = false;
 };
 
 class RoundRobinSplitter : public Splitter {
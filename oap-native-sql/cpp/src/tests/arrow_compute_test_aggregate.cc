@@ -391,6 +391,65 @@ TEST(TestArrowCompute, GroupByTwoAggregateWithMultipleBatchTest) {
   ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
 }
 
+TEST(TestArrowCompute, GroupByTwoAggregateWithNullKeysTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", uint32());
+  auto f2 = field("f2", uint32());
+  auto f_unique_0 = field("unique", uint32());
+  auto f_unique_1 = field("unique", uint32());
+  auto f_sum = field("sum", uint64());
+  auto f_res = field("res", uint64());
+
+  auto arg0 = TreeExprBuilder::MakeField(f0);
+  auto arg1 = TreeExprBuilder::MakeField(f1);
+  auto arg2 = TreeExprBuilder::MakeField(f2);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg0, arg1}, uint32());
+
+  auto n_split = TreeExprBuilder::MakeFunction("splitArrayListWithAction",
+                                               {n_pre, arg0, arg1, arg2}, uint32());
+  auto n_unique_0 =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg0}, uint32());
+  auto n_unique_1 =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg1}, uint32());
+  auto n_sum = TreeExprBuilder::MakeFunction("action_sum", {n_split, arg2}, uint32());
+
+  auto unique_expr_0 = TreeExprBuilder::MakeExpression(n_unique_0, f_res);
+  auto unique_expr_1 = TreeExprBuilder::MakeExpression(n_unique_1, f_res);
+  auto sum_expr = TreeExprBuilder::MakeExpression(n_sum, f_res);
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {
+      unique_expr_0, unique_expr_1, sum_expr};
+  auto sch = arrow::schema({f0, f1, f2});
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique_0, f_unique_1, f_sum};
+
+  /////////////////////// Create Expression Evaluator ////////////////////
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+  ////////////////////// calculation /////////////////////
+  // (NULL, 5) and (5, NULL) are two groups, their keys are only told apart by the
+  // position of the null
+  std::vector<std::string> input_data = {"[null, 5, null, 5, 1, null]",
+                                         "[5, null, 5, null, 1, null]",
+                                         "[1, 2, 3, 4, 5, 6]"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  ////////////////////// Finish //////////////////////////
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+  ASSERT_NOT_OK(expr->finish(&result_batch));
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {
+      "[null, 5, 1, null]", "[5, null, 1, null]", "[4, 6, 5, 6]"};
+  auto res_sch = arrow::schema({f_unique_0, f_unique_1, f_sum});
+  MakeInputBatch(expected_result_string, res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+}
+
 TEST(TestArrowCompute, GroupByTwoUtf8AggregateWithMultipleBatchTest) {
   ////////////////////// prepare expr_vector ///////////////////////
   auto f0 = field("f0", utf8());
@@ -788,5 +847,411 @@ TEST(TestArrowCompute, GroupbySumCountMergeTest) {
   ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
 }
 
+TEST(TestArrowCompute, GroupByCountDistinctWithMultipleBatchTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", int64());
+  auto f2 = field("f2", utf8());
+  auto f_unique = field("unique", uint32());
+  auto f_count_0 = field("count_distinct_f1", int64());
+  auto f_count_1 = field("count_distinct_f1_f2", int64());
+  auto f_res = field("res", uint32());
+
+  auto arg_0 = TreeExprBuilder::MakeField(f0);
+  auto arg_1 = TreeExprBuilder::MakeField(f1);
+  auto arg_2 = TreeExprBuilder::MakeField(f2);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_0}, uint32());
+  auto n_split = TreeExprBuilder::MakeFunction(
+      "splitArrayListWithAction", {n_pre, arg_0, arg_1, arg_1, arg_2}, uint32());
+  auto n_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg_0}, uint32());
+  auto n_count_0 =
+      TreeExprBuilder::MakeFunction("action_count_distinct_1", {n_split, arg_1}, uint32());
+  auto n_count_1 = TreeExprBuilder::MakeFunction("action_count_distinct_2",
+                                                 {n_split, arg_1, arg_2}, uint32());
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {
+      TreeExprBuilder::MakeExpression(n_unique, f_res),
+      TreeExprBuilder::MakeExpression(n_count_0, f_res),
+      TreeExprBuilder::MakeExpression(n_count_1, f_res)};
+  auto sch = arrow::schema({f0, f1, f2});
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique, f_count_0, f_count_1};
+
+  // run once fully in memory, and once spilling the distinct sets on every batch
+  for (auto spill_threshold : {"536870912", "1"}) {
+    setenv("NATIVESQL_DISTINCT_SPILL_THRESHOLD", spill_threshold, 1);
+    /////////////////////// Create Expression Evaluator ////////////////////
+    std::shared_ptr<CodeGenerator> expr;
+    ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+    std::shared_ptr<arrow::RecordBatch> input_batch;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+    ////////////////////// calculation /////////////////////
+    std::vector<std::string> input_data = {
+        "[1, 2, 1, 3, 2, 1, 4, 4]", "[1, 10, 1, 7, 10, 3, null, 5]",
+        R"(["a", "b", "a", "c", "b", "a", "d", "d"])"};
+    MakeInputBatch(input_data, sch, &input_batch);
+    ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+    std::vector<std::string> input_data_2 = {"[2, 1, 3, 4, 4, 2]",
+                                             "[11, 3, 7, 5, 6, 10]",
+                                             R"(["b", "a", "c", "e", "e", "x"])"};
+    MakeInputBatch(input_data_2, sch, &input_batch);
+    ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+    ////////////////////// Finish //////////////////////////
+    std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+    ASSERT_NOT_OK(expr->finish(&result_batch));
+
+    std::shared_ptr<arrow::RecordBatch> expected_result;
+    std::vector<std::string> expected_result_string = {"[1, 2, 3, 4]", "[2, 2, 1, 2]",
+                                                       "[2, 3, 1, 3]"};
+    auto res_sch = arrow::schema(ret_types);
+    MakeInputBatch(expected_result_string, res_sch, &expected_result);
+    ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+  }
+  unsetenv("NATIVESQL_DISTINCT_SPILL_THRESHOLD");
+}
+
+TEST(TestArrowCompute, GroupByApproxCountDistinctWithMultipleBatchTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", int64());
+  auto f_unique = field("unique", uint32());
+  auto f_res = field("res", uint32());
+
+  auto arg_0 = TreeExprBuilder::MakeField(f0);
+  auto arg_1 = TreeExprBuilder::MakeField(f1);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_0}, uint32());
+  auto n_split = TreeExprBuilder::MakeFunction("splitArrayListWithAction",
+                                               {n_pre, arg_0, arg_1}, uint32());
+  auto n_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg_0}, uint32());
+  auto n_partial = TreeExprBuilder::MakeFunction(
+      "action_approx_count_distinct_partial_0.05", {n_split, arg_1}, uint32());
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {
+      TreeExprBuilder::MakeExpression(n_unique, f_res),
+      TreeExprBuilder::MakeExpression(n_partial, f_res)};
+  auto sch = arrow::schema({f0, f1});
+  // relativeSD 0.05 => p = 9, 512 registers packed into 52 words
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique};
+  for (int i = 0; i < 52; i++) {
+    ret_types.push_back(field("MS[" + std::to_string(i) + "]", int64()));
+  }
+
+  /////////////////////// Create Expression Evaluator ////////////////////
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+  ////////////////////// calculation /////////////////////
+  std::vector<std::string> input_data = {
+      "[1, 2, 1, 3, 2, 1, 4, 4, 4, 4, 4]",
+      "[1, 10, 2, 7, 11, 3, 100, 200, 300, 400, 500]"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::string> input_data_2 = {
+      "[2, 2, 2, 1, 3, 2, 4, 4, 4, 4, 4, 1, 1, 2]",
+      "[12, 13, 14, 1, 7, 10, 600, 700, 800, 900, 1000, 2, null, 11]"};
+  MakeInputBatch(input_data_2, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> partial_batch;
+  ASSERT_NOT_OK(expr->finish(&partial_batch));
+
+  ////////////////////// final aggregation //////////////////////////
+  auto partial_sch = arrow::schema(ret_types);
+  auto arg_key = TreeExprBuilder::MakeField(ret_types[0]);
+  auto n_final_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_key}, uint32());
+  std::vector<std::shared_ptr<gandiva::Node>> split_args = {n_final_pre, arg_key};
+  std::vector<std::shared_ptr<gandiva::Node>> final_args = {};
+  for (int i = 1; i < ret_types.size(); i++) {
+    split_args.push_back(TreeExprBuilder::MakeField(ret_types[i]));
+  }
+  auto n_final_split =
+      TreeExprBuilder::MakeFunction("splitArrayListWithAction", split_args, uint32());
+  final_args.push_back(n_final_split);
+  for (int i = 1; i < ret_types.size(); i++) {
+    final_args.push_back(TreeExprBuilder::MakeField(ret_types[i]));
+  }
+  auto n_final_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_final_split, arg_key}, uint32());
+  auto n_final = TreeExprBuilder::MakeFunction("action_approx_count_distinct_final_0.05",
+                                               final_args, uint32());
+  std::vector<std::shared_ptr<::gandiva::Expression>> final_expr_vector = {
+      TreeExprBuilder::MakeExpression(n_final_unique, f_res),
+      TreeExprBuilder::MakeExpression(n_final, f_res)};
+  auto f_count = field("count", int64());
+  std::vector<std::shared_ptr<Field>> final_ret_types = {f_unique, f_count};
+
+  std::shared_ptr<CodeGenerator> final_expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(partial_sch, final_expr_vector, final_ret_types,
+                                    &final_expr, true));
+  ASSERT_NOT_OK(final_expr->evaluate(partial_batch[0], &output_batch_list));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+  ASSERT_NOT_OK(final_expr->finish(&result_batch));
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {"[1, 2, 3, 4]", "[3, 5, 1, 10]"};
+  auto res_sch = arrow::schema(final_ret_types);
+  MakeInputBatch(expected_result_string, res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+
+  // a relative standard deviation of 0 fails instead of sizing a sketch
+  auto n_zero_sd = TreeExprBuilder::MakeFunction(
+      "action_approx_count_distinct_partial_0", {n_split, arg_1}, uint32());
+  std::shared_ptr<CodeGenerator> zero_sd_expr;
+  auto status = CreateCodeGenerator(
+      sch, {TreeExprBuilder::MakeExpression(n_unique, f_res),
+            TreeExprBuilder::MakeExpression(n_zero_sd, f_res)},
+      ret_types, &zero_sd_expr, true);
+  if (status.ok()) {
+    status = zero_sd_expr->evaluate(input_batch, &output_batch_list);
+  }
+  ASSERT_FALSE(status.ok());
+}
+
+TEST(TestArrowCompute, GroupByPercentileApproxWithMultipleBatchTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", int64());
+  auto f_unique = field("unique", uint32());
+  auto f_digest = field("digest", binary());
+  auto f_res = field("res", uint32());
+
+  auto arg_0 = TreeExprBuilder::MakeField(f0);
+  auto arg_1 = TreeExprBuilder::MakeField(f1);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_0}, uint32());
+  auto n_split = TreeExprBuilder::MakeFunction("splitArrayListWithAction",
+                                               {n_pre, arg_0, arg_1}, uint32());
+  auto n_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg_0}, uint32());
+  auto n_partial = TreeExprBuilder::MakeFunction("action_percentile_approx_partial_10000",
+                                                 {n_split, arg_1}, uint32());
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {
+      TreeExprBuilder::MakeExpression(n_unique, f_res),
+      TreeExprBuilder::MakeExpression(n_partial, f_res)};
+  auto sch = arrow::schema({f0, f1});
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique, f_digest};
+
+  /////////////////////// Create Expression Evaluator ////////////////////
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+  ////////////////////// calculation /////////////////////
+  std::vector<std::string> input_data = {
+      "[1, 2, 1, 3, 2, 1, 4, 4, 4, 4, 4]",
+      "[1, 10, 2, 7, 11, 3, 100, 200, 300, 400, 500]"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::string> input_data_2 = {
+      "[2, 2, 2, 1, 3, 2, 4, 4, 4, 4, 4, 1, 1, 2]",
+      "[12, 13, 14, 1, 7, 10, 600, 700, 800, 900, 1000, 2, null, 11]"};
+  MakeInputBatch(input_data_2, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> partial_batch;
+  ASSERT_NOT_OK(expr->finish(&partial_batch));
+
+  ////////////////////// final aggregation //////////////////////////
+  auto partial_sch = arrow::schema(ret_types);
+  auto arg_key = TreeExprBuilder::MakeField(f_unique);
+  auto arg_digest = TreeExprBuilder::MakeField(f_digest);
+  auto n_final_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_key}, uint32());
+  auto n_final_split = TreeExprBuilder::MakeFunction(
+      "splitArrayListWithAction", {n_final_pre, arg_key, arg_digest}, uint32());
+  auto n_final_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_final_split, arg_key}, uint32());
+  auto n_final = TreeExprBuilder::MakeFunction(
+      "action_percentile_approx_final_0.5_10000_int64", {n_final_split, arg_digest},
+      uint32());
+  std::vector<std::shared_ptr<::gandiva::Expression>> final_expr_vector = {
+      TreeExprBuilder::MakeExpression(n_final_unique, f_res),
+      TreeExprBuilder::MakeExpression(n_final, f_res)};
+  auto f_median = field("median", int64());
+  std::vector<std::shared_ptr<Field>> final_ret_types = {f_unique, f_median};
+
+  std::shared_ptr<CodeGenerator> final_expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(partial_sch, final_expr_vector, final_ret_types,
+                                    &final_expr, true));
+  ASSERT_NOT_OK(final_expr->evaluate(partial_batch[0], &output_batch_list));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+  ASSERT_NOT_OK(final_expr->finish(&result_batch));
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {"[1, 2, 3, 4]",
+                                                     "[2, 11, 7, 500]"};
+  auto res_sch = arrow::schema(final_ret_types);
+  MakeInputBatch(expected_result_string, res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+
+  // a truncated state fails the merge instead of reading past it
+  auto digest_array = std::dynamic_pointer_cast<arrow::BinaryArray>(
+      partial_batch[0]->GetColumnByName("digest"));
+  auto digest = digest_array->GetView(0);
+  arrow::BinaryBuilder truncated_builder;
+  ASSERT_NOT_OK(truncated_builder.Append(digest.data(), digest.size() - 8));
+  std::shared_ptr<arrow::Array> truncated;
+  ASSERT_NOT_OK(truncated_builder.Finish(&truncated));
+  auto truncated_batch = arrow::RecordBatch::Make(
+      partial_sch, 1, {partial_batch[0]->column(0)->Slice(0, 1), truncated});
+  std::shared_ptr<CodeGenerator> truncated_expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(partial_sch, final_expr_vector, final_ret_types,
+                                    &truncated_expr, true));
+  ASSERT_FALSE(truncated_expr->evaluate(truncated_batch, &output_batch_list).ok());
+
+  // an unknown result type fails instead of falling back to double
+  auto n_bad_type = TreeExprBuilder::MakeFunction(
+      "action_percentile_approx_final_0.5_10000_int65", {n_final_split, arg_digest},
+      uint32());
+  std::shared_ptr<CodeGenerator> bad_type_expr;
+  auto status = CreateCodeGenerator(
+      partial_sch, {TreeExprBuilder::MakeExpression(n_final_unique, f_res),
+                    TreeExprBuilder::MakeExpression(n_bad_type, f_res)},
+      final_ret_types, &bad_type_expr, true);
+  if (status.ok()) {
+    status = bad_type_expr->evaluate(partial_batch[0], &output_batch_list);
+  }
+  ASSERT_FALSE(status.ok());
+}
+
+TEST(TestArrowCompute, GroupByDecimalSumAvgWithMultipleBatchTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", decimal(10, 2));
+  auto f_unique = field("unique", uint32());
+  auto f_sum = field("sum", decimal(20, 2));
+  auto f_avg = field("avg", decimal(14, 6));
+  auto f_res = field("res", uint32());
+
+  auto arg_pre = TreeExprBuilder::MakeField(f0);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_pre}, uint32());
+
+  auto arg0 = TreeExprBuilder::MakeField(f0);
+  auto arg1 = TreeExprBuilder::MakeField(f1);
+  auto n_split = TreeExprBuilder::MakeFunction("splitArrayListWithAction",
+                                               {n_pre, arg0, arg1}, uint32());
+  auto n_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg0}, uint32());
+  auto n_sum = TreeExprBuilder::MakeFunction("action_sum", {n_split, arg1}, uint32());
+  auto n_avg = TreeExprBuilder::MakeFunction("action_avg", {n_split, arg1}, uint32());
+
+  auto unique_expr = TreeExprBuilder::MakeExpression(n_unique, f_res);
+  auto sum_expr = TreeExprBuilder::MakeExpression(n_sum, f_res);
+  auto avg_expr = TreeExprBuilder::MakeExpression(n_avg, f_res);
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {unique_expr,
+                                                                     sum_expr, avg_expr};
+  auto sch = arrow::schema({f0, f1});
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique, f_sum, f_avg};
+
+  /////////////////////// Create Expression Evaluator ////////////////////
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+  ////////////////////// calculation /////////////////////
+  std::vector<std::string> input_data = {
+      "[1, 2, 1, 2, 3]", R"(["1.10", "2.25", null, "-0.25", "3.33"])"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::string> input_data_2 = {"[3, 1, 2, 4]",
+                                           R"(["0.01", "2.00", "0.02", null])"};
+  MakeInputBatch(input_data_2, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  ////////////////////// Finish //////////////////////////
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+  ASSERT_NOT_OK(expr->finish(&result_batch));
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {
+      "[1, 2, 3, 4]", R"(["3.10", "2.02", "3.34", null])",
+      R"(["1.550000", "0.673333", "1.670000", null])"};
+  auto res_sch = arrow::schema({f_unique, f_sum, f_avg});
+  MakeInputBatch(expected_result_string, res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+}
+
+TEST(TestArrowCompute, GroupByDecimalSumAvgMergeWithMultipleBatchTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", uint32());
+  auto f1 = field("f1", decimal(20, 2));
+  auto f2 = field("f2", int64());
+  auto f_unique = field("unique", uint32());
+  auto f_sum = field("sum", decimal(20, 2));
+  auto f_count = field("count", int64());
+  auto f_avg = field("avg", decimal(14, 6));
+  auto f_res = field("res", uint32());
+
+  auto arg_pre = TreeExprBuilder::MakeField(f0);
+  auto n_pre = TreeExprBuilder::MakeFunction("encodeArray", {arg_pre}, uint32());
+
+  auto arg0 = TreeExprBuilder::MakeField(f0);
+  auto arg1 = TreeExprBuilder::MakeField(f1);
+  auto arg2 = TreeExprBuilder::MakeField(f2);
+  auto n_split = TreeExprBuilder::MakeFunction("splitArrayListWithAction",
+                                               {n_pre, arg0, arg1, arg2}, uint32());
+  auto n_unique =
+      TreeExprBuilder::MakeFunction("action_unique", {n_split, arg0}, uint32());
+  auto n_sum =
+      TreeExprBuilder::MakeFunction("action_sum_merge", {n_split, arg1}, uint32());
+  auto n_merge = TreeExprBuilder::MakeFunction("action_sum_count_merge",
+                                               {n_split, arg1, arg2}, uint32());
+  auto n_avg = TreeExprBuilder::MakeFunction("action_avgByCount_14_6",
+                                             {n_split, arg1, arg2}, uint32());
+
+  auto unique_expr = TreeExprBuilder::MakeExpression(n_unique, f_res);
+  auto sum_expr = TreeExprBuilder::MakeExpression(n_sum, f_res);
+  auto merge_expr = TreeExprBuilder::MakeExpression(n_merge, f_res);
+  auto avg_expr = TreeExprBuilder::MakeExpression(n_avg, f_res);
+
+  std::vector<std::shared_ptr<::gandiva::Expression>> expr_vector = {
+      unique_expr, sum_expr, merge_expr, avg_expr};
+  auto sch = arrow::schema({f0, f1, f2});
+  std::vector<std::shared_ptr<Field>> ret_types = {f_unique, f_sum, f_sum, f_count,
+                                                   f_avg};
+
+  /////////////////////// Create Expression Evaluator ////////////////////
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, expr_vector, ret_types, &expr, true));
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> output_batch_list;
+
+  ////////////////////// calculation /////////////////////
+  // partial sum_count buffers, a null sum is skipped with its count
+  std::vector<std::string> input_data = {
+      "[1, 2, 1, 3]", R"(["1.10", "2.25", "2.00", null])", "[1, 1, 1, 5]"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  std::vector<std::string> input_data_2 = {
+      "[2, 3, 4]", R"(["-0.23", "3.34", "0.00"])", "[2, 2, 0]"};
+  MakeInputBatch(input_data_2, sch, &input_batch);
+  ASSERT_NOT_OK(expr->evaluate(input_batch, &output_batch_list));
+
+  ////////////////////// Finish //////////////////////////
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batch;
+  ASSERT_NOT_OK(expr->finish(&result_batch));
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {
+      "[1, 2, 3, 4]", R"(["3.10", "2.02", "3.34", "0.00"])",
+      R"(["3.10", "2.02", "3.34", "0.00"])", "[2, 3, 2, 0]",
+      R"(["1.550000", "0.673333", "1.670000", null])"};
+  auto res_sch = arrow::schema({f_unique, f_sum, f_sum, f_count, f_avg});
+  MakeInputBatch(expected_result_string, res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *(result_batch[0]).get()));
+}
+
 }  // namespace codegen
 }  // namespace sparkcolumnarplugin
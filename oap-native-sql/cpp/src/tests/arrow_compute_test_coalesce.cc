@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "codegen/code_generator.h"
+#include "codegen/code_generator_factory.h"
+#include "tests/test_utils.h"
+
+using arrow::int32;
+using arrow::uint32;
+using arrow::utf8;
+using gandiva::TreeExprBuilder;
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+TEST(TestArrowComputeCoalesce, CoalesceBatchesByRowsTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", int32());
+  auto f1 = field("f1", utf8());
+  auto f_res = field("res", uint32());
+
+  auto n_coalesce = TreeExprBuilder::MakeFunction(
+      "CoalesceBatches", {TreeExprBuilder::MakeLiteral((int)4)}, uint32());
+  auto n_standalone =
+      TreeExprBuilder::MakeFunction("standalone", {n_coalesce}, uint32());
+  auto coalesce_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+  auto sch = arrow::schema({f0, f1});
+
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, {coalesce_expr}, {f0, f1}, &expr, true));
+
+  ////////////////////// calculation /////////////////////
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+  std::vector<std::vector<std::string>> input_data_list = {
+      {"[1, 2]", R"(["a", "b"])"},
+      {"[3]", R"(["c"])"},
+      {"[4, null, 6]", R"(["d", "e", null])"},
+      {"[7, 8, 9, 10, 11]", R"(["f", "g", "h", "i", "j"])"}};
+  for (auto input_data : input_data_list) {
+    MakeInputBatch(input_data, sch, &input_batch);
+    ASSERT_NOT_OK(expr->evaluate(input_batch, &dummy_result_batches));
+  }
+
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr->finish(&result_iterator_base));
+  auto result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(result_iterator_base);
+
+  std::vector<std::vector<std::string>> expected_result_list = {
+      {"[1, 2, 3, 4]", R"(["a", "b", "c", "d"])"},
+      {"[null, 6, 7, 8]", R"(["e", null, "f", "g"])"},
+      {"[9, 10, 11]", R"(["h", "i", "j"])"}};
+  for (auto expected_result_string : expected_result_list) {
+    ASSERT_TRUE(result_iterator->HasNext());
+    std::shared_ptr<arrow::RecordBatch> expected_result;
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    MakeInputBatch(expected_result_string, sch, &expected_result);
+    ASSERT_NOT_OK(result_iterator->Next(&result_batch));
+    ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+  }
+  ASSERT_FALSE(result_iterator->HasNext());
+}
+
+TEST(TestArrowComputeCoalesce, CoalesceBatchesByBytesTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", int32());
+  auto f_res = field("res", uint32());
+
+  // 10000 rows at most, or 12 bytes, i.e. three int32 values. Input batches are split
+  // so that no output batch goes over 12 bytes.
+  auto n_coalesce = TreeExprBuilder::MakeFunction(
+      "CoalesceBatches",
+      {TreeExprBuilder::MakeLiteral((int)10000), TreeExprBuilder::MakeLiteral((int64_t)12)},
+      uint32());
+  auto n_standalone =
+      TreeExprBuilder::MakeFunction("standalone", {n_coalesce}, uint32());
+  auto coalesce_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+  auto sch = arrow::schema({f0});
+
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, {coalesce_expr}, {f0}, &expr, true));
+
+  ////////////////////// calculation /////////////////////
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+  std::vector<std::vector<std::string>> input_data_list = {
+      {"[1, 2]"}, {"[3, 4]"}, {"[5]"}, {"[6]"}, {"[7]"}};
+  for (auto input_data : input_data_list) {
+    MakeInputBatch(input_data, sch, &input_batch);
+    ASSERT_NOT_OK(expr->evaluate(input_batch, &dummy_result_batches));
+  }
+
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr->finish(&result_iterator_base));
+  auto result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(result_iterator_base);
+
+  // [3, 4] is split, the last batch is what remains at the end of the input
+  std::vector<std::vector<std::string>> expected_result_list = {
+      {"[1, 2, 3]"}, {"[4, 5, 6]"}, {"[7]"}};
+  for (auto expected_result_string : expected_result_list) {
+    ASSERT_TRUE(result_iterator->HasNext());
+    std::shared_ptr<arrow::RecordBatch> expected_result;
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    MakeInputBatch(expected_result_string, sch, &expected_result);
+    ASSERT_NOT_OK(result_iterator->Next(&result_batch));
+    ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+  }
+  ASSERT_FALSE(result_iterator->HasNext());
+}
+
+TEST(TestArrowComputeCoalesce, CoalesceBatchesStreamingTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", int32());
+  auto f_res = field("res", uint32());
+
+  auto n_coalesce = TreeExprBuilder::MakeFunction(
+      "CoalesceBatches",
+      {TreeExprBuilder::MakeLiteral((int)10000), TreeExprBuilder::MakeLiteral((int64_t)12)},
+      uint32());
+  auto n_standalone =
+      TreeExprBuilder::MakeFunction("standalone", {n_coalesce}, uint32());
+  auto coalesce_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+  auto sch = arrow::schema({f0});
+
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(CreateCodeGenerator(sch, {coalesce_expr}, {f0}, &expr, true));
+
+  // the iterator is made before any input, batches come out as soon as they are full
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr->finish(&result_iterator_base));
+  auto result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(result_iterator_base);
+  ASSERT_FALSE(result_iterator->HasNext());
+
+  auto process = [&](const std::string& input_data) {
+    std::shared_ptr<arrow::RecordBatch> input_batch;
+    MakeInputBatch({input_data}, sch, &input_batch);
+    return result_iterator->ProcessAndCacheOne(input_batch->columns());
+  };
+  auto check_next = [&](const std::string& expected_data) {
+    ASSERT_TRUE(result_iterator->HasNext());
+    std::shared_ptr<arrow::RecordBatch> expected_result;
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    MakeInputBatch({expected_data}, sch, &expected_result);
+    ASSERT_NOT_OK(result_iterator->Next(&result_batch));
+    ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+  };
+
+  // an oversized input batch is cut into full batches, the rest stays buffered
+  ASSERT_NOT_OK(process("[1, 2, 3, 4, 5, 6, 7]"));
+  check_next("[1, 2, 3]");
+  check_next("[4, 5, 6]");
+  ASSERT_FALSE(result_iterator->HasNext());
+
+  ASSERT_NOT_OK(process("[8]"));
+  ASSERT_FALSE(result_iterator->HasNext());
+  ASSERT_NOT_OK(process("[9, 10]"));
+  check_next("[7, 8, 9]");
+  ASSERT_FALSE(result_iterator->HasNext());
+
+  ASSERT_NOT_OK(result_iterator->FinishInput());
+  check_next("[10]");
+  ASSERT_FALSE(result_iterator->HasNext());
+}
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "codegen/code_generator.h"
+#include "codegen/code_generator_factory.h"
+#include "tests/test_utils.h"
+
+using arrow::int32;
+using arrow::int64;
+using arrow::uint32;
+using arrow::utf8;
+using gandiva::TreeExprBuilder;
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+
+TEST(TestArrowComputeExpand, ExpandRollupTest) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto f0 = field("f0", int32());
+  auto f1 = field("f1", utf8());
+  auto f2 = field("f2", int64());
+  auto f_gid = field("spark_grouping_id", int32());
+  auto f_res = field("res", uint32());
+
+  // GROUP BY ROLLUP(f0, f1)
+  auto n_f0 = TreeExprBuilder::MakeField(f0);
+  auto n_f1 = TreeExprBuilder::MakeField(f1);
+  auto n_f2 = TreeExprBuilder::MakeField(f2);
+  auto n_projection_0 = TreeExprBuilder::MakeFunction(
+      "projection", {n_f0, n_f1, n_f2, TreeExprBuilder::MakeLiteral((int)0)}, uint32());
+  auto n_projection_1 = TreeExprBuilder::MakeFunction(
+      "projection",
+      {n_f0, TreeExprBuilder::MakeNull(utf8()), n_f2,
+       TreeExprBuilder::MakeLiteral((int)1)},
+      uint32());
+  auto n_projection_2 = TreeExprBuilder::MakeFunction(
+      "projection",
+      {TreeExprBuilder::MakeNull(int32()), TreeExprBuilder::MakeNull(utf8()), n_f2,
+       TreeExprBuilder::MakeLiteral((int)3)},
+      uint32());
+  auto n_expand = TreeExprBuilder::MakeFunction(
+      "Expand", {n_projection_0, n_projection_1, n_projection_2}, uint32());
+  auto n_standalone = TreeExprBuilder::MakeFunction("standalone", {n_expand}, uint32());
+  auto expand_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+  auto sch = arrow::schema({f0, f1, f2});
+  auto res_sch = arrow::schema({f0, f1, f2, f_gid});
+
+  std::shared_ptr<CodeGenerator> expr;
+  ASSERT_NOT_OK(
+      CreateCodeGenerator(sch, {expand_expr}, {f0, f1, f2, f_gid}, &expr, true));
+
+  ////////////////////// calculation /////////////////////
+  // the second batch is shorter and the third one longer than the first one, so the
+  // cached constant columns are sliced and rebuilt
+  std::vector<std::shared_ptr<arrow::RecordBatch>> input_batch_list;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+  std::vector<std::vector<std::string>> input_data_list = {
+      {"[1, 2, null]", R"(["a", null, "c"])", "[10, 20, 30]"},
+      {"[4, 5]", R"(["d", "e"])", "[40, 50]"},
+      {"[6, 7, 8, 9]", R"(["f", "g", "h", "i"])", "[60, 70, 80, 90]"}};
+  for (auto input_data : input_data_list) {
+    std::shared_ptr<arrow::RecordBatch> input_batch;
+    MakeInputBatch(input_data, sch, &input_batch);
+    ASSERT_NOT_OK(expr->evaluate(input_batch, &dummy_result_batches));
+    input_batch_list.push_back(input_batch);
+  }
+
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr->finish(&result_iterator_base));
+  auto result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(result_iterator_base);
+
+  std::vector<std::vector<std::string>> expected_result_list = {
+      {"[1, 2, null]", R"(["a", null, "c"])", "[10, 20, 30]", "[0, 0, 0]"},
+      {"[1, 2, null]", "[null, null, null]", "[10, 20, 30]", "[1, 1, 1]"},
+      {"[null, null, null]", "[null, null, null]", "[10, 20, 30]", "[3, 3, 3]"},
+      {"[4, 5]", R"(["d", "e"])", "[40, 50]", "[0, 0]"},
+      {"[4, 5]", "[null, null]", "[40, 50]", "[1, 1]"},
+      {"[null, null]", "[null, null]", "[40, 50]", "[3, 3]"},
+      {"[6, 7, 8, 9]", R"(["f", "g", "h", "i"])", "[60, 70, 80, 90]", "[0, 0, 0, 0]"},
+      {"[6, 7, 8, 9]", "[null, null, null, null]", "[60, 70, 80, 90]", "[1, 1, 1, 1]"},
+      {"[null, null, null, null]", "[null, null, null, null]", "[60, 70, 80, 90]",
+       "[3, 3, 3, 3]"}};
+  for (int i = 0; i < expected_result_list.size(); i++) {
+    ASSERT_TRUE(result_iterator->HasNext());
+    std::shared_ptr<arrow::RecordBatch> expected_result;
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    MakeInputBatch(expected_result_list[i], res_sch, &expected_result);
+    ASSERT_NOT_OK(result_iterator->Next(&result_batch));
+    ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+    // the passed through column shares the input buffers
+    ASSERT_EQ(result_batch->column(2)->data()->buffers[1],
+              input_batch_list[i / 3]->column(2)->data()->buffers[1]);
+  }
+  ASSERT_FALSE(result_iterator->HasNext());
+}
+
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -20,6 +20,7 @@
 #include <arrow/record_batch.h>
 #include <gandiva/tree_expr_builder.h>
 #include <gtest/gtest.h>
+#include <stdlib.h>
 
 #include <memory>
 
@@ -357,6 +358,135 @@ TEST(TestArrowComputeWSCG, JoinWOCGTestTwoStringInnerJoin) {
   }
 }
 
+TEST(TestArrowComputeWSCG, JoinWOCGTestTwoIntInnerJoin) {
+  ////////////////////// prepare expr_vector ///////////////////////
+  // two int32 keys are packed into one exact int64 key
+  auto table0_f0 = field("table0_f0", arrow::int32());
+  auto table0_f1 = field("table0_f1", arrow::int32());
+  auto table0_f2 = field("table0_f2", uint32());
+  auto table1_f0 = field("table1_f0", arrow::int32());
+  auto table1_f1 = field("table1_f1", arrow::int32());
+
+  ///////////////////////////////////////////
+  auto n_left = TreeExprBuilder::MakeFunction(
+      "codegen_left_schema",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeField(table0_f2)},
+      uint32());
+  auto n_right = TreeExprBuilder::MakeFunction(
+      "codegen_right_schema",
+      {TreeExprBuilder::MakeField(table1_f0), TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto f_res = field("res", uint32());
+
+  auto n_left_key = TreeExprBuilder::MakeFunction(
+      "codegen_left_key_schema",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1)},
+      uint32());
+  auto n_right_key = TreeExprBuilder::MakeFunction(
+      "codegen_right_key_schema",
+      {TreeExprBuilder::MakeField(table1_f0), TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_result = TreeExprBuilder::MakeFunction(
+      "result",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeField(table0_f2), TreeExprBuilder::MakeField(table1_f0),
+       TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_hash_config = TreeExprBuilder::MakeFunction(
+      "build_keys_config_node", {TreeExprBuilder::MakeLiteral((int)0)}, uint32());
+  auto n_probeArrays = TreeExprBuilder::MakeFunction(
+      "conditionedProbeArraysInner",
+      {n_left, n_right, n_left_key, n_right_key, n_result, n_hash_config}, uint32());
+  auto n_standalone =
+      TreeExprBuilder::MakeFunction("standalone", {n_probeArrays}, uint32());
+  auto probeArrays_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1, table0_f2});
+  auto schema_table_1 = arrow::schema({table1_f0, table1_f1});
+  auto schema_table =
+      arrow::schema({table0_f0, table0_f1, table0_f2, table1_f0, table1_f1});
+
+  auto n_hash_kernel =
+      TreeExprBuilder::MakeFunction("HashRelation", {n_left_key}, uint32());
+  auto n_hash = TreeExprBuilder::MakeFunction("standalone", {n_hash_kernel}, uint32());
+  auto hashRelation_expr = TreeExprBuilder::MakeExpression(n_hash, f_res);
+  std::shared_ptr<CodeGenerator> expr_build;
+  ASSERT_NOT_OK(
+      CreateCodeGenerator(schema_table_0, {hashRelation_expr}, {}, &expr_build, true));
+  std::shared_ptr<CodeGenerator> expr_probe;
+  ASSERT_NOT_OK(CreateCodeGenerator(
+      schema_table_1, {probeArrays_expr},
+      {table0_f0, table0_f1, table0_f2, table1_f0, table1_f1}, &expr_probe, true));
+  ///////////////////// Calculation //////////////////
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> table_0;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> table_1;
+
+  std::vector<std::string> input_data_string = {
+      "[1, -1, 0, 2147483647]", "[-1, 1, 5, -2147483648]", "[1, 2, 3, 4]"};
+  MakeInputBatch(input_data_string, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+
+  input_data_string = {"[3, 5, 1, 7]", "[4, 6, 1, 8]", "[5, 6, 7, 8]"};
+  MakeInputBatch(input_data_string, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+
+  std::vector<std::string> input_data_2_string = {"[1, 0, 2147483647, -1, 9, 5]",
+                                                  "[-1, 5, -2147483648, -1, 9, 6]"};
+  MakeInputBatch(input_data_2_string, schema_table_1, &input_batch);
+  table_1.push_back(input_batch);
+
+  input_data_2_string = {"[-1, 3, 1, 4]", "[1, 4, 1, 3]"};
+  MakeInputBatch(input_data_2_string, schema_table_1, &input_batch);
+  table_1.push_back(input_batch);
+
+  //////////////////////// data prepared /////////////////////////
+
+  std::vector<std::shared_ptr<RecordBatch>> expected_table;
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {
+      "[1, 0, 2147483647, 5]", "[-1, 5, -2147483648, 6]", "[1, 3, 4, 6]",
+      "[1, 0, 2147483647, 5]", "[-1, 5, -2147483648, 6]"};
+  MakeInputBatch(expected_result_string, schema_table, &expected_result);
+  expected_table.push_back(expected_result);
+
+  expected_result_string = {"[-1, 3, 1]", "[1, 4, 1]", "[2, 5, 7]", "[-1, 3, 1]",
+                            "[1, 4, 1]"};
+  MakeInputBatch(expected_result_string, schema_table, &expected_result);
+  expected_table.push_back(expected_result);
+
+  ////////////////////// evaluate //////////////////////
+  for (auto batch : table_0) {
+    ASSERT_NOT_OK(expr_build->evaluate(batch, &dummy_result_batches));
+  }
+  std::shared_ptr<ResultIteratorBase> build_result_iterator;
+  std::shared_ptr<ResultIteratorBase> probe_result_iterator_base;
+  ASSERT_NOT_OK(expr_build->finish(&build_result_iterator));
+  ASSERT_NOT_OK(expr_probe->finish(&probe_result_iterator_base));
+
+  auto probe_result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+          probe_result_iterator_base);
+  probe_result_iterator->SetDependencies({build_result_iterator});
+
+  for (int i = 0; i < 2; i++) {
+    auto right_batch = table_1[i];
+
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    std::vector<std::shared_ptr<arrow::Array>> input;
+    for (int i = 0; i < right_batch->num_columns(); i++) {
+      input.push_back(right_batch->column(i));
+    }
+
+    ASSERT_NOT_OK(probe_result_iterator->Process(input, &result_batch));
+    ASSERT_NOT_OK(Equals(*(expected_table[i]).get(), *result_batch.get()));
+  }
+}
+
 TEST(TestArrowComputeWSCG, JoinWOCGTestOuterJoin) {
   ////////////////////// prepare expr_vector ///////////////////////
   auto table0_f0 = field("table0_f0", uint32());
@@ -2011,5 +2141,261 @@ TEST(TestArrowComputeWSCG, JoinWOCGTestStringInnerJoinType2LoadHashRelation) {
   }
 }
 
+TEST(TestArrowComputeWSCG, JoinWOCGTestTwoStringInnerJoinType2RowPayload) {
+  // gather the build side from packed rows, which is only chosen for wide payloads
+  setenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT", "row", 1);
+  ////////////////////// prepare expr_vector ///////////////////////
+  auto table0_f0 = field("table0_f0", utf8());
+  auto table0_f1 = field("table0_f1", utf8());
+  auto table0_f2 = field("table0_f2", uint32());
+  auto table1_f0 = field("table1_f0", utf8());
+  auto table1_f1 = field("table1_f1", utf8());
+
+  ///////////////////////////////////////////
+  auto n_left = TreeExprBuilder::MakeFunction(
+      "codegen_left_schema",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeField(table0_f2)},
+      uint32());
+  auto n_right = TreeExprBuilder::MakeFunction(
+      "codegen_right_schema",
+      {TreeExprBuilder::MakeField(table1_f0), TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto f_res = field("res", uint32());
+
+  auto n_left_key = TreeExprBuilder::MakeFunction(
+      "codegen_left_key_schema",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1)},
+      uint32());
+  auto n_right_key = TreeExprBuilder::MakeFunction(
+      "codegen_right_key_schema",
+      {TreeExprBuilder::MakeField(table1_f0), TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_result = TreeExprBuilder::MakeFunction(
+      "result",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeField(table0_f2), TreeExprBuilder::MakeField(table1_f0),
+       TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_hash_config = TreeExprBuilder::MakeFunction(
+      "build_keys_config_node", {TreeExprBuilder::MakeLiteral((int)1)}, uint32());
+  auto n_probeArrays = TreeExprBuilder::MakeFunction(
+      "conditionedProbeArraysInner",
+      {n_left, n_right, n_left_key, n_right_key, n_result, n_hash_config}, uint32());
+  auto n_standalone =
+      TreeExprBuilder::MakeFunction("standalone", {n_probeArrays}, uint32());
+  auto probeArrays_expr = TreeExprBuilder::MakeExpression(n_standalone, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1, table0_f2});
+  auto schema_table_1 = arrow::schema({table1_f0, table1_f1});
+  auto schema_table =
+      arrow::schema({table0_f0, table0_f1, table0_f2, table1_f0, table1_f1});
+
+  auto n_hash_kernel = TreeExprBuilder::MakeFunction(
+      "HashRelation", {n_left_key, n_hash_config}, uint32());
+  auto n_hash = TreeExprBuilder::MakeFunction("standalone", {n_hash_kernel}, uint32());
+  auto hashRelation_expr = TreeExprBuilder::MakeExpression(n_hash, f_res);
+  std::shared_ptr<CodeGenerator> expr_build;
+  ASSERT_NOT_OK(
+      CreateCodeGenerator(schema_table_0, {hashRelation_expr}, {}, &expr_build, true));
+  std::shared_ptr<CodeGenerator> expr_probe;
+  ASSERT_NOT_OK(CreateCodeGenerator(
+      schema_table_1, {probeArrays_expr},
+      {table0_f0, table0_f1, table0_f2, table1_f0, table1_f1}, &expr_probe, true));
+  ///////////////////// Calculation //////////////////
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> table_0;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> table_1;
+
+  std::vector<std::string> input_data_string = {
+      R"(["l", "c", "a", "b"])", R"(["L", "C", "A", "B"])", "[10, 3, null, 2]"};
+  MakeInputBatch(input_data_string, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+
+  input_data_string = {R"(["f", "n", "e", "j"])", R"(["F", "N", "E", "J"])",
+                       "[6, 12, 5, 8]"};
+  MakeInputBatch(input_data_string, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+
+  std::vector<std::string> input_data_2_string = {R"(["a", "b", "c", "d", "e", "f"])",
+                                                  R"(["A", "B", "C", "D", "F", "F"])"};
+  MakeInputBatch(input_data_2_string, schema_table_1, &input_batch);
+  table_1.push_back(input_batch);
+
+  input_data_2_string = {R"(["i", "j", "k", "l", "m", "n"])",
+                         R"(["I", "J", "K", "L", "M", "N"])"};
+  MakeInputBatch(input_data_2_string, schema_table_1, &input_batch);
+  table_1.push_back(input_batch);
+
+  //////////////////////// data prepared /////////////////////////
+
+  std::vector<std::shared_ptr<RecordBatch>> expected_table;
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  std::vector<std::string> expected_result_string = {
+      R"(["a", "b", "c", "f"])", R"(["A", "B", "C", "F"])", "[null, 2, 3, 6]",
+      R"(["a", "b", "c", "f"])", R"(["A", "B", "C", "F"])"};
+  MakeInputBatch(expected_result_string, schema_table, &expected_result);
+  expected_table.push_back(expected_result);
+
+  expected_result_string = {R"(["j", "l", "n"])", R"(["J", "L", "N"])", "[8, 10, 12]",
+                            R"(["j", "l", "n"])", R"(["J", "L", "N"])"};
+  MakeInputBatch(expected_result_string, schema_table, &expected_result);
+  expected_table.push_back(expected_result);
+
+  ////////////////////// evaluate //////////////////////
+  for (auto batch : table_0) {
+    ASSERT_NOT_OK(expr_build->evaluate(batch, &dummy_result_batches));
+  }
+  std::shared_ptr<ResultIteratorBase> build_result_iterator;
+  std::shared_ptr<ResultIteratorBase> probe_result_iterator_base;
+  ASSERT_NOT_OK(expr_build->finish(&build_result_iterator));
+  ASSERT_NOT_OK(expr_probe->finish(&probe_result_iterator_base));
+
+  auto probe_result_iterator =
+      std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+          probe_result_iterator_base);
+  probe_result_iterator->SetDependencies({build_result_iterator});
+
+  for (int i = 0; i < 2; i++) {
+    auto right_batch = table_1[i];
+
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    std::vector<std::shared_ptr<arrow::Array>> input;
+    for (int i = 0; i < right_batch->num_columns(); i++) {
+      input.push_back(right_batch->column(i));
+    }
+
+    ASSERT_NOT_OK(probe_result_iterator->Process(input, &result_batch));
+    ASSERT_NOT_OK(Equals(*(expected_table[i]).get(), *result_batch.get()));
+  }
+  unsetenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT");
+}
+
+TEST(TestArrowComputeWSCG, HashRelationPayloadRows) {
+  auto schema = arrow::schema({field("f0", utf8()), field("f1", arrow::int8()),
+                               field("f2", int64()), field("f3", boolean()),
+                               field("f4", arrow::float64()), field("f5", utf8()),
+                               field("f6", arrow::date32())});
+  std::vector<std::shared_ptr<arrow::DataType>> types;
+  for (auto f : schema->fields()) {
+    types.push_back(f->type());
+  }
+  auto rows = std::make_shared<HashRelationPayloadRows>(arrow::default_memory_pool(),
+                                                       types);
+  // null bitmap, then int64, double, date32, int8, bool, then the two string slots
+  ASSERT_EQ(rows->field_offset(2), 8);
+  ASSERT_EQ(rows->field_offset(4), 16);
+  ASSERT_EQ(rows->field_offset(6), 24);
+  ASSERT_EQ(rows->field_offset(1), 28);
+  ASSERT_EQ(rows->field_offset(3), 29);
+  ASSERT_EQ(rows->field_offset(0), 32);
+  ASSERT_EQ(rows->field_offset(5), 40);
+  ASSERT_EQ(rows->row_size(), 48);
+
+  std::vector<std::string> input_data_string = {
+      R"(["a", null, "ccc", ""])", "[1, -2, null, 4]", "[10, null, 30, 40]",
+      "[true, false, null, true]", "[0.5, 1.5, 2.5, null]",
+      R"([null, "a longer string", "x", "yy"])", "[100, 200, 300, null]"};
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch(input_data_string, schema, &input_batch);
+  for (int batch = 0; batch < 2; batch++) {
+    ASSERT_NOT_OK(rows->AppendBatch(input_batch->columns()));
+  }
+
+  TypedHashRelationRowColumn<arrow::StringType> f0(rows, 0);
+  TypedHashRelationRowColumn<arrow::Int8Type> f1(rows, 1);
+  TypedHashRelationRowColumn<arrow::Int64Type> f2(rows, 2);
+  TypedHashRelationRowColumn<arrow::BooleanType> f3(rows, 3);
+  TypedHashRelationRowColumn<arrow::DoubleType> f4(rows, 4);
+  TypedHashRelationRowColumn<arrow::StringType> f5(rows, 5);
+  TypedHashRelationRowColumn<arrow::Date32Type> f6(rows, 6);
+  auto c0 = std::static_pointer_cast<arrow::StringArray>(input_batch->column(0));
+  auto c1 = std::static_pointer_cast<arrow::Int8Array>(input_batch->column(1));
+  auto c2 = std::static_pointer_cast<arrow::Int64Array>(input_batch->column(2));
+  auto c3 = std::static_pointer_cast<arrow::BooleanArray>(input_batch->column(3));
+  auto c4 = std::static_pointer_cast<arrow::DoubleArray>(input_batch->column(4));
+  auto c5 = std::static_pointer_cast<arrow::StringArray>(input_batch->column(5));
+  auto c6 = std::static_pointer_cast<arrow::Date32Array>(input_batch->column(6));
+  for (int batch = 0; batch < 2; batch++) {
+    for (int i = 0; i < input_batch->num_rows(); i++) {
+      ASSERT_EQ(f0.IsNull(batch, i), c0->IsNull(i));
+      ASSERT_EQ(f1.IsNull(batch, i), c1->IsNull(i));
+      ASSERT_EQ(f2.IsNull(batch, i), c2->IsNull(i));
+      ASSERT_EQ(f3.IsNull(batch, i), c3->IsNull(i));
+      ASSERT_EQ(f4.IsNull(batch, i), c4->IsNull(i));
+      ASSERT_EQ(f5.IsNull(batch, i), c5->IsNull(i));
+      ASSERT_EQ(f6.IsNull(batch, i), c6->IsNull(i));
+      if (c0->IsValid(i)) ASSERT_EQ(f0.GetValue(batch, i), c0->GetString(i));
+      if (c1->IsValid(i)) ASSERT_EQ(f1.GetValue(batch, i), c1->Value(i));
+      if (c2->IsValid(i)) ASSERT_EQ(f2.GetValue(batch, i), c2->Value(i));
+      if (c3->IsValid(i)) ASSERT_EQ(f3.GetValue(batch, i), c3->Value(i));
+      if (c4->IsValid(i)) ASSERT_EQ(f4.GetValue(batch, i), c4->Value(i));
+      if (c5->IsValid(i)) ASSERT_EQ(f5.GetValue(batch, i), c5->GetString(i));
+      if (c6->IsValid(i)) ASSERT_EQ(f6.GetValue(batch, i), c6->Value(i));
+    }
+  }
+}
+
+TEST(TestArrowComputeWSCG, HashRelationPayloadRowLayout) {
+  auto schema = arrow::schema({field("f0", utf8()), field("f1", arrow::int32()),
+                               field("f2", arrow::boolean())});
+  std::vector<std::shared_ptr<arrow::DataType>> types;
+  std::vector<std::shared_ptr<HashRelationColumn>> columns;
+  for (auto f : schema->fields()) {
+    types.push_back(f->type());
+    std::shared_ptr<HashRelationColumn> column;
+    ASSERT_NOT_OK(MakeHashRelationColumn(f->type()->id(), &column));
+    columns.push_back(column);
+  }
+  auto hash_relation = std::make_shared<HashRelation>(columns);
+  hash_relation->EnablePayloadRows(arrow::default_memory_pool(), types);
+  ASSERT_TRUE(hash_relation->HasPayloadRows());
+  std::vector<std::string> input_data_string = {R"(["a", null, "ccc", ""])",
+                                                "[1, -2, null, 4]",
+                                                "[true, false, null, true]"};
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch(input_data_string, schema, &input_batch);
+  ASSERT_NOT_OK(hash_relation->AppendPayload(input_batch->columns()));
+
+  // the payload is only kept in rows, consumers of columns get it unpacked
+  std::shared_ptr<TypedHashRelationColumn<arrow::Int32Type>> column;
+  ASSERT_FALSE(hash_relation->GetColumn(1, &column).ok());
+  for (int f = 0; f < types.size(); f++) {
+    arrow::ArrayVector arrays;
+    ASSERT_NOT_OK(hash_relation->GetArrayVector(f, &arrays));
+    ASSERT_EQ(arrays.size(), 1);
+    ASSERT_TRUE(arrays[0]->Equals(input_batch->column(f)));
+  }
+  std::shared_ptr<TypedHashRelationPayload<arrow::StringType>> f0;
+  ASSERT_NOT_OK(hash_relation->GetPayloadColumn(0, &f0));
+  ASSERT_TRUE(f0->IsNull(0, 1));
+  ASSERT_EQ(f0->GetValue(0, 2), "ccc");
+
+  auto column_relation = std::make_shared<HashRelation>(columns);
+  ASSERT_FALSE(column_relation->HasPayloadRows());
+  ASSERT_NOT_OK(column_relation->AppendPayload(input_batch->columns()));
+  std::shared_ptr<TypedHashRelationPayload<arrow::Int32Type>> f1;
+  ASSERT_NOT_OK(column_relation->GetPayloadColumn(1, &f1));
+  ASSERT_TRUE(f1->IsNull(0, 2));
+  ASSERT_EQ(f1->GetValue(0, 1), -2);
+}
+
+TEST(TestArrowComputeWSCG, HashRelationPayloadLayoutChoice) {
+  std::vector<std::shared_ptr<arrow::DataType>> narrow = {int64(), utf8()};
+  std::vector<std::shared_ptr<arrow::DataType>> wide(20, int64());
+  std::vector<std::shared_ptr<arrow::DataType>> unsupported(20, arrow::decimal(10, 2));
+  ASSERT_FALSE(HashRelationPayloadRows::Preferred(narrow));
+  ASSERT_TRUE(HashRelationPayloadRows::Preferred(wide));
+  ASSERT_FALSE(HashRelationPayloadRows::Preferred(unsupported));
+  setenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT", "column", 1);
+  ASSERT_FALSE(HashRelationPayloadRows::Preferred(wide));
+  setenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT", "row", 1);
+  ASSERT_TRUE(HashRelationPayloadRows::Preferred(narrow));
+  unsetenv("NATIVESQL_HASH_RELATION_PAYLOAD_LAYOUT");
+}
+
 }  // namespace codegen
 }  // namespace sparkcolumnarplugin
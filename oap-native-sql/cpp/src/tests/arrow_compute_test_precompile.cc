@@ -15,11 +15,19 @@
  * limitations under the License.
  */
 
+#include <arrow/memory_pool.h>
 #include <arrow/record_batch.h>
 #include <arrow/type.h>
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <set>
+#include <stdexcept>
+
 #include "precompile/array.h"
+#include "precompile/in_set.h"
+#include "precompile/string_kernels.h"
+#include "precompile/string_predicates.h"
 #include "tests/test_utils.h"
 
 namespace sparkcolumnarplugin {
@@ -41,5 +49,208 @@ TEST(TestArrowCompute, BooleanArrayTest) {
     }
   }
 }
+
+TEST(TestArrowCompute, StringKernelsTest) {
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  auto sch = arrow::schema({field("ascii_col", arrow::utf8()),
+                            field("utf8_col", arrow::utf8())});
+  std::vector<std::string> input_data = {
+      R"(["Spark SQL", null, "", "abcdefghijklmnopqrstuvwxyz0123456789ABC"])",
+      R"(["Café", "привет", null, "αβγ 中文 x"])"};
+  MakeInputBatch(input_data, sch, &input_batch);
+
+  std::shared_ptr<arrow::RecordBatch> expected_batch;
+  auto expected_sch = arrow::schema(
+      {field("upper", arrow::utf8()), field("lower", arrow::utf8()),
+       field("substr", arrow::utf8()), field("upper_utf8", arrow::utf8()),
+       field("substr_utf8", arrow::utf8())});
+  std::vector<std::string> expected_data = {
+      R"(["SPARK SQL", null, "", "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789ABC"])",
+      R"(["spark sql", null, "", "abcdefghijklmnopqrstuvwxyz0123456789abc"])",
+      R"(["SQ", null, "", "AB"])", R"(["CAFÉ", "ПРИВЕТ", null, "ΑΒΓ 中文 X"])",
+      R"(["fé", "ет", null, " x"])"};
+  MakeInputBatch(expected_data, expected_sch, &expected_batch);
+
+  auto ascii_col = input_batch->column(0);
+  auto utf8_col = input_batch->column(1);
+  std::shared_ptr<arrow::Array> result;
+  ASSERT_NOT_OK(precompile::UpperStringArray(arrow::default_memory_pool(), ascii_col,
+                                             &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(0)));
+  ASSERT_NOT_OK(precompile::LowerStringArray(arrow::default_memory_pool(), ascii_col,
+                                             &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(1)));
+  ASSERT_NOT_OK(precompile::SubstrStringArray(arrow::default_memory_pool(), ascii_col,
+                                              -3, 2, &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(2)));
+  ASSERT_NOT_OK(precompile::UpperStringArray(arrow::default_memory_pool(), utf8_col,
+                                             &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(3)));
+  ASSERT_NOT_OK(precompile::SubstrStringArray(arrow::default_memory_pool(), utf8_col,
+                                              -2, 5, &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(4)));
+
+  // sliced input keeps its offset
+  ASSERT_NOT_OK(precompile::UpperStringArray(arrow::default_memory_pool(),
+                                             utf8_col->Slice(1), &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(3)->Slice(1)));
+  ASSERT_NOT_OK(precompile::SubstrStringArray(arrow::default_memory_pool(),
+                                              utf8_col->Slice(1), -2, 5, &result));
+  ASSERT_TRUE(result->Equals(expected_batch->column(4)->Slice(1)));
+
+  // a non-ASCII batch is mapped as Java does, lengths may change
+  std::shared_ptr<arrow::RecordBatch> mixed_batch;
+  MakeInputBatch({R"(["Straße", null, "ΟΔΟΣ", "ﬁ İ"])"},
+                 arrow::schema({field("mixed", arrow::utf8())}), &mixed_batch);
+  std::shared_ptr<arrow::RecordBatch> mixed_expected;
+  MakeInputBatch({R"(["STRASSE", null, "ΟΔΟΣ", "FI İ"])",
+                  R"(["straße", null, "οδος", "ﬁ i̇"])"},
+                 arrow::schema({field("upper", arrow::utf8()),
+                                field("lower", arrow::utf8())}),
+                 &mixed_expected);
+  ASSERT_NOT_OK(precompile::UpperStringArray(arrow::default_memory_pool(),
+                                             mixed_batch->column(0), &result));
+  ASSERT_TRUE(result->Equals(mixed_expected->column(0)));
+  ASSERT_NOT_OK(precompile::LowerStringArray(arrow::default_memory_pool(),
+                                             mixed_batch->column(0), &result));
+  ASSERT_TRUE(result->Equals(mixed_expected->column(1)));
+
+  ASSERT_EQ(precompile::Utf8Lower("ÀÉ Straße"), "àé straße");
+  ASSERT_EQ(precompile::Utf8Upper("ÀÉ Straße"), "ÀÉ STRASSE");
+  ASSERT_EQ(precompile::Utf8Substr("Spark SQL", 0, 3), "Spa");
+  ASSERT_EQ(precompile::Utf8Substr("Spark SQL", 5, 1), "k");
+  ASSERT_EQ(precompile::Utf8Substr("Spark SQL", 2, -1), "");
+}
+
+TEST(TestArrowCompute, StringMatcherTest) {
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  auto sch = arrow::schema({field("str", arrow::utf8())});
+  // "ab" + "cd" straddles two rows and must not match "bc"
+  std::vector<std::string> input_data = {
+      R"(["xab", "cdx", null, "abcd", "", "zzbc", "bcbc", "a%b", "aéc"])"};
+  MakeInputBatch(input_data, sch, &input_batch);
+  auto in = input_batch->column(0);
+
+  auto check = [&in](std::shared_ptr<precompile::StringMatcher> matcher,
+                     std::vector<bool> expected) {
+    std::shared_ptr<arrow::Buffer> selection;
+    ASSERT_NOT_OK(matcher->MatchArray(arrow::default_memory_pool(), in, &selection));
+    auto typed_in = std::dynamic_pointer_cast<arrow::StringArray>(in);
+    for (int i = 0; i < in->length(); i++) {
+      ASSERT_EQ(precompile::GetSelection(selection->data(), i), expected[i]);
+      if (!in->IsNull(i)) {
+        ASSERT_EQ(matcher->Match(typed_in->GetView(i)), expected[i]);
+      }
+    }
+  };
+  auto like_substr = precompile::StringMatcher::MakeLike("%bc%");
+  ASSERT_EQ(like_substr->kind(), precompile::StringMatcher::SUBSTRING);
+  check(like_substr, {false, false, false, true, false, true, true, false, false});
+  check(precompile::StringMatcher::MakeContains("bc"),
+        {false, false, false, true, false, true, true, false, false});
+  check(precompile::StringMatcher::MakeStartsWith("ab"),
+        {false, false, false, true, false, false, false, false, false});
+  check(precompile::StringMatcher::MakeEndsWith("bc"),
+        {false, false, false, false, false, true, true, false, false});
+  check(precompile::StringMatcher::MakeLike("a\\%b"),
+        {false, false, false, false, false, false, false, true, false});
+  auto like_wildcard = precompile::StringMatcher::MakeLike("a_c%");
+  ASSERT_EQ(like_wildcard->kind(), precompile::StringMatcher::WILDCARD);
+  check(like_wildcard, {false, false, false, true, false, false, false, false, true});
+  check(precompile::StringMatcher::MakeRegex("^(bc)+$"),
+        {false, false, false, false, false, false, true, false, false});
+  ASSERT_EQ(precompile::StringMatcher::GetOrMake("rlike", "^(bc)+$"),
+            precompile::StringMatcher::GetOrMake("rlike", "^(bc)+$"));
+  // java.util.regex syntax
+  check(precompile::StringMatcher::MakeRegex("^\\p{Alpha}\\Qb\\E"),
+        {false, false, false, true, false, false, false, false, false});
+  check(precompile::StringMatcher::MakeRegex("^[\\p{Lower}%]{3}\\Z"),
+        {true, true, false, false, false, false, false, true, false});
+
+  precompile::StringMatcherMemo memo("like");
+  ASSERT_TRUE(memo.Get("a%").Match("abc"));
+  ASSERT_EQ(&memo.Get("a%"), &memo.Get("a%"));
+  ASSERT_FALSE(memo.Get("b%").Match("abc"));
+}
+
+TEST(TestArrowCompute, StringMatcherValidateTest) {
+  using precompile::StringMatcher;
+  ASSERT_TRUE(StringMatcher::Validate("like", "a\\%b\\_c\\\\%").ok());
+  // Spark rejects a trailing escape and escaping anything else
+  ASSERT_TRUE(StringMatcher::Validate("like", "abc\\").IsInvalid());
+  ASSERT_TRUE(StringMatcher::Validate("like", "a\\bc").IsInvalid());
+  ASSERT_THROW(StringMatcher::MakeLike("abc\\"), std::runtime_error);
+
+  ASSERT_TRUE(StringMatcher::Validate("rlike", "^(bc)+$").ok());
+  ASSERT_TRUE(StringMatcher::Validate("rlike", "plain").ok());
+  // a regex RE2 can't run is reported when the code is generated, not thrown by the
+  // jitted kernel
+  ASSERT_TRUE(StringMatcher::Validate("rlike", "(a)\\1").IsNotImplemented());
+  ASSERT_TRUE(StringMatcher::Validate("rlike", "a(?=b)").IsNotImplemented());
+  ASSERT_TRUE(StringMatcher::Validate("rlike", "a(b").IsInvalid());
+  ASSERT_TRUE(StringMatcher::Validate("starts_with", "a\\").ok());
+}
+
+TEST(TestArrowCompute, TranslateJavaRegexTest) {
+  auto translate = [](const std::string& pattern) {
+    std::string out;
+    auto status = precompile::TranslateJavaRegex(pattern, &out);
+    return status.ok() ? out : status.CodeAsString();
+  };
+  ASSERT_EQ(translate("[\\p{Digit}x]+"), "[[:digit:]x]+");
+  ASSERT_EQ(translate("\\P{Alpha}"), "[[:^alpha:]]");
+  ASSERT_EQ(translate("a$"), "a(?:\\n?\\z)");
+  ASSERT_EQ(translate("(?m)a$"), "(?m)a$");
+  ASSERT_EQ(translate("\\Qa.b\\E"), "a\\.b");
+  ASSERT_EQ(translate("(?<year>\\d{4})"), "(?P<year>\\d{4})");
+  ASSERT_EQ(translate("(?u)\\u00e9"), "\\x{00e9}");
+  // no RE2 equivalent
+  for (auto pattern : {"(a)\\1", "a(?=b)", "(?<!a)b", "(?>a)", "a*+", "[a-z&&[^b]]"}) {
+    ASSERT_EQ(translate(pattern), "NotImplemented") << pattern;
+  }
+}
+
+TEST(TestArrowCompute, InSetTest) {
+  // dense, short and long lists take the bitmap, sorted and hash paths
+  std::vector<std::vector<int64_t>> lists = {
+      {3, 4, 5, 7}, {-100, 5, 1000000, 42}, {}, {std::numeric_limits<int64_t>::min(), 0}};
+  std::vector<int64_t> long_list;
+  for (int64_t i = 0; i < 200; i++) {
+    long_list.push_back(i * 1000003 - 77);
+  }
+  lists.push_back(long_list);
+  for (auto& list : lists) {
+    precompile::IntegerInSet<int64_t> in_set(list);
+    std::set<int64_t> expected(list.begin(), list.end());
+    for (auto v : list) {
+      ASSERT_TRUE(in_set.Contains(v));
+      ASSERT_EQ(in_set.Contains(v + 1), expected.count(v + 1) > 0);
+      ASSERT_EQ(in_set.Contains(v - 1), expected.count(v - 1) > 0);
+    }
+    ASSERT_EQ(in_set.Contains(std::numeric_limits<int64_t>::max()),
+              expected.count(std::numeric_limits<int64_t>::max()) > 0);
+  }
+  precompile::IntegerInSet<int32_t> int_set(
+      {std::numeric_limits<int32_t>::min(), 1, std::numeric_limits<int32_t>::max()});
+  ASSERT_TRUE(int_set.Contains(std::numeric_limits<int32_t>::min()));
+  ASSERT_TRUE(int_set.Contains(std::numeric_limits<int32_t>::max()));
+  ASSERT_FALSE(int_set.Contains(0));
+
+  std::vector<std::string> strings = {"", "a", std::string("a\0b", 3)};
+  precompile::StringInSet short_set(strings);
+  for (int i = 0; i < 20; i++) {
+    strings.push_back("str_" + std::to_string(i));
+  }
+  precompile::StringInSet long_set(strings);
+  for (auto& str : strings) {
+    ASSERT_TRUE(long_set.Contains(str));
+  }
+  ASSERT_TRUE(short_set.Contains(""));
+  ASSERT_TRUE(short_set.Contains(std::string("a\0b", 3)));
+  ASSERT_FALSE(short_set.Contains("ab"));
+  ASSERT_FALSE(short_set.Contains("str_1"));
+  ASSERT_FALSE(long_set.Contains("str_20"));
+  ASSERT_FALSE(long_set.Contains("b"));
+}
 }  // namespace codegen
 }  // namespace sparkcolumnarplugin
\ No newline at end of file
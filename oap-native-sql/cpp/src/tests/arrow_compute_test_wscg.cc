@@ -21,10 +21,12 @@
 #include <gandiva/tree_expr_builder.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <memory>
 
 #include "codegen/code_generator.h"
 #include "codegen/code_generator_factory.h"
+#include "codegen/common/limit_result_iterator.h"
 #include "tests/test_utils.h"
 
 using arrow::boolean;
@@ -1635,5 +1637,392 @@ TEST(TestArrowComputeWSCG, WSCGTestSemiJoinWithCoalesce) {
   }
 }
 
+TEST(TestArrowComputeWSCG, WSCGTestNullFreeAndNullableBatch) {
+  auto table0_f0 = field("table0_f0", arrow::int32());
+  auto table0_f1 = field("table0_f1", arrow::int32());
+  auto f_sum = field("sum", arrow::int32());
+  auto f_res = field("res", uint32());
+
+  gandiva::NodeVector field_node_list = {TreeExprBuilder::MakeField(table0_f0),
+                                         TreeExprBuilder::MakeField(table0_f1)};
+  auto n_filter_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_filter_func = TreeExprBuilder::MakeFunction(
+      "greater_than_or_equal_to",
+      {TreeExprBuilder::MakeField(table0_f1), TreeExprBuilder::MakeLiteral((int)10)},
+      boolean());
+  auto n_filter =
+      TreeExprBuilder::MakeFunction("filter", {n_filter_input, n_filter_func}, uint32());
+  auto n_child_filter = TreeExprBuilder::MakeFunction("child", {n_filter}, uint32());
+  auto n_project_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_add = TreeExprBuilder::MakeFunction(
+      "add",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1)},
+      arrow::int32());
+  auto n_project_func = TreeExprBuilder::MakeFunction(
+      "codegen_project", {TreeExprBuilder::MakeField(table0_f0), n_add}, uint32());
+  auto n_project = TreeExprBuilder::MakeFunction(
+      "project", {n_project_input, n_project_func}, uint32());
+  auto n_child =
+      TreeExprBuilder::MakeFunction("child", {n_project, n_child_filter}, uint32());
+  auto n_wscg = TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, uint32());
+  auto wscg_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1});
+  std::shared_ptr<CodeGenerator> expr_wscg;
+  ASSERT_NOT_OK(CreateCodeGenerator(schema_table_0, {wscg_expr}, {table0_f0, f_sum},
+                                    &expr_wscg, true));
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr_wscg->finish(&result_iterator_base));
+  auto result_iterator = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+      result_iterator_base);
+  ASSERT_NOT_OK(result_iterator->SetDependencies({}));
+
+  // the first batch takes the nullable loop, the second one the null free loop
+  std::vector<std::shared_ptr<arrow::RecordBatch>> table_0;
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch({"[1, null, 3, 4]", "[10, 20, 30, 5]"}, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+  MakeInputBatch({"[5, 6, 7]", "[1, 10, 100]"}, schema_table_0, &input_batch);
+  table_0.push_back(input_batch);
+
+  std::vector<std::shared_ptr<RecordBatch>> expected_table;
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  auto res_sch = arrow::schema({table0_f0, f_sum});
+  MakeInputBatch({"[1, null, 3]", "[11, null, 33]"}, res_sch, &expected_result);
+  expected_table.push_back(expected_result);
+  MakeInputBatch({"[6, 7]", "[16, 107]"}, res_sch, &expected_result);
+  expected_table.push_back(expected_result);
+
+  for (int i = 0; i < 2; i++) {
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    ASSERT_NOT_OK(result_iterator->Process(table_0[i]->columns(), &result_batch));
+    ASSERT_NOT_OK(Equals(*(expected_table[i]).get(), *result_batch.get()));
+  }
+}
+
+TEST(TestArrowComputeWSCG, WSCGTestMorselInnerJoin) {
+  auto table0_f0 = field("table0_f0", uint32());
+  auto table0_f1 = field("table0_f1", uint32());
+  auto table1_f0 = field("table1_f0", uint32());
+  auto table1_f1 = field("table1_f1", uint32());
+  auto f_res = field("res", uint32());
+
+  auto n_left = TreeExprBuilder::MakeFunction(
+      "codegen_left_schema",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1)},
+      uint32());
+  auto n_right = TreeExprBuilder::MakeFunction(
+      "codegen_right_schema",
+      {TreeExprBuilder::MakeField(table1_f0), TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_left_key = TreeExprBuilder::MakeFunction(
+      "codegen_left_key_schema", {TreeExprBuilder::MakeField(table0_f0)}, uint32());
+  auto n_right_key = TreeExprBuilder::MakeFunction(
+      "codegen_right_key_schema", {TreeExprBuilder::MakeField(table1_f0)}, uint32());
+  auto n_result = TreeExprBuilder::MakeFunction(
+      "result",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeField(table1_f1)},
+      uint32());
+  auto n_hash_config = TreeExprBuilder::MakeFunction(
+      "build_keys_config_node", {TreeExprBuilder::MakeLiteral((int)1)}, uint32());
+  auto n_probeArrays = TreeExprBuilder::MakeFunction(
+      "conditionedProbeArraysInner",
+      {n_left, n_right, n_left_key, n_right_key, n_result, n_hash_config}, uint32());
+  auto n_child = TreeExprBuilder::MakeFunction("child", {n_probeArrays}, uint32());
+  auto n_wscg = TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, uint32());
+  auto probeArrays_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1});
+  auto schema_table_1 = arrow::schema({table1_f0, table1_f1});
+  auto n_hash_kernel = TreeExprBuilder::MakeFunction(
+      "HashRelation", {n_left_key, n_hash_config}, uint32());
+  auto n_hash = TreeExprBuilder::MakeFunction("standalone", {n_hash_kernel}, uint32());
+  auto hashRelation_expr = TreeExprBuilder::MakeExpression(n_hash, f_res);
+  std::shared_ptr<CodeGenerator> expr_build;
+  ASSERT_NOT_OK(
+      CreateCodeGenerator(schema_table_0, {hashRelation_expr}, {}, &expr_build, true));
+
+  // keys 1 and 3 have two build rows, so the matched item lists are read per thread
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> dummy_result_batches;
+  MakeInputBatch({"[1, 3, 5, 1, 3, 7]", "[10, 30, 50, 11, 31, 70]"}, schema_table_0,
+                 &input_batch);
+  ASSERT_NOT_OK(expr_build->evaluate(input_batch, &dummy_result_batches));
+  std::shared_ptr<ResultIteratorBase> build_result_iterator;
+  ASSERT_NOT_OK(expr_build->finish(&build_result_iterator));
+
+  std::shared_ptr<arrow::RecordBatch> probe_batch;
+  MakeInputBatch({"[1, 2, 3, 4, 5, 6, 7, 1, 3, 5, 9]",
+                  "[100, 200, 300, 400, 500, 600, 700, 101, 301, 501, 901]"},
+                 schema_table_1, &probe_batch);
+
+  // the same pipeline on a single thread, and on morsels of 2 rows over 3 threads
+  std::vector<std::shared_ptr<arrow::RecordBatch>> result_batches;
+  for (auto threads : {"1", "3"}) {
+    setenv("NATIVESQL_WSCG_THREADS", threads, 1);
+    setenv("NATIVESQL_WSCG_MORSEL_ROWS", "2", 1);
+    std::shared_ptr<CodeGenerator> expr_probe;
+    ASSERT_NOT_OK(CreateCodeGenerator(schema_table_1, {probeArrays_expr},
+                                      {table0_f0, table0_f1, table1_f1}, &expr_probe,
+                                      true));
+    std::shared_ptr<ResultIteratorBase> probe_result_iterator_base;
+    ASSERT_NOT_OK(expr_probe->finish(&probe_result_iterator_base));
+    unsetenv("NATIVESQL_WSCG_THREADS");
+    unsetenv("NATIVESQL_WSCG_MORSEL_ROWS");
+    auto probe_result_iterator =
+        std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+            probe_result_iterator_base);
+    ASSERT_NOT_OK(probe_result_iterator->SetDependencies({build_result_iterator}));
+    std::shared_ptr<arrow::RecordBatch> result_batch;
+    ASSERT_NOT_OK(probe_result_iterator->Process(probe_batch->columns(), &result_batch));
+    result_batches.push_back(result_batch);
+  }
+
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  auto res_sch = arrow::schema({table0_f0, table0_f1, table1_f1});
+  MakeInputBatch({"[1, 1, 3, 3, 5, 7, 1, 1, 3, 3, 5]",
+                  "[10, 11, 30, 31, 50, 70, 10, 11, 30, 31, 50]",
+                  "[100, 100, 300, 300, 500, 700, 101, 101, 301, 301, 501]"},
+                 res_sch, &expected_result);
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batches[0].get()));
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batches[1].get()));
+}
+
+TEST(TestArrowComputeWSCG, WSCGTestProjectCaseWhen) {
+  auto table0_f0 = field("table0_f0", arrow::int32());
+  auto table0_f1 = field("table0_f1", arrow::int32());
+  auto f_case = field("case", arrow::int32());
+  auto f_if = field("if", arrow::int32());
+  auto f_res = field("res", uint32());
+
+  gandiva::NodeVector field_node_list = {TreeExprBuilder::MakeField(table0_f0),
+                                         TreeExprBuilder::MakeField(table0_f1)};
+  auto n_filter_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_filter_func = TreeExprBuilder::MakeFunction(
+      "greater_than_or_equal_to",
+      {TreeExprBuilder::MakeField(table0_f1), TreeExprBuilder::MakeLiteral((int)0)},
+      boolean());
+  auto n_filter =
+      TreeExprBuilder::MakeFunction("filter", {n_filter_input, n_filter_func}, uint32());
+  auto n_child_filter = TreeExprBuilder::MakeFunction("child", {n_filter}, uint32());
+
+  // CASE table0_f0 WHEN 1 THEN 100 WHEN 2 THEN 200 WHEN 4 THEN 400 WHEN 1 THEN 999
+  // WHEN 5 THEN null ELSE -1 END, compiled to a lookup table
+  std::vector<std::pair<int, gandiva::NodePtr>> arms = {
+      {1, TreeExprBuilder::MakeLiteral((int)100)},
+      {2, TreeExprBuilder::MakeLiteral((int)200)},
+      {4, TreeExprBuilder::MakeLiteral((int)400)},
+      {1, TreeExprBuilder::MakeLiteral((int)999)},
+      {5, TreeExprBuilder::MakeNull(arrow::int32())}};
+  gandiva::NodePtr n_case = TreeExprBuilder::MakeLiteral((int)-1);
+  for (auto it = arms.rbegin(); it != arms.rend(); it++) {
+    auto n_equal = TreeExprBuilder::MakeFunction(
+        "equal",
+        {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeLiteral(it->first)},
+        boolean());
+    n_case = TreeExprBuilder::MakeIf(n_equal, it->second, n_case, arrow::int32());
+  }
+  // table0_f0 is only read by the rows which take the then branch
+  auto n_isnotnull = TreeExprBuilder::MakeFunction(
+      "isnotnull", {TreeExprBuilder::MakeField(table0_f0)}, boolean());
+  auto n_add = TreeExprBuilder::MakeFunction(
+      "add",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1)},
+      arrow::int32());
+  auto n_if = TreeExprBuilder::MakeIf(
+      n_isnotnull, n_add, TreeExprBuilder::MakeField(table0_f1), arrow::int32());
+  auto n_project_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_project_func =
+      TreeExprBuilder::MakeFunction("codegen_project", {n_case, n_if}, uint32());
+  auto n_project = TreeExprBuilder::MakeFunction(
+      "project", {n_project_input, n_project_func}, uint32());
+  auto n_child =
+      TreeExprBuilder::MakeFunction("child", {n_project, n_child_filter}, uint32());
+  auto n_wscg = TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, uint32());
+  auto wscg_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1});
+  std::shared_ptr<CodeGenerator> expr_wscg;
+  ASSERT_NOT_OK(CreateCodeGenerator(schema_table_0, {wscg_expr}, {f_case, f_if},
+                                    &expr_wscg, true));
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr_wscg->finish(&result_iterator_base));
+  auto result_iterator = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+      result_iterator_base);
+  ASSERT_NOT_OK(result_iterator->SetDependencies({}));
+
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch({"[1, 2, 3, 4, 5, null, 1, 0]", "[10, 20, 30, 40, 50, 60, 70, 80]"},
+                 schema_table_0, &input_batch);
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  MakeInputBatch({"[100, 200, -1, 400, null, -1, 100, -1]",
+                  "[11, 22, 33, 44, 55, 60, 71, 80]"},
+                 arrow::schema({f_case, f_if}), &expected_result);
+
+  std::shared_ptr<arrow::RecordBatch> result_batch;
+  ASSERT_NOT_OK(result_iterator->Process(input_batch->columns(), &result_batch));
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+}
+
+TEST(TestArrowComputeWSCG, WSCGTestExpandFilter) {
+  auto table0_f0 = field("table0_f0", arrow::int32());
+  auto table0_f1 = field("table0_f1", arrow::int32());
+  auto expand_f0 = field("expand_f0", arrow::int32());
+  auto expand_f1 = field("expand_f1", arrow::int32());
+  auto expand_gid = field("spark_grouping_id", arrow::int32());
+  auto f_res = field("res", uint32());
+
+  // GROUP BY ROLLUP(table0_f0, table0_f1) without the grand total
+  gandiva::NodeVector field_node_list = {TreeExprBuilder::MakeField(table0_f0),
+                                         TreeExprBuilder::MakeField(table0_f1)};
+  auto n_expand_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_projection_0 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeLiteral((int)0)},
+      uint32());
+  auto n_projection_1 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeNull(arrow::int32()),
+       TreeExprBuilder::MakeLiteral((int)1)},
+      uint32());
+  auto n_projection_2 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeNull(arrow::int32()),
+       TreeExprBuilder::MakeNull(arrow::int32()), TreeExprBuilder::MakeLiteral((int)3)},
+      uint32());
+  auto n_expand = TreeExprBuilder::MakeFunction(
+      "expand", {n_expand_input, n_projection_0, n_projection_1, n_projection_2},
+      uint32());
+  auto n_child_expand = TreeExprBuilder::MakeFunction("child", {n_expand}, uint32());
+
+  gandiva::NodeVector expand_node_list = {TreeExprBuilder::MakeField(expand_f0),
+                                          TreeExprBuilder::MakeField(expand_f1),
+                                          TreeExprBuilder::MakeField(expand_gid)};
+  auto n_filter_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", expand_node_list, uint32());
+  auto n_filter_func = TreeExprBuilder::MakeFunction(
+      "less_than",
+      {TreeExprBuilder::MakeField(expand_gid), TreeExprBuilder::MakeLiteral((int)3)},
+      boolean());
+  auto n_filter =
+      TreeExprBuilder::MakeFunction("filter", {n_filter_input, n_filter_func}, uint32());
+  auto n_child =
+      TreeExprBuilder::MakeFunction("child", {n_filter, n_child_expand}, uint32());
+  auto n_wscg = TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, uint32());
+  auto wscg_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1});
+  std::shared_ptr<CodeGenerator> expr_wscg;
+  ASSERT_NOT_OK(CreateCodeGenerator(schema_table_0, {wscg_expr},
+                                    {expand_f0, expand_f1, expand_gid}, &expr_wscg,
+                                    true));
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr_wscg->finish(&result_iterator_base));
+  auto result_iterator = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+      result_iterator_base);
+  ASSERT_NOT_OK(result_iterator->SetDependencies({}));
+
+  // every input row comes out once per kept projection, in projection order
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch({"[1, 2, null]", "[10, null, 30]"}, schema_table_0, &input_batch);
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  MakeInputBatch({"[1, 1, 2, 2, null, null]", "[10, null, null, null, 30, null]",
+                  "[0, 1, 0, 1, 0, 1]"},
+                 arrow::schema({expand_f0, expand_f1, expand_gid}), &expected_result);
+
+  std::shared_ptr<arrow::RecordBatch> result_batch;
+  ASSERT_NOT_OK(result_iterator->Process(input_batch->columns(), &result_batch));
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+}
+
+
+TEST(TestArrowComputeWSCG, WSCGTestLimitExpandFilter) {
+  auto table0_f0 = field("table0_f0", arrow::int32());
+  auto table0_f1 = field("table0_f1", arrow::int32());
+  auto expand_f0 = field("expand_f0", arrow::int32());
+  auto expand_f1 = field("expand_f1", arrow::int32());
+  auto expand_gid = field("spark_grouping_id", arrow::int32());
+  auto f_res = field("res", uint32());
+
+  // GROUP BY ROLLUP(table0_f0, table0_f1) without the grand total
+  gandiva::NodeVector field_node_list = {TreeExprBuilder::MakeField(table0_f0),
+                                         TreeExprBuilder::MakeField(table0_f1)};
+  auto n_expand_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", field_node_list, uint32());
+  auto n_projection_0 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeField(table0_f1),
+       TreeExprBuilder::MakeLiteral((int)0)},
+      uint32());
+  auto n_projection_1 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeField(table0_f0), TreeExprBuilder::MakeNull(arrow::int32()),
+       TreeExprBuilder::MakeLiteral((int)1)},
+      uint32());
+  auto n_projection_2 = TreeExprBuilder::MakeFunction(
+      "codegen_project",
+      {TreeExprBuilder::MakeNull(arrow::int32()),
+       TreeExprBuilder::MakeNull(arrow::int32()), TreeExprBuilder::MakeLiteral((int)3)},
+      uint32());
+  auto n_expand = TreeExprBuilder::MakeFunction(
+      "expand", {n_expand_input, n_projection_0, n_projection_1, n_projection_2},
+      uint32());
+  auto n_child_expand = TreeExprBuilder::MakeFunction("child", {n_expand}, uint32());
+
+  gandiva::NodeVector expand_node_list = {TreeExprBuilder::MakeField(expand_f0),
+                                          TreeExprBuilder::MakeField(expand_f1),
+                                          TreeExprBuilder::MakeField(expand_gid)};
+  auto n_filter_input =
+      TreeExprBuilder::MakeFunction("codegen_input_schema", expand_node_list, uint32());
+  auto n_filter_func = TreeExprBuilder::MakeFunction(
+      "less_than",
+      {TreeExprBuilder::MakeField(expand_gid), TreeExprBuilder::MakeLiteral((int)3)},
+      boolean());
+  auto n_filter =
+      TreeExprBuilder::MakeFunction("filter", {n_filter_input, n_filter_func}, uint32());
+  auto n_child =
+      TreeExprBuilder::MakeFunction("child", {n_filter, n_child_expand}, uint32());
+  auto n_wscg = TreeExprBuilder::MakeFunction("wholestagecodegen", {n_child}, uint32());
+  auto wscg_expr = TreeExprBuilder::MakeExpression(n_wscg, f_res);
+
+  auto schema_table_0 = arrow::schema({table0_f0, table0_f1});
+  std::shared_ptr<CodeGenerator> expr_wscg;
+  ASSERT_NOT_OK(CreateCodeGenerator(schema_table_0, {wscg_expr},
+                                    {expand_f0, expand_f1, expand_gid}, &expr_wscg,
+                                    true));
+  std::shared_ptr<ResultIteratorBase> result_iterator_base;
+  ASSERT_NOT_OK(expr_wscg->finish(&result_iterator_base));
+  auto result_iterator = std::dynamic_pointer_cast<ResultIterator<arrow::RecordBatch>>(
+      result_iterator_base);
+  ASSERT_NOT_OK(result_iterator->SetDependencies({}));
+  std::shared_ptr<ResultIterator<arrow::RecordBatch>> limit_iterator;
+  ASSERT_NOT_OK(LimitResultIterator::Make(result_iterator, 3, &limit_iterator));
+
+  // the loop stops after the second input row, its second expanded row is cut
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch({"[1, 2, null]", "[10, null, 30]"}, schema_table_0, &input_batch);
+  std::shared_ptr<arrow::RecordBatch> expected_result;
+  MakeInputBatch({"[1, 1, 2]", "[10, null, null]", "[0, 1, 0]"},
+                 arrow::schema({expand_f0, expand_f1, expand_gid}), &expected_result);
+
+  std::shared_ptr<arrow::RecordBatch> result_batch;
+  ASSERT_NOT_OK(limit_iterator->Process(input_batch->columns(), &result_batch));
+  ASSERT_NOT_OK(Equals(*expected_result.get(), *result_batch.get()));
+  ASSERT_TRUE(result_iterator->BudgetExhausted());
+  ASSERT_TRUE(limit_iterator->BudgetExhausted());
+
+  // once the limit is met later batches come back empty
+  ASSERT_NOT_OK(limit_iterator->Process(input_batch->columns(), &result_batch));
+  ASSERT_EQ(result_batch->num_rows(), 0);
+  ASSERT_EQ(result_batch->num_columns(), 3);
+}
+
 }  // namespace codegen
 }  // namespace sparkcolumnarplugin
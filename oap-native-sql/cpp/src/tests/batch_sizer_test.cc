@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/batch_sizer.h"
+
+#include <arrow/builder.h>
+#include <arrow/record_batch.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+std::shared_ptr<arrow::RecordBatch> MakeStringBatch(int num_rows, int value_bytes) {
+  arrow::Int32Builder int_builder;
+  arrow::StringBuilder string_builder;
+  for (int i = 0; i < num_rows; i++) {
+    EXPECT_TRUE(int_builder.Append(i).ok());
+    EXPECT_TRUE(string_builder.Append(std::string(value_bytes, 'x')).ok());
+  }
+  std::shared_ptr<arrow::Array> int_array;
+  std::shared_ptr<arrow::Array> string_array;
+  EXPECT_TRUE(int_builder.Finish(&int_array).ok());
+  EXPECT_TRUE(string_builder.Finish(&string_array).ok());
+  auto schema = arrow::schema(
+      {arrow::field("i", arrow::int32()), arrow::field("s", arrow::utf8())});
+  return arrow::RecordBatch::Make(schema, num_rows, {int_array, string_array});
+}
+
+TEST(BatchSizerTest, TestFixedRows) {
+  BatchSizer sizer(4096, 0, 65536);
+  ASSERT_FALSE(sizer.adaptive());
+  sizer.Estimate(*arrow::schema({arrow::field("i", arrow::int32())}));
+  ASSERT_EQ(sizer.NextRows(), 4096);
+  sizer.Observe(*MakeStringBatch(10, 1000));
+  ASSERT_EQ(sizer.NextRows(), 4096);
+}
+
+TEST(BatchSizerTest, TestEstimateFromSchema) {
+  BatchSizer sizer(4096, 1024 * 1024, 65536);
+  // nothing known yet
+  ASSERT_EQ(sizer.NextRows(), 4096);
+  // 8 bytes per row would be 128K rows, capped
+  sizer.Estimate(*arrow::schema(
+      {arrow::field("a", arrow::int32()), arrow::field("b", arrow::int32())}));
+  ASSERT_EQ(sizer.row_bytes(), 8);
+  ASSERT_EQ(sizer.NextRows(), 65536);
+
+  BatchSizer string_sizer(4096, 1024 * 1024, 65536);
+  string_sizer.Estimate(*arrow::schema({arrow::field("s", arrow::utf8())}));
+  ASSERT_EQ(string_sizer.row_bytes(), 4 + BatchSizer::kDefaultValueBytes);
+  ASSERT_EQ(string_sizer.NextRows(), 1024 * 1024 / 36);
+
+  BatchSizer file_sizer(4096, 1024 * 1024, 65536);
+  file_sizer.Estimate(1024.0);
+  ASSERT_EQ(file_sizer.NextRows(), 1024);
+}
+
+TEST(BatchSizerTest, TestMaxRows) {
+  // narrow rows grow past the configured batch size up to the global cap
+  BatchSizer sizer(4096, 32 * 1024 * 1024, 65536);
+  sizer.Observe(*MakeStringBatch(100, 4));
+  ASSERT_EQ(sizer.NextRows(), 65536);
+  // wide ones are cut to the byte budget
+  sizer.Observe(*MakeStringBatch(10, 100000));
+  ASSERT_LT(sizer.NextRows(), 4096);
+  // the cap is never below the configured batch size
+  BatchSizer low_cap_sizer(4096, 32 * 1024 * 1024, 1024);
+  low_cap_sizer.Observe(*MakeStringBatch(100, 4));
+  ASSERT_EQ(low_cap_sizer.NextRows(), 4096);
+}
+
+TEST(BatchSizerTest, TestObserveWideRows) {
+  BatchSizer sizer(4096, 1024 * 1024, 65536);
+  sizer.Estimate(*MakeStringBatch(1, 1)->schema());
+  // 4 byte ints, 4 byte offsets and 1020 byte strings
+  sizer.Observe(*MakeStringBatch(100, 1020));
+  ASSERT_EQ(sizer.row_bytes(), 1028);
+  ASSERT_EQ(sizer.NextRows(), 1024 * 1024 / 1028);
+  ASSERT_EQ(sizer.ExpectedValueBytes(1, 10), 10200);
+  ASSERT_EQ(sizer.ExpectedValueBytes(0, 10), 0);
+  // the average moves a quarter of the way per batch
+  sizer.Observe(*MakeStringBatch(100, 4));
+  ASSERT_EQ(sizer.row_bytes(), 4 + 4 + (1020 * 3 + 4) / 4);
+  // a later estimate doesn't override what was observed
+  sizer.Estimate(1.0);
+  ASSERT_EQ(sizer.row_bytes(), 4 + 4 + (1020 * 3 + 4) / 4);
+  // empty batches carry no width
+  sizer.Observe(*MakeStringBatch(0, 0));
+  ASSERT_EQ(sizer.row_bytes(), 4 + 4 + (1020 * 3 + 4) / 4);
+}
+
+TEST(BatchSizerTest, TestMinRows) {
+  BatchSizer sizer(4096, 1024, 65536);
+  sizer.Observe(*MakeStringBatch(10, 100000));
+  ASSERT_EQ(sizer.NextRows(), BatchSizer::kMinRows);
+  // the cap wins over the minimum
+  BatchSizer capped_sizer(16, 1024, 16);
+  capped_sizer.Observe(*MakeStringBatch(10, 100000));
+  ASSERT_EQ(capped_sizer.NextRows(), 16);
+}
+
+TEST(BatchSizerTest, TestExpectedRows) {
+  BatchSizer sizer(4096, 0, 65536);
+  ASSERT_EQ(sizer.ExpectedRows(1000), 1000);
+  // a filter keeping a tenth of the rows
+  sizer.Observe(*MakeStringBatch(100, 1), 1000);
+  ASSERT_EQ(sizer.ExpectedRows(1000), 100);
+  sizer.Observe(*MakeStringBatch(500, 1), 1000);
+  ASSERT_EQ(sizer.ExpectedRows(1000), 200);
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni/build_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace jni {
+
+TEST(BuildCacheTest, TestHitAndMiss) {
+  BuildCache<std::string> cache(4);
+  ASSERT_EQ(cache.Lookup("a"), nullptr);
+  cache.Insert("a", std::make_shared<std::string>("plan a"), 100);
+  auto plan = cache.Lookup("a");
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(*plan, "plan a");
+  cache.Lookup("a");
+  ASSERT_EQ(cache.hits(), 2);
+  ASSERT_EQ(cache.misses(), 1);
+  ASSERT_EQ(cache.saved_nanos(), 200);
+  // the first build wins, the cached value is never replaced
+  cache.Insert("a", std::make_shared<std::string>("plan a again"), 100);
+  ASSERT_EQ(*cache.Lookup("a"), "plan a");
+  // keys are compared as bytes, embedded zeros included
+  std::string key_1("x\0y", 3);
+  std::string key_2("x\0z", 3);
+  cache.Insert(key_1, std::make_shared<std::string>("plan 1"), 0);
+  ASSERT_EQ(cache.Lookup(key_2), nullptr);
+  ASSERT_EQ(*cache.Lookup(key_1), "plan 1");
+}
+
+TEST(BuildCacheTest, TestEvictLeastRecentlyUsed) {
+  BuildCache<int> cache(2);
+  cache.Insert("a", std::make_shared<int>(1), 0);
+  cache.Insert("b", std::make_shared<int>(2), 0);
+  cache.Lookup("a");
+  cache.Insert("c", std::make_shared<int>(3), 0);
+  ASSERT_EQ(cache.Size(), 2);
+  ASSERT_EQ(cache.Lookup("b"), nullptr);
+  ASSERT_EQ(*cache.Lookup("a"), 1);
+  ASSERT_EQ(*cache.Lookup("c"), 3);
+  // evicted values stay valid for their current users
+  auto a = cache.Lookup("a");
+  cache.Clear();
+  ASSERT_EQ(*a, 1);
+}
+
+TEST(BuildCacheTest, TestDisabled) {
+  BuildCache<int> cache(0);
+  cache.Insert("a", std::make_shared<int>(1), 0);
+  ASSERT_EQ(cache.Lookup("a"), nullptr);
+  ASSERT_EQ(cache.Size(), 0);
+}
+
+TEST(BuildCacheTest, TestConcurrentTasks) {
+  BuildCache<int> cache(8);
+  std::vector<std::thread> tasks;
+  for (int t = 0; t < 8; t++) {
+    tasks.emplace_back([&cache, t]() {
+      for (int i = 0; i < 1000; i++) {
+        auto key = std::to_string((t + i) % 16);
+        if (cache.Lookup(key) == nullptr) {
+          cache.Insert(key, std::make_shared<int>((t + i) % 16), 1);
+        }
+      }
+    });
+  }
+  for (auto& task : tasks) {
+    task.join();
+  }
+  ASSERT_EQ(cache.hits() + cache.misses(), 8000);
+  ASSERT_LE(cache.Size(), 8);
+}
+
+}  // namespace jni
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/arrow_compute/ext/code_store.h"
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+class CodeStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir_template[] = "/tmp/code_store_test_XXXXXX";
+    dir_ = mkdtemp(dir_template);
+  }
+
+  void TearDown() override { system(("rm -rf " + dir_).c_str()); }
+
+  // a file of the given size last modified at the given time
+  static void WriteFile(const std::string& path, int size, time_t mtime) {
+    std::ofstream(path) << std::string(size, 'x');
+    struct utimbuf times = {mtime, mtime};
+    utime(path.c_str(), &times);
+  }
+
+  static bool Exists(const std::string& path) {
+    struct stat file_stat;
+    return stat(path.c_str(), &file_stat) == 0;
+  }
+
+  std::string dir_;
+};
+
+TEST_F(CodeStoreTest, TestEvictLeastRecentlyUsed) {
+  CodeStore store(dir_, 2500);
+  WriteFile(store.GetPath("a", ".so"), 1000, 100);
+  WriteFile(store.GetPath("a", ".cc"), 100, 100);
+  WriteFile(store.GetPath("b", ".so"), 1000, 200);
+  WriteFile(store.GetJarPath("b"), 100, 200);
+  WriteFile(store.GetPath("c", ".so"), 1000, 300);
+  // all files of the oldest signature go at once
+  ASSERT_EQ(store.Evict(), 1100);
+  ASSERT_FALSE(Exists(store.GetPath("a", ".so")));
+  ASSERT_FALSE(Exists(store.GetPath("a", ".cc")));
+  ASSERT_TRUE(Exists(store.GetPath("b", ".so")));
+  ASSERT_TRUE(Exists(store.GetJarPath("b")));
+  ASSERT_TRUE(Exists(store.GetPath("c", ".so")));
+  ASSERT_EQ(store.Evict(), 0);
+}
+
+TEST_F(CodeStoreTest, TestPinnedNotEvicted) {
+  CodeStore store(dir_, 1500);
+  WriteFile(store.GetPath("a", ".so"), 1000, 100);
+  WriteFile(store.GetPath("b", ".so"), 1000, 200);
+  // loading makes a the most recent, and keeps it
+  store.Pin("a");
+  ASSERT_EQ(store.Evict(), 1000);
+  ASSERT_TRUE(Exists(store.GetPath("a", ".so")));
+  ASSERT_FALSE(Exists(store.GetPath("b", ".so")));
+  WriteFile(store.GetPath("c", ".so"), 1000, 300);
+  ASSERT_EQ(store.Evict(), 1000);
+  ASSERT_TRUE(Exists(store.GetPath("a", ".so")));
+  ASSERT_FALSE(Exists(store.GetPath("c", ".so")));
+}
+
+TEST_F(CodeStoreTest, TestLockedNotEvicted) {
+  CodeStore store(dir_, 1);
+  WriteFile(store.GetPath("a", ".so"), 1000, 100);
+  auto fd = store.Lock("a");
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(store.Evict(), 0);
+  store.Unlock(fd);
+  ASSERT_EQ(store.Evict(), 1000);
+}
+
+TEST_F(CodeStoreTest, TestProfileBuildLocks) {
+  CodeStore store(dir_, 1);
+  // the instrumented build writes its library, the object and profile of the key
+  WriteFile(store.GetPath("a-pgo1-instrumented", ".so"), 1000, 100);
+  WriteFile(store.GetPath("a-pgo1", ".pgo.o"), 1000, 100);
+  WriteFile(store.GetPath("a-pgo1", ".pgo.gcda"), 100, 100);
+  auto fds = store.Lock(std::vector<std::string>{"a-pgo1-instrumented", "a-pgo1"});
+  ASSERT_FALSE(fds.empty());
+  for (auto fd : fds) {
+    ASSERT_GE(fd, 0);
+  }
+  ASSERT_EQ(store.Evict(), 0);
+  for (auto fd : fds) {
+    store.Unlock(fd);
+  }
+  // profiles count against the cap and go with the object
+  ASSERT_EQ(store.Evict(), 2100);
+  ASSERT_FALSE(Exists(store.GetPath("a-pgo1", ".pgo.gcda")));
+}
+
+TEST_F(CodeStoreTest, TestUnbounded) {
+  CodeStore store(dir_, 0);
+  WriteFile(store.GetPath("a", ".so"), 1000, 100);
+  ASSERT_EQ(store.Evict(), 0);
+  ASSERT_TRUE(Exists(store.GetPath("a", ".so")));
+}
+
+TEST_F(CodeStoreTest, TestCleanUp) {
+  CodeStore store(dir_, 0);
+  // a compile that crashed before linking and one that crashed while linking
+  WriteFile(store.GetPath("a", ".cc"), 10, 100);
+  WriteFile(store.GetPath("a", ".log"), 10, 100);
+  WriteFile(store.GetPath("b", ".so.tmp"), 10, 100);
+  WriteFile(store.GetPath("c", ".cc"), 10, 100);
+  WriteFile(store.GetPath("c", ".so"), 10, 100);
+  WriteFile(store.GetPath("c", ".so.tmp"), 10, 100);
+  // files of others are left alone
+  WriteFile(dir_ + "/other.txt", 10, 100);
+  ASSERT_EQ(store.CleanUp(), 4);
+  ASSERT_FALSE(Exists(store.GetPath("a", ".cc")));
+  ASSERT_FALSE(Exists(store.GetPath("b", ".so.tmp")));
+  ASSERT_FALSE(Exists(store.GetPath("c", ".so.tmp")));
+  ASSERT_TRUE(Exists(store.GetPath("c", ".cc")));
+  ASSERT_TRUE(Exists(store.GetPath("c", ".so")));
+  ASSERT_TRUE(Exists(dir_ + "/other.txt"));
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <arrow/record_batch.h>
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include "operators/columnar_to_row_converter.h"
+#include "tests/test_utils.h"
+
+namespace sparkcolumnarplugin {
+namespace columnartorow {
+
+template <typename T>
+T GetField(const uint8_t* row, int64_t offset) {
+  T value;
+  memcpy(&value, row + offset, sizeof(T));
+  return value;
+}
+
+TEST(ColumnarToRowConverterTest, SparkUnsafeRowLayout) {
+  auto schema = arrow::schema(
+      {field("f_int32", arrow::int32()), field("f_string", arrow::utf8()),
+       field("f_bool", arrow::boolean()), field("f_double", arrow::float64()),
+       field("f_int64", arrow::int64()), field("f_decimal10", arrow::decimal(10, 2)),
+       field("f_decimal20", arrow::decimal(20, 2))});
+  std::vector<std::string> input_data = {"[1, null, 3]",
+                                         R"(["a", "hello world!", null])",
+                                         "[true, false, null]",
+                                         "[1.5, 2.5, null]",
+                                         "[10, null, 30]",
+                                         R"(["123.45", "-0.01", null])",
+                                         R"(["-1.00", null, "1.28"])"};
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch(input_data, schema, &input_batch);
+
+  ColumnarToRowConverter converter(input_batch, arrow::default_memory_pool());
+  ASSERT_NOT_OK(converter.Init());
+  ASSERT_NOT_OK(converter.Write());
+
+  // 8 bytes null bit set, 7 fields of 8 bytes, then 8-byte aligned variable data
+  ASSERT_EQ(converter.GetNumRows(), 3);
+  ASSERT_EQ(converter.GetLengths(), std::vector<int64_t>({88, 96, 80}));
+  ASSERT_EQ(converter.GetOffsets(), std::vector<int64_t>({0, 88, 184}));
+  ASSERT_EQ(converter.GetBufferSize(), 264);
+
+  const uint8_t* row = converter.GetBufferAddress();
+  ASSERT_EQ(row[0], 0);
+  ASSERT_EQ(GetField<int32_t>(row, 8), 1);
+  ASSERT_EQ(GetField<int64_t>(row, 16), (64LL << 32) | 1);
+  ASSERT_EQ(row[64], 'a');
+  ASSERT_EQ(row[24], 1);
+  ASSERT_EQ(GetField<double>(row, 32), 1.5);
+  ASSERT_EQ(GetField<int64_t>(row, 40), 10);
+  ASSERT_EQ(GetField<int64_t>(row, 48), 12345);
+  ASSERT_EQ(GetField<int64_t>(row, 56), (72LL << 32) | 1);
+  ASSERT_EQ(row[72], 0x9C);
+
+  row = converter.GetBufferAddress() + 88;
+  ASSERT_EQ(row[0], 0x51);
+  ASSERT_EQ(GetField<int64_t>(row, 16), (64LL << 32) | 12);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(row + 64), 12), "hello world!");
+  ASSERT_EQ(row[24], 0);
+  ASSERT_EQ(GetField<double>(row, 32), 2.5);
+  ASSERT_EQ(GetField<int64_t>(row, 48), -1);
+  // a null wide decimal keeps 16 zeroed bytes, as Spark's UnsafeRowWriter does
+  ASSERT_EQ(GetField<int64_t>(row, 56), 80LL << 32);
+  ASSERT_EQ(GetField<int64_t>(row, 80), 0);
+  ASSERT_EQ(GetField<int64_t>(row, 88), 0);
+
+  row = converter.GetBufferAddress() + 184;
+  ASSERT_EQ(row[0], 0x2E);
+  ASSERT_EQ(GetField<int32_t>(row, 8), 3);
+  ASSERT_EQ(GetField<int64_t>(row, 40), 30);
+  ASSERT_EQ(GetField<int64_t>(row, 56), (64LL << 32) | 2);
+  ASSERT_EQ(row[64], 0x00);
+  ASSERT_EQ(row[65], 0x80);
+}
+
+}  // namespace columnartorow
+}  // namespace sparkcolumnarplugin
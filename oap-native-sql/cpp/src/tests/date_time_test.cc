@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/date_time.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+// walks the calendar a day at a time from 1970-01-01, a Thursday
+struct NaiveDate {
+  int32_t year = 1970;
+  int32_t month = 1;
+  int32_t day = 1;
+  int32_t day_of_year = 1;
+  // 1 for Sunday
+  int32_t day_of_week = 5;
+
+  static bool IsLeap(int32_t y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+  static int32_t DaysInMonth(int32_t y, int32_t m) {
+    static const int32_t kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return m == 2 && IsLeap(y) ? 29 : kDays[m - 1];
+  }
+
+  void Next() {
+    day_of_week = day_of_week % 7 + 1;
+    day_of_year++;
+    if (++day <= DaysInMonth(year, month)) return;
+    day = 1;
+    if (++month <= 12) return;
+    month = 1;
+    year++;
+    day_of_year = 1;
+  }
+
+  void Previous() {
+    day_of_week = (day_of_week + 5) % 7 + 1;
+    day_of_year--;
+    if (--day >= 1) return;
+    if (--month < 1) {
+      month = 12;
+      year--;
+      day_of_year = IsLeap(year) ? 366 : 365;
+    }
+    day = DaysInMonth(year, month);
+  }
+};
+
+void ExpectFields(int32_t days, const NaiveDate& expected) {
+  int32_t year, month, day;
+  CivilFromDays(days, &year, &month, &day);
+  ASSERT_EQ(year, expected.year) << days;
+  ASSERT_EQ(month, expected.month) << days;
+  ASSERT_EQ(day, expected.day) << days;
+  ASSERT_EQ(DaysFromCivil(year, month, day), days);
+  ASSERT_EQ(ExtractQuarter(days), (expected.month + 2) / 3);
+  ASSERT_EQ(ExtractDayOfWeek(days), expected.day_of_week) << days;
+  ASSERT_EQ(ExtractDayOfYear(days), expected.day_of_year) << days;
+  ASSERT_EQ(TruncMonth(days), days - expected.day + 1);
+  ASSERT_EQ(TruncYear(days), days - expected.day_of_year + 1);
+  // Monday is 2
+  ASSERT_EQ(TruncWeek(days), days - (expected.day_of_week + 5) % 7);
+  ASSERT_EQ(TruncQuarter(days),
+            DaysFromCivil(expected.year, 3 * ((expected.month - 1) / 3) + 1, 1));
+}
+
+TEST(DateTimeTest, TestCivilFromDaysForward) {
+  // beyond 2400, through the non leap 2100, 2200 and 2300
+  NaiveDate date;
+  for (int32_t days = 0; days < 200000; days++) {
+    ExpectFields(days, date);
+    date.Next();
+  }
+}
+
+TEST(DateTimeTest, TestCivilFromDaysBackward) {
+  // back before the year 0, the proleptic calendar goes on
+  NaiveDate date;
+  for (int32_t days = 0; days > -800000; days--) {
+    ExpectFields(days, date);
+    date.Previous();
+  }
+}
+
+TEST(DateTimeTest, TestKnownDates) {
+  ASSERT_EQ(DaysFromCivil(2000, 2, 29), 11016);
+  ASSERT_EQ(DaysFromCivil(1969, 12, 31), -1);
+  ASSERT_EQ(DaysFromCivil(1, 1, 1), -719162);
+  ASSERT_EQ(ExtractYear(DaysFromCivil(9999, 12, 31)), 9999);
+  // the ends of the range the unsigned shift holds for
+  ASSERT_EQ(DaysFromCivil(-5877641, 6, 23), std::numeric_limits<int32_t>::min());
+  ASSERT_EQ(ExtractYear(std::numeric_limits<int32_t>::min()), -5877641);
+  ASSERT_EQ(DaysFromCivil(5879621, 3, 20), 2146768024);
+  ASSERT_EQ(ExtractDayOfMonth(2146768024), 20);
+  // 2020-07-15 was a Wednesday, in the third quarter
+  auto days = DaysFromCivil(2020, 7, 15);
+  ASSERT_EQ(ExtractDayOfWeek(days), 4);
+  ASSERT_EQ(ExtractQuarter(days), 3);
+  ASSERT_EQ(TruncWeek(days), DaysFromCivil(2020, 7, 13));
+  ASSERT_EQ(TruncQuarter(days), DaysFromCivil(2020, 7, 1));
+}
+
+TEST(DateTimeTest, TestMillis) {
+  ASSERT_EQ(DaysOfMillis(0), 0);
+  ASSERT_EQ(DaysOfMillis(kMillisPerDay - 1), 0);
+  // before the epoch rounds down to the day it is in
+  ASSERT_EQ(DaysOfMillis(-1), -1);
+  ASSERT_EQ(DaysOfMillis(-kMillisPerDay), -1);
+  ASSERT_EQ(DaysOfMillis(-kMillisPerDay - 1), -2);
+  ASSERT_EQ(MillisOfDays(-3), -3 * kMillisPerDay);
+}
+
+TEST(DateTimeTest, TestArrayKernels) {
+  std::vector<int32_t> days;
+  for (int32_t d = -100000; d < 100000; d += 37) {
+    days.push_back(d);
+  }
+  std::vector<int32_t> out(days.size());
+  ExtractMonths(days.data(), days.size(), out.data());
+  for (size_t i = 0; i < days.size(); i++) {
+    ASSERT_EQ(out[i], ExtractMonth(days[i]));
+  }
+  // in place
+  auto in_place = days;
+  TruncWeeks(in_place.data(), in_place.size(), in_place.data());
+  for (size_t i = 0; i < days.size(); i++) {
+    ASSERT_EQ(in_place[i], TruncWeek(days[i]));
+  }
+}
+
+TEST(DateTimeTest, TestStepLookup) {
+  // offsets of America/New_York at the midnights of 2020, by seconds of UTC midnight
+  const int64_t bounds[] = {1583712000, 1604275200};
+  const int64_t offsets[] = {-18000, -14400, -18000};
+  ASSERT_EQ(StepLookup(std::numeric_limits<int64_t>::min(), bounds, offsets, 2), -18000);
+  ASSERT_EQ(StepLookup(1583712000 - 86400, bounds, offsets, 2), -18000);
+  ASSERT_EQ(StepLookup(1583712000, bounds, offsets, 2), -14400);
+  ASSERT_EQ(StepLookup(1604275200 - 1, bounds, offsets, 2), -14400);
+  ASSERT_EQ(StepLookup(1604275200, bounds, offsets, 2), -18000);
+  ASSERT_EQ(StepLookup(int64_t(0), bounds, offsets, 0), -18000);
+
+  // against a linear scan, for every count of bounds
+  std::vector<int64_t> steps;
+  std::vector<int32_t> values = {0};
+  for (int32_t size = 0; size < 40; size++) {
+    for (int64_t key = -10; key < 3 * size + 10; key++) {
+      int32_t expected = 0;
+      while (expected < size && steps[expected] <= key) {
+        expected++;
+      }
+      ASSERT_EQ(StepLookup(key, steps.data(), values.data(), size), expected);
+    }
+    steps.push_back(3 * size + (size % 3));
+    values.push_back(size + 1);
+  }
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "precompile/decimal.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+TEST(DecimalTest, TestRoundHalfUp) {
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(125, 10), 13);
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(124, 10), 12);
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(-125, 10), -13);
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(-124, 10), -12);
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(7, 2), 4);
+  ASSERT_EQ(DivideRoundHalfUp<int64_t>(-7, 2), -4);
+  auto max = GetDecimalScaleMultiplier(38) - 1;
+  ASSERT_EQ(DivideRoundHalfUp<int128_t>(max, GetDecimalScaleMultiplier(38)), 1);
+  ASSERT_EQ(DivideRoundHalfUp<int128_t>(-max, GetDecimalScaleMultiplier(38)), -1);
+}
+
+TEST(DecimalTest, TestRescale) {
+  bool validity;
+  // 1.25 as decimal(3, 2) to decimal(2, 1) and decimal(5, 4)
+  auto out = RescaleDecimal(arrow::Decimal128(125), 2, 2, 1, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(static_cast<int64_t>(out.low_bits()), 13);
+  out = RescaleDecimal(arrow::Decimal128(-125), 2, 5, 4, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(static_cast<int64_t>(out.low_bits()), -12500);
+  ASSERT_EQ(out.high_bits(), -1);
+  // 999.5 doesn't fit in decimal(3, 0) once rounded
+  RescaleDecimal(arrow::Decimal128(9995), 1, 3, 0, &validity);
+  ASSERT_FALSE(validity);
+  // the 64 bit multiplication overflows, decimal(38, 20) still fits
+  out = RescaleDecimal(arrow::Decimal128(123456789012345678), 0, 38, 20, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(ToInt128(out), static_cast<int128_t>(123456789012345678) *
+                               GetDecimalScaleMultiplier(20));
+  // and back to a short decimal
+  out = RescaleDecimal(out, 20, 18, 0, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(static_cast<int64_t>(out.low_bits()), 123456789012345678);
+  // more digits than an int64 has are dropped
+  out = RescaleDecimal(arrow::Decimal128(std::numeric_limits<int64_t>::max()), 20, 10,
+                       0, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(static_cast<int64_t>(out.low_bits()), 0);
+}
+
+TEST(DecimalTest, TestShortMatchesWide) {
+  std::mt19937_64 gen(42);
+  for (int i = 0; i < 100000; i++) {
+    int64_t in = static_cast<int64_t>(gen()) % GetShortDecimalScaleMultiplier(18);
+    int32_t in_scale = gen() % 19;
+    int32_t out_scale = gen() % 19;
+    int32_t out_precision = 1 + gen() % 18;
+    int64_t short_out;
+    int128_t wide_out;
+    auto short_ok = RescaleShortDecimal(in, in_scale, out_scale, &short_out) &&
+                    DecimalFitsInPrecision(short_out, out_precision);
+    auto wide_ok = RescaleDecimal(in, in_scale, out_scale, &wide_out) &&
+                   DecimalFitsInPrecision(wide_out, out_precision);
+    ASSERT_EQ(short_ok, wide_ok);
+    if (short_ok) {
+      ASSERT_EQ(short_out, wide_out);
+    }
+  }
+}
+
+TEST(DecimalTest, TestCastInteger) {
+  bool validity;
+  auto out = CastDecimal(-42, 10, 2, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(static_cast<int64_t>(out.low_bits()), -4200);
+  CastDecimal(100, 4, 2, &validity);
+  ASSERT_FALSE(validity);
+  out = CastDecimal(std::numeric_limits<int64_t>::min(), 38, 10, &validity);
+  ASSERT_TRUE(validity);
+  ASSERT_EQ(ToInt128(out), static_cast<int128_t>(std::numeric_limits<int64_t>::min()) *
+                               GetDecimalScaleMultiplier(10));
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
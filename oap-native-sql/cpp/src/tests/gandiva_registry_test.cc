@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/gandiva_registry.h"
+
+#include <gandiva/tree_expr_builder.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "tests/test_utils.h"
+
+namespace sparkcolumnarplugin {
+
+using gandiva::TreeExprBuilder;
+
+gandiva::ExpressionPtr MakeAdd(const std::shared_ptr<arrow::Field>& a,
+                               const std::shared_ptr<arrow::Field>& b) {
+  auto add = TreeExprBuilder::MakeFunction(
+      "add", {TreeExprBuilder::MakeField(a), TreeExprBuilder::MakeField(b)},
+      arrow::int32());
+  return TreeExprBuilder::MakeExpression(add, arrow::field("r", arrow::int32()));
+}
+
+TEST(GandivaRegistryTest, TestProjectorHit) {
+  GandivaRegistry registry(64 << 20);
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto schema = arrow::schema({a, b});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  std::shared_ptr<gandiva::Projector> first;
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &first));
+  // a task building the same trees again gets the same projector
+  std::shared_ptr<gandiva::Projector> second;
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &second));
+  ASSERT_EQ(first, second);
+  auto metrics = registry.metrics();
+  ASSERT_EQ(metrics.hits, 1);
+  ASSERT_EQ(metrics.misses, 1);
+  ASSERT_EQ(metrics.size, 1);
+  ASSERT_EQ(metrics.inserts, 1);
+  ASSERT_GT(metrics.bytes, 0);
+  ASSERT_GT(metrics.build_nanos, 0);
+  ASSERT_EQ(metrics.saved_nanos, metrics.build_nanos);
+
+  // the shared projector evaluates as one of its own
+  std::shared_ptr<arrow::RecordBatch> batch;
+  MakeInputBatch({"[1, 2, 3]", "[10, 20, 30]"}, schema, &batch);
+  arrow::ArrayVector outputs;
+  ASSERT_NOT_OK(second->Evaluate(*batch, arrow::default_memory_pool(), &outputs));
+  std::shared_ptr<arrow::Array> expected;
+  ASSERT_NOT_OK(arrow::ipc::internal::json::ArrayFromJSON(arrow::int32(), "[11, 22, 33]",
+                                                          &expected));
+  ASSERT_TRUE(outputs[0]->Equals(expected));
+}
+
+TEST(GandivaRegistryTest, TestFingerprint) {
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto c = arrow::field("c", arrow::int32());
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  auto none = gandiva::SelectionVector::Mode::MODE_NONE;
+  auto key = GandivaRegistry::ProjectorFingerprint(*arrow::schema({a, b, c}),
+                                                   {MakeAdd(a, b)}, none, *configuration);
+  // same types, other columns
+  ASSERT_NE(key, GandivaRegistry::ProjectorFingerprint(
+                     *arrow::schema({a, b, c}), {MakeAdd(a, c)}, none, *configuration));
+  // same trees, other input layout
+  ASSERT_NE(key, GandivaRegistry::ProjectorFingerprint(
+                     *arrow::schema({b, a, c}), {MakeAdd(a, b)}, none, *configuration));
+  ASSERT_NE(key, GandivaRegistry::ProjectorFingerprint(
+                     *arrow::schema({a, b, c}), {MakeAdd(a, b)},
+                     gandiva::SelectionVector::Mode::MODE_UINT16, *configuration));
+  ASSERT_EQ(key, GandivaRegistry::ProjectorFingerprint(
+                     *arrow::schema({a, b, c}), {MakeAdd(a, b)}, none, *configuration));
+
+  // names holding the separators of the printed schema don't run into each other
+  auto one = TreeExprBuilder::MakeExpression(TreeExprBuilder::MakeLiteral(1),
+                                             arrow::field("r", arrow::int32()));
+  auto split_after_b = arrow::schema({arrow::field("a", arrow::int32()),
+                                      arrow::field("b: int32\nc", arrow::int32())});
+  auto split_before_b = arrow::schema({arrow::field("a: int32\nb", arrow::int32()),
+                                       arrow::field("c", arrow::int32())});
+  ASSERT_EQ(split_after_b->ToString(), split_before_b->ToString());
+  ASSERT_NE(GandivaRegistry::ProjectorFingerprint(*split_after_b, {one}, none,
+                                                  *configuration),
+            GandivaRegistry::ProjectorFingerprint(*split_before_b, {one}, none,
+                                                  *configuration));
+
+  // doubles printing the same
+  auto make_literal = [](double value) {
+    return TreeExprBuilder::MakeExpression(TreeExprBuilder::MakeLiteral(value),
+                                           arrow::field("r", arrow::float64()));
+  };
+  auto empty = arrow::schema({});
+  ASSERT_NE(GandivaRegistry::ProjectorFingerprint(*empty, {make_literal(0.1)}, none,
+                                                  *configuration),
+            GandivaRegistry::ProjectorFingerprint(
+                *empty, {make_literal(std::nextafter(0.1, 1.0))}, none, *configuration));
+}
+
+TEST(GandivaRegistryTest, TestFilterHit) {
+  GandivaRegistry registry(64 << 20);
+  auto a = arrow::field("a", arrow::int32());
+  auto schema = arrow::schema({a});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  auto make_condition = [&](int32_t bound) {
+    return TreeExprBuilder::MakeCondition(TreeExprBuilder::MakeFunction(
+        "less_than",
+        {TreeExprBuilder::MakeField(a), TreeExprBuilder::MakeLiteral(bound)},
+        arrow::boolean()));
+  };
+  std::shared_ptr<gandiva::Filter> first;
+  std::shared_ptr<gandiva::Filter> second;
+  std::shared_ptr<gandiva::Filter> other;
+  ASSERT_NOT_OK(registry.MakeFilter(schema, make_condition(5), configuration, &first));
+  ASSERT_NOT_OK(registry.MakeFilter(schema, make_condition(5), configuration, &second));
+  // literals are part of the key
+  ASSERT_NOT_OK(registry.MakeFilter(schema, make_condition(6), configuration, &other));
+  ASSERT_EQ(first, second);
+  ASSERT_NE(first, other);
+  ASSERT_EQ(registry.metrics().hits, 1);
+  ASSERT_EQ(registry.metrics().misses, 2);
+}
+
+TEST(GandivaRegistryTest, TestEvictLeastRecentlyUsed) {
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto c = arrow::field("c", arrow::int32());
+  auto schema = arrow::schema({a, b, c});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  // the keys of the three sums have the same size, two fit
+  auto none = gandiva::SelectionVector::Mode::MODE_NONE;
+  auto key = GandivaRegistry::ProjectorFingerprint(*schema, {MakeAdd(a, b)}, none,
+                                                   *configuration);
+  GandivaRegistry registry(2 * GandivaRegistry::EstimatedBytes(key) + 1);
+  std::shared_ptr<gandiva::Projector> ab, ac, bc, again;
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &ab));
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, c)}, configuration, &ac));
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &again));
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(b, c)}, configuration, &bc));
+  auto metrics = registry.metrics();
+  ASSERT_EQ(metrics.evictions, 1);
+  ASSERT_EQ(metrics.size, 2);
+  ASSERT_EQ(metrics.inserts, 3);
+  ASSERT_EQ(metrics.bytes, 2 * GandivaRegistry::EstimatedBytes(key));
+  // a + c was the least recently used, the task holding it still can evaluate it
+  ASSERT_NE(ac, nullptr);
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &again));
+  ASSERT_EQ(again, ab);
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, c)}, configuration, &again));
+  ASSERT_NE(again, ac);
+
+  // entries added keep counting after the evictions
+  ASSERT_EQ(registry.metrics().inserts, 4);
+
+  registry.Clear();
+  ASSERT_EQ(registry.metrics().size, 0);
+  ASSERT_EQ(registry.metrics().bytes, 0);
+}
+
+TEST(GandivaRegistryTest, TestEntryAboveCapacity) {
+  GandivaRegistry registry(1);
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto schema = arrow::schema({a, b});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  std::shared_ptr<gandiva::Projector> projector;
+  ASSERT_NOT_OK(
+      registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &projector));
+  ASSERT_NE(projector, nullptr);
+  ASSERT_EQ(registry.metrics().size, 0);
+  ASSERT_EQ(registry.metrics().evictions, 0);
+}
+
+TEST(GandivaRegistryTest, TestThreadMetrics) {
+  GandivaRegistry registry(64 << 20);
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto schema = arrow::schema({a, b});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  auto before = GandivaRegistry::ThreadMetrics();
+  std::shared_ptr<gandiva::Projector> projector;
+  ASSERT_NOT_OK(
+      registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &projector));
+  // the lookups of another thread are not counted here
+  std::thread other([&] {
+    std::shared_ptr<gandiva::Projector> shared;
+    ASSERT_NOT_OK(
+        registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &shared));
+  });
+  other.join();
+  auto after = GandivaRegistry::ThreadMetrics();
+  ASSERT_EQ(after.misses - before.misses, 1);
+  ASSERT_EQ(after.hits - before.hits, 0);
+  ASSERT_EQ(after.inserts - before.inserts, 1);
+  ASSERT_EQ(registry.metrics().hits, 1);
+}
+
+TEST(GandivaRegistryTest, TestDisabled) {
+  GandivaRegistry registry(0);
+  auto a = arrow::field("a", arrow::int32());
+  auto b = arrow::field("b", arrow::int32());
+  auto schema = arrow::schema({a, b});
+  auto configuration = gandiva::ConfigurationBuilder::DefaultConfiguration();
+  std::shared_ptr<gandiva::Projector> first, second;
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &first));
+  ASSERT_NOT_OK(registry.MakeProjector(schema, {MakeAdd(a, b)}, configuration, &second));
+  ASSERT_NE(first, second);
+  ASSERT_EQ(registry.metrics().hits, 0);
+  ASSERT_EQ(registry.metrics().size, 0);
+}
+
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/arrow_compute/ext/hyperloglog_plus_plus.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+// splitmix64, well mixed 64-bit hashes
+uint64_t NextHash(uint64_t* state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+TEST(HyperLogLogPlusPlusTest, TestBiasTables) {
+  for (int p = 4; p <= 18; p++) {
+    auto table = GetHyperLogLogPlusPlusBias(p);
+    ASSERT_GT(table.size, 1);
+    for (int i = 1; i < table.size; i++) {
+      ASSERT_LT(table.raw_estimates[i - 1], table.raw_estimates[i]);
+    }
+  }
+}
+
+TEST(HyperLogLogPlusPlusTest, TestBiasCorrectedEstimate) {
+  // relative_sd 0.05 => p = 9
+  HyperLogLogPlusPlus hll(0.05);
+  ASSERT_EQ(hll.p(), 9);
+  int m = hll.num_registers();
+  uint64_t state = 42;
+  // between the linear counting threshold and 5m the raw estimate is biased upwards,
+  // the corrected one is not
+  for (int64_t n : {m, 2 * m, 3 * m}) {
+    double error_sum = 0;
+    double raw_error_sum = 0;
+    const int num_sketches = 200;
+    for (int s = 0; s < num_sketches; s++) {
+      std::vector<int64_t> words(hll.num_words(), 0);
+      for (int64_t i = 0; i < n; i++) {
+        hll.Update(words.data(), hll.Encode(NextHash(&state)));
+      }
+      auto estimate = hll.Query(words.data());
+      error_sum += estimate - n;
+      raw_error_sum += estimate + hll.EstimateBias(estimate) - n;
+    }
+    double mean_error = error_sum / num_sketches / n;
+    double raw_mean_error = raw_error_sum / num_sketches / n;
+    ASSERT_LT(std::fabs(mean_error), 0.01) << n;
+    ASSERT_LT(std::fabs(mean_error), std::fabs(raw_mean_error)) << n;
+  }
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
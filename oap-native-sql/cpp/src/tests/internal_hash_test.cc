@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/array.h>
+#include <arrow/ipc/json_simple.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "precompile/internal_hash.h"
+#include "tests/test_utils.h"
+
+namespace sparkcolumnarplugin {
+namespace precompile {
+
+std::shared_ptr<arrow::Array> MakeInputArray(
+    const std::shared_ptr<arrow::DataType>& type, const std::string& json) {
+  std::shared_ptr<arrow::Array> array;
+  ASSERT_NOT_OK(arrow::ipc::internal::json::ArrayFromJSON(type, json, &array));
+  return array;
+}
+
+TEST(InternalHashTest, TestCrc32c) {
+  // standard CRC32C check value, with the inversions the instructions leave out
+  std::string check = "123456789";
+  uint32_t crc = 0xFFFFFFFF;
+  for (auto c : check) {
+    crc = Crc32cU8(crc, c);
+  }
+  ASSERT_EQ(crc ^ 0xFFFFFFFF, 0xE3069283);
+
+  std::mt19937_64 gen(42);
+  for (int i = 0; i < 10000; i++) {
+    uint32_t seed = gen();
+    uint64_t v = gen();
+    ASSERT_EQ(Crc32cU64(seed, v), SoftwareCrc32cU64(seed, v));
+    ASSERT_EQ(Crc32cU32(seed, v), SoftwareCrc32cU32(seed, v));
+    ASSERT_EQ(Crc32cU8(seed, v), SoftwareCrc32cU8(seed, v));
+  }
+}
+
+TEST(InternalHashTest, TestWidthIndependence) {
+  ASSERT_EQ(InternalHash32(static_cast<int8_t>(-3), true),
+            InternalHash32(static_cast<int64_t>(-3), true));
+  ASSERT_EQ(InternalHash32(static_cast<int32_t>(7), true),
+            InternalHash32(static_cast<uint16_t>(7), true));
+  ASSERT_EQ(InternalHash32(-0.0, true), InternalHash32(0.0f, true));
+  ASSERT_EQ(InternalHash32(std::string("abc"), true),
+            InternalHash32(arrow::util::string_view("abc"), true));
+  // a null hashes the same whatever its type, but not to the seed
+  ASSERT_EQ(InternalHash32(std::string("abc"), false, 17), InternalHashNull32(17));
+  ASSERT_EQ(InternalHash32(1.5, false, 17), InternalHashNull32(17));
+  ASSERT_NE(InternalHash32(1.5, false, 17), 17);
+  ASSERT_EQ(InternalHash64(1.5, false, 17), InternalHashNull64(17));
+  ASSERT_NE(InternalHash64(1.5, false, 17), 17);
+}
+
+TEST(InternalHashTest, TestNullPosition) {
+  // (NULL, 5) and (5, NULL) are different groups, the 64 bit hash is the group key
+  std::vector<std::shared_ptr<arrow::Array>> in = {
+      MakeInputArray(arrow::int32(), "[null, 5, null, 5, null]"),
+      MakeInputArray(arrow::int32(), "[5, null, 5, null, null]")};
+  std::shared_ptr<arrow::Array> out_32;
+  std::shared_ptr<arrow::Array> out_64;
+  ASSERT_NOT_OK(HashArrays32(in, arrow::default_memory_pool(), &out_32));
+  ASSERT_NOT_OK(HashArrays64(in, arrow::default_memory_pool(), &out_64));
+  auto hashes_32 = std::static_pointer_cast<arrow::Int32Array>(out_32);
+  auto hashes_64 = std::static_pointer_cast<arrow::Int64Array>(out_64);
+  ASSERT_NE(hashes_32->Value(0), hashes_32->Value(1));
+  ASSERT_NE(hashes_64->Value(0), hashes_64->Value(1));
+  ASSERT_EQ(hashes_32->Value(0), hashes_32->Value(2));
+  ASSERT_EQ(hashes_64->Value(1), hashes_64->Value(3));
+  // (NULL, NULL) is neither (NULL) nor the empty key
+  ASSERT_NE(hashes_64->Value(4), InternalHashNull64(0));
+  ASSERT_NE(hashes_64->Value(4), 0);
+
+  // a null string doesn't hash like the empty string
+  ASSERT_NE(InternalHash64(arrow::util::string_view(""), false, 0),
+            InternalHash64(arrow::util::string_view(""), true, 0));
+  ASSERT_NE(InternalHash32(arrow::util::string_view(""), false, 0),
+            InternalHash32(arrow::util::string_view(""), true, 0));
+}
+
+TEST(InternalHashTest, TestHashArrays) {
+  std::vector<std::shared_ptr<arrow::Array>> in = {
+      MakeInputArray(arrow::int32(), "[1, null, 3, -4, 5, 6, 7, 8, 9, null]"),
+      MakeInputArray(arrow::utf8(),
+                     R"(["a", "bb", null, "", "a longer string", "eeeeeeee", "f", "g",
+                         "h", null])"),
+      MakeInputArray(arrow::float64(), "[0.5, -0.0, 2.5, null, 3, 4, 5, 6, 7, null]"),
+      MakeInputArray(arrow::boolean(),
+                     "[true, false, null, true, true, false, null, true, false, null]"),
+      MakeInputArray(arrow::date32(), "[1, 2, 3, 4, 5, 6, 7, 8, null, null]"),
+      MakeInputArray(arrow::decimal(20, 2),
+                     R"(["1.00", "-2.50", null, "123456789012345678.99", "0.00", "7.77",
+                         "8.88", "9.99", "10.10", null])")};
+
+  std::shared_ptr<arrow::Array> out_32;
+  std::shared_ptr<arrow::Array> out_64;
+  ASSERT_NOT_OK(HashArrays32(in, arrow::default_memory_pool(), &out_32));
+  ASSERT_NOT_OK(HashArrays64(in, arrow::default_memory_pool(), &out_64));
+  ASSERT_EQ(out_32->length(), in[0]->length());
+  ASSERT_EQ(out_32->null_count(), 0);
+  auto hashes_32 = std::static_pointer_cast<arrow::Int32Array>(out_32);
+  auto hashes_64 = std::static_pointer_cast<arrow::Int64Array>(out_64);
+
+  auto ints = std::static_pointer_cast<arrow::Int32Array>(in[0]);
+  auto strs = std::static_pointer_cast<arrow::StringArray>(in[1]);
+  auto doubles = std::static_pointer_cast<arrow::DoubleArray>(in[2]);
+  auto bools = std::static_pointer_cast<arrow::BooleanArray>(in[3]);
+  auto dates = std::static_pointer_cast<arrow::Date32Array>(in[4]);
+  auto decimals = std::static_pointer_cast<arrow::Decimal128Array>(in[5]);
+  // the batch hash is the per row hash chained over the keys, as the jitted code does
+  for (int64_t i = 0; i < in[0]->length(); i++) {
+    int32_t hash_32 = 0;
+    hash_32 = InternalHash32(ints->Value(i), ints->IsValid(i), hash_32);
+    hash_32 = InternalHash32(strs->GetString(i), strs->IsValid(i), hash_32);
+    hash_32 = InternalHash32(doubles->Value(i), doubles->IsValid(i), hash_32);
+    hash_32 = InternalHash32(bools->Value(i), bools->IsValid(i), hash_32);
+    hash_32 = InternalHash32(dates->Value(i), dates->IsValid(i), hash_32);
+    hash_32 = InternalHash32(arrow::Decimal128(decimals->GetValue(i)),
+                             decimals->IsValid(i), hash_32);
+    ASSERT_EQ(hashes_32->Value(i), hash_32);
+
+    int64_t hash_64 = 0;
+    hash_64 = InternalHash64(ints->Value(i), ints->IsValid(i), hash_64);
+    hash_64 = InternalHash64(strs->GetString(i), strs->IsValid(i), hash_64);
+    hash_64 = InternalHash64(doubles->Value(i), doubles->IsValid(i), hash_64);
+    hash_64 = InternalHash64(bools->Value(i), bools->IsValid(i), hash_64);
+    hash_64 = InternalHash64(dates->Value(i), dates->IsValid(i), hash_64);
+    hash_64 = InternalHash64(arrow::Decimal128(decimals->GetValue(i)),
+                             decimals->IsValid(i), hash_64);
+    ASSERT_EQ(hashes_64->Value(i), hash_64);
+  }
+  // only nulls, every column hashed its null marker
+  int32_t null_hash_32 = 0;
+  int64_t null_hash_64 = 0;
+  for (size_t i = 0; i < in.size(); i++) {
+    null_hash_32 = InternalHashNull32(null_hash_32);
+    null_hash_64 = InternalHashNull64(null_hash_64);
+  }
+  ASSERT_EQ(hashes_32->Value(9), null_hash_32);
+  ASSERT_EQ(hashes_64->Value(9), null_hash_64);
+}
+
+TEST(InternalHashTest, TestSlicedInput) {
+  auto in = MakeInputArray(arrow::int64(), "[10, 20, null, 40, 50]");
+  std::shared_ptr<arrow::Array> out;
+  ASSERT_NOT_OK(HashArrays32({in->Slice(1, 3)}, arrow::default_memory_pool(), &out));
+  auto hashes = std::static_pointer_cast<arrow::Int32Array>(out);
+  ASSERT_EQ(hashes->length(), 3);
+  ASSERT_EQ(hashes->Value(0), InternalHash32(static_cast<int64_t>(20), true));
+  ASSERT_EQ(hashes->Value(1), InternalHashNull32(0));
+  ASSERT_EQ(hashes->Value(2), InternalHash32(static_cast<int64_t>(40), true));
+}
+
+}  // namespace precompile
+}  // namespace sparkcolumnarplugin
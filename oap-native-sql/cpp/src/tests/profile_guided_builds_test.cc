@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/arrow_compute/ext/profile_guided_builds.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+namespace codegen {
+namespace arrowcompute {
+namespace extra {
+
+using State = ProfileGuidedBuilds::State;
+
+// records the builds instead of compiling them, the optimised one fails if asked to
+class StubbedBuilds {
+ public:
+  explicit StubbedBuilds(bool fail_optimised = false)
+      : builds_(
+            1,
+            [this, fail_optimised](const std::string& codes,
+                                   const std::string& build_signature,
+                                   bool instrumented, const std::string& profile_key) {
+              std::lock_guard<std::mutex> lock(mtx_);
+              compiled_.push_back(build_signature);
+              if (!instrumented && fail_optimised) {
+                return arrow::Status::Invalid("no profile for ", profile_key);
+              }
+              return arrow::Status::OK();
+            },
+            [this](const std::string& instrumented_signature) {
+              std::lock_guard<std::mutex> lock(mtx_);
+              dumped_.push_back(instrumented_signature);
+              return arrow::Status::OK();
+            }) {}
+
+  ProfileGuidedBuilds* builds() { return &builds_; }
+
+  // builds run in the background, waits for the state they leave behind
+  State WaitFor(const std::string& signature, State state) {
+    for (int i = 0; i < 1000 && builds_.GetState(signature) != state; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return builds_.GetState(signature);
+  }
+
+  std::vector<std::string> compiled() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return compiled_;
+  }
+
+  std::vector<std::string> dumped() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return dumped_;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::vector<std::string> compiled_;
+  std::vector<std::string> dumped_;
+  ProfileGuidedBuilds builds_;
+};
+
+TEST(ProfileGuidedBuildsTest, TestDisabled) {
+  ProfileGuidedBuilds builds(0);
+  ASSERT_FALSE(builds.enabled());
+  builds.AddRunTime("abc", "", 1000000000);
+  ASSERT_EQ(builds.GetState("abc"), State::kPlain);
+  ASSERT_EQ(builds.GetSignature("abc"), "abc");
+}
+
+TEST(ProfileGuidedBuildsTest, TestBelowThreshold) {
+  ProfileGuidedBuilds builds(10);
+  ASSERT_TRUE(builds.enabled());
+  builds.AddRunTime("abc", "", 4000000);
+  builds.AddRunTime("abc", "", 4000000);
+  ASSERT_EQ(builds.GetState("abc"), State::kPlain);
+  // nothing to run before the instrumented build is compiled
+  std::string instrumented;
+  ASSERT_FALSE(builds.ClaimInstrumented("abc", &instrumented));
+  builds.FinishProfiling("abc", "", 10);
+  ASSERT_EQ(builds.GetState("abc"), State::kPlain);
+  ASSERT_EQ(builds.GetSignature("abc"), "abc");
+}
+
+TEST(ProfileGuidedBuildsTest, TestProfileRound) {
+  StubbedBuilds stub;
+  auto builds = stub.builds();
+  builds->AddRunTime("abc", "codes", 2000000);
+  ASSERT_EQ(stub.WaitFor("abc", State::kInstrumented), State::kInstrumented);
+  ASSERT_EQ(stub.compiled(), std::vector<std::string>{"abc-pgo1-instrumented"});
+
+  // one task profiles, the others keep the plain build
+  std::string instrumented;
+  ASSERT_TRUE(builds->ClaimInstrumented("abc", &instrumented));
+  ASSERT_EQ(instrumented, "abc-pgo1-instrumented");
+  ASSERT_FALSE(builds->ClaimInstrumented("abc", &instrumented));
+  ASSERT_EQ(builds->GetState("abc"), State::kProfiling);
+
+  // a task ending before the first batch hands the instrumented build on
+  builds->FinishProfiling("abc", "codes", 0);
+  ASSERT_EQ(builds->GetState("abc"), State::kInstrumented);
+  ASSERT_TRUE(builds->ClaimInstrumented("abc", &instrumented));
+  builds->FinishProfiling("abc", "codes", 8);
+  ASSERT_EQ(stub.WaitFor("abc", State::kOptimised), State::kOptimised);
+  ASSERT_EQ(stub.dumped(), std::vector<std::string>{"abc-pgo1-instrumented"});
+  ASSERT_EQ(stub.compiled().back(), "abc-pgo1");
+  ASSERT_EQ(builds->GetSignature("abc"), "abc-pgo1");
+}
+
+TEST(ProfileGuidedBuildsTest, TestFailedBuild) {
+  StubbedBuilds stub(true);
+  auto builds = stub.builds();
+  builds->AddRunTime("abc", "codes", 2000000);
+  ASSERT_EQ(stub.WaitFor("abc", State::kInstrumented), State::kInstrumented);
+  std::string instrumented;
+  ASSERT_TRUE(builds->ClaimInstrumented("abc", &instrumented));
+  builds->FinishProfiling("abc", "codes", 8);
+  ASSERT_EQ(stub.WaitFor("abc", State::kFailed), State::kFailed);
+  // tasks keep the plain build and stop adding run time
+  ASSERT_EQ(builds->GetSignature("abc"), "abc");
+  builds->AddRunTime("abc", "codes", 2000000);
+  ASSERT_EQ(builds->GetState("abc"), State::kFailed);
+  ASSERT_EQ(stub.compiled().size(), 2);
+}
+
+TEST(ProfileGuidedBuildsTest, TestFailedLoad) {
+  StubbedBuilds stub;
+  auto builds = stub.builds();
+  builds->AddRunTime("abc", "codes", 2000000);
+  ASSERT_EQ(stub.WaitFor("abc", State::kInstrumented), State::kInstrumented);
+  std::string instrumented;
+  ASSERT_TRUE(builds->ClaimInstrumented("abc", &instrumented));
+  // the claiming task could not load the instrumented build
+  builds->MarkFailed("abc");
+  ASSERT_EQ(builds->GetState("abc"), State::kFailed);
+  ASSERT_FALSE(builds->ClaimInstrumented("abc", &instrumented));
+  builds->FinishProfiling("abc", "codes", 8);
+  ASSERT_EQ(builds->GetState("abc"), State::kFailed);
+  ASSERT_TRUE(stub.dumped().empty());
+}
+
+TEST(ProfileGuidedBuildsTest, TestSignatures) {
+  // each generation of profile builds is cached and loaded on its own
+  ASSERT_EQ(ProfileGuidedBuilds::OptimisedSignature("abc", 1), "abc-pgo1");
+  ASSERT_EQ(ProfileGuidedBuilds::InstrumentedSignature("abc", 1),
+            "abc-pgo1-instrumented");
+  ASSERT_NE(ProfileGuidedBuilds::OptimisedSignature("abc", 1),
+            ProfileGuidedBuilds::OptimisedSignature("abc", 2));
+}
+
+}  // namespace extra
+}  // namespace arrowcompute
+}  // namespace codegen
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/record_batch.h>
+#include <gtest/gtest.h>
+
+#include "operators/columnar_to_row_converter.h"
+#include "operators/row_to_columnar_converter.h"
+#include "tests/test_utils.h"
+
+namespace sparkcolumnarplugin {
+namespace rowtocolumnar {
+
+TEST(RowToColumnarConverterTest, RoundTrip) {
+  auto schema = arrow::schema(
+      {field("f_int8", arrow::int8()), field("f_int16", arrow::int16()),
+       field("f_int32", arrow::int32()), field("f_string", arrow::utf8()),
+       field("f_bool", arrow::boolean()), field("f_float", arrow::float32()),
+       field("f_double", arrow::float64()), field("f_int64", arrow::int64()),
+       field("f_date32", arrow::date32()), field("f_binary", arrow::binary()),
+       field("f_decimal10", arrow::decimal(10, 2)),
+       field("f_decimal20", arrow::decimal(20, 2))});
+  std::vector<std::string> input_data = {"[1, null, -3, 4]",
+                                         "[null, 200, -300, 400]",
+                                         "[1, null, 3, 2147483647]",
+                                         R"(["a", "hello world!", null, ""])",
+                                         "[true, false, null, true]",
+                                         "[1.5, null, -2.5, 0]",
+                                         "[1.5, 2.5, null, -0.5]",
+                                         "[10, null, 30, -9223372036854775808]",
+                                         "[0, 18000, null, -1]",
+                                         R"(["YWJj", null, "", "ZGVmZ2hpams="])",
+                                         R"(["123.45", "-0.01", null, "99999999.99"])",
+                                         R"(["-1.00", null, "1.28",
+                                             "-999999999999999999.99"])"};
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch(input_data, schema, &input_batch);
+
+  columnartorow::ColumnarToRowConverter row_converter(input_batch,
+                                                      arrow::default_memory_pool());
+  ASSERT_NOT_OK(row_converter.Init());
+  ASSERT_NOT_OK(row_converter.Write());
+
+  RowToColumnarConverter converter(schema, row_converter.GetNumRows(),
+                                   row_converter.GetOffsets().data(),
+                                   row_converter.GetBufferAddress(),
+                                   arrow::default_memory_pool());
+  std::shared_ptr<arrow::RecordBatch> result_batch;
+  ASSERT_NOT_OK(converter.Convert(&result_batch));
+  ASSERT_NOT_OK(Equals(*input_batch, *result_batch));
+}
+
+TEST(RowToColumnarConverterTest, NoNullColumn) {
+  auto schema = arrow::schema({field("f_int64", arrow::int64())});
+  std::shared_ptr<arrow::RecordBatch> input_batch;
+  MakeInputBatch({"[1, 2, 3]"}, schema, &input_batch);
+
+  columnartorow::ColumnarToRowConverter row_converter(input_batch,
+                                                      arrow::default_memory_pool());
+  ASSERT_NOT_OK(row_converter.Init());
+  ASSERT_NOT_OK(row_converter.Write());
+
+  RowToColumnarConverter converter(schema, row_converter.GetNumRows(),
+                                   row_converter.GetOffsets().data(),
+                                   row_converter.GetBufferAddress(),
+                                   arrow::default_memory_pool());
+  std::shared_ptr<arrow::RecordBatch> result_batch;
+  ASSERT_NOT_OK(converter.Convert(&result_batch));
+  ASSERT_NOT_OK(Equals(*input_batch, *result_batch));
+  // a column without null doesn't get a validity bitmap
+  ASSERT_EQ(result_batch->column(0)->null_count(), 0);
+  ASSERT_EQ(result_batch->column_data(0)->buffers[0], nullptr);
+}
+
+}  // namespace rowtocolumnar
+}  // namespace sparkcolumnarplugin
@@ -176,6 +176,46 @@ TEST_F(SplitterTest, TestSingleSplitter) {
   }
 }
 
+TEST_F(SplitterTest, TestSpillByArbiter) {
+  auto arbiter = std::make_shared<SpillArbiter>();
+  ArbitratedMemoryPool pool(arrow::default_memory_pool(), arbiter);
+  split_options_.buffer_size = 10;
+  split_options_.memory_pool = &pool;
+  ARROW_ASSIGN_OR_THROW(splitter_, Splitter::Make("rr", schema_, 1, split_options_))
+
+  ASSERT_NOT_OK(splitter_->Split(*input_batch_1_));
+  ASSERT_GT(splitter_->GetReclaimableBytes(), 0);
+
+  // another operator of the task is short of memory, the buffered rows are spilled
+  int64_t reclaimed;
+  ASSERT_NOT_OK(arbiter->Reclaim(1, &reclaimed));
+  ASSERT_GT(reclaimed, 0);
+  ASSERT_EQ(splitter_->GetReclaimableBytes(), 0);
+  ASSERT_EQ(arbiter->metrics()["ShuffleSplitter"].num_spills, 1);
+
+  // partition buffers are allocated again
+  ASSERT_NOT_OK(splitter_->Split(*input_batch_2_));
+  ASSERT_NOT_OK(splitter_->Split(*input_batch_1_));
+  ASSERT_NOT_OK(splitter_->Stop());
+
+  std::shared_ptr<arrow::ipc::RecordBatchReader> file_reader;
+  ARROW_ASSIGN_OR_THROW(file_reader, GetRecordBatchStreamReader(splitter_->DataFile()));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  ASSERT_NOT_OK(file_reader->ReadAll(&batches));
+  ASSERT_EQ(batches.size(), 3);
+  std::vector<arrow::RecordBatch*> expected = {input_batch_1_.get(), input_batch_2_.get(),
+                                               input_batch_1_.get()};
+  for (auto i = 0; i < batches.size(); ++i) {
+    ASSERT_TRUE(batches[i]->Equals(*expected[i]));
+  }
+
+  // the splitter unregisters when it's gone
+  file_reader.reset();
+  splitter_.reset();
+  ASSERT_NOT_OK(arbiter->Reclaim(1, &reclaimed));
+  ASSERT_EQ(reclaimed, 0);
+}
+
 TEST_F(SplitterTest, TestRoundRobinSplitter) {
   int32_t num_partitions = 2;
   split_options_.buffer_size = 4;
@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tests/test_utils.h"
+#include "utils/spill_arbiter.h"
+
+namespace sparkcolumnarplugin {
+
+const int64_t kMB = 1024 * 1024;
+
+// stands in for a task's listenable pool, rejects allocations over the limit
+class LimitedMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit LimitedMemoryPool(int64_t limit) : limit_(limit) {}
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override {
+    if (bytes_allocated() + size > limit_) {
+      return arrow::Status::OutOfMemory("Limit of ", limit_, " bytes exceeded");
+    }
+    return pool_->Allocate(size, out);
+  }
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override {
+    if (bytes_allocated() + new_size - old_size > limit_) {
+      return arrow::Status::OutOfMemory("Limit of ", limit_, " bytes exceeded");
+    }
+    return pool_->Reallocate(old_size, new_size, ptr);
+  }
+
+  void Free(uint8_t* buffer, int64_t size) override { pool_->Free(buffer, size); }
+
+  int64_t bytes_allocated() const override { return pool_->bytes_allocated(); }
+
+  int64_t max_memory() const override { return pool_->max_memory(); }
+
+  std::string backend_name() const override { return pool_->backend_name(); }
+
+ private:
+  std::unique_ptr<arrow::ProxyMemoryPool> pool_ =
+      std::make_unique<arrow::ProxyMemoryPool>(arrow::default_memory_pool());
+  int64_t limit_;
+};
+
+// holds 1MB buffers and drops them when spilled
+class FakeSpillable : public Spillable {
+ public:
+  FakeSpillable(std::string name, double cost) : name_(std::move(name)), cost_(cost) {}
+
+  arrow::Status Hold(arrow::MemoryPool* pool, int64_t num_mb) {
+    for (int64_t i = 0; i < num_mb; i++) {
+      std::shared_ptr<arrow::Buffer> buffer;
+      ARROW_ASSIGN_OR_RAISE(buffer, arrow::AllocateBuffer(kMB, pool));
+      buffers_.push_back(std::move(buffer));
+    }
+    return arrow::Status::OK();
+  }
+
+  std::string SpillableName() const override { return name_; }
+
+  int64_t GetReclaimableBytes() const override { return buffers_.size() * kMB; }
+
+  double GetSpillCost() const override { return cost_; }
+
+  arrow::Status Spill(int64_t size, int64_t* reclaimed) override {
+    *reclaimed = 0;
+    while (*reclaimed < size && !buffers_.empty()) {
+      buffers_.pop_back();
+      *reclaimed += kMB;
+    }
+    if (on_spill) {
+      return on_spill();
+    }
+    return arrow::Status::OK();
+  }
+
+  std::function<arrow::Status()> on_spill;
+
+ private:
+  std::string name_;
+  double cost_;
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers_;
+};
+
+TEST(SpillArbiterTest, TestReclaimFromLargestVictim) {
+  LimitedMemoryPool limited_pool(8 * kMB);
+  auto arbiter = std::make_shared<SpillArbiter>();
+  ArbitratedMemoryPool pool(&limited_pool, arbiter);
+
+  FakeSpillable small("small", 1.0);
+  FakeSpillable large("large", 1.0);
+  ASSERT_NOT_OK(small.Hold(&pool, 2));
+  ASSERT_NOT_OK(large.Hold(&pool, 5));
+  arbiter->Register(&small);
+  arbiter->Register(&large);
+
+  // 1MB is left, the allocation only succeeds after a spill
+  std::shared_ptr<arrow::Buffer> buffer;
+  ARROW_ASSIGN_OR_THROW(buffer, arrow::AllocateBuffer(3 * kMB, &pool));
+  ASSERT_EQ(small.GetReclaimableBytes(), 2 * kMB);
+  ASSERT_EQ(large.GetReclaimableBytes(), 2 * kMB);
+
+  ASSERT_EQ(arbiter->num_triggers(), 1);
+  ASSERT_EQ(arbiter->total_bytes_reclaimed(), 3 * kMB);
+  auto metrics = arbiter->metrics();
+  ASSERT_EQ(metrics.count("small"), 0);
+  ASSERT_EQ(metrics["large"].num_spills, 1);
+  ASSERT_EQ(metrics["large"].bytes_reclaimed, 3 * kMB);
+
+  arbiter->Unregister(&small);
+  arbiter->Unregister(&large);
+}
+
+TEST(SpillArbiterTest, TestReclaimByCost) {
+  LimitedMemoryPool limited_pool(8 * kMB);
+  auto arbiter = std::make_shared<SpillArbiter>();
+  ArbitratedMemoryPool pool(&limited_pool, arbiter);
+
+  // the large one has to read its spill back, the cheap one gives more bytes per cost
+  FakeSpillable expensive("expensive", 8.0);
+  FakeSpillable cheap("cheap", 1.0);
+  ASSERT_NOT_OK(expensive.Hold(&pool, 4));
+  ASSERT_NOT_OK(cheap.Hold(&pool, 3));
+  arbiter->Register(&expensive);
+  arbiter->Register(&cheap);
+
+  std::shared_ptr<arrow::Buffer> buffer;
+  ARROW_ASSIGN_OR_THROW(buffer, arrow::AllocateBuffer(3 * kMB, &pool));
+  ASSERT_EQ(expensive.GetReclaimableBytes(), 4 * kMB);
+  ASSERT_EQ(cheap.GetReclaimableBytes(), 0);
+
+  // only the expensive one is left to spill
+  buffer.reset();
+  ARROW_ASSIGN_OR_THROW(buffer, arrow::AllocateBuffer(6 * kMB, &pool));
+  ASSERT_EQ(expensive.GetReclaimableBytes(), 0);
+  ASSERT_EQ(arbiter->num_triggers(), 2);
+  auto metrics = arbiter->metrics();
+  ASSERT_EQ(metrics["cheap"].num_spills, 1);
+  ASSERT_EQ(metrics["cheap"].bytes_reclaimed, 3 * kMB);
+  ASSERT_EQ(metrics["expensive"].num_spills, 1);
+  ASSERT_EQ(metrics["expensive"].bytes_reclaimed, 4 * kMB);
+
+  arbiter->Unregister(&expensive);
+  arbiter->Unregister(&cheap);
+}
+
+TEST(SpillArbiterTest, TestReclaimNothing) {
+  LimitedMemoryPool limited_pool(4 * kMB);
+  auto arbiter = std::make_shared<SpillArbiter>();
+  ArbitratedMemoryPool pool(&limited_pool, arbiter);
+
+  uint8_t* out;
+  auto status = pool.Allocate(5 * kMB, &out);
+  ASSERT_TRUE(status.IsOutOfMemory());
+  ASSERT_EQ(arbiter->num_triggers(), 1);
+  ASSERT_EQ(arbiter->total_bytes_reclaimed(), 0);
+}
+
+TEST(SpillArbiterTest, TestNoReclaimWithinSpill) {
+  auto arbiter = std::make_shared<SpillArbiter>();
+  FakeSpillable first("first", 1.0);
+  FakeSpillable second("second", 1.0);
+  ASSERT_NOT_OK(first.Hold(arrow::default_memory_pool(), 2));
+  ASSERT_NOT_OK(second.Hold(arrow::default_memory_pool(), 1));
+  int64_t nested_reclaimed = -1;
+  first.on_spill = [&]() { return arbiter->Reclaim(kMB, &nested_reclaimed); };
+  arbiter->Register(&first);
+  arbiter->Register(&second);
+
+  int64_t reclaimed;
+  ASSERT_NOT_OK(arbiter->Reclaim(kMB, &reclaimed));
+  ASSERT_EQ(reclaimed, kMB);
+  ASSERT_EQ(nested_reclaimed, 0);
+  ASSERT_EQ(second.GetReclaimableBytes(), kMB);
+  ASSERT_EQ(arbiter->num_triggers(), 1);
+
+  arbiter->Unregister(&first);
+  arbiter->Unregister(&second);
+}
+
+TEST(SpillArbiterTest, TestArbiterPerTask) {
+  auto arbiter_1 = SpillArbiter::ForTask(1);
+  ASSERT_EQ(SpillArbiter::ForTask(1), arbiter_1);
+  ASSERT_NE(SpillArbiter::ForTask(2), arbiter_1);
+
+  ArbitratedMemoryPool pool(arrow::default_memory_pool(), arbiter_1);
+  ASSERT_EQ(GetSpillArbiter(&pool), arbiter_1);
+  ASSERT_EQ(GetSpillArbiter(arrow::default_memory_pool()), nullptr);
+}
+
+TEST(SpillArbiterTest, TestReleasedTask) {
+  std::weak_ptr<SpillArbiter> released;
+  {
+    LimitedMemoryPool limited(kMB);
+    ArbitratedMemoryPool pool(&limited, SpillArbiter::ForTask(3));
+    released = pool.arbiter();
+    // a pool released with buffers left gives up the task's arbiter
+    std::shared_ptr<arrow::Buffer> buffer;
+    ARROW_ASSIGN_OR_THROW(buffer, arrow::AllocateBuffer(kMB, &pool));
+    pool.ReleaseArbiter();
+    ASSERT_EQ(GetSpillArbiter(&pool), nullptr);
+    ASSERT_TRUE(released.expired());
+    // and fails over the limit without reclaiming
+    ASSERT_FALSE(arrow::AllocateBuffer(kMB, &pool).ok());
+  }
+  SpillArbiter::RemoveFinishedTasks();
+  ASSERT_NE(SpillArbiter::ForTask(3), nullptr);
+}
+
+}  // namespace sparkcolumnarplugin
@@ -14,7 +14,9 @@ template <typename T>
 using enable_if_int64 = typename std::enable_if<is_int64<T>::value, int32_t>::type;
 
 template <typename T>
-using is_string = std::is_same<std::string, T>;
+using is_string =
+    std::integral_constant<bool, std::is_same<std::string, T>::value ||
+                                     std::is_same<arrow::util::string_view, T>::value>;
 
 template <typename T>
 using enable_if_string = typename std::enable_if<is_string<T>::value, int32_t>::type;
@@ -123,12 +123,12 @@ static inline unsafeHashMap* createUnsafeHashMap(int initArrayCapacity,
       (unsafeHashMap*)nativeMalloc(sizeof(unsafeHashMap), MEMTYPE_HASHMAP);
   uint8_t bytesInKeyArray = (keySize == -1) ? 8 : 8 + keySize;
   hashMap->bytesInKeyArray = bytesInKeyArray;
-  hashMap->keyArray =
-      (char*)nativeMalloc(initArrayCapacity * bytesInKeyArray, MEMTYPE_HASHMAP);
+  hashMap->keyArray = (char*)nativeMallocLarge(
+      (size_t)initArrayCapacity * bytesInKeyArray, MEMTYPE_HASHMAP);
   hashMap->arrayCapacity = initArrayCapacity;
   memset(hashMap->keyArray, -1, initArrayCapacity * bytesInKeyArray);
 
-  hashMap->bytesMap = (char*)nativeMalloc(initialHashCapacity, MEMTYPE_HASHMAP);
+  hashMap->bytesMap = (char*)nativeMallocLarge(initialHashCapacity, MEMTYPE_HASHMAP);
   hashMap->mapSize = initialHashCapacity;
 
   hashMap->cursor = 0;
@@ -139,8 +139,10 @@ static inline unsafeHashMap* createUnsafeHashMap(int initArrayCapacity,
 
 static inline void destroyHashMap(unsafeHashMap* hm) {
   if (hm != NULL) {
-    if (hm->keyArray != NULL) nativeFree(hm->keyArray);
-    if (hm->bytesMap != NULL) nativeFree(hm->bytesMap);
+    if (hm->keyArray != NULL) {
+      nativeFreeLarge(hm->keyArray, (size_t)hm->arrayCapacity * hm->bytesInKeyArray);
+    }
+    if (hm->bytesMap != NULL) nativeFreeLarge(hm->bytesMap, hm->mapSize);
 
     nativeFree(hm);
   }
@@ -194,7 +196,8 @@ static inline int getValueFromBytesMapByOffset(unsafeHashMap* hashMap,
 static inline bool growHashBytesMap(unsafeHashMap* hashMap) {
   int oldSize = hashMap->mapSize;
   int newSize = oldSize << 1;
-  char* newBytesMap = (char*)nativeRealloc(hashMap->bytesMap, newSize, MEMTYPE_HASHMAP);
+  char* newBytesMap =
+      (char*)nativeReallocLarge(hashMap->bytesMap, oldSize, newSize, MEMTYPE_HASHMAP);
   if (newBytesMap == NULL) return false;
 
   hashMap->bytesMap = newBytesMap;
@@ -212,8 +215,8 @@ static inline bool growAndRehashKeyArray(unsafeHashMap* hashMap) {
   char* oldKeyArray = hashMap->keyArray;
 
   // Allocate the new keyArray and zero it
-  char* newKeyArray =
-      (char*)nativeMalloc(newCapacity * hashMap->bytesInKeyArray, MEMTYPE_HASHMAP);
+  char* newKeyArray = (char*)nativeMallocLarge(
+      (size_t)newCapacity * hashMap->bytesInKeyArray, MEMTYPE_HASHMAP);
   if (newKeyArray == NULL) return false;
 
   memset(newKeyArray, -1, newCapacity * hashMap->bytesInKeyArray);
@@ -259,7 +262,7 @@ static inline bool growAndRehashKeyArray(unsafeHashMap* hashMap) {
   hashMap->keyArray = newKeyArray;
   hashMap->arrayCapacity = newCapacity;
 
-  nativeFree(oldKeyArray);
+  nativeFreeLarge(oldKeyArray, (size_t)oldCapacity * hashMap->bytesInKeyArray);
   return true;
 }
 /*
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/** Huge page backed allocations for large and long-lived native structures, like the
+ * keyArray and bytesMap of unsafeHashMap. Random probes into multi-GB arrays miss the
+ * TLB on almost every access with 4K pages.
+ *
+ * NATIVESQL_HUGE_PAGE selects the mode:
+ *   off (default) - regular anonymous mappings
+ *   thp           - 2M aligned mappings advised with MADV_HUGEPAGE
+ *   hugetlb       - MAP_HUGETLB from the reserved pool, thp when none is left
+ * Only allocations of at least NATIVESQL_HUGE_PAGE_THRESHOLD bytes (16M by default)
+ * are mapped here, smaller ones stay on malloc.
+ **/
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define DEFAULT_HUGE_PAGE_THRESHOLD (16 * 1024 * 1024)
+
+typedef enum { HUGEPAGE_OFF = 0, HUGEPAGE_THP, HUGEPAGE_HUGETLB } HugePageMode;
+
+/* Read once per process: allocations are freed by the mode and threshold they were
+ * made with, which must not change in between. Not static, so that all the
+ * translation units share the one copy. */
+inline HugePageMode getHugePageMode() {
+  static const HugePageMode mode = [] {
+    const char* env_mode = getenv("NATIVESQL_HUGE_PAGE");
+    if (env_mode == NULL) return HUGEPAGE_OFF;
+    if (strcmp(env_mode, "thp") == 0) return HUGEPAGE_THP;
+    if (strcmp(env_mode, "hugetlb") == 0) return HUGEPAGE_HUGETLB;
+    return HUGEPAGE_OFF;
+  }();
+  return mode;
+}
+
+inline size_t getHugePageThreshold() {
+  static const size_t threshold = [] {
+    const char* env_threshold = getenv("NATIVESQL_HUGE_PAGE_THRESHOLD");
+    if (env_threshold == NULL) return (size_t)DEFAULT_HUGE_PAGE_THRESHOLD;
+    return (size_t)strtoull(env_threshold, NULL, 10);
+  }();
+  return threshold;
+}
+
+static inline size_t roundUpToHugePage(size_t size) {
+  return (size + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1);
+}
+
+/* 2M aligned anonymous mapping, the unaligned head and tail are unmapped again */
+static inline void* mapAlignedToHugePage(size_t mapped_size) {
+  size_t reserve_size = mapped_size + HUGE_PAGE_SIZE;
+  char* reserved = (char*)mmap(NULL, reserve_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED) return NULL;
+  uintptr_t mask = (uintptr_t)HUGE_PAGE_SIZE - 1;
+  char* aligned = (char*)(((uintptr_t)reserved + mask) & ~mask);
+  size_t head = aligned - reserved;
+  size_t tail = reserve_size - head - mapped_size;
+  if (head > 0) munmap(reserved, head);
+  if (tail > 0) munmap(aligned + mapped_size, tail);
+  return aligned;
+}
+
+/* Large allocations are always mmap'ed, huge pages are best effort: if neither the
+ * hugetlb pool nor THP can back the mapping it still works with regular pages, and
+ * hugePageFree() can always munmap it. Memory is zero filled. */
+static inline void* hugePageAlloc(size_t size) {
+  size_t mapped_size = roundUpToHugePage(size);
+  HugePageMode mode = getHugePageMode();
+#if defined(MAP_HUGETLB)
+  if (mode == HUGEPAGE_HUGETLB) {
+    void* addr = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) return addr;
+  }
+#endif
+  void* addr = mapAlignedToHugePage(mapped_size);
+  if (addr == NULL) return NULL;
+#if defined(MADV_HUGEPAGE)
+  if (mode != HUGEPAGE_OFF) madvise(addr, mapped_size, MADV_HUGEPAGE);
+#endif
+  return addr;
+}
+
+static inline void hugePageFree(void* ptr, size_t size) {
+  if (ptr == NULL) return;
+  munmap(ptr, roundUpToHugePage(size));
+}
+
+/* Whether an allocation of this size goes through hugePageAlloc(), the same size must
+ * be given back on free so that both sides agree. Fixed for the life of the process. */
+static inline bool isHugePageAllocation(size_t size) {
+  return getHugePageMode() != HUGEPAGE_OFF && size >= getHugePageThreshold();
+}
@@ -6,6 +6,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "third_party/row_wise_memory/huge_page.h"
 
 #define WORD_SIZE 8
 #define MAX_METRICS_NUM 200
@@ -57,6 +60,9 @@ typedef struct MemStat_ {
   uint64_t allocCnt;
   uint64_t reallocCnt;
   uint64_t freeCnt;
+  /*--- huge page backed allocations, also counted above ---*/
+  uint64_t hugePageAllocCnt;
+  uint64_t hugePageBytes;
   /*--- xxx ---*/
   uint64_t createColumnBatchCnt;
   uint64_t freeColumnBatchCnt;
@@ -174,6 +180,8 @@ static void inline dumpMemstat() {
           gmemstat->allocCnt, gmemstat->freeCnt, gmemstat->reallocCnt);
   fprintf(stdout, "    createBatch: %ld  freeBatch: %ld \n",
           gmemstat->createColumnBatchCnt, gmemstat->freeColumnBatchCnt);
+  fprintf(stdout, "    hugePageAlloc: %ld  hugePageBytes: %ld \n",
+          gmemstat->hugePageAllocCnt, gmemstat->hugePageBytes);
   uint32_t notfreeCnt = 0;
   uint64_t sum;
   sum = sumNonFreedSize(gmemstat, &notfreeCnt);
@@ -228,4 +236,45 @@ static inline void nativeFree(void* ptr) {
   free(ptr);
 }
 
+/* For large and long-lived structures, see huge_page.h. The caller passes the size of
+ * the allocation back on realloc and free, which decides how it was allocated. */
+static inline void* nativeMallocLarge(size_t size, uint32_t id) {
+  if (!isHugePageAllocation(size)) return nativeMalloc(size, id);
+  void* addr = hugePageAlloc(size);
+
+#if defined(MEM_STAT)
+  assert(id < MEMTYPE_LAST);
+  gmemstat->allocCnt++;
+  if (addr != NULL) {
+    gmemstat->hugePageAllocCnt++;
+    gmemstat->hugePageBytes += roundUpToHugePage(size);
+  }
+  statMalloc(gmemstat, (uint64_t)addr, size, id);
+#endif
+
+  return addr;
+}
+
+static inline void nativeFreeLarge(void* ptr, size_t size) {
+  if (!isHugePageAllocation(size)) return nativeFree(ptr);
+#if defined(MEM_STAT)
+  gmemstat->freeCnt++;
+  if (ptr != NULL) gmemstat->hugePageBytes -= roundUpToHugePage(size);
+  statFree(gmemstat, (uint64_t)ptr);
+#endif
+  hugePageFree(ptr, size);
+}
+
+static inline void* nativeReallocLarge(void* ptr, size_t oldsize, size_t newsize,
+                                       uint32_t id) {
+  if (!isHugePageAllocation(oldsize) && !isHugePageAllocation(newsize)) {
+    return nativeRealloc(ptr, newsize, id);
+  }
+  void* addr = nativeMallocLarge(newsize, id);
+  if (addr == NULL) return NULL;
+  memcpy(addr, ptr, oldsize < newsize ? oldsize : newsize);
+  nativeFreeLarge(ptr, oldsize);
+  return addr;
+}
+
 #endif
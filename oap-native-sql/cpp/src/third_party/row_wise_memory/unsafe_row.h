@@ -1,6 +1,7 @@
 #pragma once
 
 #include <arrow/util/decimal.h>
+#include <arrow/util/string_view.h>
 #include <assert.h>
 #include <inttypes.h>
 #include <stdlib.h>
@@ -88,12 +89,12 @@ static inline void appendToUnsafeRow(UnsafeRow* row, const int& index, const T&
 }
 
 static inline void appendToUnsafeRow(UnsafeRow* row, const int& index,
-                                     const std::string& str) {
+                                     arrow::util::string_view str) {
   int numBytes = str.size();
   // int roundedSize = roundNumberOfBytesToNearestWord(numBytes);
 
   // zeroOutPaddingBytes(row, numBytes);
-  memcpy(row->data + row->cursor, str.c_str(), numBytes);
+  memcpy(row->data + row->cursor, str.data(), numBytes);
 
   // move the cursor forward.
   row->cursor += numBytes;
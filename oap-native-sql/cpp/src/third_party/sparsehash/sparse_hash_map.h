@@ -1,6 +1,7 @@
 #include <arrow/compute/context.h>
 #include <arrow/status.h>
 
+#include "precompile/internal_hash.h"
 #include "sparsehash/dense_hash_map"
 
 using google::dense_hash_map;
@@ -58,7 +59,9 @@ class SparseHashMap {
   }
 
  private:
-  dense_hash_map<Scalar, int32_t> dense_map_;
+  // std::hash is the identity for integers, which clusters sequential keys
+  dense_hash_map<Scalar, int32_t, sparkcolumnarplugin::precompile::InternalHasher<Scalar>>
+      dense_map_;
   int32_t size_ = 0;
   bool null_index_set_ = false;
   int32_t null_index_;
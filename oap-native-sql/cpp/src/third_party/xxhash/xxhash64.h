@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace sparkcolumnarplugin {
+namespace thirdparty {
+namespace xxhash64 {
+
+// Port of org.apache.spark.sql.catalyst.expressions.XXH64, results are bit-identical
+// to Spark's hashInt/hashLong/hashUnsafeBytes for the same seed.
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotate_left(uint64_t val, int distance) {
+  return (val << distance) | (val >> (64 - distance));
+}
+
+static inline uint64_t fmix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= PRIME64_2;
+  hash ^= hash >> 29;
+  hash *= PRIME64_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+static inline uint64_t read_long(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t read_int(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t hash_int(int32_t input, uint64_t seed) {
+  uint64_t hash = seed + PRIME64_5 + 4ULL;
+  hash ^= (static_cast<uint64_t>(input) & 0xFFFFFFFFULL) * PRIME64_1;
+  hash = rotate_left(hash, 23) * PRIME64_2 + PRIME64_3;
+  return fmix(hash);
+}
+
+static inline uint64_t hash_long(int64_t input, uint64_t seed) {
+  uint64_t hash = seed + PRIME64_5 + 8ULL;
+  hash ^= rotate_left(static_cast<uint64_t>(input) * PRIME64_2, 31) * PRIME64_1;
+  hash = rotate_left(hash, 27) * PRIME64_1 + PRIME64_4;
+  return fmix(hash);
+}
+
+static inline uint64_t hash_bytes_by_words(const uint8_t* data, int32_t length,
+                                           uint64_t seed) {
+  const uint8_t* p = data;
+  const uint8_t* end = data + length;
+  uint64_t hash;
+  if (length >= 32) {
+    const uint8_t* limit = end - 32;
+    uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+    uint64_t v2 = seed + PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME64_1;
+    do {
+      v1 = rotate_left(v1 + read_long(p) * PRIME64_2, 31) * PRIME64_1;
+      v2 = rotate_left(v2 + read_long(p + 8) * PRIME64_2, 31) * PRIME64_1;
+      v3 = rotate_left(v3 + read_long(p + 16) * PRIME64_2, 31) * PRIME64_1;
+      v4 = rotate_left(v4 + read_long(p + 24) * PRIME64_2, 31) * PRIME64_1;
+      p += 32;
+    } while (p <= limit);
+
+    hash = rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) +
+           rotate_left(v4, 18);
+
+    v1 = rotate_left(v1 * PRIME64_2, 31) * PRIME64_1;
+    hash = (hash ^ v1) * PRIME64_1 + PRIME64_4;
+    v2 = rotate_left(v2 * PRIME64_2, 31) * PRIME64_1;
+    hash = (hash ^ v2) * PRIME64_1 + PRIME64_4;
+    v3 = rotate_left(v3 * PRIME64_2, 31) * PRIME64_1;
+    hash = (hash ^ v3) * PRIME64_1 + PRIME64_4;
+    v4 = rotate_left(v4 * PRIME64_2, 31) * PRIME64_1;
+    hash = (hash ^ v4) * PRIME64_1 + PRIME64_4;
+  } else {
+    hash = seed + PRIME64_5;
+  }
+
+  hash += static_cast<uint64_t>(length);
+
+  while (p + 8 <= end) {
+    hash ^= rotate_left(read_long(p) * PRIME64_2, 31) * PRIME64_1;
+    hash = rotate_left(hash, 27) * PRIME64_1 + PRIME64_4;
+    p += 8;
+  }
+  return hash;
+}
+
+static inline uint64_t hash_bytes(const uint8_t* data, int32_t length, uint64_t seed) {
+  uint64_t hash = hash_bytes_by_words(data, length, seed);
+  const uint8_t* p = data + (length & ~7);
+  const uint8_t* end = data + length;
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64_t>(read_int(p)) * PRIME64_1;
+    hash = rotate_left(hash, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  while (p < end) {
+    hash ^= static_cast<uint64_t>(*p) * PRIME64_5;
+    hash = rotate_left(hash, 11) * PRIME64_1;
+    p++;
+  }
+  return fmix(hash);
+}
+
+}  // namespace xxhash64
+}  // namespace thirdparty
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,330 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/gandiva_registry.h"
+
+#include <gandiva/node.h>
+#include <gandiva/node_visitor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+
+namespace {
+
+// the lookups of each thread, see GandivaRegistry::ThreadMetrics()
+thread_local GandivaRegistry::Metrics thread_metrics;
+
+// Writes a schema and gandiva trees as a string no other input writes: every node
+// starts with a tag, then its parts, each length prefixed.
+class KeyBuilder : public gandiva::NodeVisitor {
+ public:
+  void Append(const std::string& part) {
+    key_ += std::to_string(part.size());
+    key_ += ':';
+    key_ += part;
+  }
+
+  void Append(int64_t value) { Append(std::to_string(value)); }
+
+  void Append(const arrow::Field& field) {
+    Append(field.name());
+    Append(field.type()->ToString());
+    Append(field.nullable() ? 1 : 0);
+  }
+
+  void Append(const arrow::Schema& schema) {
+    Append(schema.num_fields());
+    for (const auto& field : schema.fields()) {
+      Append(*field);
+    }
+  }
+
+  void Append(const gandiva::NodePtr& node) {
+    // gandiva's own nodes don't fail to visit
+    auto status = node->Accept(*this);
+    if (!status.ok()) {
+      Append(node->ToString());
+    }
+  }
+
+  arrow::Status Visit(const gandiva::FieldNode& node) override {
+    key_ += 'F';
+    Append(*node.field());
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Visit(const gandiva::FunctionNode& node) override {
+    key_ += 'N';
+    Append(node.descriptor()->name());
+    Append(node.return_type()->ToString());
+    AppendChildren(node.children());
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Visit(const gandiva::IfNode& node) override {
+    key_ += 'I';
+    Append(node.return_type()->ToString());
+    Append(node.condition());
+    Append(node.then_node());
+    Append(node.else_node());
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Visit(const gandiva::LiteralNode& node) override {
+    key_ += 'L';
+    Append(node.return_type()->ToString());
+    if (node.is_null()) {
+      Append("null");
+      return arrow::Status::OK();
+    }
+    // the printed value of a float loses bits, its bit pattern doesn't
+    switch (node.return_type()->id()) {
+      case arrow::Type::FLOAT: {
+        uint32_t bits;
+        auto value = arrow::util::get<float>(node.holder());
+        memcpy(&bits, &value, sizeof(bits));
+        Append(static_cast<int64_t>(bits));
+      } break;
+      case arrow::Type::DOUBLE: {
+        int64_t bits;
+        auto value = arrow::util::get<double>(node.holder());
+        memcpy(&bits, &value, sizeof(bits));
+        Append(bits);
+      } break;
+      default:
+        Append(gandiva::ToString(node.holder()));
+    }
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Visit(const gandiva::BooleanNode& node) override {
+    key_ += 'B';
+    Append(static_cast<int64_t>(node.expr_type()));
+    AppendChildren(node.children());
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Visit(const gandiva::InExpressionNode<int>& node) override {
+    return VisitIn(node);
+  }
+
+  arrow::Status Visit(const gandiva::InExpressionNode<long int>& node) override {
+    return VisitIn(node);
+  }
+
+  arrow::Status Visit(const gandiva::InExpressionNode<std::string>& node) override {
+    return VisitIn(node);
+  }
+
+  const std::string& key() const { return key_; }
+
+ private:
+  void AppendChildren(const gandiva::NodeVector& children) {
+    Append(static_cast<int64_t>(children.size()));
+    for (const auto& child : children) {
+      Append(child);
+    }
+  }
+
+  template <typename Type>
+  arrow::Status VisitIn(const gandiva::InExpressionNode<Type>& node) {
+    key_ += 'E';
+    Append(node.eval_expr());
+    // the values are a hash set, equal sets may iterate in different orders
+    std::vector<std::string> values;
+    for (const auto& value : node.values()) {
+      std::stringstream ss;
+      ss << value;
+      values.push_back(ss.str());
+    }
+    std::sort(values.begin(), values.end());
+    Append(static_cast<int64_t>(values.size()));
+    for (const auto& value : values) {
+      Append(value);
+    }
+    return arrow::Status::OK();
+  }
+
+  std::string key_;
+};
+
+}  // namespace
+
+GandivaRegistry* GandivaRegistry::Get() {
+  // never destroyed, tasks may still evaluate shared projectors when the executor exits
+  static auto instance = new GandivaRegistry(DefaultCapacity());
+  return instance;
+}
+
+int64_t GandivaRegistry::DefaultCapacity() {
+  auto env = std::getenv("NATIVESQL_GANDIVA_CACHE_BYTES");
+  return env == nullptr ? 256LL << 20 : std::strtoll(env, nullptr, 10);
+}
+
+std::string GandivaRegistry::ProjectorFingerprint(
+    const arrow::Schema& schema, const gandiva::ExpressionVector& exprs,
+    gandiva::SelectionVector::Mode selection_vector_mode,
+    const gandiva::Configuration& configuration) {
+  KeyBuilder builder;
+  builder.Append("projector");
+  builder.Append(static_cast<int64_t>(selection_vector_mode));
+  builder.Append(static_cast<int64_t>(configuration.Hash()));
+  builder.Append(schema);
+  builder.Append(static_cast<int64_t>(exprs.size()));
+  for (const auto& expr : exprs) {
+    builder.Append(expr->root());
+    builder.Append(*expr->result());
+  }
+  return builder.key();
+}
+
+std::string GandivaRegistry::FilterFingerprint(
+    const arrow::Schema& schema, const gandiva::Condition& condition,
+    const gandiva::Configuration& configuration) {
+  KeyBuilder builder;
+  builder.Append("filter");
+  builder.Append(static_cast<int64_t>(configuration.Hash()));
+  builder.Append(schema);
+  builder.Append(condition.root());
+  return builder.key();
+}
+
+arrow::Status GandivaRegistry::MakeProjector(
+    const std::shared_ptr<arrow::Schema>& schema, const gandiva::ExpressionVector& exprs,
+    std::shared_ptr<gandiva::Configuration> configuration,
+    std::shared_ptr<gandiva::Projector>* out) {
+  return MakeProjector(schema, exprs, gandiva::SelectionVector::Mode::MODE_NONE,
+                       std::move(configuration), out);
+}
+
+arrow::Status GandivaRegistry::MakeProjector(
+    const std::shared_ptr<arrow::Schema>& schema, const gandiva::ExpressionVector& exprs,
+    gandiva::SelectionVector::Mode selection_vector_mode,
+    std::shared_ptr<gandiva::Configuration> configuration,
+    std::shared_ptr<gandiva::Projector>* out) {
+  if (capacity_bytes_ <= 0) {
+    return gandiva::Projector::Make(schema, exprs, selection_vector_mode,
+                                    std::move(configuration), out);
+  }
+  auto key = ProjectorFingerprint(*schema, exprs, selection_vector_mode, *configuration);
+  Entry entry;
+  if (Lookup(key, &entry)) {
+    *out = entry.projector;
+    return arrow::Status::OK();
+  }
+  auto start = std::chrono::steady_clock::now();
+  RETURN_NOT_OK(gandiva::Projector::Make(schema, exprs, selection_vector_mode,
+                                         std::move(configuration), &entry.projector));
+  entry.build_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  *out = entry.projector;
+  Insert(key, std::move(entry));
+  return arrow::Status::OK();
+}
+
+arrow::Status GandivaRegistry::MakeFilter(
+    const std::shared_ptr<arrow::Schema>& schema, const gandiva::ConditionPtr& condition,
+    std::shared_ptr<gandiva::Configuration> configuration,
+    std::shared_ptr<gandiva::Filter>* out) {
+  if (capacity_bytes_ <= 0) {
+    return gandiva::Filter::Make(schema, condition, std::move(configuration), out);
+  }
+  auto key = FilterFingerprint(*schema, *condition, *configuration);
+  Entry entry;
+  if (Lookup(key, &entry)) {
+    *out = entry.filter;
+    return arrow::Status::OK();
+  }
+  auto start = std::chrono::steady_clock::now();
+  RETURN_NOT_OK(
+      gandiva::Filter::Make(schema, condition, std::move(configuration), &entry.filter));
+  entry.build_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  *out = entry.filter;
+  Insert(key, std::move(entry));
+  return arrow::Status::OK();
+}
+
+bool GandivaRegistry::Lookup(const std::string& key, Entry* out) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    metrics_.misses++;
+    thread_metrics.misses++;
+    return false;
+  }
+  metrics_.hits++;
+  metrics_.saved_nanos += it->second.build_nanos;
+  thread_metrics.hits++;
+  thread_metrics.saved_nanos += it->second.build_nanos;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  *out = it->second;
+  return true;
+}
+
+void GandivaRegistry::Insert(const std::string& key, Entry entry) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  metrics_.build_nanos += entry.build_nanos;
+  thread_metrics.build_nanos += entry.build_nanos;
+  // another task may have built the same inputs meanwhile
+  if (map_.find(key) != map_.end()) return;
+  entry.bytes = EstimatedBytes(key);
+  // an entry bigger than the whole budget is not kept
+  if (entry.bytes > capacity_bytes_) return;
+  while (!lru_.empty() && bytes_ + entry.bytes > capacity_bytes_) {
+    auto victim = map_.find(*lru_.back());
+    bytes_ -= victim->second.bytes;
+    map_.erase(victim);
+    lru_.pop_back();
+    metrics_.evictions++;
+    thread_metrics.evictions++;
+  }
+  bytes_ += entry.bytes;
+  metrics_.inserts++;
+  thread_metrics.inserts++;
+  auto it = map_.emplace(key, std::move(entry)).first;
+  lru_.push_front(&it->first);
+  it->second.lru_it = lru_.begin();
+}
+
+GandivaRegistry::Metrics GandivaRegistry::metrics() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto metrics = metrics_;
+  metrics.size = map_.size();
+  metrics.bytes = bytes_;
+  return metrics;
+}
+
+GandivaRegistry::Metrics GandivaRegistry::ThreadMetrics() { return thread_metrics; }
+
+void GandivaRegistry::Clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  lru_.clear();
+  map_.clear();
+  bytes_ = 0;
+}
+
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/status.h>
+#include <arrow/type.h>
+#include <gandiva/configuration.h>
+#include <gandiva/filter.h>
+#include <gandiva/projector.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sparkcolumnarplugin {
+
+/**
+ * Executor wide registry of built gandiva projectors and filters, keyed by the
+ * fingerprint of what they are built from. Gandiva's module cache saves the LLVM
+ * compile of a task building the same expressions as an earlier one, but not the
+ * cache lookup, the hashing of the IR and the setup of the evaluator, which the
+ * registry turns into a map lookup. Projectors and filters only read their state
+ * while evaluating, so the tasks share them. The least recently used are dropped once
+ * their estimated size passes NATIVESQL_GANDIVA_CACHE_BYTES, tasks still using one keep
+ * it alive.
+ */
+class GandivaRegistry {
+ public:
+  struct Metrics {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    // entries added, unlike size it only grows
+    int64_t inserts = 0;
+    // time spent building on misses, and the build time of the entries hit
+    int64_t build_nanos = 0;
+    int64_t saved_nanos = 0;
+    // entries held and their estimated bytes, left 0 by ThreadMetrics()
+    int64_t size = 0;
+    int64_t bytes = 0;
+  };
+
+  explicit GandivaRegistry(int64_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+  /// Registry of the executor, configured by NATIVESQL_GANDIVA_CACHE_BYTES.
+  static GandivaRegistry* Get();
+
+  /// NATIVESQL_GANDIVA_CACHE_BYTES, 256M by default, 0 builds every time.
+  static int64_t DefaultCapacity();
+
+  /// Estimated memory of the module and evaluator built for key: the machine code and
+  /// LLVM state of a module grow with its expressions, and so does the key.
+  static int64_t EstimatedBytes(const std::string& key) {
+    return kModuleBytes + static_cast<int64_t>(key.size()) * kBytesPerKeyByte;
+  }
+
+  /// Same as gandiva::Projector::Make, returning the projector already built from the
+  /// same inputs if there is one.
+  arrow::Status MakeProjector(const std::shared_ptr<arrow::Schema>& schema,
+                              const gandiva::ExpressionVector& exprs,
+                              std::shared_ptr<gandiva::Configuration> configuration,
+                              std::shared_ptr<gandiva::Projector>* out);
+
+  arrow::Status MakeProjector(const std::shared_ptr<arrow::Schema>& schema,
+                              const gandiva::ExpressionVector& exprs,
+                              gandiva::SelectionVector::Mode selection_vector_mode,
+                              std::shared_ptr<gandiva::Configuration> configuration,
+                              std::shared_ptr<gandiva::Projector>* out);
+
+  arrow::Status MakeFilter(const std::shared_ptr<arrow::Schema>& schema,
+                           const gandiva::ConditionPtr& condition,
+                           std::shared_ptr<gandiva::Configuration> configuration,
+                           std::shared_ptr<gandiva::Filter>* out);
+
+  /// Key of a projector or filter. It spells out the schema and the trees node by node,
+  /// every name and value length prefixed so that no two inputs share a key, with the
+  /// field names and the exact bits of the literals, which the codegen fingerprints of
+  /// CodeGenRegister leave out as kernels are shared across column names.
+  static std::string ProjectorFingerprint(
+      const arrow::Schema& schema, const gandiva::ExpressionVector& exprs,
+      gandiva::SelectionVector::Mode selection_vector_mode,
+      const gandiva::Configuration& configuration);
+  static std::string FilterFingerprint(const arrow::Schema& schema,
+                                       const gandiva::Condition& condition,
+                                       const gandiva::Configuration& configuration);
+
+  Metrics metrics();
+
+  /// Counters of the lookups the calling thread made, in any registry, since it
+  /// started. A task diffs them around its own builds, unlike metrics() they don't
+  /// count the builds of the tasks running next to it.
+  static Metrics ThreadMetrics();
+
+  void Clear();
+
+ private:
+  static constexpr int64_t kModuleBytes = 64 << 10;
+  static constexpr int64_t kBytesPerKeyByte = 32;
+
+  // keys of map_ are stable, the recency list only points at them
+  using LruList = std::list<const std::string*>;
+
+  struct Entry {
+    std::shared_ptr<gandiva::Projector> projector;
+    std::shared_ptr<gandiva::Filter> filter;
+    int64_t build_nanos;
+    int64_t bytes;
+    LruList::iterator lru_it;
+  };
+
+  // copies the entry of key out, false on a miss
+  bool Lookup(const std::string& key, Entry* out);
+  void Insert(const std::string& key, Entry entry);
+
+  const int64_t capacity_bytes_;
+  std::mutex mtx_;
+  LruList lru_;
+  std::unordered_map<std::string, Entry> map_;
+  int64_t bytes_ = 0;
+  Metrics metrics_;
+};
+
+}  // namespace sparkcolumnarplugin
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "third_party/row_wise_memory/huge_page.h"
+
+namespace sparkcolumnarplugin {
+
+/// Serves large arrow buffers (sort buffers, hash relation payloads) from huge page
+/// mappings, see third_party/row_wise_memory/huge_page.h. Smaller buffers and the
+/// whole pool when NATIVESQL_HUGE_PAGE is off go to the delegated pool.
+class HugePageMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit HugePageMemoryPool(arrow::MemoryPool* delegated) : delegated_(delegated) {}
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override {
+    if (!isHugePageAllocation(size)) return delegated_->Allocate(size, out);
+    void* addr = hugePageAlloc(size);
+    if (addr == nullptr) {
+      return arrow::Status::OutOfMemory("HugePageMemoryPool failed to map ", size,
+                                        " bytes");
+    }
+    *out = reinterpret_cast<uint8_t*>(addr);
+    UpdateAllocated(size);
+    return arrow::Status::OK();
+  }
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override {
+    if (!isHugePageAllocation(old_size) && !isHugePageAllocation(new_size)) {
+      return delegated_->Reallocate(old_size, new_size, ptr);
+    }
+    uint8_t* out;
+    RETURN_NOT_OK(Allocate(new_size, &out));
+    memcpy(out, *ptr, std::min(old_size, new_size));
+    Free(*ptr, old_size);
+    *ptr = out;
+    return arrow::Status::OK();
+  }
+
+  void Free(uint8_t* buffer, int64_t size) override {
+    if (!isHugePageAllocation(size)) return delegated_->Free(buffer, size);
+    hugePageFree(buffer, size);
+    UpdateAllocated(-size);
+  }
+
+  int64_t bytes_allocated() const override {
+    return delegated_->bytes_allocated() + huge_page_bytes_.load();
+  }
+
+  int64_t max_memory() const override {
+    return std::max(delegated_->max_memory(), max_huge_page_bytes_.load());
+  }
+
+  std::string backend_name() const override {
+    return "hugepage+" + delegated_->backend_name();
+  }
+
+ private:
+  void UpdateAllocated(int64_t diff) {
+    auto allocated = huge_page_bytes_.fetch_add(diff) + diff;
+    auto max_allocated = max_huge_page_bytes_.load();
+    while (allocated > max_allocated &&
+           !max_huge_page_bytes_.compare_exchange_weak(max_allocated, allocated)) {
+    }
+  }
+
+  arrow::MemoryPool* delegated_;
+  std::atomic<int64_t> huge_page_bytes_{0};
+  std::atomic<int64_t> max_huge_page_bytes_{0};
+};
+
+/// Process wide instance on top of arrow::default_memory_pool(), used as the backing
+/// pool of the per task listenable pools when huge pages are enabled.
+inline arrow::MemoryPool* GetHugePageMemoryPool() {
+  static HugePageMemoryPool pool(arrow::default_memory_pool());
+  return &pool;
+}
+
+}  // namespace sparkcolumnarplugin
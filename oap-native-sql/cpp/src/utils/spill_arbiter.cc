@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/spill_arbiter.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace sparkcolumnarplugin {
+
+// a reservation is retried as long as the last round reclaimed something
+static const int kMaxReclaimRounds = 3;
+
+SpillArbiter::~SpillArbiter() {
+#ifdef DEBUG
+  std::cout << "SpillArbiter: " << num_triggers_ << " spill triggers, "
+            << total_bytes_reclaimed_ << " bytes reclaimed" << std::endl;
+  for (const auto& entry : metrics_) {
+    std::cout << "  " << entry.first << ": " << entry.second.num_spills << " spills, "
+              << entry.second.bytes_reclaimed << " bytes reclaimed" << std::endl;
+  }
+#endif
+}
+
+static std::mutex registry_mutex;
+static std::map<int64_t, std::weak_ptr<SpillArbiter>> registry;
+
+static void RemoveExpired() {
+  for (auto it = registry.begin(); it != registry.end();) {
+    it = it->second.expired() ? registry.erase(it) : std::next(it);
+  }
+}
+
+std::shared_ptr<SpillArbiter> SpillArbiter::ForTask(int64_t task_attempt_id) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto arbiter = registry[task_attempt_id].lock();
+  if (arbiter == nullptr) {
+    // drop arbiters of finished tasks before adding one
+    RemoveExpired();
+    arbiter = std::make_shared<SpillArbiter>();
+    registry[task_attempt_id] = arbiter;
+  }
+  return arbiter;
+}
+
+void SpillArbiter::RemoveFinishedTasks() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  RemoveExpired();
+}
+
+void SpillArbiter::Register(Spillable* spillable) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  spillables_.push_back(spillable);
+}
+
+void SpillArbiter::Unregister(Spillable* spillable) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  spillables_.erase(std::remove(spillables_.begin(), spillables_.end(), spillable),
+                    spillables_.end());
+}
+
+arrow::Status SpillArbiter::Reclaim(int64_t size, int64_t* reclaimed) {
+  *reclaimed = 0;
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (reclaiming_) {
+    return arrow::Status::OK();
+  }
+  num_triggers_++;
+
+  std::vector<std::pair<double, Spillable*>> candidates;
+  for (auto spillable : spillables_) {
+    auto bytes = spillable->GetReclaimableBytes();
+    if (bytes > 0) {
+      candidates.emplace_back(bytes / std::max(spillable->GetSpillCost(), 1e-6),
+                              spillable);
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const std::pair<double, Spillable*>& a,
+                      const std::pair<double, Spillable*>& b) {
+                     return a.first > b.first;
+                   });
+
+  reclaiming_ = true;
+  arrow::Status status;
+  for (const auto& candidate : candidates) {
+    if (*reclaimed >= size) break;
+    auto victim = candidate.second;
+    int64_t victim_reclaimed = 0;
+    status = victim->Spill(size - *reclaimed, &victim_reclaimed);
+    if (!status.ok()) break;
+    auto& metrics = metrics_[victim->SpillableName()];
+    metrics.num_spills++;
+    metrics.bytes_reclaimed += victim_reclaimed;
+    total_bytes_reclaimed_ += victim_reclaimed;
+    *reclaimed += victim_reclaimed;
+#ifdef DEBUG
+    std::cout << "SpillArbiter: spilled " << victim->SpillableName() << ", reclaimed "
+              << victim_reclaimed << " of " << size << " bytes" << std::endl;
+#endif
+  }
+  reclaiming_ = false;
+  return status;
+}
+
+int64_t SpillArbiter::num_triggers() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return num_triggers_;
+}
+
+int64_t SpillArbiter::total_bytes_reclaimed() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return total_bytes_reclaimed_;
+}
+
+std::map<std::string, SpillArbiter::Metrics> SpillArbiter::metrics() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return metrics_;
+}
+
+arrow::Status ArbitratedMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  auto status = delegated_->Allocate(size, out);
+  for (int round = 0; !status.ok() && arbiter_ != nullptr && round < kMaxReclaimRounds;
+       round++) {
+    int64_t reclaimed;
+    RETURN_NOT_OK(arbiter_->Reclaim(size, &reclaimed));
+    if (reclaimed == 0) break;
+    status = delegated_->Allocate(size, out);
+  }
+  return status;
+}
+
+arrow::Status ArbitratedMemoryPool::Reallocate(int64_t old_size, int64_t new_size,
+                                               uint8_t** ptr) {
+  auto status = delegated_->Reallocate(old_size, new_size, ptr);
+  for (int round = 0; !status.ok() && arbiter_ != nullptr && round < kMaxReclaimRounds;
+       round++) {
+    int64_t reclaimed;
+    RETURN_NOT_OK(arbiter_->Reclaim(new_size - old_size, &reclaimed));
+    if (reclaimed == 0) break;
+    status = delegated_->Reallocate(old_size, new_size, ptr);
+  }
+  return status;
+}
+
+std::shared_ptr<SpillArbiter> GetSpillArbiter(arrow::MemoryPool* pool) {
+  auto arbitrated = dynamic_cast<ArbitratedMemoryPool*>(pool);
+  return arbitrated == nullptr ? nullptr : arbitrated->arbiter();
+}
+
+}  // namespace sparkcolumnarplugin
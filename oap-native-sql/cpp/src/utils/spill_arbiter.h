@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sparkcolumnarplugin {
+
+/// An operator holding memory it can give back on request, by writing it to disk or
+/// by dropping buffers it can rebuild. Only memory allocated from the pool the
+/// operator registered with counts as reclaimable, as only that releases the task's
+/// reservation.
+class Spillable {
+ public:
+  virtual ~Spillable() = default;
+
+  /// Name the reclaimed bytes are reported under, operators of one kind share it.
+  virtual std::string SpillableName() const = 0;
+
+  /// Bytes a Spill() could release right now, 0 when the operator is in a state it
+  /// can't spill from.
+  virtual int64_t GetReclaimableBytes() const = 0;
+
+  /// Relative cost of releasing one byte, victims with more reclaimable bytes per
+  /// unit of cost are asked first. Operators that have to read spilled data back
+  /// should report more than the default.
+  virtual double GetSpillCost() const { return 1.0; }
+
+  /// Release at least size bytes if possible, and report how many were released.
+  virtual arrow::Status Spill(int64_t size, int64_t* reclaimed) = 0;
+};
+
+/// Per task registry of the spill capable operators. When a reservation fails,
+/// ArbitratedMemoryPool asks the arbiter to reclaim the requested size, and the
+/// arbiter spills the registered operators in order of reclaimable bytes per cost
+/// until enough was released. This lets an allocation succeed while another operator
+/// of the same task holds the memory.
+class SpillArbiter {
+ public:
+  struct Metrics {
+    int64_t num_spills = 0;
+    int64_t bytes_reclaimed = 0;
+  };
+
+  SpillArbiter() = default;
+  ~SpillArbiter();
+
+  /// Arbiter shared by all the memory pools of a task attempt, it lives as long as
+  /// one of them holds it.
+  static std::shared_ptr<SpillArbiter> ForTask(int64_t task_attempt_id);
+
+  /// Drops the registry entries of tasks whose pools were all released.
+  static void RemoveFinishedTasks();
+
+  void Register(Spillable* spillable);
+  void Unregister(Spillable* spillable);
+
+  /// Spills registered operators until size bytes are released or no candidate is
+  /// left. Calls made from within a Spill() reclaim nothing, a spilling operator
+  /// can't be spilled again.
+  arrow::Status Reclaim(int64_t size, int64_t* reclaimed);
+
+  /// Number of failed reservations that went through Reclaim().
+  int64_t num_triggers() const;
+  int64_t total_bytes_reclaimed() const;
+  /// Spills and reclaimed bytes by SpillableName().
+  std::map<std::string, Metrics> metrics() const;
+
+ private:
+  mutable std::recursive_mutex mutex_;
+  std::vector<Spillable*> spillables_;
+  bool reclaiming_ = false;
+  int64_t num_triggers_ = 0;
+  int64_t total_bytes_reclaimed_ = 0;
+  std::map<std::string, Metrics> metrics_;
+};
+
+/// Wraps the memory pool of a task, a failed Allocate or Reallocate lets the arbiter
+/// spill and is then retried.
+class ArbitratedMemoryPool : public arrow::MemoryPool {
+ public:
+  ArbitratedMemoryPool(arrow::MemoryPool* delegated,
+                       std::shared_ptr<SpillArbiter> arbiter)
+      : delegated_(delegated), arbiter_(std::move(arbiter)) {}
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size) override { delegated_->Free(buffer, size); }
+
+  int64_t bytes_allocated() const override { return delegated_->bytes_allocated(); }
+
+  int64_t max_memory() const override { return delegated_->max_memory(); }
+
+  std::string backend_name() const override { return delegated_->backend_name(); }
+
+  arrow::MemoryPool* delegated() const { return delegated_; }
+
+  const std::shared_ptr<SpillArbiter>& arbiter() const { return arbiter_; }
+
+  /// Called when the task released the pool while buffers are still allocated from
+  /// it, failed allocations are no longer retried afterwards.
+  void ReleaseArbiter() { arbiter_.reset(); }
+
+ private:
+  arrow::MemoryPool* delegated_;
+  std::shared_ptr<SpillArbiter> arbiter_;
+};
+
+/// Arbiter of the task owning pool, nullptr when the pool is not arbitrated.
+std::shared_ptr<SpillArbiter> GetSpillArbiter(arrow::MemoryPool* pool);
+
+}  // namespace sparkcolumnarplugin